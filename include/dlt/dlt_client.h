@@ -75,6 +75,8 @@
   \{
 */
 
+#include <pthread.h>
+
 #include "dlt_types.h"
 #include "dlt_common.h"
 
@@ -97,14 +99,70 @@ typedef struct
     char ecuid[4];           /**< ECUiD */
     speed_t baudrate;      /**< baudrate Baudrate of serial interface, as speed_t */
     DltClientMode mode;    /**< mode DltClientMode */
+    struct sDltClientPrivate *priv; /**< private data, allocated by dlt_client_init() */
 } DltClient;
 
+/**
+ * State of a connection managed by a client loop
+ */
+typedef enum
+{
+    DLT_CLIENT_LOOP_DISCONNECTED = 0, /**< waiting for the next connection attempt */
+    DLT_CLIENT_LOOP_CONNECTING,       /**< connection is being established */
+    DLT_CLIENT_LOOP_CONNECTED         /**< messages are received */
+} DltClientLoopState;
+
+/**
+ * Connection managed by a client loop.
+ * The client is set up with dlt_client_init() and the dlt_client_set_ functions,
+ * the callbacks and data are set before the connection is added to a loop.
+ */
+typedef struct DltClientConnection
+{
+    DltClient client;                  /**< connection parameters and receiver */
+    DltClientLoopState state;          /**< state of the connection */
+    int (*message_callback) (struct DltClientConnection *con, DltMessage *message, void *data); /**< called for each received message */
+    void (*state_callback) (struct DltClientConnection *con, void *data); /**< called when the state changed, optional */
+    void *data;                        /**< passed to the callbacks */
+    struct DltClientLoop *loop;        /**< loop managing the connection */
+    uint32_t backoff;                  /**< delay before the next connection attempt in ms */
+    int64_t retry;                     /**< time of the next connection attempt in ms */
+    uint8_t *sendbuf;                  /**< control messages not sent yet */
+    uint32_t send_used;                /**< bytes in sendbuf */
+    uint32_t send_size;                /**< size of sendbuf */
+} DltClientConnection;
+
+/**
+ * Event loop handling many connections to dlt daemons in one thread.
+ * Control messages can be sent from other threads.
+ */
+typedef struct DltClientLoop
+{
+    int epfd;                          /**< epoll instance */
+    int wake_fd;                       /**< eventfd to interrupt the loop */
+    int stop;                          /**< request to leave dlt_client_loop_run() */
+    pthread_mutex_t mutex;             /**< protects sockets and send buffers */
+    DltClientConnection **connections; /**< managed connections */
+    int num_connections;               /**< number of managed connections */
+    uint32_t backoff_min;              /**< first reconnect delay in ms */
+    uint32_t backoff_max;              /**< maximum reconnect delay in ms */
+} DltClientLoop;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 void dlt_client_register_message_callback(int (*registerd_callback) (DltMessage *message, void *data));
 
+/**
+ * Register a function called after all messages of a received chunk were handed
+ * to the message callback. The payload of the messages handed to the message
+ * callback points into the receive buffer, preceded by the complete message
+ * without storage header, and stays valid until this function returned.
+ * @param registerd_callback function called with the data of the main loop
+ */
+void dlt_client_register_chunk_callback(int (*registerd_callback) (void *data));
+
 /**
  * Initialising dlt client structure with a specific port
  * @param client pointer to dlt client structure
@@ -129,7 +187,16 @@ DltReturnValue dlt_client_init(DltClient *client, int verbose);
  */
 DltReturnValue dlt_client_connect(DltClient *client, int verbose);
 /**
- * Cleanup dlt client structure
+ * Set the size of the receive buffer, a larger buffer reduces the number of
+ * reads at high data rates. Must be called before dlt_client_connect().
+ * @param client pointer to dlt client structure
+ * @param size size of receive buffer in bytes
+ * @return Value from DltReturnValue enum
+ */
+DltReturnValue dlt_client_set_receive_buffer_size(DltClient *client, int32_t size);
+/**
+ * Cleanup dlt client structure.
+ * A connection of a client loop is removed from the loop before.
  * @param client pointer to dlt client structure
  * @param verbose if set to true verbose information is printed out.
  * @return Value from DltReturnValue enum
@@ -144,7 +211,9 @@ DltReturnValue dlt_client_cleanup(DltClient *client, int verbose);
  */
 DltReturnValue dlt_client_main_loop(DltClient *client, void *data, int verbose);
 /**
- * Send ancontrol message to the dlt daemon
+ * Send ancontrol message to the dlt daemon.
+ * If the client is a connection of a client loop, the message is queued and
+ * sent without blocking.
  * @param client pointer to dlt client structure
  * @param apid application id
  * @param ctid context id
@@ -228,6 +297,13 @@ DltReturnValue dlt_client_send_default_trace_status(DltClient *client, uint8_t d
  * @return Value from DltReturnValue enum
  */
 DltReturnValue dlt_client_send_all_trace_status(DltClient *client, uint8_t traceStatus);
+/**
+ * Send a filter to the dlt daemon, only messages matching it are sent to this client
+ * @param client pointer to dlt client structure
+ * @param filter filter text as in filter files, see dlt_filter_parse(); empty text removes the filter
+ * @return Value from DltReturnValue enum
+ */
+DltReturnValue dlt_client_send_filter(DltClient *client, const char *filter);
 /**
  * Send the timing pakets status to the dlt daemon
  * @param client pointer to dlt client structure
@@ -280,6 +356,75 @@ int dlt_client_set_serial_device(DltClient *client, char *serial_device);
  */
 int dlt_client_set_socket_path(DltClient *client, char *socket_path);
 
+/**
+ * Initialise a client loop
+ * @param loop pointer to client loop structure
+ * @param verbose if set to true verbose information is printed out.
+ * @return Value from DltReturnValue enum
+ */
+DltReturnValue dlt_client_loop_init(DltClientLoop *loop, int verbose);
+/**
+ * Close all connections of a client loop and free the loop.
+ * The connection structures stay owned by the caller.
+ * @param loop pointer to client loop structure
+ * @param verbose if set to true verbose information is printed out.
+ * @return Value from DltReturnValue enum
+ */
+DltReturnValue dlt_client_loop_free(DltClientLoop *loop, int verbose);
+/**
+ * Set the delays between connection attempts. The delay starts with min_delay
+ * and is doubled after each failed attempt up to max_delay.
+ * @param loop pointer to client loop structure
+ * @param min_delay first delay in ms
+ * @param max_delay maximum delay in ms
+ * @return Value from DltReturnValue enum
+ */
+DltReturnValue dlt_client_loop_set_backoff(DltClientLoop *loop, uint32_t min_delay, uint32_t max_delay);
+/**
+ * Add a connection to a client loop, it is connected by the loop and
+ * reconnected whenever it was lost. Must not be called while the loop is
+ * dispatched in another thread.
+ * @param loop pointer to client loop structure
+ * @param con connection, valid until removed
+ * @param verbose if set to true verbose information is printed out.
+ * @return Value from DltReturnValue enum
+ */
+DltReturnValue dlt_client_loop_add(DltClientLoop *loop, DltClientConnection *con, int verbose);
+/**
+ * Close a connection and remove it from its client loop. Must not be called
+ * while the loop is dispatched in another thread, except from a callback.
+ * If removed from a callback, the connection must stay valid until the
+ * dispatch returned.
+ * @param loop pointer to client loop structure
+ * @param con connection
+ * @param verbose if set to true verbose information is printed out.
+ * @return Value from DltReturnValue enum
+ */
+DltReturnValue dlt_client_loop_remove(DltClientLoop *loop, DltClientConnection *con, int verbose);
+/**
+ * Wait for events of the connections of a client loop and handle them.
+ * Received messages are handed to the message callback of their connection,
+ * the payload points into the receive buffer. Lost connections are
+ * reconnected when their delay expired.
+ * @param loop pointer to client loop structure
+ * @param timeout maximum time to wait in ms, -1 waits until an event occurred
+ * @param verbose if set to true verbose information is printed out.
+ * @return number of handled events, negative value if there was an error
+ */
+int dlt_client_loop_dispatch(DltClientLoop *loop, int timeout, int verbose);
+/**
+ * Dispatch the events of a client loop until dlt_client_loop_stop() is called
+ * @param loop pointer to client loop structure
+ * @param verbose if set to true verbose information is printed out.
+ * @return Value from DltReturnValue enum
+ */
+DltReturnValue dlt_client_loop_run(DltClientLoop *loop, int verbose);
+/**
+ * Request dlt_client_loop_run() to return, may be called from any thread
+ * @param loop pointer to client loop structure
+ */
+void dlt_client_loop_stop(DltClientLoop *loop);
+
 #ifdef __cplusplus
 }
 #endif
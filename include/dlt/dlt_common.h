@@ -274,7 +274,6 @@ enum {
 #define DLT_OUTPUT_ASCII_LIMITED    5
 
 #define DLT_FILTER_MAX 30 /**< Maximum number of filters */
-
 #define DLT_MSG_READ_VALUE(dst,src,length,type) \
 { \
     if((length<0) || ((length)<((int32_t)sizeof(type)))) \
@@ -296,7 +295,8 @@ enum {
     if(((maxlength)<0) || ((length)<0) || ((maxlength)<(length))) \
     { maxlength = -1; } \
     else \
-    { memcpy(dst,src,length);dlt_clean_string(dst,length);dst[length]=0; \
+    { char *dst_string = (char *)(dst); \
+        memcpy(dst_string,src,length);dlt_clean_string(dst_string,length);dst_string[length]=0; \
         src+=length;maxlength-=length; } \
 }
 
@@ -606,6 +606,16 @@ typedef struct
     char injections[DLT_ENTRY_MAX];           /**< list of injections */
 } PACKED DltServiceGetCurrentFilterInfo;
 
+/**
+ * The structure of DLT Service Set Client Filter
+ */
+typedef struct
+{
+    uint32_t service_id;            /**< service ID */
+    uint32_t length;                /**< length of following filter text, 0 removes the filter */
+    /*char [] filter;*/
+} PACKED DltServiceSetClientFilter;
+
 /**
  * The structure of DLT Service Passive Node Connect
  */
@@ -632,14 +642,23 @@ typedef struct
  * Structure to store filter parameters.
  * ID are maximal four characters. Unused values are filled with zeros.
  * If every value as filter is valid, the id should be empty by having only zero values.
+ * A message is used if any of the filters matches.
+ * Further predicates of the filters are kept compiled in private state
+ * allocated by dlt_filter_init() and released by dlt_filter_free().
  */
 typedef struct
 {
     char apid[DLT_FILTER_MAX][DLT_ID_SIZE]; /**< application id */
     char ctid[DLT_FILTER_MAX][DLT_ID_SIZE]; /**< context id */
     int  counter;                           /**< number of filters */
+    struct sDltFilterCompiled *compiled;    /**< compiled predicates and hash set (private) */
 } DltFilter;
 
+/**
+ * Suffix appended to the name of a DLT file to get the name of its index file.
+ */
+#define DLT_FILE_INDEX_SUFFIX ".idx"
+
 /**
  * The structure to organise the access to DLT files.
  * This structure is used by the corresponding functions.
@@ -648,7 +667,7 @@ typedef struct sDltFile
 {
     /* file handle and index for fast access */
     FILE *handle;      /**< file handle of opened DLT file */
-    long *index;       /**< file positions of all DLT messages for fast access to file, only filtered messages */
+    struct sDltFileIndex *index; /**< file positions of all DLT messages for fast access to file, only filtered messages, private, see dlt_file_index_position() */
 
     /* size parameters */
     int32_t counter;       /**< number of messages in DLT file with filter */
@@ -795,12 +814,29 @@ extern "C"
     DltReturnValue dlt_filter_free(DltFilter *filter,int verbose);
     /**
      * Load filter list from file.
+     * The filter list initialised by dlt_filter_init() is reset before.
+     * Each line holds pairs of application and context id ("----" for any id) or
+     * predicates like level<=warn, every pair starts a new filter. See dlt_filter_parse().
      * @param filter pointer to structure of organising DLT filter
      * @param filename filename to load filters from
      * @param verbose if set to true verbose information is printed out.
      * @return negative value if there was an error
      */
     DltReturnValue dlt_filter_load(DltFilter *filter,const char *filename,int verbose);
+    /**
+     * Add the filters of a text to the filter list.
+     * Lines are separated by newlines, words by blanks. Words without operator are
+     * pairs of application and context id, predicates are
+     * apid=, ctid=, ecu=, type=, level=, level<=, level>=, seid=, tmsp=, tmsp<=, tmsp>=,
+     * payload= (byte string) and payload~= (extended regular expression).
+     * Predicates belong to the filter started last in the line, or start a new one.
+     * Lines starting with # are ignored.
+     * @param filter pointer to structure of organising DLT filter
+     * @param text filter text
+     * @param verbose if set to true verbose information is printed out.
+     * @return negative value if there was an error
+     */
+    DltReturnValue dlt_filter_parse(DltFilter *filter,const char *text,int verbose);
     /**
      * Save filter list to file.
      * @param filter pointer to structure of organising DLT filter
@@ -810,7 +846,7 @@ extern "C"
      */
     DltReturnValue dlt_filter_save(DltFilter *filter,const char *filename,int verbose);
     /**
-     * Find index of filter in filter list
+     * Find index of filter without further predicates in filter list
      * @param filter pointer to structure of organising DLT filter
      * @param apid application id to be found in filter list
      * @param ctid context id to be found in filter list
@@ -903,6 +939,35 @@ extern "C"
      */
     int dlt_message_read(DltMessage *msg,uint8_t *buffer,unsigned int length,int resync,int verbose);
 
+    /**
+     * Read message headers from memory buffer, without copying the payload.
+     * Message in buffer has no storage header. The payload of msg->datasize bytes
+     * is checked to be complete and starts in buffer after the serial header (if found),
+     * the resync offset and the message headers.
+     * @param msg pointer to structure of organising access to DLT messages
+     * @param buffer pointer to memory buffer
+     * @param length length of message in buffer
+     * @param resync if set to true resync to serial header is enforced
+     * @param verbose if set to true verbose information is printed out.
+     * @return negative value if there was an error
+     */
+    int dlt_message_read_header(DltMessage *msg,uint8_t *buffer,unsigned int length,int resync,int verbose);
+
+    /**
+     * Read message from memory buffer, without copying the payload.
+     * Message in buffer has no storage header. msg->databuffer points to the payload
+     * in buffer and stays valid as long as the buffer is not changed, msg->databuffersize
+     * is set to 0. The message must not own a payload buffer before and must not be
+     * freed with dlt_message_free() afterwards.
+     * @param msg pointer to structure of organising access to DLT messages
+     * @param buffer pointer to memory buffer
+     * @param length length of message in buffer
+     * @param resync if set to true resync to serial header is enforced
+     * @param verbose if set to true verbose information is printed out.
+     * @return negative value if there was an error
+     */
+    int dlt_message_read_view(DltMessage *msg,uint8_t *buffer,unsigned int length,int resync,int verbose);
+
     /**
      * Get standard header extra parameters
      * @param msg pointer to structure of organising access to DLT messages
@@ -965,6 +1030,18 @@ extern "C"
      * @return 0 = message does not match filter, 1 = message was read, negative value if there was an error
      */
     DltReturnValue dlt_file_read_raw(DltFile *file,int resync,int verbose);
+    /**
+     * Find and parse all remaining messages in the DLT file, using several threads.
+     * The mapped file is split into chunks, which are resynchronised to the
+     * storage header pattern, indexed and filtered concurrently and appended
+     * to the index in order. The result is the same as calling dlt_file_read()
+     * until it fails.
+     * @param file pointer to structure of organising access to DLT file
+     * @param threads number of threads, 0 to use one per online CPU
+     * @param verbose if set to true verbose information is printed out.
+     * @return negative value if there was an error
+     */
+    DltReturnValue dlt_file_read_parallel(DltFile *file,int threads,int verbose);
     /**
      * Closing loading a DLT file.
      * @param file pointer to structure of organising access to DLT file
@@ -1013,6 +1090,53 @@ extern "C"
      * @return number of messages loaded, negative value if there was an error
      */
     DltReturnValue dlt_file_message(DltFile *file,int index,int verbose);
+    /**
+     * Get a view of a message selected by the index from the mapped file, without
+     * changing the state of the file. May be called from several threads as long as
+     * the file is not read at the same time. The headers are copied to msg, the payload
+     * stays in the mapping, see dlt_message_read_view().
+     * @param file pointer to structure of organising access to DLT file
+     * @param index position of message in the files beginning from zero
+     * @param msg message to be set
+     * @param verbose if set to true verbose information is printed out.
+     * @return negative value if there was an error or the file is not mapped
+     */
+    DltReturnValue dlt_file_message_view(DltFile *file,int index,DltMessage *msg,int verbose);
+    /**
+     * Get the position of a message in the file.
+     * If filters are set, index is based on the filtered list.
+     * @param file pointer to structure of organising access to DLT file
+     * @param index position of message in the files beginning from zero
+     * @return file position of the message, negative value if there was an error
+     */
+    long dlt_file_index_position(DltFile *file,int32_t index);
+    /**
+     * Check if the DLT file is mapped, which dlt_file_message_view() needs.
+     * @param file pointer to structure of organising access to DLT file
+     * @return 1 if the file is mapped, 0 otherwise
+     */
+    int dlt_file_is_mapped(DltFile *file);
+    /**
+     * Store the index of a DLT file in an index file.
+     * The index file is only valid for the current size and modification time
+     * of the DLT file and the filters set.
+     * @param file pointer to structure of organising access to DLT file
+     * @param filename filename of index file
+     * @param verbose if set to true verbose information is printed out.
+     * @return negative value if there was an error
+     */
+    DltReturnValue dlt_file_index_save(DltFile *file,const char *filename,int verbose);
+    /**
+     * Load the index of an opened DLT file from an index file instead of
+     * reading all messages with dlt_file_read().
+     * Fails if the index file does not belong to the current content of the
+     * DLT file or to the filters set.
+     * @param file pointer to structure of organising access to DLT file
+     * @param filename filename of index file
+     * @param verbose if set to true verbose information is printed out.
+     * @return negative value if there was an error
+     */
+    DltReturnValue dlt_file_index_load(DltFile *file,const char *filename,int verbose);
     /**
      * Free the used memory by the organising structure of file.
      * @param file pointer to structure of organising access to DLT file
@@ -1109,6 +1233,13 @@ extern "C"
      * @return negative value if there was an error
      */
     DltReturnValue dlt_receiver_move_to_begin(DltReceiver *receiver);
+    /**
+     * Enlarge receive buffer, received data is kept
+     * @param receiver pointer to dlt receiver structure
+     * @param buffersize new size of receive buffer, smaller sizes are ignored
+     * @return negative value if there was an error
+     */
+    DltReturnValue dlt_receiver_grow(DltReceiver *receiver, int32_t buffersize);
 
     /**
      * Check whether to_get amount of data is available in receiver and
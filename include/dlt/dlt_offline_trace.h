@@ -58,6 +58,7 @@
 #define DLT_OFFLINE_TRACE_H
 
 #include <limits.h>
+#include <pthread.h>
 
 #include "dlt_types.h"
 
@@ -71,6 +72,23 @@
                                           sizeof(DLT_OFFLINETRACE_FILENAME_DELI) + \
                                           DLT_OFFLINETRACE_INDEX_MAX_SIZE + \
                                           sizeof(DLT_OFFLINETRACE_FILENAME_EXT) + 1)
+/* buffered data is written in multiples of this size, relative to the file start */
+#define DLT_OFFLINETRACE_WRITE_ALIGN 4096
+/* number of entries of the file list allocated at first, doubled if full */
+#define DLT_OFFLINETRACE_FILES_ALLOC 64
+
+typedef struct
+{
+    char name[NAME_MAX + 1];     /**< (String) Filename without directory */
+    unsigned long size;          /**< Size of the file in bytes */
+} DltOfflineTraceFile;
+
+/* deleted file waiting to be removed by the remover thread */
+typedef struct DltOfflineTraceRemoval
+{
+    struct DltOfflineTraceRemoval *next;
+    char filename[PATH_MAX + 1];
+} DltOfflineTraceRemoval;
 
 typedef struct
 {
@@ -80,13 +98,36 @@ typedef struct
     int  maxSize;                /**< (int) Maximum size of all trace files (Default: 4000000) */
     int  filenameTimestampBased; /**< (int) timestamp based or index based (Default: 1 Timestamp based) */
     int ohandle;
+    int  fileOffset;             /**< (int) Bytes written and buffered for the current file */
+    unsigned char *buffer;       /**< Staging buffer, NULL if every message is written directly */
+    int  bufferSize;             /**< (int) Size of the staging buffer */
+    int  bufferUsed;             /**< (int) Bytes in the staging buffer */
+    int  flushInterval;          /**< (int) Maximum time in ms data stays in the staging buffer */
+    uint32_t bufferTime;         /**< Uptime when the oldest buffered data was added, in 0.1 ms */
+    DltOfflineTraceFile *files;  /**< Files of the offline trace, oldest first, ring of filesMax entries */
+    int  filesFirst;             /**< (int) Entry of the oldest file */
+    int  filesNum;               /**< (int) Number of files */
+    int  filesMax;               /**< (int) Number of allocated entries */
+    unsigned long totalSize;     /**< Size of all files in bytes */
+    unsigned int fileIndex;      /**< Index of the newest file, if filenames are index based */
+    pthread_t remover;           /**< Thread removing deleted files */
+    int  removerRunning;         /**< (int) Remover thread was started */
+    int  removerStop;            /**< (int) Request to terminate the remover thread */
+    pthread_mutex_t removerMutex;
+    pthread_cond_t removerCond;
+    DltOfflineTraceRemoval *removeFirst; /**< Files to be removed, oldest first */
+    DltOfflineTraceRemoval *removeLast;
+    DltOfflineTraceRemoval *removing;    /**< File currently removed by the thread */
 } DltOfflineTrace;
 
 /**
  * Initialise the offline trace
  * This function call opens the currently used log file.
+ * The list of offline trace files is read from the directory during startup
+ * and updated when files are created or deleted afterwards.
  * A check of the complete size of the offline trace is done during startup.
  * Old files are deleted, if there is not enough space left to create new file.
+ * Deleted files are removed from the directory by a background thread.
  * This function must be called before using further offline trace functions.
  * @param trace pointer to offline trace structure
  * @param directory directory where to store offline trace files
@@ -97,9 +138,38 @@ typedef struct
  */
 extern DltReturnValue dlt_offline_trace_init(DltOfflineTrace *trace,const char *directory,int fileSize,int maxSize,int filenameTimestampBased);
 
+/**
+ * Enable buffering of the offline trace
+ * Messages are collected in a staging buffer and written in large chunks,
+ * when the buffer is full or the oldest buffered message reaches the flush interval.
+ * Must be called after dlt_offline_trace_init.
+ * @param trace pointer to offline trace structure
+ * @param bufferSize size of the staging buffer in bytes, 0 writes every message directly
+ * @param flushInterval maximum time in ms a message stays unwritten
+ * @return negative value if there was an error
+ */
+extern DltReturnValue dlt_offline_trace_set_buffer(DltOfflineTrace *trace, int bufferSize, int flushInterval);
+
+/**
+ * Write all buffered data to the current log file
+ * @param trace pointer to offline trace structure
+ * @return negative value if there was an error
+ */
+extern DltReturnValue dlt_offline_trace_flush(DltOfflineTrace *trace);
+
+/**
+ * Write buffered data which would exceed the flush interval before the next check
+ * To be called periodically, so that data is also written without new messages.
+ * @param trace pointer to offline trace structure
+ * @param period time in ms until the next check
+ * @return negative value if there was an error
+ */
+extern DltReturnValue dlt_offline_trace_flush_due(DltOfflineTrace *trace, int period);
+
 /**
  * Uninitialise the offline trace
- * This function call closes currently used log file.
+ * This function call writes buffered data and closes currently used log file.
+ * It waits until all deleted files are removed.
  * This function must be called after usage of offline trace
  * @param trace pointer to offline trace structure
  * @return negative value if there was an error
@@ -123,7 +193,8 @@ extern DltReturnValue dlt_offline_trace_free(DltOfflineTrace *buf);
 extern DltReturnValue dlt_offline_trace_write(DltOfflineTrace *trace,unsigned char *data1,int size1,unsigned char *data2,int size2,unsigned char *data3,int size3);
 
 /**
- * Get size of currently used offline trace buffer
+ * Get size of all offline trace files, as kept in the file list
+ * The currently used log file is counted with its size when it was opened.
  * @return size in bytes
  */
 extern unsigned long dlt_offline_trace_get_total_size(DltOfflineTrace *trace);
@@ -203,6 +203,7 @@
 #define DLT_SERVICE_ID_PASSIVE_NODE_CONNECTION_STATUS 0xf0F /**< Service ID: Passive Node status information */
 #define DLT_SERVICE_ID_SET_ALL_LOG_LEVEL              0xf10 /**< Service ID: set all log level */
 #define DLT_SERVICE_ID_SET_ALL_TRACE_STATUS           0xf11 /**< Service ID: Set all trace status */
+#define DLT_SERVICE_ID_SET_CLIENT_FILTER              0xf12 /**< Service ID: Set filter of the requesting client */
 #define DLT_SERVICE_ID_CALLSW_CINJECTION              0xFFF /**< Service ID: Message Injection (minimal ID) */
 
 /*
@@ -59,60 +59,91 @@
 
 #include "dlt_common.h"
 
-/* shared memory key */
-/* must be the same for server and cleint */
-#define DLT_SHM_KEY    11771
+/* default size of the ring of one producing thread, must be a power of two */
+/* may be overwritten by the application with DLT_USER_ENV_SHM_RING_SIZE */
+#define DLT_SHM_RING_SIZE   65536
 
-/* default size of shared memory */
-/* size is extended during creation to fit segment size */
-/* client retreives real size from shm buffer */
-#define DLT_SHM_SIZE   100000
+/* default maximum size of a ring accepted by the daemon */
+#define DLT_SHM_SIZE        1048576
 
-/* Id of the used semaphore */
-/* used for synchronisation of write and read access of multiple clients and server */
-/* must be the same for server and client */
-#define DLT_SHM_SEM    22771
+/* smallest ring size accepted by client and server */
+#define DLT_SHM_RING_MIN_SIZE 4096
 
-#define DLT_SHM_HEAD   "SHM"
+/* magic value at the beginning of each ring */
+#define DLT_SHM_RING_MAGIC  0x444c5452 /* "DLTR" */
 
-typedef struct
-{
-    int shmid;        /* Id of shared memory */
-    int semid;        /* Id of semaphore */
-    DltBuffer buffer;
-} DltShm;
+/* record length marking the unused end of the ring, reader continues at 0 */
+#define DLT_SHM_RING_PAD    0xffffffffu
+
+/* ring flags */
+#define DLT_SHM_RING_CLOSED 0x1 /* producer is gone, ring can be released */
+
+/* alignment of records in the ring */
+#define DLT_SHM_RING_ALIGN  8
+
+/* size of a cache line, used to keep head and tail apart */
+#define DLT_SHM_CACHE_LINE  64
 
+/**
+ * Header at the beginning of the shared ring.
+ *
+ * The ring is a single producer single consumer queue. head is only written
+ * by the producing thread of the application, tail is only written by the
+ * daemon. Both are free running byte counters, the used size of the ring is
+ * head - tail. Each record consists of a 32 bit length followed by the data,
+ * padded to DLT_SHM_RING_ALIGN. A record never wraps, instead the remaining
+ * bytes at the end of the ring are skipped with a DLT_SHM_RING_PAD record.
+ */
 typedef struct
 {
-    char head[4];
-    unsigned char status;
-    int size;
-} DltShmBlockHead;
+    uint32_t magic;        /**< DLT_SHM_RING_MAGIC */
+    uint32_t size;         /**< size of the data area in bytes */
+    uint32_t flags;        /**< DLT_SHM_RING_CLOSED */
+    uint32_t dropped;      /**< messages the producer could not write */
+    char pad0[DLT_SHM_CACHE_LINE - 4 * sizeof(uint32_t)];
+    uint32_t head;         /**< write position, written by producer */
+    char pad1[DLT_SHM_CACHE_LINE - sizeof(uint32_t)];
+    uint32_t tail;         /**< read position, written by consumer */
+    char pad2[DLT_SHM_CACHE_LINE - sizeof(uint32_t)];
+} DltShmRingHead;
 
-#define DLT_SHM_SEM_GET(id) dlt_shm_pv(id,-1)
-#define DLT_SHM_SEM_FREE(id) dlt_shm_pv(id,1)
+typedef struct DltShm
+{
+    int memfd;              /**< memfd backing the ring, -1 if closed */
+    int eventfd;            /**< doorbell of the daemon, -1 if closed */
+    int owner;              /**< daemon: application socket the ring belongs to */
+    pid_t pid;              /**< process which created the ring */
+    uint32_t size;          /**< local copy of the data area size */
+    uint32_t current;       /**< consumer: size of the record returned by dlt_shm_copy */
+    DltShmRingHead *head;   /**< mapped ring header, NULL if not mapped */
+    unsigned char *data;    /**< data area following the ring header */
+    struct DltShm *next;    /**< daemon: list of registered rings */
+} DltShm;
 
 /**
- * Initialise the shared memory on the client side.
- * This function must be called before using further shm functions.
+ * Create a new ring on the client side.
+ * The ring is backed by a sealed memfd, the doorbell is a new eventfd.
+ * Both file descriptors have to be handed over to the daemon afterwards.
  * @param buf pointer to shm structure
- * @param key the identifier of the shm, must be the same for server and client
+ * @param size size of the data area, rounded up to a power of two
  * @return negative value if there was an error
  */
-extern DltReturnValue dlt_shm_init_client(DltShm *buf,int key);
+extern DltReturnValue dlt_shm_init_client(DltShm *buf, int size);
 
 /**
- * Initialise the shared memory on the server side.
- * This function must be called before using further shm functions.
+ * Map a ring received from an application on the server side.
+ * buf->memfd and buf->eventfd must be set. The memfd is closed after
+ * mapping, the eventfd stays open and is owned by the caller.
  * @param buf pointer to shm structure
- * @param key the identifier of the shm, must be the same for server and client
- * @param size the requested size of the shm
+ * @param max_size maximum size of the data area accepted
  * @return negative value if there was an error
  */
-extern DltReturnValue dlt_shm_init_server(DltShm *buf,int key,int size);
+extern DltReturnValue dlt_shm_init_server(DltShm *buf, int max_size);
 
 /**
- * Push data from client onto the shm.
+ * Push a message from the client onto the ring.
+ * Only the thread owning the ring may call this function. No system call is
+ * done, except for ringing the doorbell when the ring was empty before.
  * @param buf pointer to shm structure
  * @param data1 pointer to first data block to be written, null if not used
  * @param size1 size in bytes of first data block to be written, 0 if not used
@@ -120,100 +151,113 @@ extern DltReturnValue dlt_shm_init_server(DltShm *buf,int key,int size);
  * @param size2 size in bytes of second data block to be written, 0 if not used
  * @param data3 pointer to third data block to be written, null if not used
  * @param size3 size in bytes of third data block to be written, 0 if not used
- * @return negative value if there was an error
+ * @return DLT_RETURN_OK, DLT_RETURN_BUFFER_FULL if the ring is full or negative value if there was an error
  */
-extern int dlt_shm_push(DltShm *buf,const unsigned char *data1,unsigned int size1,const unsigned char *data2,unsigned int size2,const unsigned char *data3,unsigned int size3);
+extern DltReturnValue dlt_shm_push(DltShm *buf,const unsigned char *data1,unsigned int size1,const unsigned char *data2,unsigned int size2,const unsigned char *data3,unsigned int size3);
 
 /**
- * Pull data from shm.
- * This function should be called from client.
- * Data is deleted from shm after this call.
+ * Copy the next message from the ring into a local buffer.
+ * This function should be called from server.
+ * The message is only copied, it stays in the ring until dlt_shm_remove() is
+ * called. Only the copy may be parsed, the application can still modify the
+ * ring. If the message is larger than max_size, only max_size bytes are copied.
  * @param buf pointer to shm structure
- * @param data pointer to buffer where data is to be written
- * @param size maximum size to be written into buffer
- * @return negative value if there was an error
+ * @param data pointer to buffer where the message is copied to
+ * @param max_size size of the buffer
+ * @return size of the message, 0 if the ring is empty, negative value if the ring is corrupted
  */
-extern int dlt_shm_pull(DltShm *buf,unsigned char *data, int size);
+extern int dlt_shm_copy(DltShm *buf, unsigned char *data, int max_size);
 
 /**
- * Copy message from shm.
+ * Delete the message returned by dlt_shm_copy() from the ring.
  * This function should be called from server.
- * Data is not deleted from shm after this call.
  * @param buf pointer to shm structure
- * @param data pointer to buffer where data is to be written
- * @param size maximum size to be written into buffer
  * @return negative value if there was an error
  */
-extern int dlt_shm_copy(DltShm *buf,unsigned char *data, int size);
+extern DltReturnValue dlt_shm_remove(DltShm *buf);
 
 /**
- * Delete message from shm.
- * This function should be called from server.
- * This function should be called after each succesful copy.
+ * Drop all messages in the ring.
+ * This function should be called from server if the ring is corrupted.
  * @param buf pointer to shm structure
  * @return negative value if there was an error
  */
-extern int dlt_shm_remove(DltShm *buf);
+extern DltReturnValue dlt_shm_reset(DltShm *buf);
 
 /**
- * Print information about shm.
+ * Clear the doorbell of the ring.
+ * Must be called by the server before the ring is drained.
  * @param buf pointer to shm structure
  */
-extern void dlt_shm_info(DltShm *buf);
+extern void dlt_shm_ack(DltShm *buf);
 
 /**
- * Print status about shm.
+ * Ring the doorbell of the ring.
  * @param buf pointer to shm structure
  */
-extern void dlt_shm_status(DltShm *buf);
+extern void dlt_shm_notify(DltShm *buf);
 
 /**
- * Deinitialise the shared memory on the client side.
+ * Mark the ring as closed by the producer and ring the doorbell.
+ * The daemon drains and releases the ring afterwards.
  * @param buf pointer to shm structure
- * @return negative value if there was an error
  */
-extern DltReturnValue dlt_shm_free_client(DltShm *buf);
+extern void dlt_shm_close(DltShm *buf);
 
 /**
- * Returns the total size of the shm.
+ * Check if the producer closed the ring.
  * @param buf pointer to shm structure
- * @return size of the shared memory.
+ * @return 1 if closed, 0 otherwise
  */
-extern int dlt_shm_get_total_size(DltShm *buf);
+extern int dlt_shm_is_closed(DltShm *buf);
 
 /**
- * Returns the used size in the shm.
+ * Print information about shm.
  * @param buf pointer to shm structure
- * @return size of the shared memory.
  */
-extern int dlt_shm_get_used_size(DltShm *buf);
+extern void dlt_shm_info(DltShm *buf);
 
 /**
- * Returns the number of messages in the shm.
+ * Print status about shm.
  * @param buf pointer to shm structure
- * @return size of the shared memory.
  */
-extern int dlt_shm_get_message_count(DltShm *buf);
+extern void dlt_shm_status(DltShm *buf);
 
 /**
- * Reset pointers and counters when shm corrupted.
+ * Returns the total size of the ring.
  * @param buf pointer to shm structure
  * @return size of the shared memory.
  */
-extern int dlt_shm_reset(DltShm *buf);
+extern int dlt_shm_get_total_size(DltShm *buf);
 
 /**
- * Recover to find next valid message.
+ * Returns the used size in the ring.
  * @param buf pointer to shm structure
- * @return size of the shared memory.
+ * @return used size of the shared memory.
  */
-extern int dlt_shm_recover(DltShm *buf);
+extern int dlt_shm_get_used_size(DltShm *buf);
+
+/**
+ * Returns the number of messages the producer had to drop.
+ * @param buf pointer to shm structure
+ * @return number of dropped messages.
+ */
+extern int dlt_shm_get_dropped_count(DltShm *buf);
+
+/**
+ * Unmap the ring and close all descriptors on the client side.
+ * The ring is not marked as closed, call dlt_shm_close() before if needed.
+ * @param buf pointer to shm structure
+ * @return negative value if there was an error
+ */
+extern DltReturnValue dlt_shm_free_client(DltShm *buf);
 
 /**
- * Deinitialise the shared memory on the server side.
+ * Unmap the ring on the server side.
+ * The eventfd is not closed, it is owned by the caller.
  * @param buf pointer to shm structure
  * @return negative value if there was an error
  */
-extern int dlt_shm_free_server(DltShm *buf);
+extern DltReturnValue dlt_shm_free_server(DltShm *buf);
 
 #endif /* DLT_SHM_H */
@@ -228,7 +228,7 @@ typedef struct
     dlt_env_ll_set initial_ll_set;
 
 #ifdef DLT_SHM_ENABLE
-    DltShm dlt_shm;
+    int shm_ring_size;                         /**< Size of the shared memory ring of each thread */
 #endif
 #ifdef DLT_TEST_ENABLE
     int corrupt_user_header;
@@ -461,6 +461,18 @@ DltReturnValue dlt_user_trace_network_segmented(DltContext *handle, DltNetworkTr
  */
 DltReturnValue dlt_init();
 
+/**
+ * Initialize the user lib communication with daemon in asynchronous mode.
+ * Log calls only copy the message into a buffer, a flusher thread sends
+ * the buffered messages in batches to the daemon. The same mode can be
+ * enabled by setting the environment variable DLT_USER_ASYNC=1.
+ * This function has to be called first, before using any DLT user lib functions.
+ * @param watermark fill level in bytes which triggers sending, 0 for default
+ * @param latency maximum time in ms a message is buffered, 0 for default
+ * @return Value from DltReturnValue enum
+ */
+DltReturnValue dlt_init_async(uint32_t watermark, uint32_t latency);
+
 /**
  * Initialize the user lib writing only to file.
  * This function has to be called first, before using any DLT user lib functions.
@@ -85,11 +85,49 @@
 #include <fcntl.h>
 
 #include <sys/uio.h> /* writev() */
+#include <pthread.h>
 
 #include "dlt_common.h"
 
 #define DLT_CONVERT_TEXTBUFSIZE  10024   /* Size of buffer for text output */
 
+#define DLT_CONVERT_BATCH_SIZE   1024    /* Number of messages decoded at once by a thread */
+
+#define DLT_CONVERT_MAX_THREADS  64      /* Maximum number of decoding threads */
+
+/* messages of a batch, decoded by a worker and written in order by the main thread */
+typedef struct
+{
+    char *text;                               /* printed messages */
+    size_t used;
+    size_t size;
+    struct iovec iov[DLT_CONVERT_BATCH_SIZE]; /* messages for the output file */
+    int count;
+    int done;
+} DltConvertBatch;
+
+typedef struct
+{
+    DltFile *file;
+    int aflag;
+    int sflag;
+    int xflag;
+    int mflag;
+    int vflag;
+    int ohandle;                              /* -1 if no output file */
+    int threads;
+    int begin;
+    int end;
+    int num_batches;
+    int next;                                 /* next batch to be decoded */
+    int written;                              /* number of batches written */
+    int failed;
+    DltConvertBatch *batch;                   /* window of 2 batches per thread */
+    int window;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+} DltConvert;
+
 /**
  * Print usage information of tool.
  */
@@ -119,6 +157,303 @@ void usage()
     printf("  -b number     First messages to be handled\n");
     printf("  -e number     Last message to be handled\n");
     printf("  -w            Follow dlt file while file is increasing\n");
+    printf("  -i            Load index from file%s, or create it\n", DLT_FILE_INDEX_SUFFIX);
+    printf("  -t threads    Number of threads decoding messages (Default: one per CPU)\n");
+}
+
+/**
+ * Print and store the messages one after the other.
+ */
+int dlt_convert_serial(DltConvert *conv, int begin, int end)
+{
+    DltFile *file = conv->file;
+    char text[DLT_CONVERT_TEXTBUFSIZE];
+    struct iovec iov[2];
+    int bytes_written;
+    int num;
+
+    for (num = begin; num <= end ;num++)
+    {
+        dlt_file_message(file,num,conv->vflag);
+
+        if (conv->xflag)
+        {
+            printf("%d ",num);
+            dlt_message_print_hex(&(file->msg),text,DLT_CONVERT_TEXTBUFSIZE,conv->vflag);
+        }
+        else if (conv->aflag)
+        {
+            printf("%d ",num);
+
+            dlt_message_header(&(file->msg),text,DLT_CONVERT_TEXTBUFSIZE,conv->vflag);
+
+            printf("%s ",text);
+
+            dlt_message_payload(&file->msg,text,DLT_CONVERT_TEXTBUFSIZE,DLT_OUTPUT_ASCII,conv->vflag);
+
+            printf("[%s]\n",text);
+        }
+        else if (conv->mflag)
+        {
+            printf("%d ",num);
+            dlt_message_print_mixed_plain(&(file->msg),text,DLT_CONVERT_TEXTBUFSIZE,conv->vflag);
+        }
+        else if (conv->sflag)
+        {
+            printf("%d ",num);
+
+            dlt_message_header(&(file->msg),text,DLT_CONVERT_TEXTBUFSIZE,conv->vflag);
+
+            printf("%s \n",text);
+        }
+
+        /* if file output enabled write message */
+        if (conv->ohandle != -1)
+        {
+            iov[0].iov_base = file->msg.headerbuffer;
+            iov[0].iov_len = file->msg.headersize;
+            iov[1].iov_base = file->msg.databuffer;
+            iov[1].iov_len = file->msg.datasize;
+
+            bytes_written = writev(conv->ohandle, iov, 2);
+            if (0 > bytes_written){
+                    printf("in main: writev(ohandle, iov, 2); returned an error!" );
+                    return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int dlt_convert_append(DltConvertBatch *batch, const char *text, size_t length)
+{
+    char *buffer;
+    size_t size;
+
+    if (batch->used + length > batch->size)
+    {
+        size = batch->size ? batch->size : DLT_CONVERT_TEXTBUFSIZE;
+
+        while (size < batch->used + length)
+        {
+            size *= 2;
+        }
+
+        buffer = realloc(batch->text, size);
+
+        if (buffer == NULL)
+        {
+            return -1;
+        }
+
+        batch->text = buffer;
+        batch->size = size;
+    }
+
+    memcpy(batch->text + batch->used, text, length);
+    batch->used += length;
+
+    return 0;
+}
+
+/* print the messages of a batch to its buffer, like dlt_convert_serial() */
+static int dlt_convert_decode(DltConvert *conv, DltConvertBatch *batch, int first, int last)
+{
+    DltMessage msg;
+    char text[DLT_CONVERT_TEXTBUFSIZE];
+    char number[16];
+    int print = conv->xflag || conv->aflag || conv->mflag || conv->sflag;
+    int num;
+    int ret = 0;
+
+    batch->used = 0;
+    batch->count = 0;
+
+    dlt_message_init(&msg, 0);
+
+    for (num = first; (num <= last) && (ret == 0); num++)
+    {
+        if (dlt_file_message_view(conv->file, num, &msg, conv->vflag) < DLT_RETURN_OK)
+        {
+            return -1;
+        }
+
+        if (print)
+        {
+            ret |= dlt_convert_append(batch, number, snprintf(number, sizeof(number), "%d ", num));
+            dlt_message_header(&msg, text, DLT_CONVERT_TEXTBUFSIZE, conv->vflag);
+            ret |= dlt_convert_append(batch, text, strlen(text));
+        }
+
+        if (conv->xflag || conv->aflag || conv->mflag)
+        {
+            ret |= dlt_convert_append(batch, conv->mflag ? " \n[" : " [", conv->mflag ? 3 : 2);
+            dlt_message_payload(&msg, text, DLT_CONVERT_TEXTBUFSIZE,
+                                conv->xflag ? DLT_OUTPUT_HEX : (conv->aflag ? DLT_OUTPUT_ASCII : DLT_OUTPUT_MIXED_FOR_PLAIN),
+                                conv->vflag);
+            ret |= dlt_convert_append(batch, text, strlen(text));
+            ret |= dlt_convert_append(batch, "]\n", 2);
+        }
+        else if (conv->sflag)
+        {
+            ret |= dlt_convert_append(batch, " \n", 2);
+        }
+
+        /* the complete message is stored in the mapping in front of the payload */
+        if (conv->ohandle != -1)
+        {
+            batch->iov[batch->count].iov_base = msg.databuffer - msg.headersize;
+            batch->iov[batch->count].iov_len = msg.headersize + msg.datasize;
+            batch->count++;
+        }
+    }
+
+    return ret;
+}
+
+static void *dlt_convert_thread(void *arg)
+{
+    DltConvert *conv = (DltConvert *) arg;
+    DltConvertBatch *batch;
+    int first;
+    int num;
+    int ret;
+
+    while (1)
+    {
+        pthread_mutex_lock(&conv->mutex);
+
+        /* decode at most a window ahead of the written batches */
+        while ((conv->next < conv->num_batches) && (conv->next >= conv->written + conv->window) && !conv->failed)
+        {
+            pthread_cond_wait(&conv->cond, &conv->mutex);
+        }
+
+        if ((conv->next >= conv->num_batches) || conv->failed)
+        {
+            pthread_mutex_unlock(&conv->mutex);
+            return NULL;
+        }
+
+        num = conv->next++;
+        pthread_mutex_unlock(&conv->mutex);
+
+        batch = &conv->batch[num % conv->window];
+        first = conv->begin + num * DLT_CONVERT_BATCH_SIZE;
+        ret = dlt_convert_decode(conv, batch, first,
+                                 (first + DLT_CONVERT_BATCH_SIZE - 1 < conv->end) ? first + DLT_CONVERT_BATCH_SIZE - 1 : conv->end);
+
+        pthread_mutex_lock(&conv->mutex);
+        batch->done = 1;
+        conv->failed |= (ret != 0);
+        pthread_cond_broadcast(&conv->cond);
+        pthread_mutex_unlock(&conv->mutex);
+    }
+}
+
+/**
+ * Print and store the messages, decoded in batches by several threads and
+ * written in order. Falls back to dlt_convert_serial() if the file is not mapped.
+ */
+int dlt_convert_parallel(DltConvert *conv, int begin, int end)
+{
+    pthread_t tids[DLT_CONVERT_MAX_THREADS];
+    DltConvertBatch *batch;
+    int started = 0;
+    int ret = 0;
+    int num;
+    int i;
+
+    if ((conv->threads <= 1) || !dlt_file_is_mapped(conv->file) || (end - begin < DLT_CONVERT_BATCH_SIZE))
+    {
+        return dlt_convert_serial(conv, begin, end);
+    }
+
+    conv->begin = begin;
+    conv->end = end;
+    conv->num_batches = (end - begin) / DLT_CONVERT_BATCH_SIZE + 1;
+    conv->next = 0;
+    conv->written = 0;
+    conv->failed = 0;
+    conv->window = 2 * conv->threads;
+    conv->batch = calloc(conv->window, sizeof(DltConvertBatch));
+
+    if (conv->batch == NULL)
+    {
+        return dlt_convert_serial(conv, begin, end);
+    }
+
+    pthread_mutex_init(&conv->mutex, NULL);
+    pthread_cond_init(&conv->cond, NULL);
+
+    for (i = 0; i < conv->threads; i++)
+    {
+        if (pthread_create(&tids[started], NULL, dlt_convert_thread, conv) == 0)
+        {
+            started++;
+        }
+    }
+
+    if (started == 0)
+    {
+        ret = -1;
+        conv->failed = 1;
+    }
+
+    for (num = 0; (num < conv->num_batches) && (ret == 0); num++)
+    {
+        batch = &conv->batch[num % conv->window];
+
+        pthread_mutex_lock(&conv->mutex);
+        while (!batch->done && !conv->failed)
+        {
+            pthread_cond_wait(&conv->cond, &conv->mutex);
+        }
+        ret = batch->done ? 0 : -1;
+        pthread_mutex_unlock(&conv->mutex);
+
+        if (ret != 0)
+        {
+            fprintf(stderr, "ERROR: Messages could not be decoded!\n");
+            break;
+        }
+
+        if (batch->used > 0)
+        {
+            fwrite(batch->text, 1, batch->used, stdout);
+        }
+
+        if ((batch->count > 0) && (writev(conv->ohandle, batch->iov, batch->count) < 0))
+        {
+            printf("in main: writev(ohandle, iov, count); returned an error!" );
+            ret = -1;
+        }
+
+        pthread_mutex_lock(&conv->mutex);
+        batch->done = 0;
+        conv->written++;
+        conv->failed |= (ret != 0);
+        pthread_cond_broadcast(&conv->cond);
+        pthread_mutex_unlock(&conv->mutex);
+    }
+
+    for (i = 0; i < started; i++)
+    {
+        pthread_join(tids[i], NULL);
+    }
+
+    for (i = 0; i < conv->window; i++)
+    {
+        free(conv->batch[i].text);
+    }
+
+    free(conv->batch);
+    conv->batch = NULL;
+    pthread_mutex_destroy(&conv->mutex);
+    pthread_cond_destroy(&conv->cond);
+
+    return ret;
 }
 
 /**
@@ -133,29 +468,30 @@ int main(int argc, char* argv[])
     int xflag = 0;
     int mflag = 0;
     int wflag = 0;
+    int iflag = 0;
     char *fvalue = 0;
     char *bvalue = 0;
     char *evalue = 0;
     char *ovalue = 0;
+    char *tvalue = 0;
 
     int index;
     int c;
 
+    char iname[PATH_MAX + 1];
+
 	DltFile file;
 	DltFilter filter;
 
 	int ohandle=-1;
 
-	int num, begin, end;
+	int begin, end;
 
-	char text[DLT_CONVERT_TEXTBUFSIZE];
-
-	struct iovec iov[2];
-    int bytes_written;
+	DltConvert conv;
 
     opterr = 0;
 
-    while ((c = getopt (argc, argv, "vcashxmwf:b:e:o:")) != -1)
+    while ((c = getopt (argc, argv, "vcashxmwif:b:e:o:t:")) != -1)
         switch (c)
         {
         case 'v':
@@ -193,6 +529,11 @@ int main(int argc, char* argv[])
             	wflag = 1;
             	break;
 			}
+        case 'i':
+			{
+            	iflag = 1;
+            	break;
+			}
         case 'h':
 			{
             	usage();
@@ -218,9 +559,14 @@ int main(int argc, char* argv[])
             	ovalue = optarg;
             	break;
 			}
+        case 't':
+			{
+            	tvalue = optarg;
+            	break;
+			}
         case '?':
 			{
-		        if (optopt == 'f' || optopt == 'b' || optopt == 'e' || optopt == 'o')
+		        if (optopt == 'f' || optopt == 'b' || optopt == 'e' || optopt == 'o' || optopt == 't')
 				{
 		            fprintf (stderr, "Option -%c requires an argument.\n", optopt);
 				}
@@ -247,6 +593,7 @@ int main(int argc, char* argv[])
     dlt_file_init(&file,vflag);
 
     /* first parse filter file if filter parameter is used */
+    dlt_filter_init(&filter,vflag);
     if (fvalue)
     {
         if (dlt_filter_load(&filter,fvalue,vflag) < DLT_RETURN_OK)
@@ -270,13 +617,36 @@ int main(int argc, char* argv[])
 
     }
 
+    memset(&conv, 0, sizeof(conv));
+    conv.file = &file;
+    conv.aflag = aflag;
+    conv.sflag = sflag;
+    conv.xflag = xflag;
+    conv.mflag = mflag;
+    conv.vflag = vflag;
+    conv.ohandle = ohandle;
+    conv.threads = tvalue ? atoi(tvalue) : sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (conv.threads > DLT_CONVERT_MAX_THREADS)
+    {
+        conv.threads = DLT_CONVERT_MAX_THREADS;
+    }
+
     for (index = optind; index < argc; index++)
     {
         /* load, analyse data file and create index list */
         if (dlt_file_open(&file,argv[index],vflag) >= DLT_RETURN_OK)
         {
-            while (dlt_file_read(&file,vflag) >= DLT_RETURN_OK)
+            snprintf(iname, sizeof(iname), "%s%s", argv[index], DLT_FILE_INDEX_SUFFIX);
+
+            if (!iflag || dlt_file_index_load(&file,iname,vflag) < DLT_RETURN_OK)
             {
+                dlt_file_read_parallel(&file,0,vflag);
+
+                if (iflag)
+                {
+                    dlt_file_index_save(&file,iname,vflag);
+                }
             }
         }
 
@@ -310,76 +680,36 @@ int main(int argc, char* argv[])
                 fprintf(stderr,"ERROR: Selected end message %d is out of range!\n",end);
                 return -1;
             }
-            for (num = begin; num <= end ;num++)
+            while (1)
             {
-                dlt_file_message(&file,num,vflag);
-
-                if (xflag)
+                if (dlt_convert_parallel(&conv, begin, end) < 0)
                 {
-                    printf("%d ",num);
-                    dlt_message_print_hex(&(file.msg),text,DLT_CONVERT_TEXTBUFSIZE,vflag);
+                    dlt_file_free(&file,vflag);
+                    return -1;
                 }
-                else if (aflag)
-                {
-                    printf("%d ",num);
-
-                    dlt_message_header(&(file.msg),text,DLT_CONVERT_TEXTBUFSIZE,vflag);
 
-                    printf("%s ",text);
-
-                    dlt_message_payload(&file.msg,text,DLT_CONVERT_TEXTBUFSIZE,DLT_OUTPUT_ASCII,vflag);
-
-                    printf("[%s]\n",text);
-                }
-                else if (mflag)
+                if (wflag == 0)
                 {
-                    printf("%d ",num);
-                    dlt_message_print_mixed_plain(&(file.msg),text,DLT_CONVERT_TEXTBUFSIZE,vflag);
-                }
-                else if (sflag)
-                {
-                    printf("%d ",num);
-
-                    dlt_message_header(&(file.msg),text,DLT_CONVERT_TEXTBUFSIZE,vflag);
-
-                    printf("%s \n",text);
-                }
-
-                /* if file output enabled write message */
-                if (ovalue)
-                {
-                    iov[0].iov_base = file.msg.headerbuffer;
-                    iov[0].iov_len = file.msg.headersize;
-                    iov[1].iov_base = file.msg.databuffer;
-                    iov[1].iov_len = file.msg.datasize;
-
-                    bytes_written = writev(ohandle, iov, 2);
-                    if (0 > bytes_written){
-                            printf("in main: writev(ohandle, iov, 2); returned an error!" );
-                            dlt_file_free(&file,vflag);
-                            return -1;
-                    }
+                    break;
                 }
 
                 /* check for new messages if follow flag set */
-                if (wflag && num==end)
+                while (1)
                 {
-                    while (1)
+                    while (dlt_file_read(&file,0)>=0)
+                    {
+                    }
+                    if (end == (file.counter-1))
+                    {
+                        /* Sleep if no new message was received */
+                        sleep(1);
+                    }
+                    else
                     {
-                        while (dlt_file_read(&file,0)>=0)
-                        {
-                        }
-                        if (end == (file.counter-1))
-						{
-                            /* Sleep if no new message was received */
-                            sleep(1);
-                        }
-						else
-                        {
-                            /* set new end of log file and continue reading */
-                            end = file.counter-1;
-                            break;
-                        }
+                        /* set new end of log file and continue reading */
+                        begin = end + 1;
+                        end = file.counter-1;
+                        break;
                     }
                 }
             }
@@ -406,6 +736,7 @@ int main(int argc, char* argv[])
     }
 
     dlt_file_free(&file,vflag);
+    dlt_filter_free(&filter,vflag);
 
     return 0;
 }
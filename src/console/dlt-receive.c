@@ -86,8 +86,15 @@
 
 #define DLT_RECEIVE_ECU_ID "RECV"
 
+#define DLT_RECEIVE_FILTER_MAX 32768 /* Maximum size of a filter file sent to the daemon */
+
+#define DLT_RECEIVE_BUFSIZE (1024*1024) /* Size of receive buffer */
+
+#define DLT_RECEIVE_IOV_MAX 1024 /* Maximum number of buffers written at once, two per message */
+
 /* Function prototypes */
 int dlt_receive_message_callback(DltMessage *message, void *data);
+int dlt_receive_chunk_callback(void *data);
 
 typedef struct {
     int aflag;
@@ -106,6 +113,10 @@ typedef struct {
     int ohandle;
     int64_t totalbytes; /* bytes written so far into the output file, used to check the file size limit */
     int part_num;    /* number of current output file if limit was exceeded */
+    struct iovec iov[DLT_RECEIVE_IOV_MAX]; /* storage headers and messages of the received chunk */
+    DltStorageHeader storage[DLT_RECEIVE_IOV_MAX/2];
+    int iov_num;
+    int64_t pending; /* bytes in iov not written yet */
     DltFile file;
     DltFilter filter;
 } DltReceiveData;
@@ -137,7 +148,49 @@ void usage()
     printf("  -c limit      Restrict file size to <limit> bytes when output to file\n");
     printf("                When limit is reached, a new file is opened. Use K,M,G as\n");
     printf("                suffix to specify kilo-, mega-, giga-bytes respectively\n");
-    printf("  -f filename   Enable filtering of messages\n");
+    printf("  -f filename   Enable filtering of messages, the daemon sends only matching messages\n");
+}
+
+/**
+ * Read the text of a filter file to be sent to the daemon.
+ * @param filename filter file
+ * @return text to be freed by the caller, NULL on errors
+ */
+char *dlt_receive_read_filter(const char *filename)
+{
+    FILE *handle;
+    char *text;
+    long size;
+
+    handle = fopen(filename, "r");
+
+    if (handle == NULL)
+    {
+        return NULL;
+    }
+
+    if ((fseek(handle, 0, SEEK_END) != 0) ||
+        ((size = ftell(handle)) < 0) ||
+        (size > DLT_RECEIVE_FILTER_MAX) ||
+        (fseek(handle, 0, SEEK_SET) != 0))
+    {
+        fclose(handle);
+        return NULL;
+    }
+
+    text = malloc(size + 1);
+
+    if ((text == NULL) || (fread(text, 1, size, handle) != (size_t) size))
+    {
+        free(text);
+        fclose(handle);
+        return NULL;
+    }
+
+    text[size] = 0;
+    fclose(handle);
+
+    return text;
 }
 
 
@@ -295,6 +348,34 @@ void dlt_receive_close_output_file(DltReceiveData * dltdata)
     }
 }
 
+/*
+ * write the collected messages to the output file
+ */
+int dlt_receive_flush_output(DltReceiveData *dltdata)
+{
+    ssize_t bytes_written;
+
+    if (dltdata->iov_num == 0)
+    {
+        return 0;
+    }
+
+    bytes_written = writev(dltdata->ohandle, dltdata->iov, dltdata->iov_num);
+
+    dltdata->iov_num = 0;
+    dltdata->pending = 0;
+
+    if (0 > bytes_written)
+    {
+        printf("dlt_receive_flush_output: writev(dltdata->ohandle, dltdata->iov, dltdata->iov_num); returned an error!" );
+        return -1;
+    }
+
+    dltdata->totalbytes += bytes_written;
+
+    return 0;
+}
+
 
 /**
  * Main function of tool.
@@ -321,6 +402,8 @@ int main(int argc, char* argv[])
     dltdata.climit = -1; /* default: -1 = unlimited */
     dltdata.ohandle=-1;
     dltdata.totalbytes = 0;
+    dltdata.iov_num = 0;
+    dltdata.pending = 0;
     dltdata.part_num = -1;
 
     /* Fetch command line arguments */
@@ -435,6 +518,11 @@ int main(int argc, char* argv[])
     /* Register callback to be called when message was received */
     dlt_client_register_message_callback(dlt_receive_message_callback);
 
+    /* Register callback to write the messages of each received chunk at once */
+    dlt_client_register_chunk_callback(dlt_receive_chunk_callback);
+
+    dlt_client_set_receive_buffer_size(&dltclient, DLT_RECEIVE_BUFSIZE);
+
     /* Setup DLT Client structure */
     dltclient.mode = dltdata.yflag;
 
@@ -532,6 +620,18 @@ int main(int argc, char* argv[])
     /* Connect to TCP socket or open serial device */
     if (dlt_client_connect(&dltclient, dltdata.vflag) != DLT_RETURN_ERROR)
     {
+        /* let the daemon drop the messages not matching the filter */
+        if (dltdata.fvalue)
+        {
+            char *text = dlt_receive_read_filter(dltdata.fvalue);
+
+            if ((text == NULL) || (dlt_client_send_filter(&dltclient, text) < DLT_RETURN_OK))
+            {
+                fprintf(stderr, "WARNING: Filter could not be sent to the daemon\n");
+            }
+
+            free(text);
+        }
 
         /* Dlt Client Main Loop */
         dlt_client_main_loop(&dltclient, &dltdata, dltdata.vflag);
@@ -560,9 +660,6 @@ int dlt_receive_message_callback(DltMessage *message, void *data)
 	DltReceiveData *dltdata;
     static char text[DLT_RECEIVE_TEXTBUFSIZE];
 
-	struct iovec iov[2];
-    int bytes_written;
-
     if ((message==0) || (data==0))
 	{
         return -1;
@@ -611,42 +708,67 @@ int dlt_receive_message_callback(DltMessage *message, void *data)
             printf("%s \n",text);
         }
 
-        /* if file output enabled write message */
+        /* if file output enabled collect message, written once per received chunk */
         if (dltdata->ovalue)
         {
-            iov[0].iov_base = message->headerbuffer;
-            iov[0].iov_len = message->headersize;
-            iov[1].iov_base = message->databuffer;
-            iov[1].iov_len = message->datasize;
+            int64_t bytes_to_write = message->headersize + message->datasize;
 
             if (dltdata->climit > -1)
             {
-            	int bytes_to_write = message->headersize + message->datasize;
-            	
-            	if ((bytes_to_write + dltdata->totalbytes > dltdata->climit))
-            	{
+                if ((bytes_to_write + dltdata->pending + dltdata->totalbytes > dltdata->climit))
+                {
+                    if (dlt_receive_flush_output(dltdata) < 0)
+                    {
+                        return -1;
+                    }
+
                     dlt_receive_close_output_file(dltdata);
-                    
-            		if (dlt_receive_open_output_file(dltdata) < 0)
-            		{
+
+                    if (dlt_receive_open_output_file(dltdata) < 0)
+                    {
                         printf("ERROR: dlt_receive_message_callback: Unable to open log when maximum filesize was reached!\n");
                         return -1;
-            		}
-            		
-            		dltdata->totalbytes = 0;
-            	}
-            }
-            
-            bytes_written = writev(dltdata->ohandle, iov, 2);
+                    }
 
-            dltdata->totalbytes += bytes_written;
+                    dltdata->totalbytes = 0;
+                }
+            }
 
-            if (0 > bytes_written){
-                    printf("dlt_receive_message_callback: writev(dltdata->ohandle, iov, 2); returned an error!" );
-                    return -1;
+            if ((dltdata->iov_num + 2 > DLT_RECEIVE_IOV_MAX) && (dlt_receive_flush_output(dltdata) < 0))
+            {
+                return -1;
             }
+
+            /* the message without storage header is stored in front of the payload
+             * in the receive buffer and stays there until the chunk is written */
+            memcpy(&(dltdata->storage[dltdata->iov_num/2]), message->storageheader, sizeof(DltStorageHeader));
+            dltdata->iov[dltdata->iov_num].iov_base = &(dltdata->storage[dltdata->iov_num/2]);
+            dltdata->iov[dltdata->iov_num].iov_len = sizeof(DltStorageHeader);
+            dltdata->iov[dltdata->iov_num+1].iov_base = message->databuffer - (message->headersize - sizeof(DltStorageHeader));
+            dltdata->iov[dltdata->iov_num+1].iov_len = message->headersize - sizeof(DltStorageHeader) + message->datasize;
+            dltdata->iov_num += 2;
+            dltdata->pending += bytes_to_write;
         }
     }
 
     return 0;
 }
+
+int dlt_receive_chunk_callback(void *data)
+{
+    DltReceiveData *dltdata;
+
+    if (data==0)
+    {
+        return -1;
+    }
+
+    dltdata = (DltReceiveData*)data;
+
+    if (dltdata->ovalue)
+    {
+        return dlt_receive_flush_output(dltdata);
+    }
+
+    return 0;
+}
@@ -66,23 +66,64 @@
 #include <ctype.h>
 #include <stdarg.h>
 #include <time.h>
+#include <libgen.h>
 
 #include <sys/stat.h>
 #include <fcntl.h>
 
-#include <sys/uio.h> /* writev() */
-
 #include "dlt_common.h"
 
 #define DLT_VERBUFSIZE  255
 
-typedef struct sTimestampIndex {
-    int num;
-    uint32_t tmsp;
-} TimestampIndex;
+/* default memory used for sorting, in MB */
+#define DLT_SORT_DEFAULT_MEMORY 256
+
+/* maximum number of runs merged at once, more runs are merged in several passes */
+#define DLT_SORT_MAX_MERGE 64
+
+/* buffer sizes of the temporary run files */
+#define DLT_SORT_RUN_WRITE_BUFFER (1024 * 1024)
+#define DLT_SORT_RUN_READ_BUFFER_MIN (64 * 1024)
+
+/* buffer size of the output file */
+#define DLT_SORT_OUTPUT_BUFFER (1024 * 1024)
+
+/* order of messages */
+typedef struct sSortKey {
+    char ecu[DLT_ID_SIZE];  /* ECU id of storage header */
+    uint32_t seid;          /* session id, 0 if not available */
+    uint32_t tmsp;          /* timestamp */
+    uint32_t source;        /* input file */
+    int32_t num;            /* message number in input file */
+} SortKey;
+
+/* message in memory, while a run is built */
+typedef struct sSortEntry {
+    SortKey key;
+    size_t offset;          /* position of message in run buffer */
+    uint32_t size;
+} SortEntry;
+
+/* sorted sequence of messages, read during merging */
+typedef struct sSortSource {
+    SortKey key;            /* key of current message */
+    uint8_t *data;          /* current message */
+    uint32_t size;          /* size of current message */
+    uint32_t data_size;     /* allocated size of data */
+    int fd;                 /* temporary run file, -1 for input files */
+    FILE *run;
+    DltFile *file;          /* input file */
+    uint32_t source;        /* number of input file */
+    int32_t num;            /* next message of input file */
+    int32_t end;            /* last message of input file */
+    uint32_t tmsp;          /* timestamp of previous message */
+} SortSource;
 
 int verbosity = 0;
 
+/* compare ECU and session id before the timestamp */
+int merge_mode = 0;
+
 /**
  * Print information, conditional upon requested verbosity level
  */
@@ -114,53 +155,588 @@ void verbose(int level, char * msg, ...)
     }
 }
 
+/**
+ * Comparison of the keys of two messages.
+ * Messages with equal timestamps keep their order in the input.
+ */
+int compare_keys(const SortKey *a, const SortKey *b)
+{
+    int ret;
+
+    if (merge_mode)
+    {
+        ret = memcmp(a->ecu, b->ecu, DLT_ID_SIZE);
+
+        if (ret != 0)
+        {
+            return ret;
+        }
+
+        if (a->seid != b->seid)
+        {
+            return (a->seid > b->seid) ? 1 : -1;
+        }
+    }
+
+    if (a->tmsp != b->tmsp)
+    {
+        return (a->tmsp > b->tmsp) ? 1 : -1;
+    }
+
+    if (a->source != b->source)
+    {
+        return (a->source > b->source) ? 1 : -1;
+    }
+
+    if (a->num != b->num)
+    {
+        return (a->num > b->num) ? 1 : -1;
+    }
+
+    return 0;
+}
+
 /**
  * Comparison function for use with qsort
  */
-int compare_index_timestamps(const void* a, const void *b)
+int compare_entries(const void* a, const void *b)
 {
-    if (((TimestampIndex*)a)->tmsp > ((TimestampIndex*)b)->tmsp)
+    return compare_keys(&((SortEntry*)a)->key, &((SortEntry*)b)->key);
+}
+
+/**
+ * Get the key of the message loaded in the file.
+ * Messages without timestamp keep the timestamp of the previous message.
+ */
+void get_key(DltFile *file, uint32_t source, int32_t num, uint32_t *tmsp, SortKey *key)
+{
+    DltMessage *msg = &(file->msg);
+
+    memset(key, 0, sizeof(SortKey));
+    memcpy(key->ecu, msg->storageheader->ecu, DLT_ID_SIZE);
+
+    if (DLT_IS_HTYP_WSID(msg->standardheader->htyp))
+    {
+        key->seid = msg->headerextra.seid;
+    }
+
+    if (DLT_IS_HTYP_WTMS(msg->standardheader->htyp))
+    {
+        *tmsp = msg->headerextra.tmsp;
+    }
+
+    key->tmsp = *tmsp;
+    key->source = source;
+    key->num = num;
+}
+
+/**
+ * Copy the message loaded in the file
+ */
+void copy_message(DltFile *file, uint8_t *dest)
+{
+    memcpy(dest, file->msg.headerbuffer, file->msg.headersize);
+    memcpy(dest + file->msg.headersize, file->msg.databuffer, file->msg.datasize);
+}
+
+void write_failed(void)
+{
+    fprintf(stderr, "ERROR: Writing messages failed!\n");
+    exit(-1);
+}
+
+/**
+ * Write a message to the output file, or to a run file together with its key
+ */
+void write_message(FILE *out, int to_run, SortKey *key, uint8_t *data, uint32_t size)
+{
+    if (to_run &&
+        ((fwrite(key, sizeof(SortKey), 1, out) != 1) ||
+         (fwrite(&size, sizeof(size), 1, out) != 1)))
+    {
+        write_failed();
+    }
+
+    if (fwrite(data, size, 1, out) != 1)
+    {
+        write_failed();
+    }
+}
+
+/**
+ * Create an unlinked temporary file in the directory
+ * @return file descriptor, -1 on error
+ */
+int create_run(const char *tmpdir)
+{
+    char name[PATH_MAX];
+    int fd;
+
+    snprintf(name, sizeof(name), "%s/dlt-sortbytimestamp-XXXXXX", tmpdir);
+    fd = mkstemp(name);
+
+    if (fd == -1)
+    {
+        fprintf(stderr, "ERROR: Temporary file in %s cannot be created!\n", tmpdir);
+        return -1;
+    }
+
+    unlink(name);
+
+    return fd;
+}
+
+/**
+ * Get the next message of a source
+ * @return 1 if a message was read, 0 at the end, -1 on error
+ */
+int source_next(SortSource *src)
+{
+    uint32_t size;
+    uint8_t *data;
+
+    if (src->run)
+    {
+        if ((fread(&src->key, sizeof(SortKey), 1, src->run) != 1) ||
+            (fread(&size, sizeof(size), 1, src->run) != 1))
+        {
+            return ferror(src->run) ? -1 : 0;
+        }
+    }
+    else
+    {
+        if (src->num > src->end)
+        {
+            return 0;
+        }
+
+        if (dlt_file_message(src->file, src->num, 0) < DLT_RETURN_OK)
+        {
+            return -1;
+        }
+
+        size = src->file->msg.headersize + src->file->msg.datasize;
+    }
+
+    if (size > src->data_size)
+    {
+        data = (uint8_t *) realloc(src->data, size);
+
+        if (data == NULL)
+        {
+            return -1;
+        }
+
+        src->data = data;
+        src->data_size = size;
+    }
+
+    src->size = size;
+
+    if (src->run)
     {
-        return 1;
+        if (fread(src->data, size, 1, src->run) != 1)
+        {
+            return -1;
+        }
     }
-    else if (((TimestampIndex*)a)->tmsp == ((TimestampIndex*)b)->tmsp)
+    else
     {
-        return 0;
+        copy_message(src->file, src->data);
+        get_key(src->file, src->source, src->num, &src->tmsp, &src->key);
+        src->num++;
+    }
+
+    return 1;
+}
+
+void heap_down(SortSource **heap, int count, int pos)
+{
+    SortSource *src = heap[pos];
+    int child;
+
+    while ((child = 2 * pos + 1) < count)
+    {
+        if ((child + 1 < count) && (compare_keys(&heap[child + 1]->key, &heap[child]->key) < 0))
+        {
+            child++;
+        }
+
+        if (compare_keys(&heap[child]->key, &src->key) >= 0)
+        {
+            break;
+        }
+
+        heap[pos] = heap[child];
+        pos = child;
     }
-    return -1;
+
+    heap[pos] = src;
 }
 
 /**
- * Write the messages in the order specified by the given index
+ * Merge sorted sources into the output file or into a run file
+ * @return 0 on success, -1 on error
  */
-void write_messages(int ohandle, DltFile *file, TimestampIndex *timestamps, int message_count)
+int merge_sources(SortSource *sources, int count, FILE *out, int to_run)
 {
-    struct iovec iov[2];
-    int bytes_written;
+    SortSource **heap;
+    int num = 0;
+    int ret;
+    int i;
 
-    verbose(1, "Writing %d messages\n", message_count);
+    heap = (SortSource **) malloc(count * sizeof(SortSource *));
 
-    for (int i = 0; i < message_count; ++i)
+    if (heap == NULL)
     {
-        if (0 == i % 1001 || i == message_count - 1)
+        return -1;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        ret = source_next(&sources[i]);
+
+        if (ret < 0)
         {
-            verbose(2, "Writing message %d\r", i);
+            free(heap);
+            return -1;
         }
-        dlt_file_message(file,timestamps[i].num,0);
-        iov[0].iov_base = file->msg.headerbuffer;
-        iov[0].iov_len = file->msg.headersize;
-        iov[1].iov_base = file->msg.databuffer;
-        iov[1].iov_len = file->msg.datasize;
 
-        bytes_written = writev(ohandle, iov, 2);
-        if (0 > bytes_written){
-                printf("in main: writev(ohandle, iov, 2); returned an error!" );
-                dlt_file_free(file,0);
-                exit (-1);
+        if (ret > 0)
+        {
+            heap[num++] = &sources[i];
         }
     }
 
-    verbose (2, "\n");
+    for (i = num / 2 - 1; i >= 0; i--)
+    {
+        heap_down(heap, num, i);
+    }
+
+    while (num > 0)
+    {
+        write_message(out, to_run, &heap[0]->key, heap[0]->data, heap[0]->size);
+
+        ret = source_next(heap[0]);
+
+        if (ret < 0)
+        {
+            free(heap);
+            return -1;
+        }
+
+        if (ret == 0)
+        {
+            heap[0] = heap[--num];
+        }
+
+        heap_down(heap, num, 0);
+    }
+
+    free(heap);
+
+    return 0;
+}
+
+/**
+ * Merge runs, several passes are used if there are too many runs
+ * @return 0 on success, -1 on error
+ */
+int merge_runs(int *runs, int num_runs, FILE *out, size_t memory, const char *tmpdir)
+{
+    SortSource *sources;
+    FILE *merged;
+    size_t buffer_size;
+    int count;
+    int ret = 0;
+    int i;
+
+    sources = (SortSource *) calloc(DLT_SORT_MAX_MERGE, sizeof(SortSource));
+
+    if (sources == NULL)
+    {
+        return -1;
+    }
+
+    while (num_runs > 0 && ret == 0)
+    {
+        count = (num_runs > DLT_SORT_MAX_MERGE) ? DLT_SORT_MAX_MERGE : num_runs;
+        buffer_size = memory / (count + 1);
+
+        if (buffer_size < DLT_SORT_RUN_READ_BUFFER_MIN)
+        {
+            buffer_size = DLT_SORT_RUN_READ_BUFFER_MIN;
+        }
+
+        verbose(1, "Merging %d of %d runs\n", count, num_runs);
+
+        memset(sources, 0, DLT_SORT_MAX_MERGE * sizeof(SortSource));
+
+        for (i = 0; i < count; i++)
+        {
+            sources[i].fd = runs[i];
+            lseek(runs[i], 0, SEEK_SET);
+            sources[i].run = fdopen(runs[i], "rb");
+
+            if (sources[i].run == NULL)
+            {
+                ret = -1;
+                break;
+            }
+
+            setvbuf(sources[i].run, NULL, _IOFBF, buffer_size);
+        }
+
+        merged = NULL;
+
+        if (ret == 0 && count < num_runs)
+        {
+            /* the merged runs become a new run */
+            runs[num_runs] = create_run(tmpdir);
+            merged = (runs[num_runs] != -1) ? fdopen(dup(runs[num_runs]), "wb") : NULL;
+
+            if (merged == NULL)
+            {
+                ret = -1;
+            }
+            else
+            {
+                setvbuf(merged, NULL, _IOFBF, DLT_SORT_RUN_WRITE_BUFFER);
+                num_runs++;
+            }
+        }
+
+        if (ret == 0)
+        {
+            ret = merge_sources(sources, count, merged ? merged : out, merged != NULL);
+        }
+
+        if (merged && (fclose(merged) != 0))
+        {
+            ret = -1;
+        }
+
+        for (i = 0; i < count; i++)
+        {
+            if (sources[i].run)
+            {
+                fclose(sources[i].run);
+            }
+            else
+            {
+                close(runs[i]);
+            }
+
+            free(sources[i].data);
+        }
+
+        memmove(runs, runs + count, (num_runs - count) * sizeof(int));
+        num_runs -= count;
+    }
+
+    for (i = 0; i < num_runs; i++)
+    {
+        close(runs[i]);
+    }
+
+    free(sources);
+
+    return ret;
+}
+
+/**
+ * Sort a range of messages of a file. Messages are sorted in runs which
+ * fit into memory. If there are several runs, they are written to temporary
+ * files and merged afterwards.
+ * @return 0 on success, -1 on error
+ */
+int sort_file(DltFile *file, int begin, int end, FILE *out, size_t memory, const char *tmpdir)
+{
+    SortEntry *entries = NULL;
+    uint8_t *buffer = NULL;
+    int *runs = NULL;
+    int num_runs = 0;
+    FILE *run;
+    size_t buffer_size;
+    size_t used = 0;
+    int32_t max_entries;
+    int32_t count = 0;
+    uint32_t size;
+    uint32_t tmsp = 0;
+    long length;
+    int num;
+    int i;
+    int ret = 0;
+
+    /* a quarter of the memory for the entries, the rest for the messages */
+    max_entries = memory / 4 / sizeof(SortEntry);
+
+    if (max_entries > end - begin + 1)
+    {
+        max_entries = end - begin + 1;
+    }
+
+    buffer_size = memory - memory / 4;
+    length = dlt_file_index_position(file, end) - dlt_file_index_position(file, begin) + UINT16_MAX + sizeof(DltStorageHeader);
+
+    if (length > 0 && buffer_size > (size_t) length)
+    {
+        buffer_size = length;
+    }
+
+    entries = (SortEntry *) malloc(max_entries * sizeof(SortEntry));
+    buffer = (uint8_t *) malloc(buffer_size);
+
+    if (entries == NULL || buffer == NULL)
+    {
+        fprintf(stderr, "ERROR: Failed to allocate memory for sorting!\n");
+        free(entries);
+        free(buffer);
+        return -1;
+    }
+
+    for (num = begin; num <= end + 1; num++)
+    {
+        if (num <= end)
+        {
+            if (dlt_file_message(file, num, 0) < DLT_RETURN_OK)
+            {
+                ret = -1;
+                break;
+            }
+
+            size = file->msg.headersize + file->msg.datasize;
+        }
+
+        /* the run is complete */
+        if ((num > end) || (count == max_entries) || (used + size > buffer_size))
+        {
+            verbose(1, "Sorting %d messages\n", count);
+            qsort((void*)entries, count, sizeof(SortEntry), compare_entries);
+
+            if ((num > end) && (num_runs == 0))
+            {
+                /* all messages fit into memory */
+                verbose(1, "Writing %d messages\n", count);
+
+                for (i = 0; i < count; i++)
+                {
+                    write_message(out, 0, &entries[i].key, buffer + entries[i].offset, entries[i].size);
+                }
+
+                break;
+            }
+
+            if (num_runs % DLT_SORT_MAX_MERGE == 0)
+            {
+                /* one more for merging in several passes */
+                int *tmp = (int *) realloc(runs, (num_runs + DLT_SORT_MAX_MERGE + 1) * sizeof(int));
+
+                if (tmp == NULL)
+                {
+                    ret = -1;
+                    break;
+                }
+
+                runs = tmp;
+            }
+
+            verbose(1, "Writing run %d\n", num_runs);
+
+            runs[num_runs] = create_run(tmpdir);
+            run = (runs[num_runs] != -1) ? fdopen(dup(runs[num_runs]), "wb") : NULL;
+
+            if (run == NULL)
+            {
+                if (runs[num_runs] != -1)
+                {
+                    close(runs[num_runs]);
+                }
+
+                ret = -1;
+                break;
+            }
+
+            num_runs++;
+            setvbuf(run, NULL, _IOFBF, DLT_SORT_RUN_WRITE_BUFFER);
+
+            for (i = 0; i < count; i++)
+            {
+                write_message(run, 1, &entries[i].key, buffer + entries[i].offset, entries[i].size);
+            }
+
+            if (fclose(run) != 0)
+            {
+                write_failed();
+            }
+
+            count = 0;
+            used = 0;
+        }
+
+        if (num <= end)
+        {
+            copy_message(file, buffer + used);
+            get_key(file, 0, num, &tmsp, &entries[count].key);
+            entries[count].offset = used;
+            entries[count].size = size;
+            count++;
+            used += size;
+        }
+    }
+
+    free(entries);
+    free(buffer);
+
+    if (ret == 0 && num_runs > 0)
+    {
+        ret = merge_runs(runs, num_runs, out, memory, tmpdir);
+    }
+    else
+    {
+        for (i = 0; i < num_runs; i++)
+        {
+            close(runs[i]);
+        }
+    }
+
+    free(runs);
+
+    return ret;
+}
+
+/**
+ * Load, analyse data file and create index list
+ */
+int load_file(DltFile *file, char *filename, DltFilter *filter, int iflag, int vflag)
+{
+    char iname[PATH_MAX + 1];
+
+    dlt_file_init(file,vflag);
+
+    if (filter)
+    {
+        dlt_file_set_filter(file,filter,vflag);
+    }
+
+    if (dlt_file_open(file,filename,vflag) < DLT_RETURN_OK)
+    {
+        return -1;
+    }
+
+    snprintf(iname, sizeof(iname), "%s%s", filename, DLT_FILE_INDEX_SUFFIX);
+
+    if (!iflag || dlt_file_index_load(file,iname,vflag) < DLT_RETURN_OK)
+    {
+        dlt_file_read_parallel(file,0,vflag);
+
+        if (iflag)
+        {
+            dlt_file_index_save(file,iname,vflag);
+        }
+    }
+
+    return 0;
 }
 
 /**
@@ -173,9 +749,11 @@ void usage()
     dlt_get_version(version,DLT_VERBUFSIZE);
 
     printf("Usage: dlt-sortbytimestamp [options] [commands] file_in file_out\n");
+    printf("       dlt-sortbytimestamp -m [options] [commands] file_in1 [file_in2 ...] file_out\n");
     printf("Read DLT file, sort by timestamp and store the messages again.\n");
     printf("Use filters to filter DLT messages.\n");
     printf("Use range to cut DLT file. Indices are zero based.\n");
+    printf("Use merge to join sorted DLT files, ordered by ECU, session and timestamp.\n");
     printf("%s \n", version);
     printf("Commands:\n");
     printf("  -h            Usage\n");
@@ -185,6 +763,10 @@ void usage()
     printf("  -f filename   Enable filtering of messages\n");
     printf("  -b number     First message in range to be handled (default: first message)\n");
     printf("  -e number     Last message in range to be handled (default: last message)\n");
+    printf("  -i            Load index from file_in%s, or create it\n", DLT_FILE_INDEX_SUFFIX);
+    printf("  -m            Merge sorted input files\n");
+    printf("  -s size       Memory used for sorting in MB (default: %d)\n", DLT_SORT_DEFAULT_MEMORY);
+    printf("  -t directory  Directory for temporary files (default: directory of file_out)\n");
 }
 
 /**
@@ -194,29 +776,38 @@ int main(int argc, char* argv[])
 {
     int vflag = 0;
     int cflag = 0;
+    int iflag = 0;
     char *fvalue = 0;
     char *bvalue = 0;
     char *evalue = 0;
     char *ivalue = 0;
     char *ovalue = 0;
-
-    TimestampIndex *timestamp_index = 0;
-    int32_t message_count = 0;
+    char *tvalue = 0;
+    size_t memory = (size_t) DLT_SORT_DEFAULT_MEMORY * 1024 * 1024;
 
     int c;
 
     DltFile file;
+    DltFile *files = NULL;
+    SortSource *sources = NULL;
+    int num_files = 0;
+    int32_t counter = 0;
+    int32_t counter_total = 0;
     DltFilter filter;
 
     int ohandle=-1;
+    FILE *out;
+    char tmpdir[PATH_MAX];
+    char oname[PATH_MAX];
 
     int num, begin, end;
+    int ret;
 
     opterr = 0;
 
     verbose(1, "Configuring\n");
 
-    while ((c = getopt (argc, argv, "vchf:b:e:")) != -1)
+    while ((c = getopt (argc, argv, "vchimf:b:e:s:t:")) != -1)
         switch (c)
         {
         case 'v':
@@ -229,6 +820,16 @@ int main(int argc, char* argv[])
             	cflag = 1;
             	break;
 			}
+        case 'i':
+            {
+                iflag = 1;
+                break;
+            }
+        case 'm':
+            {
+                merge_mode = 1;
+                break;
+            }
         case 'h':
             {
                 usage();
@@ -249,9 +850,25 @@ int main(int argc, char* argv[])
                 evalue = optarg;
                 break;
             }
+        case 's':
+            {
+                if (atoi(optarg) < 1)
+                {
+                    fprintf(stderr, "ERROR: Memory for sorting must be at least 1 MB!\n");
+                    return -1;
+                }
+
+                memory = (size_t) atoi(optarg) * 1024 * 1024;
+                break;
+            }
+        case 't':
+            {
+                tvalue = optarg;
+                break;
+            }
         case '?':
             {
-                if (optopt == 'f' || optopt == 'b' || optopt == 'e')
+                if (optopt == 'f' || optopt == 'b' || optopt == 'e' || optopt == 's' || optopt == 't')
                 {
                     fprintf (stderr, "Option -%c requires an argument.\n", optopt);
                 }
@@ -282,137 +899,186 @@ int main(int argc, char* argv[])
 
     verbose (1, "Initializing\n");
 
-    /* initialise structure to use DLT file */
-    dlt_file_init(&file,vflag);
-
     /* first parse filter file if filter parameter is used */
+    dlt_filter_init(&filter,vflag);
     if (fvalue)
     {
         if (bvalue || evalue)
         {
             fprintf(stderr,"ERROR: can't specify a range *and* filtering!\n");
-            dlt_file_free(&file,vflag);
             return -1;
         }
 
         if (dlt_filter_load(&filter,fvalue,vflag) < DLT_RETURN_OK)
         {
-            dlt_file_free(&file,vflag);
             return -1;
         }
-
-        dlt_file_set_filter(&file,&filter,vflag);
     }
 
-    ivalue = argv[optind];
+    if (merge_mode && (bvalue || evalue))
+    {
+        fprintf(stderr,"ERROR: can't specify a range *and* merging!\n");
+        return -1;
+    }
 
-    if (!ivalue)
+    if (optind >= argc)
     {
-        dlt_file_free(&file,vflag);
         fprintf(stderr,"ERROR: Need an input file!\n");
         return -1;
     }
 
-    ovalue = argv[optind + 1];
+    if (optind + 1 >= argc)
+    {
+        fprintf(stderr,"ERROR: Need an output file!\n");
+        return -1;
+    }
 
-    if (ovalue)
+    if (merge_mode)
     {
-        ohandle = open(ovalue,O_WRONLY|O_CREAT|O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH); /* mode: wb */
-        if (ohandle == -1)
-        {
-            dlt_file_free(&file,vflag);
-            fprintf(stderr,"ERROR: Output file %s cannot be opened!\n",ovalue);
-            return -1;
-        }
+        num_files = argc - optind - 1;
+        ovalue = argv[argc - 1];
     }
     else
     {
-        dlt_file_free(&file,vflag);
-        fprintf(stderr,"ERROR: Need an output file!\n");
+        ivalue = argv[optind];
+        ovalue = argv[optind + 1];
+    }
+
+    ohandle = open(ovalue,O_WRONLY|O_CREAT|O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH); /* mode: wb */
+    out = (ohandle != -1) ? fdopen(ohandle, "wb") : NULL;
+
+    if (out == NULL)
+    {
+        fprintf(stderr,"ERROR: Output file %s cannot be opened!\n",ovalue);
         return -1;
     }
 
+    setvbuf(out, NULL, _IOFBF, DLT_SORT_OUTPUT_BUFFER);
+
+    /* temporary files are created next to the output file by default */
+    if (tvalue)
+    {
+        snprintf(tmpdir, sizeof(tmpdir), "%s", tvalue);
+    }
+    else
+    {
+        snprintf(oname, sizeof(oname), "%s", ovalue);
+        snprintf(tmpdir, sizeof(tmpdir), "%s", dirname(oname));
+    }
+
     verbose(1, "Loading\n");
 
-    /* load, analyse data file and create index list */
-    if (dlt_file_open(&file,ivalue,vflag) >= DLT_RETURN_OK)
+    if (merge_mode)
     {
-        while (dlt_file_read(&file,vflag) >= DLT_RETURN_OK)
+        files = (DltFile *) calloc(num_files, sizeof(DltFile));
+        sources = (SortSource *) calloc(num_files, sizeof(SortSource));
+
+        if (files == NULL || sources == NULL)
         {
+            fprintf(stderr,"ERROR: Failed to allocate memory for input files!\n");
+            return -1;
         }
+
+        for (num = 0; num < num_files; num++)
+        {
+            if (load_file(&files[num], argv[optind + num], fvalue ? &filter : NULL, iflag, vflag) != 0)
+            {
+                fprintf(stderr,"ERROR: Input file %s cannot be opened!\n",argv[optind + num]);
+                return -1;
+            }
+
+            counter += files[num].counter;
+            counter_total += files[num].counter_total;
+
+            sources[num].fd = -1;
+            sources[num].file = &files[num];
+            sources[num].source = num;
+            sources[num].end = files[num].counter - 1;
+        }
+    }
+    else
+    {
+        load_file(&file, ivalue, fvalue ? &filter : NULL, iflag, vflag);
+        counter = file.counter;
+        counter_total = file.counter_total;
     }
 
     if (cflag) {
         if (fvalue)
         {
-            printf("Loaded %d messages, %d after filtering.\n", file.counter_total, file.counter);
+            printf("Loaded %d messages, %d after filtering.\n", counter_total, counter);
         }
         else
         {
-            printf("Loaded %d messages.\n", file.counter_total);
+            printf("Loaded %d messages.\n", counter_total);
         }
     }
 
-    if (bvalue)
+    if (merge_mode)
     {
-        begin = atoi(bvalue);
-    }
-    else
-    {
-        begin = 0;
-    }
+        verbose(1, "Merging %d files\n", num_files);
+        ret = merge_sources(sources, num_files, out, 0);
 
-    if (evalue)
-    {
-        end = atoi(evalue);
-    }
-    else
-    {
-        end = file.counter-1;
-    }
+        for (num = 0; num < num_files; num++)
+        {
+            free(sources[num].data);
+            dlt_file_free(&files[num],vflag);
+        }
 
-    if (begin<0 || begin>=file.counter || begin>end)
-    {
-        fprintf(stderr,"ERROR: Selected first message %d is out of range!\n",begin);
-        return -1;
+        free(sources);
+        free(files);
     }
-    if (end<0 || end<begin || end>=file.counter)
+    else
     {
-        fprintf(stderr,"ERROR: Selected end message %d is out of range!\n",end);
-        return -1;
-    }
+        if (bvalue)
+        {
+            begin = atoi(bvalue);
+        }
+        else
+        {
+            begin = 0;
+        }
 
-    verbose(2, "Begin: %d End: %d Range: %d\n", begin, end, 1 + end - begin);
+        if (evalue)
+        {
+            end = atoi(evalue);
+        }
+        else
+        {
+            end = file.counter-1;
+        }
 
-    verbose(1, "Allocating memory\n");
+        if (begin<0 || begin>=file.counter || begin>end)
+        {
+            fprintf(stderr,"ERROR: Selected first message %d is out of range!\n",begin);
+            return -1;
+        }
+        if (end<0 || end<begin || end>=file.counter)
+        {
+            fprintf(stderr,"ERROR: Selected end message %d is out of range!\n",end);
+            return -1;
+        }
 
-    message_count = 1 + end - begin;
+        verbose(2, "Begin: %d End: %d Range: %d\n", begin, end, 1 + end - begin);
 
-    timestamp_index = (TimestampIndex*)malloc(sizeof(TimestampIndex) * message_count);
+        ret = sort_file(&file, begin, end, out, memory, tmpdir);
 
-    if (timestamp_index == 0)
-    {
-        fprintf(stderr,"ERROR: Failed to allocate memory for message index!\n");
         dlt_file_free(&file,vflag);
-        return -1;
     }
 
-    verbose(1, "Filling %d entries\n", message_count);
-    for (num = begin; num <= end; num++)
+    if (fclose(out) != 0)
     {
-        dlt_file_message(&file,num,vflag);
-        timestamp_index[num - begin].num = num;
-        timestamp_index[num - begin].tmsp = file.msg.headerextra.tmsp;
+        ret = -1;
     }
 
-    verbose(1, "Sorting\n");
-    qsort((void*)timestamp_index, message_count, sizeof(TimestampIndex), compare_index_timestamps);
+    dlt_filter_free(&filter,vflag);
 
-    write_messages(ohandle, &file, timestamp_index, message_count);
-    close(ohandle);
+    if (ret != 0)
+    {
+        fprintf(stderr,"ERROR: Sorting messages failed!\n");
+        return -1;
+    }
 
     verbose(1, "Tidying up.\n");
-    free(timestamp_index);
-    dlt_file_free(&file,vflag);
     return 0;
 }
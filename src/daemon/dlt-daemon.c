@@ -81,6 +81,14 @@ static char str[DLT_DAEMON_TEXTBUFSIZE];
 
 static int dlt_daemon_log_internal(DltDaemon *daemon, DltDaemonLocal *daemon_local, char *str, int verbose);
 
+#ifdef DLT_SHM_ENABLE
+static int dlt_daemon_shm_receive(DltDaemonLocal *daemon_local, DltReceiver *receiver);
+static void dlt_daemon_shm_remove_rings(DltDaemon *daemon, DltDaemonLocal *daemon_local, int owner, int verbose);
+static void dlt_daemon_shm_free_rings(DltDaemonLocal *daemon_local);
+#endif
+
+static int dlt_daemon_app_connection_create(DltDaemonLocal *daemon_local, int fd);
+
 #ifdef DLT_SYSTEMD_WATCHDOG_ENABLE
 static uint32_t watchdog_trigger_interval;  // watchdog trigger interval in [s]
 #endif
@@ -222,11 +230,18 @@ int option_file_parser(DltDaemonLocal *daemon_local)
 
 	/* set default values for configuration */
 	daemon_local->flags.sharedMemorySize = DLT_SHM_SIZE;
+	daemon_local->flags.ingestThreads = 0;
+	daemon_local->flags.storageQueueSize = 0;
+	daemon_local->flags.clientSendQueueSize = DLT_DAEMON_SNDQUEUESIZE_MAX;
+	daemon_local->flags.clientSendQueueHighWatermark = DLT_DAEMON_SNDQUEUE_HIGH_WATERMARK;
+	daemon_local->flags.clientSendQueueLowWatermark = DLT_DAEMON_SNDQUEUE_LOW_WATERMARK;
 	daemon_local->flags.sendMessageTime = 0;
 	daemon_local->flags.offlineTraceDirectory[0] = 0;
 	daemon_local->flags.offlineTraceFileSize = 1000000;
 	daemon_local->flags.offlineTraceMaxSize = 0;
 	daemon_local->flags.offlineTraceFilenameTimestampBased = 1;
+	daemon_local->flags.offlineTraceBufferSize = 0;
+	daemon_local->flags.offlineTraceFlushInterval = DLT_DAEMON_OFFLINE_TRACE_FLUSH_INTERVAL;
 	daemon_local->flags.loggingMode = DLT_LOG_TO_CONSOLE;
 	daemon_local->flags.loggingLevel = LOG_INFO;
 	snprintf(daemon_local->flags.loggingFilename, sizeof(daemon_local->flags.loggingFilename)-1, "%s/dlt.log", dltFifoBaseDir);
@@ -427,6 +442,42 @@ int option_file_parser(DltDaemonLocal *daemon_local)
                             daemon_local->flags.sharedMemorySize = atoi(value);
                             //printf("Option: %s=%s\n",token,value);
                         }
+                        else if(strcmp(token,"IngestThreads")==0)
+                        {
+                            daemon_local->flags.ingestThreads = atoi(value);
+                        }
+                        else if(strcmp(token,"StorageQueueSize")==0)
+                        {
+                            daemon_local->flags.storageQueueSize = atoi(value);
+                        }
+                        else if(strcmp(token,"ClientSendQueueSize")==0)
+                        {
+                            daemon_local->flags.clientSendQueueSize = atoi(value);
+                            if (daemon_local->flags.clientSendQueueSize < DLT_DAEMON_SNDQUEUESIZE)
+                            {
+                                daemon_local->flags.clientSendQueueSize = DLT_DAEMON_SNDQUEUESIZE;
+                            }
+                        }
+                        else if(strcmp(token,"ClientSendQueueHighWatermark")==0)
+                        {
+                            daemon_local->flags.clientSendQueueHighWatermark = atoi(value);
+                            if ((daemon_local->flags.clientSendQueueHighWatermark < 1) ||
+                                (daemon_local->flags.clientSendQueueHighWatermark > 100))
+                            {
+                                dlt_vlog(LOG_WARNING, "Invalid ClientSendQueueHighWatermark %s, using %d\n", value, DLT_DAEMON_SNDQUEUE_HIGH_WATERMARK);
+                                daemon_local->flags.clientSendQueueHighWatermark = DLT_DAEMON_SNDQUEUE_HIGH_WATERMARK;
+                            }
+                        }
+                        else if(strcmp(token,"ClientSendQueueLowWatermark")==0)
+                        {
+                            daemon_local->flags.clientSendQueueLowWatermark = atoi(value);
+                            if ((daemon_local->flags.clientSendQueueLowWatermark < 0) ||
+                                (daemon_local->flags.clientSendQueueLowWatermark > 100))
+                            {
+                                dlt_vlog(LOG_WARNING, "Invalid ClientSendQueueLowWatermark %s, using %d\n", value, DLT_DAEMON_SNDQUEUE_LOW_WATERMARK);
+                                daemon_local->flags.clientSendQueueLowWatermark = DLT_DAEMON_SNDQUEUE_LOW_WATERMARK;
+                            }
+                        }
                         else if(strcmp(token,"OfflineTraceDirectory")==0)
                         {
                             strncpy(daemon_local->flags.offlineTraceDirectory,value,sizeof(daemon_local->flags.offlineTraceDirectory) - 1);
@@ -448,6 +499,22 @@ int option_file_parser(DltDaemonLocal *daemon_local)
 							daemon_local->flags.offlineTraceFilenameTimestampBased = atoi(value);
 							//printf("Option: %s=%s\n",token,value);
 						}
+                        else if(strcmp(token,"OfflineTraceBufferSize")==0)
+                        {
+                            daemon_local->flags.offlineTraceBufferSize = atoi(value);
+                            if (daemon_local->flags.offlineTraceBufferSize < 0)
+                            {
+                                daemon_local->flags.offlineTraceBufferSize = 0;
+                            }
+                        }
+                        else if(strcmp(token,"OfflineTraceFlushInterval")==0)
+                        {
+                            daemon_local->flags.offlineTraceFlushInterval = atoi(value);
+                            if (daemon_local->flags.offlineTraceFlushInterval < 0)
+                            {
+                                daemon_local->flags.offlineTraceFlushInterval = 0;
+                            }
+                        }
                         else if(strcmp(token,"SendECUSoftwareVersion")==0)
                         {
                             daemon_local->flags.sendECUSoftwareVersion = atoi(value);
@@ -701,6 +768,12 @@ int main(int argc, char* argv[])
         return -1;
     }
 
+    if (dlt_daemon_local_ingest_init(&daemon_local, daemon_local.flags.vflag)==-1)
+    {
+        dlt_log(LOG_CRIT,"Initialization of ingest threads failed!\n");
+        return -1;
+    }
+
     /* --- Daemon connection init begin */
     if (dlt_daemon_local_connection_init(&daemon, &daemon_local, daemon_local.flags.vflag)==-1)
     {
@@ -727,6 +800,12 @@ int main(int argc, char* argv[])
         }
     }
 
+    if (dlt_daemon_local_storage_init(&daemon, &daemon_local, daemon_local.flags.vflag)==-1)
+    {
+        dlt_log(LOG_CRIT,"Initialization of storage thread failed!\n");
+        return -1;
+    }
+
     // create fd for watchdog
 #ifdef DLT_SYSTEMD_WATCHDOG_ENABLE
     {
@@ -906,6 +985,14 @@ int dlt_daemon_local_init_p2(DltDaemon *daemon, DltDaemonLocal *daemon_local, in
             dlt_log(LOG_ERR,"Could not initialize offline trace\n");
             return -1;
         }
+
+        if (dlt_offline_trace_set_buffer(&(daemon_local->offlineTrace),
+            daemon_local->flags.offlineTraceBufferSize,
+            daemon_local->flags.offlineTraceFlushInterval) < DLT_RETURN_OK)
+        {
+            dlt_log(LOG_ERR,"Could not initialize offline trace buffer\n");
+            return -1;
+        }
     }
 
     /* Init offline logstorage for MAX devices */
@@ -935,12 +1022,8 @@ int dlt_daemon_local_init_p2(DltDaemon *daemon, DltDaemonLocal *daemon_local, in
     daemon->sendserialheader = daemon_local->flags.lflag;
 
 #ifdef DLT_SHM_ENABLE
-    /* init shared memory */
-    if (dlt_shm_init_server(&(daemon_local->dlt_shm),DLT_SHM_KEY,daemon_local->flags.sharedMemorySize)==-1)
-    {
-        dlt_log(LOG_ERR,"Could not initialize shared memory\n");
-        return -1;
-    }
+    /* shared memory rings are created by the applications on demand */
+    daemon_local->shm_rings = NULL;
 #endif
 
     /* prepare main loop */
@@ -1115,14 +1198,129 @@ static int dlt_daemon_init_fifo(DltDaemonLocal *daemon_local)
      * as soon as possible. This registration is automatically ignored
      * during next execution.
      */
-    return dlt_connection_create(daemon_local,
-                                 &daemon_local->pEvent,
-                                 fd,
-                                 EPOLLIN,
-                                 DLT_CONNECTION_APP_MSG);
+    return dlt_daemon_app_connection_create(daemon_local, fd);
 }
 #endif
 
+/**
+ * Register a connection for messages of applications.
+ * With ingest threads, the connection is received from by a worker and
+ * its messages arrive through the queue of that worker.
+ */
+static int dlt_daemon_app_connection_create(DltDaemonLocal *daemon_local, int fd)
+{
+    DltConnection *con;
+
+    if (dlt_connection_create(daemon_local,
+                              &daemon_local->pEvent,
+                              fd,
+                              EPOLLIN,
+                              DLT_CONNECTION_APP_MSG))
+    {
+        return -1;
+    }
+
+    if (daemon_local->ingest.num_workers == 0)
+    {
+        return 0;
+    }
+
+    con = dlt_event_handler_find_connection(&daemon_local->pEvent, fd);
+
+    if ((con != NULL) && (con->status == INACTIVE))
+    {
+        /* already handed over */
+        return 0;
+    }
+
+    if ((con == NULL) ||
+        (dlt_connection_check_activate(&daemon_local->pEvent, con, DEACTIVATE) != 0) ||
+        (dlt_daemon_ingest_add(&daemon_local->ingest, con->receiver) != 0))
+    {
+        dlt_log(LOG_ERR, "Cannot hand over application connection to ingest thread\n");
+        /* connection owns the descriptor now */
+        dlt_event_handler_unregister_connection(&daemon_local->pEvent, daemon_local, fd);
+        return 1;
+    }
+
+    return 0;
+}
+
+int dlt_daemon_local_ingest_init(DltDaemonLocal *daemon_local, int verbose)
+{
+    int threads;
+    int i;
+
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if (daemon_local == NULL)
+    {
+        dlt_vlog(LOG_ERR, "%s: Invalid function parameters\n", __func__);
+        return -1;
+    }
+
+    threads = daemon_local->flags.ingestThreads;
+
+#ifdef DLT_SHM_ENABLE
+    if (threads > 0)
+    {
+        /* descriptors of rings are taken over while receiving */
+        dlt_log(LOG_WARNING, "Ingest threads not supported with shared memory rings\n");
+        threads = 0;
+    }
+#endif
+
+    if (dlt_daemon_ingest_init(&daemon_local->ingest, threads, verbose) != 0)
+    {
+        return -1;
+    }
+
+    for (i = 0; i < daemon_local->ingest.num_workers; i++)
+    {
+        if (dlt_connection_create(daemon_local,
+                                  &daemon_local->pEvent,
+                                  daemon_local->ingest.workers[i].notify_fd,
+                                  EPOLLIN,
+                                  DLT_CONNECTION_APP_INGEST) != 0)
+        {
+            dlt_log(LOG_ERR, "Cannot register ingest thread\n");
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int dlt_daemon_local_storage_init(DltDaemon *daemon, DltDaemonLocal *daemon_local, int verbose)
+{
+    DltLogStorageUserConfig file_config;
+    DltOfflineTrace *trace = NULL;
+
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if ((daemon == NULL) || (daemon_local == NULL))
+    {
+        dlt_vlog(LOG_ERR, "%s: Invalid function parameters\n", __func__);
+        return -1;
+    }
+
+    /* the offline trace is written depending on the current mode */
+    if (daemon_local->flags.offlineTraceDirectory[0])
+    {
+        trace = &daemon_local->offlineTrace;
+    }
+
+    dlt_daemon_logstorage_get_user_config(&daemon_local->flags, &file_config);
+
+    return dlt_daemon_storage_init(&daemon_local->storage,
+                                   daemon,
+                                   trace,
+                                   &file_config,
+                                   daemon_local->flags.offlineLogstorageMaxDevices,
+                                   daemon_local->flags.storageQueueSize,
+                                   verbose);
+}
+
 int dlt_daemon_local_connection_init(DltDaemon *daemon,
                                      DltDaemonLocal *daemon_local,
                                      int verbose)
@@ -1313,6 +1511,17 @@ void dlt_daemon_local_cleanup(DltDaemon *daemon, DltDaemonLocal *daemon_local, i
         return;
     }
 
+#ifdef DLT_SHM_ENABLE
+    /* release rings of all applications */
+    dlt_daemon_shm_free_rings(daemon_local);
+#endif
+
+    /* stop receiving from applications, queued messages are dropped */
+    dlt_daemon_ingest_free(&daemon_local->ingest, verbose);
+
+    /* write what is queued for storage before it is closed */
+    dlt_daemon_storage_free(&daemon_local->storage, verbose);
+
     /* Don't receive event anymore */
     dlt_event_handler_cleanup_connections(&daemon_local->pEvent);
 
@@ -1328,11 +1537,6 @@ void dlt_daemon_local_cleanup(DltDaemon *daemon, DltDaemonLocal *daemon_local, i
     /* Try to delete existing pipe, ignore result of unlink() */
     unlink(daemon_local->flags.daemonFifoName);
 
-#ifdef DLT_SHM_ENABLE
-    /* free shared memory */
-    dlt_shm_free_server(&(daemon_local->dlt_shm));
-#endif
-
     /* Try to delete lock file, ignore result of unlink() */
     unlink(DLT_DAEMON_LOCK_FILE);
 
@@ -1926,6 +2130,7 @@ int dlt_daemon_process_app_connect(
     socklen_t app_size;
     struct sockaddr_un app;
     int in_sock = -1;
+    int ret;
 
     PRINT_FUNCTION_VERBOSE(verbose);
 
@@ -1950,16 +2155,19 @@ int dlt_daemon_process_app_connect(
     dlt_daemon_applications_invalidate_fd(daemon, daemon->ecuid, in_sock, verbose);
     dlt_daemon_contexts_invalidate_fd(daemon,daemon->ecuid, in_sock, verbose);
 
-    if (dlt_connection_create(daemon_local,
-                             &daemon_local->pEvent,
-                             in_sock,
-                             EPOLLIN,
-                             DLT_CONNECTION_APP_MSG))
+    ret = dlt_daemon_app_connection_create(daemon_local, in_sock);
+
+    if (ret < 0)
     {
         dlt_log(LOG_ERR, "Failed to register new application. \n");
         close(in_sock);
         return -1;
     }
+    else if (ret > 0)
+    {
+        /* connection was already dropped, keep the daemon running */
+        return 0;
+    }
 
     if (verbose)
     {
@@ -2075,9 +2283,12 @@ static int dlt_daemon_process_user_message_not_sup(DltDaemon *daemon,
     {
         dlt_log(LOG_WARNING,
                 "Can't remove bytes from receiver for user messages\n");
+        return -1;
     }
 
-    return -1;
+    /* continue with the next message, otherwise the received messages
+     * following it are only handled with the next read */
+    return 0;
 }
 
 static dlt_daemon_process_user_message_func process_user_func[DLT_USER_MESSAGE_NOT_SUPPORTED] = {
@@ -2103,6 +2314,26 @@ static dlt_daemon_process_user_message_func process_user_func[DLT_USER_MESSAGE_N
     dlt_daemon_process_user_message_not_sup
 };
 
+/* Handle the user message at the beginning of the receiver */
+static int dlt_daemon_process_user_message(DltDaemon *daemon,
+                                           DltDaemonLocal *daemon_local,
+                                           DltReceiver *receiver)
+{
+    DltUserHeader *userheader = (DltUserHeader *)receiver->buf;
+    dlt_daemon_process_user_message_func func = NULL;
+
+    if (userheader->message >= DLT_USER_MESSAGE_NOT_SUPPORTED)
+    {
+        func = dlt_daemon_process_user_message_not_sup;
+    }
+    else
+    {
+        func = process_user_func[userheader->message];
+    }
+
+    return func(daemon, daemon_local, receiver, daemon_local->flags.vflag);
+}
+
 int dlt_daemon_process_user_messages(DltDaemon *daemon,
                                      DltDaemonLocal *daemon_local,
                                      DltReceiver *receiver,
@@ -2113,6 +2344,7 @@ int dlt_daemon_process_user_messages(DltDaemon *daemon,
     int32_t min_size = (int32_t)sizeof(DltUserHeader);
     DltUserHeader *userheader;
     int recv;
+    int32_t grow = 0;
 
     PRINT_FUNCTION_VERBOSE(verbose);
 
@@ -2124,10 +2356,18 @@ int dlt_daemon_process_user_messages(DltDaemon *daemon,
         return -1;
     }
 
+#ifdef DLT_SHM_ENABLE
+    /* rings are registered with descriptors passed along the messages */
+    recv = dlt_daemon_shm_receive(daemon_local, receiver);
+#else
     recv = dlt_receiver_receive(receiver);
+#endif
 #ifdef DLT_USE_UNIX_SOCKET_IPC
     if (recv <= 0)
     {
+#ifdef DLT_SHM_ENABLE
+        dlt_daemon_shm_remove_rings(daemon, daemon_local, receiver->fd, verbose);
+#endif
         dlt_daemon_close_socket(receiver->fd,
                                 daemon,
                                 daemon_local,
@@ -2144,48 +2384,46 @@ int dlt_daemon_process_user_messages(DltDaemon *daemon,
     }
 #endif
 
-    /* look through buffer as long as data is in there */
-    while ((receiver->bytesRcvd >= min_size) && run_loop)
+    /* A full buffer means more data is waiting or a message does not fit,
+     * read more at once next time */
+    if ((receiver->bytesRcvd == receiver->buffersize) &&
+        (receiver->buffersize < DLT_DAEMON_RCVBUFSIZE_APP_MAX))
     {
-        dlt_daemon_process_user_message_func func = NULL;
+        grow = receiver->buffersize * 2;
+    }
 
-        offset = 0;
-        userheader = (DltUserHeader *)(receiver->buf + offset);
+    /* look through buffer as long as data is in there, messages are
+     * processed in place */
+    while ((receiver->bytesRcvd >= min_size) && run_loop)
+    {
+        userheader = (DltUserHeader *)receiver->buf;
 
-        while (!dlt_user_check_userheader(userheader) &&
-               (offset + min_size <= receiver->bytesRcvd))
         /* resync if necessary */
-        {
-            offset++;
-            userheader = (DltUserHeader *)(receiver->buf + offset);
-        }
-
-        /* Check for user header pattern */
         if (!dlt_user_check_userheader(userheader))
         {
-            break;
-        }
+            offset = dlt_user_find_userheader(receiver->buf, receiver->bytesRcvd);
 
-        /* Set new start offset */
-        if (offset > 0)
-        {
-            dlt_receiver_remove(receiver, offset);
-        }
+            if (offset < 0)
+            {
+                /* keep only what could be the start of a user header */
+                offset = receiver->bytesRcvd - (DLT_ID_SIZE - 1);
+                dlt_receiver_remove(receiver, offset);
+                break;
+            }
 
+            /* Set new start offset */
+            dlt_receiver_remove(receiver, offset);
+            userheader = (DltUserHeader *)receiver->buf;
 
-        if (userheader->message >= DLT_USER_MESSAGE_NOT_SUPPORTED)
-        {
-            func = dlt_daemon_process_user_message_not_sup;
-        }
-        else
-        {
-            func = process_user_func[userheader->message];
+            if (receiver->bytesRcvd < min_size)
+            {
+                break;
+            }
         }
 
-        if (func(daemon,
-                 daemon_local,
-                 receiver,
-                 daemon_local->flags.vflag) == -1)
+        if (dlt_daemon_process_user_message(daemon,
+                                            daemon_local,
+                                            receiver) == -1)
         {
             run_loop = 0;
         }
@@ -2200,6 +2438,85 @@ int dlt_daemon_process_user_messages(DltDaemon *daemon,
         return -1;
     }
 
+    if (grow > 0)
+    {
+        if (grow > DLT_DAEMON_RCVBUFSIZE_APP_MAX)
+        {
+            grow = DLT_DAEMON_RCVBUFSIZE_APP_MAX;
+        }
+
+        if (dlt_receiver_grow(receiver, grow) != DLT_RETURN_OK)
+        {
+            dlt_log(LOG_WARNING, "Can't enlarge receiver buffer for user messages\n");
+        }
+    }
+
+    return 0;
+}
+
+int dlt_daemon_process_user_ingest(DltDaemon *daemon,
+                                   DltDaemonLocal *daemon_local,
+                                   DltReceiver *rec,
+                                   int verbose)
+{
+    DltDaemonIngestWorker *worker;
+    DltReceiver view;
+    int handled;
+    int type;
+    int fd;
+
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if ((daemon == NULL) || (daemon_local == NULL) || (rec == NULL))
+    {
+        dlt_vlog(LOG_ERR, "Invalid function parameters used for %s\n", __func__);
+        return -1;
+    }
+
+    worker = dlt_daemon_ingest_find(&daemon_local->ingest, rec->fd);
+
+    if (worker == NULL)
+    {
+        dlt_log(LOG_WARNING, "Event for unknown ingest thread\n");
+        return 0;
+    }
+
+    /* clear the notification before draining, the worker notifies again
+     * for everything queued afterwards */
+    dlt_daemon_ingest_ack(worker);
+
+    memset(&view, 0, sizeof(view));
+
+    for (handled = 0; handled < DLT_DAEMON_INGEST_DRAIN_BUDGET; handled++)
+    {
+        if (!dlt_daemon_ingest_peek(worker, &fd, &type, &view.buf, &view.bytesRcvd))
+        {
+            break;
+        }
+
+        if (type == DLT_DAEMON_INGEST_CLOSE)
+        {
+            /* all messages of the application were handled before */
+            dlt_daemon_close_socket(fd, daemon, daemon_local, verbose);
+        }
+        else
+        {
+            /* messages are framed by the worker, handle them in place */
+            view.fd = fd;
+            view.buffer = view.buf;
+            view.buffersize = view.bytesRcvd;
+            dlt_daemon_process_user_message(daemon, daemon_local, &view);
+        }
+
+        dlt_daemon_ingest_release(worker);
+    }
+
+    if (handled == DLT_DAEMON_INGEST_DRAIN_BUDGET)
+    {
+        /* be fair to other connections, continue later */
+        dlt_daemon_ingest_notify(worker);
+    }
+
     return 0;
 }
 
@@ -2557,11 +2874,13 @@ int dlt_daemon_process_user_message_register_context(DltDaemon *daemon,
     if(daemon_local->flags.offlineLogstorageMaxDevices)
     {
         /* Store log level set for offline logstorage into context structure*/
+        dlt_daemon_storage_lock(&daemon_local->storage);
         context->storage_log_level =
             dlt_daemon_logstorage_get_loglevel(daemon,
                                                daemon_local->flags.offlineLogstorageMaxDevices,
                                                userctxt.apid,
                                                userctxt.ctid);
+        dlt_daemon_storage_unlock(&daemon_local->storage);
     }
     else
     {
@@ -2817,6 +3136,7 @@ int dlt_daemon_process_user_message_log(DltDaemon *daemon,
 {
     int ret;
     int bytes_to_be_removed;
+    uint8_t *payload;
 
     static char text[DLT_DAEMON_TEXTSIZE];
 
@@ -2828,13 +3148,22 @@ int dlt_daemon_process_user_message_log(DltDaemon *daemon,
         return DLT_DAEMON_ERROR_UNKNOWN;
     }
 
-    ret = dlt_message_read(&(daemon_local->msg),
-                           (unsigned char*)rec->buf + sizeof(DltUserHeader),
-                           rec->bytesRcvd - sizeof(DltUserHeader),
-                           0,
-                           verbose);
+    /* The payload stays in the receive buffer, it is only copied when
+     * it has to be buffered for a client */
+    ret = dlt_message_read_header(&(daemon_local->msg),
+                                  (unsigned char*)rec->buf + sizeof(DltUserHeader),
+                                  rec->bytesRcvd - sizeof(DltUserHeader),
+                                  0,
+                                  verbose);
     if(ret!=DLT_MESSAGE_ERROR_OK)
     {
+        if (ret == DLT_MESSAGE_ERROR_CONTENT)
+        {
+            /* corrupted message, skip its user header to resync to the next one */
+            dlt_receiver_remove(rec, sizeof(DltUserHeader));
+            return DLT_DAEMON_ERROR_OK;
+        }
+
         if(ret!=DLT_MESSAGE_ERROR_SIZE)
         {
             /* This is a normal usecase: The daemon reads the data in 10kb chunks.
@@ -2849,6 +3178,13 @@ int dlt_daemon_process_user_message_log(DltDaemon *daemon,
         return DLT_DAEMON_ERROR_UNKNOWN;
     }
 
+    payload = (uint8_t *)rec->buf + sizeof(DltUserHeader) +
+              daemon_local->msg.headersize - sizeof(DltStorageHeader);
+    if (daemon_local->msg.found_serialheader)
+    {
+        payload += sizeof(dltSerialHeader);
+    }
+
     /* set overwrite ecu id */
     if ((daemon_local->flags.evalue[0]) && (strncmp(daemon_local->msg.headerextra.ecu,DLT_DAEMON_ECU_ID,4)==0))
     {
@@ -2884,6 +3220,13 @@ int dlt_daemon_process_user_message_log(DltDaemon *daemon,
     }
 
     {
+        uint8_t *databuffer_tmp = daemon_local->msg.databuffer;
+        int32_t databuffersize_tmp = daemon_local->msg.databuffersize;
+
+        /* print functions read the payload from the message */
+        daemon_local->msg.databuffer = payload;
+        daemon_local->msg.databuffersize = daemon_local->msg.datasize;
+
         /* if no filter set or filter is matching display message */
         if (daemon_local->flags.xflag)
         {
@@ -2908,6 +3251,9 @@ int dlt_daemon_process_user_message_log(DltDaemon *daemon,
             /* print message header only */
         } /* if */
 
+        /* Restore variables */
+        daemon_local->msg.databuffer = databuffer_tmp;
+        daemon_local->msg.databuffersize = databuffersize_tmp;
 
         /* check if overflow occurred */
         if(daemon->overflow_counter)
@@ -2922,7 +3268,7 @@ int dlt_daemon_process_user_message_log(DltDaemon *daemon,
 
         /* send message to client or write to log file */
         if((ret = dlt_daemon_client_send(DLT_DAEMON_SEND_TO_ALL,daemon,daemon_local,daemon_local->msg.headerbuffer,sizeof(DltStorageHeader),daemon_local->msg.headerbuffer+sizeof(DltStorageHeader),daemon_local->msg.headersize-sizeof(DltStorageHeader),
-                            daemon_local->msg.databuffer,daemon_local->msg.datasize,verbose)))
+                            payload,daemon_local->msg.datasize,verbose)))
         {
             if(ret == DLT_DAEMON_ERROR_BUFFER_FULL)
             {
@@ -2948,164 +3294,408 @@ int dlt_daemon_process_user_message_log(DltDaemon *daemon,
 }
 
 #ifdef DLT_SHM_ENABLE
-#define DLT_SHM_RCV_BUFFER_SIZE 10000
+/* Maximum number of messages taken from one ring before other events are handled */
+#define DLT_DAEMON_SHM_DRAIN_BUDGET 256
+
+/* Number of descriptors an application passes for one ring: memfd and eventfd */
+#define DLT_DAEMON_SHM_FDS 2
+
+static DltShm *dlt_daemon_shm_find(DltDaemonLocal *daemon_local, int eventfd)
+{
+    DltShm *ring;
+
+    for (ring = daemon_local->shm_rings; ring != NULL; ring = ring->next)
+    {
+        if ((ring->head != NULL) && (ring->eventfd == eventfd))
+        {
+            return ring;
+        }
+    }
+
+    return NULL;
+}
+
+static void dlt_daemon_shm_destroy(DltDaemonLocal *daemon_local, DltShm *ring)
+{
+    DltShm **prev = &daemon_local->shm_rings;
+
+    while ((*prev != NULL) && (*prev != ring))
+    {
+        prev = &(*prev)->next;
+    }
+
+    if (*prev != NULL)
+    {
+        *prev = ring->next;
+    }
+
+    if (ring->eventfd >= 0)
+    {
+        /* the connection owns the eventfd once the ring is registered */
+        if (dlt_event_handler_find_connection(&daemon_local->pEvent, ring->eventfd) != NULL)
+        {
+            dlt_event_handler_unregister_connection(&daemon_local->pEvent,
+                                                    daemon_local,
+                                                    ring->eventfd);
+        }
+        else
+        {
+            close(ring->eventfd);
+        }
+        ring->eventfd = -1;
+    }
+
+    dlt_shm_free_server(ring);
+    free(ring);
+}
+
+static void dlt_daemon_shm_free_rings(DltDaemonLocal *daemon_local)
+{
+    while (daemon_local->shm_rings != NULL)
+    {
+        dlt_daemon_shm_destroy(daemon_local, daemon_local->shm_rings);
+    }
+}
+
+/**
+ * Add descriptors received from an application.
+ * The ring is mapped when the registration message is processed, which
+ * follows the descriptors in the stream.
+ */
+static void dlt_daemon_shm_add_pending(DltDaemonLocal *daemon_local, int owner, int *fds, int nfds)
+{
+    DltShm *ring;
+    DltShm **last = &daemon_local->shm_rings;
+    int i;
+
+    ring = calloc(1, sizeof(DltShm));
+
+    if ((nfds != DLT_DAEMON_SHM_FDS) || (ring == NULL))
+    {
+        dlt_log(LOG_WARNING, "Unexpected descriptors received from application\n");
+        for (i = 0; i < nfds; i++)
+        {
+            close(fds[i]);
+        }
+        free(ring);
+        return;
+    }
+
+    ring->owner = owner;
+    ring->memfd = fds[0];
+    ring->eventfd = fds[1];
+
+    /* never block the daemon on a descriptor provided by an application */
+    fcntl(ring->eventfd, F_SETFL, fcntl(ring->eventfd, F_GETFL, 0) | O_NONBLOCK);
+
+    /* keep order of reception, registrations are matched in the same order */
+    while (*last != NULL)
+    {
+        last = &(*last)->next;
+    }
+    *last = ring;
+}
+
+/**
+ * Receive from an application socket like dlt_receiver_receive(),
+ * additionally taking over passed descriptors of shared memory rings.
+ */
+static int dlt_daemon_shm_receive(DltDaemonLocal *daemon_local, DltReceiver *receiver)
+{
+    struct msghdr msg;
+    struct iovec iov;
+    struct cmsghdr *cmsg;
+    char control[CMSG_SPACE(sizeof(int) * DLT_DAEMON_SHM_FDS)];
+    ssize_t ret;
+
+    if ((receiver == NULL) || (receiver->buffer == NULL))
+    {
+        return -1;
+    }
+
+    receiver->buf = (char *)receiver->buffer;
+    receiver->lastBytesRcvd = receiver->bytesRcvd;
+
+    iov.iov_base = receiver->buf + receiver->lastBytesRcvd;
+    iov.iov_len = receiver->buffersize - receiver->lastBytesRcvd;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ret = recvmsg(receiver->fd, &msg, MSG_CMSG_CLOEXEC);
+
+    if (ret > 0)
+    {
+        for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_RIGHTS))
+            {
+                int fds[DLT_DAEMON_SHM_FDS];
+                int nfds = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+
+                if (nfds > DLT_DAEMON_SHM_FDS)
+                {
+                    nfds = DLT_DAEMON_SHM_FDS;
+                }
+
+                memcpy(fds, CMSG_DATA(cmsg), sizeof(int) * nfds);
+                dlt_daemon_shm_add_pending(daemon_local, receiver->fd, fds, nfds);
+            }
+        }
+
+        if (msg.msg_flags & MSG_CTRUNC)
+        {
+            dlt_log(LOG_WARNING, "Descriptors received from application truncated\n");
+        }
+    }
+
+    if (ret <= 0)
+    {
+        receiver->bytesRcvd = 0;
+
+        return receiver->bytesRcvd;
+    }
+
+    receiver->bytesRcvd = ret;
+    receiver->totalBytesRcvd += receiver->bytesRcvd;
+    receiver->bytesRcvd += receiver->lastBytesRcvd;
+
+    return receiver->bytesRcvd;
+}
+
+/**
+ * Forward messages of a ring.
+ * @return 1 if the budget was exhausted and messages are left, 0 otherwise
+ */
+static int dlt_daemon_shm_drain(DltDaemon *daemon,
+                                DltDaemonLocal *daemon_local,
+                                DltShm *ring,
+                                int budget,
+                                int verbose)
+{
+    DltReceiver rec;
+    DltUserHeader *userheader;
+    unsigned char data[DLT_DAEMON_RCVBUFSIZE];
+    int size;
+    int num;
+
+    for (num = 0; num < budget; num++)
+    {
+        /* the application can modify the ring anytime, only parse a copy */
+        size = dlt_shm_copy(ring, data, sizeof(data));
+
+        if (size == 0)
+        {
+            return 0;
+        }
+
+        if (size < 0)
+        {
+            /* ring corrupted, drop its content */
+            dlt_shm_reset(ring);
+            return 0;
+        }
+
+        userheader = (DltUserHeader *)data;
+
+        if ((size < (int)sizeof(DltUserHeader)) ||
+            (size > (int)sizeof(data)) ||
+            !dlt_user_check_userheader(userheader) ||
+            (userheader->message != DLT_USER_MESSAGE_LOG))
+        {
+            dlt_log(LOG_WARNING, "Invalid message in shared memory ring\n");
+        }
+        else
+        {
+            memset(&rec, 0, sizeof(rec));
+            rec.fd = ring->owner;
+            rec.buffer = (char *)data;
+            rec.buf = (char *)data;
+            rec.buffersize = size;
+            rec.bytesRcvd = size;
+
+            dlt_daemon_process_user_message_log(daemon, daemon_local, &rec, verbose);
+        }
+
+        dlt_shm_remove(ring);
+    }
+
+    return 1;
+}
+
+static void dlt_daemon_shm_remove_rings(DltDaemon *daemon,
+                                        DltDaemonLocal *daemon_local,
+                                        int owner,
+                                        int verbose)
+{
+    DltShm *ring = daemon_local->shm_rings;
+    DltShm *next;
+
+    while (ring != NULL)
+    {
+        next = ring->next;
+
+        if (ring->owner == owner)
+        {
+            /* application is gone, forward what it left behind */
+            if (ring->head != NULL)
+            {
+                while (dlt_daemon_shm_drain(daemon,
+                                            daemon_local,
+                                            ring,
+                                            DLT_DAEMON_SHM_DRAIN_BUDGET,
+                                            verbose))
+                {
+                    ;
+                }
+            }
+
+            dlt_daemon_shm_destroy(daemon_local, ring);
+        }
+
+        ring = next;
+    }
+}
+
 int dlt_daemon_process_user_message_log_shm(DltDaemon *daemon,
                                             DltDaemonLocal *daemon_local,
                                             DltReceiver *rec,
                                             int verbose)
 {
-    char local_str[DLT_DAEMON_TEXTBUFSIZE] = { '\0' };
-    int j,sent,third_value;
-    ssize_t ret;
-    uint8_t *rcv_buffer = NULL;
-    int size;
-    uint32_t len = sizeof(DltUserHeader);
-    DltUserHeader userheader;
-
-    static char text[DLT_DAEMON_TEXTSIZE];
+    DltUserControlMsgShmRegister usercontext;
+    DltShm *ring;
+    uint32_t len = sizeof(DltUserControlMsgShmRegister);
 
     PRINT_FUNCTION_VERBOSE(verbose);
 
-    if ((daemon == NULL)  || (daemon_local == NULL) || (rec == NULL))
+    if ((daemon == NULL) || (daemon_local == NULL) || (rec == NULL))
     {
-        snprintf(local_str,
-                 DLT_DAEMON_TEXTBUFSIZE,
-                 "Invalid function parameters used for %s\n",
-                 __func__);
+        dlt_vlog(LOG_ERR, "Invalid function parameters used for %s\n", __func__);
+        return -1;
+    }
 
-        dlt_log(LOG_ERR, local_str);
+    memset(&usercontext, 0, len);
+
+    if (dlt_receiver_check_and_get(rec,
+                                   &usercontext,
+                                   len,
+                                   DLT_RCV_SKIP_HEADER | DLT_RCV_REMOVE) < 0)
+    {
+        /* Not enough bytes received */
         return -1;
     }
 
-    rcv_buffer = calloc(1, DLT_SHM_RCV_BUFFER_SIZE);
+    /* descriptors were received along with this message */
+    for (ring = daemon_local->shm_rings; ring != NULL; ring = ring->next)
+    {
+        if ((ring->owner == rec->fd) && (ring->head == NULL))
+        {
+            break;
+        }
+    }
 
-    if (!rcv_buffer)
+    if (ring == NULL)
     {
-        snprintf(local_str,
-                 DLT_DAEMON_TEXTBUFSIZE,
-                 "No memory to allocate receiver buffer in %s.\n",
-                 __func__);
+        dlt_vlog(LOG_WARNING,
+                 "No descriptors received for shared memory ring of pid %d\n",
+                 (int)usercontext.pid);
+        return 0;
+    }
 
-        dlt_log(LOG_ERR, local_str);
+    ring->pid = usercontext.pid;
 
-        return -1;
+    if ((dlt_shm_init_server(ring, daemon_local->flags.sharedMemorySize) < DLT_RETURN_OK) ||
+        (dlt_connection_create(daemon_local,
+                               &daemon_local->pEvent,
+                               ring->eventfd,
+                               EPOLLIN,
+                               DLT_CONNECTION_APP_RING) != 0))
+    {
+        dlt_vlog(LOG_WARNING,
+                 "Can't register shared memory ring of pid %d\n",
+                 (int)usercontext.pid);
+        dlt_daemon_shm_destroy(daemon_local, ring);
+        return 0;
+    }
+
+    if (verbose)
+    {
+        dlt_vlog(LOG_INFO,
+                 "Shared memory ring of pid %d registered, size %u\n",
+                 (int)usercontext.pid,
+                 ring->size);
     }
 
-    memset(&userheader, 0, len);
+    return 0;
+}
 
-    if (dlt_receiver_check_and_get(rec, &userheader, len, DLT_RCV_REMOVE) < 0)
+int dlt_daemon_process_user_ring(DltDaemon *daemon,
+                                 DltDaemonLocal *daemon_local,
+                                 DltReceiver *rec,
+                                 int verbose)
+{
+    DltShm *ring;
+
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if ((daemon == NULL) || (daemon_local == NULL) || (rec == NULL))
     {
-        /* Not enough bytes received */
+        dlt_vlog(LOG_ERR, "Invalid function parameters used for %s\n", __func__);
         return -1;
     }
 
-	//dlt_shm_status(&(daemon_local->dlt_shm));
-	while (1)
+    ring = dlt_daemon_shm_find(daemon_local, rec->fd);
+
+    if (ring == NULL)
     {
-        /* log message in SHM */
-        size = dlt_shm_copy(&(daemon_local->dlt_shm),
-                            rcv_buffer,
-                            DLT_SHM_RCV_BUFFER_SIZE);
-        if(size <= 0)
-            break;
+        dlt_log(LOG_WARNING, "Event for unknown shared memory ring\n");
+        dlt_event_handler_unregister_connection(&daemon_local->pEvent,
+                                                daemon_local,
+                                                rec->fd);
+        return 0;
+    }
 
-		if (dlt_message_read(&(daemon_local->msg),rcv_buffer,size,0,verbose)!=0) {
-			break;
-			dlt_log(LOG_WARNING,"Can't read messages from shm\n");
-			return -1;
-		}
-
-		/* set overwrite ecu id */
-		if ((daemon_local->flags.evalue[0]) && (strncmp(daemon_local->msg.headerextra.ecu,DLT_DAEMON_ECU_ID,4)==0))
-		{
-			/* Set header extra parameters */
-			dlt_set_id(daemon_local->msg.headerextra.ecu, daemon->ecuid );
-			//msg.headerextra.seid = 0;
-			if (dlt_message_set_extraparameters(&(daemon_local->msg),0)==-1)
-			{
-				dlt_log(LOG_WARNING,"Can't set message extra parameters in process user message log\n");
-				dlt_shm_remove(&(daemon_local->dlt_shm));
-				return -1;
-			}
-
-			/* Correct value of timestamp, this was changed by dlt_message_set_extraparameters() */
-			daemon_local->msg.headerextra.tmsp = DLT_BETOH_32(daemon_local->msg.headerextra.tmsp);
-		}
-
-		/* prepare storage header */
-		if (DLT_IS_HTYP_WEID(daemon_local->msg.standardheader->htyp))
-		{
-			if (dlt_set_storageheader(daemon_local->msg.storageheader,daemon_local->msg.headerextra.ecu)==-1)
-			{
-				dlt_log(LOG_WARNING,"Can't set storage header in process user message log\n");
-				dlt_shm_remove(&(daemon_local->dlt_shm));
-				return -1;
-			}
-		}
-		else
-		{
-			if (dlt_set_storageheader(daemon_local->msg.storageheader,daemon->ecuid)==-1)
-			{
-				dlt_log(LOG_WARNING,"Can't set storage header in process user message log\n");
-				dlt_shm_remove(&(daemon_local->dlt_shm));
-				return -1;
-			}
-		}
-
-		/* display message */
-		if (daemon_local->flags.xflag)
-		{
-			if (dlt_message_print_hex(&(daemon_local->msg),text,DLT_DAEMON_TEXTSIZE,verbose)==-1)
-			{
-				dlt_log(LOG_WARNING,"dlt_message_print_hex() failed!\n");
-			}
-		} /*  if */
-		else if (daemon_local->flags.aflag)
-		{
-			if (dlt_message_print_ascii(&(daemon_local->msg),text,DLT_DAEMON_TEXTSIZE,verbose)==-1)
-			{
-				dlt_log(LOG_WARNING,"dlt_message_print_ascii() failed!\n");
-			}
-		} /* if */
-		else if (daemon_local->flags.sflag)
-		{
-			if (dlt_message_print_header(&(daemon_local->msg),text,DLT_DAEMON_TEXTSIZE,verbose)==-1)
-			{
-				dlt_log(LOG_WARNING,"dlt_message_print_header() failed!\n");
-			}
-			/* print message header only */
-		} /* if */
-
-		sent=0;
-
-		/* write message to offline trace */
-		if(daemon_local->flags.offlineTraceDirectory[0])
-		{
-			dlt_offline_trace_write(&(daemon_local->offlineTrace),daemon_local->msg.headerbuffer,daemon_local->msg.headersize,
-									daemon_local->msg.databuffer,daemon_local->msg.datasize,0,0);
-			sent = 1;
-		}
-
-        sent = dlt_daemon_client_send_all(daemon, daemon_local, verbose);
-
-        /* Message was not sent to client, so store it in client ringbuffer */
-        if (sent == 1)
-        {
-            if(userheader.message == DLT_USER_MESSAGE_LOG_SHM) {
-                /* dlt message was sent, remove from buffer if log message from shm */
-                dlt_shm_remove(&(daemon_local->dlt_shm));
-            }
+    /* clear the doorbell before draining, the application rings it again
+     * as soon as it finds the ring empty */
+    dlt_shm_ack(ring);
+
+    if (dlt_daemon_shm_drain(daemon,
+                             daemon_local,
+                             ring,
+                             DLT_DAEMON_SHM_DRAIN_BUDGET,
+                             verbose))
+    {
+        /* be fair to other rings and connections, continue later */
+        dlt_shm_notify(ring);
+    }
+    else if (dlt_shm_is_closed(ring))
+    {
+        /* producing thread is gone, take what it wrote before closing */
+        while (dlt_daemon_shm_drain(daemon,
+                                    daemon_local,
+                                    ring,
+                                    DLT_DAEMON_SHM_DRAIN_BUDGET,
+                                    verbose))
+        {
+            ;
         }
-        else
+
+        if (verbose)
         {
-            /* dlt message was not sent, keep in buffer */
-            break;
+            dlt_vlog(LOG_INFO,
+                     "Shared memory ring of pid %d closed, %d messages dropped\n",
+                     (int)ring->pid,
+                     dlt_shm_get_dropped_count(ring));
         }
+
+        dlt_daemon_shm_destroy(daemon_local, ring);
     }
 
     return 0;
 }
-#undef DLT_SHM_RCV_BUFFER_SIZE
 #endif
 
 int dlt_daemon_process_user_message_set_app_ll_ts(DltDaemon *daemon,
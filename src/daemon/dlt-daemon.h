@@ -78,6 +78,8 @@
 #include "dlt_daemon_event_handler_types.h"
 #include "dlt_gateway_types.h"
 #include "dlt_offline_trace.h"
+#include "dlt_daemon_ingest.h"
+#include "dlt_daemon_storage.h"
 
 #define DLT_DAEMON_FLAG_MAX 256
 
@@ -100,12 +102,19 @@ typedef struct
     char yvalue[NAME_MAX + 1];   /**< (String: Devicename) Additional support for serial device */
     char ivalue[NAME_MAX + 1];   /**< (String: Directory) Directory where to store the persistant configuration (Default: /tmp) */
     char cvalue[NAME_MAX + 1];   /**< (String: Directory) Filename of DLT configuration file (Default: /etc/dlt.conf) */
-    int  sharedMemorySize;       /**< (int) Size of shared memory (Default: 100000) */
+    int  sharedMemorySize;       /**< (int) Maximum size of the shared memory ring of an application thread (Default: 1048576) */
+    int  clientSendQueueSize;    /**< (int) Maximum size of the outgoing queue of a client connection (Default: 1048576) */
+    int  clientSendQueueHighWatermark; /**< (int) Percentage of the outgoing queue from which messages to a client are dropped (Default: 90) */
+    int  clientSendQueueLowWatermark;  /**< (int) Percentage of the outgoing queue below which a client gets messages again (Default: 50) */
+    int  ingestThreads;          /**< (int) Number of threads receiving from applications, 0 receives in the main loop (Default: 0) */
+    int  storageQueueSize;       /**< (int) Number of messages queued per storage target for the storage thread, 0 writes in the main loop (Default: 0) */
     int  sendMessageTime;       /**< (Boolean) Send periodic Message Time if client is connected (Default: 0) */
     char offlineTraceDirectory[DLT_DAEMON_FLAG_MAX]; /**< (String: Directory) Store DLT messages to local directory (Default: /etc/dlt.conf) */
     int  offlineTraceFileSize;    /**< (int) Maximum size in bytes of one trace file (Default: 1000000) */
     int  offlineTraceMaxSize;    /**< (int) Maximum size of all trace files (Default: 4000000) */
     int  offlineTraceFilenameTimestampBased; /**< (int) timestamp based or index based (Default: 1 Timestamp based) */
+    int  offlineTraceBufferSize; /**< (int) Size of the buffer collecting messages before they are written (Default: 0) */
+    int  offlineTraceFlushInterval; /**< (int) Maximum time in ms a message stays in the buffer (Default: 1000) */
     int  loggingMode;    /**< (int) The logging console for internal logging of dlt-daemon (Default: 0) */
     int  loggingLevel;    /**< (int) The logging level for internal logging of dlt-daemon (Default: 6) */
     char loggingFilename[DLT_DAEMON_FLAG_MAX]; /**< (String: Filename) The logging filename if internal logging mode is log to file (Default: /tmp/log) */
@@ -147,8 +156,10 @@ typedef struct
     int client_connections;    /**< counter for nr. of client connections */
     size_t baudrate;          /**< Baudrate of serial connection */
 #ifdef DLT_SHM_ENABLE
-    DltShm dlt_shm;                /**< Shared memory handling */
+    DltShm *shm_rings;        /**< Shared memory rings registered by applications */
 #endif
+    DltDaemonIngest ingest;   /**< Workers receiving from application connections */
+    DltDaemonStorage storage; /**< Thread writing offline trace and logstorage */
     DltOfflineTrace offlineTrace; /**< Offline trace handling */
     int timeoutOnSend;
     unsigned long RingbufferMinSize;
@@ -182,6 +193,8 @@ void dlt_daemon_local_cleanup(DltDaemon *daemon, DltDaemonLocal *daemon_local, i
 int dlt_daemon_local_init_p1(DltDaemon *daemon, DltDaemonLocal *daemon_local, int verbose);
 int dlt_daemon_local_init_p2(DltDaemon *daemon, DltDaemonLocal *daemon_local, int verbose);
 int dlt_daemon_local_connection_init(DltDaemon *daemon, DltDaemonLocal *daemon_local, int verbose);
+int dlt_daemon_local_ingest_init(DltDaemonLocal *daemon_local, int verbose);
+int dlt_daemon_local_storage_init(DltDaemon *daemon, DltDaemonLocal *daemon_local, int verbose);
 int dlt_daemon_local_ecu_version_init(DltDaemon *daemon, DltDaemonLocal *daemon_local, int verbose);
 
 void dlt_daemon_daemonize(int verbose);
@@ -211,7 +224,9 @@ int dlt_daemon_process_user_message_unregister_context(DltDaemon *daemon, DltDae
 int dlt_daemon_process_user_message_log(DltDaemon *daemon, DltDaemonLocal *daemon_local, DltReceiver *rec, int verbose);
 #ifdef DLT_SHM_ENABLE
 int dlt_daemon_process_user_message_log_shm(DltDaemon *daemon, DltDaemonLocal *daemon_local, DltReceiver *rec, int verbose);
+int dlt_daemon_process_user_ring(DltDaemon *daemon, DltDaemonLocal *daemon_local, DltReceiver *rec, int verbose);
 #endif
+int dlt_daemon_process_user_ingest(DltDaemon *daemon, DltDaemonLocal *daemon_local, DltReceiver *rec, int verbose);
 int dlt_daemon_process_user_message_set_app_ll_ts(DltDaemon *daemon, DltDaemonLocal *daemon_local, DltReceiver *rec, int verbose);
 int dlt_daemon_process_user_message_marker(DltDaemon *daemon, DltDaemonLocal *daemon_local, DltReceiver *rec, int verbose);
 
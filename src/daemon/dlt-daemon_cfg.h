@@ -80,6 +80,34 @@
 
 /* Size of receive buffer for fifo connection  (from user application) */
 #define DLT_DAEMON_RCVBUFSIZE       10024
+/* Initial size of receive buffer for user application messages, grows under load */
+#define DLT_DAEMON_RCVBUFSIZE_APP   65536
+/* Maximum size of receive buffer for user application messages */
+#define DLT_DAEMON_RCVBUFSIZE_APP_MAX 1048576
+/* Size of the queue from one ingest worker to the main loop, power of two */
+#define DLT_DAEMON_INGEST_QUEUE_SIZE 1048576
+/* Maximum number of queued messages handled at once before other events */
+#define DLT_DAEMON_INGEST_DRAIN_BUDGET 256
+/* Time in milliseconds a worker waits for queue space before checking for stop */
+#define DLT_DAEMON_INGEST_WAIT_MSEC 100
+/* Maximum number of messages of one target written before the storage lock is released */
+#define DLT_DAEMON_STORAGE_BATCH 256
+/* Period in milliseconds of due flushes of offline trace and logstorage in the storage thread */
+#define DLT_DAEMON_STORAGE_FLUSH_MSEC 1000
+/* Initial size of the outgoing queue of a client connection, grows under load */
+#define DLT_DAEMON_SNDQUEUESIZE     16384
+/* Default maximum backlog of the outgoing queue of a client connection */
+#define DLT_DAEMON_SNDQUEUESIZE_MAX 1048576
+/* Queued bytes of a client connection sent at once without waiting for the main loop */
+#define DLT_DAEMON_SNDQUEUE_FLUSH   16384
+/* Default percentage of the client send queue from which messages are dropped */
+#define DLT_DAEMON_SNDQUEUE_HIGH_WATERMARK 90
+/* Default percentage of the client send queue below which a dropping client recovers */
+#define DLT_DAEMON_SNDQUEUE_LOW_WATERMARK  50
+/* Default maximum time in milliseconds a message stays in the offline trace buffer */
+#define DLT_DAEMON_OFFLINE_TRACE_FLUSH_INTERVAL 1000
+/* Time in milliseconds to wait for a client to take buffered history */
+#define DLT_DAEMON_SNDQUEUE_WAIT_MSEC 4000
 /* Size of receive buffer for socket connection (from dlt client) */
 #define DLT_DAEMON_RCVBUFSIZESOCK   10024
 /* Size of receive buffer for serial connection (from dlt client) */
@@ -64,6 +64,7 @@
 
 #include "dlt_daemon_client.h"
 #include "dlt_daemon_connection.h"
+#include "dlt_daemon_event_handler.h"
 
 #include "dlt_daemon_offline_logstorage.h"
 #include "dlt_gateway.h"
@@ -96,10 +97,69 @@ static inline int8_t getStatus(uint8_t request_log, int context_log)
     return (request_log <= context_log)? request_log : context_log;
 }
 
+/** @brief Prepares a message to be checked by client filters.
+ *
+ * The message is given like sent to clients, without storage header, as
+ * header and payload or as one block. Only the headers are copied, the
+ * payload is referenced.
+ *
+ * @param msg Message to be prepared.
+ * @param data1 The first part of the message.
+ * @param size1 The size of the first part.
+ * @param data2 The second part of the message.
+ * @param size2 The size of the second part.
+ *
+ * @return 0 on success, -1 if the message cannot be parsed.
+ */
+static int dlt_daemon_client_filter_message(DltMessage *msg,
+                                            void *data1,
+                                            int size1,
+                                            void *data2,
+                                            int size2)
+{
+    int32_t headersize;
+
+    if ((data1 == NULL) || (size1 < (int) sizeof(DltStandardHeader)))
+    {
+        return -1;
+    }
+
+    headersize = sizeof(DltStandardHeader) +
+        DLT_STANDARD_HEADER_EXTRA_SIZE(((DltStandardHeader *) data1)->htyp) +
+        (DLT_IS_HTYP_UEH(((DltStandardHeader *) data1)->htyp) ? sizeof(DltExtendedHeader) : 0);
+
+    if (size1 < headersize)
+    {
+        return -1;
+    }
+
+    memcpy(msg->headerbuffer + sizeof(DltStorageHeader), data1, headersize);
+    msg->storageheader = NULL;
+    msg->standardheader = (DltStandardHeader *) (msg->headerbuffer + sizeof(DltStorageHeader));
+    msg->extendedheader = (DltExtendedHeader *) (msg->headerbuffer + sizeof(DltStorageHeader) +
+                                                 headersize - sizeof(DltExtendedHeader));
+    dlt_message_get_extraparameters(msg, 0);
+
+    if (size1 > headersize)
+    {
+        /* message in one block, e.g. from the history buffer */
+        msg->databuffer = (uint8_t *) data1 + headersize;
+        msg->datasize = size1 - headersize;
+    }
+    else
+    {
+        msg->databuffer = (uint8_t *) data2;
+        msg->datasize = (data2 != NULL) ? size2 : 0;
+    }
+
+    return 0;
+}
+
 /** @brief Sends up to 2 messages to all the clients.
  *
  * Runs through the client list and sends the messages to them. If the message
  * transfer fails and the connection is a socket connection, the socket is closed.
+ * Clients with a filter only get the messages matching it.
  * Takes and release dlt_daemon_mutex.
  *
  * @param daemon Daemon structure needed for socket closure.
@@ -108,6 +168,7 @@ static inline int8_t getStatus(uint8_t request_log, int context_log)
  * @param size1 The size of the first message.
  * @param data2 The second message to be send.
  * @param size2 The second message size.
+ * @param wait Wait for slow clients instead of dropping the message.
  * @param verbose Needed for socket closure.
  *
  * @return The amount of data transfered.
@@ -118,6 +179,7 @@ static int dlt_daemon_client_send_all_multiple(DltDaemon *daemon,
                                                int size1,
                                                void* data2,
                                                int size2,
+                                               int wait,
                                                int verbose)
 {
     int j, sent = 0;
@@ -125,6 +187,8 @@ static int dlt_daemon_client_send_all_multiple(DltDaemon *daemon,
     int type_mask =
         (DLT_CON_MASK_CLIENT_MSG_TCP | DLT_CON_MASK_CLIENT_MSG_SERIAL);
     char local_str[DLT_DAEMON_TEXTBUFSIZE];
+    DltMessage msg;
+    int prepared = 0; /* 1 if msg is prepared for filters, -1 if it cannot be parsed */
 
     if ((daemon == NULL) || (daemon_local == NULL))
     {
@@ -146,17 +210,42 @@ static int dlt_daemon_client_send_all_multiple(DltDaemon *daemon,
     for (j = 0; ((j < daemon_local->client_connections) && (temp != NULL)); j++)
     {
         int ret = 0;
-        DLT_DAEMON_SEM_LOCK();
         DltConnection *next = dlt_connection_get_next(temp->next, type_mask);
 
-        ret = dlt_connection_send_multiple(temp,
-                                          data1,
-                                          size1,
-                                          data2,
-                                          size2,
-                                          daemon->sendserialheader);
+        if (temp->filter != NULL)
+        {
+            /* the message is parsed once for all clients with a filter */
+            if (prepared == 0)
+            {
+                prepared = (dlt_daemon_client_filter_message(&msg, data1, size1, data2, size2) == 0) ? 1 : -1;
+            }
+
+            if ((prepared == 1) &&
+                (dlt_message_filter_check(&msg, temp->filter, 0) != DLT_RETURN_TRUE))
+            {
+                /* not requested by the client, counts as delivered */
+                sent = 1;
+                temp = next;
+                continue;
+            }
+        }
+
+        DLT_DAEMON_SEM_LOCK();
+
+        ret = dlt_connection_queue_multiple(temp,
+                                            data1,
+                                            size1,
+                                            data2,
+                                            size2,
+                                            daemon->sendserialheader,
+                                            wait);
         DLT_DAEMON_SEM_FREE();
 
+        if (ret == DLT_DAEMON_ERROR_OK)
+        {
+            dlt_connection_check_output(&daemon_local->pEvent, temp);
+        }
+
         if((ret != DLT_DAEMON_ERROR_OK) &&
            DLT_CONNECTION_CLIENT_MSG_TCP == temp->type)
         {
@@ -231,6 +320,7 @@ int dlt_daemon_client_send_all(DltDaemon *daemon,
                                                msg1_sz,
                                                msg2,
                                                msg2_sz,
+                                               0,
                                                verbose);
 
     return ret;
@@ -258,9 +348,26 @@ int dlt_daemon_client_send(int sock,DltDaemon *daemon,DltDaemonLocal *daemon_loc
         }
         else
         {
+            DltConnection *con = dlt_event_handler_find_connection(&daemon_local->pEvent, sock);
+
             DLT_DAEMON_SEM_LOCK();
 
-            if((ret=dlt_daemon_socket_send(sock,data1,size1,data2,size2,daemon->sendserialheader)))
+            if ((con != NULL) && (con->queue != NULL))
+            {
+                /* keep the order of messages queued for this client */
+                ret = dlt_connection_queue_multiple(con,data1,size1,data2,size2,daemon->sendserialheader,0);
+
+                if (ret == DLT_DAEMON_ERROR_OK)
+                {
+                    dlt_connection_check_output(&daemon_local->pEvent, con);
+                }
+            }
+            else
+            {
+                ret = dlt_daemon_socket_send(sock,data1,size1,data2,size2,daemon->sendserialheader);
+            }
+
+            if(ret)
             {
                 DLT_DAEMON_SEM_FREE();
                 dlt_log(LOG_WARNING,"dlt_daemon_client_send: socket send dlt message failed\n");
@@ -276,7 +383,23 @@ int dlt_daemon_client_send(int sock,DltDaemon *daemon,DltDaemonLocal *daemon_loc
 	// In the SEND_BUFFER state we must skip offline tracing because the offline traces
 	// are going without buffering directly to the offline trace. Thus we have to filter out
 	// the traces that are coming from the buffer.
-	if ((sock!=DLT_DAEMON_SEND_FORCE) && (daemon->state != DLT_DAEMON_STATE_SEND_BUFFER))
+	if ((sock!=DLT_DAEMON_SEND_FORCE) && (daemon->state != DLT_DAEMON_STATE_SEND_BUFFER) &&
+	    daemon_local->storage.running)
+	{
+        /* the storage thread writes offline trace and logstorage */
+        dlt_daemon_storage_write(&daemon_local->storage,
+                                 ((daemon->mode == DLT_USER_MODE_INTERNAL) ||
+                                  (daemon->mode == DLT_USER_MODE_BOTH)) &&
+                                 daemon_local->flags.offlineTraceDirectory[0],
+                                 daemon_local->flags.offlineLogstorageMaxDevices > 0,
+                                 storage_header,
+                                 storage_header_size,
+                                 data1,
+                                 size1,
+                                 data2,
+                                 size2);
+	}
+	else if ((sock!=DLT_DAEMON_SEND_FORCE) && (daemon->state != DLT_DAEMON_STATE_SEND_BUFFER))
 	{
 		if(((daemon->mode == DLT_USER_MODE_INTERNAL) || (daemon->mode == DLT_USER_MODE_BOTH))
 							&& daemon_local->flags.offlineTraceDirectory[0])
@@ -313,12 +436,14 @@ int dlt_daemon_client_send(int sock,DltDaemon *daemon,DltDaemonLocal *daemon_loc
 	{
 		if ((sock==DLT_DAEMON_SEND_FORCE) || (daemon->state == DLT_DAEMON_STATE_SEND_DIRECT))
 		{
+            /* history is not dropped for slow clients */
             sent = dlt_daemon_client_send_all_multiple(daemon,
                                                        daemon_local,
                                                        data1,
                                                        size1,
                                                        data2,
                                                        size2,
+                                                       (sock==DLT_DAEMON_SEND_FORCE),
                                                        verbose);
 
 			if((sock==DLT_DAEMON_SEND_FORCE) && !sent)
@@ -622,6 +747,11 @@ int dlt_daemon_client_process_control(int sock, DltDaemon *daemon, DltDaemonLoca
                                                           verbose);
             break;
         }
+        case DLT_SERVICE_ID_SET_CLIENT_FILTER:
+        {
+            dlt_daemon_control_set_client_filter(sock, daemon, daemon_local, msg, verbose);
+            break;
+        }
         default:
         {
             dlt_daemon_control_service_response(sock, daemon, daemon_local, id, DLT_SERVICE_RESPONSE_NOT_SUPPORTED,  verbose);
@@ -1145,6 +1275,34 @@ void dlt_daemon_control_get_log_info(int sock, DltDaemon *daemon, DltDaemonLocal
     dlt_message_free(&resp,0);
 }
 
+int dlt_daemon_client_report_dropped(DltDaemon *daemon, DltDaemonLocal *daemon_local, DltConnection *con, int verbose)
+{
+    uint32_t dropped;
+
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if ((daemon == NULL) || (daemon_local == NULL) || (con == NULL) || (con->receiver == NULL))
+    {
+        return DLT_DAEMON_ERROR_UNKNOWN;
+    }
+
+    /* report only once the client left the drop mode */
+    if ((con->queue == NULL) || con->queue->degraded || (con->queue->dropped == 0))
+    {
+        return DLT_DAEMON_ERROR_OK;
+    }
+
+    dropped = con->queue->dropped;
+    con->queue->dropped = 0;
+
+    dlt_vlog(LOG_NOTICE,
+             "Client on socket %d caught up, %u messages dropped\n",
+             con->receiver->fd,
+             dropped);
+
+    return dlt_daemon_control_message_buffer_overflow(con->receiver->fd, daemon, daemon_local, dropped, "", verbose);
+}
+
 int dlt_daemon_control_message_buffer_overflow(int sock, DltDaemon *daemon, DltDaemonLocal *daemon_local, unsigned int overflow_counter,char* apid, int verbose)
 {
 	int ret;
@@ -1975,6 +2133,85 @@ void dlt_daemon_control_set_all_log_level(int sock, DltDaemon *daemon, DltDaemon
     }
 }
 
+void dlt_daemon_control_set_client_filter(int sock, DltDaemon *daemon, DltDaemonLocal *daemon_local, DltMessage *msg, int verbose)
+{
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    DltServiceSetClientFilter *req = NULL;
+    int32_t id = DLT_SERVICE_ID_SET_CLIENT_FILTER;
+    DltConnection *con = NULL;
+    DltFilter *filter = NULL;
+    uint32_t length = 0;
+    char *text = NULL;
+
+    if ((daemon == NULL) || (daemon_local == NULL) || (msg == NULL) || (msg->databuffer == NULL))
+    {
+        dlt_vlog(LOG_ERR, "%s: Invalid parameters\n", __func__);
+        return;
+    }
+
+    if (DLT_CHECK_RCV_DATA_SIZE(msg->datasize, sizeof(DltServiceSetClientFilter)) < 0)
+    {
+        return;
+    }
+
+    req = (DltServiceSetClientFilter *) (msg->databuffer);
+    length = DLT_ENDIAN_GET_32(msg->standardheader->htyp, req->length);
+
+    con = dlt_event_handler_find_connection(&daemon_local->pEvent, sock);
+
+    if ((con == NULL) ||
+        ((con->type != DLT_CONNECTION_CLIENT_MSG_TCP) && (con->type != DLT_CONNECTION_CLIENT_MSG_SERIAL)) ||
+        (length > (uint32_t) msg->datasize - sizeof(DltServiceSetClientFilter)))
+    {
+        dlt_daemon_control_service_response(sock, daemon, daemon_local, id, DLT_SERVICE_RESPONSE_ERROR, verbose);
+        return;
+    }
+
+    if (length > 0)
+    {
+        filter = malloc(sizeof(DltFilter));
+        text = malloc(length + 1);
+
+        if ((filter == NULL) || (text == NULL))
+        {
+            free(filter);
+            free(text);
+            dlt_daemon_control_service_response(sock, daemon, daemon_local, id, DLT_SERVICE_RESPONSE_ERROR, verbose);
+            return;
+        }
+
+        memcpy(text, msg->databuffer + sizeof(DltServiceSetClientFilter), length);
+        text[length] = 0;
+
+        dlt_filter_init(filter, verbose);
+
+        if (dlt_filter_parse(filter, text, verbose) < DLT_RETURN_OK)
+        {
+            dlt_filter_free(filter, verbose);
+            free(filter);
+            free(text);
+            dlt_daemon_control_service_response(sock, daemon, daemon_local, id, DLT_SERVICE_RESPONSE_ERROR, verbose);
+            return;
+        }
+
+        free(text);
+    }
+
+    /* an empty filter removes the filter of the client */
+    if (con->filter != NULL)
+    {
+        dlt_filter_free(con->filter, verbose);
+        free(con->filter);
+    }
+
+    con->filter = filter;
+
+    dlt_vlog(LOG_INFO, "Filter of client %d %s\n", sock, (filter != NULL) ? "set" : "removed");
+
+    dlt_daemon_control_service_response(sock, daemon, daemon_local, id, DLT_SERVICE_RESPONSE_OK, verbose);
+}
+
 void dlt_daemon_control_set_default_trace_status(int sock, DltDaemon *daemon, DltDaemonLocal *daemon_local, DltMessage *msg, int verbose)
 {
     PRINT_FUNCTION_VERBOSE(verbose);
@@ -2210,6 +2447,20 @@ int dlt_daemon_process_one_s_timer(DltDaemon *daemon,
         }
     }
 
+    /* buffered offline trace must not wait for the next message,
+     * the storage thread flushes on its own */
+    if (((daemon->mode == DLT_USER_MODE_INTERNAL) || (daemon->mode == DLT_USER_MODE_BOTH)) &&
+        daemon_local->flags.offlineTraceDirectory[0] && !daemon_local->storage.running)
+    {
+        dlt_offline_trace_flush_due(&(daemon_local->offlineTrace), 1000);
+    }
+
+    /* group commits of logstorage filters must not wait for the next message */
+    if ((daemon_local->flags.offlineLogstorageMaxDevices > 0) && !daemon_local->storage.running)
+    {
+        dlt_daemon_logstorage_commit_due(daemon, daemon_local, 1000, verbose);
+    }
+
     if((daemon->timingpackets) &&
        (daemon->state == DLT_DAEMON_STATE_SEND_DIRECT))
     {
@@ -2373,6 +2624,10 @@ void dlt_daemon_control_service_logstorage(int sock, DltDaemon *daemon, DltDaemo
     }
 
     req = (DltServiceOfflineLogstorage*) (msg->databuffer);
+
+    /* devices are written by the storage thread, if running */
+    dlt_daemon_storage_lock(&daemon_local->storage);
+
     int device_index=-1;
     int i=0;
     for(i=0; i < daemon_local->flags.offlineLogstorageMaxDevices; i++)
@@ -2402,6 +2657,7 @@ void dlt_daemon_control_service_logstorage(int sock, DltDaemon *daemon, DltDaemo
                                             DLT_SERVICE_RESPONSE_ERROR,
                                             verbose);
         dlt_log(LOG_WARNING, "MAX devices already in use  \n");
+        dlt_daemon_storage_unlock(&daemon_local->storage);
         return;
     }
 
@@ -2413,6 +2669,7 @@ void dlt_daemon_control_service_logstorage(int sock, DltDaemon *daemon, DltDaemo
         if(ret != 0)
         {
             dlt_daemon_control_service_response(sock, daemon, daemon_local, DLT_SERVICE_ID_OFFLINE_LOGSTORAGE, DLT_SERVICE_RESPONSE_ERROR, verbose);
+            dlt_daemon_storage_unlock(&daemon_local->storage);
             return;
         }
 
@@ -2421,6 +2678,7 @@ void dlt_daemon_control_service_logstorage(int sock, DltDaemon *daemon, DltDaemo
         if(ret != 0)
         {
             dlt_daemon_control_service_response(sock, daemon, daemon_local, DLT_SERVICE_ID_OFFLINE_LOGSTORAGE, DLT_SERVICE_RESPONSE_ERROR, verbose);
+            dlt_daemon_storage_unlock(&daemon_local->storage);
             return;
         }
 
@@ -2471,6 +2729,8 @@ void dlt_daemon_control_service_logstorage(int sock, DltDaemon *daemon, DltDaemo
     {
         dlt_daemon_control_service_response(sock, daemon, daemon_local, DLT_SERVICE_ID_OFFLINE_LOGSTORAGE, DLT_SERVICE_RESPONSE_ERROR, verbose);
     }
+
+    dlt_daemon_storage_unlock(&daemon_local->storage);
 }
 
 void dlt_daemon_control_passive_node_connect(int sock,
@@ -137,6 +137,16 @@ void dlt_daemon_control_get_default_log_level(int sock, DltDaemon *daemon, DltDa
  * @return -1 if there is an error or buffer overflow, else 0
  */
 int dlt_daemon_control_message_buffer_overflow(int sock, DltDaemon *daemon, DltDaemonLocal *daemon_local, unsigned int overflow_counter,char* apid, int verbose);
+/**
+ * Tell a client which caught up again how many messages it lost, by sending
+ * a message buffer overflow control message through its send queue
+ * @param daemon pointer to dlt daemon structure
+ * @param daemon_local pointer to dlt daemon local structure
+ * @param con client connection
+ * @param verbose if set to true verbose information is printed out.
+ * @return -1 if there is an error, else 0
+ */
+int dlt_daemon_client_report_dropped(DltDaemon *daemon, DltDaemonLocal *daemon_local, DltConnection *con, int verbose);
 /**
  * Generate response to control message from dlt client
  * @param sock connection handle used for sending response
@@ -238,6 +248,16 @@ void dlt_daemon_control_set_default_log_level(int sock, DltDaemon *daemon, DltDa
  * @param verbose if set to true verbose information is printed out.
  */
 void dlt_daemon_control_set_all_log_level(int sock, DltDaemon *daemon, DltDaemonLocal *daemon_local, DltMessage *msg, int verbose);
+/**
+ * Process and generate response to received set client filter control message.
+ * The filter applies to the client connection the message was received from.
+ * @param sock connection handle used for sending response
+ * @param daemon pointer to dlt daemon structure
+ * @param daemon_local pointer to dlt daemon local structure
+ * @param msg pointer to received control message
+ * @param verbose if set to true verbose information is printed out.
+ */
+void dlt_daemon_control_set_client_filter(int sock, DltDaemon *daemon, DltDaemonLocal *daemon_local, DltMessage *msg, int verbose);
 
 /**
  * Process and generate response to received set default trace status control message
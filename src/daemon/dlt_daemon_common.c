@@ -77,6 +77,8 @@
 
 #include <sys/types.h>  /* send() */
 #include <sys/socket.h> /* send() */
+#include <sys/stat.h>
+#include <sys/mman.h>   /* mmap() */
 
 #include "dlt_types.h"
 #include "dlt_daemon_common.h"
@@ -129,6 +131,219 @@ static int dlt_daemon_cmp_apid_ctid(const void *m1, const void *m2)
     return ret;
 }
 
+/* Pack apid and ctid, zero padded like dlt_set_id, into one integer key */
+static uint64_t dlt_daemon_context_key(const char *apid, const char *ctid)
+{
+    char id[2 * DLT_ID_SIZE];
+    uint64_t key = 0;
+
+    dlt_set_id(id, apid);
+    dlt_set_id(id + DLT_ID_SIZE, ctid);
+    memcpy(&key, id, sizeof(key));
+
+    return key;
+}
+
+static uint32_t dlt_daemon_context_index_home(uint64_t key, uint32_t size)
+{
+    /* Fibonacci hashing, size is a power of two */
+    return (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & (size - 1);
+}
+
+/* Get slot of context with key, or the free slot where it is to be inserted */
+static uint32_t dlt_daemon_context_index_probe(DltDaemonRegisteredUsers *user_list,
+                                               uint64_t key)
+{
+    uint32_t mask = user_list->context_index_size - 1;
+    uint32_t slot = dlt_daemon_context_index_home(key, user_list->context_index_size);
+    uint32_t pos;
+
+    while ((pos = user_list->context_index[slot]) != 0)
+    {
+        if (dlt_daemon_context_key(user_list->contexts[pos - 1].apid,
+                                   user_list->contexts[pos - 1].ctid) == key)
+        {
+            break;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+/* Rebuild the index with size slots from the contexts array */
+static int dlt_daemon_context_index_build(DltDaemonRegisteredUsers *user_list,
+                                          uint32_t size)
+{
+    uint32_t *old = user_list->context_index;
+    int i;
+
+    user_list->context_index = calloc(size, sizeof(uint32_t));
+
+    if (user_list->context_index == NULL)
+    {
+        user_list->context_index = old;
+        return -1;
+    }
+
+    user_list->context_index_size = size;
+
+    for (i = 0; i < user_list->num_contexts; i++)
+    {
+        user_list->context_index[dlt_daemon_context_index_probe(user_list,
+            dlt_daemon_context_key(user_list->contexts[i].apid,
+                                   user_list->contexts[i].ctid))] = i + 1;
+    }
+
+    free(old);
+
+    return 0;
+}
+
+/* Adapt positions stored in the index when contexts from pos on are moved by delta */
+static void dlt_daemon_context_index_shift(DltDaemonRegisteredUsers *user_list,
+                                           int pos,
+                                           int delta)
+{
+    uint32_t i;
+
+    for (i = 0; i < user_list->context_index_size; i++)
+    {
+        if (user_list->context_index[i] > (uint32_t)pos)
+        {
+            user_list->context_index[i] += delta;
+        }
+    }
+}
+
+/* Remove slot from the index, closing the gap by moving back following entries */
+static void dlt_daemon_context_index_remove(DltDaemonRegisteredUsers *user_list,
+                                            uint32_t slot)
+{
+    uint32_t mask = user_list->context_index_size - 1;
+    uint32_t next = slot;
+    uint32_t home;
+    uint32_t pos;
+
+    while (1)
+    {
+        next = (next + 1) & mask;
+        pos = user_list->context_index[next];
+
+        if (pos == 0)
+        {
+            break;
+        }
+
+        home = dlt_daemon_context_index_home(
+            dlt_daemon_context_key(user_list->contexts[pos - 1].apid,
+                                   user_list->contexts[pos - 1].ctid),
+            user_list->context_index_size);
+
+        /* entry may move to slot if slot lies cyclically in [home, next) */
+        if (((next - home) & mask) >= ((next - slot) & mask))
+        {
+            user_list->context_index[slot] = pos;
+            slot = next;
+        }
+    }
+
+    user_list->context_index[slot] = 0;
+}
+
+#ifndef DLT_USE_UNIX_SOCKET_IPC
+/**
+ * Create the log level table of an application next to its FIFO.
+ * The daemon owns the file and is the only writer, the application maps it
+ * read-only. Without table, log levels are sent to the application as messages.
+ */
+static void dlt_daemon_application_create_log_level_table(DltDaemon *daemon,
+                                                          DltDaemonApplication *application,
+                                                          int verbose)
+{
+    char filename[DLT_DAEMON_COMMON_TEXTBUFSIZE];
+    DltUserLogLevelTable *table;
+    void *ptr;
+    int fd;
+    int i;
+
+    snprintf(filename,
+             DLT_DAEMON_COMMON_TEXTBUFSIZE,
+             "%s/dltpipes/dlt%d%s",
+             dltFifoBaseDir,
+             application->pid,
+             DLT_USER_LOG_LEVEL_TABLE_SUFFIX);
+
+    /* never reuse a file found there, it may have been placed by anyone */
+    unlink(filename);
+
+    fd = open(filename, O_RDWR | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC,
+              S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (fd < 0)
+    {
+        dlt_vlog(LOG_WARNING, "open() failed to %s, errno=%d (%s)!\n", filename, errno, strerror(errno));
+        return;
+    }
+
+    /* the umask may have removed the read rights of the applications */
+    if ((fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) == -1) ||
+        (ftruncate(fd, sizeof(DltUserLogLevelTable)) == -1))
+    {
+        dlt_vlog(LOG_WARNING, "Log level table %s cannot be set up, errno=%d (%s)!\n", filename, errno, strerror(errno));
+        close(fd);
+        unlink(filename);
+        return;
+    }
+
+    ptr = mmap(NULL, sizeof(DltUserLogLevelTable), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (ptr == MAP_FAILED)
+    {
+        dlt_vlog(LOG_WARNING, "mmap() failed to %s, errno=%d (%s)!\n", filename, errno, strerror(errno));
+        unlink(filename);
+        return;
+    }
+
+    /* contexts read the default levels until the daemon stored theirs */
+    table = (DltUserLogLevelTable *)ptr;
+
+    for (i = 0; i < DLT_USER_LOG_LEVEL_TABLE_ENTRIES; i++)
+    {
+        table->entries[i].log_level = daemon->default_log_level;
+        table->entries[i].trace_status = daemon->default_trace_status;
+    }
+
+    application->log_level_table = table;
+    application->log_level_table_sent = 0;
+
+    if (verbose)
+    {
+        dlt_vlog(LOG_INFO, "Log level table of %.4s created\n", application->apid);
+    }
+}
+#endif
+
+static void dlt_daemon_application_remove_log_level_table(DltDaemonApplication *application)
+{
+    char filename[DLT_DAEMON_COMMON_TEXTBUFSIZE];
+
+    if (application->log_level_table != NULL)
+    {
+        munmap(application->log_level_table, sizeof(DltUserLogLevelTable));
+        application->log_level_table = NULL;
+
+        snprintf(filename,
+                 DLT_DAEMON_COMMON_TEXTBUFSIZE,
+                 "%s/dltpipes/dlt%d%s",
+                 dltFifoBaseDir,
+                 application->pid,
+                 DLT_USER_LOG_LEVEL_TABLE_SUFFIX);
+        unlink(filename);
+    }
+}
+
 DltDaemonRegisteredUsers *dlt_daemon_find_users_list(DltDaemon *daemon,
                                                      char *ecu,
                                                      int verbose)
@@ -396,6 +611,8 @@ int dlt_daemon_applications_clear(DltDaemon *daemon, char *ecu, int verbose)
             free(user_list->applications[i].application_description);
             user_list->applications[i].application_description = NULL;
         }
+
+        dlt_daemon_application_remove_log_level_table(&(user_list->applications[i]));
     }
 
     if (user_list->applications != NULL)
@@ -487,6 +704,8 @@ DltDaemonApplication* dlt_daemon_application_add(DltDaemon *daemon,
         application->application_description = NULL;
         application->num_contexts = 0;
         application->user_handle = DLT_FD_INIT;
+        application->log_level_table = NULL;
+        application->log_level_table_sent = 0;
 
         new_application = 1;
 
@@ -539,6 +758,7 @@ DltDaemonApplication* dlt_daemon_application_add(DltDaemon *daemon,
     		             strerror(errno)); /* errno 2: ENOENT - No such file or directory */
     		}
 #endif
+    		dlt_daemon_application_remove_log_level_table(application);
     		application->user_handle = DLT_FD_INIT;
     		application->pid = 0;
         }
@@ -570,6 +790,19 @@ DltDaemonApplication* dlt_daemon_application_add(DltDaemon *daemon,
 
         application->user_handle = dlt_user_handle;
         application->pid = pid;
+
+#ifndef DLT_USE_UNIX_SOCKET_IPC
+        if (dlt_user_handle >= DLT_FD_MINIMUM)
+        {
+            /* the table of a reopened FIFO is kept, the process may still map it */
+            if (application->log_level_table == NULL)
+            {
+                dlt_daemon_application_create_log_level_table(daemon, application, verbose);
+            }
+
+            application->log_level_table_sent = 0;
+        }
+#endif
     }
 
     /* Sort */
@@ -626,6 +859,8 @@ int dlt_daemon_application_del(DltDaemon *daemon,
             application->application_description = NULL;
         }
 
+        dlt_daemon_application_remove_log_level_table(application);
+
         pos = application - (user_list->applications);
 
         /* move all applications above pos to pos */
@@ -852,7 +1087,10 @@ DltDaemonContext* dlt_daemon_context_add(DltDaemon *daemon,
     DltDaemonApplication *application;
     DltDaemonContext *context;
     DltDaemonContext *old;
+    DltDaemonContext tmp;
     int new_context=0;
+    int pos, low, high;
+    uint32_t size;
     DltDaemonRegisteredUsers* user_list = NULL;
 
     PRINT_FUNCTION_VERBOSE(verbose);
@@ -899,6 +1137,25 @@ DltDaemonContext* dlt_daemon_context_add(DltDaemon *daemon,
     context = dlt_daemon_context_find(daemon, apid, ctid, ecu, verbose);
     if (context == NULL)
     {
+        /* Keep the index filled to at most three quarters */
+        size = user_list->context_index_size;
+
+        if (size == 0)
+        {
+            size = DLT_DAEMON_CONTEXT_INDEX_SIZE;
+        }
+
+        while ((uint32_t)(user_list->num_contexts + 1) * 4 > size * 3)
+        {
+            size *= 2;
+        }
+
+        if ((size != user_list->context_index_size) &&
+            (dlt_daemon_context_index_build(user_list, size) != 0))
+        {
+            return (DltDaemonContext*) NULL;
+        }
+
         user_list->num_contexts += 1;
 
         if (user_list->num_contexts != 0)
@@ -923,12 +1180,44 @@ DltDaemonContext* dlt_daemon_context_add(DltDaemon *daemon,
             }
         }
 
-        context = &(user_list->contexts[user_list->num_contexts - 1]);
+        /* Find position of new context in the sorted contexts */
+        dlt_set_id(tmp.apid, apid);
+        dlt_set_id(tmp.ctid, ctid);
+        low = 0;
+        high = user_list->num_contexts - 1;
+
+        while (low < high)
+        {
+            pos = low + (high - low) / 2;
+
+            if (dlt_daemon_cmp_apid_ctid(&tmp, &(user_list->contexts[pos])) > 0)
+            {
+                low = pos + 1;
+            }
+            else
+            {
+                high = pos;
+            }
+        }
+
+        pos = low;
+
+        /* move all contexts from pos on one up */
+        dlt_daemon_context_index_shift(user_list, pos, 1);
+        memmove(&(user_list->contexts[pos + 1]),
+                &(user_list->contexts[pos]),
+                sizeof(DltDaemonContext) * ((user_list->num_contexts - 1) - pos));
+
+        context = &(user_list->contexts[pos]);
+        memset(context, 0, sizeof(DltDaemonContext));
 
         dlt_set_id(context->apid,apid);
         dlt_set_id(context->ctid,ctid);
         context->context_description = NULL;
 
+        user_list->context_index[dlt_daemon_context_index_probe(user_list,
+            dlt_daemon_context_key(apid, ctid))] = pos + 1;
+
         application->num_contexts++;
         new_context =1;
     }
@@ -984,18 +1273,6 @@ DltDaemonContext* dlt_daemon_context_add(DltDaemon *daemon,
     context->log_level_pos = log_level_pos;
     context->user_handle = user_handle;
 
-    /* Sort */
-    if (new_context)
-    {
-        qsort(user_list->contexts,
-              user_list->num_contexts,
-              sizeof(DltDaemonContext),
-              dlt_daemon_cmp_apid_ctid);
-
-        /* Find new position of context with apid, ctid */
-        context = dlt_daemon_context_find(daemon, apid, ctid, ecu, verbose);
-    }
-
     return context;
 }
 
@@ -1034,6 +1311,11 @@ int dlt_daemon_context_del(DltDaemon *daemon,
 
         pos = context-(user_list->contexts);
 
+        dlt_daemon_context_index_remove(user_list,
+            dlt_daemon_context_index_probe(user_list,
+                dlt_daemon_context_key(context->apid, context->ctid)));
+        dlt_daemon_context_index_shift(user_list, pos + 1, -1);
+
         /* move all contexts above pos to pos */
         memmove(&(user_list->contexts[pos]),
                 &(user_list->contexts[pos + 1]),
@@ -1062,8 +1344,8 @@ DltDaemonContext* dlt_daemon_context_find(DltDaemon *daemon,
                                           char *ecu,
                                           int verbose)
 {
-    DltDaemonContext context;
     DltDaemonRegisteredUsers* user_list = NULL;
+    uint32_t pos;
 
     PRINT_FUNCTION_VERBOSE(verbose);
 
@@ -1074,28 +1356,21 @@ DltDaemonContext* dlt_daemon_context_find(DltDaemon *daemon,
     }
 
     user_list = dlt_daemon_find_users_list(daemon, ecu, verbose);
-    if ((user_list == NULL) || (user_list->num_contexts == 0))
+    if ((user_list == NULL) || (user_list->num_contexts == 0) ||
+        (user_list->context_index == NULL))
     {
         return (DltDaemonContext*) NULL;
     }
 
-    /* Check, if apid is smaller than smallest apid or greater than greatest apid */
-    if ((memcmp(apid, user_list->contexts[0].apid, DLT_ID_SIZE) < 0) ||
-        (memcmp(apid,
-                user_list->contexts[user_list->num_contexts-1].apid,
-                DLT_ID_SIZE) > 0))
+    pos = user_list->context_index[dlt_daemon_context_index_probe(user_list,
+        dlt_daemon_context_key(apid, ctid))];
+
+    if (pos == 0)
     {
         return (DltDaemonContext*) NULL;
     }
 
-    dlt_set_id(context.apid,apid);
-    dlt_set_id(context.ctid,ctid);
-
-    return (DltDaemonContext*)bsearch(&context,
-                                      user_list->contexts,
-                                      user_list->num_contexts,
-                                      sizeof(DltDaemonContext),
-                                      dlt_daemon_cmp_apid_ctid);
+    return &(user_list->contexts[pos - 1]);
 }
 
 int dlt_daemon_contexts_invalidate_fd(DltDaemon *daemon,
@@ -1163,6 +1438,10 @@ int dlt_daemon_contexts_clear(DltDaemon *daemon, char *ecu, int verbose)
         users->contexts = NULL;
     }
 
+    free(users->context_index);
+    users->context_index = NULL;
+    users->context_index_size = 0;
+
     for (i = 0; i < users->num_applications; i++)
     {
         users->applications[i].num_contexts = 0;
@@ -1457,6 +1736,8 @@ int dlt_daemon_user_send_log_level(DltDaemon *daemon, DltDaemonContext *context,
 {
     DltUserHeader userheader;
     DltUserControlMsgLogLevel usercontext;
+    DltDaemonApplication *application;
+    DltUserLogLevelEntry *entry;
     DltReturnValue ret;
 
     PRINT_FUNCTION_VERBOSE(verbose);
@@ -1486,6 +1767,35 @@ int dlt_daemon_user_send_log_level(DltDaemon *daemon, DltDaemonContext *context,
 
     usercontext.log_level_pos = context->log_level_pos;
 
+    /* Change the level in place, if the context is in the log level table of its application */
+    application = dlt_daemon_application_find(daemon, context->apid, daemon->ecuid, verbose);
+
+    if ((application != NULL) &&
+        (application->log_level_table != NULL) &&
+        (context->log_level_pos >= 0) &&
+        (context->log_level_pos < DLT_USER_LOG_LEVEL_TABLE_ENTRIES))
+    {
+        entry = &(application->log_level_table->entries[context->log_level_pos]);
+
+        __atomic_store_n(&entry->log_level, (int8_t)usercontext.log_level, __ATOMIC_RELAXED);
+        __atomic_store_n(&entry->trace_status, (int8_t)usercontext.trace_status, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&application->log_level_table->generation, 1, __ATOMIC_RELEASE);
+
+        /* the application maps the table with the first message it receives */
+        if (application->log_level_table_sent)
+        {
+            dlt_vlog(LOG_DEBUG, "Set log-level of context: %.4s:%.4s [%i -> %i] [%i -> %i]\n",
+                     context->apid,
+                     context->ctid,
+                     context->log_level,
+                     usercontext.log_level,
+                     context->trace_status,
+                     usercontext.trace_status);
+
+            return DLT_RETURN_OK;
+        }
+    }
+
     dlt_vlog(LOG_NOTICE, "Send log-level to context: %.4s:%.4s [%i -> %i] [%i -> %i]\n",
              context->apid,
              context->ctid,
@@ -1515,6 +1825,10 @@ int dlt_daemon_user_send_log_level(DltDaemon *daemon, DltDaemonContext *context,
             context->user_handle = DLT_FD_INIT;
         }
     }
+    else if ((application != NULL) && (application->log_level_table != NULL))
+    {
+        application->log_level_table_sent = 1;
+    }
 
     return ((ret == DLT_RETURN_OK) ? DLT_RETURN_OK : DLT_RETURN_ERROR);
 }
@@ -81,6 +81,7 @@
 #include <semaphore.h>
 #include "dlt_common.h"
 #include "dlt_user.h"
+#include "dlt_user_shared.h"
 #include "dlt_offline_logstorage.h"
 #include "dlt_gateway_types.h"
 
@@ -123,6 +124,8 @@ typedef struct
     int user_handle;    /**< connection handle for connection to user application */
     char *application_description; /**< context description */
     int num_contexts; /**< number of contexts for this application */
+    DltUserLogLevelTable *log_level_table; /**< log level table published to the application, NULL if not available */
+    int log_level_table_sent; /**< a log level message was sent since the table was created, the application maps the table on receiving it */
 } DltDaemonApplication;
 
 /**
@@ -148,6 +151,8 @@ typedef struct
     DltDaemonApplication *applications; /**< Pointer to applications */
     int num_applications; /**< Number of available application */
     DltDaemonContext *contexts; /**< Pointer to contexts */
+    uint32_t *context_index; /**< Hash index on apid/ctid, slots hold position in contexts + 1, 0 if free */
+    uint32_t context_index_size; /**< Number of slots in context_index, power of two */
     int num_contexts; /**< Total number of all contexts in all applications in this list */
     char ecu[DLT_ID_SIZE];  /**< ECU ID of where contexts are registered */
 } DltDaemonRegisteredUsers;
@@ -107,6 +107,9 @@
 /* Number of entries to be allocated at one in context table,
    when no more entries are available */
 #define DLT_DAEMON_CONTEXT_ALLOC_SIZE  1000
+/* Initial number of slots of the context hash index, power of two.
+   The index is doubled when it is filled to more than three quarters */
+#define DLT_DAEMON_CONTEXT_INDEX_SIZE  2048
 
 /* Debug get log info function,
    set to 1 to enable, 0 to disable debugging */
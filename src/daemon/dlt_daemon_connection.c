@@ -32,6 +32,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <poll.h>
 
 #include <sys/socket.h>
 #include <sys/syslog.h>
@@ -136,6 +137,129 @@ int dlt_connection_send_multiple(DltConnection *con,
     return ret;
 }
 
+/** @brief Queue a message for a connection.
+ *
+ * Client connections with an outgoing queue get the message appended, it is
+ * sent once enough data is queued or the socket becomes writable. If the
+ * client exceeds its high watermark, it is degraded and messages are dropped
+ * and counted until it caught up. Other connections send the message
+ * directly.
+ *
+ * @param con The connection to send the messages through.
+ * @param data1 The first message to be sent.
+ * @param size1 The size of the first message.
+ * @param data2 The second message to be send.
+ * @param size2 The second message size.
+ * @param sendserialheader Whether we need or not to send the serial header.
+ * @param wait Wait up to DLT_DAEMON_SNDQUEUE_WAIT_MSEC for queue space
+ *             instead of dropping the message. Degraded clients are not
+ *             waited for.
+ *
+ * @return DLT_DAEMON_ERROR_OK on success, -1 otherwise.
+ */
+int dlt_connection_queue_multiple(DltConnection *con,
+                                  void *data1,
+                                  int size1,
+                                  void *data2,
+                                  int size2,
+                                  int sendserialheader,
+                                  int wait)
+{
+    struct pollfd pfd;
+    int32_t needed;
+
+    if (con == NULL)
+    {
+        return DLT_DAEMON_ERROR_UNKNOWN;
+    }
+
+    if ((con->queue == NULL) || (con->receiver == NULL))
+    {
+        return dlt_connection_send_multiple(con,
+                                            data1,
+                                            size1,
+                                            data2,
+                                            size2,
+                                            sendserialheader);
+    }
+
+    needed = (sendserialheader ? (int32_t)sizeof(dltSerialHeader) : 0) +
+             ((data1 != NULL) ? size1 : 0) + ((data2 != NULL) ? size2 : 0);
+
+    while (wait && !con->queue->degraded && (con->queue->used > 0) &&
+           ((con->queue->high_watermark - con->queue->used) < needed))
+    {
+        if (dlt_daemon_socket_queue_flush(con->receiver->fd, con->queue) != DLT_DAEMON_ERROR_OK)
+        {
+            return DLT_DAEMON_ERROR_SEND_FAILED;
+        }
+
+        if ((con->queue->high_watermark - con->queue->used) >= needed)
+        {
+            break;
+        }
+
+        pfd.fd = con->receiver->fd;
+        pfd.events = POLLOUT;
+        pfd.revents = 0;
+
+        if (poll(&pfd, 1, DLT_DAEMON_SNDQUEUE_WAIT_MSEC) <= 0)
+        {
+            /* client does not take anything, degrade it below */
+            break;
+        }
+    }
+
+    if (dlt_daemon_socket_queue_add(con->queue,
+                                    data1,
+                                    size1,
+                                    data2,
+                                    size2,
+                                    sendserialheader) == DLT_DAEMON_ERROR_BUFFER_FULL)
+    {
+        if (con->queue->dropped == 1)
+        {
+            dlt_vlog(LOG_WARNING,
+                     "Client on socket %d does not keep up, dropping messages\n",
+                     con->receiver->fd);
+        }
+
+        /* healthy clients are served, a slow one only loses its messages */
+
+        return DLT_DAEMON_ERROR_OK;
+    }
+
+    /* do not let a burst within one loop iteration degrade a healthy client */
+    if ((con->queue->used >= DLT_DAEMON_SNDQUEUE_FLUSH) ||
+        (con->queue->used >= con->queue->low_watermark))
+    {
+        return dlt_daemon_socket_queue_flush(con->receiver->fd, con->queue);
+    }
+
+    return DLT_DAEMON_ERROR_OK;
+}
+
+/** @brief Send queued data of a connection.
+ *
+ * @param con The connection to be flushed.
+ *
+ * @return DLT_DAEMON_ERROR_OK on success, -1 otherwise.
+ */
+int dlt_connection_flush(DltConnection *con)
+{
+    if ((con == NULL) || (con->receiver == NULL))
+    {
+        return DLT_DAEMON_ERROR_UNKNOWN;
+    }
+
+    if (con->queue == NULL)
+    {
+        return DLT_DAEMON_ERROR_OK;
+    }
+
+    return dlt_daemon_socket_queue_flush(con->receiver->fd, con->queue);
+}
+
 /** @brief Get the next connection filtered with a type mask.
  *
  * In some cases we need the next connection available of a specific type or
@@ -216,12 +340,17 @@ STATIC DltReceiver *dlt_connection_get_receiver(DltDaemonLocal *daemon_local,
             dlt_receiver_init(ret, fd, DLT_DAEMON_RCVBUFSIZESERIAL);
         }
         break;
+    case DLT_CONNECTION_APP_MSG:
+        /* messages are parsed in place, the buffer grows with the load */
+        ret = calloc(1, sizeof(DltReceiver));
+        if (ret) {
+            dlt_receiver_init(ret, fd, DLT_DAEMON_RCVBUFSIZE_APP);
+        }
+        break;
 #ifdef DLT_USE_UNIX_SOCKET_IPC
     case DLT_CONNECTION_APP_CONNECT:
     /* FALL THROUGH */
 #endif
-    case DLT_CONNECTION_APP_MSG:
-    /* FALL THROUGH */
     case DLT_CONNECTION_ONE_S_TIMER:
     /* FALL THROUGH */
     case DLT_CONNECTION_SIXTY_S_TIMER:
@@ -231,6 +360,12 @@ STATIC DltReceiver *dlt_connection_get_receiver(DltDaemonLocal *daemon_local,
 #endif
     /* FALL THROUGH */
     case DLT_CONNECTION_GATEWAY_TIMER:
+#ifdef DLT_SHM_ENABLE
+    /* FALL THROUGH */
+    case DLT_CONNECTION_APP_RING:
+#endif
+    /* FALL THROUGH */
+    case DLT_CONNECTION_APP_INGEST:
         ret = calloc(1, sizeof(DltReceiver));
         if (ret) {
             dlt_receiver_init(ret, fd, DLT_DAEMON_RCVBUFSIZE);
@@ -310,6 +445,14 @@ void *dlt_connection_get_callback(DltConnection *con)
     case DLT_CONNECTION_GATEWAY_TIMER:
         ret = dlt_gateway_process_gateway_timer;
         break;
+#ifdef DLT_SHM_ENABLE
+    case DLT_CONNECTION_APP_RING:
+        ret = dlt_daemon_process_user_ring;
+        break;
+#endif
+    case DLT_CONNECTION_APP_INGEST:
+        ret = dlt_daemon_process_user_ingest;
+        break;
     default:
         ret = NULL;
     }
@@ -331,6 +474,21 @@ void dlt_connection_destroy(DltConnection *to_destroy)
     to_destroy->id = 0;
     close(to_destroy->receiver->fd);
     dlt_connection_destroy_receiver(to_destroy);
+
+    if (to_destroy->queue != NULL)
+    {
+        dlt_daemon_socket_queue_free(to_destroy->queue);
+        free(to_destroy->queue);
+        to_destroy->queue = NULL;
+    }
+
+    if (to_destroy->filter != NULL)
+    {
+        dlt_filter_free(to_destroy->filter, 0);
+        free(to_destroy->filter);
+        to_destroy->filter = NULL;
+    }
+
     /* connection pointer might be in epoll queue and used even after destroying
      * it. To make sure it is not used anymore, connection type is invalidated */
     to_destroy->type = DLT_CONNECTION_TYPE_MAX;
@@ -409,6 +567,35 @@ int dlt_connection_create(DltDaemonLocal *daemon_local,
     temp->type = type;
     temp->status = ACTIVE;
 
+    if (type == DLT_CONNECTION_CLIENT_MSG_TCP)
+    {
+        int32_t high = (int32_t)((int64_t)daemon_local->flags.clientSendQueueSize *
+                                 daemon_local->flags.clientSendQueueHighWatermark / 100);
+        int32_t low = (int32_t)((int64_t)daemon_local->flags.clientSendQueueSize *
+                                daemon_local->flags.clientSendQueueLowWatermark / 100);
+
+        if (low > high)
+        {
+            low = high;
+        }
+
+        /* messages to clients are queued and sent when the socket is writable */
+        temp->queue = malloc(sizeof(DltDaemonSocketQueue));
+
+        if ((temp->queue == NULL) ||
+            (dlt_daemon_socket_queue_init(temp->queue,
+                                          daemon_local->flags.clientSendQueueSize,
+                                          high,
+                                          low) != DLT_DAEMON_ERROR_OK))
+        {
+            dlt_log(LOG_CRIT, "Allocation of client send queue failed\n");
+            free(temp->queue);
+            dlt_connection_destroy_receiver(temp);
+            free(temp);
+            return -1;
+        }
+    }
+
     /* Now give the ownership of the newly created connection
      * to the event handler, by registering for events.
      */
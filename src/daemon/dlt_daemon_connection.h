@@ -35,6 +35,8 @@
 #include "dlt-daemon.h"
 
 int dlt_connection_send_multiple(DltConnection *, void *, int, void *, int, int);
+int dlt_connection_queue_multiple(DltConnection *, void *, int, void *, int, int, int);
+int dlt_connection_flush(DltConnection *);
 
 DltConnection *dlt_connection_get_next(DltConnection *, int);
 int dlt_connection_create_remaining(DltDaemonLocal *);
@@ -52,6 +52,8 @@ typedef enum {
     DLT_CONNECTION_CONTROL_MSG,
     DLT_CONNECTION_GATEWAY,
     DLT_CONNECTION_GATEWAY_TIMER,
+    DLT_CONNECTION_APP_RING,
+    DLT_CONNECTION_APP_INGEST,
     DLT_CONNECTION_TYPE_MAX
 } DltConnectionType;
 
@@ -67,6 +69,8 @@ typedef enum {
 #define DLT_CON_MASK_CONTROL_MSG        (1 << DLT_CONNECTION_CONTROL_MSG)
 #define DLT_CON_MASK_GATEWAY            (1 << DLT_CONNECTION_GATEWAY)
 #define DLT_CON_MASK_GATEWAY_TIMER      (1 << DLT_CONNECTION_GATEWAY_TIMER)
+#define DLT_CON_MASK_APP_RING           (1 << DLT_CONNECTION_APP_RING)
+#define DLT_CON_MASK_APP_INGEST         (1 << DLT_CONNECTION_APP_INGEST)
 #define DLT_CON_MASK_ALL                (0xffff)
 
 typedef uintptr_t DltConnectionId;
@@ -81,6 +85,8 @@ typedef struct DltConnection {
     DltConnectionStatus status; /**< Status of connection */
     struct DltConnection *next;   /**< For multiple client connection using linked list */
     int ev_mask; /**< Mask to set when registering the connection for events */
+    struct DltDaemonSocketQueue *queue; /**< Outgoing data of client connections, sent when writable */
+    DltFilter *filter; /**< Messages requested by the client, NULL for all messages */
 } DltConnection;
 
 #endif /* DLT_DAEMON_CONNECTION_TYPES_H */
@@ -43,6 +43,8 @@
 #include "dlt_daemon_connection_types.h"
 #include "dlt_daemon_event_handler.h"
 #include "dlt_daemon_event_handler_types.h"
+#include "dlt_daemon_socket.h"
+#include "dlt_daemon_client.h"
 
 /**
  * \def DLT_EPOLL_TIMEOUT_MSEC
@@ -98,14 +100,23 @@ int dlt_daemon_handle_event(DltEventHandler *pEvent,
     }
     int nfds = 0;
     int i = 0;
+    int timeout = DLT_EPOLL_TIMEOUT_MSEC;
     char str[DLT_DAEMON_TEXTBUFSIZE];
     int (*callback)(DltDaemon *, DltDaemonLocal *, DltReceiver *, int) = NULL;
 
+    /* synced logstorage caches are written step by step, events are only
+     * polled for while data is left. The storage thread does this itself. */
+    if (!daemon_local->storage.running &&
+        dlt_logstorage_flush_caches(DLT_OFFLINE_LOGSTORAGE_FLUSH_CHUNK))
+    {
+        timeout = 0;
+    }
+
     /*CM Change begin*/
     nfds = epoll_wait(pEvent->epfd,
                       pEvent->events,
                       DLT_EPOLL_MAX_EVENTS,
-                      DLT_EPOLL_TIMEOUT_MSEC);
+                      timeout);
 
     if (nfds < 0)
     {
@@ -147,7 +158,7 @@ int dlt_daemon_handle_event(DltEventHandler *pEvent,
         /* First of all handle epoll error events
          * We only expect EPOLLIN or EPOLLOUT
          */
-        if ((ev->events != EPOLLIN) && (ev->events != EPOLLOUT))
+        if (ev->events & ~(EPOLLIN | EPOLLOUT))
         {
             /* epoll reports an error, we need to clean-up the concerned event
              */
@@ -169,6 +180,24 @@ int dlt_daemon_handle_event(DltEventHandler *pEvent,
             continue;
         }
 
+        /* Socket became writable, send what is queued for the client */
+        if (ev->events & EPOLLOUT)
+        {
+            if (dlt_connection_flush(con) != DLT_DAEMON_ERROR_OK)
+            {
+                dlt_daemon_close_socket(fd, daemon, daemon_local, 0);
+                continue;
+            }
+
+            dlt_daemon_client_report_dropped(daemon, daemon_local, con, 0);
+            dlt_connection_check_output(pEvent, con);
+
+            if (!(ev->events & EPOLLIN))
+            {
+                continue;
+            }
+        }
+
         /* Get the function to be used to handle the event */
         callback = dlt_connection_get_callback(con);
 
@@ -430,6 +459,64 @@ int dlt_connection_check_activate(DltEventHandler *evhdl,
     return 0;
 }
 
+/** @brief Check for pending output of a connection
+ *
+ * A connection with queued outgoing data is registered for EPOLLOUT, so the
+ * data is sent as soon as the socket is writable. Once everything is sent,
+ * EPOLLOUT is removed again to avoid useless wake ups.
+ *
+ * @param evhdl The event handler structure.
+ * @param con The connection to act on
+ *
+ * @return 0 on success, -1 otherwise
+ */
+int dlt_connection_check_output(DltEventHandler *evhdl,
+                                DltConnection *con)
+{
+    struct epoll_event ev; /* Content will be copied by the kernel */
+    int mask;
+
+    if (!evhdl || !con || !con->receiver)
+    {
+        dlt_vlog(LOG_ERR, "%s: wrong parameters.\n", __func__);
+        return -1;
+    }
+
+    mask = con->ev_mask & ~EPOLLOUT;
+
+    if ((con->queue != NULL) && (con->queue->used > 0))
+    {
+        mask |= EPOLLOUT;
+    }
+
+    if (mask == con->ev_mask)
+    {
+        return 0;
+    }
+
+    con->ev_mask = mask;
+
+    if (con->status != ACTIVE)
+    {
+        /* applied on activation */
+        return 0;
+    }
+
+    ev.events = con->ev_mask;
+    ev.data.ptr = (void *)con->id;
+
+    if (epoll_ctl(evhdl->epfd,
+                  EPOLL_CTL_MOD,
+                  con->receiver->fd,
+                  &ev) == -1)
+    {
+        dlt_log(LOG_ERR, "epoll_ctl() in check output failed!\n");
+        return -1;
+    }
+
+    return 0;
+}
+
 /** @brief Registers a connection for event handling and takes its ownership.
  *
  * As we add the connection to the list of connection, we take its ownership.
@@ -58,6 +58,8 @@ int dlt_event_handler_unregister_connection(DltEventHandler *,
 int dlt_connection_check_activate(DltEventHandler *,
                                   DltConnection *,
                                   int);
+int dlt_connection_check_output(DltEventHandler *,
+                                DltConnection *);
 #ifdef DLT_UNIT_TESTS
 int dlt_daemon_remove_connection(DltEventHandler *ev,
                                        DltConnection *to_remove);
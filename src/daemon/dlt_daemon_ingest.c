@@ -0,0 +1,710 @@
+/*
+ * @licence app begin@
+ * SPDX license identifier: MPL-2.0
+ *
+ * This file is part of GENIVI Project DLT - Diagnostic Log and Trace.
+ *
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License (MPL), v. 2.0.
+ * If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * For further information see http://www.genivi.org/.
+ * @licence end@
+ */
+
+/*!
+ * \file dlt_daemon_ingest.c
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syslog.h>
+
+#include "dlt_daemon_ingest.h"
+#include "dlt_daemon_event_handler_types.h"
+#include "dlt-daemon_cfg.h"
+#include "dlt_user_shared.h"
+#include "dlt_user_shared_cfg.h"
+#include "dlt_common.h"
+
+/* record size marking the unused end of the queue, reader continues at 0 */
+#define DLT_DAEMON_INGEST_PAD 0xffffffffu
+
+/* records are aligned, so message headers can be accessed in place */
+#define DLT_DAEMON_INGEST_ALIGN(x) (((x) + 7u) & ~7u)
+
+typedef struct
+{
+    uint32_t size;          /**< size of the message or DLT_DAEMON_INGEST_PAD */
+    int32_t fd;             /**< application connection */
+    uint32_t type;          /**< DLT_DAEMON_INGEST_MSG or DLT_DAEMON_INGEST_CLOSE */
+    uint32_t reserved;
+} DltDaemonIngestRecord;
+
+static int dlt_daemon_ingest_queue_push(DltDaemonIngestQueue *queue,
+                                        int fd,
+                                        int type,
+                                        const char *data,
+                                        uint32_t size)
+{
+    DltDaemonIngestRecord *record;
+    uint32_t rec = DLT_DAEMON_INGEST_ALIGN(sizeof(DltDaemonIngestRecord) + size);
+    uint32_t head = queue->head;
+    uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_SEQ_CST);
+    uint32_t pos = head & (queue->size - 1);
+    uint32_t pad = 0;
+
+    if ((pos + rec) > queue->size)
+    {
+        pad = queue->size - pos;
+    }
+
+    if ((rec + pad) > (queue->size - (head - tail)))
+    {
+        return 0;
+    }
+
+    if (pad > 0)
+    {
+        ((DltDaemonIngestRecord *)(queue->data + pos))->size = DLT_DAEMON_INGEST_PAD;
+        pos = 0;
+    }
+
+    record = (DltDaemonIngestRecord *)(queue->data + pos);
+    record->size = size;
+    record->fd = fd;
+    record->type = (uint32_t)type;
+
+    if (size > 0)
+    {
+        memcpy(queue->data + pos + sizeof(DltDaemonIngestRecord), data, size);
+    }
+
+    __atomic_store_n(&queue->head, head + pad + rec, __ATOMIC_RELEASE);
+
+    return 1;
+}
+
+void dlt_daemon_ingest_notify(DltDaemonIngestWorker *worker)
+{
+    if (worker != NULL)
+    {
+        eventfd_write(worker->notify_fd, 1);
+    }
+}
+
+void dlt_daemon_ingest_ack(DltDaemonIngestWorker *worker)
+{
+    eventfd_t value;
+
+    if (worker != NULL)
+    {
+        eventfd_read(worker->notify_fd, &value);
+    }
+}
+
+/* Queue a record, waits for the main loop if the queue is full */
+static int dlt_daemon_ingest_push(DltDaemonIngestWorker *worker,
+                                  int fd,
+                                  int type,
+                                  const char *data,
+                                  uint32_t size)
+{
+    struct pollfd pfd;
+    eventfd_t value;
+
+    if ((sizeof(DltDaemonIngestRecord) + size) > worker->queue.size)
+    {
+        dlt_vlog(LOG_WARNING, "Ingest worker %d: message of %u bytes dropped\n", worker->id, size);
+        return 0;
+    }
+
+    while (!dlt_daemon_ingest_queue_push(&worker->queue, fd, type, data, size))
+    {
+        if (__atomic_load_n(&worker->stop, __ATOMIC_ACQUIRE))
+        {
+            return -1;
+        }
+
+        if (!worker->waiting)
+        {
+            /* announce before the last check for space, the main loop wakes
+             * us up after it released a record */
+            dlt_daemon_ingest_notify(worker);
+            __atomic_store_n(&worker->waiting, 1, __ATOMIC_SEQ_CST);
+            continue;
+        }
+
+        pfd.fd = worker->space_fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        if (poll(&pfd, 1, DLT_DAEMON_INGEST_WAIT_MSEC) > 0)
+        {
+            eventfd_read(worker->space_fd, &value);
+        }
+    }
+
+    __atomic_store_n(&worker->waiting, 0, __ATOMIC_RELAXED);
+
+    return 0;
+}
+
+int32_t dlt_daemon_ingest_message_size(DltMessage *msg, const char *buf, int32_t length)
+{
+    const DltUserHeader *userheader = (const DltUserHeader *)buf;
+    int32_t header = (int32_t)sizeof(DltUserHeader);
+    int32_t size = 0;
+    uint32_t desc = 0;
+    int ret;
+
+    if ((msg == NULL) || (buf == NULL) || (length < header))
+    {
+        return 0;
+    }
+
+    switch (userheader->message)
+    {
+    case DLT_USER_MESSAGE_LOG:
+        ret = dlt_message_read_header(msg,
+                                      (uint8_t *)buf + header,
+                                      (unsigned int)(length - header),
+                                      0,
+                                      0);
+        if (ret == DLT_MESSAGE_ERROR_CONTENT)
+        {
+            return -1;
+        }
+        if (ret != DLT_MESSAGE_ERROR_OK)
+        {
+            return 0;
+        }
+
+        size = header + msg->headersize - (int32_t)sizeof(DltStorageHeader) + msg->datasize;
+        if (msg->found_serialheader)
+        {
+            size += (int32_t)sizeof(dltSerialHeader);
+        }
+        break;
+    case DLT_USER_MESSAGE_REGISTER_APPLICATION:
+        size = header + (int32_t)sizeof(DltUserControlMsgRegisterApplication);
+        if (length >= size)
+        {
+            memcpy(&desc,
+                   buf + header + offsetof(DltUserControlMsgRegisterApplication, description_length),
+                   sizeof(desc));
+        }
+        break;
+    case DLT_USER_MESSAGE_REGISTER_CONTEXT:
+        size = header + (int32_t)sizeof(DltUserControlMsgRegisterContext);
+        if (length >= size)
+        {
+            memcpy(&desc,
+                   buf + header + offsetof(DltUserControlMsgRegisterContext, description_length),
+                   sizeof(desc));
+        }
+        break;
+    case DLT_USER_MESSAGE_UNREGISTER_APPLICATION:
+        size = header + (int32_t)sizeof(DltUserControlMsgUnregisterApplication);
+        break;
+    case DLT_USER_MESSAGE_UNREGISTER_CONTEXT:
+        size = header + (int32_t)sizeof(DltUserControlMsgUnregisterContext);
+        break;
+    case DLT_USER_MESSAGE_OVERFLOW:
+        size = header + (int32_t)sizeof(DltUserControlMsgBufferOverflow);
+        break;
+    case DLT_USER_MESSAGE_APP_LL_TS:
+        size = header + (int32_t)sizeof(DltUserControlMsgAppLogLevelTraceStatus);
+        break;
+    case DLT_USER_MESSAGE_MARKER:
+        size = header + (int32_t)sizeof(DltUserControlMsgLogMode);
+        break;
+    default:
+        return -1;
+    }
+
+    /* the daemon keeps only the beginning of longer descriptions */
+    if (desc > DLT_DAEMON_DESCSIZE)
+    {
+        desc = DLT_DAEMON_DESCSIZE;
+    }
+    size += (int32_t)desc;
+
+    return (length >= size) ? size : 0;
+}
+
+/* Receive from one connection and queue all complete messages */
+static int dlt_daemon_ingest_read(DltDaemonIngestWorker *worker, DltReceiver *receiver)
+{
+    int32_t min_size = (int32_t)sizeof(DltUserHeader);
+    int32_t grow = 0;
+    int32_t offset;
+    int32_t size;
+    int recv;
+
+    recv = dlt_receiver_receive(receiver);
+#ifdef DLT_USE_UNIX_SOCKET_IPC
+    if (recv <= 0)
+    {
+        /* the main loop closes the connection after all its messages */
+        epoll_ctl(worker->epfd, EPOLL_CTL_DEL, receiver->fd, NULL);
+        __atomic_sub_fetch(&worker->connections, 1, __ATOMIC_RELAXED);
+        return dlt_daemon_ingest_push(worker, receiver->fd, DLT_DAEMON_INGEST_CLOSE, NULL, 0);
+    }
+#else
+    if (recv < 0)
+    {
+        dlt_log(LOG_WARNING, "dlt_receiver_receive_fd() for user messages failed!\n");
+        return 0;
+    }
+#endif
+
+    /* A full buffer means more data is waiting or a message does not fit,
+     * read more at once next time */
+    if ((receiver->bytesRcvd == receiver->buffersize) &&
+        (receiver->buffersize < DLT_DAEMON_RCVBUFSIZE_APP_MAX))
+    {
+        grow = receiver->buffersize * 2;
+    }
+
+    while (receiver->bytesRcvd >= min_size)
+    {
+        /* resync if necessary */
+        if (!dlt_user_check_userheader((DltUserHeader *)receiver->buf))
+        {
+            offset = dlt_user_find_userheader(receiver->buf, receiver->bytesRcvd);
+
+            if (offset < 0)
+            {
+                /* keep only what could be the start of a user header */
+                dlt_receiver_remove(receiver, receiver->bytesRcvd - (DLT_ID_SIZE - 1));
+                break;
+            }
+
+            dlt_receiver_remove(receiver, offset);
+
+            if (receiver->bytesRcvd < min_size)
+            {
+                break;
+            }
+        }
+
+        size = dlt_daemon_ingest_message_size(&worker->msg, receiver->buf, receiver->bytesRcvd);
+
+        if (size == 0)
+        {
+            /* wait for the rest of the message */
+            break;
+        }
+
+        if (size < 0)
+        {
+            if (((DltUserHeader *)receiver->buf)->message != DLT_USER_MESSAGE_LOG)
+            {
+                dlt_vlog(LOG_ERR,
+                         "Invalid user message type received: %d!\n",
+                         ((DltUserHeader *)receiver->buf)->message);
+            }
+
+            /* skip user header to resync to the next message */
+            dlt_receiver_remove(receiver, min_size);
+            continue;
+        }
+
+        if (dlt_daemon_ingest_push(worker,
+                                   receiver->fd,
+                                   DLT_DAEMON_INGEST_MSG,
+                                   receiver->buf,
+                                   (uint32_t)size) < 0)
+        {
+            return -1;
+        }
+
+        dlt_receiver_remove(receiver, size);
+    }
+
+    /* keep not read data in buffer */
+    if (dlt_receiver_move_to_begin(receiver) == -1)
+    {
+        dlt_log(LOG_WARNING,
+                "Can't move bytes to beginning of receiver buffer for user "
+                "messages\n");
+        return 0;
+    }
+
+    if (grow > 0)
+    {
+        if (grow > DLT_DAEMON_RCVBUFSIZE_APP_MAX)
+        {
+            grow = DLT_DAEMON_RCVBUFSIZE_APP_MAX;
+        }
+
+        if (dlt_receiver_grow(receiver, grow) != DLT_RETURN_OK)
+        {
+            dlt_log(LOG_WARNING, "Can't enlarge receiver buffer for user messages\n");
+        }
+    }
+
+    return 0;
+}
+
+static void *dlt_daemon_ingest_thread(void *arg)
+{
+    DltDaemonIngestWorker *worker = (DltDaemonIngestWorker *)arg;
+    struct epoll_event events[DLT_EPOLL_MAX_EVENTS];
+    sigset_t set;
+    eventfd_t value;
+    int nfds;
+    int i;
+
+    /* signals are handled by the main loop */
+    sigfillset(&set);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+    while (!__atomic_load_n(&worker->stop, __ATOMIC_ACQUIRE))
+    {
+        nfds = epoll_wait(worker->epfd, events, DLT_EPOLL_MAX_EVENTS, -1);
+
+        if (nfds < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            dlt_vlog(LOG_CRIT, "Ingest worker %d: epoll_wait() failed: %s\n", worker->id, strerror(errno));
+            break;
+        }
+
+        for (i = 0; i < nfds; i++)
+        {
+            if (events[i].data.ptr == NULL)
+            {
+                /* space or stop notification */
+                eventfd_read(worker->space_fd, &value);
+                continue;
+            }
+
+            if (dlt_daemon_ingest_read(worker, (DltReceiver *)events[i].data.ptr) < 0)
+            {
+                break;
+            }
+        }
+
+        /* one notification for everything received in this round */
+        if (__atomic_load_n(&worker->queue.tail, __ATOMIC_ACQUIRE) != worker->queue.head)
+        {
+            dlt_daemon_ingest_notify(worker);
+        }
+    }
+
+    return NULL;
+}
+
+static void dlt_daemon_ingest_worker_free(DltDaemonIngestWorker *worker, int close_notify)
+{
+    if (worker->running)
+    {
+        __atomic_store_n(&worker->stop, 1, __ATOMIC_RELEASE);
+        eventfd_write(worker->space_fd, 1);
+        pthread_join(worker->thread, NULL);
+        worker->running = 0;
+    }
+
+    if (worker->epfd >= 0)
+    {
+        close(worker->epfd);
+        worker->epfd = -1;
+    }
+
+    if (worker->space_fd >= 0)
+    {
+        close(worker->space_fd);
+        worker->space_fd = -1;
+    }
+
+    if (close_notify && (worker->notify_fd >= 0))
+    {
+        close(worker->notify_fd);
+        worker->notify_fd = -1;
+    }
+
+    dlt_message_free(&worker->msg, 0);
+    free(worker->queue.data);
+    worker->queue.data = NULL;
+}
+
+static int dlt_daemon_ingest_worker_init(DltDaemonIngestWorker *worker, int id, int verbose)
+{
+    struct epoll_event ev;
+    cpu_set_t cpus;
+    long nprocs;
+
+    worker->id = id;
+    worker->epfd = epoll_create(DLT_EPOLL_MAX_EVENTS);
+    worker->notify_fd = eventfd(0, EFD_NONBLOCK);
+    worker->space_fd = eventfd(0, EFD_NONBLOCK);
+    worker->queue.size = DLT_DAEMON_INGEST_QUEUE_SIZE;
+    worker->queue.data = malloc(worker->queue.size);
+
+    if ((worker->epfd < 0) || (worker->notify_fd < 0) ||
+        (worker->space_fd < 0) || (worker->queue.data == NULL) ||
+        (dlt_message_init(&worker->msg, verbose) != DLT_RETURN_OK))
+    {
+        dlt_vlog(LOG_ERR, "Ingest worker %d: initialization failed\n", id);
+        return -1;
+    }
+
+    /* a NULL pointer identifies the space notification */
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+
+    if (epoll_ctl(worker->epfd, EPOLL_CTL_ADD, worker->space_fd, &ev) == -1)
+    {
+        dlt_vlog(LOG_ERR, "Ingest worker %d: epoll_ctl() failed\n", id);
+        return -1;
+    }
+
+    if (pthread_create(&worker->thread, NULL, dlt_daemon_ingest_thread, worker) != 0)
+    {
+        dlt_vlog(LOG_ERR, "Ingest worker %d: cannot create thread\n", id);
+        return -1;
+    }
+    worker->running = 1;
+
+    /* keep the first CPU for the main loop if possible */
+    nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+    if (nprocs > 1)
+    {
+        CPU_ZERO(&cpus);
+        CPU_SET((id + 1) % nprocs, &cpus);
+
+        if (pthread_setaffinity_np(worker->thread, sizeof(cpus), &cpus) != 0)
+        {
+            dlt_vlog(LOG_WARNING, "Ingest worker %d: cannot set CPU affinity\n", id);
+        }
+    }
+
+    return 0;
+}
+
+int dlt_daemon_ingest_init(DltDaemonIngest *ingest, int num_workers, int verbose)
+{
+    int i;
+
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if (ingest == NULL)
+    {
+        return -1;
+    }
+
+    ingest->num_workers = 0;
+    ingest->workers = NULL;
+
+    if (num_workers <= 0)
+    {
+        return 0;
+    }
+
+    if (num_workers > DLT_DAEMON_INGEST_MAX_THREADS)
+    {
+        dlt_vlog(LOG_WARNING,
+                 "Number of ingest threads limited to %d\n",
+                 DLT_DAEMON_INGEST_MAX_THREADS);
+        num_workers = DLT_DAEMON_INGEST_MAX_THREADS;
+    }
+
+    ingest->workers = calloc((size_t)num_workers, sizeof(DltDaemonIngestWorker));
+
+    if (ingest->workers == NULL)
+    {
+        dlt_log(LOG_ERR, "Cannot allocate ingest workers\n");
+        return -1;
+    }
+
+    for (i = 0; i < num_workers; i++)
+    {
+        ingest->workers[i].epfd = -1;
+        ingest->workers[i].notify_fd = -1;
+        ingest->workers[i].space_fd = -1;
+    }
+
+    for (i = 0; i < num_workers; i++)
+    {
+        if (dlt_daemon_ingest_worker_init(&ingest->workers[i], i, verbose) != 0)
+        {
+            while (i >= 0)
+            {
+                dlt_daemon_ingest_worker_free(&ingest->workers[i], 1);
+                i--;
+            }
+
+            free(ingest->workers);
+            ingest->workers = NULL;
+            return -1;
+        }
+    }
+
+    ingest->num_workers = num_workers;
+
+    dlt_vlog(LOG_INFO, "%d ingest threads started\n", num_workers);
+
+    return 0;
+}
+
+void dlt_daemon_ingest_free(DltDaemonIngest *ingest, int verbose)
+{
+    int i;
+
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if ((ingest == NULL) || (ingest->workers == NULL))
+    {
+        return;
+    }
+
+    for (i = 0; i < ingest->num_workers; i++)
+    {
+        dlt_daemon_ingest_worker_free(&ingest->workers[i], 0);
+    }
+
+    free(ingest->workers);
+    ingest->workers = NULL;
+    ingest->num_workers = 0;
+}
+
+int dlt_daemon_ingest_add(DltDaemonIngest *ingest, DltReceiver *receiver)
+{
+    DltDaemonIngestWorker *worker = NULL;
+    struct epoll_event ev;
+    int i;
+
+    if ((ingest == NULL) || (ingest->num_workers <= 0) || (receiver == NULL))
+    {
+        return -1;
+    }
+
+    for (i = 0; i < ingest->num_workers; i++)
+    {
+        if ((worker == NULL) ||
+            (__atomic_load_n(&ingest->workers[i].connections, __ATOMIC_RELAXED) <
+             __atomic_load_n(&worker->connections, __ATOMIC_RELAXED)))
+        {
+            worker = &ingest->workers[i];
+        }
+    }
+
+    __atomic_add_fetch(&worker->connections, 1, __ATOMIC_RELAXED);
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = receiver;
+
+    if (epoll_ctl(worker->epfd, EPOLL_CTL_ADD, receiver->fd, &ev) == -1)
+    {
+        dlt_vlog(LOG_ERR, "Ingest worker %d: epoll_ctl() failed: %s\n", worker->id, strerror(errno));
+        __atomic_sub_fetch(&worker->connections, 1, __ATOMIC_RELAXED);
+        return -1;
+    }
+
+    return 0;
+}
+
+DltDaemonIngestWorker *dlt_daemon_ingest_find(DltDaemonIngest *ingest, int notify_fd)
+{
+    int i;
+
+    if (ingest == NULL)
+    {
+        return NULL;
+    }
+
+    for (i = 0; i < ingest->num_workers; i++)
+    {
+        if (ingest->workers[i].notify_fd == notify_fd)
+        {
+            return &ingest->workers[i];
+        }
+    }
+
+    return NULL;
+}
+
+int dlt_daemon_ingest_peek(DltDaemonIngestWorker *worker,
+                           int *fd,
+                           int *type,
+                           char **data,
+                           int32_t *size)
+{
+    DltDaemonIngestQueue *queue;
+    DltDaemonIngestRecord *record;
+    uint32_t head;
+    uint32_t pos;
+
+    if ((worker == NULL) || (fd == NULL) || (type == NULL) || (data == NULL) || (size == NULL))
+    {
+        return 0;
+    }
+
+    queue = &worker->queue;
+    head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+
+    while (queue->tail != head)
+    {
+        pos = queue->tail & (queue->size - 1);
+        record = (DltDaemonIngestRecord *)(queue->data + pos);
+
+        if (record->size == DLT_DAEMON_INGEST_PAD)
+        {
+            __atomic_store_n(&queue->tail, queue->tail + (queue->size - pos), __ATOMIC_SEQ_CST);
+            continue;
+        }
+
+        *fd = record->fd;
+        *type = (int)record->type;
+        *data = (char *)(queue->data + pos + sizeof(DltDaemonIngestRecord));
+        *size = (int32_t)record->size;
+        return 1;
+    }
+
+    return 0;
+}
+
+void dlt_daemon_ingest_release(DltDaemonIngestWorker *worker)
+{
+    DltDaemonIngestQueue *queue;
+    DltDaemonIngestRecord *record;
+
+    if (worker == NULL)
+    {
+        return;
+    }
+
+    queue = &worker->queue;
+
+    if (queue->tail == __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+
+    record = (DltDaemonIngestRecord *)(queue->data + (queue->tail & (queue->size - 1)));
+    __atomic_store_n(&queue->tail,
+                     queue->tail + DLT_DAEMON_INGEST_ALIGN(sizeof(DltDaemonIngestRecord) + record->size),
+                     __ATOMIC_SEQ_CST);
+
+    if (__atomic_load_n(&worker->waiting, __ATOMIC_SEQ_CST))
+    {
+        eventfd_write(worker->space_fd, 1);
+    }
+}
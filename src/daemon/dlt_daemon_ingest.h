@@ -0,0 +1,150 @@
+/*
+ * @licence app begin@
+ * SPDX license identifier: MPL-2.0
+ *
+ * This file is part of GENIVI Project DLT - Diagnostic Log and Trace.
+ *
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License (MPL), v. 2.0.
+ * If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * For further information see http://www.genivi.org/.
+ * @licence end@
+ */
+
+/*!
+ * \file dlt_daemon_ingest.h
+ *
+ * Ingest workers receive and frame the messages of application connections
+ * in own threads. Each worker owns a subset of the connections and passes
+ * complete user messages in reception order to the main loop, through a
+ * single producer/single consumer queue per worker.
+ */
+
+#ifndef DLT_DAEMON_INGEST_H
+#define DLT_DAEMON_INGEST_H
+
+#include <pthread.h>
+
+#include "dlt_common.h"
+
+/* maximum number of ingest workers */
+#define DLT_DAEMON_INGEST_MAX_THREADS 16
+
+/* record types in the queue of a worker */
+#define DLT_DAEMON_INGEST_MSG   0 /* complete user message */
+#define DLT_DAEMON_INGEST_CLOSE 1 /* connection was closed by the application */
+
+/**
+ * Queue from one worker to the main loop.
+ * head and tail are free running byte counters, records never wrap.
+ */
+typedef struct
+{
+    uint8_t *data;          /**< record storage */
+    uint32_t size;          /**< size of storage, power of two */
+    uint32_t head;          /**< written by the worker only */
+    uint32_t tail;          /**< written by the main loop only */
+} DltDaemonIngestQueue;
+
+typedef struct
+{
+    int id;                 /**< index of the worker */
+    pthread_t thread;       /**< receiving thread */
+    int running;            /**< thread was started */
+    int epfd;               /**< epoll instance of the owned connections */
+    int notify_fd;          /**< eventfd, signals queued records to the main loop */
+    int space_fd;           /**< eventfd, signals free queue space or stop to the worker */
+    int stop;               /**< request to terminate the worker */
+    int waiting;            /**< worker waits for free queue space */
+    int connections;        /**< number of owned connections */
+    DltMessage msg;         /**< used for framing of log messages */
+    DltDaemonIngestQueue queue;
+} DltDaemonIngestWorker;
+
+typedef struct
+{
+    int num_workers;        /**< 0 if connections are handled by the main loop */
+    DltDaemonIngestWorker *workers;
+} DltDaemonIngest;
+
+/**
+ * Create the queues and start the workers.
+ * @param ingest structure to be initialized
+ * @param num_workers number of worker threads, 0 disables the workers
+ * @param verbose if set to true verbose information is printed out.
+ * @return 0 on success, -1 otherwise
+ */
+int dlt_daemon_ingest_init(DltDaemonIngest *ingest, int num_workers, int verbose);
+
+/**
+ * Stop the workers and free the queues.
+ * The notification descriptors belong to their connections once registered
+ * in the main loop and are not closed here.
+ * @param ingest structure to be freed
+ * @param verbose if set to true verbose information is printed out.
+ */
+void dlt_daemon_ingest_free(DltDaemonIngest *ingest, int verbose);
+
+/**
+ * Hand over an application connection to the worker with the fewest
+ * connections. The receiver stays owned by the connection in the main loop.
+ * @param ingest ingest structure
+ * @param receiver receiver of the application connection
+ * @return 0 on success, -1 otherwise
+ */
+int dlt_daemon_ingest_add(DltDaemonIngest *ingest, DltReceiver *receiver);
+
+/**
+ * Find the worker notifying on a descriptor.
+ * @param ingest ingest structure
+ * @param notify_fd notification descriptor
+ * @return worker or NULL
+ */
+DltDaemonIngestWorker *dlt_daemon_ingest_find(DltDaemonIngest *ingest, int notify_fd);
+
+/**
+ * Clear the notification of a worker before its queue is drained.
+ * @param worker worker
+ */
+void dlt_daemon_ingest_ack(DltDaemonIngestWorker *worker);
+
+/**
+ * Notify the main loop again, e.g. if draining was interrupted.
+ * @param worker worker
+ */
+void dlt_daemon_ingest_notify(DltDaemonIngestWorker *worker);
+
+/**
+ * Get the oldest record of the queue of a worker without removing it.
+ * @param worker worker
+ * @param fd application connection of the record
+ * @param type DLT_DAEMON_INGEST_MSG or DLT_DAEMON_INGEST_CLOSE
+ * @param data user message, valid until released
+ * @param size size of user message
+ * @return 1 if a record is available, 0 if the queue is empty
+ */
+int dlt_daemon_ingest_peek(DltDaemonIngestWorker *worker,
+                           int *fd,
+                           int *type,
+                           char **data,
+                           int32_t *size);
+
+/**
+ * Remove the oldest record from the queue of a worker.
+ * @param worker worker
+ */
+void dlt_daemon_ingest_release(DltDaemonIngestWorker *worker);
+
+/**
+ * Get the size of the user message at the beginning of a buffer.
+ * The size corresponds to the bytes the message handlers consume.
+ * @param msg message used for parsing of log message headers
+ * @param buf buffer starting with a user header
+ * @param length number of bytes in buffer
+ * @return size of the message, 0 if incomplete, -1 if it cannot be handled
+ */
+int32_t dlt_daemon_ingest_message_size(DltMessage *msg, const char *buf, int32_t length);
+
+#endif /* DLT_DAEMON_INGEST_H */
@@ -24,6 +24,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <syslog.h>
+#include <limits.h>
 
 #include "dlt_daemon_offline_logstorage.h"
 
@@ -36,7 +37,7 @@
  * If :CTID - ctxid = CTID and appid = .*
  * Else appid = APID and ctxid = CTID
  *
- * @param key      Given key of filter hash map
+ * @param key      Given key of filter table
  * @param appid    Application id
  * @param ctxid    Context id
  * @return         0 on success, -1 on error
@@ -515,48 +516,66 @@ void dlt_daemon_logstorage_write(DltDaemon *daemon,
     }
 
     /* Copy user configuration */
-    file_config.logfile_timestamp = user_config->offlineLogstorageTimestamp;
-    file_config.logfile_delimiter = user_config->offlineLogstorageDelimiter;
-    file_config.logfile_maxcounter = user_config->offlineLogstorageMaxCounter;
-    file_config.logfile_counteridxlen =
-            user_config->offlineLogstorageMaxCounterIdx;
+    dlt_daemon_logstorage_get_user_config(user_config, &file_config);
 
     for (i = 0; i < user_config->offlineLogstorageMaxDevices; i++)
     {
-        if (daemon->storage_handle[i].config_status ==
-            DLT_OFFLINE_LOGSTORAGE_CONFIG_DONE)
+        dlt_daemon_logstorage_write_device(daemon,
+                                           i,
+                                           &file_config,
+                                           data1,
+                                           size1,
+                                           data2,
+                                           size2,
+                                           data3,
+                                           size3);
+    }
+}
+
+void dlt_daemon_logstorage_get_user_config(DltDaemonFlags *user_config,
+                                           DltLogStorageUserConfig *file_config)
+{
+    file_config->logfile_timestamp = user_config->offlineLogstorageTimestamp;
+    file_config->logfile_delimiter = user_config->offlineLogstorageDelimiter;
+    file_config->logfile_maxcounter = user_config->offlineLogstorageMaxCounter;
+    file_config->logfile_counteridxlen =
+            user_config->offlineLogstorageMaxCounterIdx;
+}
+
+void dlt_daemon_logstorage_write_device(DltDaemon *daemon,
+                                        int dev_num,
+                                        DltLogStorageUserConfig *file_config,
+                                        unsigned char *data1,
+                                        int size1,
+                                        unsigned char *data2,
+                                        int size2,
+                                        unsigned char *data3,
+                                        int size3)
+{
+    if (daemon->storage_handle[dev_num].config_status ==
+        DLT_OFFLINE_LOGSTORAGE_CONFIG_DONE)
+    {
+        if (dlt_logstorage_write(&(daemon->storage_handle[dev_num]),
+                                 file_config,
+                                 data1,
+                                 size1,
+                                 data2,
+                                 size2,
+                                 data3,
+                                 size3) != 0)
         {
-            if (dlt_logstorage_write(&(daemon->storage_handle[i]),
-                                     &file_config,
-                                     data1,
-                                     size1,
-                                     data2,
-                                     size2,
-                                     data3,
-                                     size3) != 0)
-            {
-                dlt_log(LOG_ERR,
-                        "dlt_daemon_logstorage_write: failed. "
-                        "Disable storage device\n");
-                /* DLT_OFFLINE_LOGSTORAGE_MAX_WRITE_ERRORS happened,
-                 * therefore remove logstorage device */
-                dlt_logstorage_device_disconnected(
-                        &(daemon->storage_handle[i]),
-                        DLT_LOGSTORAGE_SYNC_ON_DEVICE_DISCONNECT);
-            }
+            dlt_log(LOG_ERR,
+                    "dlt_daemon_logstorage_write: failed. "
+                    "Disable storage device\n");
+            /* DLT_OFFLINE_LOGSTORAGE_MAX_WRITE_ERRORS happened,
+             * therefore remove logstorage device */
+            dlt_logstorage_device_disconnected(
+                    &(daemon->storage_handle[dev_num]),
+                    DLT_LOGSTORAGE_SYNC_ON_DEVICE_DISCONNECT);
         }
     }
 }
 
-/**
- * dlt_daemon_logstorage_setup_internal_storage
- *
- * Setup user defined path as offline log storage device
- *
- * @param daemon        Pointer to Dlt Daemon structure
- * @param path          User configured internal storage path
- * @param verbose       If set to true verbose information is printed out
- */
 int dlt_daemon_logstorage_setup_internal_storage(DltDaemon *daemon, char *path, int verbose)
 {
     int ret = 0;
@@ -620,6 +639,9 @@ int dlt_daemon_logstorage_cleanup(DltDaemon *daemon,
         }
     }
 
+    /* synced caches must be written before the daemon exits */
+    dlt_logstorage_flush_caches(UINT_MAX);
+
     return 0;
 }
 
@@ -674,6 +696,34 @@ int dlt_daemon_logstorage_sync_cache(DltDaemon *daemon,
     return 0;
 }
 
+int dlt_daemon_logstorage_commit_due(DltDaemon *daemon,
+                                     DltDaemonLocal *daemon_local,
+                                     int period,
+                                     int verbose)
+{
+    int i = 0;
+
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if (daemon == NULL || daemon_local == NULL)
+    {
+        return -1;
+    }
+
+    for (i = 0; i < daemon_local->flags.offlineLogstorageMaxDevices; i++)
+    {
+        if (daemon->storage_handle[i].connection_type ==
+                DLT_OFFLINE_LOGSTORAGE_DEVICE_CONNECTED &&
+            daemon->storage_handle[i].config_status ==
+                DLT_OFFLINE_LOGSTORAGE_CONFIG_DONE)
+        {
+            dlt_logstorage_commit_due(&daemon->storage_handle[i], period);
+        }
+    }
+
+    return 0;
+}
+
 DltLogStorage *dlt_daemon_logstorage_get_device(DltDaemon *daemon,
                                                 DltDaemonLocal *daemon_local,
                                                 char *mnt_point,
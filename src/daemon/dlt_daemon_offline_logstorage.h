@@ -121,6 +121,44 @@ void dlt_daemon_logstorage_write(DltDaemon *daemon,
                                  unsigned char *data3,
                                  int size3);
 
+/**
+ * dlt_daemon_logstorage_get_user_config
+ *
+ * Copy the logstorage file name settings from the daemon configuration.
+ *
+ * @param user_config   DltDaemon configuration
+ * @param file_config   Logstorage file name settings to be filled
+ */
+void dlt_daemon_logstorage_get_user_config(DltDaemonFlags *user_config,
+                                           DltLogStorageUserConfig *file_config);
+
+/**
+ * dlt_daemon_logstorage_write_device
+ *
+ * Write log message to one storage device, if it is configured. If the called
+ * dlt_logstorage_write function is not able to write to the device, DltDaemon
+ * will disconnect this device.
+ *
+ * @param daemon        Pointer to Dlt Daemon structure
+ * @param dev_num       Number of storage device
+ * @param file_config   Logstorage file name settings
+ * @param data1         storage header buffer
+ * @param size1         storage header buffer size
+ * @param data2         message header buffer
+ * @param size2         message header buffer size
+ * @param data3         message data buffer
+ * @param size3         message data size
+ */
+void dlt_daemon_logstorage_write_device(DltDaemon *daemon,
+                                        int dev_num,
+                                        DltLogStorageUserConfig *file_config,
+                                        unsigned char *data1,
+                                        int size1,
+                                        unsigned char *data2,
+                                        int size2,
+                                        unsigned char *data3,
+                                        int size3);
+
 /**
  * dlt_daemon_logstorage_setup_internal_storage
  *
@@ -164,6 +202,21 @@ int dlt_daemon_logstorage_sync_cache(DltDaemon *daemon,
                                      char *mnt_point,
                                      int verbose);
 
+/**
+ * Write messages of group commit filters which would wait longer than their
+ * commit interval before the next check
+ *
+ * @param daemon        Pointer to Dlt Daemon structure
+ * @param daemon_local  Pointer to Dlt Daemon Local structure
+ * @param period        Time in ms until the next check
+ * @param verbose       If set to true verbose information is printed out
+ * @return 0 on success, -1 otherwise
+ */
+int dlt_daemon_logstorage_commit_due(DltDaemon *daemon,
+                                     DltDaemonLocal *daemon_local,
+                                     int period,
+                                     int verbose);
+
 /**
  * dlt_logstorage_get_device
  *
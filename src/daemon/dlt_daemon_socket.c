@@ -42,6 +42,7 @@
 #include <errno.h>
 #include <pthread.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <net/if.h>
 
 #ifdef linux
@@ -203,6 +204,226 @@ int dlt_daemon_socket_sendreliable(int sock, void* buffer, int message_size)
     return DLT_DAEMON_ERROR_OK;
 }
 
+int dlt_daemon_socket_queue_init(DltDaemonSocketQueue *queue, int32_t max_size, int32_t high_watermark, int32_t low_watermark)
+{
+    if ((queue == NULL) || (max_size <= 0) ||
+        (high_watermark <= 0) || (high_watermark > max_size) ||
+        (low_watermark < 0) || (low_watermark > high_watermark))
+    {
+        return DLT_DAEMON_ERROR_UNKNOWN;
+    }
+
+    /* storage is allocated with the first message */
+    memset(queue, 0, sizeof(DltDaemonSocketQueue));
+    queue->max_size = max_size;
+    queue->high_watermark = high_watermark;
+    queue->low_watermark = low_watermark;
+
+    return DLT_DAEMON_ERROR_OK;
+}
+
+void dlt_daemon_socket_queue_free(DltDaemonSocketQueue *queue)
+{
+    if (queue == NULL)
+    {
+        return;
+    }
+
+    free(queue->buffer);
+    queue->buffer = NULL;
+    queue->size = 0;
+    queue->start = 0;
+    queue->used = 0;
+}
+
+/* Enlarge the ring, queued bytes are moved to the beginning */
+static int dlt_daemon_socket_queue_grow(DltDaemonSocketQueue *queue, int32_t needed)
+{
+    int32_t size = (queue->size > 0) ? queue->size : DLT_DAEMON_SNDQUEUESIZE;
+    int32_t first;
+    char *buffer;
+
+    while (size < needed)
+    {
+        size *= 2;
+    }
+
+    if (size > queue->max_size)
+    {
+        size = queue->max_size;
+    }
+
+    buffer = malloc(size);
+    if (buffer == NULL)
+    {
+        return -1;
+    }
+
+    if (queue->used > 0)
+    {
+        first = queue->size - queue->start;
+        if (first > queue->used)
+        {
+            first = queue->used;
+        }
+
+        memcpy(buffer, queue->buffer + queue->start, first);
+        memcpy(buffer + first, queue->buffer, queue->used - first);
+    }
+
+    free(queue->buffer);
+    queue->buffer = buffer;
+    queue->size = size;
+    queue->start = 0;
+
+    return 0;
+}
+
+static void dlt_daemon_socket_queue_append(DltDaemonSocketQueue *queue, const void *data, int32_t size)
+{
+    int32_t end = (queue->start + queue->used) % queue->size;
+    int32_t part = queue->size - end;
+
+    if (part > size)
+    {
+        part = size;
+    }
+
+    memcpy(queue->buffer + end, data, part);
+    memcpy(queue->buffer, (const char *)data + part, size - part);
+    queue->used += size;
+}
+
+int dlt_daemon_socket_queue_add(DltDaemonSocketQueue *queue,void* data1,int size1,void* data2,int size2,char serialheader)
+{
+    int32_t total = 0;
+
+    if (queue == NULL)
+    {
+        return DLT_DAEMON_ERROR_UNKNOWN;
+    }
+
+    if (data1 == NULL)
+    {
+        size1 = 0;
+    }
+
+    if (data2 == NULL)
+    {
+        size2 = 0;
+    }
+
+    total = (serialheader ? (int32_t)sizeof(dltSerialHeader) : 0) + (size1 > 0 ? size1 : 0) + (size2 > 0 ? size2 : 0);
+
+    if (queue->degraded)
+    {
+        queue->dropped++;
+        return DLT_DAEMON_ERROR_BUFFER_FULL;
+    }
+
+    if ((queue->used > 0) && ((queue->used + total) > queue->high_watermark))
+    {
+        /* the client does not keep up, drop until it caught up again */
+        queue->degraded = 1;
+        queue->dropped++;
+        return DLT_DAEMON_ERROR_BUFFER_FULL;
+    }
+
+    if ((queue->used + total) > queue->size)
+    {
+        if (((queue->used + total) > queue->max_size) ||
+            (dlt_daemon_socket_queue_grow(queue, queue->used + total) != 0))
+        {
+            queue->dropped++;
+            return DLT_DAEMON_ERROR_BUFFER_FULL;
+        }
+    }
+
+    if (serialheader)
+    {
+        dlt_daemon_socket_queue_append(queue, dltSerialHeader, sizeof(dltSerialHeader));
+    }
+
+    if (size1 > 0)
+    {
+        dlt_daemon_socket_queue_append(queue, data1, size1);
+    }
+
+    if (size2 > 0)
+    {
+        dlt_daemon_socket_queue_append(queue, data2, size2);
+    }
+
+    return DLT_DAEMON_ERROR_OK;
+}
+
+int dlt_daemon_socket_queue_flush(int sock, DltDaemonSocketQueue *queue)
+{
+    struct iovec iov[2];
+    struct msghdr msg;
+    int32_t first;
+    ssize_t ret;
+
+    if (queue == NULL)
+    {
+        return DLT_DAEMON_ERROR_UNKNOWN;
+    }
+
+    while (queue->used > 0)
+    {
+        /* queued bytes may wrap around the end of the ring */
+        first = queue->size - queue->start;
+        if (first > queue->used)
+        {
+            first = queue->used;
+        }
+
+        memset(&msg, 0, sizeof(msg));
+        iov[0].iov_base = queue->buffer + queue->start;
+        iov[0].iov_len = first;
+        iov[1].iov_base = queue->buffer;
+        iov[1].iov_len = queue->used - first;
+        msg.msg_iov = iov;
+        msg.msg_iovlen = (queue->used > first) ? 2 : 1;
+
+        ret = sendmsg(sock, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+
+        if (ret < 0)
+        {
+            const int lastErrno = errno;
+
+            if (lastErrno == EINTR)
+            {
+                continue;
+            }
+
+            if ((lastErrno == EAGAIN) || (lastErrno == EWOULDBLOCK))
+            {
+                /* continue when the socket is writable again */
+                break;
+            }
+
+            dlt_vlog(LOG_WARNING, "dlt_daemon_socket_queue_flush: socket sendmsg() error %d: %s\n", lastErrno, strerror(lastErrno));
+            return DLT_DAEMON_ERROR_SEND_FAILED;
+        }
+
+        queue->start = (queue->start + (int32_t)ret) % queue->size;
+        queue->used -= (int32_t)ret;
+    }
+
+    if (queue->used == 0)
+    {
+        queue->start = 0;
+    }
+
+    if (queue->degraded && (queue->used <= queue->low_watermark))
+    {
+        queue->degraded = 0;
+    }
+
+    return DLT_DAEMON_ERROR_OK;
+}
+
 int dlt_daemon_socket_get_send_qeue_max_size(int sock)
 {
     int n = 0;
@@ -62,6 +62,26 @@
 #include "dlt_common.h"
 #include "dlt_user.h"
 
+/**
+ * Outgoing bytes of a client connection, sent when the socket is writable.
+ * The queue is a ring growing up to max_size, messages are only queued or
+ * dropped as a whole.
+ * A client exceeding the high watermark is degraded: all its messages are
+ * dropped and counted until the queue is sent down to the low watermark.
+ */
+typedef struct DltDaemonSocketQueue
+{
+    char *buffer;           /**< ring of queued bytes */
+    int32_t size;           /**< allocated size of buffer */
+    int32_t max_size;       /**< maximum backlog */
+    int32_t start;          /**< offset of the first queued byte */
+    int32_t used;           /**< number of queued bytes */
+    int32_t high_watermark; /**< backlog degrading the client */
+    int32_t low_watermark;  /**< backlog recovering the client */
+    int degraded;           /**< client is in drop mode */
+    uint32_t dropped;       /**< messages dropped and not yet reported */
+} DltDaemonSocketQueue;
+
 int dlt_daemon_socket_open(int *sock, unsigned int servPort);
 int dlt_daemon_socket_close(int sock);
 
@@ -78,4 +98,41 @@ int dlt_daemon_socket_send(int sock,void* data1,int size1,void* data2,int size2,
  */
 int dlt_daemon_socket_sendreliable(int sock, void* buffer,int  message_size);
 
+/**
+ * @brief dlt_daemon_socket_queue_init - initialize an outgoing queue
+ * @param queue
+ * @param max_size maximum number of queued bytes
+ * @param high_watermark number of queued bytes from which messages are dropped
+ * @param low_watermark number of queued bytes up to which the queue must be sent to stop dropping
+ * @return on success: DLT_DAEMON_ERROR_OK, otherwise DLT_DAEMON_ERROR_UNKNOWN
+ */
+int dlt_daemon_socket_queue_init(DltDaemonSocketQueue *queue, int32_t max_size, int32_t high_watermark, int32_t low_watermark);
+
+/**
+ * @brief dlt_daemon_socket_queue_free - free an outgoing queue, queued bytes are discarded
+ * @param queue
+ */
+void dlt_daemon_socket_queue_free(DltDaemonSocketQueue *queue);
+
+/**
+ * @brief dlt_daemon_socket_queue_add - append a message to an outgoing queue
+ * @param queue
+ * @param data1
+ * @param size1
+ * @param data2
+ * @param size2
+ * @param serialheader prepend the serial header
+ * @return DLT_DAEMON_ERROR_OK, or DLT_DAEMON_ERROR_BUFFER_FULL if the message was dropped
+ */
+int dlt_daemon_socket_queue_add(DltDaemonSocketQueue *queue,void* data1,int size1,void* data2,int size2,char serialheader);
+
+/**
+ * @brief dlt_daemon_socket_queue_flush - send queued bytes as far as the socket accepts them without blocking,
+ * a degraded queue recovers once it is sent down to the low watermark
+ * @param sock
+ * @param queue
+ * @return on success: DLT_DAEMON_ERROR_OK, on error: DLT_DAEMON_ERROR_SEND_FAILED
+ */
+int dlt_daemon_socket_queue_flush(int sock, DltDaemonSocketQueue *queue);
+
 #endif /* DLT_DAEMON_SOCKET_H */
@@ -0,0 +1,515 @@
+/*
+ * @licence app begin@
+ * SPDX license identifier: MPL-2.0
+ *
+ * This file is part of GENIVI Project DLT - Diagnostic Log and Trace.
+ *
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License (MPL), v. 2.0.
+ * If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * For further information see http://www.genivi.org/.
+ * @licence end@
+ */
+
+/*!
+ * \file dlt_daemon_storage.c
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/eventfd.h>
+#include <sys/syslog.h>
+
+#include "dlt_daemon_storage.h"
+#include "dlt_daemon_offline_logstorage.h"
+#include "dlt-daemon_cfg.h"
+#include "dlt_common.h"
+
+static void dlt_daemon_storage_queue_name(int idx, char *name, size_t len)
+{
+    if (idx == DLT_DAEMON_STORAGE_OFFLINE_TRACE)
+    {
+        snprintf(name, len, "offline trace");
+    }
+    else
+    {
+        snprintf(name, len, "logstorage device %d", idx - 1);
+    }
+}
+
+/* Log dropped messages once the queue accepts messages again */
+static void dlt_daemon_storage_report_dropped(DltDaemonStorageQueue *queue, int idx)
+{
+    char name[32];
+
+    if (queue->dropped == queue->reported)
+    {
+        return;
+    }
+
+    dlt_daemon_storage_queue_name(idx, name, sizeof(name));
+    dlt_vlog(LOG_WARNING,
+             "Storage queue of %s was full, %llu messages dropped\n",
+             name,
+             queue->dropped - queue->reported);
+    queue->reported = queue->dropped;
+}
+
+static int dlt_daemon_storage_queue_full(DltDaemonStorageQueue *queue)
+{
+    return (queue->head - __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE)) >= queue->size;
+}
+
+static void dlt_daemon_storage_queue_push(DltDaemonStorageQueue *queue,
+                                          DltDaemonStorageMsg *msg)
+{
+    queue->msgs[queue->head & (queue->size - 1)] = msg;
+    __atomic_store_n(&queue->head, queue->head + 1, __ATOMIC_SEQ_CST);
+}
+
+static DltDaemonStorageMsg *dlt_daemon_storage_queue_pop(DltDaemonStorageQueue *queue)
+{
+    DltDaemonStorageMsg *msg;
+
+    if (queue->tail == __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE))
+    {
+        return NULL;
+    }
+
+    msg = queue->msgs[queue->tail & (queue->size - 1)];
+    __atomic_store_n(&queue->tail, queue->tail + 1, __ATOMIC_RELEASE);
+
+    return msg;
+}
+
+static int dlt_daemon_storage_pending(DltDaemonStorage *storage)
+{
+    int i;
+
+    for (i = 0; i < storage->num_queues; i++)
+    {
+        if (storage->queues[i].tail !=
+            __atomic_load_n(&storage->queues[i].head, __ATOMIC_SEQ_CST))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void dlt_daemon_storage_release(DltDaemonStorageMsg *msg)
+{
+    /* only the storage thread releases messages */
+    if (--msg->refcount == 0)
+    {
+        free(msg);
+    }
+}
+
+static void dlt_daemon_storage_write_msg(DltDaemonStorage *storage,
+                                         int idx,
+                                         DltDaemonStorageMsg *msg)
+{
+    static int error_dlt_offline_trace_write_failed = 0;
+    unsigned char *data1 = msg->data;
+    unsigned char *data2 = data1 + msg->size1;
+    unsigned char *data3 = data2 + msg->size2;
+
+    if (idx == DLT_DAEMON_STORAGE_OFFLINE_TRACE)
+    {
+        if (dlt_offline_trace_write(storage->trace,
+                                    data1, msg->size1,
+                                    data2, msg->size2,
+                                    data3, msg->size3) &&
+            !error_dlt_offline_trace_write_failed)
+        {
+            dlt_log(LOG_ERR, "dlt_daemon_storage: dlt_offline_trace_write failed!\n");
+            error_dlt_offline_trace_write_failed = 1;
+        }
+    }
+    else
+    {
+        dlt_daemon_logstorage_write_device(storage->daemon,
+                                           idx - 1,
+                                           &storage->file_config,
+                                           data1, msg->size1,
+                                           data2, msg->size2,
+                                           data3, msg->size3);
+    }
+}
+
+/* Write buffered data which must not wait longer, like the one second timer
+ * of the main loop does without storage thread */
+static void dlt_daemon_storage_flush_due(DltDaemonStorage *storage)
+{
+    int i;
+
+    if (storage->trace != NULL)
+    {
+        dlt_offline_trace_flush_due(storage->trace, DLT_DAEMON_STORAGE_FLUSH_MSEC);
+    }
+
+    for (i = 1; i < storage->num_queues; i++)
+    {
+        if ((storage->daemon->storage_handle[i - 1].connection_type ==
+             DLT_OFFLINE_LOGSTORAGE_DEVICE_CONNECTED) &&
+            (storage->daemon->storage_handle[i - 1].config_status ==
+             DLT_OFFLINE_LOGSTORAGE_CONFIG_DONE))
+        {
+            dlt_logstorage_commit_due(&storage->daemon->storage_handle[i - 1],
+                                      DLT_DAEMON_STORAGE_FLUSH_MSEC);
+        }
+    }
+}
+
+static void *dlt_daemon_storage_thread(void *arg)
+{
+    DltDaemonStorage *storage = (DltDaemonStorage *)arg;
+    DltDaemonStorageMsg *msg;
+    struct pollfd pfd;
+    sigset_t set;
+    eventfd_t value;
+    uint32_t last_flush = dlt_uptime();
+    uint32_t elapsed;
+    int written;
+    int batch;
+    int pending;
+    int stop;
+    int i;
+
+    /* signals are handled by the main loop */
+    sigfillset(&set);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+    pfd.fd = storage->wakeup_fd;
+    pfd.events = POLLIN;
+
+    while (1)
+    {
+        stop = __atomic_load_n(&storage->stop, __ATOMIC_ACQUIRE);
+        written = 0;
+
+        /* the lock is released between batches for the main loop */
+        pthread_mutex_lock(&storage->lock);
+
+        for (i = 0; i < storage->num_queues; i++)
+        {
+            /* a busy target does not hold back the others */
+            for (batch = 0; batch < DLT_DAEMON_STORAGE_BATCH; batch++)
+            {
+                msg = dlt_daemon_storage_queue_pop(&storage->queues[i]);
+
+                if (msg == NULL)
+                {
+                    break;
+                }
+
+                dlt_daemon_storage_write_msg(storage, i, msg);
+                dlt_daemon_storage_release(msg);
+            }
+
+            written += batch;
+        }
+
+        /* uptime is in 0.1 ms */
+        elapsed = (dlt_uptime() - last_flush) / 10;
+
+        if (elapsed >= DLT_DAEMON_STORAGE_FLUSH_MSEC)
+        {
+            dlt_daemon_storage_flush_due(storage);
+            last_flush = dlt_uptime();
+            elapsed = 0;
+        }
+
+        pending = dlt_logstorage_flush_caches(DLT_OFFLINE_LOGSTORAGE_FLUSH_CHUNK);
+
+        pthread_mutex_unlock(&storage->lock);
+
+        if ((written > 0) || (pending && !stop))
+        {
+            continue;
+        }
+
+        if (stop)
+        {
+            break;
+        }
+
+        /* wait for the next message or due flush */
+        __atomic_store_n(&storage->sleeping, 1, __ATOMIC_SEQ_CST);
+
+        if (!dlt_daemon_storage_pending(storage) &&
+            !__atomic_load_n(&storage->stop, __ATOMIC_SEQ_CST))
+        {
+            if (poll(&pfd, 1, DLT_DAEMON_STORAGE_FLUSH_MSEC - elapsed) > 0)
+            {
+                eventfd_read(storage->wakeup_fd, &value);
+            }
+        }
+
+        __atomic_store_n(&storage->sleeping, 0, __ATOMIC_SEQ_CST);
+    }
+
+    return NULL;
+}
+
+static void dlt_daemon_storage_wakeup(DltDaemonStorage *storage)
+{
+    if (__atomic_exchange_n(&storage->sleeping, 0, __ATOMIC_SEQ_CST))
+    {
+        eventfd_write(storage->wakeup_fd, 1);
+    }
+}
+
+int dlt_daemon_storage_init(DltDaemonStorage *storage,
+                            DltDaemon *daemon,
+                            DltOfflineTrace *trace,
+                            DltLogStorageUserConfig *file_config,
+                            int num_devices,
+                            int queue_size,
+                            int verbose)
+{
+    uint32_t size = 1;
+    int i;
+
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if ((storage == NULL) || (daemon == NULL) || (file_config == NULL))
+    {
+        return -1;
+    }
+
+    memset(storage, 0, sizeof(DltDaemonStorage));
+    storage->wakeup_fd = -1;
+
+    if ((queue_size <= 0) || ((trace == NULL) && (num_devices <= 0)))
+    {
+        return 0;
+    }
+
+    while (size < (uint32_t)queue_size)
+    {
+        size <<= 1;
+    }
+
+    storage->daemon = daemon;
+    storage->trace = trace;
+    storage->file_config = *file_config;
+    storage->num_queues = 1 + ((num_devices > 0) ? num_devices : 0);
+    storage->queues = calloc(storage->num_queues, sizeof(DltDaemonStorageQueue));
+    storage->wakeup_fd = eventfd(0, EFD_NONBLOCK);
+
+    if ((storage->queues == NULL) || (storage->wakeup_fd < 0))
+    {
+        dlt_log(LOG_ERR, "Storage thread: initialization failed\n");
+        dlt_daemon_storage_free(storage, verbose);
+        return -1;
+    }
+
+    for (i = 0; i < storage->num_queues; i++)
+    {
+        storage->queues[i].size = size;
+        storage->queues[i].msgs = calloc(size, sizeof(DltDaemonStorageMsg *));
+
+        if (storage->queues[i].msgs == NULL)
+        {
+            dlt_log(LOG_ERR, "Storage thread: cannot allocate queue\n");
+            dlt_daemon_storage_free(storage, verbose);
+            return -1;
+        }
+    }
+
+    pthread_mutex_init(&storage->lock, NULL);
+
+    if (pthread_create(&storage->thread, NULL, dlt_daemon_storage_thread, storage) != 0)
+    {
+        dlt_log(LOG_ERR, "Storage thread: cannot create thread\n");
+        pthread_mutex_destroy(&storage->lock);
+        dlt_daemon_storage_free(storage, verbose);
+        return -1;
+    }
+
+    storage->running = 1;
+    dlt_vlog(LOG_INFO, "Storage thread started, %u messages per queue\n", size);
+
+    return 0;
+}
+
+void dlt_daemon_storage_free(DltDaemonStorage *storage, int verbose)
+{
+    DltDaemonStorageMsg *msg;
+    int i;
+
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if (storage == NULL)
+    {
+        return;
+    }
+
+    if (storage->running)
+    {
+        /* the thread writes what is queued before it terminates */
+        __atomic_store_n(&storage->stop, 1, __ATOMIC_SEQ_CST);
+        eventfd_write(storage->wakeup_fd, 1);
+        pthread_join(storage->thread, NULL);
+        pthread_mutex_destroy(&storage->lock);
+        storage->running = 0;
+    }
+
+    if (storage->wakeup_fd >= 0)
+    {
+        close(storage->wakeup_fd);
+        storage->wakeup_fd = -1;
+    }
+
+    for (i = 0; (storage->queues != NULL) && (i < storage->num_queues); i++)
+    {
+        if (storage->queues[i].msgs != NULL)
+        {
+            while ((msg = dlt_daemon_storage_queue_pop(&storage->queues[i])) != NULL)
+            {
+                dlt_daemon_storage_release(msg);
+            }
+
+            free(storage->queues[i].msgs);
+        }
+
+        dlt_daemon_storage_report_dropped(&storage->queues[i], i);
+    }
+
+    free(storage->queues);
+    storage->queues = NULL;
+    storage->num_queues = 0;
+}
+
+int dlt_daemon_storage_write(DltDaemonStorage *storage,
+                             int trace,
+                             int logstorage,
+                             unsigned char *data1,
+                             int size1,
+                             unsigned char *data2,
+                             int size2,
+                             unsigned char *data3,
+                             int size3)
+{
+    DltDaemonStorageMsg *msg = NULL;
+    char name[32];
+    int refcount = 0;
+    int i;
+
+    if ((storage == NULL) || !storage->running || (data1 == NULL))
+    {
+        return -1;
+    }
+
+    /* logstorage only stores complete log messages, see dlt_daemon_logstorage_write */
+    logstorage = logstorage && (data2 != NULL) && (data3 != NULL);
+    size2 = (data2 != NULL) ? size2 : 0;
+    size3 = (data3 != NULL) ? size3 : 0;
+
+    unsigned char targets[storage->num_queues];
+
+    for (i = 0; i < storage->num_queues; i++)
+    {
+        if (i == DLT_DAEMON_STORAGE_OFFLINE_TRACE)
+        {
+            targets[i] = (trace && (storage->trace != NULL));
+        }
+        else
+        {
+            /* the storage thread checks the device state again */
+            targets[i] = logstorage &&
+                (__atomic_load_n(&storage->daemon->storage_handle[i - 1].config_status,
+                                 __ATOMIC_RELAXED) == DLT_OFFLINE_LOGSTORAGE_CONFIG_DONE);
+        }
+
+        if (!targets[i])
+        {
+            continue;
+        }
+
+        /* a full queue drops the message for this target only */
+        if (dlt_daemon_storage_queue_full(&storage->queues[i]))
+        {
+            if (storage->queues[i].dropped == storage->queues[i].reported)
+            {
+                dlt_daemon_storage_queue_name(i, name, sizeof(name));
+                dlt_vlog(LOG_WARNING, "Storage queue of %s full, dropping messages\n", name);
+            }
+
+            storage->queues[i].dropped++;
+            targets[i] = 0;
+            continue;
+        }
+
+        dlt_daemon_storage_report_dropped(&storage->queues[i], i);
+        refcount++;
+    }
+
+    if (refcount == 0)
+    {
+        return 0;
+    }
+
+    msg = malloc(sizeof(DltDaemonStorageMsg) + size1 + size2 + size3);
+
+    if (msg == NULL)
+    {
+        dlt_log(LOG_ERR, "Storage thread: cannot allocate message\n");
+        return -1;
+    }
+
+    msg->refcount = refcount;
+    msg->size1 = size1;
+    msg->size2 = size2;
+    msg->size3 = size3;
+    memcpy(msg->data, data1, size1);
+
+    if (size2 > 0)
+    {
+        memcpy(msg->data + size1, data2, size2);
+    }
+
+    if (size3 > 0)
+    {
+        memcpy(msg->data + size1 + size2, data3, size3);
+    }
+
+    /* queues only get more space meanwhile */
+    for (i = 0; i < storage->num_queues; i++)
+    {
+        if (targets[i])
+        {
+            dlt_daemon_storage_queue_push(&storage->queues[i], msg);
+        }
+    }
+
+    dlt_daemon_storage_wakeup(storage);
+
+    return 0;
+}
+
+void dlt_daemon_storage_lock(DltDaemonStorage *storage)
+{
+    if ((storage != NULL) && storage->running)
+    {
+        pthread_mutex_lock(&storage->lock);
+    }
+}
+
+void dlt_daemon_storage_unlock(DltDaemonStorage *storage)
+{
+    if ((storage != NULL) && storage->running)
+    {
+        pthread_mutex_unlock(&storage->lock);
+    }
+}
@@ -0,0 +1,142 @@
+/*
+ * @licence app begin@
+ * SPDX license identifier: MPL-2.0
+ *
+ * This file is part of GENIVI Project DLT - Diagnostic Log and Trace.
+ *
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License (MPL), v. 2.0.
+ * If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * For further information see http://www.genivi.org/.
+ * @licence end@
+ */
+
+/*!
+ * \file dlt_daemon_storage.h
+ *
+ * The storage thread writes messages to the offline trace and the offline
+ * logstorage devices, so a slow storage medium does not stall the main loop.
+ * Every storage target has a bounded single producer/single consumer queue
+ * of messages. A message is allocated once and referenced from the queues of
+ * all targets it is written to. If the queue of a target is full, the message
+ * is dropped for this target and counted.
+ */
+
+#ifndef DLT_DAEMON_STORAGE_H
+#define DLT_DAEMON_STORAGE_H
+
+#include <pthread.h>
+
+#include "dlt_common.h"
+#include "dlt_daemon_common.h"
+#include "dlt_offline_trace.h"
+
+/* queue of the offline trace, logstorage device n uses queue n + 1 */
+#define DLT_DAEMON_STORAGE_OFFLINE_TRACE 0
+
+/**
+ * Message written by the storage thread.
+ */
+typedef struct
+{
+    int refcount;           /**< queues referencing the message, decremented by the storage thread */
+    int size1;              /**< size of storage header */
+    int size2;              /**< size of message header */
+    int size3;              /**< size of payload */
+    unsigned char data[];   /**< storage header, message header and payload */
+} DltDaemonStorageMsg;
+
+/**
+ * Queue from the main loop to the storage thread.
+ * head and tail are free running counters.
+ */
+typedef struct
+{
+    DltDaemonStorageMsg **msgs;     /**< message storage */
+    uint32_t size;                  /**< number of entries, power of two */
+    uint32_t head;                  /**< written by the main loop only */
+    uint32_t tail;                  /**< written by the storage thread only */
+    unsigned long long dropped;     /**< messages dropped because the queue was full */
+    unsigned long long reported;    /**< dropped messages already reported */
+} DltDaemonStorageQueue;
+
+typedef struct
+{
+    pthread_t thread;           /**< storage thread */
+    int running;                /**< thread was started */
+    int stop;                   /**< request to terminate the thread */
+    int sleeping;               /**< thread waits for messages */
+    int wakeup_fd;              /**< eventfd, wakes the storage thread */
+    pthread_mutex_t lock;       /**< protects offline trace and logstorage devices */
+    DltDaemon *daemon;          /**< owner of the logstorage devices */
+    DltOfflineTrace *trace;     /**< offline trace, NULL if not used */
+    DltLogStorageUserConfig file_config; /**< logstorage file name settings */
+    int num_queues;             /**< offline trace and logstorage devices */
+    DltDaemonStorageQueue *queues;
+} DltDaemonStorage;
+
+/**
+ * Create the queues and start the storage thread.
+ * @param storage structure to be initialized
+ * @param daemon daemon owning the logstorage devices
+ * @param trace offline trace or NULL
+ * @param file_config logstorage file name settings
+ * @param num_devices number of logstorage devices
+ * @param queue_size number of messages queued per target, 0 disables the thread
+ * @param verbose if set to true verbose information is printed out.
+ * @return 0 on success, -1 otherwise
+ */
+int dlt_daemon_storage_init(DltDaemonStorage *storage,
+                            DltDaemon *daemon,
+                            DltOfflineTrace *trace,
+                            DltLogStorageUserConfig *file_config,
+                            int num_devices,
+                            int queue_size,
+                            int verbose);
+
+/**
+ * Write all queued messages, stop the storage thread and free the queues.
+ * @param storage structure to be freed
+ * @param verbose if set to true verbose information is printed out.
+ */
+void dlt_daemon_storage_free(DltDaemonStorage *storage, int verbose);
+
+/**
+ * Hand over a message to the storage thread.
+ * @param storage storage structure
+ * @param trace write the message to the offline trace
+ * @param logstorage write the message to the logstorage devices
+ * @param data1 storage header
+ * @param size1 size of storage header
+ * @param data2 message header
+ * @param size2 size of message header
+ * @param data3 payload
+ * @param size3 size of payload
+ * @return 0 on success, -1 if the message could not be allocated
+ */
+int dlt_daemon_storage_write(DltDaemonStorage *storage,
+                             int trace,
+                             int logstorage,
+                             unsigned char *data1,
+                             int size1,
+                             unsigned char *data2,
+                             int size2,
+                             unsigned char *data3,
+                             int size3);
+
+/**
+ * Get exclusive access to offline trace and logstorage devices.
+ * Does nothing if the storage thread is not running.
+ * @param storage storage structure
+ */
+void dlt_daemon_storage_lock(DltDaemonStorage *storage);
+
+/**
+ * Release access taken with dlt_daemon_storage_lock.
+ * @param storage storage structure
+ */
+void dlt_daemon_storage_unlock(DltDaemonStorage *storage);
+
+#endif /* DLT_DAEMON_STORAGE_H */
@@ -78,6 +78,8 @@
 #include <netdb.h>
 #include <sys/stat.h>
 #include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #endif
 
 #if defined(_MSC_VER)
@@ -93,19 +95,60 @@
 #include <string.h> /* for strlen(), memcmp(), memmove() */
 #include <errno.h>
 #include <limits.h>
+#include <time.h>
 
 #include "dlt_types.h"
 #include "dlt_client.h"
 #include "dlt_client_cfg.h"
 
+/**
+ * Private part of DltClient.
+ */
+struct sDltClientPrivate
+{
+    int32_t receiver_buffersize;             /* size of receive buffer */
+    struct DltClientConnection *connection;  /* set if managed by a client loop */
+};
+
 static int (*message_callback_function) (DltMessage *message, void *data) = NULL;
+static int (*chunk_callback_function) (void *data) = NULL;
 
 static char str[DLT_CLIENT_TEXTBUFSIZE];
 
+static DltReturnValue dlt_client_loop_queue(DltClientConnection *con, uint8_t *header, uint32_t headersize, uint8_t *data, uint32_t datasize);
+
+/* allocate the private data if the client has none yet */
+static DltReturnValue dlt_client_prepare(DltClient *client)
+{
+    if (client->priv == NULL)
+    {
+        client->priv = (struct sDltClientPrivate *) calloc(1, sizeof(struct sDltClientPrivate));
+
+        if (client->priv == NULL)
+        {
+            dlt_log(LOG_ERR, "Cannot allocate memory for client\n");
+            return DLT_RETURN_ERROR;
+        }
+
+        client->priv->receiver_buffersize = DLT_CLIENT_RCVBUFSIZE;
+    }
+
+    return DLT_RETURN_OK;
+}
+
+static int32_t dlt_client_receiver_buffersize(DltClient *client)
+{
+    return (client->priv != NULL) ? client->priv->receiver_buffersize : DLT_CLIENT_RCVBUFSIZE;
+}
+
 void dlt_client_register_message_callback(int (*registerd_callback) (DltMessage *message, void *data)){
     message_callback_function = registerd_callback;
 }
 
+void dlt_client_register_chunk_callback(int (*registerd_callback) (void *data)){
+    chunk_callback_function = registerd_callback;
+}
+
 DltReturnValue dlt_client_init_port(DltClient *client, int port, int verbose)
 {
     if (verbose && port != DLT_DAEMON_TCP_PORT)
@@ -126,8 +169,9 @@ DltReturnValue dlt_client_init_port(DltClient *client, int port, int verbose)
     client->socketPath = 0;
     client->mode=DLT_CLIENT_MODE_TCP;
     client->receiver.buffer=0;
+    client->priv=NULL;
 
-    return DLT_RETURN_OK;
+    return dlt_client_prepare(client);
 }
 
 DltReturnValue dlt_client_init(DltClient *client, int verbose)
@@ -165,6 +209,23 @@ DltReturnValue dlt_client_init(DltClient *client, int verbose)
     return dlt_client_init_port(client, servPort, verbose);
 }
 
+DltReturnValue dlt_client_set_receive_buffer_size(DltClient *client, int32_t size)
+{
+    if ((client == NULL) || (size < DLT_CLIENT_RCVBUFSIZE))
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    if (dlt_client_prepare(client) < DLT_RETURN_OK)
+    {
+        return DLT_RETURN_ERROR;
+    }
+
+    client->priv->receiver_buffersize = size;
+
+    return DLT_RETURN_OK;
+}
+
 DltReturnValue dlt_client_connect(DltClient *client, int verbose)
 {
     char portnumbuffer[33];
@@ -289,7 +350,7 @@ DltReturnValue dlt_client_connect(DltClient *client, int verbose)
         return DLT_RETURN_ERROR;
     }
 
-    if (dlt_receiver_init(&(client->receiver),client->sock,DLT_CLIENT_RCVBUFSIZE) != DLT_RETURN_OK)
+    if (dlt_receiver_init(&(client->receiver),client->sock,dlt_client_receiver_buffersize(client)) != DLT_RETURN_OK)
     {
         fprintf(stderr, "ERROR initializing receiver\n");
         return DLT_RETURN_ERROR;
@@ -315,6 +376,9 @@ DltReturnValue dlt_client_cleanup(DltClient *client, int verbose)
         close(client->sock);
     }
 
+    free(client->priv);
+    client->priv = NULL;
+
     if (dlt_receiver_free(&(client->receiver)) == DLT_RETURN_ERROR)
     {
         return DLT_RETURN_ERROR;
@@ -327,6 +391,7 @@ DltReturnValue dlt_client_main_loop(DltClient *client, void *data, int verbose)
 {
     DltMessage msg;
     int ret;
+    int size;
 
     if (client==0)
     {
@@ -354,15 +419,11 @@ DltReturnValue dlt_client_main_loop(DltClient *client, void *data, int verbose)
         if (ret<=0)
         {
             /* No more data to be received */
-            if (dlt_message_free(&msg,verbose) == DLT_RETURN_ERROR)
-            {
-                return DLT_RETURN_ERROR;
-            }
-
             return DLT_RETURN_TRUE;
         }
 
-        while (dlt_message_read(&msg,(unsigned char*)(client->receiver.buf),client->receiver.bytesRcvd,0,verbose) == DLT_MESSAGE_ERROR_OK)
+        /* hand out views of all complete messages, the payload is not copied */
+        while (dlt_message_read_view(&msg,(unsigned char*)(client->receiver.buf),client->receiver.bytesRcvd,0,verbose) == DLT_MESSAGE_ERROR_OK)
         {
             /* Call callback function */
             if (message_callback_function)
@@ -370,39 +431,33 @@ DltReturnValue dlt_client_main_loop(DltClient *client, void *data, int verbose)
                 (*message_callback_function)(&msg,data);
             }
 
+            size = msg.headersize+msg.datasize-sizeof(DltStorageHeader);
+
             if (msg.found_serialheader)
             {
-                if (dlt_receiver_remove(&(client->receiver),msg.headersize+msg.datasize-sizeof(DltStorageHeader)+sizeof(dltSerialHeader)) == DLT_RETURN_ERROR)
-                {
-                    /* Return value ignored */
-                    dlt_message_free(&msg,verbose);
-                    return DLT_RETURN_ERROR;
-                }
+                size += sizeof(dltSerialHeader);
             }
-            else
+
+            if (dlt_receiver_remove(&(client->receiver),size) == DLT_RETURN_ERROR)
             {
-                if (dlt_receiver_remove(&(client->receiver),msg.headersize+msg.datasize-sizeof(DltStorageHeader)) == DLT_RETURN_ERROR)
-                {
-                    /* Return value ignored */
-                    dlt_message_free(&msg,verbose);
-                    return DLT_RETURN_ERROR;
-                }
+                return DLT_RETURN_ERROR;
             }
         }
 
+        /* views of this chunk are released afterwards */
+        if (chunk_callback_function)
+        {
+            (*chunk_callback_function)(data);
+        }
+
+        msg.databuffer = NULL;
+
         if (dlt_receiver_move_to_begin(&(client->receiver)) == DLT_RETURN_ERROR)
         {
-            /* Return value ignored */
-            dlt_message_free(&msg,verbose);
             return DLT_RETURN_ERROR;
         }
     }
 
-    if (dlt_message_free(&msg,verbose) == DLT_RETURN_ERROR)
-    {
-        return DLT_RETURN_ERROR;
-    }
-
     return DLT_RETURN_OK;
 }
 
@@ -506,7 +561,14 @@ DltReturnValue dlt_client_send_ctrl_msg(DltClient *client, char *apid, char *cti
     msg.standardheader->len = DLT_HTOBE_16(len);
 
     /* Send data (without storage header) */
-    if ((client->mode == DLT_CLIENT_MODE_TCP) || (client->mode == DLT_CLIENT_MODE_SERIAL))
+    if ((client->priv != NULL) && (client->priv->connection != NULL))
+    {
+        /* via send buffer of client loop */
+        ret = dlt_client_loop_queue(client->priv->connection, msg.headerbuffer+sizeof(DltStorageHeader),msg.headersize-sizeof(DltStorageHeader),msg.databuffer,msg.datasize);
+        dlt_message_free(&msg,0);
+        return ret;
+    }
+    else if ((client->mode == DLT_CLIENT_MODE_TCP) || (client->mode == DLT_CLIENT_MODE_SERIAL))
     {
         /* via FileDescriptor */
         ret=write(client->sock, msg.headerbuffer+sizeof(DltStorageHeader),msg.headersize-sizeof(DltStorageHeader));
@@ -802,6 +864,43 @@ DltReturnValue dlt_client_send_all_trace_status(DltClient *client, uint8_t trace
     return DLT_RETURN_OK;
 }
 
+DltReturnValue dlt_client_send_filter(DltClient *client, const char *filter)
+{
+    DltServiceSetClientFilter *req;
+    uint8_t *payload;
+    uint32_t length;
+
+    if (filter == NULL)
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    length = strlen(filter);
+    payload = (uint8_t *) malloc(sizeof(DltServiceSetClientFilter) + length);
+
+    if (payload == 0)
+    {
+        return DLT_RETURN_ERROR;
+    }
+
+    req = (DltServiceSetClientFilter *) payload;
+
+    req->service_id = DLT_SERVICE_ID_SET_CLIENT_FILTER;
+    req->length = length;
+    memcpy(payload + sizeof(DltServiceSetClientFilter), filter, length);
+
+    /* free message */
+    if (dlt_client_send_ctrl_msg(client, "APP", "CON", payload, sizeof(DltServiceSetClientFilter) + length) == DLT_RETURN_ERROR)
+    {
+        free(payload);
+        return DLT_RETURN_ERROR;
+    }
+
+    free(payload);
+
+    return DLT_RETURN_OK;
+}
+
 DltReturnValue dlt_client_send_timing_pakets(DltClient *client, uint8_t timingPakets)
 {
     DltServiceSetVerboseMode *req;
@@ -905,3 +1004,725 @@ int dlt_client_set_socket_path(DltClient *client, char *socket_path)
     }
     return DLT_RETURN_OK;
 }
+
+static int64_t dlt_client_loop_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void dlt_client_loop_set_state(DltClientConnection *con, DltClientLoopState state)
+{
+    con->state = state;
+
+    if (con->state_callback)
+    {
+        con->state_callback(con, con->data);
+    }
+}
+
+static int dlt_client_loop_update_events(DltClientConnection *con)
+{
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = con;
+
+    if ((con->state == DLT_CLIENT_LOOP_CONNECTING) || (con->send_used > 0))
+    {
+        ev.events |= EPOLLOUT;
+    }
+
+    return epoll_ctl(con->loop->epfd, EPOLL_CTL_MOD, con->client.sock, &ev);
+}
+
+/* send as much of the send buffer as possible, called with the mutex locked */
+static int dlt_client_loop_flush(DltClientConnection *con)
+{
+    ssize_t ret;
+
+    while (con->send_used > 0)
+    {
+        if (con->client.mode == DLT_CLIENT_MODE_SERIAL)
+        {
+            ret = write(con->client.sock, con->sendbuf, con->send_used);
+        }
+        else
+        {
+            ret = send(con->client.sock, con->sendbuf, con->send_used, MSG_NOSIGNAL);
+        }
+
+        if (ret < 0)
+        {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            {
+                break;
+            }
+
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            return -1;
+        }
+
+        memmove(con->sendbuf, con->sendbuf + ret, con->send_used - ret);
+        con->send_used -= ret;
+    }
+
+    return 0;
+}
+
+static DltReturnValue dlt_client_loop_queue(DltClientConnection *con, uint8_t *header, uint32_t headersize, uint8_t *data, uint32_t datasize)
+{
+    DltClientLoop *loop = con->loop;
+    DltReturnValue ret = DLT_RETURN_OK;
+    uint8_t *sendbuf;
+    uint32_t size;
+
+    if (loop == NULL)
+    {
+        return DLT_RETURN_ERROR;
+    }
+
+    pthread_mutex_lock(&loop->mutex);
+
+    if ((con->state != DLT_CLIENT_LOOP_CONNECTED) ||
+        (con->send_used + headersize + datasize > DLT_CLIENT_LOOP_SENDBUFSIZE))
+    {
+        pthread_mutex_unlock(&loop->mutex);
+        return DLT_RETURN_ERROR;
+    }
+
+    if (con->send_used + headersize + datasize > con->send_size)
+    {
+        size = con->send_size ? con->send_size : DLT_CLIENT_TEXTBUFSIZE;
+
+        while (size < con->send_used + headersize + datasize)
+        {
+            size *= 2;
+        }
+
+        sendbuf = (uint8_t *) realloc(con->sendbuf, size);
+
+        if (sendbuf == NULL)
+        {
+            pthread_mutex_unlock(&loop->mutex);
+            return DLT_RETURN_ERROR;
+        }
+
+        con->sendbuf = sendbuf;
+        con->send_size = size;
+    }
+
+    memcpy(con->sendbuf + con->send_used, header, headersize);
+    memcpy(con->sendbuf + con->send_used + headersize, data, datasize);
+    con->send_used += headersize + datasize;
+
+    /* the loop thread is woken by EPOLLOUT for the part not sent immediately */
+    if ((dlt_client_loop_flush(con) < 0) ||
+        ((con->send_used > 0) && (dlt_client_loop_update_events(con) < 0)))
+    {
+        ret = DLT_RETURN_ERROR;
+    }
+
+    pthread_mutex_unlock(&loop->mutex);
+
+    return ret;
+}
+
+static void dlt_client_loop_close(DltClientConnection *con)
+{
+    pthread_mutex_lock(&con->loop->mutex);
+
+    if (con->client.sock != -1)
+    {
+        epoll_ctl(con->loop->epfd, EPOLL_CTL_DEL, con->client.sock, NULL);
+        close(con->client.sock);
+        con->client.sock = -1;
+    }
+
+    con->send_used = 0;
+    con->client.receiver.bytesRcvd = 0;
+    con->client.receiver.buf = con->client.receiver.buffer;
+
+    pthread_mutex_unlock(&con->loop->mutex);
+}
+
+static void dlt_client_loop_disconnect(DltClientConnection *con, int verbose)
+{
+    DltClientLoop *loop = con->loop;
+    DltClientLoopState state = con->state;
+
+    dlt_client_loop_close(con);
+
+    con->retry = dlt_client_loop_now() + con->backoff;
+    con->backoff = (con->backoff * 2 > loop->backoff_max) ? loop->backoff_max : con->backoff * 2;
+
+    if (verbose)
+    {
+        dlt_vlog(LOG_INFO, "Client connection %s lost, retry in %u ms\n",
+                 con->client.servIP ? con->client.servIP :
+                 con->client.serialDevice ? con->client.serialDevice : con->client.socketPath,
+                 (unsigned int) (con->retry - dlt_client_loop_now()));
+    }
+
+    if (state != DLT_CLIENT_LOOP_DISCONNECTED)
+    {
+        dlt_client_loop_set_state(con, DLT_CLIENT_LOOP_DISCONNECTED);
+    }
+}
+
+static void dlt_client_loop_established(DltClientConnection *con)
+{
+    pthread_mutex_lock(&con->loop->mutex);
+    con->state = DLT_CLIENT_LOOP_CONNECTED;
+    dlt_client_loop_update_events(con);
+    pthread_mutex_unlock(&con->loop->mutex);
+
+    con->backoff = con->loop->backoff_min;
+    dlt_client_loop_set_state(con, DLT_CLIENT_LOOP_CONNECTED);
+}
+
+/* start a connection attempt without blocking, the address lookup may block */
+static int dlt_client_loop_connect(DltClientConnection *con, int verbose)
+{
+    DltClient *client = &con->client;
+    char portnumbuffer[33];
+    struct addrinfo hints, *servinfo, *p;
+    struct sockaddr_un addr;
+    struct epoll_event ev;
+    int sock = -1;
+    int ret = -1;
+
+    switch (client->mode)
+    {
+    case DLT_CLIENT_MODE_TCP:
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_socktype = SOCK_STREAM;
+        snprintf(portnumbuffer, 32, "%d", client->port);
+
+        if (getaddrinfo(client->servIP, portnumbuffer, &hints, &servinfo) != 0)
+        {
+            break;
+        }
+
+        for (p = servinfo; p != NULL; p = p->ai_next)
+        {
+            sock = socket(p->ai_family, p->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, p->ai_protocol);
+
+            if (sock < 0)
+            {
+                continue;
+            }
+
+            ret = connect(sock, p->ai_addr, p->ai_addrlen);
+
+            if ((ret == 0) || (errno == EINPROGRESS))
+            {
+                break;
+            }
+
+            close(sock);
+            sock = -1;
+        }
+
+        freeaddrinfo(servinfo);
+        break;
+    case DLT_CLIENT_MODE_SERIAL:
+        sock = open(client->serialDevice, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+
+        if ((sock >= 0) && (!isatty(sock) || (dlt_setup_serial(sock, client->baudrate) < DLT_RETURN_OK)))
+        {
+            close(sock);
+            sock = -1;
+        }
+
+        ret = 0;
+        break;
+    case DLT_CLIENT_MODE_UNIX:
+        sock = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+        if (sock < 0)
+        {
+            break;
+        }
+
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, client->socketPath, sizeof(addr.sun_path) - 1);
+
+        ret = connect(sock, (struct sockaddr *) &addr, sizeof(addr));
+
+        if ((ret != 0) && (errno != EINPROGRESS))
+        {
+            close(sock);
+            sock = -1;
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (sock < 0)
+    {
+        if (verbose)
+        {
+            dlt_vlog(LOG_INFO, "Client connection attempt failed: %s\n", strerror(errno));
+        }
+
+        dlt_client_loop_disconnect(con, verbose);
+        return -1;
+    }
+
+    if ((client->receiver.buffer == NULL) &&
+        (dlt_receiver_init(&client->receiver, sock,
+                           (dlt_client_receiver_buffersize(client) < DLT_CLIENT_LOOP_RCVBUFSIZE) ?
+                           DLT_CLIENT_LOOP_RCVBUFSIZE : dlt_client_receiver_buffersize(client)) != DLT_RETURN_OK))
+    {
+        close(sock);
+        dlt_client_loop_disconnect(con, verbose);
+        return -1;
+    }
+
+    client->receiver.fd = sock;
+    client->receiver.bytesRcvd = 0;
+    client->receiver.buf = client->receiver.buffer;
+
+    pthread_mutex_lock(&con->loop->mutex);
+    client->sock = sock;
+    con->state = (ret == 0) ? DLT_CLIENT_LOOP_CONNECTED : DLT_CLIENT_LOOP_CONNECTING;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = (ret == 0) ? EPOLLIN : (EPOLLIN | EPOLLOUT);
+    ev.data.ptr = con;
+    ret = epoll_ctl(con->loop->epfd, EPOLL_CTL_ADD, sock, &ev);
+    pthread_mutex_unlock(&con->loop->mutex);
+
+    if (ret < 0)
+    {
+        dlt_client_loop_disconnect(con, verbose);
+        return -1;
+    }
+
+    if (con->state == DLT_CLIENT_LOOP_CONNECTED)
+    {
+        con->backoff = con->loop->backoff_min;
+        dlt_client_loop_set_state(con, DLT_CLIENT_LOOP_CONNECTED);
+    }
+    else
+    {
+        dlt_client_loop_set_state(con, DLT_CLIENT_LOOP_CONNECTING);
+    }
+
+    return 0;
+}
+
+/* receive available data and hand out views of the complete messages */
+static int dlt_client_loop_receive(DltClientConnection *con, int verbose)
+{
+    DltReceiver *receiver = &con->client.receiver;
+    DltMessage msg;
+    ssize_t ret;
+    int size;
+
+    if (receiver->bytesRcvd >= receiver->buffersize)
+    {
+        /* buffer holds no complete message, stream is corrupted */
+        return -1;
+    }
+
+    ret = read(receiver->fd, receiver->buffer + receiver->bytesRcvd, receiver->buffersize - receiver->bytesRcvd);
+
+    if (ret < 0)
+    {
+        return ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) ? 0 : -1;
+    }
+
+    if (ret == 0)
+    {
+        return -1;
+    }
+
+    receiver->lastBytesRcvd = ret;
+    receiver->totalBytesRcvd += ret;
+    receiver->bytesRcvd += ret;
+    receiver->buf = receiver->buffer;
+
+    dlt_message_init(&msg, 0);
+
+    while (dlt_message_read_view(&msg, (uint8_t *) receiver->buf, receiver->bytesRcvd, 0, verbose) == DLT_MESSAGE_ERROR_OK)
+    {
+        if (con->message_callback)
+        {
+            con->message_callback(con, &msg, con->data);
+        }
+
+        /* connection was closed by the callback */
+        if (con->client.sock == -1)
+        {
+            return 0;
+        }
+
+        size = msg.headersize + msg.datasize - sizeof(DltStorageHeader);
+
+        if (msg.found_serialheader)
+        {
+            size += sizeof(dltSerialHeader);
+        }
+
+        if (dlt_receiver_remove(receiver, size) != DLT_RETURN_OK)
+        {
+            return -1;
+        }
+    }
+
+    return (dlt_receiver_move_to_begin(receiver) == DLT_RETURN_OK) ? 0 : -1;
+}
+
+static void dlt_client_loop_handle(DltClientConnection *con, uint32_t events, int verbose)
+{
+    int error = 0;
+    socklen_t len = sizeof(error);
+
+    if (con->state == DLT_CLIENT_LOOP_CONNECTING)
+    {
+        if ((getsockopt(con->client.sock, SOL_SOCKET, SO_ERROR, &error, &len) < 0) || (error != 0))
+        {
+            dlt_client_loop_disconnect(con, verbose);
+            return;
+        }
+
+        if (!(events & (EPOLLOUT | EPOLLIN)))
+        {
+            return;
+        }
+
+        dlt_client_loop_established(con);
+
+        if (con->client.sock == -1)
+        {
+            return;
+        }
+    }
+
+    if (events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+    {
+        if (dlt_client_loop_receive(con, verbose) < 0)
+        {
+            dlt_client_loop_disconnect(con, verbose);
+            return;
+        }
+    }
+
+    if ((events & EPOLLOUT) && (con->client.sock != -1))
+    {
+        pthread_mutex_lock(&con->loop->mutex);
+        error = dlt_client_loop_flush(con);
+
+        if ((error == 0) && (con->state == DLT_CLIENT_LOOP_CONNECTED))
+        {
+            dlt_client_loop_update_events(con);
+        }
+
+        pthread_mutex_unlock(&con->loop->mutex);
+
+        if (error < 0)
+        {
+            dlt_client_loop_disconnect(con, verbose);
+        }
+    }
+}
+
+DltReturnValue dlt_client_loop_init(DltClientLoop *loop, int verbose)
+{
+    struct epoll_event ev;
+
+    if (loop == NULL)
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    if (verbose)
+    {
+        printf("Init dlt client loop\n");
+    }
+
+    memset(loop, 0, sizeof(DltClientLoop));
+    loop->backoff_min = DLT_CLIENT_LOOP_BACKOFF_MIN;
+    loop->backoff_max = DLT_CLIENT_LOOP_BACKOFF_MAX;
+
+    loop->epfd = epoll_create1(EPOLL_CLOEXEC);
+
+    if (loop->epfd < 0)
+    {
+        dlt_vlog(LOG_ERR, "Creation of epoll instance failed: %s\n", strerror(errno));
+        return DLT_RETURN_ERROR;
+    }
+
+    loop->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+
+    if ((loop->wake_fd < 0) || (epoll_ctl(loop->epfd, EPOLL_CTL_ADD, loop->wake_fd, &ev) < 0))
+    {
+        dlt_vlog(LOG_ERR, "Creation of client loop wake up event failed: %s\n", strerror(errno));
+
+        if (loop->wake_fd >= 0)
+        {
+            close(loop->wake_fd);
+        }
+
+        close(loop->epfd);
+        return DLT_RETURN_ERROR;
+    }
+
+    pthread_mutex_init(&loop->mutex, NULL);
+
+    return DLT_RETURN_OK;
+}
+
+DltReturnValue dlt_client_loop_free(DltClientLoop *loop, int verbose)
+{
+    if (loop == NULL)
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    if (verbose)
+    {
+        printf("Cleanup dlt client loop\n");
+    }
+
+    while (loop->num_connections > 0)
+    {
+        dlt_client_loop_remove(loop, loop->connections[loop->num_connections - 1], verbose);
+    }
+
+    free(loop->connections);
+    loop->connections = NULL;
+
+    close(loop->wake_fd);
+    close(loop->epfd);
+    pthread_mutex_destroy(&loop->mutex);
+
+    return DLT_RETURN_OK;
+}
+
+DltReturnValue dlt_client_loop_set_backoff(DltClientLoop *loop, uint32_t min_delay, uint32_t max_delay)
+{
+    if ((loop == NULL) || (min_delay == 0) || (max_delay < min_delay))
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    loop->backoff_min = min_delay;
+    loop->backoff_max = max_delay;
+
+    return DLT_RETURN_OK;
+}
+
+DltReturnValue dlt_client_loop_add(DltClientLoop *loop, DltClientConnection *con, int verbose)
+{
+    DltClientConnection **connections;
+
+    if ((loop == NULL) || (con == NULL) || (con->loop != NULL))
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    if (dlt_client_prepare(&con->client) < DLT_RETURN_OK)
+    {
+        return DLT_RETURN_ERROR;
+    }
+
+    connections = (DltClientConnection **) realloc(loop->connections,
+                                                   (loop->num_connections + 1) * sizeof(DltClientConnection *));
+
+    if (connections == NULL)
+    {
+        return DLT_RETURN_ERROR;
+    }
+
+    loop->connections = connections;
+    loop->connections[loop->num_connections++] = con;
+
+    con->loop = loop;
+    con->client.priv->connection = con;
+    con->client.sock = -1;
+    con->state = DLT_CLIENT_LOOP_DISCONNECTED;
+    con->backoff = loop->backoff_min;
+    con->sendbuf = NULL;
+    con->send_used = 0;
+    con->send_size = 0;
+
+    /* first connection attempt in the next dispatch */
+    con->retry = dlt_client_loop_now();
+
+    if (verbose)
+    {
+        printf("Added connection to client loop, %d connections\n", loop->num_connections);
+    }
+
+    return DLT_RETURN_OK;
+}
+
+DltReturnValue dlt_client_loop_remove(DltClientLoop *loop, DltClientConnection *con, int verbose)
+{
+    int i;
+
+    if ((loop == NULL) || (con == NULL) || (con->loop != loop))
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    for (i = 0; i < loop->num_connections; i++)
+    {
+        if (loop->connections[i] == con)
+        {
+            break;
+        }
+    }
+
+    if (i == loop->num_connections)
+    {
+        return DLT_RETURN_ERROR;
+    }
+
+    memmove(&loop->connections[i], &loop->connections[i + 1],
+            (loop->num_connections - i - 1) * sizeof(DltClientConnection *));
+    loop->num_connections--;
+
+    dlt_client_loop_close(con);
+
+    con->state = DLT_CLIENT_LOOP_DISCONNECTED;
+    con->loop = NULL;
+    if (con->client.priv != NULL)
+    {
+        con->client.priv->connection = NULL;
+    }
+
+    free(con->sendbuf);
+    con->sendbuf = NULL;
+    con->send_size = 0;
+
+    dlt_receiver_free(&con->client.receiver);
+
+    if (verbose)
+    {
+        printf("Removed connection from client loop, %d connections\n", loop->num_connections);
+    }
+
+    return DLT_RETURN_OK;
+}
+
+int dlt_client_loop_dispatch(DltClientLoop *loop, int timeout, int verbose)
+{
+    struct epoll_event events[DLT_CLIENT_LOOP_MAX_EVENTS];
+    DltClientConnection *con;
+    int64_t now;
+    uint64_t value;
+    int num;
+    int i;
+
+    if (loop == NULL)
+    {
+        return -1;
+    }
+
+    /* connection attempts which are due, and the time until the next one */
+    now = dlt_client_loop_now();
+
+    for (i = 0; i < loop->num_connections; i++)
+    {
+        con = loop->connections[i];
+
+        if ((con->state == DLT_CLIENT_LOOP_DISCONNECTED) && (con->retry <= now))
+        {
+            dlt_client_loop_connect(con, verbose);
+        }
+
+        if ((con->state == DLT_CLIENT_LOOP_DISCONNECTED) &&
+            ((timeout < 0) || (con->retry - now < timeout)))
+        {
+            timeout = (con->retry > now) ? (int) (con->retry - now) : 0;
+        }
+    }
+
+    num = epoll_wait(loop->epfd, events, DLT_CLIENT_LOOP_MAX_EVENTS, timeout);
+
+    if (num < 0)
+    {
+        return (errno == EINTR) ? 0 : -1;
+    }
+
+    for (i = 0; i < num; i++)
+    {
+        con = (DltClientConnection *) events[i].data.ptr;
+
+        if (con == NULL)
+        {
+            /* wake up event, only clear it */
+            if (read(loop->wake_fd, &value, sizeof(value)) < 0)
+            {
+                /* nothing to clear */
+            }
+
+            continue;
+        }
+
+        /* connection may have been closed while handling a former event */
+        if (con->client.sock == -1)
+        {
+            continue;
+        }
+
+        dlt_client_loop_handle(con, events[i].events, verbose);
+    }
+
+    return num;
+}
+
+DltReturnValue dlt_client_loop_run(DltClientLoop *loop, int verbose)
+{
+    if (loop == NULL)
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    while (!__atomic_load_n(&loop->stop, __ATOMIC_ACQUIRE))
+    {
+        if (dlt_client_loop_dispatch(loop, -1, verbose) < 0)
+        {
+            return DLT_RETURN_ERROR;
+        }
+    }
+
+    __atomic_store_n(&loop->stop, 0, __ATOMIC_RELEASE);
+
+    return DLT_RETURN_OK;
+}
+
+void dlt_client_loop_stop(DltClientLoop *loop)
+{
+    uint64_t value = 1;
+
+    if (loop == NULL)
+    {
+        return;
+    }
+
+    __atomic_store_n(&loop->stop, 1, __ATOMIC_RELEASE);
+
+    if (write(loop->wake_fd, &value, sizeof(value)) < 0)
+    {
+        dlt_vlog(LOG_WARNING, "Waking up client loop failed: %s\n", strerror(errno));
+    }
+}
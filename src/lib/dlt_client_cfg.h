@@ -85,6 +85,19 @@
 /* Size of receive buffer */
 #define DLT_CLIENT_RCVBUFSIZE         10024
 
+/* Minimum size of receive buffer of a client loop connection, holds the largest message */
+#define DLT_CLIENT_LOOP_RCVBUFSIZE    (UINT16_MAX + 4)
+
+/* Maximum size of unsent control messages of a client loop connection */
+#define DLT_CLIENT_LOOP_SENDBUFSIZE   (1024 * 1024)
+
+/* Maximum number of events handled by a client loop at once */
+#define DLT_CLIENT_LOOP_MAX_EVENTS    64
+
+/* Default delays between connection attempts of a client loop in ms */
+#define DLT_CLIENT_LOOP_BACKOFF_MIN   100
+#define DLT_CLIENT_LOOP_BACKOFF_MAX   10000
+
 /* Initial baudrate */
 #if !defined (__WIN32__) && !defined(_MSC_VER)
 #define DLT_CLIENT_INITIAL_BAUDRATE B115200
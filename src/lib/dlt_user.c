@@ -38,6 +38,7 @@
 #endif
 
 #include <sys/time.h>
+#include <time.h> /* for clock_gettime() */
 #include <math.h>
 
 #include <sys/stat.h>
@@ -45,6 +46,7 @@
 #include <errno.h>
 
 #include <sys/uio.h> /* writev() */
+#include <sys/mman.h> /* mmap() */
 
 #include <limits.h>
 #ifdef linux
@@ -87,6 +89,17 @@ static char dlt_user_dir[NAME_MAX + 1];
 static char dlt_daemon_fifo[NAME_MAX + 1];
 #endif
 
+/* Log level table the contexts point into, NULL if levels are only received as messages.
+   It is private until the table of the daemon is mapped over it. */
+static DltUserLogLevelTable *dlt_user_log_level_table = NULL;
+static int dlt_user_log_level_table_shared = 0;   /* table of the daemon is mapped, read-only */
+static int dlt_user_log_level_table_pending = 0;  /* mapping failed, retried by the receiver thread */
+#ifndef DLT_USE_UNIX_SOCKET_IPC
+static uint32_t dlt_user_log_level_table_generation = 0;
+static dev_t dlt_user_log_level_table_dev;
+static ino_t dlt_user_log_level_table_ino;
+#endif
+
 static char str[DLT_USER_BUFFER_LENGTH];
 
 static sem_t dlt_mutex;
@@ -98,6 +111,81 @@ static int  atexit_registered = 0;
 // calling atfork_handler() only once
 static int  atfork_registered = 0;
 
+#ifdef DLT_SHM_ENABLE
+/* Shared memory ring of one producing thread */
+typedef struct
+{
+    DltShm shm;
+    unsigned int generation; /* connection the ring was registered on */
+} DltUserShm;
+
+static pthread_key_t dlt_user_shm_key;
+static pthread_once_t dlt_user_shm_once = PTHREAD_ONCE_INIT;
+/* incremented on each connection to the daemon, rings of older connections are dropped */
+static unsigned int dlt_user_shm_generation = 0;
+
+static void dlt_user_shm_key_init(void);
+static DltUserShm *dlt_user_shm_get(void);
+static void dlt_user_shm_release(void);
+#endif
+
+/* Asynchronous mode: log calls only copy the message, a flusher thread sends */
+typedef struct
+{
+    int enabled;                /* asynchronous mode is used */
+    int requested;              /* asynchronous mode requested by dlt_init_async() */
+    pthread_mutex_t mutex;      /* protects the active buffer and spill */
+    pthread_cond_t cond;        /* wakes up the flusher thread */
+    pthread_t thread;           /* flusher thread */
+    int stop;                   /* request to stop the flusher thread */
+    int flush_now;              /* request to send without waiting for the latency */
+    unsigned char *buffer[2];   /* active and flushing buffer */
+    int active;                 /* index of the buffer log calls write to */
+    uint32_t size;              /* size of each buffer */
+    uint32_t used;              /* bytes used in the active buffer */
+    uint32_t flush_used;        /* bytes used in the flushing buffer, flusher only */
+    uint32_t flush_offset;      /* bytes of the flushing buffer already sent, flusher only */
+    uint32_t watermark;         /* fill level waking up the flusher thread */
+    uint32_t latency;           /* maximum time in ms a message is buffered */
+    int spill;                  /* buffer was full, messages go to the startup buffer until caught up */
+} DltUserAsync;
+
+static DltUserAsync dlt_user_async;
+
+/* Settings used by the header templates of the contexts, changed when a setting changes */
+static uint32_t dlt_user_header_generation = 1;
+
+/* Number of words holding a header template */
+#define DLT_USER_HEADER_TEMPLATE_WORDS ((DLT_USER_HEADER_TEMPLATE_SIZE + 3) / 4)
+
+/* Pre-built standard, extra and extended header of a context. Senders copy it
+ * without lock, so all fields are only accessed with atomic operations. */
+typedef struct
+{
+    uint32_t generation;        /* settings the template was built for, 0 if not built */
+    uint32_t size;              /* size of the template */
+    uint32_t header[DLT_USER_HEADER_TEMPLATE_WORDS];
+} DltUserHeaderTemplate;
+
+/* Header templates indexed by log_level_pos of the context. Chunks are
+ * allocated under DLT_SEM and never moved or freed, so senders read them
+ * without lock, also while dlt_free() runs in another thread. */
+static DltUserHeaderTemplate *dlt_user_header_chunks[DLT_USER_HEADER_CHUNKS];
+
+static void dlt_user_header_invalidate(void);
+static void dlt_user_header_reset(int32_t pos);
+static uint8_t dlt_user_log_get_header(DltContext *handle, unsigned char *buffer);
+
+static DltReturnValue dlt_user_async_init(void);
+static void dlt_user_async_free(void);
+static int dlt_user_async_start_thread(void);
+static void dlt_user_async_stop_thread(void);
+static void dlt_user_async_disable(void);
+static void dlt_user_async_sync(void);
+static DltReturnValue dlt_user_async_push(const unsigned char *data1, uint32_t size1,
+                                          const unsigned char *data2, uint32_t size2,
+                                          const unsigned char *data3, uint32_t size3);
+
 
 /* Segmented Network Trace */
 #define DLT_MAX_TRACE_SEGMENT_SIZE 1024
@@ -160,6 +248,16 @@ static void dlt_user_trace_network_segmented_thread(void *unused);
 static void dlt_user_trace_network_segmented_thread_segmenter(s_segmented_data *data);
 static DltReturnValue dlt_user_queue_resend(void);
 
+#ifndef DLT_USE_UNIX_SOCKET_IPC
+static void dlt_user_log_level_table_init(void);
+static void dlt_user_log_level_table_attach(void);
+static void dlt_user_log_level_table_watch(void);
+static void dlt_user_log_level_table_check(void);
+#endif
+static void dlt_user_log_level_table_free(void);
+static DltUserLogLevelEntry *dlt_user_log_level_table_entry(int8_t *log_level_ptr);
+static void dlt_user_log_level_set(dlt_ll_ts_type *ll_ts);
+
 static int dlt_start_threads();
 static void dlt_stop_threads();
 static void dlt_fork_pre_fork_handler();
@@ -241,6 +339,9 @@ static DltReturnValue dlt_initialize_socket_connection(void)
     {
         dlt_user.dlt_log_handle = sockfd;
         dlt_user.connection_state = DLT_USER_CONNECTED;
+#ifdef DLT_SHM_ENABLE
+        __atomic_add_fetch(&dlt_user_shm_generation, 1, __ATOMIC_RELEASE);
+#endif
 
         if (dlt_receiver_init(&(dlt_user.receiver),
                               sockfd,
@@ -311,6 +412,8 @@ static DltReturnValue dlt_initialize_fifo_connection(void)
         return DLT_RETURN_OK;
     }
 
+    dlt_user_log_level_table_init();
+
     /* open DLT output FIFO */
     dlt_user.dlt_log_handle = open(dlt_daemon_fifo, O_WRONLY | O_NONBLOCK | O_CLOEXEC );
     if (dlt_user.dlt_log_handle==-1)
@@ -329,8 +432,268 @@ static DltReturnValue dlt_initialize_fifo_connection(void)
 
     return DLT_RETURN_OK;
 }
+
+/**
+ * Set up the log level table the contexts point into. It is private until
+ * the table the daemon creates for the application is mapped over it, see
+ * dlt_user_log_level_table_attach(). Then the daemon changes the levels of
+ * the contexts in place, instead of sending a message per context.
+ */
+static void dlt_user_log_level_table_init(void)
+{
+    void *table;
+
+    table = mmap(NULL, sizeof(DltUserLogLevelTable), PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (table == MAP_FAILED)
+    {
+        dlt_vnlog(LOG_INFO, DLT_USER_BUFFER_LENGTH, "Log level table cannot be mapped, levels are received as messages\n");
+        return;
+    }
+
+    dlt_user_log_level_table = (DltUserLogLevelTable *)table;
+    dlt_user_log_level_table_shared = 0;
+    dlt_user_log_level_table_pending = 0;
+    dlt_user_log_level_table_generation = 0;
+}
+
+/**
+ * Map the log level table of the daemon read-only over the table the contexts
+ * point into, so their pointers stay valid. Called with DLT_SEM locked, when
+ * a log level message is received: the daemon sends at least one before it
+ * changes levels only in place.
+ */
+static void dlt_user_log_level_table_attach(void)
+{
+    char filename[DLT_USER_MAX_FILENAME_LENGTH];
+    DltUserLogLevelTable backup;
+    struct stat daemon_st;
+    struct stat st;
+    void *table;
+    int fd;
+
+    if (dlt_user_log_level_table == NULL)
+    {
+        return;
+    }
+
+    snprintf(filename, DLT_USER_MAX_FILENAME_LENGTH, "%s/dlt%d%s",
+             dlt_user_dir, getpid(), DLT_USER_LOG_LEVEL_TABLE_SUFFIX);
+
+    fd = open(filename, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd == -1)
+    {
+        /* daemon without log level table */
+        dlt_user_log_level_table_pending = 0;
+        return;
+    }
+
+    if (fstat(fd, &st) == -1)
+    {
+        close(fd);
+        dlt_user_log_level_table_pending = 1;
+        dlt_user_log_level_table_watch();
+        return;
+    }
+
+    /* the daemon recreates the table when the application registers again */
+    if (dlt_user_log_level_table_shared &&
+        (st.st_dev == dlt_user_log_level_table_dev) &&
+        (st.st_ino == dlt_user_log_level_table_ino))
+    {
+        close(fd);
+        dlt_user_log_level_table_pending = 0;
+        return;
+    }
+
+    /* only map a table created by the daemon, which nobody can resize */
+    if (!S_ISREG(st.st_mode) || (st.st_nlink != 1) ||
+        (st.st_size < (off_t)sizeof(DltUserLogLevelTable)) ||
+        (stat(dlt_daemon_fifo, &daemon_st) == -1) || (st.st_uid != daemon_st.st_uid))
+    {
+        dlt_vnlog(LOG_WARNING, DLT_USER_BUFFER_LENGTH, "Log level table %s not created by the daemon, ignored!\n", filename);
+        close(fd);
+        dlt_user_log_level_table_pending = 0;
+        return;
+    }
+
+    /* a failing fixed mapping may leave the range unmapped */
+    memcpy(&backup, dlt_user_log_level_table, sizeof(DltUserLogLevelTable));
+
+    table = mmap(dlt_user_log_level_table, sizeof(DltUserLogLevelTable), PROT_READ,
+                 MAP_SHARED | MAP_FIXED, fd, 0);
+    close(fd);
+
+    if (table == MAP_FAILED)
+    {
+        table = mmap(dlt_user_log_level_table, sizeof(DltUserLogLevelTable), PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+
+        if (table != MAP_FAILED)
+        {
+            memcpy(table, &backup, sizeof(DltUserLogLevelTable));
+        }
+
+        dlt_vnlog(LOG_WARNING, DLT_USER_BUFFER_LENGTH, "Log level table %s cannot be mapped!\n", filename);
+        dlt_user_log_level_table_shared = 0;
+        dlt_user_log_level_table_pending = 1;
+        dlt_user_log_level_table_watch();
+        return;
+    }
+
+    dlt_user_log_level_table_shared = 1;
+    dlt_user_log_level_table_pending = 0;
+    dlt_user_log_level_table_dev = st.st_dev;
+    dlt_user_log_level_table_ino = st.st_ino;
+    dlt_user_log_level_table_generation = 0;
+    dlt_user_log_level_table_watch();
+}
+
+/**
+ * The receiver thread reads the FIFO blocking. Once the table has to be
+ * checked, the FIFO is read non-blocking, so the thread returns to check it
+ * every DLT_USER_RECEIVE_DELAY, as with unix socket IPC.
+ */
+static void dlt_user_log_level_table_watch(void)
+{
+    int flags;
+
+    flags = fcntl(dlt_user.dlt_user_handle, F_GETFL, 0);
+
+    if ((flags != -1) && !(flags & O_NONBLOCK))
+    {
+        fcntl(dlt_user.dlt_user_handle, F_SETFL, flags | O_NONBLOCK);
+    }
+}
+
+/**
+ * Update the local levels of the contexts from the table of the daemon and
+ * invoke their log level changed callbacks. Called by the receiver thread,
+ * so changes are reported with the same delay as received messages. Changes
+ * in a short time may be reported once, with the latest levels.
+ */
+static void dlt_user_log_level_table_check(void)
+{
+    DltUserLogLevelChangedCallback delayed_log_level_changed_callback;
+    DltUserLogLevelEntry *entry;
+    uint32_t generation;
+    uint32_t i = 0;
+
+    DLT_SEM_LOCK();
+
+    if (dlt_user_log_level_table_pending)
+    {
+        dlt_user_log_level_table_attach();
+    }
+
+    if (!dlt_user_log_level_table_shared)
+    {
+        DLT_SEM_FREE();
+        return;
+    }
+
+    generation = __atomic_load_n(&dlt_user_log_level_table->generation, __ATOMIC_ACQUIRE);
+
+    if (generation == dlt_user_log_level_table_generation)
+    {
+        DLT_SEM_FREE();
+        return;
+    }
+
+    dlt_user_log_level_table_generation = generation;
+
+    while (1)
+    {
+        delayed_log_level_changed_callback.log_level_changed_callback = 0;
+
+        for (; (dlt_user.dlt_ll_ts != NULL) && (i < dlt_user.dlt_ll_ts_num_entries); i++)
+        {
+            entry = dlt_user_log_level_table_entry(dlt_user.dlt_ll_ts[i].log_level_ptr);
+
+            if ((entry == NULL) ||
+                ((entry->log_level == dlt_user.dlt_ll_ts[i].log_level) &&
+                 (entry->trace_status == dlt_user.dlt_ll_ts[i].trace_status)))
+            {
+                continue;
+            }
+
+            dlt_user.dlt_ll_ts[i].log_level = entry->log_level;
+            dlt_user.dlt_ll_ts[i].trace_status = entry->trace_status;
+
+            if (dlt_user.dlt_ll_ts[i].log_level_changed_callback != 0)
+            {
+                delayed_log_level_changed_callback.log_level_changed_callback = dlt_user.dlt_ll_ts[i].log_level_changed_callback;
+                memcpy(delayed_log_level_changed_callback.contextID, dlt_user.dlt_ll_ts[i].contextID, DLT_ID_SIZE);
+                delayed_log_level_changed_callback.log_level = entry->log_level;
+                delayed_log_level_changed_callback.trace_status = entry->trace_status;
+                i++;
+                break;
+            }
+        }
+
+        DLT_SEM_FREE();
+
+        if (delayed_log_level_changed_callback.log_level_changed_callback == 0)
+        {
+            return;
+        }
+
+        /* call callback outside of semaphore */
+        delayed_log_level_changed_callback.log_level_changed_callback(delayed_log_level_changed_callback.contextID,
+                                                                      delayed_log_level_changed_callback.log_level,
+                                                                      delayed_log_level_changed_callback.trace_status);
+
+        DLT_SEM_LOCK();
+    }
+}
 #endif
 
+static void dlt_user_log_level_table_free(void)
+{
+    /* Contexts not unregistered may still check their log level after
+       dlt_free(), the mapping is kept until the process exits */
+    dlt_user_log_level_table = NULL;
+    dlt_user_log_level_table_shared = 0;
+    dlt_user_log_level_table_pending = 0;
+}
+
+/**
+ * Get the entry of the log level table a log level pointer points into.
+ * @return entry or NULL if the log level is not stored in the table
+ */
+static DltUserLogLevelEntry *dlt_user_log_level_table_entry(int8_t *log_level_ptr)
+{
+    DltUserLogLevelTable *table = dlt_user_log_level_table;
+
+    if ((table == NULL) || (log_level_ptr == NULL) ||
+        (log_level_ptr < (int8_t *)table->entries) ||
+        (log_level_ptr >= (int8_t *)(table->entries + DLT_USER_LOG_LEVEL_TABLE_ENTRIES)))
+    {
+        return NULL;
+    }
+
+    return &table->entries[(log_level_ptr - (int8_t *)table->entries) / sizeof(DltUserLogLevelEntry)];
+}
+
+/**
+ * Store the levels of a context where its pointers point to, unless they
+ * point into the table of the daemon, which the daemon updates itself.
+ */
+static void dlt_user_log_level_set(dlt_ll_ts_type *ll_ts)
+{
+    if (dlt_user_log_level_table_shared &&
+        (dlt_user_log_level_table_entry(ll_ts->log_level_ptr) != NULL))
+    {
+        return;
+    }
+
+    if (ll_ts->log_level_ptr)
+        *(ll_ts->log_level_ptr) = ll_ts->log_level;
+    if (ll_ts->trace_status_ptr)
+        *(ll_ts->trace_status_ptr) = ll_ts->trace_status;
+}
+
 DltReturnValue dlt_init(void)
 {
     // process is exiting. Do not allocate new resources.
@@ -357,16 +720,7 @@ DltReturnValue dlt_init(void)
     dlt_user.dlt_is_file = 0;
     dlt_user.overflow = 0;
     dlt_user.overflow_counter = 0;
-#ifdef DLT_SHM_ENABLE
-    memset(&(dlt_user.dlt_shm),0,sizeof(DltShm));
-    /* init shared memory */
-    if (dlt_shm_init_client(&(dlt_user.dlt_shm),DLT_SHM_KEY) < 0)
-    {
-        snprintf(str,DLT_USER_BUFFER_LENGTH,"Logging disabled, Shared memory %d cannot be created!\n",DLT_SHM_KEY);
-        dlt_log(LOG_WARNING, str);
-        //return 0;
-    }
-#elif defined DLT_USE_UNIX_SOCKET_IPC
+#ifdef DLT_USE_UNIX_SOCKET_IPC
     if (dlt_initialize_socket_connection() != DLT_RETURN_OK)
     {
         // We could connect to the pipe, but not to the socket, which is normally
@@ -387,6 +741,12 @@ DltReturnValue dlt_init(void)
     }
 #endif
 
+    /* Asynchronous mode is optional, fall back to synchronous sending on error */
+    if (dlt_user_async.requested && (dlt_user_async_init() < DLT_RETURN_OK))
+    {
+        dlt_log(LOG_WARNING, "Asynchronous mode disabled, sending synchronously\n");
+    }
+
     /* These will be lazy initialized only when needed */
     dlt_user.dlt_segmented_queue_read_handle = -1;
     dlt_user.dlt_segmented_queue_write_handle = -1;
@@ -425,6 +785,21 @@ DltReturnValue dlt_init(void)
     return DLT_RETURN_OK;
 }
 
+DltReturnValue dlt_init_async(uint32_t watermark, uint32_t latency)
+{
+    if (dlt_user_initialised)
+    {
+        dlt_vlog(LOG_WARNING, "%s dlt already initialised\n", __FUNCTION__);
+        return DLT_RETURN_ERROR;
+    }
+
+    dlt_user_async.requested = 1;
+    dlt_user_async.watermark = watermark;
+    dlt_user_async.latency = latency;
+
+    return dlt_init();
+}
+
 DltReturnValue dlt_init_file(const char *name)
 {
     // check null pointer
@@ -528,6 +903,10 @@ DltReturnValue dlt_init_common(void)
     uint32_t buffer_max = DLT_USER_RINGBUFFER_MAX_SIZE;
     char *env_buffer_step;
     uint32_t buffer_step = DLT_USER_RINGBUFFER_STEP_SIZE;
+#ifdef DLT_SHM_ENABLE
+    char *env_shm_ring_size;
+#endif
+    char *env_async;
 
     /* Binary semaphore for threads */
     if (sem_init(&dlt_mutex, 0, 1)==-1)
@@ -545,6 +924,9 @@ DltReturnValue dlt_init_common(void)
     dlt_set_id(dlt_user.ecuID,DLT_USER_DEFAULT_ECU_ID);
     dlt_set_id(dlt_user.appID,"");
 
+    /* header templates contain the session id, rebuild them also after fork() */
+    dlt_user_header_invalidate();
+
     dlt_user.application_description = NULL;
 
     /* Verbose mode is enabled by default */
@@ -569,6 +951,43 @@ DltReturnValue dlt_init_common(void)
 
     dlt_user.timeout_at_exit_handler = DLT_USER_ATEXIT_RESEND_BUFFER_EXIT_TIMEOUT;
 
+#ifdef DLT_SHM_ENABLE
+    dlt_user.shm_ring_size = DLT_SHM_RING_SIZE;
+
+    env_shm_ring_size = getenv(DLT_USER_ENV_SHM_RING_SIZE);
+    if (env_shm_ring_size != NULL)
+    {
+        dlt_user.shm_ring_size = (int) strtol(env_shm_ring_size, NULL, 10);
+        if (errno == EINVAL || errno == ERANGE || dlt_user.shm_ring_size <= 0)
+        {
+            dlt_vlog(LOG_ERR,
+                     "Wrong value specified for %s. Using default\n",
+                     DLT_USER_ENV_SHM_RING_SIZE);
+            dlt_user.shm_ring_size = DLT_SHM_RING_SIZE;
+        }
+    }
+
+    pthread_once(&dlt_user_shm_once, dlt_user_shm_key_init);
+#endif
+
+    env_async = getenv(DLT_USER_ENV_ASYNC);
+    if (env_async != NULL)
+    {
+        dlt_user_async.requested = (strcmp(env_async, "1") == 0);
+    }
+
+    env_async = getenv(DLT_USER_ENV_ASYNC_WATERMARK);
+    if (env_async != NULL)
+    {
+        dlt_user_async.watermark = (uint32_t) strtoul(env_async, NULL, 10);
+    }
+
+    env_async = getenv(DLT_USER_ENV_ASYNC_LATENCY);
+    if (env_async != NULL)
+    {
+        dlt_user_async.latency = (uint32_t) strtoul(env_async, NULL, 10);
+    }
+
     env_local_print = getenv(DLT_USER_ENV_LOCAL_PRINT_MODE);
     if (env_local_print)
     {
@@ -681,6 +1100,9 @@ void dlt_user_atexit_handler(void)
         return;
     }
 
+    /* Send remaining messages of asynchronous mode synchronously from now on */
+    dlt_user_async_disable();
+
     /* Try to resend potential log messages in the user buffer */
     int count = dlt_user_atexit_blow_out_user_buffer();
 
@@ -785,8 +1207,9 @@ DltReturnValue dlt_free(void)
 #endif
 
 #ifdef DLT_SHM_ENABLE
-    /* free shared memory */
-    dlt_shm_free_client(&dlt_user.dlt_shm);
+    /* release ring of this thread, rings of other threads are dropped on their next use */
+    dlt_user_shm_release();
+    __atomic_add_fetch(&dlt_user_shm_generation, 1, __ATOMIC_RELEASE);
 #endif
 
     if (dlt_user.dlt_log_handle!=-1)
@@ -806,6 +1229,8 @@ DltReturnValue dlt_free(void)
     dlt_buffer_free_dynamic(&(dlt_user.startup_buffer));
     DLT_SEM_FREE();
 
+    dlt_user_async_free();
+
     DLT_SEM_LOCK();
     if (dlt_user.dlt_ll_ts)
     {
@@ -817,18 +1242,15 @@ DltReturnValue dlt_free(void)
                 dlt_user.dlt_ll_ts[i].context_description = NULL;
             }
 
-            if (dlt_user.dlt_ll_ts[i].log_level_ptr != NULL)
+            if (dlt_user_log_level_table_entry(dlt_user.dlt_ll_ts[i].log_level_ptr) == NULL)
             {
                 free(dlt_user.dlt_ll_ts[i].log_level_ptr);
-                dlt_user.dlt_ll_ts[i].log_level_ptr = NULL;
-            }
-
-            if (dlt_user.dlt_ll_ts[i].trace_status_ptr != NULL)
-            {
                 free(dlt_user.dlt_ll_ts[i].trace_status_ptr);
-                dlt_user.dlt_ll_ts[i].trace_status_ptr = NULL;
             }
 
+            dlt_user.dlt_ll_ts[i].log_level_ptr = NULL;
+            dlt_user.dlt_ll_ts[i].trace_status_ptr = NULL;
+
             if (dlt_user.dlt_ll_ts[i].injection_table != NULL)
             {
                 free(dlt_user.dlt_ll_ts[i].injection_table);
@@ -844,6 +1266,11 @@ DltReturnValue dlt_free(void)
         dlt_user.dlt_ll_ts_num_entries = 0;
     }
 
+    dlt_user_log_level_table_free();
+
+    /* header templates are kept for a later dlt_init(), senders may still read them */
+    dlt_user_header_invalidate();
+
     dlt_env_free_ll_set(&dlt_user.initial_ll_set);
     DLT_SEM_FREE();
 
@@ -926,6 +1353,7 @@ DltReturnValue dlt_register_app(const char *appid, const char * description)
 
     /* Store locally application id and application description */
     dlt_set_id(dlt_user.appID, appid);
+    dlt_user_header_invalidate();
 
     if (dlt_user.application_description != NULL)
         free(dlt_user.application_description);
@@ -1136,6 +1564,18 @@ DltReturnValue dlt_register_context_ll_ts(DltContext *handle, const char *contex
 		dlt_user.dlt_ll_ts[dlt_user.dlt_ll_ts_num_entries].context_description[desc_len]='\0';
 	}
 
+	if ((dlt_user.dlt_ll_ts[dlt_user.dlt_ll_ts_num_entries].log_level_ptr == 0) &&
+	    (dlt_user.dlt_ll_ts[dlt_user.dlt_ll_ts_num_entries].trace_status_ptr == 0) &&
+	    (dlt_user_log_level_table != NULL) &&
+	    (dlt_user.dlt_ll_ts_num_entries < DLT_USER_LOG_LEVEL_TABLE_ENTRIES))
+	{
+		/* levels are changed in place by the daemon */
+		dlt_user.dlt_ll_ts[dlt_user.dlt_ll_ts_num_entries].log_level_ptr =
+			&(dlt_user_log_level_table->entries[dlt_user.dlt_ll_ts_num_entries].log_level);
+		dlt_user.dlt_ll_ts[dlt_user.dlt_ll_ts_num_entries].trace_status_ptr =
+			&(dlt_user_log_level_table->entries[dlt_user.dlt_ll_ts_num_entries].trace_status);
+	}
+
 	if(dlt_user.dlt_ll_ts[dlt_user.dlt_ll_ts_num_entries].log_level_ptr == 0)
 	{
 		dlt_user.dlt_ll_ts[dlt_user.dlt_ll_ts_num_entries].log_level_ptr = malloc(sizeof(int8_t));
@@ -1177,13 +1617,16 @@ DltReturnValue dlt_register_context_ll_ts(DltContext *handle, const char *contex
 	dlt_set_id(handle->contextID, contextid);
 	handle->log_level_pos = dlt_user.dlt_ll_ts_num_entries;
 
+	/* Header template is built with the first message */
+	dlt_user_header_reset(handle->log_level_pos);
+
 	handle->log_level_ptr = dlt_user.dlt_ll_ts[dlt_user.dlt_ll_ts_num_entries].log_level_ptr;
 	handle->trace_status_ptr = dlt_user.dlt_ll_ts[dlt_user.dlt_ll_ts_num_entries].trace_status_ptr;
 
 	log.context_description = dlt_user.dlt_ll_ts[dlt_user.dlt_ll_ts_num_entries].context_description;
 
-	*(dlt_user.dlt_ll_ts[dlt_user.dlt_ll_ts_num_entries].log_level_ptr) = dlt_user.dlt_ll_ts[dlt_user.dlt_ll_ts_num_entries].log_level;
-	*(dlt_user.dlt_ll_ts[dlt_user.dlt_ll_ts_num_entries].trace_status_ptr) = dlt_user.dlt_ll_ts[dlt_user.dlt_ll_ts_num_entries].trace_status = tracestatus;
+	dlt_user.dlt_ll_ts[dlt_user.dlt_ll_ts_num_entries].trace_status = tracestatus;
+	dlt_user_log_level_set(&dlt_user.dlt_ll_ts[dlt_user.dlt_ll_ts_num_entries]);
 
 	log.log_level = loglevel;
 	log.trace_status =  tracestatus;
@@ -1205,6 +1648,9 @@ DltReturnValue dlt_unregister_app(void)
         return DLT_RETURN_ERROR;
     }
 
+    /* Send buffered log messages before the application is gone */
+    dlt_user_async_sync();
+
     /* Inform daemon to unregister application and all of its contexts */
     ret = dlt_user_log_send_unregister_application();
 
@@ -1212,6 +1658,7 @@ DltReturnValue dlt_unregister_app(void)
 
     /* Clear and free local stored application information */
     dlt_set_id(dlt_user.appID, "");
+    dlt_user_header_invalidate();
 
     if (dlt_user.application_description != NULL)
     {
@@ -1253,18 +1700,15 @@ DltReturnValue dlt_unregister_context(DltContext *handle)
             free(dlt_user.dlt_ll_ts[handle->log_level_pos].context_description);
         }
 
-        if (dlt_user.dlt_ll_ts[handle->log_level_pos].log_level_ptr != NULL)
+        if (dlt_user_log_level_table_entry(dlt_user.dlt_ll_ts[handle->log_level_pos].log_level_ptr) == NULL)
         {
             free(dlt_user.dlt_ll_ts[handle->log_level_pos].log_level_ptr);
-            dlt_user.dlt_ll_ts[handle->log_level_pos].log_level_ptr = NULL;
-        }
-
-        if (dlt_user.dlt_ll_ts[handle->log_level_pos].trace_status_ptr != NULL)
-        {
             free(dlt_user.dlt_ll_ts[handle->log_level_pos].trace_status_ptr);
-            dlt_user.dlt_ll_ts[handle->log_level_pos].trace_status_ptr = NULL;
         }
 
+        dlt_user.dlt_ll_ts[handle->log_level_pos].log_level_ptr = NULL;
+        dlt_user.dlt_ll_ts[handle->log_level_pos].trace_status_ptr = NULL;
+
         dlt_user.dlt_ll_ts[handle->log_level_pos].context_description = NULL;
 
         if (dlt_user.dlt_ll_ts[handle->log_level_pos].injection_table != NULL)
@@ -1341,10 +1785,7 @@ DltReturnValue dlt_set_application_ll_ts_limit(DltLogLevelType loglevel, DltTrac
     {
         dlt_user.dlt_ll_ts[i].log_level = loglevel;
         dlt_user.dlt_ll_ts[i].trace_status = tracestatus;
-        if(dlt_user.dlt_ll_ts[i].log_level_ptr)
-            *(dlt_user.dlt_ll_ts[i].log_level_ptr) = loglevel;
-        if(dlt_user.dlt_ll_ts[i].trace_status_ptr)
-            *(dlt_user.dlt_ll_ts[i].trace_status_ptr) = tracestatus;
+        dlt_user_log_level_set(&dlt_user.dlt_ll_ts[i]);
     }
 
     DLT_SEM_FREE();
@@ -3286,6 +3727,7 @@ DltReturnValue dlt_verbose_mode(void)
 
     /* Switch to verbose mode */
     dlt_user.verbose_mode = 1;
+    dlt_user_header_invalidate();
 
     return DLT_RETURN_OK;
 }
@@ -3303,6 +3745,7 @@ DltReturnValue dlt_nonverbose_mode(void)
 
     /* Switch to non-verbose mode */
     dlt_user.verbose_mode = 0;
+    dlt_user_header_invalidate();
 
     return DLT_RETURN_OK;
 }
@@ -3320,6 +3763,7 @@ DltReturnValue dlt_use_extended_header_for_non_verbose(int8_t use_extende_header
 
     /* Set use_extende_header_for_non_verbose */
     dlt_user.use_extende_header_for_non_verbose = use_extende_header_for_non_verbose;
+    dlt_user_header_invalidate();
 
     return DLT_RETURN_OK;
 }
@@ -3337,6 +3781,7 @@ DltReturnValue dlt_with_session_id(int8_t with_session_id)
 
     /* Set use_extende_header_for_non_verbose */
     dlt_user.with_session_id = with_session_id;
+    dlt_user_header_invalidate();
 
     return DLT_RETURN_OK;
 }
@@ -3354,6 +3799,7 @@ DltReturnValue dlt_with_timestamp(int8_t with_timestamp)
 
     /* Set with_timestamp */
     dlt_user.with_timestamp = with_timestamp;
+    dlt_user_header_invalidate();
 
     return DLT_RETURN_OK;
 }
@@ -3371,6 +3817,7 @@ DltReturnValue dlt_with_ecu_id(int8_t with_ecu_id)
 
     /* Set with_timestamp */
     dlt_user.with_ecu_id = with_ecu_id;
+    dlt_user_header_invalidate();
 
     return DLT_RETURN_OK;
 }
@@ -3414,6 +3861,11 @@ void dlt_user_receiverthread_function(__attribute__((unused)) void *ptr)
 #endif
     while (1)
     {
+#ifndef DLT_USE_UNIX_SOCKET_IPC
+        /* Check for levels changed in place by DLT daemon */
+        dlt_user_log_level_table_check();
+#endif
+
         /* Check for new messages from DLT daemon */
         if (dlt_user_log_check_user_message() < DLT_RETURN_OK)
         {
@@ -3502,117 +3954,405 @@ DltReturnValue dlt_user_queue_resend(void)
     return DLT_RETURN_OK;
 }
 
-DltReturnValue dlt_user_log_send_log(DltContextData *log, int mtype)
+#ifdef DLT_SHM_ENABLE
+static void dlt_user_shm_destroy(void *data)
 {
-    DltMessage msg;
-    DltUserHeader userheader;
-    int32_t len;
-
-    DltReturnValue ret = DLT_RETURN_OK;
+    DltUserShm *ring = (DltUserShm *)data;
 
-    if (!dlt_user_initialised)
+    if (ring == NULL)
     {
-        dlt_vlog(LOG_ERR, "%s dlt_user_initialised false\n", __FUNCTION__);
-        return DLT_RETURN_ERROR;
+        return;
     }
 
-    if (log == NULL ||
-        log->handle == NULL ||
-        log->handle->contextID[0] == '\0' ||
-        (mtype < DLT_TYPE_LOG) || (mtype > DLT_TYPE_CONTROL)
-        )
+    /* after fork() the ring still belongs to the parent */
+    if (ring->shm.pid == getpid())
     {
-        return DLT_RETURN_WRONG_PARAMETER;
+        dlt_shm_close(&ring->shm);
     }
 
-    /* also for Trace messages */
-#ifdef DLT_SHM_ENABLE
-    if (dlt_user_set_userheader(&userheader, DLT_USER_MESSAGE_LOG_SHM) < DLT_RETURN_OK)
-#else
-    if (dlt_user_set_userheader(&userheader, DLT_USER_MESSAGE_LOG) < DLT_RETURN_OK)
-#endif
-    {
-        return DLT_RETURN_ERROR;
-    }
+    dlt_shm_free_client(&ring->shm);
+    free(ring);
+}
 
-    if (dlt_message_init(&msg, 0) == DLT_RETURN_ERROR)
+static void dlt_user_shm_key_init(void)
+{
+    if (pthread_key_create(&dlt_user_shm_key, dlt_user_shm_destroy) != 0)
     {
-        return DLT_RETURN_ERROR;
+        dlt_log(LOG_ERR, "Can't create key for shared memory rings\n");
     }
+}
 
-    msg.storageheader = (DltStorageHeader*)msg.headerbuffer;
+static void dlt_user_shm_release(void)
+{
+    DltUserShm *ring = (DltUserShm *)pthread_getspecific(dlt_user_shm_key);
 
-    if (dlt_set_storageheader(msg.storageheader,dlt_user.ecuID) == DLT_RETURN_ERROR)
+    if (ring != NULL)
     {
-        return DLT_RETURN_ERROR;
+        pthread_setspecific(dlt_user_shm_key, NULL);
+        dlt_user_shm_destroy(ring);
     }
+}
 
-    msg.standardheader = (DltStandardHeader*)(msg.headerbuffer + sizeof(DltStorageHeader));
-    msg.standardheader->htyp = DLT_HTYP_PROTOCOL_VERSION1 ;
+/**
+ * Get the ring of the calling thread.
+ * The ring is created and registered at the daemon on first use and after
+ * each reconnection to the daemon.
+ * @return ring or NULL if the socket has to be used instead
+ */
+static DltUserShm *dlt_user_shm_get(void)
+{
+    DltUserShm *ring;
+    DltUserHeader userheader;
+    DltUserControlMsgShmRegister usercontext;
+    unsigned int generation;
+    int fds[2];
+
+    generation = __atomic_load_n(&dlt_user_shm_generation, __ATOMIC_ACQUIRE);
+    ring = (DltUserShm *)pthread_getspecific(dlt_user_shm_key);
 
-    /* send ecu id */
-    if(dlt_user.with_ecu_id)
+    if (ring != NULL)
     {
-        msg.standardheader->htyp |= DLT_HTYP_WEID;
+        if ((ring->generation == generation) && (ring->shm.pid == getpid()))
+        {
+            return ring;
+        }
+
+        /* daemon dropped the ring together with the old connection */
+        dlt_user_shm_release();
     }
 
-    /* send timestamp */
-    if(dlt_user.with_timestamp)
+    if (dlt_user.dlt_log_handle < 0)
     {
-        msg.standardheader->htyp |= DLT_HTYP_WTMS;
+        return NULL;
     }
 
-    /* send session id */
-    if(dlt_user.with_session_id)
+    ring = calloc(1, sizeof(DltUserShm));
+    if (ring == NULL)
     {
-        msg.standardheader->htyp |= DLT_HTYP_WSID;
-        msg.headerextra.seid = getpid();
+        return NULL;
     }
 
-    if (dlt_user.verbose_mode)
+    if (dlt_shm_init_client(&ring->shm, dlt_user.shm_ring_size) < DLT_RETURN_OK)
     {
-        /* In verbose mode, send extended header */
-        msg.standardheader->htyp = (msg.standardheader->htyp | DLT_HTYP_UEH );
+        free(ring);
+        return NULL;
     }
-    else
+
+    if (dlt_user_set_userheader(&userheader, DLT_USER_MESSAGE_LOG_SHM) < DLT_RETURN_OK)
     {
-        /* In non-verbose, send extended header if desired */
-        if(dlt_user.use_extende_header_for_non_verbose)
-            msg.standardheader->htyp = (msg.standardheader->htyp | DLT_HTYP_UEH );
+        dlt_user_shm_destroy(ring);
+        return NULL;
     }
 
-#if (BYTE_ORDER==BIG_ENDIAN)
-    msg.standardheader->htyp = (msg.standardheader->htyp | DLT_HTYP_MSBF);
-#endif
+    usercontext.pid = getpid();
+    usercontext.size = ring->shm.size;
+    fds[0] = ring->shm.memfd;
+    fds[1] = ring->shm.eventfd;
 
-    msg.standardheader->mcnt = log->handle->mcnt++;
+    if (dlt_user_log_out2_fds(dlt_user.dlt_log_handle,
+                              &(userheader), sizeof(DltUserHeader),
+                              &(usercontext), sizeof(DltUserControlMsgShmRegister),
+                              fds, 2) != DLT_RETURN_OK)
+    {
+        dlt_shm_free_client(&ring->shm);
+        free(ring);
+        return NULL;
+    }
+
+    /* the daemon holds its own reference to the memory now */
+    close(ring->shm.memfd);
+    ring->shm.memfd = -1;
+    ring->generation = generation;
+
+    pthread_setspecific(dlt_user_shm_key, ring);
+
+    return ring;
+}
+#endif
+
+static void dlt_user_header_invalidate(void)
+{
+    /* 0 marks a header template which is not built yet */
+    if (__atomic_add_fetch(&dlt_user_header_generation, 1, __ATOMIC_RELEASE) == 0)
+    {
+        __atomic_add_fetch(&dlt_user_header_generation, 1, __ATOMIC_RELEASE);
+    }
+}
+
+/* Get the header template of a context, NULL if not allocated */
+static DltUserHeaderTemplate *dlt_user_header_get(int32_t pos)
+{
+    DltUserHeaderTemplate *chunk;
+
+    if ((pos < 0) || (pos >= DLT_USER_HEADER_CHUNK_SIZE * DLT_USER_HEADER_CHUNKS))
+    {
+        return NULL;
+    }
+
+    chunk = __atomic_load_n(&dlt_user_header_chunks[pos / DLT_USER_HEADER_CHUNK_SIZE], __ATOMIC_ACQUIRE);
+
+    return (chunk != NULL) ? &chunk[pos % DLT_USER_HEADER_CHUNK_SIZE] : NULL;
+}
+
+/* Get the header template of a context, allocate it if needed, DLT_SEM must be locked */
+static DltUserHeaderTemplate *dlt_user_header_alloc(int32_t pos)
+{
+    DltUserHeaderTemplate *chunk;
+
+    if ((pos < 0) || (pos >= DLT_USER_HEADER_CHUNK_SIZE * DLT_USER_HEADER_CHUNKS))
+    {
+        return NULL;
+    }
+
+    chunk = dlt_user_header_chunks[pos / DLT_USER_HEADER_CHUNK_SIZE];
+
+    if (chunk == NULL)
+    {
+        chunk = calloc(DLT_USER_HEADER_CHUNK_SIZE, sizeof(DltUserHeaderTemplate));
+
+        if (chunk == NULL)
+        {
+            return NULL;
+        }
+
+        __atomic_store_n(&dlt_user_header_chunks[pos / DLT_USER_HEADER_CHUNK_SIZE], chunk, __ATOMIC_RELEASE);
+    }
+
+    return &chunk[pos % DLT_USER_HEADER_CHUNK_SIZE];
+}
+
+/* Mark the template of a newly registered context as not built, DLT_SEM must be locked */
+static void dlt_user_header_reset(int32_t pos)
+{
+    DltUserHeaderTemplate *template = dlt_user_header_get(pos);
+
+    if (template != NULL)
+    {
+        __atomic_store_n(&template->generation, 0, __ATOMIC_RELEASE);
+    }
+}
+
+/* Build the header of a context from the current settings, returns its size */
+static uint8_t dlt_user_log_build_header(DltContext *handle, unsigned char *header)
+{
+    DltStandardHeader *standardheader = (DltStandardHeader *)header;
+    unsigned char *ptr = header + sizeof(DltStandardHeader);
+    uint8_t htyp = DLT_HTYP_PROTOCOL_VERSION1;
+
+    if (dlt_user.with_ecu_id)
+    {
+        htyp |= DLT_HTYP_WEID;
+    }
+
+    if (dlt_user.with_session_id)
+    {
+        htyp |= DLT_HTYP_WSID;
+    }
+
+    if (dlt_user.with_timestamp)
+    {
+        htyp |= DLT_HTYP_WTMS;
+    }
+
+    /* In verbose mode, send extended header, in non-verbose only if desired */
+    if (dlt_user.verbose_mode || dlt_user.use_extende_header_for_non_verbose)
+    {
+        htyp |= DLT_HTYP_UEH;
+    }
+
+#if (BYTE_ORDER==BIG_ENDIAN)
+    htyp |= DLT_HTYP_MSBF;
+#endif
+
+    memset(header, 0, DLT_USER_HEADER_TEMPLATE_SIZE);
+    standardheader->htyp = htyp;
+
+    if (DLT_IS_HTYP_WEID(htyp))
+    {
+        dlt_set_id((char *)ptr, dlt_user.ecuID);
+        ptr += DLT_SIZE_WEID;
+    }
+
+    if (DLT_IS_HTYP_WSID(htyp))
+    {
+        uint32_t seid = DLT_HTOBE_32(getpid());
+
+        memcpy(ptr, &seid, DLT_SIZE_WSID);
+        ptr += DLT_SIZE_WSID;
+    }
+
+    if (DLT_IS_HTYP_WTMS(htyp))
+    {
+        /* timestamp is set per message */
+        ptr += DLT_SIZE_WTMS;
+    }
+
+    if (DLT_IS_HTYP_UEH(htyp))
+    {
+        DltExtendedHeader *extendedheader = (DltExtendedHeader *)ptr;
+
+        /* message type and info are set per message */
+        if (dlt_user.verbose_mode)
+        {
+            extendedheader->msin = DLT_MSIN_VERB;
+        }
 
-    /* Set header extra parameters */
-    dlt_set_id(msg.headerextra.ecu,dlt_user.ecuID);
-    //msg.headerextra.seid = 0;
-    msg.headerextra.tmsp = dlt_uptime();
+        dlt_set_id(extendedheader->apid, dlt_user.appID);
+        dlt_set_id(extendedheader->ctid, handle->contextID);
+        ptr += sizeof(DltExtendedHeader);
+    }
+
+    return (uint8_t)(ptr - header);
+}
 
-    if (dlt_message_set_extraparameters(&msg, 0) == DLT_RETURN_ERROR)
+/* Copy a header template word by word, the words may be rebuilt concurrently */
+static uint32_t dlt_user_header_copy(DltUserHeaderTemplate *template, unsigned char *buffer)
+{
+    uint32_t words[DLT_USER_HEADER_TEMPLATE_WORDS];
+    uint32_t size;
+    int i;
+
+    size = __atomic_load_n(&template->size, __ATOMIC_RELAXED);
+
+    for (i = 0; i < DLT_USER_HEADER_TEMPLATE_WORDS; i++)
     {
+        words[i] = __atomic_load_n(&template->header[i], __ATOMIC_RELAXED);
+    }
+
+    memcpy(buffer, words, DLT_USER_HEADER_TEMPLATE_SIZE);
+
+    return size;
+}
+
+/* Copy the header template of a context to buffer, returns the size of the header */
+static uint8_t dlt_user_log_get_header(DltContext *handle, unsigned char *buffer)
+{
+    uint32_t generation = __atomic_load_n(&dlt_user_header_generation, __ATOMIC_ACQUIRE);
+    DltUserHeaderTemplate *template = dlt_user_header_get(handle->log_level_pos);
+    uint32_t words[DLT_USER_HEADER_TEMPLATE_WORDS];
+    uint32_t size;
+    int i;
+
+    if ((template != NULL) &&
+        (__atomic_load_n(&template->generation, __ATOMIC_ACQUIRE) == generation))
+    {
+        size = dlt_user_header_copy(template, buffer);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        /* template was not rebuilt while copying it */
+        if (__atomic_load_n(&template->generation, __ATOMIC_RELAXED) == generation)
+        {
+            return (uint8_t)size;
+        }
+    }
+
+    DLT_SEM_LOCK();
+
+    template = dlt_user_header_alloc(handle->log_level_pos);
+
+    if (template == NULL)
+    {
+        /* context without template, e.g. not registered */
+        size = dlt_user_log_build_header(handle, buffer);
+        DLT_SEM_FREE();
+        return (uint8_t)size;
+    }
+
+    if (__atomic_load_n(&template->generation, __ATOMIC_RELAXED) != generation)
+    {
+        /* readers copying the template at the same time retry */
+        __atomic_store_n(&template->generation, 0, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+
+        memset(words, 0, sizeof(words));
+        size = dlt_user_log_build_header(handle, (unsigned char *)words);
+
+        for (i = 0; i < DLT_USER_HEADER_TEMPLATE_WORDS; i++)
+        {
+            __atomic_store_n(&template->header[i], words[i], __ATOMIC_RELAXED);
+        }
+
+        __atomic_store_n(&template->size, size, __ATOMIC_RELAXED);
+        __atomic_store_n(&template->generation, generation, __ATOMIC_RELEASE);
+    }
+
+    size = dlt_user_header_copy(template, buffer);
+
+    DLT_SEM_FREE();
+
+    return (uint8_t)size;
+}
+
+DltReturnValue dlt_user_log_send_log(DltContextData *log, int mtype)
+{
+    DltMessage msg;
+    DltUserHeader userheader;
+    int32_t len;
+
+    DltReturnValue ret = DLT_RETURN_OK;
+
+    if (!dlt_user_initialised)
+    {
+        dlt_vlog(LOG_ERR, "%s dlt_user_initialised false\n", __FUNCTION__);
         return DLT_RETURN_ERROR;
     }
 
+    if (log == NULL ||
+        log->handle == NULL ||
+        log->handle->contextID[0] == '\0' ||
+        (mtype < DLT_TYPE_LOG) || (mtype > DLT_TYPE_CONTROL)
+        )
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    /* also for Trace messages */
+    if (dlt_user_set_userheader(&userheader, DLT_USER_MESSAGE_LOG) < DLT_RETURN_OK)
+    {
+        return DLT_RETURN_ERROR;
+    }
+
+    if (dlt_message_init(&msg, 0) == DLT_RETURN_ERROR)
+    {
+        return DLT_RETURN_ERROR;
+    }
+
+    /* The storage header is only needed for a file or for printing, the daemon sets its own */
+    msg.storageheader = (DltStorageHeader*)msg.headerbuffer;
+    msg.standardheader = (DltStandardHeader*)(msg.headerbuffer + sizeof(DltStorageHeader));
+
+    /* Copy the pre-built header of the context, only the per message fields are set here */
+    msg.headersize = sizeof(DltStorageHeader) + dlt_user_log_get_header(log->handle, msg.headerbuffer + sizeof(DltStorageHeader));
+
+    msg.standardheader->mcnt = log->handle->mcnt++;
+
+    if (DLT_IS_HTYP_WTMS(msg.standardheader->htyp))
+    {
+        uint32_t tmsp = DLT_HTOBE_32(dlt_uptime());
+
+        memcpy(msg.headerbuffer + sizeof(DltStorageHeader) + sizeof(DltStandardHeader)
+               + (DLT_IS_HTYP_WEID(msg.standardheader->htyp) ? DLT_SIZE_WEID : 0)
+               + (DLT_IS_HTYP_WSID(msg.standardheader->htyp) ? DLT_SIZE_WSID : 0), &tmsp, DLT_SIZE_WTMS);
+    }
+
     /* Fill out extended header, if extended header should be provided */
     if (DLT_IS_HTYP_UEH(msg.standardheader->htyp))
     {
-        /* with extended header */
+        /* with extended header, verbose flag, apid and ctid are already set */
         msg.extendedheader = (DltExtendedHeader*)(msg.headerbuffer + sizeof(DltStorageHeader) + sizeof(DltStandardHeader) + DLT_STANDARD_HEADER_EXTRA_SIZE(msg.standardheader->htyp)  );
 
+        msg.extendedheader->msin &= DLT_MSIN_VERB;
+
         switch (mtype)
         {
         case DLT_TYPE_LOG:
         {
-            msg.extendedheader->msin = (DLT_TYPE_LOG << DLT_MSIN_MSTP_SHIFT) | ((log->log_level << DLT_MSIN_MTIN_SHIFT) & DLT_MSIN_MTIN) ; /* messsage info */
+            msg.extendedheader->msin |= (DLT_TYPE_LOG << DLT_MSIN_MSTP_SHIFT) | ((log->log_level << DLT_MSIN_MTIN_SHIFT) & DLT_MSIN_MTIN) ; /* messsage info */
             break;
         }
         case DLT_TYPE_NW_TRACE:
         {
-            msg.extendedheader->msin = (DLT_TYPE_NW_TRACE << DLT_MSIN_MSTP_SHIFT) | ((log->trace_status << DLT_MSIN_MTIN_SHIFT) & DLT_MSIN_MTIN) ; /* messsage info */
+            msg.extendedheader->msin |= (DLT_TYPE_NW_TRACE << DLT_MSIN_MSTP_SHIFT) | ((log->trace_status << DLT_MSIN_MTIN_SHIFT) & DLT_MSIN_MTIN) ; /* messsage info */
             break;
         }
         default:
@@ -3623,22 +4363,7 @@ DltReturnValue dlt_user_log_send_log(DltContextData *log, int mtype)
         }
         }
 
-        /* If in verbose mode, set flag in header for verbose mode */
-        if (dlt_user.verbose_mode)
-        {
-            msg.extendedheader->msin |= DLT_MSIN_VERB;
-        }
-
         msg.extendedheader->noar = log->args_num;              /* number of arguments */
-        dlt_set_id(msg.extendedheader->apid,dlt_user.appID);       /* application id */
-        dlt_set_id(msg.extendedheader->ctid,log->handle->contextID);   /* context id */
-
-        msg.headersize = sizeof(DltStorageHeader) + sizeof(DltStandardHeader) + sizeof(DltExtendedHeader) + DLT_STANDARD_HEADER_EXTRA_SIZE(msg.standardheader->htyp);
-    }
-    else
-    {
-        /* without extended header */
-        msg.headersize = sizeof(DltStorageHeader) + sizeof(DltStandardHeader) + DLT_STANDARD_HEADER_EXTRA_SIZE(msg.standardheader->htyp);
     }
 
     len=msg.headersize - sizeof(DltStorageHeader) +log->size;
@@ -3656,7 +4381,8 @@ DltReturnValue dlt_user_log_send_log(DltContextData *log, int mtype)
     {
         if ((dlt_user.enable_local_print) || (dlt_user.local_print_mode == DLT_PM_FORCE_ON))
         {
-            if (dlt_user_print_msg(&msg, log) == DLT_RETURN_ERROR)
+            if ((dlt_set_storageheader(msg.storageheader,dlt_user.ecuID) == DLT_RETURN_ERROR) ||
+                (dlt_user_print_msg(&msg, log) == DLT_RETURN_ERROR))
             {
                 return DLT_RETURN_ERROR;
             }
@@ -3665,10 +4391,31 @@ DltReturnValue dlt_user_log_send_log(DltContextData *log, int mtype)
 
     if (dlt_user.dlt_is_file)
     {
-        /* log to file */
+        /* log to file, including the storage header */
+        if (dlt_set_storageheader(msg.storageheader,dlt_user.ecuID) == DLT_RETURN_ERROR)
+        {
+            return DLT_RETURN_ERROR;
+        }
+
         ret=dlt_user_log_out2(dlt_user.dlt_log_handle, msg.headerbuffer, msg.headersize, log->buffer, log->size);
         return ret;
     }
+    else if (dlt_user_async.enabled && (dlt_user.appID[0] != '\0'))
+    {
+        /* the flusher thread sends the message */
+        ret = dlt_user_async_push((unsigned char *)&(userheader), sizeof(DltUserHeader),
+                                  msg.headerbuffer+sizeof(DltStorageHeader), msg.headersize-sizeof(DltStorageHeader),
+                                  log->buffer, log->size);
+        if (ret == DLT_RETURN_BUFFER_FULL)
+        {
+            if(dlt_user.overflow_counter == 0)
+            {
+                dlt_log(LOG_WARNING,"Buffer full! Messages will be discarded.\n");
+            }
+            dlt_user.overflow_counter += 1;
+        }
+        return ret;
+    }
     else
     {
         /* Reattach to daemon if neccesary */
@@ -3693,15 +4440,23 @@ DltReturnValue dlt_user_log_send_log(DltContextData *log, int mtype)
 		{
 			/* resend ok or nothing to resent */
 #ifdef DLT_SHM_ENABLE
-            if(dlt_user.dlt_log_handle!=-1)
-                dlt_shm_push(&dlt_user.dlt_shm,msg.headerbuffer+sizeof(DltStorageHeader), msg.headersize-sizeof(DltStorageHeader),
-                                            log->buffer, log->size, 0, 0);
+            DltUserShm *ring = dlt_user_shm_get();
 
-            ret = dlt_user_log_out3(dlt_user.dlt_log_handle,
-                                    &(userheader), sizeof(DltUserHeader),
-                                    0, 0,
-                                    0, 0);
-#else
+            if (ring != NULL)
+            {
+                /* a full ring is handled like a full socket */
+                ret = dlt_shm_push(&ring->shm,
+                                   (unsigned char *)&(userheader), sizeof(DltUserHeader),
+                                   msg.headerbuffer+sizeof(DltStorageHeader), msg.headersize-sizeof(DltStorageHeader),
+                                   log->buffer, log->size);
+                if (ret == DLT_RETURN_BUFFER_FULL)
+                {
+                    ret = DLT_RETURN_PIPE_FULL;
+                }
+            }
+            else
+#endif
+            {
 #ifdef DLT_TEST_ENABLE
             if(dlt_user.corrupt_user_header) {
                 userheader.pattern[0]=0xff;
@@ -3717,7 +4472,7 @@ DltReturnValue dlt_user_log_send_log(DltContextData *log, int mtype)
                                     &(userheader), sizeof(DltUserHeader),
                                     msg.headerbuffer+sizeof(DltStorageHeader), msg.headersize-sizeof(DltStorageHeader),
                                     log->buffer, log->size);
-#endif
+            }
         }
 
         /* store message in ringbuffer, if an error has occured */
@@ -3773,13 +4528,9 @@ DltReturnValue dlt_user_log_send_log(DltContextData *log, int mtype)
                 dlt_user.dlt_log_handle = -1;
                 dlt_user.connection_state = DLT_USER_RETRY_CONNECT;
 
-    #ifdef DLT_SHM_ENABLE
-                /* free shared memory */
-                dlt_shm_free_client(&dlt_user.dlt_shm);
-    #endif
-
                 if (dlt_user.local_print_mode == DLT_PM_AUTOMATIC)
                 {
+                    dlt_set_storageheader(msg.storageheader,dlt_user.ecuID);
                     dlt_user_print_msg(&msg, log);
                 }
 
@@ -4276,6 +5027,11 @@ DltReturnValue dlt_user_log_check_user_message(void)
                     {
                         DLT_SEM_LOCK();
 
+#ifndef DLT_USE_UNIX_SOCKET_IPC
+                        /* the daemon sends a message before it changes levels only in the table */
+                        dlt_user_log_level_table_attach();
+#endif
+
                         if ((usercontextll->log_level_pos >= 0) &&
                                         (usercontextll->log_level_pos < (int32_t)dlt_user.dlt_ll_ts_num_entries))
                         {
@@ -4284,10 +5040,7 @@ DltReturnValue dlt_user_log_check_user_message(void)
                             {
                                 dlt_user.dlt_ll_ts[usercontextll->log_level_pos].log_level = usercontextll->log_level;
                                 dlt_user.dlt_ll_ts[usercontextll->log_level_pos].trace_status = usercontextll->trace_status;
-                                if(dlt_user.dlt_ll_ts[usercontextll->log_level_pos].log_level_ptr)
-                                    *(dlt_user.dlt_ll_ts[usercontextll->log_level_pos].log_level_ptr) = usercontextll->log_level;
-                                if(dlt_user.dlt_ll_ts[usercontextll->log_level_pos].trace_status_ptr)
-                                    *(dlt_user.dlt_ll_ts[usercontextll->log_level_pos].trace_status_ptr) = usercontextll->trace_status;
+                                dlt_user_log_level_set(&dlt_user.dlt_ll_ts[usercontextll->log_level_pos]);
 
                                 delayed_log_level_changed_callback.log_level_changed_callback = dlt_user.dlt_ll_ts[usercontextll->log_level_pos].log_level_changed_callback;
                                 memcpy(delayed_log_level_changed_callback.contextID,dlt_user.dlt_ll_ts[usercontextll->log_level_pos].contextID,DLT_ID_SIZE);
@@ -4482,13 +5235,7 @@ DltReturnValue dlt_user_log_resend_buffer(void)
                 }
             }
 
-#ifdef DLT_SHM_ENABLE
-            dlt_shm_push(&dlt_user.dlt_shm, dlt_user.resend_buffer+sizeof(DltUserHeader), size-sizeof(DltUserHeader), 0, 0, 0, 0);
-
-            ret = dlt_user_log_out3(dlt_user.dlt_log_handle, dlt_user.resend_buffer,sizeof(DltUserHeader), 0, 0, 0, 0);
-#else
             ret = dlt_user_log_out3(dlt_user.dlt_log_handle, dlt_user.resend_buffer,size, 0, 0, 0, 0);
-#endif
 
             /* in case of error, keep message in ringbuffer */
             if (ret == DLT_RETURN_OK)
@@ -4544,15 +5291,6 @@ void dlt_user_log_reattach_to_daemon(void)
             return;
         }
 
-#ifdef DLT_SHM_ENABLE
-        /* init shared memory */
-        if (dlt_shm_init_client(&dlt_user.dlt_shm,DLT_SHM_KEY) < 0)
-        {
-            dlt_vnlog(LOG_WARNING, DLT_USER_BUFFER_LENGTH, "Loging disabled, Shared memory %d cannot be created!\n", DLT_SHM_KEY);
-            //return DLT_RETURN_OK;
-        }
-#endif
-
         dlt_log(LOG_NOTICE, "Logging (re-)enabled!\n");
 
         /* Re-register application */
@@ -4634,17 +5372,44 @@ DltReturnValue dlt_user_check_buffer(int *total_size, int *used_size)
     if(total_size == NULL || used_size == NULL)
         return DLT_RETURN_WRONG_PARAMETER;
 
+    int async = dlt_user_async.enabled;
+
+    if (async)
+    {
+        pthread_mutex_lock(&(dlt_user_async.mutex));
+    }
+
     DLT_SEM_LOCK();
 
-#ifdef DLT_SHM_ENABLE
-    *total_size = dlt_shm_get_total_size(&(dlt_user.dlt_shm));
-    *used_size = dlt_shm_get_used_size(&(dlt_user.dlt_shm));
-#else
     *total_size = dlt_buffer_get_total_size(&(dlt_user.startup_buffer));
     *used_size = dlt_buffer_get_used_size(&(dlt_user.startup_buffer));
+
+#ifdef DLT_SHM_ENABLE
+    {
+        /* add the ring of the calling thread */
+        DltUserShm *ring = (DltUserShm *)pthread_getspecific(dlt_user_shm_key);
+
+        if (ring != NULL)
+        {
+            *total_size += dlt_shm_get_total_size(&(ring->shm));
+            *used_size += dlt_shm_get_used_size(&(ring->shm));
+        }
+    }
 #endif
 
+    if (async)
+    {
+        *total_size += 2 * dlt_user_async.size;
+        *used_size += dlt_user_async.used + dlt_user_async.flush_used - dlt_user_async.flush_offset;
+    }
+
     DLT_SEM_FREE();
+
+    if (async)
+    {
+        pthread_mutex_unlock(&(dlt_user_async.mutex));
+    }
+
     return DLT_RETURN_OK; /* ok */
 }
 
@@ -4661,6 +5426,432 @@ void dlt_user_test_corrupt_message_size(int enable,int16_t size)
 #endif
 
 
+/* Size of a message in the asynchronous buffer, including its length */
+#define DLT_USER_ASYNC_RECORD_SIZE(len) ((sizeof(uint32_t) + (len) + 3) & ~3u)
+
+static DltReturnValue dlt_user_async_init(void)
+{
+    DltUserAsync *async = &dlt_user_async;
+    pthread_condattr_t attr;
+
+    async->size = DLT_USER_ASYNC_BUFFER_SIZE;
+    if ((async->watermark == 0) || (async->watermark > async->size))
+    {
+        async->watermark = DLT_USER_ASYNC_WATERMARK;
+    }
+    if (async->latency == 0)
+    {
+        async->latency = DLT_USER_ASYNC_LATENCY;
+    }
+
+    async->buffer[0] = malloc(async->size);
+    async->buffer[1] = malloc(async->size);
+    if ((async->buffer[0] == NULL) || (async->buffer[1] == NULL))
+    {
+        dlt_log(LOG_ERR, "Cannot allocate asynchronous buffer\n");
+        dlt_user_async_free();
+        return DLT_RETURN_ERROR;
+    }
+
+    async->active = 0;
+    async->used = 0;
+    async->flush_used = 0;
+    async->flush_offset = 0;
+    async->spill = 0;
+    async->stop = 0;
+    async->flush_now = 0;
+    async->thread = 0;
+
+    /* latency is measured with the monotonic clock */
+    pthread_mutex_init(&(async->mutex), NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&(async->cond), &attr);
+    pthread_condattr_destroy(&attr);
+
+    async->enabled = 1;
+
+    dlt_vlog(LOG_INFO, "Asynchronous mode enabled, watermark %u bytes, latency %u ms\n",
+             async->watermark, async->latency);
+
+    return DLT_RETURN_OK;
+}
+
+static void dlt_user_async_free(void)
+{
+    DltUserAsync *async = &dlt_user_async;
+
+    /* called after the flusher thread was stopped, also in a forked child */
+    if (async->enabled)
+    {
+        pthread_cond_destroy(&(async->cond));
+        pthread_mutex_destroy(&(async->mutex));
+    }
+
+    async->enabled = 0;
+    free(async->buffer[0]);
+    free(async->buffer[1]);
+    async->buffer[0] = NULL;
+    async->buffer[1] = NULL;
+    async->used = 0;
+    async->flush_used = 0;
+    async->flush_offset = 0;
+}
+
+static DltReturnValue dlt_user_async_push(const unsigned char *data1, uint32_t size1,
+                                          const unsigned char *data2, uint32_t size2,
+                                          const unsigned char *data3, uint32_t size3)
+{
+    DltUserAsync *async = &dlt_user_async;
+    DltReturnValue ret = DLT_RETURN_OK;
+    uint32_t len = size1 + size2 + size3;
+    uint32_t record = DLT_USER_ASYNC_RECORD_SIZE(len);
+
+    pthread_mutex_lock(&(async->mutex));
+
+    if (!async->spill && (record <= async->size - async->used))
+    {
+        unsigned char *ptr = async->buffer[async->active] + async->used;
+
+        memcpy(ptr, &len, sizeof(uint32_t));
+        ptr += sizeof(uint32_t);
+        memcpy(ptr, data1, size1);
+        memcpy(ptr + size1, data2, size2);
+        memcpy(ptr + size1 + size2, data3, size3);
+
+        /* wake up the flusher to start the latency timer or to send at the watermark */
+        if ((async->used == 0) ||
+            ((async->used < async->watermark) && (async->used + record >= async->watermark)))
+        {
+            pthread_cond_signal(&(async->cond));
+        }
+
+        async->used += record;
+    }
+    else
+    {
+        /* Buffer is full: continue in the startup buffer until the flusher
+         * has sent everything, so the order of the messages is kept */
+        if (!async->spill)
+        {
+            async->spill = 1;
+            pthread_cond_signal(&(async->cond));
+        }
+
+        DLT_SEM_LOCK();
+        if (dlt_buffer_push3(&(dlt_user.startup_buffer), data1, size1, data2, size2, data3, size3) == DLT_RETURN_ERROR)
+        {
+            ret = DLT_RETURN_BUFFER_FULL;
+        }
+        DLT_SEM_FREE();
+    }
+
+    pthread_mutex_unlock(&(async->mutex));
+
+    return ret;
+}
+
+/* Send the flushing buffer, called by the flusher thread without holding the mutex */
+static DltReturnValue dlt_user_async_send(int spill)
+{
+    DltUserAsync *async = &dlt_user_async;
+    unsigned char *buffer = async->buffer[1 - async->active];
+    struct iovec iov[DLT_USER_ASYNC_MAX_IOV];
+    DltReturnValue ret;
+
+    /* Reattach to daemon if neccesary */
+    dlt_user_log_reattach_to_daemon();
+
+    if (dlt_user.dlt_log_handle == -1)
+    {
+        return DLT_RETURN_PIPE_ERROR;
+    }
+
+    if (dlt_user.overflow_counter)
+    {
+        if (dlt_user_log_send_overflow() == DLT_RETURN_OK)
+        {
+            dlt_vnlog(LOG_WARNING, DLT_USER_BUFFER_LENGTH, "%u messages discarded!\n", dlt_user.overflow_counter);
+            dlt_user.overflow_counter = 0;
+        }
+    }
+
+    /* Messages in the startup buffer are older, unless they were spilled
+     * there while the buffers were full. Those follow the buffered ones. */
+    if (!spill || (async->flush_used == 0))
+    {
+        ret = dlt_user_log_resend_buffer();
+        if (ret != DLT_RETURN_OK)
+        {
+            return ret;
+        }
+    }
+
+    while (async->flush_offset < async->flush_used)
+    {
+        uint32_t offset = async->flush_offset;
+        uint32_t total = 0;
+        int iovcnt = 0;
+
+        /* Batches up to PIPE_BUF bytes are written atomically, so the daemon
+         * never receives a part of a message */
+        while ((offset < async->flush_used) && (iovcnt < DLT_USER_ASYNC_MAX_IOV))
+        {
+            uint32_t len;
+
+            memcpy(&len, buffer + offset, sizeof(uint32_t));
+            if ((iovcnt > 0) && (total + len > PIPE_BUF))
+            {
+                break;
+            }
+
+            iov[iovcnt].iov_base = buffer + offset + sizeof(uint32_t);
+            iov[iovcnt].iov_len = len;
+            iovcnt++;
+            total += len;
+            offset += DLT_USER_ASYNC_RECORD_SIZE(len);
+        }
+
+        ret = dlt_user_log_outv(dlt_user.dlt_log_handle, iov, iovcnt);
+        if (ret != DLT_RETURN_OK)
+        {
+            return ret;
+        }
+
+        async->flush_offset = offset;
+    }
+
+    return DLT_RETURN_OK;
+}
+
+static void dlt_user_async_wait(uint32_t ms)
+{
+    DltUserAsync *async = &dlt_user_async;
+    struct timespec deadline;
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += ms / 1000;
+    deadline.tv_nsec += (ms % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    while (!async->stop && !async->spill && !async->flush_now &&
+           (async->used < async->watermark))
+    {
+        if (pthread_cond_timedwait(&(async->cond), &(async->mutex), &deadline) == ETIMEDOUT)
+        {
+            break;
+        }
+    }
+}
+
+static void dlt_user_async_flusher(void *ptr)
+{
+    DltUserAsync *async = &dlt_user_async;
+    DltReturnValue ret = DLT_RETURN_OK;
+    int stop, spill;
+
+    (void) ptr;
+
+#ifdef linux
+    prctl(PR_SET_NAME, "dlt_flusher", 0, 0, 0);
+#endif
+
+    pthread_mutex_lock(&(async->mutex));
+
+    while (1)
+    {
+        if (ret != DLT_RETURN_OK)
+        {
+            /* daemon not reachable or busy, try again later */
+            async->flush_now = 0;
+            dlt_user_async_wait(async->latency);
+        }
+        else if (async->flush_used == async->flush_offset)
+        {
+            /* wait for the first message, then for the latency or the watermark */
+            while (!async->stop && !async->spill && (async->used == 0))
+            {
+                pthread_cond_wait(&(async->cond), &(async->mutex));
+            }
+            dlt_user_async_wait(async->latency);
+        }
+
+        /* swap buffers, log calls continue in the empty one */
+        if (async->flush_used == async->flush_offset)
+        {
+            async->flush_used = async->used;
+            async->flush_offset = 0;
+            async->used = 0;
+            async->active = 1 - async->active;
+            async->flush_now = 0;
+        }
+
+        stop = async->stop;
+        spill = async->spill;
+
+        pthread_mutex_unlock(&(async->mutex));
+
+        ret = dlt_user_async_send(spill);
+        if (ret == DLT_RETURN_PIPE_ERROR && dlt_user.dlt_log_handle != -1)
+        {
+            /* handle not open or pipe error */
+            close(dlt_user.dlt_log_handle);
+            dlt_user.dlt_log_handle = -1;
+            dlt_user.connection_state = DLT_USER_RETRY_CONNECT;
+        }
+
+        pthread_mutex_lock(&(async->mutex));
+
+        if ((ret == DLT_RETURN_OK) && (async->flush_used == async->flush_offset))
+        {
+            async->flush_used = 0;
+            async->flush_offset = 0;
+
+            /* all buffered messages are sent, go on with the buffers once the
+             * spilled messages are sent as well */
+            if (async->spill && (async->used == 0))
+            {
+                DLT_SEM_LOCK();
+                if (dlt_buffer_get_message_count(&(dlt_user.startup_buffer)) == 0)
+                {
+                    async->spill = 0;
+                }
+                DLT_SEM_FREE();
+            }
+        }
+
+        if (stop && ((ret != DLT_RETURN_OK) || ((async->flush_used == 0) && (async->used == 0))))
+        {
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&(async->mutex));
+}
+
+static int dlt_user_async_start_thread(void)
+{
+    DltUserAsync *async = &dlt_user_async;
+
+    if (!async->enabled)
+    {
+        return 0;
+    }
+
+    async->stop = 0;
+
+    if (pthread_create(&(async->thread), NULL, (void *) dlt_user_async_flusher, NULL) != 0)
+    {
+        async->thread = 0;
+        return -1;
+    }
+
+    return 0;
+}
+
+static void dlt_user_async_stop_thread(void)
+{
+    DltUserAsync *async = &dlt_user_async;
+
+    if (!async->enabled || !async->thread)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&(async->mutex));
+    async->stop = 1;
+    pthread_cond_signal(&(async->cond));
+    pthread_mutex_unlock(&(async->mutex));
+
+    if (pthread_join(async->thread, NULL) != 0)
+    {
+        dlt_vlog(LOG_ERR, "ERROR pthread_join(flusher thread, NULL): %s\n", strerror(errno));
+    }
+    async->thread = 0;
+}
+
+static void dlt_user_async_disable(void)
+{
+    DltUserAsync *async = &dlt_user_async;
+    int i;
+
+    if (!async->enabled)
+    {
+        return;
+    }
+
+    dlt_user_async_stop_thread();
+
+    /* Move messages the flusher could not send to the startup buffer.
+     * Log calls entering after this point go to the startup buffer as well. */
+    pthread_mutex_lock(&(async->mutex));
+
+    async->spill = 1;
+
+    for (i = 0; i < 2; i++)
+    {
+        unsigned char *buffer = async->buffer[(i == 0) ? 1 - async->active : async->active];
+        uint32_t offset = (i == 0) ? async->flush_offset : 0;
+        uint32_t used = (i == 0) ? async->flush_used : async->used;
+
+        while (offset < used)
+        {
+            uint32_t len;
+
+            memcpy(&len, buffer + offset, sizeof(uint32_t));
+
+            DLT_SEM_LOCK();
+            if (dlt_buffer_push(&(dlt_user.startup_buffer), buffer + offset + sizeof(uint32_t), len) == DLT_RETURN_ERROR)
+            {
+                dlt_user.overflow_counter += 1;
+            }
+            DLT_SEM_FREE();
+
+            offset += DLT_USER_ASYNC_RECORD_SIZE(len);
+        }
+    }
+
+    async->used = 0;
+    async->flush_used = 0;
+    async->flush_offset = 0;
+
+    pthread_mutex_unlock(&(async->mutex));
+}
+
+static void dlt_user_async_sync(void)
+{
+    DltUserAsync *async = &dlt_user_async;
+    uint32_t exitTime = dlt_uptime() + dlt_user.timeout_at_exit_handler;
+    int pending;
+
+    if (!async->enabled || !async->thread)
+    {
+        return;
+    }
+
+    /* wait until the flusher has sent all messages, as long as the daemon is reachable */
+    do
+    {
+        pthread_mutex_lock(&(async->mutex));
+        pending = (async->used != 0) || (async->flush_used != 0) || async->spill;
+        if (pending)
+        {
+            async->flush_now = 1;
+            pthread_cond_signal(&(async->cond));
+        }
+        pthread_mutex_unlock(&(async->mutex));
+
+        if (pending)
+        {
+            usleep(async->latency * 1000);
+        }
+    } while (pending && (dlt_user.dlt_log_handle != -1) && (dlt_uptime() < exitTime));
+}
+
 int dlt_start_threads()
 {
     /* Start receiver thread */
@@ -4681,6 +5872,13 @@ int dlt_start_threads()
         return -1;
     }
 
+    /* Start the flusher thread of asynchronous mode */
+    if (dlt_user_async_start_thread() < 0)
+    {
+        dlt_log(LOG_CRIT, "Can't start flusher thread!\n");
+        return -1;
+    }
+
     return 0;
 }
 
@@ -4739,6 +5937,9 @@ void dlt_stop_threads()
         }
         dlt_user.dlt_segmented_nwt_handle = 0; /* set to invalid */
     }
+
+    /* the flusher thread is not cancelled, it sends what it can and stops */
+    dlt_user_async_stop_thread();
 }
 
 static void dlt_fork_pre_fork_handler()
@@ -85,6 +85,9 @@
 #define DLT_USER_ENV_BUFFER_MAX_SIZE  "DLT_USER_BUFFER_MAX"
 #define DLT_USER_ENV_BUFFER_STEP_SIZE "DLT_USER_BUFFER_STEP"
 
+/* Name of environment variable for the size of the shared memory ring of each thread */
+#define DLT_USER_ENV_SHM_RING_SIZE    "DLT_USER_SHM_RING_SIZE"
+
 /* Temporary buffer length */
 #define DLT_USER_BUFFER_LENGTH               255
 
@@ -134,6 +137,32 @@
 /* Name of environment variable for local print mode */
 #define DLT_USER_ENV_LOCAL_PRINT_MODE "DLT_LOCAL_PRINT_MODE"
 
+/* Size of each of the two buffers used in asynchronous mode */
+#define DLT_USER_ASYNC_BUFFER_SIZE 65536
+
+/* Fill level in bytes of the asynchronous buffer which wakes up the flusher thread */
+#define DLT_USER_ASYNC_WATERMARK 16384
+
+/* Maximum time in ms a message waits in the asynchronous buffer */
+#define DLT_USER_ASYNC_LATENCY 10
+
+/* Maximum size of standard header (4), standard header extra (12) and extended header (10) */
+#define DLT_USER_HEADER_TEMPLATE_SIZE 26
+
+/* Number of header templates allocated at once */
+#define DLT_USER_HEADER_CHUNK_SIZE 256
+
+/* Maximum number of chunks of header templates, later contexts build their header per message */
+#define DLT_USER_HEADER_CHUNKS 1024
+
+/* Maximum number of messages sent with one write in asynchronous mode */
+#define DLT_USER_ASYNC_MAX_IOV 128
+
+/* Name of environment variables for asynchronous mode */
+#define DLT_USER_ENV_ASYNC           "DLT_USER_ASYNC"
+#define DLT_USER_ENV_ASYNC_WATERMARK "DLT_USER_ASYNC_WATERMARK"
+#define DLT_USER_ENV_ASYNC_LATENCY   "DLT_USER_ASYNC_LATENCY"
+
 /* Timeout offset for resending user buffer at exit in 10th milliseconds (10000 = 1s)*/
 #define DLT_USER_ATEXIT_RESEND_BUFFER_EXIT_TIMEOUT 100000
 
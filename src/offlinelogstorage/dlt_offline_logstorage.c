@@ -39,49 +39,215 @@
 #define DLT_OFFLINE_LOGSTORAGE_STORE_FILTER_ERROR 2
 
 #define GENERAL_BASE_NAME "General"
-/* Hash map functions */
+/* Filter table functions */
 
-static int dlt_logstorage_hash_create(int num_entries, struct hsearch_data *htab)
+static int dlt_logstorage_table_create(DltLogStorage *handle, unsigned int size)
 {
-    memset(htab, 0, sizeof(*htab));
+    handle->filter_table = calloc(size, sizeof(DltLogStorageFilterEntry));
 
-    if (hcreate_r(num_entries, htab) == 0)
+    if (handle->filter_table == NULL)
         return -1;
 
+    handle->filter_table_size = size;
+    handle->filter_table_used = 0;
+    handle->filter_table_cached = 0;
+
     return 0;
 }
 
-static int dlt_logstorage_hash_destroy(struct hsearch_data *htab)
+static void dlt_logstorage_table_destroy(DltLogStorage *handle)
 {
-    hdestroy_r(htab);
+    free(handle->filter_table);
+    handle->filter_table = NULL;
+    handle->filter_table_size = 0;
+    handle->filter_table_used = 0;
+    handle->filter_table_cached = 0;
+}
 
-    return 0;
+/* Build the table key of up to 4 characters of apid and ctid, ids are
+ * compared up to their first '\0' like strings */
+static uint64_t dlt_logstorage_table_key(const char *apid, const char *ctid)
+{
+    uint8_t id[2 * DLT_ID_SIZE] = {0};
+    uint64_t key = 0;
+    int i;
+
+    for (i = 0; (apid != NULL) && (i < DLT_ID_SIZE) && (apid[i] != '\0'); i++)
+        id[i] = (uint8_t)apid[i];
+
+    for (i = 0; (ctid != NULL) && (i < DLT_ID_SIZE) && (ctid[i] != '\0'); i++)
+        id[DLT_ID_SIZE + i] = (uint8_t)ctid[i];
+
+    for (i = 0; i < (2 * DLT_ID_SIZE); i++)
+        key |= (uint64_t)id[i] << (8 * i);
+
+    return key;
+}
+
+/* Build the table key of a filter key "APID:CTID", "APID:" or ":CTID" */
+static uint64_t dlt_logstorage_table_key_of_string(const char *str)
+{
+    char apid[DLT_ID_SIZE + 1] = {0};
+    const char *sep = strchr(str, ':');
+
+    if (sep == NULL)
+        return dlt_logstorage_table_key(str, NULL);
+
+    strncpy(apid, str, DLT_OFFLINE_LOGSTORAGE_MIN(sep - str, DLT_ID_SIZE));
+
+    return dlt_logstorage_table_key(apid, sep + 1);
 }
 
-static int dlt_logstorage_hash_add(char *key, void *value, struct hsearch_data *htab)
+/* Find the slot of a key, or the empty slot where it belongs */
+static DltLogStorageFilterEntry *dlt_logstorage_table_probe(DltLogStorage *handle, uint64_t key)
 {
-    ENTRY e, *ep;
+    unsigned int mask = handle->filter_table_size - 1;
+    uint64_t h = key * 0x9E3779B97F4A7C15ULL;
+    unsigned int idx = (unsigned int)(h >> 32) & mask;
+
+    while ((handle->filter_table[idx].key != 0) &&
+           (handle->filter_table[idx].key != key))
+    {
+        idx = (idx + 1) & mask;
+    }
 
-    memset(&e, 0, sizeof(ENTRY));
-    e.key = key;
-    e.data = value;
+    return &(handle->filter_table[idx]);
+}
 
-    if (hsearch_r(e, ENTER, &ep, htab) == 0)
+/* Move the slots to a new table of the given size. If cache is not set,
+ * only slots of configured filters are kept and their matches are dropped. */
+static int dlt_logstorage_table_rehash(DltLogStorage *handle, unsigned int size, int cache)
+{
+    DltLogStorageFilterEntry *old = handle->filter_table;
+    unsigned int old_size = handle->filter_table_size;
+    unsigned int old_used = handle->filter_table_used;
+    unsigned int old_cached = handle->filter_table_cached;
+    DltLogStorageFilterEntry *entry = NULL;
+    unsigned int i;
+
+    if (dlt_logstorage_table_create(handle, size) != 0)
+    {
+        handle->filter_table = old;
+        handle->filter_table_size = old_size;
+        handle->filter_table_used = old_used;
+        handle->filter_table_cached = old_cached;
         return -1;
+    }
+
+    for (i = 0; i < old_size; i++)
+    {
+        if ((old[i].key == 0) || (!cache && (old[i].filter == NULL)))
+            continue;
+
+        entry = dlt_logstorage_table_probe(handle, old[i].key);
+        *entry = old[i];
+        handle->filter_table_used++;
+
+        if (entry->filter == NULL)
+            handle->filter_table_cached++;
+
+        if (!cache)
+        {
+            entry->resolved = 0;
+            entry->num_config = 0;
+        }
+    }
+
+    free(old);
 
     return 0;
 }
 
-static void *dlt_logstorage_hash_find(char *key, struct hsearch_data *htab)
+/* Get the slot of a key, a new slot is added if the key is not present */
+static DltLogStorageFilterEntry *dlt_logstorage_table_add(DltLogStorage *handle, uint64_t key)
 {
-    ENTRY e, *ep;
+    DltLogStorageFilterEntry *entry = NULL;
 
-    e.key = key;
+    entry = dlt_logstorage_table_probe(handle, key);
 
-    if (hsearch_r(e, FIND, &ep, htab) != 0)
-        return ep->data;
-    else
+    if (entry->key != 0)
+        return entry;
+
+    /* keep the load below 3/4 */
+    if (((handle->filter_table_used + 1) * 4) > (handle->filter_table_size * 3))
+    {
+        if (dlt_logstorage_table_rehash(handle, handle->filter_table_size * 2, 1) != 0)
+            return NULL;
+
+        entry = dlt_logstorage_table_probe(handle, key);
+    }
+
+    memset(entry, 0, sizeof(DltLogStorageFilterEntry));
+    entry->key = key;
+    handle->filter_table_used++;
+
+    return entry;
+}
+
+/* Get the filters matching a key, computed once and cached in its slot, also
+ * if no filter matches. Returns NULL if no filter matches the key. */
+static DltLogStorageFilterEntry *dlt_logstorage_table_lookup(DltLogStorage *handle, uint64_t key)
+{
+    DltLogStorageFilterEntry *entry = NULL;
+    DltLogStorageFilterEntry *wildcard = NULL;
+    DltLogStorageConfigData *config[3] = {NULL, NULL, NULL};
+    uint64_t keys[2];
+    int i;
+
+    if ((key == 0) || (handle->filter_table == NULL))
         return NULL;
+
+    entry = dlt_logstorage_table_probe(handle, key);
+
+    if ((entry->key == key) && entry->resolved)
+        return (entry->num_config > 0) ? entry : NULL;
+
+    /* first message with these ids: apid:, :ctid and apid:ctid */
+    keys[0] = key & 0xFFFFFFFFULL;
+    keys[1] = key & ~0xFFFFFFFFULL;
+
+    for (i = 0; i < 2; i++)
+    {
+        if ((keys[i] != 0) && (keys[i] != key))
+        {
+            wildcard = dlt_logstorage_table_probe(handle, keys[i]);
+
+            if (wildcard->key == keys[i])
+                config[i] = wildcard->filter;
+        }
+    }
+
+    if (entry->key == key)
+    {
+        config[2] = entry->filter;
+    }
+    else
+    {
+        /* the cache is bounded, else the table would grow with every
+         * apid/ctid pair ever logged */
+        if ((handle->filter_table_cached >= DLT_OFFLINE_LOGSTORAGE_FILTER_CACHE_MAX) &&
+            (dlt_logstorage_table_rehash(handle, handle->filter_table_size, 0) != 0))
+            return NULL;
+
+        entry = dlt_logstorage_table_add(handle, key);
+
+        if (entry == NULL)
+            return NULL;
+
+        handle->filter_table_cached++;
+    }
+
+    entry->num_config = 0;
+
+    for (i = 0; i < 3; i++)
+    {
+        if (config[i] != NULL)
+            entry->config[entry->num_config++] = config[i];
+    }
+
+    entry->resolved = 1;
+
+    return (entry->num_config > 0) ? entry : NULL;
 }
 
 /* Configuration file parsing helper functions */
@@ -340,6 +506,11 @@ int dlt_logstorage_set_sync_strategy(int *strategy, char *value)
         *strategy = DLT_LOGSTORAGE_SYNC_ON_MSG;
         dlt_log(LOG_DEBUG, "ON_MSG found, ignore other if added\n");
     }
+    else if (strcasestr(value, "ON_GROUP_COMMIT") != NULL)
+    {
+        *strategy = DLT_LOGSTORAGE_SYNC_ON_GROUP_COMMIT;
+        dlt_log(LOG_DEBUG, "ON_GROUP_COMMIT found, ignore other if added\n");
+    }
     else /* ON_MSG not set, combination of cache based strategies possible */
     {
         if (strcasestr(value, "ON_DAEMON_EXIT") != NULL)
@@ -400,7 +571,7 @@ int dlt_logstorage_set_ecuid(char **ecuid, char *value)
 /**
  * dlt_logstorage_create_keys
  *
- * Create keys for hash table
+ * Create keys for filter table
  *
  * From each section [filter] in offline logstorage configuration file, we receive
  * application and context id strings.
@@ -418,7 +589,7 @@ int dlt_logstorage_set_ecuid(char **ecuid, char *value)
  *
  * @param[in]: appids: string given from filter configuration
  * @param[in]: ctxids: string given from filter configuration
- * @param[out]: keys: keys to fill into hash table
+ * @param[out]: keys: keys to fill into filter table
  * @param[out]: num_keys: number of keys
  * @return: 0 on success, error on failure*
  */
@@ -581,9 +752,14 @@ int dlt_logstorage_device_connected(DltLogStorage *handle, char *mount_point)
     handle->config_status = 0;
     handle->write_errors = 0;
     handle->num_filter_keys = 0;
+    handle->files_read = 0;
 
     handle->config_data = NULL;
     handle->filter_keys = NULL;
+    handle->filter_table = NULL;
+    handle->filter_table_size = 0;
+    handle->filter_table_used = 0;
+    handle->filter_table_cached = 0;
 
     return 0;
 }
@@ -601,7 +777,7 @@ void dlt_logstorage_free(DltLogStorage *handle, int reason)
 {
     int i=0;
 
-    dlt_logstorage_hash_destroy(&(handle->config_htab));
+    dlt_logstorage_table_destroy(handle);
 
     for(i=0; i<handle->num_filter_keys; i++)
     {
@@ -611,6 +787,8 @@ void dlt_logstorage_free(DltLogStorage *handle, int reason)
                 &(handle->config_data[i].data),
                 reason);
 
+        dlt_logstorage_group_commit_statistics(&(handle->config_data[i].data));
+
         free(handle->config_data[i].data.file_name);
 
         if (handle->config_data[i].data.ecuid != NULL)
@@ -623,19 +801,15 @@ void dlt_logstorage_free(DltLogStorage *handle, int reason)
             fclose(handle->config_data[i].data.log);
         }
 
-        if (handle->config_data[i].data.cache != NULL)
-        {
-            free(handle->config_data[i].data.cache);
-        }
+        dlt_logstorage_free_msg_cache(&(handle->config_data[i].data));
 
-        DltLogStorageFileList *n = handle->config_data[i].data.records;
-        while(n)
+        if (handle->config_data[i].data.group_commit != NULL)
         {
-            DltLogStorageFileList *n1 = n;
-            n = n->next;
-            free(n1->name);
-            free(n1);
+            free(handle->config_data[i].data.group_commit->buffer);
+            free(handle->config_data[i].data.group_commit);
         }
+
+        dlt_logstorage_file_list_free(&(handle->config_data[i].data.records));
     }
 
     free(handle->config_data);
@@ -673,6 +847,7 @@ int dlt_logstorage_device_disconnected(DltLogStorage *handle, int reason)
     handle->config_status = 0;
     handle->write_errors = 0;
     handle->num_filter_keys = 0;
+    handle->files_read = 0;
 
     return 0;
 }
@@ -680,7 +855,7 @@ int dlt_logstorage_device_disconnected(DltLogStorage *handle, int reason)
 /**
  * dlt_logstorage_prepare_table
  *
- * Prepares hash table with keys and data
+ * Prepares filter table with keys and data
  *
  * @param handle         DLT Logstorage handle
  * @param appid          Application ID value provided in configuration file
@@ -695,6 +870,7 @@ int dlt_logstorage_prepare_table(DltLogStorage *handle, char *appid, char *ctxid
     int num_keys = 0;
     char *keys = NULL;
     int idx = 0;
+    DltLogStorageFilterEntry *entry = NULL;
 
     /* Allocate memory for filters */
     if(handle->config_data == NULL)
@@ -709,11 +885,11 @@ int dlt_logstorage_prepare_table(DltLogStorage *handle, char *appid, char *ctxid
     ret = dlt_logstorage_create_keys(appid, ctxid, &keys, &num_keys);
     if (ret != 0)
     {
-        dlt_log(LOG_ERR, "Not able to create keys for hash table\n");
+        dlt_log(LOG_ERR, "Not able to create keys for filter table\n");
         return -1;
     }
 
-    /* hash_add */
+    /* table_add */
     for (idx=0; idx<num_keys; idx++)
     {
         DltLogStorageConfig *p_node = NULL;
@@ -737,19 +913,29 @@ int dlt_logstorage_prepare_table(DltLogStorage *handle, char *appid, char *ctxid
         {
             p_node->data.ecuid = NULL;
         }
-        p_node->data.records = NULL;
+        memset(&p_node->data.records, 0, sizeof(DltLogStorageFileList));
         p_node->data.log = NULL;
         p_node->data.cache = NULL;
+        p_node->data.group_commit = NULL;
 
-        if(dlt_logstorage_hash_add(p_node->key, &p_node->data, &(handle->config_htab)) != 0)
+        entry = dlt_logstorage_table_add(handle,
+                                         dlt_logstorage_table_key_of_string(p_node->key));
+
+        if (entry == NULL)
         {
-            dlt_log(LOG_ERR, "Adding to hash table failed, returning failure\n");
+            dlt_log(LOG_ERR, "Adding to filter table failed, returning failure\n");
 
             dlt_logstorage_free(handle, DLT_LOGSTORAGE_SYNC_ON_ERROR);
 
             free(keys);
             return -1;
         }
+        /* the first filter of a key is used */
+        if (entry->filter == NULL)
+        {
+            entry->filter = &p_node->data;
+        }
+
         /* update filter keys and number of keys */
         strncat(handle->filter_keys + handle->num_filter_keys * DLT_OFFLINE_LOGSTORAGE_MAX_KEY_LEN, keys, strlen(keys));
         handle->num_filter_keys += 1;
@@ -835,6 +1021,27 @@ int dlt_logstorage_validate_filter_value(char *filter_key, char *filter_value,
             return DLT_OFFLINE_LOGSTORAGE_ECUID;
         }
     }
+    else if (strncmp(filter_key, "GroupCommitSyncInterval",
+                     strlen("GroupCommitSyncInterval")) == 0)
+    {
+        ret = dlt_logstorage_read_number(&(tmp_data->commit_sync_interval),
+                                         filter_value);
+        if (ret == 0)
+            ret = DLT_OFFLINE_LOGSTORAGE_GROUP_COMMIT;
+    }
+    else if (strncmp(filter_key, "GroupCommitSize", strlen("GroupCommitSize")) == 0)
+    {
+        ret = dlt_logstorage_read_number(&(tmp_data->commit_size), filter_value);
+        if (ret == 0)
+            ret = DLT_OFFLINE_LOGSTORAGE_GROUP_COMMIT;
+    }
+    else if (strncmp(filter_key, "GroupCommitInterval",
+                     strlen("GroupCommitInterval")) == 0)
+    {
+        ret = dlt_logstorage_read_number(&(tmp_data->commit_interval), filter_value);
+        if (ret == 0)
+            ret = DLT_OFFLINE_LOGSTORAGE_GROUP_COMMIT;
+    }
     else
     {
         /* Invalid filter key */
@@ -900,6 +1107,22 @@ void dlt_logstorage_filter_set_strategy(DltLogStorageConfigData *config,
         config->dlt_logstorage_write = &dlt_logstorage_write_on_msg;
         config->dlt_logstorage_sync = &dlt_logstorage_sync_on_msg;
     }
+    else if (strategy == DLT_LOGSTORAGE_SYNC_ON_GROUP_COMMIT) /* file based, batched */
+    {
+        config->dlt_logstorage_prepare = &dlt_logstorage_prepare_group_commit;
+        config->dlt_logstorage_write = &dlt_logstorage_write_group_commit;
+        config->dlt_logstorage_sync = &dlt_logstorage_sync_group_commit;
+
+        if (config->commit_size == 0)
+        {
+            config->commit_size = DLT_OFFLINE_LOGSTORAGE_COMMIT_SIZE;
+        }
+
+        if (config->commit_interval == 0)
+        {
+            config->commit_interval = DLT_OFFLINE_LOGSTORAGE_COMMIT_INTERVAL;
+        }
+    }
     else /* cache based */
     {
         config->dlt_logstorage_prepare = &dlt_logstorage_prepare_msg_cache;
@@ -910,7 +1133,7 @@ void dlt_logstorage_filter_set_strategy(DltLogStorageConfigData *config,
 
 /*Return :
 DLT_OFFLINE_LOGSTORAGE_FILTER_ERROR - On filter properties or value is not valid
-DLT_OFFLINE_LOGSTORAGE_STORE_FILTER_ERROR - On error while storing in hash table
+DLT_OFFLINE_LOGSTORAGE_STORE_FILTER_ERROR - On error while storing in filter table
 */
 
 int dlt_daemon_setup_filter_properties(DltLogStorage *handle, DltConfigFile *config_file, char *sec_name)
@@ -933,7 +1156,10 @@ int dlt_daemon_setup_filter_properties(DltLogStorage *handle, DltConfigFile *con
                             "FileSize",
                             "NOFiles",
                             "SyncBehavior",
-                            "EcuID"
+                            "EcuID",
+                            "GroupCommitSize",
+                            "GroupCommitInterval",
+                            "GroupCommitSyncInterval"
                             };
 
     memset(&tmp_data, 0, sizeof(DltLogStorageConfigData));
@@ -951,6 +1177,8 @@ int dlt_daemon_setup_filter_properties(DltLogStorage *handle, DltConfigFile *con
             strncmp(filter_section_key[j], "SyncBehavior", strlen(filter_section_key[j]))
             != 0 &&
             strncmp(filter_section_key[j], "EcuID", strlen(filter_section_key[j]))
+            != 0 &&
+            strncmp(filter_section_key[j], "GroupCommit", strlen("GroupCommit"))
             != 0)
         {
             is_filter_set = DLT_OFFLINE_LOGSTORAGE_FILTER_UNINIT;
@@ -1020,7 +1248,7 @@ int dlt_daemon_setup_filter_properties(DltLogStorage *handle, DltConfigFile *con
  * dlt_logstorage_store_filters
  *
  * This function reads the filter keys and values
- * and stores them into the hash map
+ * and stores them into the filter table
  *
  * @param handle             DLT Logstorage handle
  * @param config_file_name   Configuration file name
@@ -1098,9 +1326,9 @@ int dlt_logstorage_store_filters(DltLogStorage *handle, char *config_file_name)
 /**
  * dlt_logstorage_load_config
  *
- * Read dlt_logstorage.conf file and setup filters in hash table
- * Hash table key consists of "APPID:CTXID", e.g "APP1:CTX1". If
- * wildcards used for application id or context id, the hash table
+ * Read dlt_logstorage.conf file and setup filters in filter table
+ * Filter table key consists of "APPID:CTXID", e.g "APP1:CTX1". If
+ * wildcards used for application id or context id, the filter table
  * key consists of none wildcard value, e.g. appid=.*, cxtid=CTX1
  * results in "CTX1".
  *
@@ -1134,9 +1362,9 @@ int dlt_logstorage_load_config(DltLogStorage *handle)
         return -1;
     }
 
-    if (dlt_logstorage_hash_create(DLT_OFFLINE_LOGSTORAGE_MAXFILTERS, &(handle->config_htab)) != 0)
+    if (dlt_logstorage_table_create(handle, DLT_OFFLINE_LOGSTORAGE_FILTER_TABLE_SIZE) != 0)
     {
-        dlt_log(LOG_ERR, "dlt_logstorage_load_config Error : Hash creation failed\n");
+        dlt_log(LOG_ERR, "dlt_logstorage_load_config Error : Filter table creation failed\n");
         return -1;
     }
 
@@ -1164,18 +1392,23 @@ int dlt_logstorage_load_config(DltLogStorage *handle)
  */
 int dlt_logstorage_get_loglevel_by_key(DltLogStorage *handle, char *key)
 {
-    DltLogStorageConfigData *config;
+    DltLogStorageFilterEntry *entry;
+    uint64_t table_key;
 
     /* Check if handle is NULL,already initialized or already configured  */
-    if ((handle == NULL) || (handle->connection_type != DLT_OFFLINE_LOGSTORAGE_DEVICE_CONNECTED)
+    if ((handle == NULL) || (key == NULL) || (handle->connection_type != DLT_OFFLINE_LOGSTORAGE_DEVICE_CONNECTED)
                 || (handle->config_status != DLT_OFFLINE_LOGSTORAGE_CONFIG_DONE))
     {
         return -1;
     }
 
-    config = (DltLogStorageConfigData *)dlt_logstorage_hash_find(key, &(handle->config_htab));
+    table_key = dlt_logstorage_table_key_of_string(key);
+    entry = dlt_logstorage_table_probe(handle, table_key);
 
-    return config->log_level;
+    if ((entry->key != table_key) || (entry->filter == NULL))
+        return -1;
+
+    return entry->filter->log_level;
 }
 
 /**
@@ -1195,11 +1428,7 @@ int dlt_logstorage_get_loglevel_by_key(DltLogStorage *handle, char *key)
 DltLogStorageConfigData **dlt_logstorage_get_config(DltLogStorage *handle, char *apid, char *ctid, int *num_config)
 {
     DltLogStorageConfigData **config = NULL;
-    DltLogStorageConfigData *ptr_config = NULL;
-    char key[3][DLT_OFFLINE_LOGSTORAGE_MAX_KEY_LEN]= {{'\0'},{'\0'},{'\0'}};
-    int i=0;
-    int apid_len = 0;
-    int ctid_len = 0;
+    DltLogStorageFilterEntry *entry = NULL;
 
     /* Check if handle is NULL,already initialized or already configured  */
     if ((handle == NULL) || (handle->connection_type != DLT_OFFLINE_LOGSTORAGE_DEVICE_CONNECTED)
@@ -1213,47 +1442,19 @@ DltLogStorageConfigData **dlt_logstorage_get_config(DltLogStorage *handle, char
     if (*(num_config) !=0)
        *(num_config) = 0;
 
-    /* Prepare possible keys with apid and ctid,
-       Possible combinataions are apid: , :ctid and apid:ctid */
-    apid_len = strlen(apid);
-    if (apid_len > DLT_ID_SIZE)
-       apid_len = DLT_ID_SIZE;
-
-    strncpy(key[0], apid, apid_len);
-    strncat(key[0], ":",1);
-
-    ctid_len = strlen(ctid);
-    if (ctid_len > DLT_ID_SIZE)
-       ctid_len = DLT_ID_SIZE;
-
-    strncpy(key[1], ":", 1);
-    strncat(key[1], ctid, ctid_len);
+    /* possible combinations apid: , :ctid and apid:ctid are resolved in the table */
+    entry = dlt_logstorage_table_lookup(handle, dlt_logstorage_table_key(apid, ctid));
 
-    strncpy(key[2], apid, apid_len);
-    strncat(key[2], ":", 1);
-    strncat(key[2], ctid, ctid_len);
+    if ((entry == NULL) || (entry->num_config == 0))
+        return NULL;
 
     config = (DltLogStorageConfigData **)calloc(3, sizeof(DltLogStorageConfigData *));
 
     if (config == NULL)
         return NULL;
 
-    /* Search the list thrice with keys as -apid: , :ctid and apid:ctid */
-    for (i=0; i<3; i++)
-    {
-        ptr_config = (DltLogStorageConfigData *)dlt_logstorage_hash_find(key[i], &(handle->config_htab));
-        if (ptr_config != NULL)
-        {
-            config[*(num_config)] = ptr_config;
-            *(num_config) += 1;
-        }
-    }
-
-    if (*(num_config) == 0)
-    {
-        free(config);
-        return NULL;
-    }
+    memcpy(config, entry->config, entry->num_config * sizeof(DltLogStorageConfigData *));
+    *(num_config) = entry->num_config;
 
     return config;
 }
@@ -1262,55 +1463,106 @@ DltLogStorageConfigData **dlt_logstorage_get_config(DltLogStorage *handle, char
  * dlt_logstorage_filter
  *
  * Check if log message need to be stored in a certain device based on filter config
- * - get all DltLogStorageConfigData from hash table possible by given apid/ctid (apid:, :ctid, apid:ctid
+ * - get all DltLogStorageConfigData possible by given apid/ctid (apid:, :ctid, apid:ctid)
+ *   with one lookup in the filter table
  * - for each found structure, compare message log level with configured one
  *
+ * @param handle    DltLogStorage handle
+ * @param config    (o/p) filters to store the message, space for 3 entries
  * @param appid     application id
  * @param ctxid     context id
- * @param log_level Log level of message
  * @param ecuid     EcuID given in the message
- * @param num       Number of found configurations
- * @return          list of filters received from hashmap or NULL
+ * @param log_level Log level of message
+ * @return          number of filters stored in config
  */
-DltLogStorageConfigData **dlt_logstorage_filter(DltLogStorage *handle,
-                                                char *appid,
-                                                char *ctxid,
-                                                char *ecuid,
-                                                int log_level,
-                                                int *num)
+int dlt_logstorage_filter(DltLogStorage *handle,
+                          DltLogStorageConfigData **config,
+                          char *appid,
+                          char *ctxid,
+                          char *ecuid,
+                          int log_level)
 {
-    DltLogStorageConfigData **config = NULL;
+    DltLogStorageFilterEntry *entry = NULL;
     int i = 0;
+    int num = 0;
 
     /* filter on names: find DltLogStorageConfigData structures */
-    config = dlt_logstorage_get_config(handle, appid, ctxid, num);
+    entry = dlt_logstorage_table_lookup(handle, dlt_logstorage_table_key(appid, ctxid));
 
-    if (config == NULL)
-    {
-        *num = 0;
-        return NULL;
-    }
+    if (entry == NULL)
+        return 0;
 
-    for (i = 0; i < *num; i++)
+    for (i = 0; i < entry->num_config; i++)
     {
         /* filter on log level */
-        if (log_level > config[i]->log_level)
-        {
-            config[i] = NULL;
+        if (log_level > entry->config[i]->log_level)
             continue;
-        }
 
         /* filter on ECU id only if EcuID is set */
-        if (config[i]->ecuid != NULL)
+        if (entry->config[i]->ecuid != NULL)
         {
-            if (strncmp(ecuid, config[i]->ecuid, strlen(ecuid)) != 0)
-            {
-                config[i] = NULL;
-            }
+            if (strncmp(ecuid, entry->config[i]->ecuid, strnlen(ecuid, DLT_ID_SIZE)) != 0)
+                continue;
         }
+
+        config[num++] = entry->config[i];
     }
 
-    return config;
+    return num;
+}
+
+/**
+ * dlt_logstorage_read_files
+ *
+ * Read the log files of all filters from the device in one directory scan.
+ * Filters which could not be read scan the directory when opening a file.
+ *
+ * @param handle    DltLogStorage handle
+ * @param uconfig   User configurations for log file
+ */
+static void dlt_logstorage_read_files(DltLogStorage *handle,
+                                      DltLogStorageUserConfig *uconfig)
+{
+    char storage_path[DLT_OFFLINE_LOGSTORAGE_CONFIG_DIR_PATH_LEN] = {'\0'};
+    DltLogStorageConfigData **config = NULL;
+    int i = 0;
+
+    handle->files_read = 1;
+
+    if (handle->num_filter_keys <= 0)
+    {
+        return;
+    }
+
+    if (snprintf(storage_path, DLT_OFFLINE_LOGSTORAGE_CONFIG_DIR_PATH_LEN,
+                 "%s/", handle->device_mount_point) >= DLT_OFFLINE_LOGSTORAGE_CONFIG_DIR_PATH_LEN)
+    {
+        dlt_log(LOG_ERR, "Mount point path name too long\n");
+        return;
+    }
+
+    config = malloc(sizeof(DltLogStorageConfigData *) * handle->num_filter_keys);
+
+    if (config == NULL)
+    {
+        dlt_log(LOG_ERR, "Memory allocation for file lists failed\n");
+        return;
+    }
+
+    for (i = 0; i < handle->num_filter_keys; i++)
+    {
+        config[i] = &(handle->config_data[i].data);
+    }
+
+    if (dlt_logstorage_storage_dir_info(uconfig,
+                                        storage_path,
+                                        config,
+                                        handle->num_filter_keys) != 0)
+    {
+        dlt_log(LOG_WARNING, "Reading log files of logstorage device failed\n");
+    }
+
+    free(config);
 }
 
 /**
@@ -1336,7 +1588,7 @@ int dlt_logstorage_write(DltLogStorage *handle,
                          unsigned char *data3,
                          int size3)
 {
-    DltLogStorageConfigData **config = NULL;
+    DltLogStorageConfigData *config[3] = {NULL, NULL, NULL};
     int i = 0;
     int ret = 0;
     int num = 0;
@@ -1357,6 +1609,13 @@ int dlt_logstorage_write(DltLogStorage *handle,
     {
         return 0;
     }
+
+    /* log files of all filters are read in one directory scan */
+    if (!handle->files_read)
+    {
+        dlt_logstorage_read_files(handle, uconfig);
+    }
+
     /* Calculate real length of DltStandardHeaderExtra */
     standardHeader = (DltStandardHeader *)data2;
     standardHeaderExtraLen = sizeof(DltStandardHeaderExtra);
@@ -1382,14 +1641,14 @@ int dlt_logstorage_write(DltLogStorage *handle,
 
     /* check if log message need to be stored in a certain device based on
      * filter configuration */
-    config = dlt_logstorage_filter(handle,
-                                   extendedHeader->apid,
-                                   extendedHeader->ctid,
-                                   extraHeader->ecu,
-                                   log_level,
-                                   &num);
+    num = dlt_logstorage_filter(handle,
+                                config,
+                                extendedHeader->apid,
+                                extendedHeader->ctid,
+                                extraHeader->ecu,
+                                log_level);
 
-    if (config != NULL)
+    if (num > 0)
     {
         /* store log message in every found filter */
         while (i < num)
@@ -1443,13 +1702,39 @@ int dlt_logstorage_write(DltLogStorage *handle,
             }
             i++;
         }
-
-        free(config);
     }
 
     return err;
 }
 
+int dlt_logstorage_commit_due(DltLogStorage *handle, int period)
+{
+    int i = 0;
+
+    if (handle == NULL)
+    {
+        return -1;
+    }
+
+    for (i=0; i<handle->num_filter_keys; i++)
+    {
+        if (handle->config_data[i].data.sync != DLT_LOGSTORAGE_SYNC_ON_GROUP_COMMIT)
+        {
+            continue;
+        }
+
+        if (dlt_logstorage_commit_group_due(&(handle->config_data[i].data),
+                                            period) != 0)
+        {
+            dlt_log(LOG_ERR,
+                    "dlt_logstorage_commit_due: Commit failed."
+                    " Continue with next filter.\n");
+        }
+    }
+
+    return 0;
+}
+
 int dlt_logstorage_sync_caches(DltLogStorage *handle)
 {
     int i = 0;
@@ -53,11 +53,12 @@
 #ifndef DLT_OFFLINE_LOGSTORAGE_H
 #define DLT_OFFLINE_LOGSTORAGE_H
 
-#include <search.h>
 #include "dlt_common.h"
 #include "dlt-daemon_cfg.h"
 
-#define DLT_OFFLINE_LOGSTORAGE_MAXFILTERS          100  /* Maximum entries in hashmap */
+#define DLT_OFFLINE_LOGSTORAGE_MAXFILTERS          100  /* Maximum number of filter keys */
+#define DLT_OFFLINE_LOGSTORAGE_FILTER_TABLE_SIZE   256  /* Initial slots of filter table, power of 2 */
+#define DLT_OFFLINE_LOGSTORAGE_FILTER_CACHE_MAX    1024 /* Maximum number of cached id combinations */
 
 #define DLT_OFFLINE_LOGSTORAGE_INIT_DONE           1  /* For device configuration status */
 #define DLT_OFFLINE_LOGSTORAGE_DEVICE_CONNECTED    1
@@ -83,6 +84,7 @@
                                                     DLT_OFFLINE_LOGSTORAGE_FILE_EXTENSION_LEN + 1)
 
 #define DLT_OFFLINE_LOGSTORAGE_FILTER_UNINIT       0
+#define DLT_OFFLINE_LOGSTORAGE_GROUP_COMMIT        (1<<9)
 #define DLT_OFFLINE_LOGSTORAGE_ECUID               (1<<8)
 #define DLT_OFFLINE_LOGSTORAGE_FILTER_PRESENT      (1<<7)
 #define DLT_OFFLINE_LOGSTORAGE_APP_INIT            (1<<6)
@@ -92,7 +94,7 @@
 #define DLT_OFFLINE_LOGSTORAGE_SIZE_INIT           (1<<2)
 #define DLT_OFFLINE_LOGSTORAGE_SYNC_BEHAVIOR       (1<<1)
 #define DLT_OFFLINE_LOGSTORAGE_NUM_INIT            1
-/* Sync behavior and ECUid are optional */
+/* Sync behavior, group commit settings and ECUid are optional */
 #define DLT_OFFLINE_LOGSTORAGE_FILTER_INIT         0xFD
 
 #define DLT_OFFLINE_LOGSTORAGE_FILTER_INITIALIZED(A) ((A) >= DLT_OFFLINE_LOGSTORAGE_FILTER_INIT)
@@ -110,7 +112,22 @@
 #define DLT_OFFLINE_LOGSTORAGE_MIN(A, B)   ((A) < (B) ? (A) : (B))
 
 #define DLT_OFFLINE_LOGSTORAGE_MAX_WRITE_ERRORS     5
-#define DLT_OFFLINE_LOGSTORAGE_MAX_KEY_NUM          8
+#define DLT_OFFLINE_LOGSTORAGE_MAX_KEY_NUM          11
+
+/* Defaults of the group commit sync strategy */
+#define DLT_OFFLINE_LOGSTORAGE_COMMIT_SIZE          65536 /* bytes written at once */
+#define DLT_OFFLINE_LOGSTORAGE_COMMIT_INTERVAL      500   /* ms a message may wait */
+
+/* Allocation unit of message caches */
+#define DLT_OFFLINE_LOGSTORAGE_CACHE_SEGMENT_SIZE   16384
+/* Bytes of synced caches written per event loop iteration */
+#define DLT_OFFLINE_LOGSTORAGE_FLUSH_CHUNK          65536
+
+/* Entries of a log file list allocated at first, doubled if full */
+#define DLT_OFFLINE_LOGSTORAGE_FILE_LIST_ALLOC      8
+
+/* Classes of commit latency: < 1 ms, < 10 ms, < 100 ms, < 1 s, longer */
+#define DLT_OFFLINE_LOGSTORAGE_COMMIT_LATENCIES     5
 
 #define DLT_OFFLINE_LOGSTORAGE_CONFIG_SECTION "FILTER"
 #define DLT_OFFLINE_LOGSTORAGE_GENERAL_CONFIG_SECTION "GENERAL"
@@ -121,6 +138,7 @@
 #define DLT_LOGSTORAGE_SYNC_ON_DAEMON_EXIT            (1<<1) /* sync on daemon exit */
 #define DLT_LOGSTORAGE_SYNC_ON_DEMAND                 (1<<2) /* sync on demand */
 #define DLT_LOGSTORAGE_SYNC_ON_DEVICE_DISCONNECT      (1<<3) /* sync on device disconnect*/
+#define DLT_LOGSTORAGE_SYNC_ON_GROUP_COMMIT           (1<<4) /* write messages in groups */
 
 #define DLT_OFFLINE_LOGSTORAGE_IS_STRATEGY_SET(S, s) ((S) & (s))
 
@@ -129,11 +147,32 @@ unsigned int g_logstorage_cache_max;
 /* current logstorage cache size */
 unsigned int g_logstorage_cache_size;
 
-typedef struct
+typedef struct DltLogStorageCache DltLogStorageCache;
+
+/* Ring buffer of messages of cache based filters. A message is stored in
+ * one piece, if it does not fit at the end, the ring continues from the
+ * beginning. The cache data is live from head to offset, through end and
+ * the beginning of the ring if wrapped is set. */
+struct DltLogStorageCache
 {
-    int offset;                   /* current write offset */
+    unsigned char **segments;     /* ring segments, allocated when used */
+    unsigned char *dirty;         /* segment was written since the last sync */
+    unsigned int num_segments;    /* number of segments */
+    unsigned int size;            /* size of the ring */
+    unsigned int head;            /* oldest cached message */
+    unsigned int offset;          /* current write offset */
+    unsigned int end;             /* end of data before the last wrap around */
+    int wrapped;                  /* cached data continues at the beginning */
     unsigned int wrap_around_cnt; /* wrap around counter */
-}DltLogStorageCacheFooter;
+    /* synced data not written to the log file yet, same layout as above */
+    FILE *flush_log;              /* log file of the synced data */
+    unsigned int flush_head;
+    unsigned int flush_offset;
+    unsigned int flush_end;
+    int flush_wrapped;
+    int detached;                 /* filter is freed, free cache once written */
+    DltLogStorageCache *next_flush; /* next cache with synced data */
+};
 
 typedef struct
 {
@@ -144,14 +183,33 @@ typedef struct
     unsigned int logfile_counteridxlen; /* File index counter length */
 }DltLogStorageUserConfig;
 
-typedef struct DltLogStorageFileList
+typedef struct
 {
-    /* List for filenames */
+    /* Log file of a filter */
     char *name;                         /* Filename */
     unsigned int idx;                   /* File index */
-    struct DltLogStorageFileList *next;
+}DltLogStorageFile;
+
+typedef struct
+{
+    /* Log files of a filter, read once from the device */
+    DltLogStorageFile *files;           /* Ring of files, NULL if not read yet */
+    unsigned int first;                 /* Entry of the oldest file */
+    unsigned int num;                   /* Number of files */
+    unsigned int max;                   /* Number of entries */
 }DltLogStorageFileList;
 
+typedef struct
+{
+    unsigned char *buffer;              /* messages not written yet */
+    unsigned int used;                  /* bytes in buffer */
+    uint32_t first_time;                /* uptime when the oldest message was added, in 0.1 ms */
+    uint32_t sync_time;                 /* uptime of the last data sync, in 0.1 ms */
+    unsigned long long commits;         /* number of write calls */
+    unsigned long long bytes;           /* bytes written */
+    unsigned long long latency[DLT_OFFLINE_LOGSTORAGE_COMMIT_LATENCIES]; /* commits per latency class */
+}DltLogStorageGroupCommit;
+
 typedef struct DltLogStorageConfigData DltLogStorageConfigData;
 
 struct DltLogStorageConfigData
@@ -162,6 +220,9 @@ struct DltLogStorageConfigData
     unsigned int file_size;         /* MAX File size of storage file configured for filter */
     unsigned int num_files;         /* MAX number of storage files configured for filters */
     int sync;                       /* Sync strategy */
+    unsigned int commit_size;       /* Bytes collected before a group commit */
+    unsigned int commit_interval;   /* Maximum time in ms a message waits for a group commit */
+    unsigned int commit_sync_interval; /* Minimum time in ms between data syncs, 0 for none */
     char *ecuid;                    /* ECU identifier */
     /* callback function for filter configurations */
     int (*dlt_logstorage_prepare)(DltLogStorageConfigData *config,
@@ -180,27 +241,46 @@ struct DltLogStorageConfigData
     int (*dlt_logstorage_sync)(DltLogStorageConfigData *config, int status);
     FILE *log;                      /* current open log file */
     void *cache;                    /* log data cache */
-    DltLogStorageFileList *records; /* File name list */
+    DltLogStorageGroupCommit *group_commit; /* messages of a group commit */
+    DltLogStorageFileList records;  /* Files of the filter, oldest first */
 };
 
 
 typedef struct
 {
-    char key[DLT_OFFLINE_LOGSTORAGE_MAX_KEY_LEN]; /* Keys stored in hash table */
-    DltLogStorageConfigData data;               /* Data stored in hash table */
+    char key[DLT_OFFLINE_LOGSTORAGE_MAX_KEY_LEN]; /* Keys stored in filter table */
+    DltLogStorageConfigData data;               /* Data stored in filter table */
 }DltLogStorageConfig;
 
 
+/* Slot of the filter table, keyed by application id and context id.
+ * Slots are created for configured filters and cache the matching filters of
+ * the combinations of ids seen in log messages, also if no filter matches.
+ * At most DLT_OFFLINE_LOGSTORAGE_FILTER_CACHE_MAX combinations without a
+ * configured filter are cached, the cache is cleared when it is full. */
 typedef struct
 {
-    struct hsearch_data config_htab;    /* Hash table object declaration used by hsearch_r()*/
+    uint64_t key;                       /* apid in low, ctid in high 4 bytes, 0 if slot is empty */
+    DltLogStorageConfigData *filter;    /* Filter configured with exactly this key or NULL */
+    int resolved;                       /* config holds all matching filters */
+    int num_config;                     /* Number of matching filters */
+    DltLogStorageConfigData *config[3]; /* Filters for apid:, :ctid and apid:ctid */
+}DltLogStorageFilterEntry;
+
+typedef struct
+{
+    DltLogStorageFilterEntry *filter_table; /* Open addressing table of filters */
+    unsigned int filter_table_size;     /* Number of slots, power of 2 */
+    unsigned int filter_table_used;     /* Number of used slots */
+    unsigned int filter_table_cached;   /* Number of slots without configured filter */
     DltLogStorageConfig *config_data; /* Configuration data  */
-    char *filter_keys;                 /* List of all keys stored in config_htab */
+    char *filter_keys;                 /* List of all keys stored in filter_table */
     int num_filter_keys;                /* Number of keys */
     char device_mount_point[DLT_MOUNT_PATH_MAX]; /* Device mount path */
     unsigned int connection_type;      /* Type of connection */
     unsigned int config_status;        /* Status of configuration */
     int write_errors;                  /* number of write errors */
+    int files_read;                    /* log files of the filters were read from the device */
 }DltLogStorage;
 
 /**
@@ -284,6 +364,29 @@ extern int dlt_logstorage_write(DltLogStorage *handle,
                                 unsigned char *data3,
                                 int size3);
 
+/**
+ * dlt_logstorage_commit_due
+ *
+ * Write the messages of group commit filters which would wait longer than
+ * their commit interval before the next check.
+ *
+ * @param  handle    DltLogStorage handle
+ * @param  period    Time in ms until the next check
+ * @return 0 on success, -1 otherwise
+ */
+extern int dlt_logstorage_commit_due(DltLogStorage *handle, int period);
+
+/**
+ * dlt_logstorage_flush_caches
+ *
+ * Write synced data of message caches into their log files, oldest sync
+ * first, until the given number of bytes is written.
+ *
+ * @param  budget    Maximum number of bytes to be written
+ * @return 1 if synced data is left, 0 otherwise
+ */
+extern int dlt_logstorage_flush_caches(unsigned int budget);
+
 /**
  * dlt_logstorage_sync_caches
  *
@@ -28,6 +28,8 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <sys/uio.h>
 
 #include "dlt_offline_logstorage.h"
 #include "dlt_offline_logstorage_behavior.h"
@@ -106,88 +108,180 @@ void dlt_logstorage_log_file_name(char *log_file_name,
 }
 
 /**
- * dlt_logstorage_sort_file_name
+ * dlt_logstorage_file_list_resize
  *
- * Sort the filenames with index based ascending order (bubble sort)
+ * Move the files of a list into a new ring, oldest file first
  *
- * @param head              Log filename list
- * @ return                 None
+ * @param list              Log file list
+ * @param max               Number of entries of the new ring
+ * @return                  0 on success, -1 on error
  */
-void dlt_logstorage_sort_file_name(DltLogStorageFileList **head)
+static int dlt_logstorage_file_list_resize(DltLogStorageFileList *list,
+                                           unsigned int max)
 {
-    int done = 0;
+    DltLogStorageFile *files = NULL;
+    unsigned int i = 0;
+
+    files = calloc(max, sizeof(DltLogStorageFile));
 
-    if (head == NULL || *head == NULL || (*head)->next == NULL)
+    if (files == NULL)
     {
-        return;
+        dlt_log(LOG_ERR, "Memory allocation for file list failed\n");
+        return -1;
     }
 
-    while (!done)
+    for (i = 0; i < list->num; i++)
     {
-        /* "source" of the pointer to the current node in the list struct */
-        DltLogStorageFileList **pv = head;
-        DltLogStorageFileList *nd = *head; /* local iterator pointer */
-        DltLogStorageFileList *nx = (*head)->next; /* local next pointer */
+        files[i] = list->files[(list->first + i) % list->max];
+    }
 
-        done = 1;
+    free(list->files);
+    list->files = files;
+    list->first = 0;
+    list->max = max;
 
-        while (nx)
-        {
-            if (nd->idx > nx->idx)
-            {
-                nd->next = nx->next;
-                nx->next = nd;
-                *pv = nx;
+    return 0;
+}
 
-                done = 0;
-            }
-            pv = &nd->next;
-            nd = nx;
-            nx = nx->next;
+/**
+ * dlt_logstorage_file_list_add
+ *
+ * Add a file as newest file to the list, the ring grows if it is full
+ *
+ * @param list              Log file list
+ * @param name              File name
+ * @param idx               File index
+ * @return                  0 on success, -1 on error
+ */
+static int dlt_logstorage_file_list_add(DltLogStorageFileList *list,
+                                        char *name,
+                                        unsigned int idx)
+{
+    DltLogStorageFile *file = NULL;
+
+    if (list->num == list->max)
+    {
+        if (dlt_logstorage_file_list_resize(list,
+                (list->max > 0) ? list->max * 2 : DLT_OFFLINE_LOGSTORAGE_FILE_LIST_ALLOC) != 0)
+        {
+            return -1;
         }
     }
+
+    file = &list->files[(list->first + list->num) % list->max];
+    file->name = strdup(name);
+
+    if (file->name == NULL)
+    {
+        dlt_log(LOG_ERR, "Memory allocation for file name failed\n");
+        return -1;
+    }
+
+    file->idx = idx;
+    list->num++;
+
+    return 0;
 }
 
 /**
- * dlt_logstorage_rearrange_file_name
+ * dlt_logstorage_file_list_remove_oldest
  *
- * Rearrange the filenames in the order of latest and oldest
+ * Remove the oldest file from the list
  *
- * @param head              Log filename list
- * @ return                 None
+ * @param list              Log file list
+ */
+static void dlt_logstorage_file_list_remove_oldest(DltLogStorageFileList *list)
+{
+    if (list->num == 0)
+    {
+        return;
+    }
+
+    free(list->files[list->first].name);
+    list->files[list->first].name = NULL;
+    list->first = (list->first + 1) % list->max;
+    list->num--;
+}
+
+/**
+ * dlt_logstorage_file_list_free
+ *
+ * Free the files of a list, the list is read again on next use
+ *
+ * @param list              Log file list
+ */
+void dlt_logstorage_file_list_free(DltLogStorageFileList *list)
+{
+    if (list == NULL)
+    {
+        return;
+    }
+
+    while (list->num > 0)
+    {
+        dlt_logstorage_file_list_remove_oldest(list);
+    }
+
+    free(list->files);
+    list->files = NULL;
+    list->first = 0;
+    list->max = 0;
+}
+
+static int dlt_logstorage_file_idx_compare(const void *a, const void *b)
+{
+    const DltLogStorageFile *file_a = a;
+    const DltLogStorageFile *file_b = b;
+
+    if (file_a->idx < file_b->idx)
+    {
+        return -1;
+    }
+
+    return (file_a->idx > file_b->idx) ? 1 : 0;
+}
+
+/**
+ * dlt_logstorage_file_list_arrange
+ *
+ * Sort the files read from the storage directory by index and rearrange
+ * them in the order of oldest and latest. The oldest file follows the last
+ * gap in the indexes, where the index wrapped around.
+ *
+ * @param list              Log file list
  */
-void dlt_logstorage_rearrange_file_name(DltLogStorageFileList **head)
+static void dlt_logstorage_file_list_arrange(DltLogStorageFileList *list)
 {
-    DltLogStorageFileList *n_prev = NULL;
-    DltLogStorageFileList *tail = NULL;
-    DltLogStorageFileList *wrap_pre = NULL;
-    DltLogStorageFileList *wrap_post = NULL;
-    DltLogStorageFileList *n = NULL;
+    unsigned int wrap = 0;
+    unsigned int i = 0;
 
-    if (head == NULL || *head == NULL || (*head)->next == NULL)
+    if (list->num < 2)
     {
         return;
     }
 
-    for (n = *head; n != NULL; n = n->next)
+    /* files are added in directory order, the list does not wrap yet */
+    qsort(list->files, list->num, sizeof(DltLogStorageFile),
+          dlt_logstorage_file_idx_compare);
+
+    for (i = 1; i < list->num; i++)
     {
-        if (n && n_prev)
+        if ((list->files[i].idx - list->files[i - 1].idx) != 1)
         {
-            if ((n->idx - n_prev->idx) != 1)
-            {
-                wrap_post = n;
-                wrap_pre = n_prev;
-            }
+            wrap = i;
         }
-        n_prev = n;
     }
-    tail = n_prev;
 
-    if (wrap_post && wrap_pre)
+    if (wrap > 0)
     {
-        wrap_pre->next = NULL;
-        tail->next = *head;
-        *head = wrap_post;
+        /* close the ring behind the newest file, then start at the oldest */
+        if ((list->num < list->max) &&
+            (dlt_logstorage_file_list_resize(list, list->num) != 0))
+        {
+            return;
+        }
+
+        list->first = wrap;
     }
 }
 
@@ -257,99 +351,104 @@ unsigned int dlt_logstorage_get_idx_of_log_file(
 /**
  * dlt_logstorage_storage_dir_info
  *
- * Read file names of storage directory.
- * Update the file list, arrange it in order of latest and oldest
+ * Read file names of storage directory once for a number of filters.
+ * Update the file lists of the filters, arrange them in order of oldest and
+ * latest. Afterwards the lists are updated when files are created and
+ * deleted, without reading the directory again.
  *
  * @param file_config   User configurations for log file
  * @param path          Path to storage directory
- * @param  config       DltLogStorageConfigData
+ * @param config        Filters to read the files for
+ * @param num_config    Number of filters
  * @return              0 on success, -1 on error
  */
 int dlt_logstorage_storage_dir_info(DltLogStorageUserConfig *file_config,
                                     char *path,
-                                    DltLogStorageConfigData *config)
+                                    DltLogStorageConfigData **config,
+                                    int num_config)
 {
     int i = 0;
-    int cnt = 0;
     int ret = 0;
-    struct dirent **files = {0};
+    DIR *dir = NULL;
+    struct dirent *entry = NULL;
     unsigned int current_idx = 0;
 
     if (config == NULL ||
         file_config == NULL ||
-        path == NULL ||
-        config->file_name == NULL)
+        path == NULL)
     {
         return -1;
     }
 
-    cnt = scandir(path, &files, 0, alphasort);
-    if (cnt < 0)
+    dir = opendir(path);
+    if (dir == NULL)
     {
         dlt_log(LOG_ERR,
                 "dlt_logstorage_storage_dir_info: Failed to scan directory\n");
         return -1;
     }
 
-    for (i = 0; i < cnt; i++)
+    for (i = 0; i < num_config; i++)
+    {
+        if (config[i]->file_name == NULL)
+        {
+            continue;
+        }
+
+        /* a filter without files has an empty list, it is not read again */
+        dlt_logstorage_file_list_free(&config[i]->records);
+        if (dlt_logstorage_file_list_resize(&config[i]->records,
+                                            config[i]->num_files + 1) != 0)
+        {
+            ret = -1;
+        }
+    }
+
+    while ((ret == 0) && ((entry = readdir(dir)) != NULL))
     {
-        int len = 0;
-        len = strlen(config->file_name);
-        if ((strncmp(files[i]->d_name,
-                     config->file_name,
-                     len) == 0) &&
-                     (files[i]->d_name[len] == file_config->logfile_delimiter))
+        for (i = 0; i < num_config; i++)
         {
-            DltLogStorageFileList **tmp = NULL;
-            current_idx = dlt_logstorage_get_idx_of_log_file(file_config,
-                                                             files[i]->d_name);
+            int len = 0;
 
-            if(config->records == NULL)
+            if (config[i]->file_name == NULL)
             {
-                config->records = malloc(sizeof(DltLogStorageFileList));
-                if (config->records == NULL)
-                {
-                    ret = -1;
-                    dlt_log(LOG_ERR,
-                            "Memory allocation failed\n");
-                    break;
-                }
-                tmp = &config->records;
+                continue;
             }
-            else
+
+            len = strlen(config[i]->file_name);
+            if ((strncmp(entry->d_name,
+                         config[i]->file_name,
+                         len) == 0) &&
+                         (entry->d_name[len] == file_config->logfile_delimiter))
             {
-                tmp = &config->records;
-                while(*(tmp) != NULL)
-                {
-                    tmp = &(*tmp)->next;
-                }
-                *tmp = malloc(sizeof(DltLogStorageFileList));
-                if (*tmp == NULL)
+                current_idx = dlt_logstorage_get_idx_of_log_file(file_config,
+                                                                 entry->d_name);
+
+                if (dlt_logstorage_file_list_add(&config[i]->records,
+                                                 entry->d_name,
+                                                 current_idx) != 0)
                 {
                     ret = -1;
-                    dlt_log(LOG_ERR,
-                            "Memory allocation failed\n");
                     break;
                 }
             }
-            (*tmp)->name = strdup(files[i]->d_name);
-            (*tmp)->idx =  current_idx;
-            (*tmp)->next = NULL;
         }
     }
 
-    if (ret == 0)
-    {
-        dlt_logstorage_sort_file_name(&config->records);
-        dlt_logstorage_rearrange_file_name(&config->records);
-    }
+    closedir(dir);
 
-    /* free scandir result */
-    for (i = 0; i < cnt; i++)
+    for (i = 0; i < num_config; i++)
     {
-        free(files[i]);
+        if (ret == 0)
+        {
+            dlt_logstorage_file_list_arrange(&config[i]->records);
+        }
+        else
+        {
+            /* read again when the filter opens a file */
+            dlt_logstorage_file_list_free(&config[i]->records);
+        }
     }
-    free(files);
 
     return ret;
 }
@@ -376,10 +475,9 @@ int dlt_logstorage_open_log_file(DltLogStorageConfigData *config,
     int ret = 0;
     char absolute_file_path[DLT_MOUNT_PATH_MAX + 1] = {'\0'};
     char storage_path[DLT_OFFLINE_LOGSTORAGE_CONFIG_DIR_PATH_LEN] = {'\0'};
-    unsigned int num_log_files = 0;
     struct stat s;
-    DltLogStorageFileList **tmp = NULL;
-    DltLogStorageFileList **newest = NULL;
+    DltLogStorageFileList *records = NULL;
+    DltLogStorageFile *newest = NULL;
     char file_name[DLT_MOUNT_PATH_MAX + 1] = {'\0'};
 
     if (config == NULL)
@@ -394,27 +492,19 @@ int dlt_logstorage_open_log_file(DltLogStorageConfigData *config,
         return -1;
     }
 
-    /* check if there are already files stored */
-    if (config->records == NULL)
+    records = &config->records;
+
+    /* check if there are already files stored, usually the files of all
+     * filters were read when the device was connected */
+    if (records->files == NULL)
     {
-        if (dlt_logstorage_storage_dir_info(file_config, storage_path, config)
+        if (dlt_logstorage_storage_dir_info(file_config, storage_path, &config, 1)
             != 0)
             return -1;
     }
 
-    /* obtain locations of newest, current file names, file count */
-    tmp = &config->records;
-    while(*(tmp) != NULL)
-    {
-        num_log_files += 1;
-        if((*tmp)->next == NULL)
-            newest = tmp;
-
-        tmp = &(*tmp)->next;
-    }
-
      /* need new file*/
-    if (num_log_files == 0)
+    if (records->num == 0)
     {
         dlt_logstorage_log_file_name(file_name,
                                      file_config,
@@ -427,21 +517,18 @@ int dlt_logstorage_open_log_file(DltLogStorageConfigData *config,
         config->log = fopen(absolute_file_path, "a+");
 
         /* Add file to file list */
-        *tmp = malloc(sizeof(DltLogStorageFileList));
-        if (*tmp == NULL)
+        if (dlt_logstorage_file_list_add(records, file_name, 1) != 0)
         {
-            dlt_log(LOG_ERR,
-                    "Memory allocation for file name failed\n");
             return -1;
         }
-        (*tmp)->name = strdup(file_name);
-        (*tmp)->idx =  1;
-        (*tmp)->next = NULL;
     }
     else /* newest file available*/
     {
+        newest = &records->files[(records->first + records->num - 1) %
+                                 records->max];
+
         strcat(absolute_file_path, storage_path);
-        strcat(absolute_file_path, (*newest)->name);
+        strcat(absolute_file_path, newest->name);
 
         ret = stat(absolute_file_path, &s);
 
@@ -452,12 +539,8 @@ int dlt_logstorage_open_log_file(DltLogStorageConfigData *config,
         }
         else /* no space in file or file stats cannot be read */
         {
-            unsigned int idx = 0;
-
-            /* get index of newest log file */
-            idx = dlt_logstorage_get_idx_of_log_file(file_config,
-                                                     (*newest)->name);
-            idx += 1;
+            /* index of newest log file */
+            unsigned int idx = newest->idx + 1;
 
             /* wrap around if max index is reached or an error occurred
              * while calculating index from file name */
@@ -480,36 +563,22 @@ int dlt_logstorage_open_log_file(DltLogStorageConfigData *config,
             config->log = fopen(absolute_file_path, "a+");
 
             /* Add file to file list */
-            *tmp = malloc(sizeof(DltLogStorageFileList));
-            if (*tmp == NULL)
+            if (dlt_logstorage_file_list_add(records, file_name, idx) != 0)
             {
-                dlt_log(LOG_ERR,
-                        "Memory allocation for file name failed\n");
                 return -1;
             }
 
-            (*tmp)->name = strdup(file_name);
-            (*tmp)->idx =  idx;
-            (*tmp)->next = NULL;
-
-            num_log_files += 1;
-
             /* check if number of log files exceeds configured max value */
-            if (num_log_files > config->num_files)
+            if (records->num > config->num_files)
             {
                 /* delete oldest */
-                DltLogStorageFileList **head = &config->records;
-                DltLogStorageFileList *n = *head;
                 memset(absolute_file_path,
                        0,
                        sizeof(absolute_file_path)/sizeof(char));
                 strcat(absolute_file_path, storage_path);
-                strcat(absolute_file_path, (*head)->name);
+                strcat(absolute_file_path, records->files[records->first].name);
                 remove(absolute_file_path);
-                free((*head)->name);
-                *head = n->next;
-                n->next = NULL;
-                free(n);
+                dlt_logstorage_file_list_remove_oldest(records);
             }
         }
     }
@@ -664,230 +733,1023 @@ int dlt_logstorage_sync_on_msg(DltLogStorageConfigData *config, int status)
     return 0;
 }
 
+/* caches with synced data which is not written to the log file yet */
+static DltLogStorageCache *g_logstorage_flush_list = NULL;
+
 /**
- * dlt_logstorage_prepare_msg_cache
+ * dlt_logstorage_cache_segment_size
  *
- * Prepare the log file for a certain filer. If log file not open or log
- * files max size reached, open a new file.
- * Create a memory area to cache data.
+ * Get the size of a cache segment. The last segment may be smaller.
  *
- * @param config        DltLogStorageConfigData
- * @param file_config   User configurations for log file
- * @param dev_path      Storage device path
- * @param log_msg_size  Size of log message
- * @return 0 on success, -1 on error
+ * @param cache         Message cache
+ * @param idx           Index of the segment
+ * @return size of the segment
  */
-int dlt_logstorage_prepare_msg_cache(DltLogStorageConfigData *config,
-                                     DltLogStorageUserConfig *file_config,
-                                     char *dev_path,
-                                     int log_msg_size)
+static unsigned int dlt_logstorage_cache_segment_size(DltLogStorageCache *cache,
+                                                      unsigned int idx)
 {
-    if (config == NULL || file_config == NULL || dev_path == NULL)
-    {
-        return -1;
-    }
-
-    log_msg_size = log_msg_size; /* satisfy compiler */
+    return DLT_OFFLINE_LOGSTORAGE_MIN(DLT_OFFLINE_LOGSTORAGE_CACHE_SEGMENT_SIZE,
+                                      cache->size -
+                                      idx * DLT_OFFLINE_LOGSTORAGE_CACHE_SEGMENT_SIZE);
+}
 
-    /* create file to sync cache into later */
-    if (config->log == NULL)
-    {
-        /* get always a new file */
-        if (dlt_logstorage_prepare_on_msg(config,
-                                          file_config,
-                                          dev_path,
-                                          config->file_size) != 0)
-        {
-            dlt_log(LOG_ERR,
-                    "Cannot prepare log file for ON_DAEMON_EXIT sync\n");
-            return -1;
-        }
-    }
+/**
+ * dlt_logstorage_cache_copy
+ *
+ * Copy data into the cache at a ring position and mark the touched segments
+ * as dirty. The segments must be allocated.
+ *
+ * @param cache         Message cache
+ * @param pos           Ring position
+ * @param data          Data to be copied
+ * @param len           Length of data
+ */
+static void dlt_logstorage_cache_copy(DltLogStorageCache *cache,
+                                      unsigned int pos,
+                                      unsigned char *data,
+                                      unsigned int len)
+{
+    unsigned int idx;
+    unsigned int off;
+    unsigned int n;
 
-    /* create cache */
-    if (config->cache == NULL)
+    while (len > 0)
     {
-        /* check total logstorage cache size */
-        if ((g_logstorage_cache_size +
-                config->file_size +
-                sizeof(DltLogStorageCacheFooter)) >
-            g_logstorage_cache_max)
-        {
-            dlt_log(LOG_ERR, "Max size of Logstorage Cache already used.");
-            return -1;
-        }
+        idx = pos / DLT_OFFLINE_LOGSTORAGE_CACHE_SEGMENT_SIZE;
+        off = pos % DLT_OFFLINE_LOGSTORAGE_CACHE_SEGMENT_SIZE;
+        n = DLT_OFFLINE_LOGSTORAGE_MIN(len,
+                                       DLT_OFFLINE_LOGSTORAGE_CACHE_SEGMENT_SIZE - off);
 
-        config->cache = calloc(1,
-                               config->file_size +
-                               sizeof(DltLogStorageCacheFooter));
+        memcpy(cache->segments[idx] + off, data, n);
+        cache->dirty[idx] = 1;
 
-        /* update current used cache size */
-        g_logstorage_cache_size = config->file_size +
-                                  sizeof(DltLogStorageCacheFooter);
-
-        if (config->cache == NULL)
-        {
-            dlt_log(LOG_CRIT,
-                    "Cannot allocate memory for filter ring buffer\n");
-        }
+        pos += n;
+        data += n;
+        len -= n;
     }
-
-    return 0;
 }
 
 /**
- * dlt_logstorage_write_msg_cache
+ * dlt_logstorage_cache_msg_size
  *
- * Write the log message.
+ * Get the size of the stored message at a ring position.
  *
- * @param config        DltLogStorageConfigData
- * @param data1         header
- * @param size1         header size
- * @param data2         storage header
- * @param size2         storage header size
- * @param data3         payload
- * @param size3         payload size
- * @return 0 on success, -1 on error
+ * @param cache         Message cache
+ * @param pos           Ring position of the storage header
+ * @param end           End of the cached data
+ * @return size of the message, 0 if no valid message is found
  */
-int dlt_logstorage_write_msg_cache(DltLogStorageConfigData *config,
-                                   unsigned char *data1,
-                                   int size1,
-                                   unsigned char *data2,
-                                   int size2,
-                                   unsigned char *data3,
-                                   int size3)
+static unsigned int dlt_logstorage_cache_msg_size(DltLogStorageCache *cache,
+                                                  unsigned int pos,
+                                                  unsigned int end)
 {
-    DltLogStorageCacheFooter *footer = NULL;
-    int msg_size;
-    int remain_cache_size;
-    void *curr_write_addr = NULL;
+    unsigned char header[sizeof(DltStorageHeader) + sizeof(DltStandardHeader)];
+    DltStandardHeader *standardheader = NULL;
+    unsigned int idx;
+    unsigned int off;
+    unsigned int n;
+    unsigned int len = 0;
+    unsigned int size;
+
+    if (end - pos < sizeof(header))
+    {
+        return 0;
+    }
 
-    if (config == NULL || data1 == NULL || size1 < 0 || data2 == NULL ||
-        size2 < 0 || data3 == NULL || size3 < 0 || config->cache == NULL)
+    while (len < sizeof(header))
     {
-        return -1;
+        idx = (pos + len) / DLT_OFFLINE_LOGSTORAGE_CACHE_SEGMENT_SIZE;
+        off = (pos + len) % DLT_OFFLINE_LOGSTORAGE_CACHE_SEGMENT_SIZE;
+        n = DLT_OFFLINE_LOGSTORAGE_MIN(sizeof(header) - len,
+                                       DLT_OFFLINE_LOGSTORAGE_CACHE_SEGMENT_SIZE - off);
+
+        memcpy(header + len, cache->segments[idx] + off, n);
+        len += n;
     }
 
-    footer = (DltLogStorageCacheFooter *)(config->cache + config->file_size);
-    if (footer == NULL)
+    if (header[0] != 'D' || header[1] != 'L' || header[2] != 'T' ||
+        header[3] != 0x01)
     {
-        dlt_log(LOG_ERR, "Cannot retrieve cache footer. Address is NULL\n");
-        return -1;
+        return 0;
     }
 
-    msg_size = size1 + size2 + size3;
-    remain_cache_size = config->file_size - footer->offset;
+    standardheader = (DltStandardHeader *)(header + sizeof(DltStorageHeader));
+    size = sizeof(DltStorageHeader) + DLT_BETOH_16(standardheader->len);
 
-    if (msg_size < remain_cache_size) /* add at current position */
+    if (size < sizeof(header) || size > end - pos)
     {
-        curr_write_addr = (void *)(config->cache + footer->offset);
-        footer->offset += msg_size;
+        return 0;
     }
-    else if (msg_size > remain_cache_size)
+
+    return size;
+}
+
+/**
+ * dlt_logstorage_cache_release
+ *
+ * Drop the oldest messages of the previous wrap around which are
+ * overwritten up to a ring position.
+ *
+ * @param cache         Message cache
+ * @param limit         Ring position up to which data is overwritten
+ */
+static void dlt_logstorage_cache_release(DltLogStorageCache *cache,
+                                         unsigned int limit)
+{
+    unsigned int size;
+
+    while (cache->wrapped && cache->head < limit)
     {
-        if ((unsigned int) msg_size > config->file_size)
+        size = dlt_logstorage_cache_msg_size(cache, cache->head, cache->end);
+
+        if (size == 0 || cache->head + size >= cache->end)
         {
-            dlt_log(LOG_WARNING, "Message is larger than cache. Discard.\n");
-            return -1;
+            /* nothing left of the previous wrap around */
+            cache->head = 0;
+            cache->wrapped = 0;
+        }
+        else
+        {
+            cache->head += size;
         }
-
-        /* start writing from beginning */
-        curr_write_addr = config->cache;
-        footer->offset = msg_size;
-        footer->wrap_around_cnt += 1;
     }
-    else /* message just fits into cache */
+}
+
+/**
+ * dlt_logstorage_cache_start
+ *
+ * Get the ring position of the next message. A message is not split at the
+ * end of the cache but stored from the beginning.
+ *
+ * @param cache         Message cache
+ * @param msg_size      Size of the message
+ * @return ring position
+ */
+static unsigned int dlt_logstorage_cache_start(DltLogStorageCache *cache,
+                                               unsigned int msg_size)
+{
+    if (cache->offset + msg_size <= cache->size)
     {
-        curr_write_addr = (void *)(config->cache + footer->offset);
-        footer->offset = 0;
-        footer->wrap_around_cnt += 1;
+        return cache->offset;
     }
 
-    /* write data to cache */
-    memcpy(curr_write_addr, data1, size1);
-    curr_write_addr += size1;
-    memcpy(curr_write_addr, data2, size2);
-    curr_write_addr += size2;
-    memcpy(curr_write_addr, data3, size3);
-
     return 0;
 }
 
 /**
- * dlt_logstorage_sync_msg_cache
+ * dlt_logstorage_cache_flush_overlaps
  *
- * sync data to disk.
+ * Check if synced data which is not written yet would be overwritten.
  *
- * @param config        DltLogStorageConfigData
- * @param status        Strategy flag
- * @return 0 on success, -1 on error
+ * @param cache         Message cache
+ * @param start         Start of the ring range to be written
+ * @param end           End of the ring range to be written
+ * @return 1 if the ranges overlap, 0 otherwise
  */
-int dlt_logstorage_sync_msg_cache(DltLogStorageConfigData *config,
-                                  int status)
+static int dlt_logstorage_cache_flush_overlaps(DltLogStorageCache *cache,
+                                               unsigned int start,
+                                               unsigned int end)
 {
-    int ret = 0;
-    DltLogStorageCacheFooter *footer = NULL;
-
-    if (config == NULL)
+    if (cache->flush_log == NULL)
     {
-        return -1;
+        return 0;
     }
 
-    /* sync only, if given strategy is set */
-    if (DLT_OFFLINE_LOGSTORAGE_IS_STRATEGY_SET(config->sync, status) > 0)
+    if (cache->flush_wrapped)
     {
-        if (config->log == NULL || config->cache == NULL)
-        {
-            dlt_log(LOG_ERR,
-                    "Cannot copy cache to file. One of both is NULL\n");
-            return -1;
-        }
+        return (start < cache->flush_end && end > cache->flush_head) ||
+               (start < cache->flush_offset);
+    }
+
+    return (start < cache->flush_offset && end > cache->flush_head);
+}
 
-        /* TODO: write only what is needed */
-        /* write ring buffer into file */
-        footer = (DltLogStorageCacheFooter *)(config->cache +
-                                              config->file_size);
+/**
+ * dlt_logstorage_cache_destroy
+ *
+ * Free all segments of a cache and the cache itself.
+ *
+ * @param cache         Message cache
+ */
+static void dlt_logstorage_cache_destroy(DltLogStorageCache *cache)
+{
+    unsigned int i;
 
-        if (footer == NULL)
+    for (i = 0; i < cache->num_segments; i++)
+    {
+        if (cache->segments[i] != NULL)
         {
-            dlt_log(LOG_ERR, "Cannot retrieve cache information\n");
-            return -1;
+            free(cache->segments[i]);
+            g_logstorage_cache_size -= dlt_logstorage_cache_segment_size(cache, i);
         }
+    }
 
-        /* TODO: check if really the whole cache need to be written */
-        /* write cache to file */
-        ret = fwrite(config->cache, config->file_size, 1, config->log);
+    free(cache->segments);
+    free(cache->dirty);
+    free(cache);
+}
 
-        if (ret <= 0)
-        {
-            if (ferror(config->log) != 0)
-            {
-                dlt_log(LOG_CRIT, "Failed to write cache into log file\n");
-            }
-        }
-        else
+/**
+ * dlt_logstorage_cache_flush_done
+ *
+ * Close the log file of a completed or failed flush. Segments without data
+ * written after the sync are freed and allocated again when needed.
+ *
+ * @param cache         Message cache
+ * @param sync          Sync the log file to disk
+ */
+static void dlt_logstorage_cache_flush_done(DltLogStorageCache *cache,
+                                            int sync)
+{
+    DltLogStorageCache **pos = &g_logstorage_flush_list;
+    unsigned int i;
+
+    if (sync)
+    {
+        /* force sync */
+        if (fflush(cache->flush_log) != 0 ||
+            fsync(fileno(cache->flush_log)) != 0)
         {
-            /* force sync */
-            if (fsync(fileno(config->log)) != 0)
-            {
-                dlt_log(LOG_ERR, "Failed to sync log file\n");
-            }
+            dlt_log(LOG_ERR, "Failed to sync log file\n");
         }
+    }
 
-        /* do not reinitialize in case of ON_DAEMON_EXIT */
-        if (status != DLT_LOGSTORAGE_SYNC_ON_DAEMON_EXIT)
-        {
-            /* clean ring buffer and reset footer information */
-            memset(config->cache,
-                   0,
-                   config->file_size + sizeof(DltLogStorageCacheFooter));
+    fclose(cache->flush_log);
+    cache->flush_log = NULL;
 
-            /* close the file, a new one will be created when prepare is
-             * called again */
-            fclose(config->log);
-            config->log = NULL;
-        }
+    while (*pos != NULL && *pos != cache)
+    {
+        pos = &((*pos)->next_flush);
     }
 
-    return 0;
+    if (*pos != NULL)
+    {
+        *pos = cache->next_flush;
+    }
+
+    cache->next_flush = NULL;
+
+    if (cache->detached)
+    {
+        dlt_logstorage_cache_destroy(cache);
+        return;
+    }
+
+    for (i = 0; i < cache->num_segments; i++)
+    {
+        if (cache->segments[i] != NULL && cache->dirty[i] == 0)
+        {
+            free(cache->segments[i]);
+            cache->segments[i] = NULL;
+            g_logstorage_cache_size -= dlt_logstorage_cache_segment_size(cache, i);
+        }
+    }
+}
+
+/**
+ * dlt_logstorage_cache_flush
+ *
+ * Write synced data of a cache in chronological order into its log file.
+ *
+ * @param cache         Message cache
+ * @param budget        Maximum number of bytes to be written
+ * @return number of bytes written, -1 on error
+ */
+static int dlt_logstorage_cache_flush(DltLogStorageCache *cache,
+                                      unsigned int budget)
+{
+    unsigned int written = 0;
+    unsigned int limit;
+    unsigned int idx;
+    unsigned int off;
+    unsigned int n;
+
+    while (cache->flush_log != NULL && written < budget)
+    {
+        limit = cache->flush_wrapped ? cache->flush_end : cache->flush_offset;
+
+        if (cache->flush_head >= limit)
+        {
+            if (cache->flush_wrapped)
+            {
+                /* continue with the data from the beginning of the cache */
+                cache->flush_wrapped = 0;
+                cache->flush_head = 0;
+                continue;
+            }
+
+            dlt_logstorage_cache_flush_done(cache, 1);
+            break;
+        }
+
+        idx = cache->flush_head / DLT_OFFLINE_LOGSTORAGE_CACHE_SEGMENT_SIZE;
+        off = cache->flush_head % DLT_OFFLINE_LOGSTORAGE_CACHE_SEGMENT_SIZE;
+        n = DLT_OFFLINE_LOGSTORAGE_MIN(limit - cache->flush_head,
+                                       DLT_OFFLINE_LOGSTORAGE_CACHE_SEGMENT_SIZE - off);
+        n = DLT_OFFLINE_LOGSTORAGE_MIN(n, budget - written);
+
+        if (fwrite(cache->segments[idx] + off, 1, n, cache->flush_log) != n)
+        {
+            dlt_log(LOG_CRIT, "Failed to write cache into log file\n");
+            dlt_logstorage_cache_flush_done(cache, 0);
+            return -1;
+        }
+
+        cache->flush_head += n;
+        written += n;
+    }
+
+    return written;
+}
+
+int dlt_logstorage_flush_caches(unsigned int budget)
+{
+    DltLogStorageCache *cache = g_logstorage_flush_list;
+    DltLogStorageCache *next = NULL;
+    int written;
+
+    while (cache != NULL && budget > 0)
+    {
+        /* a completed cache is removed from the list */
+        next = cache->next_flush;
+        written = dlt_logstorage_cache_flush(cache, budget);
+
+        if (written > 0)
+        {
+            budget -= written;
+        }
+
+        cache = next;
+    }
+
+    return (g_logstorage_flush_list != NULL);
+}
+
+/**
+ * dlt_logstorage_prepare_msg_cache
+ *
+ * Prepare the log file for a certain filer. If log file not open or log
+ * files max size reached, open a new file.
+ * Create the message cache and allocate the cache segments the log message
+ * is stored in.
+ *
+ * @param config        DltLogStorageConfigData
+ * @param file_config   User configurations for log file
+ * @param dev_path      Storage device path
+ * @param log_msg_size  Size of log message
+ * @return 0 on success, -1 on error
+ */
+int dlt_logstorage_prepare_msg_cache(DltLogStorageConfigData *config,
+                                     DltLogStorageUserConfig *file_config,
+                                     char *dev_path,
+                                     int log_msg_size)
+{
+    DltLogStorageCache *cache = NULL;
+    unsigned int start;
+    unsigned int idx;
+    unsigned int last;
+    unsigned int size;
+
+    if (config == NULL || file_config == NULL || dev_path == NULL ||
+        log_msg_size < 0)
+    {
+        return -1;
+    }
+
+    if (config->file_size == 0)
+    {
+        dlt_log(LOG_ERR, "Cannot create cache of size 0\n");
+        return -1;
+    }
+
+    /* create file to sync cache into later */
+    if (config->log == NULL)
+    {
+        /* get always a new file */
+        if (dlt_logstorage_prepare_on_msg(config,
+                                          file_config,
+                                          dev_path,
+                                          config->file_size) != 0)
+        {
+            dlt_log(LOG_ERR,
+                    "Cannot prepare log file for ON_DAEMON_EXIT sync\n");
+            return -1;
+        }
+    }
+
+    /* create cache, segments are allocated when used */
+    if (config->cache == NULL)
+    {
+        cache = calloc(1, sizeof(DltLogStorageCache));
+
+        if (cache != NULL)
+        {
+            cache->size = config->file_size;
+            cache->num_segments = (config->file_size +
+                                   DLT_OFFLINE_LOGSTORAGE_CACHE_SEGMENT_SIZE - 1) /
+                                  DLT_OFFLINE_LOGSTORAGE_CACHE_SEGMENT_SIZE;
+            cache->segments = calloc(cache->num_segments, sizeof(unsigned char *));
+            cache->dirty = calloc(cache->num_segments, sizeof(unsigned char));
+        }
+
+        if (cache == NULL || cache->segments == NULL || cache->dirty == NULL)
+        {
+            dlt_log(LOG_CRIT,
+                    "Cannot allocate memory for filter ring buffer\n");
+
+            if (cache != NULL)
+            {
+                free(cache->segments);
+                free(cache->dirty);
+                free(cache);
+            }
+
+            return -1;
+        }
+
+        config->cache = cache;
+    }
+
+    cache = config->cache;
+
+    if ((unsigned int)log_msg_size > cache->size || log_msg_size == 0)
+    {
+        /* discarded on write */
+        return 0;
+    }
+
+    start = dlt_logstorage_cache_start(cache, log_msg_size);
+
+    /* synced data must be written before it is overwritten */
+    if (dlt_logstorage_cache_flush_overlaps(cache, start, start + log_msg_size))
+    {
+        dlt_logstorage_cache_flush(cache, UINT_MAX);
+    }
+
+    last = (start + log_msg_size - 1) / DLT_OFFLINE_LOGSTORAGE_CACHE_SEGMENT_SIZE;
+
+    for (idx = start / DLT_OFFLINE_LOGSTORAGE_CACHE_SEGMENT_SIZE; idx <= last; idx++)
+    {
+        if (cache->segments[idx] != NULL)
+        {
+            continue;
+        }
+
+        size = dlt_logstorage_cache_segment_size(cache, idx);
+
+        /* check total logstorage cache size */
+        if ((g_logstorage_cache_size + size) > g_logstorage_cache_max)
+        {
+            dlt_log(LOG_ERR, "Max size of Logstorage Cache already used.\n");
+            return -1;
+        }
+
+        cache->segments[idx] = malloc(size);
+
+        if (cache->segments[idx] == NULL)
+        {
+            dlt_log(LOG_CRIT,
+                    "Cannot allocate memory for filter ring buffer\n");
+            return -1;
+        }
+
+        /* update current used cache size */
+        g_logstorage_cache_size += size;
+    }
+
+    return 0;
+}
+
+/**
+ * dlt_logstorage_write_msg_cache
+ *
+ * Write the log message.
+ *
+ * @param config        DltLogStorageConfigData
+ * @param data1         header
+ * @param size1         header size
+ * @param data2         storage header
+ * @param size2         storage header size
+ * @param data3         payload
+ * @param size3         payload size
+ * @return 0 on success, -1 on error
+ */
+int dlt_logstorage_write_msg_cache(DltLogStorageConfigData *config,
+                                   unsigned char *data1,
+                                   int size1,
+                                   unsigned char *data2,
+                                   int size2,
+                                   unsigned char *data3,
+                                   int size3)
+{
+    DltLogStorageCache *cache = NULL;
+    unsigned int msg_size;
+    unsigned int start;
+
+    if (config == NULL || data1 == NULL || size1 < 0 || data2 == NULL ||
+        size2 < 0 || data3 == NULL || size3 < 0 || config->cache == NULL)
+    {
+        return -1;
+    }
+
+    cache = config->cache;
+    msg_size = size1 + size2 + size3;
+
+    if (msg_size > cache->size)
+    {
+        dlt_log(LOG_WARNING, "Message is larger than cache. Discard.\n");
+        return -1;
+    }
+
+    start = dlt_logstorage_cache_start(cache, msg_size);
+
+    if (start == 0 && cache->offset != 0) /* start writing from beginning */
+    {
+        /* the data before the previous wrap around is dropped */
+        if (cache->wrapped)
+        {
+            cache->head = 0;
+        }
+
+        if (cache->head == cache->offset) /* no data cached */
+        {
+            cache->head = 0;
+            cache->wrapped = 0;
+        }
+        else
+        {
+            cache->end = cache->offset;
+            cache->wrapped = 1;
+            dlt_logstorage_cache_release(cache, msg_size);
+        }
+
+        cache->wrap_around_cnt += 1;
+    }
+    else
+    {
+        dlt_logstorage_cache_release(cache, start + msg_size);
+    }
+
+    /* write data to cache */
+    dlt_logstorage_cache_copy(cache, start, data1, size1);
+    dlt_logstorage_cache_copy(cache, start + size1, data2, size2);
+    dlt_logstorage_cache_copy(cache, start + size1 + size2, data3, size3);
+    cache->offset = start + msg_size;
+
+    return 0;
+}
+
+/**
+ * dlt_logstorage_sync_msg_cache
+ *
+ * sync data to disk.
+ * The cached messages are handed over to be written in chronological order
+ * by dlt_logstorage_flush_caches, the cache continues with a new log file.
+ *
+ * @param config        DltLogStorageConfigData
+ * @param status        Strategy flag
+ * @return 0 on success, -1 on error
+ */
+int dlt_logstorage_sync_msg_cache(DltLogStorageConfigData *config,
+                                  int status)
+{
+    DltLogStorageCache *cache = NULL;
+
+    if (config == NULL)
+    {
+        return -1;
+    }
+
+    /* sync only, if given strategy is set */
+    if (DLT_OFFLINE_LOGSTORAGE_IS_STRATEGY_SET(config->sync, status) > 0)
+    {
+        if (config->log == NULL || config->cache == NULL)
+        {
+            dlt_log(LOG_ERR,
+                    "Cannot copy cache to file. One of both is NULL\n");
+            return -1;
+        }
+
+        cache = config->cache;
+
+        /* data of the previous sync is written first */
+        if (cache->flush_log != NULL)
+        {
+            dlt_logstorage_cache_flush(cache, UINT_MAX);
+        }
+
+        cache->flush_log = config->log;
+        cache->flush_head = cache->head;
+        cache->flush_end = cache->end;
+        cache->flush_offset = cache->offset;
+        cache->flush_wrapped = cache->wrapped;
+        memset(cache->dirty, 0, cache->num_segments);
+
+        cache->head = cache->offset;
+        cache->wrapped = 0;
+
+        cache->next_flush = g_logstorage_flush_list;
+        g_logstorage_flush_list = cache;
+
+        /* a new file will be created when prepare is called again */
+        config->log = NULL;
+    }
+
+    return 0;
+}
+
+/**
+ * dlt_logstorage_free_msg_cache
+ *
+ * Free the message cache of a filter. A cache with synced data which is not
+ * written yet is freed once the data is written.
+ *
+ * @param config        DltLogStorageConfigData
+ */
+void dlt_logstorage_free_msg_cache(DltLogStorageConfigData *config)
+{
+    DltLogStorageCache *cache = NULL;
+
+    if (config == NULL || config->cache == NULL)
+    {
+        return;
+    }
+
+    cache = config->cache;
+    config->cache = NULL;
+
+    if (cache->flush_log != NULL)
+    {
+        cache->detached = 1;
+        return;
+    }
+
+    dlt_logstorage_cache_destroy(cache);
+}
+
+/**
+ * dlt_logstorage_commit
+ *
+ * Write the collected messages of a group commit filter and an optional
+ * message with one writev call. Sync data to disk if the sync interval
+ * elapsed.
+ *
+ * @param config        DltLogStorageConfigData
+ * @param data1         header, NULL if no message is given
+ * @param size1         header size
+ * @param data2         storage header
+ * @param size2         storage header size
+ * @param data3         payload
+ * @param size3         payload size
+ * @return 0 on success, -1 on error
+ */
+static int dlt_logstorage_commit(DltLogStorageConfigData *config,
+                                 unsigned char *data1,
+                                 int size1,
+                                 unsigned char *data2,
+                                 int size2,
+                                 unsigned char *data3,
+                                 int size3)
+{
+    DltLogStorageGroupCommit *group = config->group_commit;
+    struct iovec iov[4];
+    struct iovec *pos = iov;
+    int iovcnt = 0;
+    size_t total = 0;
+    ssize_t ret;
+    uint32_t now;
+    uint32_t latency;
+    int latency_class;
+
+    if (group->used > 0)
+    {
+        iov[iovcnt].iov_base = group->buffer;
+        iov[iovcnt++].iov_len = group->used;
+    }
+
+    if (data1 != NULL)
+    {
+        iov[iovcnt].iov_base = data1;
+        iov[iovcnt++].iov_len = size1;
+        iov[iovcnt].iov_base = data2;
+        iov[iovcnt++].iov_len = size2;
+        iov[iovcnt].iov_base = data3;
+        iov[iovcnt++].iov_len = size3;
+    }
+
+    if (iovcnt == 0)
+    {
+        return 0;
+    }
+
+    now = dlt_uptime();
+    latency = (group->used > 0) ? (now - group->first_time) : 0;
+    group->used = 0;
+
+    /* write all data, continue after partial writes */
+    while (iovcnt > 0)
+    {
+        ret = writev(fileno(config->log), pos, iovcnt);
+
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            dlt_log(LOG_ERR, "Failed to write group commit into log file\n");
+            return -1;
+        }
+
+        total += ret;
+
+        while ((iovcnt > 0) && ((size_t)ret >= pos->iov_len))
+        {
+            ret -= pos->iov_len;
+            pos++;
+            iovcnt--;
+        }
+
+        if (iovcnt > 0)
+        {
+            pos->iov_base = (char *)pos->iov_base + ret;
+            pos->iov_len -= ret;
+        }
+    }
+
+    /* statistics, uptime is in 0.1 ms */
+    group->commits++;
+    group->bytes += total;
+
+    for (latency_class = 0;
+         (latency_class < DLT_OFFLINE_LOGSTORAGE_COMMIT_LATENCIES - 1) && (latency >= 10);
+         latency_class++)
+    {
+        latency /= 10;
+    }
+
+    group->latency[latency_class]++;
+
+    if ((config->commit_sync_interval > 0) &&
+        ((now - group->sync_time) / 10 >= config->commit_sync_interval))
+    {
+        if (fdatasync(fileno(config->log)) != 0)
+        {
+            dlt_log(LOG_ERR, "Failed to sync log file\n");
+        }
+
+        group->sync_time = now;
+    }
+
+    return 0;
+}
+
+/**
+ * dlt_logstorage_prepare_group_commit
+ *
+ * Prepare the log file for a certain filter like ON_MSG. Collected messages
+ * count for the current log file and are written before a new file is
+ * opened. Create the buffer for collected messages.
+ *
+ * @param config        DltLogStorageConfigData
+ * @param file_config   User configurations for log file
+ * @param dev_path      Storage device path
+ * @param log_msg_size  Size of log message
+ * @return 0 on success, -1 on error
+ */
+int dlt_logstorage_prepare_group_commit(DltLogStorageConfigData *config,
+                                        DltLogStorageUserConfig *file_config,
+                                        char *dev_path,
+                                        int log_msg_size)
+{
+    DltLogStorageGroupCommit *group = NULL;
+    struct stat s;
+
+    if (config == NULL || file_config == NULL || dev_path == NULL)
+    {
+        return -1;
+    }
+
+    if (config->group_commit == NULL)
+    {
+        group = calloc(1, sizeof(DltLogStorageGroupCommit));
+
+        if (group != NULL)
+        {
+            group->buffer = malloc(config->commit_size);
+        }
+
+        if (group == NULL || group->buffer == NULL)
+        {
+            dlt_log(LOG_CRIT,
+                    "Cannot allocate memory for group commit\n");
+            free(group);
+            return -1;
+        }
+
+        group->sync_time = dlt_uptime();
+        config->group_commit = group;
+    }
+
+    group = config->group_commit;
+
+    /* collected messages must be written into the current file */
+    if (config->log != NULL && group->used > 0)
+    {
+        if (fstat(fileno(config->log), &s) != 0)
+        {
+            dlt_log(LOG_ERR,
+                    "dlt_logstorage_prepare_group_commit: stat() failed.\n");
+            return -1;
+        }
+
+        if (s.st_size + group->used + log_msg_size >= config->file_size)
+        {
+            /* the message is added to the next file */
+            dlt_logstorage_commit(config, NULL, 0, NULL, 0, NULL, 0);
+        }
+    }
+
+    return dlt_logstorage_prepare_on_msg(config,
+                                         file_config,
+                                         dev_path,
+                                         log_msg_size + group->used);
+}
+
+/**
+ * dlt_logstorage_write_group_commit
+ *
+ * Add the log message to the collected messages. If they exceed the commit
+ * size, all are written together.
+ *
+ * @param config        DltLogStorageConfigData
+ * @param data1         header
+ * @param size1         header size
+ * @param data2         storage header
+ * @param size2         storage header size
+ * @param data3         payload
+ * @param size3         payload size
+ * @return 0 on success, -1 on error
+ */
+int dlt_logstorage_write_group_commit(DltLogStorageConfigData *config,
+                                      unsigned char *data1,
+                                      int size1,
+                                      unsigned char *data2,
+                                      int size2,
+                                      unsigned char *data3,
+                                      int size3)
+{
+    DltLogStorageGroupCommit *group = NULL;
+    unsigned int msg_size;
+
+    if (config == NULL || data1 == NULL || size1 < 0 || data2 == NULL ||
+        size2 < 0 || data3 == NULL || size3 < 0 ||
+        config->group_commit == NULL || config->log == NULL)
+    {
+        return -1;
+    }
+
+    group = config->group_commit;
+    msg_size = size1 + size2 + size3;
+
+    if (group->used + msg_size > config->commit_size)
+    {
+        /* one write call for the collected messages and this one */
+        return dlt_logstorage_commit(config,
+                                     data1,
+                                     size1,
+                                     data2,
+                                     size2,
+                                     data3,
+                                     size3);
+    }
+
+    if (group->used == 0)
+    {
+        group->first_time = dlt_uptime();
+    }
+
+    memcpy(group->buffer + group->used, data1, size1);
+    group->used += size1;
+    memcpy(group->buffer + group->used, data2, size2);
+    group->used += size2;
+    memcpy(group->buffer + group->used, data3, size3);
+    group->used += size3;
+
+    return 0;
+}
+
+/**
+ * dlt_logstorage_sync_group_commit
+ *
+ * Write the collected messages if the commit size or interval is reached.
+ * Any other strategy than ON_MSG, e.g. on daemon exit or device disconnect,
+ * writes them in any case.
+ *
+ * @param config        DltLogStorageConfigData
+ * @param status        Strategy flag
+ * @return 0 on success, -1 on error
+ */
+int dlt_logstorage_sync_group_commit(DltLogStorageConfigData *config,
+                                     int status)
+{
+    DltLogStorageGroupCommit *group = NULL;
+
+    if (config == NULL)
+    {
+        return -1;
+    }
+
+    group = config->group_commit;
+
+    if (group == NULL || group->used == 0 || config->log == NULL)
+    {
+        return 0;
+    }
+
+    if (status == DLT_LOGSTORAGE_SYNC_ON_MSG)
+    {
+        return dlt_logstorage_commit_group_due(config, 0);
+    }
+
+    return dlt_logstorage_commit(config, NULL, 0, NULL, 0, NULL, 0);
+}
+
+/**
+ * dlt_logstorage_commit_group_due
+ *
+ * Write the collected messages if the commit size is reached or the oldest
+ * one would exceed the commit interval before the next check.
+ *
+ * @param config        DltLogStorageConfigData
+ * @param period        Time in ms until the next check
+ * @return 0 on success, -1 on error
+ */
+int dlt_logstorage_commit_group_due(DltLogStorageConfigData *config,
+                                    int period)
+{
+    DltLogStorageGroupCommit *group = NULL;
+    uint32_t age;
+
+    if (config == NULL)
+    {
+        return -1;
+    }
+
+    group = config->group_commit;
+
+    if (group == NULL || group->used == 0 || config->log == NULL)
+    {
+        return 0;
+    }
+
+    /* uptime is in 0.1 ms */
+    age = (dlt_uptime() - group->first_time) / 10;
+
+    if ((group->used < config->commit_size) &&
+        (age + (uint32_t)period < config->commit_interval))
+    {
+        return 0;
+    }
+
+    return dlt_logstorage_commit(config, NULL, 0, NULL, 0, NULL, 0);
+}
+
+/**
+ * dlt_logstorage_group_commit_statistics
+ *
+ * Log the number of write calls, the bytes per write call and the commit
+ * latencies of a group commit filter.
+ *
+ * @param config        DltLogStorageConfigData
+ */
+void dlt_logstorage_group_commit_statistics(DltLogStorageConfigData *config)
+{
+    DltLogStorageGroupCommit *group = NULL;
+
+    if (config == NULL || config->group_commit == NULL)
+    {
+        return;
+    }
+
+    group = config->group_commit;
+
+    if (group->commits == 0)
+    {
+        return;
+    }
+
+    dlt_vlog(LOG_INFO,
+             "Logstorage group commit %s: %llu writes, %llu bytes per write, "
+             "latency <1ms: %llu, <10ms: %llu, <100ms: %llu, <1s: %llu, "
+             ">=1s: %llu\n",
+             config->file_name,
+             group->commits,
+             group->bytes / group->commits,
+             group->latency[0],
+             group->latency[1],
+             group->latency[2],
+             group->latency[3],
+             group->latency[4]);
 }
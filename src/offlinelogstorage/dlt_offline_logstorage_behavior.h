@@ -86,4 +86,39 @@ int dlt_logstorage_write_msg_cache(DltLogStorageConfigData *config,
 int dlt_logstorage_sync_msg_cache(DltLogStorageConfigData *config,
                                   int status);
 
+void dlt_logstorage_free_msg_cache(DltLogStorageConfigData *config);
+
+/* Log file lists */
+int dlt_logstorage_storage_dir_info(DltLogStorageUserConfig *file_config,
+                                    char *path,
+                                    DltLogStorageConfigData **config,
+                                    int num_config);
+
+void dlt_logstorage_file_list_free(DltLogStorageFileList *list);
+
+/* Group commit behavior */
+int dlt_logstorage_prepare_group_commit(DltLogStorageConfigData *config,
+                                        DltLogStorageUserConfig *file_config,
+                                        char *dev_path,
+                                        int log_msg_size);
+
+int dlt_logstorage_write_group_commit(DltLogStorageConfigData *config,
+                                      unsigned char *data1,
+                                      int size1,
+                                      unsigned char *data2,
+                                      int size2,
+                                      unsigned char *data3,
+                                      int size3);
+
+int dlt_logstorage_sync_group_commit(DltLogStorageConfigData *config,
+                                     int status);
+
+/* write messages which would wait longer than the commit interval
+ * before the next check in period ms */
+int dlt_logstorage_commit_group_due(DltLogStorageConfigData *config,
+                                    int period);
+
+/* log the statistics of a group commit filter */
+void dlt_logstorage_group_commit_statistics(DltLogStorageConfigData *config);
+
 #endif /* DLT_OFFLINELOGSTORAGE_DLT_OFFLINE_LOGSTORAGE_BEHAVIOR_H_ */
@@ -37,6 +37,11 @@
 
 #include <errno.h>
 #include <sys/stat.h> /* for mkdir() */
+#include <regex.h>    /* for regcomp(), regexec() */
+
+#if defined (__SSE2__)
+#include <emmintrin.h> /* for character classification of 16 bytes at once */
+#endif
 
 #include "dlt_user_shared.h"
 #include "dlt_common.h"
@@ -57,6 +62,8 @@
 #else
 #include <unistd.h>     /* for read(), close() */
 #include <sys/time.h>    /* for gettimeofday() */
+#include <sys/mman.h>    /* for mmap() */
+#include <pthread.h>
 #endif
 
 #if defined (__MSDOS__) || defined (_MSC_VER)
@@ -88,6 +95,7 @@ static char *service_id[] = {"","set_log_level","set_trace_status","get_log_info
                              "get_software_version","message_buffer_overflow"
                             };
 static char *return_type[] = {"ok","not_supported","error","","","","","","no_matching_context_id"};
+static const char hex_digits[] = "0123456789abcdef";
 
 /* internal function definitions */
 int dlt_buffer_get(DltBuffer *buf,unsigned char *data, int max_size,int delete);
@@ -135,21 +143,44 @@ DltReturnValue dlt_print_hex_string(char *text, int textlength, uint8_t *ptr, in
         return DLT_RETURN_ERROR;
     }
 
-    for (num=0; num<size; num++)
+    if (size == 0)
     {
-        if (num>0)
-        {
-            snprintf(text,2," ");
-            text++;
-        }
+        return DLT_RETURN_OK;
+    }
+
+    text[0] = hex_digits[ptr[0] >> 4];
+    text[1] = hex_digits[ptr[0] & 0x0f];
+    text+=2; /* 2 chars */
 
-        snprintf(text,3,"%.2x",((uint8_t*)ptr)[num]);
-        text+=2; /* 2 chars */
+    for (num=1; num<size; num++)
+    {
+        text[0] = ' ';
+        text[1] = hex_digits[ptr[num] >> 4];
+        text[2] = hex_digits[ptr[num] & 0x0f];
+        text+=3; /* space and 2 chars */
     }
 
+    *text = 0;
+
     return DLT_RETURN_OK;
 }
 
+/* Print the offset of a line of mixed output as 'XXXXXX: ' */
+static void dlt_print_line_number(char *text, int offset)
+{
+    int i;
+
+    for (i=5; i>=0; i--)
+    {
+        text[i] = hex_digits[offset & 0x0f];
+        offset >>= 4;
+    }
+
+    text[6] = ':';
+    text[7] = ' ';
+    text[8] = 0;
+}
+
 DltReturnValue dlt_print_mixed_string(char *text, int textlength ,uint8_t *ptr, int size, int html)
 {
     int required_size = 0;
@@ -186,11 +217,12 @@ DltReturnValue dlt_print_mixed_string(char *text, int textlength ,uint8_t *ptr,
     /* print full lines */
     for (lines=0; lines< (size / DLT_COMMON_HEX_CHARS); lines++)
     {
-        int ret = 0;
-        /* Line number */
-        ret = snprintf(text,DLT_COMMON_HEX_LINELEN+1,"%.6x: ",lines * DLT_COMMON_HEX_CHARS);
-        if ((ret < 0 ) || (ret >= (DLT_COMMON_HEX_LINELEN + 1)))
+        /* Line number, only the lower 24 bits fit into 'XXXXXX' */
+        if (lines * DLT_COMMON_HEX_CHARS > 0xffffff)
+        {
             dlt_log(LOG_WARNING, "line was truncated\n");
+        }
+        dlt_print_line_number(text, (lines * DLT_COMMON_HEX_CHARS) & 0xffffff);
         text+=DLT_COMMON_HEX_LINELEN; /* 'XXXXXX: ' */
 
         /* Hex-Output */
@@ -199,7 +231,7 @@ DltReturnValue dlt_print_mixed_string(char *text, int textlength ,uint8_t *ptr,
         dlt_print_hex_string(text,textlength,(uint8_t*)(ptr+(lines*DLT_COMMON_HEX_CHARS)),DLT_COMMON_HEX_CHARS);
         text+=((2*DLT_COMMON_HEX_CHARS)+(DLT_COMMON_HEX_CHARS-1)); /* 32 characters + 15 spaces */
 
-        snprintf(text,2," ");
+        *text = ' ';
         text+=DLT_COMMON_CHARLEN;
 
         /* Char-Output */
@@ -209,14 +241,16 @@ DltReturnValue dlt_print_mixed_string(char *text, int textlength ,uint8_t *ptr,
 
         if (html==0)
         {
-            snprintf(text,2,"\n");
+            *text = '\n';
             text+=DLT_COMMON_CHARLEN;
         }
         else
         {
-            snprintf(text,5,"<BR>");
+            memcpy(text,"<BR>",4);
             text+=(4*DLT_COMMON_CHARLEN);
         }
+
+        *text = 0;
     }
 
     /* print partial line */
@@ -224,13 +258,12 @@ DltReturnValue dlt_print_mixed_string(char *text, int textlength ,uint8_t *ptr,
 
     if (rest>0)
     {
-        /* Line number */
-        int ret = 0;
-        ret = snprintf(text,9,"%.6x: ", (size / DLT_COMMON_HEX_CHARS) * DLT_COMMON_HEX_CHARS);
-        if ((ret < 0) || (ret >= 9))
+        /* Line number, only the lower 24 bits fit into 'XXXXXX' */
+        if ((size / DLT_COMMON_HEX_CHARS) * DLT_COMMON_HEX_CHARS > 0xffffff)
         {
             dlt_log(LOG_WARNING, "line number was truncated");
         }
+        dlt_print_line_number(text, ((size / DLT_COMMON_HEX_CHARS) * DLT_COMMON_HEX_CHARS) & 0xffffff);
         text+=DLT_COMMON_HEX_LINELEN; /* 'XXXXXX: ' */
 
         /* Hex-Output */
@@ -241,11 +274,11 @@ DltReturnValue dlt_print_mixed_string(char *text, int textlength ,uint8_t *ptr,
 
         for (i=0;i<(DLT_COMMON_HEX_CHARS-rest);i++)
         {
-            snprintf(text,4," xx");
+            memcpy(text," xx",3);
             text+=(3*DLT_COMMON_CHARLEN);
         }
 
-        snprintf(text,2," ");
+        *text = ' ';
         text+=DLT_COMMON_CHARLEN;
 
         /* Char-Output */
@@ -274,27 +307,51 @@ DltReturnValue dlt_print_char_string(char **text, int textlength, uint8_t *ptr,
         return DLT_RETURN_WRONG_PARAMETER;
     }
 
-    for (num=0; num<size; num++)
+    num = 0;
+
+#if defined (__SSE2__)
+    {
+        /* signed compares, bytes from 0x80 are negative and not printable */
+        const __m128i below = _mm_set1_epi8(DLT_COMMON_ASCII_CHAR_SPACE - 1);
+        const __m128i above = _mm_set1_epi8(DLT_COMMON_ASCII_CHAR_TILDE + 1);
+        const __m128i lt = _mm_set1_epi8(DLT_COMMON_ASCII_CHAR_LT);
+        const __m128i dot = _mm_set1_epi8('.');
+
+        for (; num+16<=size; num+=16)
+        {
+            __m128i chars = _mm_loadu_si128((const __m128i *) (ptr+num));
+            __m128i printable = _mm_andnot_si128(_mm_cmpeq_epi8(chars, lt),
+                                                 _mm_and_si128(_mm_cmpgt_epi8(chars, below),
+                                                               _mm_cmplt_epi8(chars, above)));
+
+            _mm_storeu_si128((__m128i *) *text,
+                             _mm_or_si128(_mm_and_si128(printable, chars),
+                                          _mm_andnot_si128(printable, dot)));
+            (*text)+=16;
+        }
+    }
+#endif
+
+    for (; num<size; num++)
     {
-        if ( (((char*)ptr)[num]<DLT_COMMON_ASCII_CHAR_SPACE) || (((char*)ptr)[num]>DLT_COMMON_ASCII_CHAR_TILDE) )
+        /* replace non printable characters and < with . */
+        if ((ptr[num]<DLT_COMMON_ASCII_CHAR_SPACE) || (ptr[num]>DLT_COMMON_ASCII_CHAR_TILDE) ||
+            (ptr[num]==DLT_COMMON_ASCII_CHAR_LT))
         {
-            snprintf(*text,2,".");
+            **text = '.';
         }
         else
         {
-            /* replace < with . */
-            if (((char*)ptr)[num]!=DLT_COMMON_ASCII_CHAR_LT)
-            {
-                snprintf(*text,2,"%c",((char *)ptr)[num]);
-            }
-            else
-            {
-                snprintf(*text,2,".");
-            }
+            **text = (char) ptr[num];
         }
         (*text)++;
     }
 
+    if (size > 0)
+    {
+        **text = 0;
+    }
+
     return DLT_RETURN_OK;
 }
 
@@ -387,1168 +444,2938 @@ void dlt_clean_string(char *text, int length)
     }
 }
 
-DltReturnValue dlt_filter_init(DltFilter *filter, int verbose)
-{
-    PRINT_FUNCTION_VERBOSE(verbose);
+#define DLT_FILTER_PAYLOAD_MAX 64 /**< Maximum length of payload patterns of a filter */
+#define DLT_FILTER_HASH_SIZE 64 /**< Size of the hash set of filters matching only ids, power of two */
 
-    if (filter == NULL)
+/*
+ * Predicates of a filter besides application and context id
+ */
+#define DLT_FILTER_ECU      0x01 /**< ECU id */
+#define DLT_FILTER_TYPE     0x02 /**< message type */
+#define DLT_FILTER_LEVEL    0x04 /**< range of log levels */
+#define DLT_FILTER_SEID     0x08 /**< session id */
+#define DLT_FILTER_TMSP     0x10 /**< range of timestamps */
+#define DLT_FILTER_PAYLOAD  0x20 /**< payload contains a byte string */
+#define DLT_FILTER_REGEX    0x40 /**< payload as ASCII matches a regular expression */
+
+/**
+ * Further predicates of a filter, all of them have to match.
+ */
+typedef struct
+{
+    int flags;                             /**< DLT_FILTER_* predicates in use */
+    char ecu[DLT_ID_SIZE];                 /**< ECU id */
+    int type;                              /**< message type */
+    int level_min;                         /**< lowest matching log level */
+    int level_max;                         /**< highest matching log level */
+    uint32_t seid;                         /**< session id */
+    uint32_t tmsp_min;                     /**< lowest matching timestamp */
+    uint32_t tmsp_max;                     /**< highest matching timestamp */
+    char payload[DLT_FILTER_PAYLOAD_MAX];  /**< byte string searched in payload */
+    char pattern[DLT_FILTER_PAYLOAD_MAX];  /**< regular expression applied to payload */
+    regex_t regex;                         /**< compiled regular expression */
+} DltFilterRule;
+
+/**
+ * Compiled state of a DltFilter, allocated by dlt_filter_init().
+ * Filters without further predicates are kept in a hash set of their ids,
+ * the others are checked one after the other.
+ */
+struct sDltFilterCompiled
+{
+    DltFilterRule rule[DLT_FILTER_MAX];     /* further predicates of each filter */
+    uint64_t hash[DLT_FILTER_HASH_SIZE];    /* ids of filters without further predicates */
+    int hash_num[DLT_FILTER_HASH_SIZE];     /* index of filter + 1, 0 for empty slots */
+    int match_all;                          /* index + 1 of a filter matching every message */
+    int rules[DLT_FILTER_MAX];              /* indices of filters with further predicates */
+    int rules_counter;                      /* number of filters with further predicates */
+    int payload;                            /* set if a filter needs the payload */
+};
+
+/* predicates of filters of a DltFilter which was never initialised */
+static const DltFilterRule dlt_filter_no_rule;
+
+/* allocate the compiled state if the filter has none yet */
+static DltReturnValue dlt_filter_prepare(DltFilter *filter)
+{
+    if (filter->compiled == NULL)
     {
-        return DLT_RETURN_WRONG_PARAMETER;
-    }
+        filter->compiled = (struct sDltFilterCompiled *) calloc(1, sizeof(struct sDltFilterCompiled));
 
-    filter->counter = 0;
+        if (filter->compiled == NULL)
+        {
+            dlt_log(LOG_ERR, "Cannot allocate memory for filter\n");
+            return DLT_RETURN_ERROR;
+        }
+    }
 
     return DLT_RETURN_OK;
 }
 
-DltReturnValue dlt_filter_free(DltFilter *filter, int verbose)
+static const DltFilterRule *dlt_filter_rule(DltFilter *filter, int num)
 {
-    PRINT_FUNCTION_VERBOSE(verbose);
-
-    if (filter == NULL)
-    {
-        return DLT_RETURN_WRONG_PARAMETER;
-    }
-
-    return DLT_RETURN_OK;
+    return (filter->compiled != NULL) ? &(filter->compiled->rule[num]) : &dlt_filter_no_rule;
 }
 
-DltReturnValue dlt_filter_load(DltFilter *filter, const char *filename, int verbose)
+/* set if a filter needs the payload of messages */
+static int dlt_filter_needs_payload(DltFilter *filter)
 {
-    if (filter == NULL || filename == NULL)
-    {
-        return DLT_RETURN_WRONG_PARAMETER;
-    }
+    return (filter != NULL) && (filter->compiled != NULL) && filter->compiled->payload;
+}
 
-    FILE *handle;
-    char str1[DLT_COMMON_BUFFER_LENGTH];
-    char apid[DLT_ID_SIZE],ctid[DLT_ID_SIZE];
+/* key of the hash set of filters, an empty id is zero */
+static uint64_t dlt_filter_key(const char *apid, const char *ctid)
+{
+    uint32_t a = 0;
+    uint32_t c = 0;
 
-    PRINT_FUNCTION_VERBOSE(verbose);
+    memcpy(&a, apid, DLT_ID_SIZE);
+    memcpy(&c, ctid, DLT_ID_SIZE);
 
-    handle = fopen(filename,"r");
-    if (handle == NULL)
-    {
-        snprintf(str, DLT_COMMON_BUFFER_LENGTH, "Filter file %s cannot be opened!\n", filename);
-        dlt_log(LOG_WARNING, str);
-        return DLT_RETURN_ERROR;
-    }
+    return ((uint64_t) a << 32) | c;
+}
 
-    /* Reset filters */
-    filter->counter=0;
+static int dlt_filter_hash_find(DltFilter *filter, uint64_t key)
+{
+    int slot = (int) ((key * 0x9E3779B97F4A7C15ULL) >> 32) & (DLT_FILTER_HASH_SIZE - 1);
 
-    while (!feof(handle))
+    while (filter->compiled->hash_num[slot] != 0)
     {
-        str1[0]=0;
-        if (fscanf(handle,"%s",str1)!=1)
-        {
-            break;
-        }
-        if (str1[0]==0)
-        {
-            break;
-        }
-        printf(" %s",str1);
-        if (strcmp(str1,"----")==0)
-        {
-            dlt_set_id(apid,"");
-        }
-        else
-        {
-            dlt_set_id(apid,str1);
-        }
-
-        str1[0]=0;
-        if (fscanf(handle,"%s",str1)!=1)
-        {
-            break;
-        }
-        if (str1[0]==0)
-        {
-            break;
-        }
-        printf(" %s\r\n",str1);
-        if (strcmp(str1,"----")==0)
+        if (filter->compiled->hash[slot] == key)
         {
-            dlt_set_id(ctid,"");
-        }
-        else
-        {
-            dlt_set_id(ctid,str1);
+            return filter->compiled->hash_num[slot] - 1;
         }
 
-        if (filter->counter<DLT_FILTER_MAX)
-        {
-            dlt_filter_add(filter,apid,ctid,verbose);
-        }
-        else
-        {
-            snprintf(str,DLT_COMMON_BUFFER_LENGTH, "Maximum number (%d) of allowed filters reached, ignoring rest of filters!\n", DLT_FILTER_MAX);
-            dlt_log(LOG_WARNING, str);
-        }
+        slot = (slot + 1) & (DLT_FILTER_HASH_SIZE - 1);
     }
 
-    fclose(handle);
-
-    return DLT_RETURN_OK;
+    return -1;
 }
 
-DltReturnValue dlt_filter_save(DltFilter *filter, const char *filename, int verbose)
+/* rebuild the hash set of filters matching only ids and the list of the others */
+static void dlt_filter_compile(DltFilter *filter)
 {
-    if (filter == NULL || filename == NULL)
-    {
-        return DLT_RETURN_WRONG_PARAMETER;
-    }
-
-    FILE *handle;
     int num;
-    char buf[DLT_COMMON_BUFFER_LENGTH];
+    int slot;
+    uint64_t key;
 
-    PRINT_FUNCTION_VERBOSE(verbose);
-
-    handle = fopen(filename,"w");
-    if (handle == NULL)
-    {
-        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Filter file %s cannot be opened!\n",filename);
-        dlt_log(LOG_WARNING, str);
-        return DLT_RETURN_ERROR;
-    }
+    memset(filter->compiled->hash_num, 0, sizeof(filter->compiled->hash_num));
+    filter->compiled->match_all = 0;
+    filter->compiled->rules_counter = 0;
+    filter->compiled->payload = 0;
 
-    for (num=0;num<filter->counter;num++)
+    for (num = 0; num < filter->counter; num++)
     {
-        if (filter->apid[num][0]==0)
+        if (filter->compiled->rule[num].flags != 0)
         {
-            fprintf(handle,"---- ");
+            filter->compiled->rules[filter->compiled->rules_counter++] = num;
+
+            if (filter->compiled->rule[num].flags & (DLT_FILTER_PAYLOAD | DLT_FILTER_REGEX))
+            {
+                filter->compiled->payload = 1;
+            }
+
+            continue;
         }
-        else
+
+        key = dlt_filter_key(filter->apid[num], filter->ctid[num]);
+
+        if (key == 0)
         {
-            dlt_print_id(buf,filter->apid[num]);
-            fprintf(handle,"%s ",buf);
+            if (filter->compiled->match_all == 0)
+            {
+                filter->compiled->match_all = num + 1;
+            }
+
+            continue;
         }
-        if (filter->ctid[num][0]==0)
+
+        /* the table is larger than the number of filters, so a slot is always found */
+        slot = (int) ((key * 0x9E3779B97F4A7C15ULL) >> 32) & (DLT_FILTER_HASH_SIZE - 1);
+
+        while ((filter->compiled->hash_num[slot] != 0) && (filter->compiled->hash[slot] != key))
         {
-            fprintf(handle,"---- ");
+            slot = (slot + 1) & (DLT_FILTER_HASH_SIZE - 1);
         }
-        else
+
+        if (filter->compiled->hash_num[slot] == 0)
         {
-            dlt_print_id(buf,filter->ctid[num]);
-            fprintf(handle,"%s ",buf);
+            filter->compiled->hash[slot] = key;
+            filter->compiled->hash_num[slot] = num + 1;
         }
     }
-
-    fclose(handle);
-
-    return DLT_RETURN_OK;
 }
 
-int dlt_filter_find(DltFilter *filter, const char *apid, const char *ctid, int verbose)
+/* release the regular expressions of all filters */
+static void dlt_filter_release(DltFilter *filter)
 {
     int num;
 
-    PRINT_FUNCTION_VERBOSE(verbose);
-
-    if ((filter == NULL) || (apid == NULL))
+    if (filter->compiled == NULL)
     {
-        return -1;
+        filter->counter = 0;
+        return;
     }
 
-    for (num=0; num<filter->counter; num++)
+    for (num = 0; num < filter->counter; num++)
     {
-        if (memcmp(filter->apid[num],apid,DLT_ID_SIZE)==0)
+        if (filter->compiled->rule[num].flags & DLT_FILTER_REGEX)
         {
-            /* apid matches, now check for ctid */
-            if (ctid == NULL)
-            {
-                /* check if empty ctid matches */
-                //if (memcmp(filter->ctid[num],"",DLT_ID_SIZE)==0)//coverity complains here about Out-of-bounds access.
-                char empty_ctid[DLT_ID_SIZE]="";
-                if (memcmp(filter->ctid[num],empty_ctid,DLT_ID_SIZE)==0)
-                {
-                    return num;
-                }
-            }
-            else
-            {
-                if (memcmp(filter->ctid[num],ctid,DLT_ID_SIZE)==0)
-                {
-                    return num;
-                }
-            }
+            regfree(&(filter->compiled->rule[num].regex));
         }
+
+        filter->compiled->rule[num].flags = 0;
     }
 
-    return -1; /* Not found */
+    filter->counter = 0;
+    dlt_filter_compile(filter);
 }
 
-DltReturnValue dlt_filter_add(DltFilter *filter,const char *apid, const char *ctid, int verbose)
+DltReturnValue dlt_filter_init(DltFilter *filter, int verbose)
 {
     PRINT_FUNCTION_VERBOSE(verbose);
 
-    if ((filter == NULL) || (apid == NULL))
+    if (filter == NULL)
     {
         return DLT_RETURN_WRONG_PARAMETER;
     }
 
-    if (filter->counter >= DLT_FILTER_MAX)
+    memset(filter, 0, sizeof(DltFilter));
+
+    if (dlt_filter_prepare(filter) < DLT_RETURN_OK)
     {
-        sprintf(str, "Maximum number (%d) of allowed filters reached, ignoring filter!\n", DLT_FILTER_MAX);
-        dlt_log(LOG_WARNING, str);
         return DLT_RETURN_ERROR;
     }
 
-    /* add each filter (apid, ctid) only once to filter array */
-    if (dlt_filter_find(filter,apid,ctid,verbose)<0)
-    {
-        /* filter not found, so add it to filter array */
-        if (filter->counter<DLT_FILTER_MAX)
-        {
-            dlt_set_id(filter->apid[filter->counter],apid);
-            dlt_set_id(filter->ctid[filter->counter],(ctid?ctid:""));
-
-            filter->counter++;
-
-            return DLT_RETURN_OK;
-        }
-    }
+    dlt_filter_compile(filter);
 
-    return DLT_RETURN_ERROR;
+    return DLT_RETURN_OK;
 }
 
-DltReturnValue dlt_filter_delete(DltFilter *filter,const char *apid,const char *ctid, int verbose)
+DltReturnValue dlt_filter_free(DltFilter *filter, int verbose)
 {
-    int j,k;
-    int found=0;
-
     PRINT_FUNCTION_VERBOSE(verbose);
 
-    if ((filter == NULL) || (apid == NULL) || (ctid == NULL))
+    if (filter == NULL)
     {
         return DLT_RETURN_WRONG_PARAMETER;
     }
 
-    if (filter->counter>0)
-    {
-        /* Get first occurence of apid and ctid in filter array */
-        for (j=0; j<filter->counter; j++)
-        {
-            if ((memcmp(filter->apid[j],apid,DLT_ID_SIZE)==0) &&
-                (memcmp(filter->ctid[j],ctid,DLT_ID_SIZE)==0)
-               )
+    dlt_filter_release(filter);
+    free(filter->compiled);
+    filter->compiled = NULL;
 
-            {
-                found=1;
-                break;
-            }
-        }
+    return DLT_RETURN_OK;
+}
 
-        if (found)
+/* parse a name of a table or a number */
+static int dlt_filter_parse_number(const char *value, char **names, int count, unsigned long *number)
+{
+    char *end = NULL;
+    int num;
+
+    for (num = 0; num < count; num++)
+    {
+        if ((names[num][0] != 0) && (strcmp(value, names[num]) == 0))
         {
-            /* j is index */
-            /* Copy from j+1 til end to j til end-1 */
+            *number = num;
+            return 0;
+        }
+    }
 
-            dlt_set_id(filter->apid[j],"");
-            dlt_set_id(filter->ctid[j],"");
+    if ((value[0] < '0') || (value[0] > '9'))
+    {
+        return -1;
+    }
 
-            for (k=j; k<(filter->counter-1); k++)
-            {
-                dlt_set_id(filter->apid[k],filter->apid[k+1]);
-                dlt_set_id(filter->ctid[k],filter->ctid[k+1]);
-            }
+    errno = 0;
+    *number = strtoul(value, &end, 0);
 
-            filter->counter--;
-            return DLT_RETURN_OK;
-        }
+    if ((errno != 0) || (end == NULL) || (*end != 0) || (*number > UINT32_MAX))
+    {
+        return -1;
     }
 
-    return DLT_RETURN_ERROR;
+    return 0;
 }
 
-DltReturnValue dlt_message_init(DltMessage *msg, int verbose)
+/* parse a predicate like level<=warn, returns -1 if it is invalid */
+static int dlt_filter_parse_predicate(char *apid, char *ctid, DltFilterRule *rule, char *token)
 {
-    PRINT_FUNCTION_VERBOSE(verbose);
+    char *op = strpbrk(token, "=<>~");
+    char *value;
+    char oper;
+    size_t keylen;
+    unsigned long number = 0;
 
-    if (msg == NULL)
+    if (op == NULL)
     {
-        return DLT_RETURN_WRONG_PARAMETER;
+        return -1;
     }
 
-    /* initalise structure parameters */
-    msg->headersize = 0;
-    msg->datasize = 0;
-
-    msg->databuffer = NULL;
-    msg->databuffersize = 0;
-
-    msg->storageheader = NULL;
-    msg->standardheader = NULL;
-    msg->extendedheader = NULL;
+    keylen = op - token;
 
-    msg->found_serialheader = 0;
-
-    return DLT_RETURN_OK;
-}
-
-DltReturnValue dlt_message_free(DltMessage *msg, int verbose)
-{
-    PRINT_FUNCTION_VERBOSE(verbose);
-
-    if (msg == NULL)
+    if (op[0] == '=')
     {
-        return DLT_RETURN_WRONG_PARAMETER;
+        oper = '=';
+        value = op + 1;
     }
-    /* delete databuffer if exists */
-    if (msg->databuffer)
+    else if (op[1] == '=')
     {
-        free(msg->databuffer);
-        msg->databuffer = NULL;
-        msg->databuffersize = 0;
+        oper = op[0];
+        value = op + 2;
     }
-
-    return DLT_RETURN_OK;
-}
-
-DltReturnValue dlt_message_header(DltMessage *msg, char *text, int textlength, int verbose)
-{
-    return dlt_message_header_flags(msg, text, textlength, DLT_HEADER_SHOW_ALL, verbose);
-}
-
-DltReturnValue dlt_message_header_flags(DltMessage *msg, char *text, int textlength, int flags, int verbose)
-{
-    struct tm * timeinfo;
-    char buffer [DLT_COMMON_BUFFER_LENGTH];
-
-    PRINT_FUNCTION_VERBOSE(verbose);
-
-    if ((msg == NULL) || (text == NULL) || (textlength <= 0))
+    else
     {
-        return DLT_RETURN_WRONG_PARAMETER;
+        return -1;
     }
 
-    if ((flags<DLT_HEADER_SHOW_NONE) || (flags>DLT_HEADER_SHOW_ALL))
+    if (value[0] == 0)
     {
-        return DLT_RETURN_WRONG_PARAMETER;
+        return -1;
     }
 
-    text[0] = 0;
+    if ((keylen == 4) && (strncmp(token, "apid", keylen) == 0) && (oper == '='))
+    {
+        dlt_set_id(apid, value);
+    }
+    else if ((keylen == 4) && (strncmp(token, "ctid", keylen) == 0) && (oper == '='))
+    {
+        dlt_set_id(ctid, value);
+    }
+    else if ((keylen == 3) && (strncmp(token, "ecu", keylen) == 0) && (oper == '='))
+    {
+        dlt_set_id(rule->ecu, value);
+        rule->flags |= DLT_FILTER_ECU;
+    }
+    else if ((keylen == 4) && (strncmp(token, "type", keylen) == 0) && (oper == '='))
+    {
+        if ((dlt_filter_parse_number(value, message_type, 4, &number) < 0) || (number > 7))
+        {
+            return -1;
+        }
 
-    if ((flags & DLT_HEADER_SHOW_TIME) == DLT_HEADER_SHOW_TIME)
+        rule->type = (int) number;
+        rule->flags |= DLT_FILTER_TYPE;
+    }
+    else if ((keylen == 5) && (strncmp(token, "level", keylen) == 0) && (oper != '~'))
     {
-        /* print received time */
-        time_t tt = msg->storageheader->seconds;
-        timeinfo = localtime (&tt);
+        if ((dlt_filter_parse_number(value, log_info, 16, &number) < 0) || (number > 15))
+        {
+            return -1;
+        }
 
-        if (timeinfo != NULL)
+        if (!(rule->flags & DLT_FILTER_LEVEL))
         {
-            strftime (buffer,sizeof(buffer),"%Y/%m/%d %H:%M:%S",timeinfo);
-            snprintf(text,textlength,"%s.%.6d ",buffer,msg->storageheader->microseconds);
+            rule->level_min = 0;
+            rule->level_max = 15;
+            rule->flags |= DLT_FILTER_LEVEL;
         }
-    }
 
-    if ((flags & DLT_HEADER_SHOW_TMSTP) == DLT_HEADER_SHOW_TMSTP)
-    {
-        /* print timestamp if available */
-        if ( DLT_IS_HTYP_WTMS(msg->standardheader->htyp) )
+        if (oper != '<')
         {
-            snprintf(text+strlen(text),textlength-strlen(text),"%10u ",msg->headerextra.tmsp);
+            rule->level_min = (int) number;
         }
-        else
+
+        if (oper != '>')
         {
-            snprintf(text+strlen(text),textlength-strlen(text),"---------- ");
+            rule->level_max = (int) number;
         }
     }
-
-    if ((flags & DLT_HEADER_SHOW_MSGCNT) == DLT_HEADER_SHOW_MSGCNT)
+    else if ((keylen == 4) && (strncmp(token, "seid", keylen) == 0) && (oper == '='))
     {
-        /* print message counter */
-        snprintf(text+strlen(text),textlength-strlen(text),"%.3d ",msg->standardheader->mcnt);
-    }
+        if (dlt_filter_parse_number(value, NULL, 0, &number) < 0)
+        {
+            return -1;
+        }
 
-    if ((flags & DLT_HEADER_SHOW_ECUID) == DLT_HEADER_SHOW_ECUID)
+        rule->seid = (uint32_t) number;
+        rule->flags |= DLT_FILTER_SEID;
+    }
+    else if ((keylen == 4) && (strncmp(token, "tmsp", keylen) == 0) && (oper != '~'))
     {
-        /* print ecu id, use header extra if available, else storage header value */
-        if ( DLT_IS_HTYP_WEID(msg->standardheader->htyp) )
+        if (dlt_filter_parse_number(value, NULL, 0, &number) < 0)
         {
-            dlt_print_id(text+strlen(text),msg->headerextra.ecu);
+            return -1;
         }
-        else
+
+        if (!(rule->flags & DLT_FILTER_TMSP))
         {
-            dlt_print_id(text+strlen(text),msg->storageheader->ecu);
+            rule->tmsp_min = 0;
+            rule->tmsp_max = UINT32_MAX;
+            rule->flags |= DLT_FILTER_TMSP;
         }
-    }
 
-    /* print app id and context id if extended header available, else '----' */#
-    if ((flags & DLT_HEADER_SHOW_APID) == DLT_HEADER_SHOW_APID)
-    {
-        snprintf(text+strlen(text),textlength-strlen(text)," ");
-        if ((DLT_IS_HTYP_UEH(msg->standardheader->htyp)) && (msg->extendedheader->apid[0]!=0))
+        if (oper != '<')
         {
-            dlt_print_id(text+strlen(text),msg->extendedheader->apid);
+            rule->tmsp_min = (uint32_t) number;
         }
-        else
+
+        if (oper != '>')
         {
-            snprintf(text+strlen(text),textlength-strlen(text),"----");
+            rule->tmsp_max = (uint32_t) number;
         }
-
-        snprintf(text+strlen(text),textlength-strlen(text)," ");
     }
+    else if ((keylen == 7) && (strncmp(token, "payload", keylen) == 0) && (oper == '='))
+    {
+        if ((rule->flags & DLT_FILTER_PAYLOAD) || (strlen(value) >= DLT_FILTER_PAYLOAD_MAX))
+        {
+            return -1;
+        }
 
-    if ((flags & DLT_HEADER_SHOW_CTID) == DLT_HEADER_SHOW_CTID)
+        memcpy(rule->payload, value, strlen(value) + 1);
+        rule->flags |= DLT_FILTER_PAYLOAD;
+    }
+    else if ((keylen == 7) && (strncmp(token, "payload", keylen) == 0) && (oper == '~'))
     {
-        if ((DLT_IS_HTYP_UEH(msg->standardheader->htyp)) && (msg->extendedheader->ctid[0]!=0))
+        if ((rule->flags & DLT_FILTER_REGEX) || (strlen(value) >= DLT_FILTER_PAYLOAD_MAX))
         {
-            dlt_print_id(text+strlen(text),msg->extendedheader->ctid);
+            return -1;
         }
-        else
+
+        if (regcomp(&(rule->regex), value, REG_EXTENDED | REG_NOSUB) != 0)
         {
-            snprintf(text+strlen(text),textlength-strlen(text),"----");
+            return -1;
         }
 
-        snprintf(text+strlen(text),textlength-strlen(text)," ");
+        memcpy(rule->pattern, value, strlen(value) + 1);
+        rule->flags |= DLT_FILTER_REGEX;
+    }
+    else
+    {
+        return -1;
     }
 
-    /* print info about message type and length */
-    if (DLT_IS_HTYP_UEH(msg->standardheader->htyp))
+    return 0;
+}
+
+/* add a parsed filter, filters without further predicates are added only once */
+static void dlt_filter_append(DltFilter *filter, const char *apid, const char *ctid, DltFilterRule *rule, int verbose)
+{
+    if (filter->counter >= DLT_FILTER_MAX)
     {
-        if ((flags & DLT_HEADER_SHOW_MSGTYPE) == DLT_HEADER_SHOW_MSGTYPE)
+        snprintf(str, DLT_COMMON_BUFFER_LENGTH, "Maximum number (%d) of allowed filters reached, ignoring rest of filters!\n", DLT_FILTER_MAX);
+        dlt_log(LOG_WARNING, str);
+
+        if (rule->flags & DLT_FILTER_REGEX)
         {
-            snprintf(text+strlen(text),textlength-strlen(text),"%s",message_type[DLT_GET_MSIN_MSTP(msg->extendedheader->msin)]);
-            snprintf(text+strlen(text),textlength-strlen(text)," ");
+            regfree(&(rule->regex));
         }
 
-        if ((flags & DLT_HEADER_SHOW_MSGSUBTYPE) == DLT_HEADER_SHOW_MSGSUBTYPE)
-        {
-            if ((DLT_GET_MSIN_MSTP(msg->extendedheader->msin))==DLT_TYPE_LOG)
-            {
-                snprintf(text+strlen(text),textlength-strlen(text),"%s",log_info[DLT_GET_MSIN_MTIN(msg->extendedheader->msin)]);
-            }
+        return;
+    }
 
-            if ((DLT_GET_MSIN_MSTP(msg->extendedheader->msin))==DLT_TYPE_APP_TRACE)
-            {
-                snprintf(text+strlen(text),textlength-strlen(text),"%s",trace_type[DLT_GET_MSIN_MTIN(msg->extendedheader->msin)]);
-            }
+    if (rule->flags == 0)
+    {
+        dlt_filter_add(filter, apid, ctid, verbose);
+        return;
+    }
 
-            if ((DLT_GET_MSIN_MSTP(msg->extendedheader->msin))==DLT_TYPE_NW_TRACE)
-            {
-                snprintf(text+strlen(text),textlength-strlen(text),"%s",nw_trace_type[DLT_GET_MSIN_MTIN(msg->extendedheader->msin)]);
-            }
+    dlt_set_id(filter->apid[filter->counter], apid);
+    dlt_set_id(filter->ctid[filter->counter], ctid);
+    filter->compiled->rule[filter->counter] = *rule;
+    filter->counter++;
 
-            if ((DLT_GET_MSIN_MSTP(msg->extendedheader->msin))==DLT_TYPE_CONTROL)
-            {
-                snprintf(text+strlen(text),textlength-strlen(text),"%s",control_type[DLT_GET_MSIN_MTIN(msg->extendedheader->msin)]);
-            }
+    dlt_filter_compile(filter);
+}
 
-            snprintf(text+strlen(text),textlength-strlen(text)," ");
+/* parse one line of filter text, a line may hold several filters */
+static DltReturnValue dlt_filter_parse_line(DltFilter *filter, char *line, int print, int verbose)
+{
+    char *token;
+    char *saveptr = NULL;
+    char apid[DLT_ID_SIZE];
+    char ctid[DLT_ID_SIZE];
+    DltFilterRule rule;
+    int started = 0; /* a filter was started in this line */
+    int pending = 0; /* application id was read, context id is expected */
+    int printed = 0;
+
+    memset(&rule, 0, sizeof(rule));
+
+    for (token = strtok_r(line, " \t\r\n", &saveptr); token != NULL; token = strtok_r(NULL, " \t\r\n", &saveptr))
+    {
+        if (token[0] == '#')
+        {
+            break;
         }
 
-        if ((flags & DLT_HEADER_SHOW_VNVSTATUS) == DLT_HEADER_SHOW_VNVSTATUS)
+        if (print)
         {
-            /* print verbose status pf message */
-            if (DLT_IS_MSIN_VERB(msg->extendedheader->msin))
+            printf(" %s", token);
+            printed = 1;
+        }
+
+        if (strpbrk(token, "=<>~") == NULL)
+        {
+            if (pending)
             {
-                snprintf(text+strlen(text),textlength-strlen(text),"V");
+                dlt_set_id(ctid, (strcmp(token, "----") == 0) ? "" : token);
+                pending = 0;
+                continue;
             }
-            else
+
+            if (started)
             {
-                snprintf(text+strlen(text),textlength-strlen(text),"N");
+                dlt_filter_append(filter, apid, ctid, &rule, verbose);
+                memset(&rule, 0, sizeof(rule));
             }
 
-            snprintf(text+strlen(text),textlength-strlen(text)," ");
+            dlt_set_id(apid, (strcmp(token, "----") == 0) ? "" : token);
+            dlt_set_id(ctid, "");
+            started = 1;
+            pending = 1;
+            continue;
         }
 
-        if ((flags & DLT_HEADER_SHOW_NOARG) == DLT_HEADER_SHOW_NOARG)
+        if (pending)
         {
-            /* print number of arguments */
-            snprintf(text+strlen(text),textlength-strlen(text),"%d", msg->extendedheader->noar);
+            snprintf(str, DLT_COMMON_BUFFER_LENGTH, "Context id missing before filter predicate %s!\n", token);
+            dlt_log(LOG_WARNING, str);
+            return DLT_RETURN_ERROR;
         }
 
-    }
-    else
-    {
-        if ((flags & DLT_HEADER_SHOW_MSGTYPE) == DLT_HEADER_SHOW_MSGTYPE)
+        if (!started)
         {
-            snprintf(text+strlen(text),textlength-strlen(text),"--- ");
+            dlt_set_id(apid, "");
+            dlt_set_id(ctid, "");
+            started = 1;
         }
 
-        if ((flags & DLT_HEADER_SHOW_MSGSUBTYPE) == DLT_HEADER_SHOW_MSGSUBTYPE)
+        if (dlt_filter_parse_predicate(apid, ctid, &rule, token) < 0)
         {
-            snprintf(text+strlen(text),textlength-strlen(text),"--- ");
-        }
+            snprintf(str, DLT_COMMON_BUFFER_LENGTH, "Invalid filter predicate %s!\n", token);
+            dlt_log(LOG_WARNING, str);
 
-        if ((flags & DLT_HEADER_SHOW_VNVSTATUS) == DLT_HEADER_SHOW_VNVSTATUS)
-        {
-            snprintf(text+strlen(text),textlength-strlen(text),"N ");
-        }
+            if (rule.flags & DLT_FILTER_REGEX)
+            {
+                regfree(&(rule.regex));
+            }
 
-        if ((flags & DLT_HEADER_SHOW_NOARG) == DLT_HEADER_SHOW_NOARG)
-        {
-            snprintf(text+strlen(text),textlength-strlen(text),"-");
+            return DLT_RETURN_ERROR;
         }
     }
 
+    if (printed)
+    {
+        printf("\r\n");
+    }
+
+    if (pending)
+    {
+        dlt_log(LOG_WARNING, "Filter without context id ignored!\n");
+    }
+    else if (started)
+    {
+        dlt_filter_append(filter, apid, ctid, &rule, verbose);
+    }
+
     return DLT_RETURN_OK;
 }
 
-DltReturnValue dlt_message_payload(DltMessage *msg, char *text, int textlength, int type, int verbose)
+DltReturnValue dlt_filter_parse(DltFilter *filter, const char *text, int verbose)
 {
-    uint32_t id=0, id_tmp=0;
-    uint8_t retval=0;
-
-    uint8_t *ptr;
-    int32_t datalength;
-
-    /* Pointer to ptr and datalength */
-    uint8_t **pptr;
-    int32_t *pdatalength;
-
-    int ret=0;
-
-    int num;
-    uint32_t type_info=0,type_info_tmp=0;
+    char *copy;
+    char *line;
+    char *saveptr = NULL;
+    DltReturnValue ret = DLT_RETURN_OK;
 
     PRINT_FUNCTION_VERBOSE(verbose);
 
-    if ((msg == NULL) || (text == NULL))
+    if (filter == NULL || text == NULL)
     {
         return DLT_RETURN_WRONG_PARAMETER;
     }
 
-    if (textlength <= 0)
+    if (dlt_filter_prepare(filter) < DLT_RETURN_OK)
     {
-        dlt_log(LOG_WARNING, "String does not fit binary data!\n");
-        return DLT_RETURN_WRONG_PARAMETER;
+        return DLT_RETURN_ERROR;
     }
 
-    /* start with empty string */
-    text[0] = 0;
+    copy = strdup(text);
 
-    /* print payload only as hex */
-    if (type==DLT_OUTPUT_HEX)
+    if (copy == NULL)
     {
-        return dlt_print_hex_string(text, textlength, msg->databuffer, msg->datasize);
+        return DLT_RETURN_ERROR;
     }
 
-    /* print payload as mixed */
-    if (type==DLT_OUTPUT_MIXED_FOR_PLAIN)
+    for (line = strtok_r(copy, "\n", &saveptr); line != NULL; line = strtok_r(NULL, "\n", &saveptr))
     {
-        return dlt_print_mixed_string(text, textlength, msg->databuffer, msg->datasize,0);
+        ret = dlt_filter_parse_line(filter, line, 0, verbose);
+
+        if (ret < DLT_RETURN_OK)
+        {
+            break;
+        }
     }
 
-    if (type==DLT_OUTPUT_MIXED_FOR_HTML)
+    free(copy);
+
+    return ret;
+}
+
+DltReturnValue dlt_filter_load(DltFilter *filter, const char *filename, int verbose)
+{
+    if (filter == NULL || filename == NULL)
     {
-        return dlt_print_mixed_string(text, textlength, msg->databuffer, msg->datasize,1);
+        return DLT_RETURN_WRONG_PARAMETER;
     }
 
-    ptr = msg->databuffer;
-    datalength = msg->datasize;
+    FILE *handle;
+    char *line = NULL;
+    size_t size = 0;
+    DltReturnValue ret = DLT_RETURN_OK;
 
-    /* Pointer to ptr and datalength */
-    pptr = &ptr;
-    pdatalength = &datalength;
+    PRINT_FUNCTION_VERBOSE(verbose);
 
-    /* non-verbose mode */
+    handle = fopen(filename,"r");
+    if (handle == NULL)
+    {
+        snprintf(str, DLT_COMMON_BUFFER_LENGTH, "Filter file %s cannot be opened!\n", filename);
+        dlt_log(LOG_WARNING, str);
+        return DLT_RETURN_ERROR;
+    }
 
-    /* print payload as hex */
-    if (DLT_MSG_IS_NONVERBOSE(msg))
+    if (dlt_filter_prepare(filter) < DLT_RETURN_OK)
     {
+        fclose(handle);
+        return DLT_RETURN_ERROR;
+    }
 
-        DLT_MSG_READ_VALUE(id_tmp,ptr,datalength,uint32_t);
-        id=DLT_ENDIAN_GET_32(msg->standardheader->htyp, id_tmp);
+    /* Reset filters */
+    dlt_filter_release(filter);
+    memset(filter->apid, 0, sizeof(filter->apid));
+    memset(filter->ctid, 0, sizeof(filter->ctid));
 
-        if (textlength<((datalength*3)+20))
+    while (getline(&line, &size, handle) != -1)
+    {
+        ret = dlt_filter_parse_line(filter, line, 1, verbose);
+
+        if (ret < DLT_RETURN_OK)
         {
-            char str[255];
-            snprintf(str, 254, "String does not fit binary data (available=%d, required=%d) !\n", textlength, (datalength*3)+20);
-            dlt_log(LOG_WARNING, str);
-            return DLT_RETURN_ERROR;
+            dlt_filter_release(filter);
+            break;
         }
+    }
 
-        /* process message id / service id */
-        if (DLT_MSG_IS_CONTROL(msg))
-        {
-            if (id > 0 && id < DLT_SERVICE_ID_LAST_ENTRY)
-            {
-                snprintf(text+strlen(text),textlength-strlen(text),"%s",service_id[id]); /* service id */
-            }
-            else
-            {
-                if (!(DLT_MSG_IS_CONTROL_TIME(msg)))
-                {
-                    snprintf(text+strlen(text),textlength-strlen(text),"service(%u)",id); /* service id */
-                }
-            }
+    free(line);
+    fclose(handle);
 
-            if (datalength>0)
-            {
-                snprintf(text+strlen(text),textlength-strlen(text),", ");
-            }
-        }
-        else
+    return ret;
+}
+
+DltReturnValue dlt_filter_save(DltFilter *filter, const char *filename, int verbose)
+{
+    if (filter == NULL || filename == NULL)
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    FILE *handle;
+    int num;
+    const DltFilterRule *rule;
+
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    handle = fopen(filename,"w");
+    if (handle == NULL)
+    {
+        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Filter file %s cannot be opened!\n",filename);
+        dlt_log(LOG_WARNING, str);
+        return DLT_RETURN_ERROR;
+    }
+
+    for (num=0;num<filter->counter;num++)
+    {
+        if (filter->apid[num][0]==0)
         {
-            snprintf(text+strlen(text),textlength-strlen(text),"%u, ",id); /* message id */
+            fprintf(handle,"---- ");
         }
-
-        /* process return value */
-        if (DLT_MSG_IS_CONTROL_RESPONSE(msg))
+        else
         {
-            if (datalength>0)
-            {
-                DLT_MSG_READ_VALUE(retval,ptr,datalength,uint8_t); /* No endian conversion necessary */
-                if ( (retval<3) || (retval==8))
-                {
-                    snprintf(text+strlen(text),textlength-strlen(text),"%s",return_type[retval]);
-                }
-                else
-                {
-                    snprintf(text+strlen(text),textlength-strlen(text),"%.2x",retval);
-                }
-
-                if (datalength>=1)
-                {
-                    snprintf(text+strlen(text),textlength-strlen(text),", ");
-                }
-            }
+            /* ids shorter than four characters are written without padding */
+            fprintf(handle,"%.*s ",DLT_ID_SIZE,filter->apid[num]);
         }
-
-        if (type==DLT_OUTPUT_ASCII_LIMITED)
+        if (filter->ctid[num][0]==0)
         {
-            ret=dlt_print_hex_string(text+strlen(text),textlength-strlen(text),ptr,
-                                     (datalength>DLT_COMMON_ASCII_LIMIT_MAX_CHARS?DLT_COMMON_ASCII_LIMIT_MAX_CHARS:datalength));
-            if ((datalength>DLT_COMMON_ASCII_LIMIT_MAX_CHARS) &&
-                    ((textlength-strlen(text))>4))
-            {
-                snprintf(text+strlen(text),textlength-strlen(text)," ...");
-            }
+            fprintf(handle,"----");
         }
         else
         {
-            ret=dlt_print_hex_string(text+strlen(text),textlength-strlen(text),ptr,datalength);
+            fprintf(handle,"%.*s",DLT_ID_SIZE,filter->ctid[num]);
         }
 
-        return ret;
-    }
-
-    /* At this point, it is ensured that a extended header is available */
-
-    /* verbose mode */
-    type_info=0;
-    type_info_tmp=0;
+        rule = dlt_filter_rule(filter, num);
 
-    for (num=0;num<(int)(msg->extendedheader->noar);num++)
-    {
-        if (num!=0)
+        if (rule->flags & DLT_FILTER_ECU)
         {
-            snprintf(text+strlen(text),textlength-strlen(text)," ");
+            fprintf(handle," ecu=%.*s",DLT_ID_SIZE,rule->ecu);
         }
-
-        /* first read the type info of the argument */
-        DLT_MSG_READ_VALUE(type_info_tmp,ptr,datalength,uint32_t);
-        type_info=DLT_ENDIAN_GET_32(msg->standardheader->htyp, type_info_tmp);
-
-        /* print out argument */
-        if (dlt_message_argument_print(msg, type_info, pptr, pdatalength, text, textlength, -1, 0) == DLT_RETURN_ERROR)
+        if (rule->flags & DLT_FILTER_TYPE)
         {
-            return DLT_RETURN_ERROR;
+            fprintf(handle," type=%d",rule->type);
+        }
+        if (rule->flags & DLT_FILTER_LEVEL)
+        {
+            fprintf(handle," level>=%d level<=%d",rule->level_min,rule->level_max);
+        }
+        if (rule->flags & DLT_FILTER_SEID)
+        {
+            fprintf(handle," seid=%u",rule->seid);
         }
+        if (rule->flags & DLT_FILTER_TMSP)
+        {
+            fprintf(handle," tmsp>=%u tmsp<=%u",rule->tmsp_min,rule->tmsp_max);
+        }
+        if (rule->flags & DLT_FILTER_PAYLOAD)
+        {
+            fprintf(handle," payload=%s",rule->payload);
+        }
+        if (rule->flags & DLT_FILTER_REGEX)
+        {
+            fprintf(handle," payload~=%s",rule->pattern);
+        }
+
+        fprintf(handle,"\n");
     }
 
+    fclose(handle);
+
     return DLT_RETURN_OK;
 }
 
-DltReturnValue dlt_message_filter_check(DltMessage *msg, DltFilter *filter, int verbose)
+int dlt_filter_find(DltFilter *filter, const char *apid, const char *ctid, int verbose)
 {
-    /* check the filters if message is used */
-    int num;
-    DltReturnValue found = DLT_RETURN_OK;
+    char id_apid[DLT_ID_SIZE];
+    char id_ctid[DLT_ID_SIZE];
+    uint64_t key;
 
     PRINT_FUNCTION_VERBOSE(verbose);
 
-    if ((msg == NULL) || (filter == NULL))
+    if ((filter == NULL) || (apid == NULL) || (filter->compiled == NULL))
     {
-        return DLT_RETURN_WRONG_PARAMETER;
+        return -1;
     }
 
-    if ((filter->counter==0) || (!(DLT_IS_HTYP_UEH(msg->standardheader->htyp))))
-    {
-        /* no filter is set, or no extended header is available, so do as filter is matching */
-        return DLT_RETURN_TRUE;
-    }
+    /* check if empty ctid matches, if no ctid is given */
+    dlt_set_id(id_apid, apid);
+    dlt_set_id(id_ctid, (ctid == NULL) ? "" : ctid);
+    key = dlt_filter_key(id_apid, id_ctid);
 
-    for (num=0 ;num<filter->counter; num++)
+    if (key == 0)
     {
-        /* check each filter if it matches */
-        if ((DLT_IS_HTYP_UEH(msg->standardheader->htyp)) &&
-                (filter->apid[num][0]==0 || memcmp(filter->apid[num],msg->extendedheader->apid,DLT_ID_SIZE)==0) &&
-                (filter->ctid[num][0]==0 || memcmp(filter->ctid[num],msg->extendedheader->ctid,DLT_ID_SIZE)==0) )
-        {
-            found = DLT_RETURN_TRUE;
-            break;
-        }
+        return filter->compiled->match_all - 1;
     }
 
-    return found;
+    return dlt_filter_hash_find(filter, key);
 }
 
-int dlt_message_read(DltMessage *msg, uint8_t *buffer, unsigned int length, int resync, int verbose)
+DltReturnValue dlt_filter_add(DltFilter *filter,const char *apid, const char *ctid, int verbose)
 {
-    int extra_size = 0;
-
     PRINT_FUNCTION_VERBOSE(verbose);
 
-    if ((msg == NULL) || (buffer == NULL) || (length <= 0))
+    if ((filter == NULL) || (apid == NULL))
     {
-        return DLT_MESSAGE_ERROR_UNKNOWN;
+        return DLT_RETURN_WRONG_PARAMETER;
     }
 
-    /* initialize resync_offset */
-    msg->resync_offset=0;
-
-    /* check if message contains serial header, smaller than standard header */
-    if (length<sizeof(dltSerialHeader))
+    if (dlt_filter_prepare(filter) < DLT_RETURN_OK)
     {
-        /* dlt_log(LOG_ERR, "Length smaller than serial header!\n"); */
-        return DLT_MESSAGE_ERROR_SIZE;
+        return DLT_RETURN_ERROR;
     }
 
-    if (memcmp(buffer, dltSerialHeader, sizeof(dltSerialHeader)) == 0)
+    if (filter->counter >= DLT_FILTER_MAX)
     {
-        /* serial header found */
-        msg->found_serialheader = 1;
-        buffer += sizeof(dltSerialHeader);
-        length -= sizeof(dltSerialHeader);
+        sprintf(str, "Maximum number (%d) of allowed filters reached, ignoring filter!\n", DLT_FILTER_MAX);
+        dlt_log(LOG_WARNING, str);
+        return DLT_RETURN_ERROR;
     }
-    else
+
+    /* add each filter (apid, ctid) only once to filter array */
+    if (dlt_filter_find(filter,apid,ctid,verbose)<0)
     {
-        /* serial header not found */
-        msg->found_serialheader = 0;
-        if (resync)
+        /* filter not found, so add it to filter array */
+        if (filter->counter<DLT_FILTER_MAX)
         {
-            /* resync if necessary */
-            msg->resync_offset=0;
+            dlt_set_id(filter->apid[filter->counter],apid);
+            dlt_set_id(filter->ctid[filter->counter],(ctid?ctid:""));
+            memset(&(filter->compiled->rule[filter->counter]), 0, sizeof(DltFilterRule));
 
-            do
-            {
-                if (memcmp(buffer+msg->resync_offset, dltSerialHeader, sizeof(dltSerialHeader)) == 0)
-                {
-                    /* serial header found */
-                    msg->found_serialheader = 1;
-                    buffer += sizeof(dltSerialHeader);
-                    length -= sizeof(dltSerialHeader);
-                    break;
-                }
+            filter->counter++;
 
-                msg->resync_offset++;
-            }
-            while ((sizeof(dltSerialHeader)+msg->resync_offset)<=length);
+            dlt_filter_compile(filter);
 
-            /* Set new start offset */
-            if (msg->resync_offset>0)
-            {
-                /* Resyncing connection */
-                buffer+=msg->resync_offset;
-                length-=msg->resync_offset;
-            }
+            return DLT_RETURN_OK;
         }
     }
 
-    /* check that standard header fits buffer */
-    if (length<sizeof(DltStandardHeader))
-    {
-        /* dlt_log(LOG_ERR, "Length smaller than standard header!\n"); */
-        return DLT_MESSAGE_ERROR_SIZE;
-    }
-    memcpy(msg->headerbuffer+sizeof(DltStorageHeader), buffer, sizeof(DltStandardHeader));
-
-    /* set ptrs to structures */
-    msg->storageheader = (DltStorageHeader*) msg->headerbuffer;
-    msg->standardheader = (DltStandardHeader*) (msg->headerbuffer + sizeof(DltStorageHeader));
+    return DLT_RETURN_ERROR;
+}
 
-    /* calculate complete size of headers */
-    extra_size = DLT_STANDARD_HEADER_EXTRA_SIZE(msg->standardheader->htyp)+(DLT_IS_HTYP_UEH(msg->standardheader->htyp) ? sizeof(DltExtendedHeader) : 0);
-    msg->headersize = sizeof(DltStorageHeader) + sizeof(DltStandardHeader) + extra_size;
-    msg->datasize =  DLT_BETOH_16(msg->standardheader->len) - (msg->headersize - sizeof(DltStorageHeader));
+DltReturnValue dlt_filter_delete(DltFilter *filter,const char *apid,const char *ctid, int verbose)
+{
+    int j,k;
+    int found=0;
 
-    if (verbose)
-    {
-        snprintf(str,DLT_COMMON_BUFFER_LENGTH, "BufferLength=%d, HeaderSize=%d, DataSize=%d\n", length, msg->headersize, msg->datasize);
-        dlt_log(LOG_DEBUG, str);
-    }
+    PRINT_FUNCTION_VERBOSE(verbose);
 
-    /* check data size */
-    if (msg->datasize < 0)
+    if ((filter == NULL) || (apid == NULL) || (ctid == NULL))
     {
-        snprintf(str,DLT_COMMON_BUFFER_LENGTH, "Plausibility check failed. Complete message size too short (%d)!\n",msg->datasize);
-        dlt_log(LOG_WARNING, str);
-        return DLT_MESSAGE_ERROR_CONTENT;
+        return DLT_RETURN_WRONG_PARAMETER;
     }
 
-    /* load standard header extra parameters and Extended header if used */
-    if (extra_size>0)
+    if ((filter->counter>0) && (filter->compiled != NULL))
     {
-        if (length  < (msg->headersize - sizeof(DltStorageHeader)))
+        /* Get first occurence of apid and ctid in filter array */
+        for (j=0; j<filter->counter; j++)
         {
-            return DLT_MESSAGE_ERROR_SIZE;
-        }
-
-        memcpy(msg->headerbuffer+sizeof(DltStorageHeader)+sizeof(DltStandardHeader),buffer+sizeof(DltStandardHeader),extra_size);
+            if ((memcmp(filter->apid[j],apid,DLT_ID_SIZE)==0) &&
+                (memcmp(filter->ctid[j],ctid,DLT_ID_SIZE)==0)
+               )
 
-        /* set extended header ptr and get standard header extra parameters */
-        if (DLT_IS_HTYP_UEH(msg->standardheader->htyp))
-        {
-            msg->extendedheader = (DltExtendedHeader*) (msg->headerbuffer + sizeof(DltStorageHeader) + sizeof(DltStandardHeader) +
-                                  DLT_STANDARD_HEADER_EXTRA_SIZE(msg->standardheader->htyp));
-        }
-        else
-        {
-            msg->extendedheader = NULL;
+            {
+                found=1;
+                break;
+            }
+        }
+
+        if (found)
+        {
+            /* j is index */
+            /* Copy from j+1 til end to j til end-1 */
+
+            dlt_set_id(filter->apid[j],"");
+            dlt_set_id(filter->ctid[j],"");
+
+            if (filter->compiled->rule[j].flags & DLT_FILTER_REGEX)
+            {
+                regfree(&(filter->compiled->rule[j].regex));
+            }
+
+            for (k=j; k<(filter->counter-1); k++)
+            {
+                dlt_set_id(filter->apid[k],filter->apid[k+1]);
+                dlt_set_id(filter->ctid[k],filter->ctid[k+1]);
+                filter->compiled->rule[k] = filter->compiled->rule[k+1];
+            }
+
+            filter->counter--;
+            memset(&(filter->compiled->rule[filter->counter]), 0, sizeof(DltFilterRule));
+
+            dlt_filter_compile(filter);
+
+            return DLT_RETURN_OK;
+        }
+    }
+
+    return DLT_RETURN_ERROR;
+}
+
+DltReturnValue dlt_message_init(DltMessage *msg, int verbose)
+{
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if (msg == NULL)
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    /* initalise structure parameters */
+    msg->headersize = 0;
+    msg->datasize = 0;
+
+    msg->databuffer = NULL;
+    msg->databuffersize = 0;
+
+    msg->storageheader = NULL;
+    msg->standardheader = NULL;
+    msg->extendedheader = NULL;
+
+    msg->found_serialheader = 0;
+
+    return DLT_RETURN_OK;
+}
+
+DltReturnValue dlt_message_free(DltMessage *msg, int verbose)
+{
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if (msg == NULL)
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+    /* delete databuffer if exists */
+    if (msg->databuffer)
+    {
+        free(msg->databuffer);
+        msg->databuffer = NULL;
+        msg->databuffersize = 0;
+    }
+
+    return DLT_RETURN_OK;
+}
+
+DltReturnValue dlt_message_header(DltMessage *msg, char *text, int textlength, int verbose)
+{
+    return dlt_message_header_flags(msg, text, textlength, DLT_HEADER_SHOW_ALL, verbose);
+}
+
+DltReturnValue dlt_message_header_flags(DltMessage *msg, char *text, int textlength, int flags, int verbose)
+{
+    struct tm timeinfo;
+    char buffer [DLT_COMMON_BUFFER_LENGTH];
+
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if ((msg == NULL) || (text == NULL) || (textlength <= 0))
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    if ((flags<DLT_HEADER_SHOW_NONE) || (flags>DLT_HEADER_SHOW_ALL))
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    text[0] = 0;
+
+    if ((flags & DLT_HEADER_SHOW_TIME) == DLT_HEADER_SHOW_TIME)
+    {
+        /* print received time */
+        time_t tt = msg->storageheader->seconds;
+
+        /* reentrant, messages may be printed by several threads */
+        if (localtime_r(&tt, &timeinfo) != NULL)
+        {
+            strftime (buffer,sizeof(buffer),"%Y/%m/%d %H:%M:%S",&timeinfo);
+            snprintf(text,textlength,"%s.%.6d ",buffer,msg->storageheader->microseconds);
+        }
+    }
+
+    if ((flags & DLT_HEADER_SHOW_TMSTP) == DLT_HEADER_SHOW_TMSTP)
+    {
+        /* print timestamp if available */
+        if ( DLT_IS_HTYP_WTMS(msg->standardheader->htyp) )
+        {
+            snprintf(text+strlen(text),textlength-strlen(text),"%10u ",msg->headerextra.tmsp);
+        }
+        else
+        {
+            snprintf(text+strlen(text),textlength-strlen(text),"---------- ");
+        }
+    }
+
+    if ((flags & DLT_HEADER_SHOW_MSGCNT) == DLT_HEADER_SHOW_MSGCNT)
+    {
+        /* print message counter */
+        snprintf(text+strlen(text),textlength-strlen(text),"%.3d ",msg->standardheader->mcnt);
+    }
+
+    if ((flags & DLT_HEADER_SHOW_ECUID) == DLT_HEADER_SHOW_ECUID)
+    {
+        /* print ecu id, use header extra if available, else storage header value */
+        if ( DLT_IS_HTYP_WEID(msg->standardheader->htyp) )
+        {
+            dlt_print_id(text+strlen(text),msg->headerextra.ecu);
+        }
+        else
+        {
+            dlt_print_id(text+strlen(text),msg->storageheader->ecu);
+        }
+    }
+
+    /* print app id and context id if extended header available, else '----' */#
+    if ((flags & DLT_HEADER_SHOW_APID) == DLT_HEADER_SHOW_APID)
+    {
+        snprintf(text+strlen(text),textlength-strlen(text)," ");
+        if ((DLT_IS_HTYP_UEH(msg->standardheader->htyp)) && (msg->extendedheader->apid[0]!=0))
+        {
+            dlt_print_id(text+strlen(text),msg->extendedheader->apid);
+        }
+        else
+        {
+            snprintf(text+strlen(text),textlength-strlen(text),"----");
+        }
+
+        snprintf(text+strlen(text),textlength-strlen(text)," ");
+    }
+
+    if ((flags & DLT_HEADER_SHOW_CTID) == DLT_HEADER_SHOW_CTID)
+    {
+        if ((DLT_IS_HTYP_UEH(msg->standardheader->htyp)) && (msg->extendedheader->ctid[0]!=0))
+        {
+            dlt_print_id(text+strlen(text),msg->extendedheader->ctid);
+        }
+        else
+        {
+            snprintf(text+strlen(text),textlength-strlen(text),"----");
+        }
+
+        snprintf(text+strlen(text),textlength-strlen(text)," ");
+    }
+
+    /* print info about message type and length */
+    if (DLT_IS_HTYP_UEH(msg->standardheader->htyp))
+    {
+        if ((flags & DLT_HEADER_SHOW_MSGTYPE) == DLT_HEADER_SHOW_MSGTYPE)
+        {
+            snprintf(text+strlen(text),textlength-strlen(text),"%s",message_type[DLT_GET_MSIN_MSTP(msg->extendedheader->msin)]);
+            snprintf(text+strlen(text),textlength-strlen(text)," ");
+        }
+
+        if ((flags & DLT_HEADER_SHOW_MSGSUBTYPE) == DLT_HEADER_SHOW_MSGSUBTYPE)
+        {
+            if ((DLT_GET_MSIN_MSTP(msg->extendedheader->msin))==DLT_TYPE_LOG)
+            {
+                snprintf(text+strlen(text),textlength-strlen(text),"%s",log_info[DLT_GET_MSIN_MTIN(msg->extendedheader->msin)]);
+            }
+
+            if ((DLT_GET_MSIN_MSTP(msg->extendedheader->msin))==DLT_TYPE_APP_TRACE)
+            {
+                snprintf(text+strlen(text),textlength-strlen(text),"%s",trace_type[DLT_GET_MSIN_MTIN(msg->extendedheader->msin)]);
+            }
+
+            if ((DLT_GET_MSIN_MSTP(msg->extendedheader->msin))==DLT_TYPE_NW_TRACE)
+            {
+                snprintf(text+strlen(text),textlength-strlen(text),"%s",nw_trace_type[DLT_GET_MSIN_MTIN(msg->extendedheader->msin)]);
+            }
+
+            if ((DLT_GET_MSIN_MSTP(msg->extendedheader->msin))==DLT_TYPE_CONTROL)
+            {
+                snprintf(text+strlen(text),textlength-strlen(text),"%s",control_type[DLT_GET_MSIN_MTIN(msg->extendedheader->msin)]);
+            }
+
+            snprintf(text+strlen(text),textlength-strlen(text)," ");
+        }
+
+        if ((flags & DLT_HEADER_SHOW_VNVSTATUS) == DLT_HEADER_SHOW_VNVSTATUS)
+        {
+            /* print verbose status pf message */
+            if (DLT_IS_MSIN_VERB(msg->extendedheader->msin))
+            {
+                snprintf(text+strlen(text),textlength-strlen(text),"V");
+            }
+            else
+            {
+                snprintf(text+strlen(text),textlength-strlen(text),"N");
+            }
+
+            snprintf(text+strlen(text),textlength-strlen(text)," ");
+        }
+
+        if ((flags & DLT_HEADER_SHOW_NOARG) == DLT_HEADER_SHOW_NOARG)
+        {
+            /* print number of arguments */
+            snprintf(text+strlen(text),textlength-strlen(text),"%d", msg->extendedheader->noar);
+        }
+
+    }
+    else
+    {
+        if ((flags & DLT_HEADER_SHOW_MSGTYPE) == DLT_HEADER_SHOW_MSGTYPE)
+        {
+            snprintf(text+strlen(text),textlength-strlen(text),"--- ");
+        }
+
+        if ((flags & DLT_HEADER_SHOW_MSGSUBTYPE) == DLT_HEADER_SHOW_MSGSUBTYPE)
+        {
+            snprintf(text+strlen(text),textlength-strlen(text),"--- ");
+        }
+
+        if ((flags & DLT_HEADER_SHOW_VNVSTATUS) == DLT_HEADER_SHOW_VNVSTATUS)
+        {
+            snprintf(text+strlen(text),textlength-strlen(text),"N ");
+        }
+
+        if ((flags & DLT_HEADER_SHOW_NOARG) == DLT_HEADER_SHOW_NOARG)
+        {
+            snprintf(text+strlen(text),textlength-strlen(text),"-");
+        }
+    }
+
+    return DLT_RETURN_OK;
+}
+
+/* write the decimal representation of a value, returns the number of characters */
+static int dlt_print_decimal(char *text, uint64_t value, int negative)
+{
+    char digits[20];
+    int num = 0;
+    int len = 0;
+
+    do
+    {
+        digits[num++] = '0' + (value % 10);
+        value /= 10;
+    }
+    while (value > 0);
+
+    if (negative)
+    {
+        text[len++] = '-';
+    }
+
+    while (num > 0)
+    {
+        text[len++] = digits[--num];
+    }
+
+    text[len] = 0;
+
+    return len;
+}
+
+/* Print strings, booleans and decimal integers, the most frequent arguments,
+ * without formatting functions. The output is the same as of
+ * dlt_message_argument_print(). Returns 0 if the argument is not handled,
+ * e.g. because of its type, missing data or space, and must be printed by
+ * dlt_message_argument_print(). */
+static int dlt_message_argument_print_fast(DltMessage *msg, uint32_t type_info, uint8_t **ptr, int32_t *datalength, char *text, int textlength)
+{
+    uint16_t length = 0;
+    uint8_t value8u = 0;
+    uint16_t value16u = 0;
+    uint32_t value32u = 0;
+    uint64_t value64u = 0;
+    int size;
+
+    if (type_info & (DLT_TYPE_INFO_VARI | DLT_TYPE_INFO_FIXP))
+    {
+        return 0;
+    }
+
+    if ((type_info & DLT_TYPE_INFO_STRG) &&
+        (((type_info & DLT_TYPE_INFO_SCOD) == DLT_SCOD_ASCII) || ((type_info & DLT_TYPE_INFO_SCOD) == DLT_SCOD_UTF8)))
+    {
+        if (*datalength < (int32_t) sizeof(uint16_t))
+        {
+            return 0;
+        }
+
+        memcpy(&length, *ptr, sizeof(uint16_t));
+        length = DLT_ENDIAN_GET_16(msg->standardheader->htyp, length);
+
+        if ((length > INT16_MAX) || (length > *datalength - (int32_t) sizeof(uint16_t)) || (length >= textlength))
+        {
+            return 0;
+        }
+
+        memcpy(text, *ptr + sizeof(uint16_t), length);
+        dlt_clean_string(text, length);
+        text[length] = 0;
+
+        *ptr += sizeof(uint16_t) + length;
+        *datalength -= sizeof(uint16_t) + length;
+
+        return 1;
+    }
+
+    /* longest number is a sign and 20 digits */
+    if (textlength < 22)
+    {
+        return 0;
+    }
+
+    if (type_info & DLT_TYPE_INFO_BOOL)
+    {
+        if (*datalength < 1)
+        {
+            return 0;
+        }
+
+        dlt_print_decimal(text, **ptr, 0);
+        *ptr += 1;
+        *datalength -= 1;
+
+        return 1;
+    }
+
+    if (((type_info & DLT_TYPE_INFO_UINT) &&
+         ((DLT_SCOD_BIN == (type_info & DLT_TYPE_INFO_SCOD)) || (DLT_SCOD_HEX == (type_info & DLT_TYPE_INFO_SCOD)))) ||
+        !(type_info & (DLT_TYPE_INFO_SINT | DLT_TYPE_INFO_UINT)))
+    {
+        return 0;
+    }
+
+    switch (type_info & DLT_TYPE_INFO_TYLE)
+    {
+        case DLT_TYLE_8BIT:
+            size = 1;
+            break;
+        case DLT_TYLE_16BIT:
+            size = 2;
+            break;
+        case DLT_TYLE_32BIT:
+            size = 4;
+            break;
+        case DLT_TYLE_64BIT:
+            size = 8;
+            break;
+        default:
+            return 0;
+    }
+
+    if (*datalength < size)
+    {
+        return 0;
+    }
+
+    switch (size)
+    {
+        case 1:
+            value8u = **ptr;
+            value64u = (type_info & DLT_TYPE_INFO_SINT) ? (uint64_t) (int64_t) (int8_t) value8u : value8u;
+            break;
+        case 2:
+            memcpy(&value16u, *ptr, size);
+            value16u = DLT_ENDIAN_GET_16(msg->standardheader->htyp, value16u);
+            value64u = (type_info & DLT_TYPE_INFO_SINT) ? (uint64_t) (int64_t) (int16_t) value16u : value16u;
+            break;
+        case 4:
+            memcpy(&value32u, *ptr, size);
+            value32u = DLT_ENDIAN_GET_32(msg->standardheader->htyp, value32u);
+            value64u = (type_info & DLT_TYPE_INFO_SINT) ? (uint64_t) (int64_t) (int32_t) value32u : value32u;
+            break;
+        default:
+            /* 64 bit values are printed signed, also unsigned ones */
+            memcpy(&value64u, *ptr, size);
+            value64u = DLT_ENDIAN_GET_64(msg->standardheader->htyp, value64u);
+            break;
+    }
+
+    if (((size == 8) || (type_info & DLT_TYPE_INFO_SINT)) && ((int64_t) value64u < 0))
+    {
+        dlt_print_decimal(text, (uint64_t) 0 - value64u, 1);
+    }
+    else
+    {
+        dlt_print_decimal(text, value64u, 0);
+    }
+
+    *ptr += size;
+    *datalength -= size;
+
+    return 1;
+}
+
+DltReturnValue dlt_message_payload(DltMessage *msg, char *text, int textlength, int type, int verbose)
+{
+    uint32_t id=0, id_tmp=0;
+    uint8_t retval=0;
+
+    uint8_t *ptr;
+    int32_t datalength;
+
+    /* Pointer to ptr and datalength */
+    uint8_t **pptr;
+    int32_t *pdatalength;
+
+    int ret=0;
+
+    int num;
+    uint32_t type_info=0,type_info_tmp=0;
+    int end;
+
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if ((msg == NULL) || (text == NULL))
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    if (textlength <= 0)
+    {
+        dlt_log(LOG_WARNING, "String does not fit binary data!\n");
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    /* start with empty string */
+    text[0] = 0;
+
+    /* print payload only as hex */
+    if (type==DLT_OUTPUT_HEX)
+    {
+        return dlt_print_hex_string(text, textlength, msg->databuffer, msg->datasize);
+    }
+
+    /* print payload as mixed */
+    if (type==DLT_OUTPUT_MIXED_FOR_PLAIN)
+    {
+        return dlt_print_mixed_string(text, textlength, msg->databuffer, msg->datasize,0);
+    }
+
+    if (type==DLT_OUTPUT_MIXED_FOR_HTML)
+    {
+        return dlt_print_mixed_string(text, textlength, msg->databuffer, msg->datasize,1);
+    }
+
+    ptr = msg->databuffer;
+    datalength = msg->datasize;
+
+    /* Pointer to ptr and datalength */
+    pptr = &ptr;
+    pdatalength = &datalength;
+
+    /* non-verbose mode */
+
+    /* print payload as hex */
+    if (DLT_MSG_IS_NONVERBOSE(msg))
+    {
+
+        DLT_MSG_READ_VALUE(id_tmp,ptr,datalength,uint32_t);
+        id=DLT_ENDIAN_GET_32(msg->standardheader->htyp, id_tmp);
+
+        if (textlength<((datalength*3)+20))
+        {
+            char str[255];
+            snprintf(str, 254, "String does not fit binary data (available=%d, required=%d) !\n", textlength, (datalength*3)+20);
+            dlt_log(LOG_WARNING, str);
+            return DLT_RETURN_ERROR;
+        }
+
+        /* process message id / service id */
+        if (DLT_MSG_IS_CONTROL(msg))
+        {
+            if (id > 0 && id < DLT_SERVICE_ID_LAST_ENTRY)
+            {
+                snprintf(text+strlen(text),textlength-strlen(text),"%s",service_id[id]); /* service id */
+            }
+            else
+            {
+                if (!(DLT_MSG_IS_CONTROL_TIME(msg)))
+                {
+                    snprintf(text+strlen(text),textlength-strlen(text),"service(%u)",id); /* service id */
+                }
+            }
+
+            if (datalength>0)
+            {
+                snprintf(text+strlen(text),textlength-strlen(text),", ");
+            }
+        }
+        else
+        {
+            snprintf(text+strlen(text),textlength-strlen(text),"%u, ",id); /* message id */
+        }
+
+        /* process return value */
+        if (DLT_MSG_IS_CONTROL_RESPONSE(msg))
+        {
+            if (datalength>0)
+            {
+                DLT_MSG_READ_VALUE(retval,ptr,datalength,uint8_t); /* No endian conversion necessary */
+                if ( (retval<3) || (retval==8))
+                {
+                    snprintf(text+strlen(text),textlength-strlen(text),"%s",return_type[retval]);
+                }
+                else
+                {
+                    snprintf(text+strlen(text),textlength-strlen(text),"%.2x",retval);
+                }
+
+                if (datalength>=1)
+                {
+                    snprintf(text+strlen(text),textlength-strlen(text),", ");
+                }
+            }
+        }
+
+        if (type==DLT_OUTPUT_ASCII_LIMITED)
+        {
+            ret=dlt_print_hex_string(text+strlen(text),textlength-strlen(text),ptr,
+                                     (datalength>DLT_COMMON_ASCII_LIMIT_MAX_CHARS?DLT_COMMON_ASCII_LIMIT_MAX_CHARS:datalength));
+            if ((datalength>DLT_COMMON_ASCII_LIMIT_MAX_CHARS) &&
+                    ((textlength-strlen(text))>4))
+            {
+                snprintf(text+strlen(text),textlength-strlen(text)," ...");
+            }
+        }
+        else
+        {
+            ret=dlt_print_hex_string(text+strlen(text),textlength-strlen(text),ptr,datalength);
+        }
+
+        return ret;
+    }
+
+    /* At this point, it is ensured that a extended header is available */
+
+    /* verbose mode */
+    type_info=0;
+    type_info_tmp=0;
+
+    /* the end of the text is tracked, arguments are appended without searching it */
+    end = 0;
+
+    for (num=0;num<(int)(msg->extendedheader->noar);num++)
+    {
+        if ((num!=0) && (textlength-end > 1))
+        {
+            text[end++] = ' ';
+            text[end] = 0;
+        }
+
+        /* first read the type info of the argument */
+        DLT_MSG_READ_VALUE(type_info_tmp,ptr,datalength,uint32_t);
+        type_info=DLT_ENDIAN_GET_32(msg->standardheader->htyp, type_info_tmp);
+
+        /* print out argument */
+        if (!dlt_message_argument_print_fast(msg, type_info, pptr, pdatalength, text+end, textlength-end) &&
+            (dlt_message_argument_print(msg, type_info, pptr, pdatalength, text+end, textlength-end, -1, 0) == DLT_RETURN_ERROR))
+        {
+            return DLT_RETURN_ERROR;
+        }
+
+        end += strlen(text+end);
+    }
+
+    return DLT_RETURN_OK;
+}
+
+/* check the filter with further predicates, payload predicates are checked last */
+static int dlt_filter_rule_check(DltMessage *msg, DltFilter *filter, int num, int verbose)
+{
+    DltFilterRule *rule = &(filter->compiled->rule[num]);
+    char *ecu;
+    int mstp;
+    int mtin;
+
+    if ((filter->apid[num][0] != 0) && (memcmp(filter->apid[num], msg->extendedheader->apid, DLT_ID_SIZE) != 0))
+    {
+        return 0;
+    }
+
+    if ((filter->ctid[num][0] != 0) && (memcmp(filter->ctid[num], msg->extendedheader->ctid, DLT_ID_SIZE) != 0))
+    {
+        return 0;
+    }
+
+    if (rule->flags & (DLT_FILTER_TYPE | DLT_FILTER_LEVEL))
+    {
+        mstp = DLT_GET_MSIN_MSTP(msg->extendedheader->msin);
+        mtin = DLT_GET_MSIN_MTIN(msg->extendedheader->msin);
+
+        if ((rule->flags & DLT_FILTER_TYPE) && (mstp != rule->type))
+        {
+            return 0;
+        }
+
+        if ((rule->flags & DLT_FILTER_LEVEL) &&
+            ((mstp != DLT_TYPE_LOG) || (mtin < rule->level_min) || (mtin > rule->level_max)))
+        {
+            return 0;
+        }
+    }
+
+    if (rule->flags & DLT_FILTER_ECU)
+    {
+        if (DLT_IS_HTYP_WEID(msg->standardheader->htyp))
+        {
+            ecu = msg->headerextra.ecu;
+        }
+        else if (msg->storageheader != NULL)
+        {
+            ecu = msg->storageheader->ecu;
+        }
+        else
+        {
+            return 0;
+        }
+
+        if (memcmp(rule->ecu, ecu, DLT_ID_SIZE) != 0)
+        {
+            return 0;
+        }
+    }
+
+    if ((rule->flags & DLT_FILTER_SEID) &&
+        (!DLT_IS_HTYP_WSID(msg->standardheader->htyp) || (msg->headerextra.seid != rule->seid)))
+    {
+        return 0;
+    }
+
+    if ((rule->flags & DLT_FILTER_TMSP) &&
+        (!DLT_IS_HTYP_WTMS(msg->standardheader->htyp) ||
+         (msg->headerextra.tmsp < rule->tmsp_min) || (msg->headerextra.tmsp > rule->tmsp_max)))
+    {
+        return 0;
+    }
+
+    if (rule->flags & (DLT_FILTER_PAYLOAD | DLT_FILTER_REGEX))
+    {
+        if ((msg->databuffer == NULL) && (msg->datasize > 0))
+        {
+            return 0;
+        }
+
+        if ((rule->flags & DLT_FILTER_PAYLOAD) &&
+            (memmem(msg->databuffer, msg->datasize, rule->payload, strlen(rule->payload)) == NULL))
+        {
+            return 0;
+        }
+
+        if (rule->flags & DLT_FILTER_REGEX)
+        {
+            char text[DLT_COMMON_FILTER_TEXT_LENGTH];
+
+            if ((dlt_message_payload(msg, text, DLT_COMMON_FILTER_TEXT_LENGTH, DLT_OUTPUT_ASCII, verbose) < DLT_RETURN_OK) ||
+                (regexec(&(rule->regex), text, 0, NULL, 0) != 0))
+            {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+DltReturnValue dlt_message_filter_check(DltMessage *msg, DltFilter *filter, int verbose)
+{
+    /* check the filters if message is used */
+    int num;
+    uint64_t key;
+
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if ((msg == NULL) || (filter == NULL))
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    if ((filter->counter==0) || (filter->compiled == NULL) || (!(DLT_IS_HTYP_UEH(msg->standardheader->htyp))))
+    {
+        /* no filter is set, or no extended header is available, so do as filter is matching */
+        return DLT_RETURN_TRUE;
+    }
+
+    if (filter->compiled->match_all)
+    {
+        return DLT_RETURN_TRUE;
+    }
+
+    /* exact ids, any context of the application and the context of any application */
+    key = dlt_filter_key(msg->extendedheader->apid, msg->extendedheader->ctid);
+
+    if ((dlt_filter_hash_find(filter, key) >= 0) ||
+        (dlt_filter_hash_find(filter, key & 0xFFFFFFFF00000000ULL) >= 0) ||
+        (dlt_filter_hash_find(filter, key & 0x00000000FFFFFFFFULL) >= 0))
+    {
+        return DLT_RETURN_TRUE;
+    }
+
+    for (num = 0; num < filter->compiled->rules_counter; num++)
+    {
+        if (dlt_filter_rule_check(msg, filter, filter->compiled->rules[num], verbose))
+        {
+            return DLT_RETURN_TRUE;
+        }
+    }
+
+    return DLT_RETURN_OK;
+}
+
+int dlt_message_read(DltMessage *msg, uint8_t *buffer, unsigned int length, int resync, int verbose)
+{
+    int ret;
+
+    ret = dlt_message_read_header(msg, buffer, length, resync, verbose);
+    if (ret != DLT_MESSAGE_ERROR_OK)
+    {
+        return ret;
+    }
+
+    /* skip serial header and resync offset */
+    buffer += msg->resync_offset;
+    if (msg->found_serialheader)
+    {
+        buffer += sizeof(dltSerialHeader);
+    }
+
+    /* free last used memory for buffer */
+    if (msg->databuffer)
+    {
+        if (msg->datasize>msg->databuffersize){
+            free(msg->databuffer);
+            msg->databuffer=(uint8_t *)malloc(msg->datasize);
+            msg->databuffersize = msg->datasize;
+        }
+    }else{
+        /* get new memory for buffer */
+        msg->databuffer = (uint8_t *)malloc(msg->datasize);
+        msg->databuffersize = msg->datasize;
+    }
+    if (msg->databuffer == NULL)
+    {
+        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Cannot allocate memory for payload buffer of size %d!\n",msg->datasize);
+        dlt_log(LOG_WARNING, str);
+        return DLT_MESSAGE_ERROR_UNKNOWN;
+    }
+
+    /* load payload data from buffer */
+    memcpy(msg->databuffer,buffer+(msg->headersize-sizeof(DltStorageHeader)),msg->datasize);
+
+    return DLT_MESSAGE_ERROR_OK;
+}
+
+int dlt_message_read_view(DltMessage *msg, uint8_t *buffer, unsigned int length, int resync, int verbose)
+{
+    int ret;
+
+    ret = dlt_message_read_header(msg, buffer, length, resync, verbose);
+    if (ret != DLT_MESSAGE_ERROR_OK)
+    {
+        return ret;
+    }
+
+    /* skip serial header and resync offset */
+    buffer += msg->resync_offset;
+    if (msg->found_serialheader)
+    {
+        buffer += sizeof(dltSerialHeader);
+    }
+
+    /* payload stays in buffer */
+    msg->databuffer = buffer + (msg->headersize - sizeof(DltStorageHeader));
+    msg->databuffersize = 0;
+
+    return DLT_MESSAGE_ERROR_OK;
+}
+
+int dlt_message_read_header(DltMessage *msg, uint8_t *buffer, unsigned int length, int resync, int verbose)
+{
+    int extra_size = 0;
+
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if ((msg == NULL) || (buffer == NULL) || (length <= 0))
+    {
+        return DLT_MESSAGE_ERROR_UNKNOWN;
+    }
+
+    /* initialize resync_offset */
+    msg->resync_offset=0;
+
+    /* check if message contains serial header, smaller than standard header */
+    if (length<sizeof(dltSerialHeader))
+    {
+        /* dlt_log(LOG_ERR, "Length smaller than serial header!\n"); */
+        return DLT_MESSAGE_ERROR_SIZE;
+    }
+
+    if (memcmp(buffer, dltSerialHeader, sizeof(dltSerialHeader)) == 0)
+    {
+        /* serial header found */
+        msg->found_serialheader = 1;
+        buffer += sizeof(dltSerialHeader);
+        length -= sizeof(dltSerialHeader);
+    }
+    else
+    {
+        /* serial header not found */
+        msg->found_serialheader = 0;
+        if (resync)
+        {
+            /* resync if necessary */
+            msg->resync_offset=0;
+
+            do
+            {
+                if (memcmp(buffer+msg->resync_offset, dltSerialHeader, sizeof(dltSerialHeader)) == 0)
+                {
+                    /* serial header found */
+                    msg->found_serialheader = 1;
+                    buffer += sizeof(dltSerialHeader);
+                    length -= sizeof(dltSerialHeader);
+                    break;
+                }
+
+                msg->resync_offset++;
+            }
+            while ((sizeof(dltSerialHeader)+msg->resync_offset)<=length);
+
+            /* Set new start offset */
+            if (msg->resync_offset>0)
+            {
+                /* Resyncing connection */
+                buffer+=msg->resync_offset;
+                length-=msg->resync_offset;
+            }
+        }
+    }
+
+    /* check that standard header fits buffer */
+    if (length<sizeof(DltStandardHeader))
+    {
+        /* dlt_log(LOG_ERR, "Length smaller than standard header!\n"); */
+        return DLT_MESSAGE_ERROR_SIZE;
+    }
+    memcpy(msg->headerbuffer+sizeof(DltStorageHeader), buffer, sizeof(DltStandardHeader));
+
+    /* set ptrs to structures */
+    msg->storageheader = (DltStorageHeader*) msg->headerbuffer;
+    msg->standardheader = (DltStandardHeader*) (msg->headerbuffer + sizeof(DltStorageHeader));
+
+    /* calculate complete size of headers */
+    extra_size = DLT_STANDARD_HEADER_EXTRA_SIZE(msg->standardheader->htyp)+(DLT_IS_HTYP_UEH(msg->standardheader->htyp) ? sizeof(DltExtendedHeader) : 0);
+    msg->headersize = sizeof(DltStorageHeader) + sizeof(DltStandardHeader) + extra_size;
+    msg->datasize =  DLT_BETOH_16(msg->standardheader->len) - (msg->headersize - sizeof(DltStorageHeader));
+
+    if (verbose)
+    {
+        snprintf(str,DLT_COMMON_BUFFER_LENGTH, "BufferLength=%d, HeaderSize=%d, DataSize=%d\n", length, msg->headersize, msg->datasize);
+        dlt_log(LOG_DEBUG, str);
+    }
+
+    /* check data size */
+    if (msg->datasize < 0)
+    {
+        snprintf(str,DLT_COMMON_BUFFER_LENGTH, "Plausibility check failed. Complete message size too short (%d)!\n",msg->datasize);
+        dlt_log(LOG_WARNING, str);
+        return DLT_MESSAGE_ERROR_CONTENT;
+    }
+
+    /* load standard header extra parameters and Extended header if used */
+    if (extra_size>0)
+    {
+        if (length  < (msg->headersize - sizeof(DltStorageHeader)))
+        {
+            return DLT_MESSAGE_ERROR_SIZE;
+        }
+
+        memcpy(msg->headerbuffer+sizeof(DltStorageHeader)+sizeof(DltStandardHeader),buffer+sizeof(DltStandardHeader),extra_size);
+
+        /* set extended header ptr and get standard header extra parameters */
+        if (DLT_IS_HTYP_UEH(msg->standardheader->htyp))
+        {
+            msg->extendedheader = (DltExtendedHeader*) (msg->headerbuffer + sizeof(DltStorageHeader) + sizeof(DltStandardHeader) +
+                                  DLT_STANDARD_HEADER_EXTRA_SIZE(msg->standardheader->htyp));
+        }
+        else
+        {
+            msg->extendedheader = NULL;
         }
 
         dlt_message_get_extraparameters(msg,verbose);
     }
 
-    /* check if payload fits length */
-    if (length  < (msg->headersize - sizeof(DltStorageHeader) + msg->datasize))
+    /* check if payload fits length */
+    if (length  < (msg->headersize - sizeof(DltStorageHeader) + msg->datasize))
+    {
+        /* dlt_log(LOG_ERR,"length does not fit!\n"); */
+        return DLT_MESSAGE_ERROR_SIZE;
+    }
+
+    return DLT_MESSAGE_ERROR_OK;
+}
+
+DltReturnValue dlt_message_get_extraparameters(DltMessage *msg, int verbose)
+{
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if (msg == NULL)
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    if (DLT_IS_HTYP_WEID(msg->standardheader->htyp))
+    {
+        memcpy(msg->headerextra.ecu,msg->headerbuffer + sizeof(DltStorageHeader) + sizeof(DltStandardHeader),DLT_ID_SIZE);
+    }
+
+    if (DLT_IS_HTYP_WSID(msg->standardheader->htyp))
+    {
+        memcpy(&(msg->headerextra.seid),msg->headerbuffer + sizeof(DltStorageHeader) + sizeof(DltStandardHeader)
+               + (DLT_IS_HTYP_WEID(msg->standardheader->htyp) ? DLT_SIZE_WEID : 0), DLT_SIZE_WSID);
+        msg->headerextra.seid = DLT_BETOH_32(msg->headerextra.seid);
+    }
+
+    if (DLT_IS_HTYP_WTMS(msg->standardheader->htyp))
+    {
+        memcpy(&(msg->headerextra.tmsp),msg->headerbuffer + sizeof(DltStorageHeader) + sizeof(DltStandardHeader)
+               + (DLT_IS_HTYP_WEID(msg->standardheader->htyp) ? DLT_SIZE_WEID : 0)
+               + (DLT_IS_HTYP_WSID(msg->standardheader->htyp) ? DLT_SIZE_WSID : 0),DLT_SIZE_WTMS);
+        msg->headerextra.tmsp = DLT_BETOH_32(msg->headerextra.tmsp);
+    }
+
+    return DLT_RETURN_OK;
+}
+
+DltReturnValue dlt_message_set_extraparameters(DltMessage *msg, int verbose)
+{
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if (msg == NULL)
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    if (DLT_IS_HTYP_WEID(msg->standardheader->htyp))
+    {
+        memcpy(msg->headerbuffer + sizeof(DltStorageHeader) + sizeof(DltStandardHeader),msg->headerextra.ecu,DLT_ID_SIZE);
+    }
+
+    if (DLT_IS_HTYP_WSID(msg->standardheader->htyp))
+    {
+        msg->headerextra.seid = DLT_HTOBE_32(msg->headerextra.seid);
+        memcpy(msg->headerbuffer + sizeof(DltStorageHeader) + sizeof(DltStandardHeader)
+               + (DLT_IS_HTYP_WEID(msg->standardheader->htyp) ? DLT_SIZE_WEID : 0), &(msg->headerextra.seid),DLT_SIZE_WSID);
+    }
+
+    if (DLT_IS_HTYP_WTMS(msg->standardheader->htyp))
+    {
+        msg->headerextra.tmsp = DLT_HTOBE_32(msg->headerextra.tmsp);
+        memcpy(msg->headerbuffer + sizeof(DltStorageHeader) + sizeof(DltStandardHeader)
+               + (DLT_IS_HTYP_WEID(msg->standardheader->htyp) ? DLT_SIZE_WEID : 0)
+               + (DLT_IS_HTYP_WSID(msg->standardheader->htyp) ? DLT_SIZE_WSID : 0), &(msg->headerextra.tmsp),DLT_SIZE_WTMS);
+    }
+
+    return DLT_RETURN_OK;
+}
+
+/**
+ * Header of an index file, stored in host byte order.
+ */
+typedef struct
+{
+    char pattern[DLT_ID_SIZE];  /* DLT_COMMON_INDEX_FILE_PATTERN */
+    uint32_t version;           /* DLT_COMMON_INDEX_FILE_VERSION */
+    uint64_t trace_size;        /* size of the DLT file */
+    int64_t trace_mtime_sec;    /* modification time of the DLT file */
+    int64_t trace_mtime_nsec;
+    int64_t file_position;      /* position after the last read message */
+    uint32_t filter_hash;       /* filters set while reading */
+    int32_t counter;
+    int32_t counter_total;
+    int32_t error_messages;
+    int32_t index_wraps;
+} DltFileIndexHeader;
+
+/**
+ * Index of message positions and mapping of a DLT file, private part of DltFile.
+ */
+struct sDltFileIndex
+{
+    uint32_t *position;   /* lower 32 bit of file positions of all messages, only filtered messages */
+    int32_t size;         /* number of allocated entries in position */
+    int32_t *wrap;        /* first message beyond each further 4 GB of the file, see dlt_file_index_position() */
+    int32_t wraps;        /* number of entries in wrap */
+
+    /* mapped file content, NULL if the file is read through the file handle */
+    char *map;            /* mapping of the complete file */
+    long map_length;      /* number of mapped bytes */
+    long map_position;    /* current read position in the mapping */
+};
+
+/**
+ * Part of a mapped file indexed by dlt_file_read_parallel().
+ */
+typedef struct
+{
+    long start;         /* first message, found by resync */
+    long end;           /* start of the next chunk */
+    long stop;          /* position after the last message read */
+    int complete;       /* end was reached without error */
+    int failed;         /* out of memory */
+    uint32_t *offsets;  /* positions of matching messages relative to start */
+    int32_t count;      /* number of matching messages */
+    int32_t size;       /* number of allocated offsets */
+    int32_t total;      /* number of messages read */
+} DltFileChunk;
+
+typedef struct
+{
+    DltFile *file;
+    DltFileChunk *chunks;
+    int num_chunks;
+    int next;           /* next chunk to be scanned, taken atomically */
+} DltFileScan;
+
+/* Map the file, or extend the mapping if the file has grown. */
+static int dlt_file_map_update(DltFile *file)
+{
+    struct stat st;
+    void *map;
+
+    if ((fstat(fileno(file->handle), &st) != 0) ||
+        !S_ISREG(st.st_mode) ||
+        (st.st_size <= file->index->map_length) ||
+        ((uint64_t) st.st_size > SIZE_MAX))
+    {
+        return 0;
+    }
+
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno(file->handle), 0);
+
+    if (map == MAP_FAILED)
+    {
+        return 0;
+    }
+
+    if (file->index->map)
+    {
+        munmap(file->index->map, file->index->map_length);
+    }
+
+    file->index->map = map;
+    file->index->map_length = st.st_size;
+    file->file_length = st.st_size;
+
+    return 1;
+}
+
+static void dlt_file_unmap(DltFile *file)
+{
+    if (file->index == NULL)
+    {
+        return;
+    }
+
+    if (file->index->map)
+    {
+        munmap(file->index->map, file->index->map_length);
+    }
+
+    file->index->map = NULL;
+    file->index->map_length = 0;
+    file->index->map_position = 0;
+}
+
+/* Read from the current position, like fread() with one item. */
+static int dlt_file_get(DltFile *file, void *ptr, size_t size)
+{
+    if ((file->index == NULL) || (file->index->map == NULL))
+    {
+        return fread(ptr, size, 1, file->handle) == 1;
+    }
+
+    if ((file->index->map_position > file->index->map_length) ||
+        (size > (size_t) (file->index->map_length - file->index->map_position)))
+    {
+        /* the file may have grown since it was mapped */
+        if (!dlt_file_map_update(file) ||
+            (file->index->map_position > file->index->map_length) ||
+            (size > (size_t) (file->index->map_length - file->index->map_position)))
+        {
+            return 0;
+        }
+    }
+
+    memcpy(ptr, file->index->map + file->index->map_position, size);
+    file->index->map_position += size;
+
+    return 1;
+}
+
+/* Set the current position, like fseek() with SEEK_SET or SEEK_CUR. */
+static int dlt_file_seek(DltFile *file, long offset, int whence)
+{
+    if ((file->index == NULL) || (file->index->map == NULL))
+    {
+        return fseek(file->handle, offset, whence);
+    }
+
+    if (whence == SEEK_CUR)
+    {
+        offset += file->index->map_position;
+    }
+
+    if (offset < 0)
+    {
+        return -1;
+    }
+
+    /* like fseek(), positions beyond the end are accepted */
+    file->index->map_position = offset;
+
+    return 0;
+}
+
+static long dlt_file_tell(DltFile *file)
+{
+    if ((file->index == NULL) || (file->index->map == NULL))
+    {
+        return ftell(file->handle);
+    }
+
+    return file->index->map_position;
+}
+
+static int dlt_file_eof(DltFile *file)
+{
+    if ((file->index == NULL) || (file->index->map == NULL))
+    {
+        return feof(file->handle);
+    }
+
+    return file->index->map_position >= file->index->map_length;
+}
+
+/* Append the position of the message to the index. */
+static DltReturnValue dlt_file_index_add(DltFile *file, long position)
+{
+    uint32_t *index;
+    int32_t *wrap;
+    int32_t size;
+
+    if (file->index == NULL)
+    {
+        return DLT_RETURN_ERROR;
+    }
+
+    if (file->counter >= file->index->size)
+    {
+        if (file->index->size > INT32_MAX / 2)
+        {
+            return DLT_RETURN_ERROR;
+        }
+
+        size = file->index->size ? file->index->size * 2 : DLT_COMMON_INDEX_ALLOC;
+        index = (uint32_t *) realloc(file->index->position, size * sizeof(uint32_t));
+
+        if (index == NULL)
+        {
+            return DLT_RETURN_ERROR;
+        }
+
+        file->index->position = index;
+        file->index->size = size;
+    }
+
+    /* the upper part of the position is stored once for each 4 GB */
+    while (((uint64_t) position >> 32) > (uint64_t) file->index->wraps)
+    {
+        wrap = (int32_t *) realloc(file->index->wrap, (file->index->wraps + 1) * sizeof(int32_t));
+
+        if (wrap == NULL)
+        {
+            return DLT_RETURN_ERROR;
+        }
+
+        wrap[file->index->wraps] = file->counter;
+        file->index->wrap = wrap;
+        file->index->wraps++;
+    }
+
+    file->index->position[file->counter] = (uint32_t) position;
+
+    return DLT_RETURN_OK;
+}
+
+/* Hash of the filters, to detect index files read with other filters. */
+static uint32_t dlt_file_hash_bytes(uint32_t hash, const void *data, size_t size)
+{
+    const unsigned char *ptr = (const unsigned char *) data;
+    size_t i;
+
+    for (i = 0; i < size; i++)
+    {
+        hash = (hash ^ ptr[i]) * 16777619U;
+    }
+
+    return hash;
+}
+
+static uint32_t dlt_file_filter_hash(DltFilter *filter)
+{
+    uint32_t hash = 2166136261U;
+    const DltFilterRule *rule;
+    int num;
+
+    if (filter == NULL)
+    {
+        return hash;
+    }
+
+    hash = (hash ^ 1) * 16777619U;
+
+    for (num = 0; num < filter->counter; num++)
+    {
+        hash = dlt_file_hash_bytes(hash, filter->apid[num], DLT_ID_SIZE);
+        hash = dlt_file_hash_bytes(hash, filter->ctid[num], DLT_ID_SIZE);
+
+        rule = dlt_filter_rule(filter, num);
+
+        /* filters matching only ids keep the hash of index files written before predicates existed */
+        if (rule->flags == 0)
+        {
+            continue;
+        }
+
+        hash = dlt_file_hash_bytes(hash, &(rule->flags), sizeof(rule->flags));
+        hash = dlt_file_hash_bytes(hash, rule->ecu, DLT_ID_SIZE);
+        hash = dlt_file_hash_bytes(hash, &(rule->type), sizeof(rule->type));
+        hash = dlt_file_hash_bytes(hash, &(rule->level_min), sizeof(rule->level_min));
+        hash = dlt_file_hash_bytes(hash, &(rule->level_max), sizeof(rule->level_max));
+        hash = dlt_file_hash_bytes(hash, &(rule->seid), sizeof(rule->seid));
+        hash = dlt_file_hash_bytes(hash, &(rule->tmsp_min), sizeof(rule->tmsp_min));
+        hash = dlt_file_hash_bytes(hash, &(rule->tmsp_max), sizeof(rule->tmsp_max));
+        hash = dlt_file_hash_bytes(hash, rule->payload, strlen(rule->payload) + 1);
+        hash = dlt_file_hash_bytes(hash, rule->pattern, strlen(rule->pattern) + 1);
+    }
+
+    return hash;
+}
+
+DltReturnValue dlt_file_init(DltFile *file, int verbose)
+{
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if (file == NULL)
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    /* initalise structure parameters */
+    file->handle = NULL;
+    file->counter = 0;
+    file->counter_total = 0;
+    file->index = NULL;
+
+    file->filter = NULL;
+    file->filter_counter = 0;
+    file->file_position = 0;
+
+    file->position = 0;
+
+    file->error_messages = 0;
+
+    return dlt_message_init(&(file->msg),verbose);
+}
+
+DltReturnValue dlt_file_set_filter(DltFile *file, DltFilter *filter, int verbose)
+{
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if (file == NULL)
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    /* set filter */
+    file->filter = filter;
+
+    return DLT_RETURN_OK;
+}
+
+DltReturnValue dlt_file_read_header(DltFile *file, int verbose)
+{
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if (file == NULL)
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    /* load header from file */
+    if (!dlt_file_get(file, file->msg.headerbuffer, sizeof(DltStorageHeader)+sizeof(DltStandardHeader)))
+    {
+        if (!dlt_file_eof(file))
+        {
+            dlt_log(LOG_WARNING, "Cannot read header from file!\n");
+        }
+        return DLT_RETURN_ERROR;
+    }
+
+    /* set ptrs to structures */
+    file->msg.storageheader = (DltStorageHeader*) file->msg.headerbuffer;
+    file->msg.standardheader = (DltStandardHeader*) (file->msg.headerbuffer + sizeof(DltStorageHeader));
+
+    /* check id of storage header */
+    if (dlt_check_storageheader(file->msg.storageheader) != DLT_RETURN_TRUE)
     {
-        /* dlt_log(LOG_ERR,"length does not fit!\n"); */
-        return DLT_MESSAGE_ERROR_SIZE;
+        dlt_log(LOG_WARNING, "DLT storage header pattern not found!\n");
+        return DLT_RETURN_ERROR;
+    }
+
+    /* calculate complete size of headers */
+    file->msg.headersize = sizeof(DltStorageHeader) + sizeof(DltStandardHeader) +
+                           DLT_STANDARD_HEADER_EXTRA_SIZE(file->msg.standardheader->htyp) + (DLT_IS_HTYP_UEH(file->msg.standardheader->htyp) ? sizeof(DltExtendedHeader) : 0);
+    file->msg.datasize = DLT_BETOH_16(file->msg.standardheader->len) + sizeof(DltStorageHeader) - file->msg.headersize;
+    if (verbose)
+    {
+        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"HeaderSize=%d, DataSize=%d\n",file->msg.headersize, file->msg.datasize);
+        dlt_log(LOG_DEBUG, str);
+    }
+
+    /* check data size */
+    if (file->msg.datasize < 0)
+    {
+        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Plausibility check failed. Complete message size too short! (%d)\n", file->msg.datasize);
+        dlt_log(LOG_WARNING, str);
+        return DLT_RETURN_ERROR;
+    }
+
+    return DLT_RETURN_OK;
+}
+
+DltReturnValue dlt_file_read_header_raw(DltFile *file, int resync, int verbose)
+{
+    char dltSerialHeaderBuffer[DLT_ID_SIZE];
+
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if (file == NULL)
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    /* check if serial header exists, ignore if found */
+    if (!dlt_file_get(file,dltSerialHeaderBuffer,sizeof(dltSerialHeaderBuffer)))
+    {
+        /* cannot read serial header, not enough data available in file */
+        if (!dlt_file_eof(file))
+        {
+            dlt_log(LOG_WARNING, "Cannot read header from file!\n");
+        }
+        return DLT_RETURN_ERROR;
+    }
+    if (memcmp(dltSerialHeaderBuffer,dltSerialHeader,sizeof(dltSerialHeader)) == 0)
+    {
+        /* serial header found */
+        /* nothing to do continue reading */
+
+    }
+    else
+    {
+        /* serial header not found */
+        if(resync)
+        {
+            /* increase error counter */
+            file->error_messages++;
+
+            /* resync to serial header */
+            do
+            {
+                memmove(dltSerialHeaderBuffer,dltSerialHeaderBuffer+1,sizeof(dltSerialHeader)-1);
+                if (!dlt_file_get(file,dltSerialHeaderBuffer+3,1))
+                {
+                    /* cannot read any data, perhaps end of file reached */
+                    return DLT_RETURN_ERROR;
+                }
+                if (memcmp(dltSerialHeaderBuffer,dltSerialHeader,sizeof(dltSerialHeader)) == 0)
+                {
+                    /* serial header synchronised */
+                    break;
+                }
+            } while(1);
+        }
+        else
+        {
+            /* go back to last file position */
+            if (0 != dlt_file_seek(file,file->file_position,SEEK_SET))
+                return DLT_RETURN_ERROR;
+        }
+    }
+
+    /* load header from file */
+    if (!dlt_file_get(file,file->msg.headerbuffer+sizeof(DltStorageHeader),sizeof(DltStandardHeader)))
+    {
+        if (!dlt_file_eof(file))
+        {
+            dlt_log(LOG_WARNING, "Cannot read header from file!\n");
+        }
+        return DLT_RETURN_ERROR;
+    }
+
+    /* set ptrs to structures */
+    file->msg.storageheader = (DltStorageHeader*) file->msg.headerbuffer; // this points now to a empty storage header (filled with '0')
+    file->msg.standardheader = (DltStandardHeader*) (file->msg.headerbuffer + sizeof(DltStorageHeader));
+
+    /* Skip storage header field, fill this field with '0' */
+    memset(file->msg.storageheader, 0, sizeof(DltStorageHeader));
+
+    /* Set storage header */
+    dlt_set_storageheader(file->msg.storageheader,DLT_COMMON_DUMMY_ECUID);
+
+    /* no check for storage header id*/
+
+    /* calculate complete size of headers */
+    file->msg.headersize = sizeof(DltStorageHeader) + sizeof(DltStandardHeader) +
+                           DLT_STANDARD_HEADER_EXTRA_SIZE(file->msg.standardheader->htyp) + (DLT_IS_HTYP_UEH(file->msg.standardheader->htyp) ? sizeof(DltExtendedHeader) : 0);
+    file->msg.datasize = DLT_BETOH_16(file->msg.standardheader->len) + sizeof(DltStorageHeader) - file->msg.headersize;
+    if (verbose)
+    {
+        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"HeaderSize=%d, DataSize=%d\n",file->msg.headersize, file->msg.datasize);
+        dlt_log(LOG_DEBUG, str);
+    }
+
+    /* check data size */
+    if (file->msg.datasize < 0)
+    {
+        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Plausibility check failed. Complete message size too short! (%d)\n", file->msg.datasize);
+        dlt_log(LOG_WARNING, str);
+        return DLT_RETURN_ERROR;
+    }
+
+    return DLT_RETURN_OK;
+}
+
+DltReturnValue dlt_file_read_header_extended(DltFile *file, int verbose)
+{
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if (file == NULL)
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    /* load standard header extra parameters if used */
+    if (DLT_STANDARD_HEADER_EXTRA_SIZE(file->msg.standardheader->htyp))
+    {
+        if (!dlt_file_get(file,file->msg.headerbuffer+sizeof(DltStorageHeader)+sizeof(DltStandardHeader),
+                          DLT_STANDARD_HEADER_EXTRA_SIZE(file->msg.standardheader->htyp)))
+        {
+            dlt_log(LOG_WARNING, "Cannot read standard header extra parameters from file!\n");
+            return DLT_RETURN_ERROR;
+        }
+
+        dlt_message_get_extraparameters(&(file->msg),verbose);
+    }
+
+    /* load Extended header if used */
+    if (DLT_IS_HTYP_UEH(file->msg.standardheader->htyp)==0)
+    {
+        /* there is nothing to be loaded */
+        return DLT_RETURN_OK;
+    }
+
+    if (!dlt_file_get(file,file->msg.headerbuffer+sizeof(DltStorageHeader)+sizeof(DltStandardHeader)+DLT_STANDARD_HEADER_EXTRA_SIZE(file->msg.standardheader->htyp),
+                      (DLT_IS_HTYP_UEH(file->msg.standardheader->htyp) ? sizeof(DltExtendedHeader) : 0)))
+    {
+        dlt_log(LOG_WARNING, "Cannot read extended header from file!\n");
+        return DLT_RETURN_ERROR;
+    }
+
+    /* set extended header ptr */
+    if (DLT_IS_HTYP_UEH(file->msg.standardheader->htyp))
+    {
+        file->msg.extendedheader = (DltExtendedHeader*) (file->msg.headerbuffer + sizeof(DltStorageHeader) + sizeof(DltStandardHeader) +
+                                   DLT_STANDARD_HEADER_EXTRA_SIZE(file->msg.standardheader->htyp));
+    }
+    else
+    {
+        file->msg.extendedheader = NULL;
+    }
+
+    return DLT_RETURN_OK;
+}
+
+DltReturnValue dlt_file_read_data(DltFile *file, int verbose)
+{
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if (file == NULL)
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
     }
 
     /* free last used memory for buffer */
-    if (msg->databuffer)
+    if (file->msg.databuffer && (file->msg.databuffersize < file->msg.datasize))
+    {
+        free(file->msg.databuffer);
+        file->msg.databuffer = NULL;
+    }
+
+    if (file->msg.databuffer == NULL){
+        /* get new memory for buffer */
+        file->msg.databuffer = (uint8_t *)malloc(file->msg.datasize);
+        file->msg.databuffersize = file->msg.datasize;
+    }
+
+    if (file->msg.databuffer == NULL)
+    {
+        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Cannot allocate memory for payload buffer of size %d!\n",file->msg.datasize);
+        dlt_log(LOG_WARNING, str);
+        return DLT_RETURN_ERROR;
+    }
+
+    /* load payload data from file */
+    if (!dlt_file_get(file,file->msg.databuffer,file->msg.datasize))
+    {
+        if (file->msg.datasize!=0)
+        {
+            snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Cannot read payload data from file of size %d!\n",file->msg.datasize);
+            dlt_log(LOG_WARNING, str);
+            return DLT_RETURN_ERROR;
+        }
+    }
+
+    return DLT_RETURN_OK;
+}
+
+DltReturnValue dlt_file_open(DltFile *file,const char *filename,int verbose)
+{
+    PRINT_FUNCTION_VERBOSE(verbose);
+
+    if(file == NULL || filename == NULL)
+        return DLT_RETURN_WRONG_PARAMETER;
+
+    /* reset counters */
+    file->counter = 0;
+    file->counter_total = 0;
+    file->position = 0;
+    file->file_position = 0;
+    file->file_length = 0;
+    file->error_messages = 0;
+
+    if (file->index == NULL)
+    {
+        file->index = (struct sDltFileIndex *) calloc(1, sizeof(struct sDltFileIndex));
+
+        if (file->index == NULL)
+        {
+            return DLT_RETURN_ERROR;
+        }
+    }
+
+    free(file->index->wrap);
+    file->index->wrap = NULL;
+    file->index->wraps = 0;
+
+    dlt_file_unmap(file);
+
+    if (file->handle)
+    {
+        fclose(file->handle);
+    }
+
+    /* open dlt file */
+    file->handle = fopen(filename,"rb");
+    if (file->handle == NULL)
+    {
+        snprintf(str, DLT_COMMON_BUFFER_LENGTH - 1 ,"File %s cannot be opened!\n", filename);
+        dlt_log(LOG_WARNING, str);
+        return DLT_RETURN_ERROR;
+    }
+
+    if (0 != fseek(file->handle, 0, SEEK_END))
     {
-        if (msg->datasize>msg->databuffersize){
-            free(msg->databuffer);
-            msg->databuffer=(uint8_t *)malloc(msg->datasize);
-            msg->databuffersize = msg->datasize;
-        }
-    }else{
-        /* get new memory for buffer */
-        msg->databuffer = (uint8_t *)malloc(msg->datasize);
-        msg->databuffersize = msg->datasize;
+        snprintf(str, DLT_COMMON_BUFFER_LENGTH, "dlt_file_open: Seek failed to 0,SEEK_END");
+        dlt_log(LOG_WARNING, str);
+        return DLT_RETURN_ERROR;
     }
-    if (msg->databuffer == NULL)
+    file->file_length = ftell(file->handle);
+
+    if (0 != fseek(file->handle,0,SEEK_SET))
     {
-        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Cannot allocate memory for payload buffer of size %d!\n",msg->datasize);
+        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"dlt_file_open: Seek failed to 0,SEEK_SET");
         dlt_log(LOG_WARNING, str);
-        return DLT_MESSAGE_ERROR_UNKNOWN;
+        return DLT_RETURN_ERROR;
     }
 
-    /* load payload data from buffer */
-    memcpy(msg->databuffer,buffer+(msg->headersize-sizeof(DltStorageHeader)),msg->datasize);
+    /* messages are parsed in place if the file can be mapped */
+    dlt_file_map_update(file);
 
-    return DLT_MESSAGE_ERROR_OK;
+    if (verbose)
+    {
+        /* print file length */
+        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"File is %lu bytes long\n",file->file_length);
+        dlt_log(LOG_DEBUG, str);
+    }
+    return DLT_RETURN_OK;
 }
 
-DltReturnValue dlt_message_get_extraparameters(DltMessage *msg, int verbose)
+DltReturnValue dlt_file_read(DltFile *file,int verbose)
 {
-    PRINT_FUNCTION_VERBOSE(verbose);
+    int found = DLT_RETURN_OK;
 
-    if (msg == NULL)
+    if (verbose)
+    {
+        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"%s: Message %d:\n",__func__, file->counter_total);
+        dlt_log(LOG_DEBUG, str);
+    }
+
+    if (file == NULL)
     {
         return DLT_RETURN_WRONG_PARAMETER;
     }
 
-    if (DLT_IS_HTYP_WEID(msg->standardheader->htyp))
+    /* set to end of last succesful read message, because of conflicting calls to dlt_file_read and dlt_file_message */
+    if (0 !=  dlt_file_seek(file,file->file_position,SEEK_SET))
     {
-        memcpy(msg->headerextra.ecu,msg->headerbuffer + sizeof(DltStorageHeader) + sizeof(DltStandardHeader),DLT_ID_SIZE);
+        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Seek failed to file_position %ld \n",file->file_position);
+        dlt_log(LOG_WARNING, str);
+        return DLT_RETURN_ERROR;
     }
 
-    if (DLT_IS_HTYP_WSID(msg->standardheader->htyp))
+    /* get file position at start of DLT message */
+    if (verbose)
     {
-        memcpy(&(msg->headerextra.seid),msg->headerbuffer + sizeof(DltStorageHeader) + sizeof(DltStandardHeader)
-               + (DLT_IS_HTYP_WEID(msg->standardheader->htyp) ? DLT_SIZE_WEID : 0), DLT_SIZE_WSID);
-        msg->headerextra.seid = DLT_BETOH_32(msg->headerextra.seid);
+        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Position in file: %ld\n",file->file_position);
+        dlt_log(LOG_INFO, str);
     }
 
-    if (DLT_IS_HTYP_WTMS(msg->standardheader->htyp))
+    /* read header */
+    if (dlt_file_read_header(file,verbose) < DLT_RETURN_OK)
     {
-        memcpy(&(msg->headerextra.tmsp),msg->headerbuffer + sizeof(DltStorageHeader) + sizeof(DltStandardHeader)
-               + (DLT_IS_HTYP_WEID(msg->standardheader->htyp) ? DLT_SIZE_WEID : 0)
-               + (DLT_IS_HTYP_WSID(msg->standardheader->htyp) ? DLT_SIZE_WSID : 0),DLT_SIZE_WTMS);
-        msg->headerextra.tmsp = DLT_BETOH_32(msg->headerextra.tmsp);
+        /* go back to last position in file */
+        dlt_file_seek(file,file->file_position,SEEK_SET);
+        return DLT_RETURN_ERROR;
     }
 
-    return DLT_RETURN_OK;
+    if (file->filter)
+    {
+        /* read the extended header if filter is enabled and extended header exists */
+        if (dlt_file_read_header_extended(file, verbose) < DLT_RETURN_OK)
+        {
+            /* go back to last position in file */
+            if (0 != dlt_file_seek(file,file->file_position,SEEK_SET))
+            {
+                snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Seek to last file pos failed!\n");
+                dlt_log(LOG_WARNING, str);
+            }
+            return DLT_RETURN_ERROR;
+        }
+
+        /* payload predicates of the filters need the payload */
+        if (dlt_filter_needs_payload(file->filter) && (dlt_file_read_data(file, verbose) < DLT_RETURN_OK))
+        {
+            /* go back to last position in file */
+            if (0 != dlt_file_seek(file,file->file_position,SEEK_SET))
+            {
+                snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Seek to last file pos failed!\n");
+                dlt_log(LOG_WARNING, str);
+            }
+            return DLT_RETURN_ERROR;
+        }
+
+        /* check the filters if message is used */
+        if (dlt_message_filter_check(&(file->msg),file->filter,verbose) == DLT_RETURN_TRUE)
+        {
+            /* filter matched, consequently store current message */
+            /* store index pointer to message position in DLT file */
+            if (dlt_file_index_add(file, file->file_position) < DLT_RETURN_OK)
+            {
+                return DLT_RETURN_ERROR;
+            }
+            file->counter++;
+            file->position = file->counter - 1;
+
+            found = DLT_RETURN_TRUE;
+        }
+
+        /* skip payload data */
+        if (!dlt_filter_needs_payload(file->filter) && dlt_file_seek(file,file->msg.datasize,SEEK_CUR)!=0)
+        {
+            /* go back to last position in file */
+            snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Seek failed to skip payload data of size %d!\n",file->msg.datasize);
+            dlt_log(LOG_WARNING, str);
+
+            if (0 != dlt_file_seek(file,file->file_position,SEEK_SET))
+            {
+                snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Seek back also failed!\n");
+                dlt_log(LOG_WARNING, str);
+            }
+
+            return DLT_RETURN_ERROR;
+        }
+    }
+    else
+    {
+        /* filter is disabled */
+        /* skip additional header parameters and payload data */
+        if (dlt_file_seek(file,file->msg.headersize - sizeof(DltStorageHeader) - sizeof(DltStandardHeader) + file->msg.datasize,SEEK_CUR))
+        {
+
+            snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Seek failed to skip extra header and payload data from file of size %d!\n",
+                    file->msg.headersize - (int32_t)sizeof(DltStorageHeader) - (int32_t)sizeof(DltStandardHeader) + file->msg.datasize);
+            dlt_log(LOG_WARNING, str);
+            /* go back to last position in file */
+            if (dlt_file_seek(file,file->file_position,SEEK_SET))
+            {
+                snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Seek back also failed!\n");
+                dlt_log(LOG_WARNING, str);
+            }
+            return DLT_RETURN_ERROR;
+        }
+
+        /* store index pointer to message position in DLT file */
+        if (dlt_file_index_add(file, file->file_position) < DLT_RETURN_OK)
+        {
+            return DLT_RETURN_ERROR;
+        }
+        file->counter++;
+        file->position = file->counter - 1;
+
+        found = DLT_RETURN_TRUE;
+    }
+
+    /* increase total message counter */
+    file->counter_total++;
+
+    /* store position to next message */
+    file->file_position = dlt_file_tell(file);
+
+    return found;
 }
 
-DltReturnValue dlt_message_set_extraparameters(DltMessage *msg, int verbose)
+DltReturnValue dlt_file_read_raw(DltFile *file, int resync, int verbose)
 {
-    PRINT_FUNCTION_VERBOSE(verbose);
+    int found = DLT_RETURN_OK;
 
-    if (msg == NULL)
+    if (verbose)
     {
+        snprintf(str, DLT_COMMON_BUFFER_LENGTH, "%s: Message %d:\n", __func__, file->counter_total);
+        dlt_log(LOG_DEBUG, str);
+    }
+
+    if (file == NULL)
         return DLT_RETURN_WRONG_PARAMETER;
+
+    /* set to end of last successful read message, because of conflicting calls to dlt_file_read and dlt_file_message */
+    if (0 != dlt_file_seek(file,file->file_position,SEEK_SET))
+        return DLT_RETURN_ERROR;
+
+    /* get file position at start of DLT message */
+    if (verbose)
+    {
+        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Position in file: %ld\n",file->file_position);
+        dlt_log(LOG_DEBUG, str);
     }
 
-    if (DLT_IS_HTYP_WEID(msg->standardheader->htyp))
+    /* read header */
+    if (dlt_file_read_header_raw(file,resync,verbose) < DLT_RETURN_OK)
     {
-        memcpy(msg->headerbuffer + sizeof(DltStorageHeader) + sizeof(DltStandardHeader),msg->headerextra.ecu,DLT_ID_SIZE);
+        /* go back to last position in file */
+        if (0!= dlt_file_seek(file,file->file_position,SEEK_SET))
+        {
+            snprintf(str,DLT_COMMON_BUFFER_LENGTH,"dlt_file_read_raw, fseek failed 1\n");
+            dlt_log(LOG_WARNING, str);
+        }
+        return DLT_RETURN_ERROR;
     }
 
-    if (DLT_IS_HTYP_WSID(msg->standardheader->htyp))
+    /* read the extended header if filter is enabled and extended header exists */
+    if (dlt_file_read_header_extended(file, verbose) < DLT_RETURN_OK)
     {
-        msg->headerextra.seid = DLT_HTOBE_32(msg->headerextra.seid);
-        memcpy(msg->headerbuffer + sizeof(DltStorageHeader) + sizeof(DltStandardHeader)
-               + (DLT_IS_HTYP_WEID(msg->standardheader->htyp) ? DLT_SIZE_WEID : 0), &(msg->headerextra.seid),DLT_SIZE_WSID);
+        /* go back to last position in file */
+        if (0 != dlt_file_seek(file,file->file_position,SEEK_SET))
+        {
+            snprintf(str,DLT_COMMON_BUFFER_LENGTH,"dlt_file_read_raw, fseek failed 2\n");
+            dlt_log(LOG_WARNING, str);
+        }
+        return DLT_RETURN_ERROR;
     }
 
-    if (DLT_IS_HTYP_WTMS(msg->standardheader->htyp))
+    if (dlt_file_read_data(file,verbose) < DLT_RETURN_OK)
     {
-        msg->headerextra.tmsp = DLT_HTOBE_32(msg->headerextra.tmsp);
-        memcpy(msg->headerbuffer + sizeof(DltStorageHeader) + sizeof(DltStandardHeader)
-               + (DLT_IS_HTYP_WEID(msg->standardheader->htyp) ? DLT_SIZE_WEID : 0)
-               + (DLT_IS_HTYP_WSID(msg->standardheader->htyp) ? DLT_SIZE_WSID : 0), &(msg->headerextra.tmsp),DLT_SIZE_WTMS);
+        /* go back to last position in file */
+        if (0 != dlt_file_seek(file,file->file_position,SEEK_SET))
+        {
+            snprintf(str,DLT_COMMON_BUFFER_LENGTH,"dlt_file_read_raw, fseek failed 3\n");
+            dlt_log(LOG_WARNING, str);
+        }
+        return DLT_RETURN_ERROR;
     }
 
-    return DLT_RETURN_OK;
+    /* store index pointer to message position in DLT file */
+    if (dlt_file_index_add(file, file->file_position) < DLT_RETURN_OK)
+    {
+        return DLT_RETURN_ERROR;
+    }
+    file->counter++;
+    file->position = file->counter - 1;
+
+    found = DLT_RETURN_TRUE;
+
+    /* increase total message counter */
+    file->counter_total++;
+
+    /* store position to next message */
+    file->file_position = dlt_file_tell(file);
+
+    return found;
 }
 
-DltReturnValue dlt_file_init(DltFile *file, int verbose)
+/*
+ * Index the messages of one chunk in place. The checks are the same as
+ * in dlt_file_read(), so that the result is identical to a sequential read.
+ */
+static void dlt_file_scan_chunk(DltFile *file, DltFileChunk *chunk)
 {
-    PRINT_FUNCTION_VERBOSE(verbose);
+    DltMessage msg;
+    DltStorageHeader *storageheader;
+    long pos = chunk->start;
+    int32_t headersize;
+    int32_t datasize;
+    uint32_t *offsets;
 
-    if (file == NULL)
+    chunk->count = 0;
+    chunk->total = 0;
+    chunk->complete = 0;
+
+    while (pos < chunk->end)
     {
-        return DLT_RETURN_WRONG_PARAMETER;
-    }
+        if (file->index->map_length - pos < (long) (sizeof(DltStorageHeader) + sizeof(DltStandardHeader)))
+        {
+            break;
+        }
+
+        storageheader = (DltStorageHeader *) (file->index->map + pos);
+
+        if (dlt_check_storageheader(storageheader) != DLT_RETURN_TRUE)
+        {
+            break;
+        }
+
+        msg.standardheader = (DltStandardHeader *) (file->index->map + pos + sizeof(DltStorageHeader));
+        headersize = sizeof(DltStorageHeader) + sizeof(DltStandardHeader) +
+                     DLT_STANDARD_HEADER_EXTRA_SIZE(msg.standardheader->htyp) +
+                     (DLT_IS_HTYP_UEH(msg.standardheader->htyp) ? sizeof(DltExtendedHeader) : 0);
+        datasize = DLT_BETOH_16(msg.standardheader->len) + sizeof(DltStorageHeader) - headersize;
+
+        if (datasize < 0)
+        {
+            break;
+        }
+
+        if (file->filter)
+        {
+            /* filters need the complete headers */
+            if (file->index->map_length - pos < headersize)
+            {
+                break;
+            }
+
+            /* the complete headers are small, copy them to get the extra parameters */
+            memcpy(msg.headerbuffer, file->index->map + pos, headersize);
+            msg.storageheader = (DltStorageHeader *) msg.headerbuffer;
+            msg.standardheader = (DltStandardHeader *) (msg.headerbuffer + sizeof(DltStorageHeader));
+            msg.extendedheader = (DltExtendedHeader *) (msg.headerbuffer + headersize - sizeof(DltExtendedHeader));
+            dlt_message_get_extraparameters(&msg, 0);
+
+            if (dlt_filter_needs_payload(file->filter))
+            {
+                if (file->index->map_length - pos - headersize < datasize)
+                {
+                    break;
+                }
+
+                msg.databuffer = (uint8_t *) (file->index->map + pos + headersize);
+                msg.datasize = datasize;
+            }
+        }
+
+        if ((file->filter == NULL) ||
+            (dlt_message_filter_check(&msg, file->filter, 0) == DLT_RETURN_TRUE))
+        {
+            if (chunk->count >= chunk->size)
+            {
+                offsets = (uint32_t *) realloc(chunk->offsets,
+                                               (chunk->size ? chunk->size * 2 : DLT_COMMON_INDEX_ALLOC) * sizeof(uint32_t));
 
-    /* initalise structure parameters */
-    file->handle = NULL;
-    file->counter = 0;
-    file->counter_total = 0;
-    file->index = NULL;
+                if (offsets == NULL)
+                {
+                    chunk->failed = 1;
+                    break;
+                }
 
-    file->filter = NULL;
-    file->filter_counter = 0;
-    file->file_position = 0;
+                chunk->offsets = offsets;
+                chunk->size = chunk->size ? chunk->size * 2 : DLT_COMMON_INDEX_ALLOC;
+            }
 
-    file->position = 0;
+            chunk->offsets[chunk->count++] = (uint32_t) (pos - chunk->start);
+        }
 
-    file->error_messages = 0;
+        chunk->total++;
+        pos += headersize + datasize;
+    }
 
-    return dlt_message_init(&(file->msg),verbose);
+    chunk->stop = pos;
+    chunk->complete = (pos >= chunk->end) && !chunk->failed;
 }
 
-DltReturnValue dlt_file_set_filter(DltFile *file, DltFilter *filter, int verbose)
+static void *dlt_file_scan_thread(void *arg)
 {
-    PRINT_FUNCTION_VERBOSE(verbose);
+    DltFileScan *scan = (DltFileScan *) arg;
+    int num;
 
-    if (file == NULL)
+    while ((num = __atomic_fetch_add(&scan->next, 1, __ATOMIC_RELAXED)) < scan->num_chunks)
     {
-        return DLT_RETURN_WRONG_PARAMETER;
+        dlt_file_scan_chunk(scan->file, &scan->chunks[num]);
     }
 
-    /* set filter */
-    file->filter = filter;
-
-    return DLT_RETURN_OK;
+    return NULL;
 }
 
-DltReturnValue dlt_file_read_header(DltFile *file, int verbose)
+DltReturnValue dlt_file_read_parallel(DltFile *file, int threads, int verbose)
 {
+    static const char pattern[DLT_ID_SIZE] = { 'D', 'L', 'T', 0x01 };
+    DltFileScan scan;
+    DltFileChunk *chunk;
+    pthread_t *tids = NULL;
+    int started = 0;
+    long chunk_size;
+    long length;
+    long pos;
+    char *found;
+    int num;
+    int i;
+    DltReturnValue ret = DLT_RETURN_OK;
+
     PRINT_FUNCTION_VERBOSE(verbose);
 
-    if (file == NULL)
+    if (file == NULL || file->handle == NULL || file->index == NULL)
     {
         return DLT_RETURN_WRONG_PARAMETER;
     }
 
-    /* load header from file */
-    if (fread(file->msg.headerbuffer, sizeof(DltStorageHeader)+sizeof(DltStandardHeader), 1, file->handle)!=1)
+    if (threads <= 0)
     {
-        if (!feof(file->handle))
-        {
-            dlt_log(LOG_WARNING, "Cannot read header from file!\n");
-        }
-        return DLT_RETURN_ERROR;
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
     }
 
-    /* set ptrs to structures */
-    file->msg.storageheader = (DltStorageHeader*) file->msg.headerbuffer;
-    file->msg.standardheader = (DltStandardHeader*) (file->msg.headerbuffer + sizeof(DltStorageHeader));
-
-    /* check id of storage header */
-    if (dlt_check_storageheader(file->msg.storageheader) != DLT_RETURN_TRUE)
+    /* make sure the mapping covers the current content of the file */
+    if (file->index->map)
     {
-        dlt_log(LOG_WARNING, "DLT storage header pattern not found!\n");
-        return DLT_RETURN_ERROR;
+        dlt_file_map_update(file);
     }
 
-    /* calculate complete size of headers */
-    file->msg.headersize = sizeof(DltStorageHeader) + sizeof(DltStandardHeader) +
-                           DLT_STANDARD_HEADER_EXTRA_SIZE(file->msg.standardheader->htyp) + (DLT_IS_HTYP_UEH(file->msg.standardheader->htyp) ? sizeof(DltExtendedHeader) : 0);
-    file->msg.datasize = DLT_BETOH_16(file->msg.standardheader->len) + sizeof(DltStorageHeader) - file->msg.headersize;
-    if (verbose)
-    {
-        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"HeaderSize=%d, DataSize=%d\n",file->msg.headersize, file->msg.datasize);
-        dlt_log(LOG_DEBUG, str);
-    }
+    length = file->index->map ? file->index->map_length - file->file_position : 0;
+    chunk_size = (threads > 1) ? length / (threads * 4) : 0;
 
-    /* check data size */
-    if (file->msg.datasize < 0)
+    if (chunk_size > DLT_COMMON_PARALLEL_CHUNK_MAX)
     {
-        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Plausibility check failed. Complete message size too short! (%d)\n", file->msg.datasize);
-        dlt_log(LOG_WARNING, str);
-        return DLT_RETURN_ERROR;
+        chunk_size = DLT_COMMON_PARALLEL_CHUNK_MAX;
     }
 
-    return DLT_RETURN_OK;
-}
-
-DltReturnValue dlt_file_read_header_raw(DltFile *file, int resync, int verbose)
-{
-    char dltSerialHeaderBuffer[DLT_ID_SIZE];
-
-    PRINT_FUNCTION_VERBOSE(verbose);
+    memset(&scan, 0, sizeof(scan));
 
-    if (file == NULL)
+    if (chunk_size >= DLT_COMMON_PARALLEL_CHUNK_MIN)
     {
-        return DLT_RETURN_WRONG_PARAMETER;
+        scan.file = file;
+        scan.num_chunks = (length + chunk_size - 1) / chunk_size;
+        scan.chunks = (DltFileChunk *) calloc(scan.num_chunks, sizeof(DltFileChunk));
+        tids = (pthread_t *) calloc(threads, sizeof(pthread_t));
     }
 
-    /* check if serial header exists, ignore if found */
-    if (fread(dltSerialHeaderBuffer,sizeof(dltSerialHeaderBuffer),1,file->handle)!=1)
-    {
-        /* cannot read serial header, not enough data available in file */
-        if (!feof(file->handle))
-        {
-            dlt_log(LOG_WARNING, "Cannot read header from file!\n");
-        }
-        return DLT_RETURN_ERROR;
-    }
-    if (memcmp(dltSerialHeaderBuffer,dltSerialHeader,sizeof(dltSerialHeader)) == 0)
+    if (scan.chunks && tids)
     {
-        /* serial header found */
-        /* nothing to do continue reading */
+        /* resync each chunk to the first storage header pattern after its nominal start */
+        scan.chunks[0].start = file->file_position;
 
-    }
-    else
-    {
-        /* serial header not found */
-        if(resync)
+        for (num = 1; num < scan.num_chunks; num++)
         {
-            /* increase error counter */
-            file->error_messages++;
+            pos = file->file_position + num * chunk_size;
 
-            /* resync to serial header */
-            do
+            if (pos < scan.chunks[num - 1].start)
             {
-                memmove(dltSerialHeaderBuffer,dltSerialHeaderBuffer+1,sizeof(dltSerialHeader)-1);
-                if (fread(dltSerialHeaderBuffer+3,1,1,file->handle)!=1)
-                {
-                    /* cannot read any data, perhaps end of file reached */
-                    return DLT_RETURN_ERROR;
-                }
-                if (memcmp(dltSerialHeaderBuffer,dltSerialHeader,sizeof(dltSerialHeader)) == 0)
-                {
-                    /* serial header synchronised */
-                    break;
-                }
-            } while(1);
+                pos = scan.chunks[num - 1].start;
+            }
+
+            found = memmem(file->index->map + pos, file->index->map_length - pos, pattern, sizeof(pattern));
+            scan.chunks[num].start = found ? found - file->index->map : file->index->map_length;
+            scan.chunks[num - 1].end = scan.chunks[num].start;
         }
-        else
+
+        scan.chunks[scan.num_chunks - 1].end = file->index->map_length;
+
+        for (i = 1; i < threads; i++)
         {
-            /* go back to last file position */
-            if (0 != fseek(file->handle,file->file_position,SEEK_SET))
-                return DLT_RETURN_ERROR;
+            if (pthread_create(&tids[started], NULL, dlt_file_scan_thread, &scan) == 0)
+            {
+                started++;
+            }
         }
-    }
 
-    /* load header from file */
-    if (fread(file->msg.headerbuffer+sizeof(DltStorageHeader),sizeof(DltStandardHeader),1,file->handle)!=1)
-    {
-        if (!feof(file->handle))
+        dlt_file_scan_thread(&scan);
+
+        for (i = 0; i < started; i++)
         {
-            dlt_log(LOG_WARNING, "Cannot read header from file!\n");
+            pthread_join(tids[i], NULL);
         }
-        return DLT_RETURN_ERROR;
-    }
 
-    /* set ptrs to structures */
-    file->msg.storageheader = (DltStorageHeader*) file->msg.headerbuffer; // this points now to a empty storage header (filled with '0')
-    file->msg.standardheader = (DltStandardHeader*) (file->msg.headerbuffer + sizeof(DltStorageHeader));
+        /*
+         * Append the chunks in order. A chunk which did not start where the
+         * previous one stopped was resynced to a pattern inside of a payload,
+         * or its predecessor ended with an incomplete message; it is scanned
+         * again from the right position.
+         */
+        pos = file->file_position;
 
-    /* Skip storage header field, fill this field with '0' */
-    memset(file->msg.storageheader, 0, sizeof(DltStorageHeader));
+        for (num = 0; num < scan.num_chunks; num++)
+        {
+            chunk = &scan.chunks[num];
 
-    /* Set storage header */
-    dlt_set_storageheader(file->msg.storageheader,DLT_COMMON_DUMMY_ECUID);
+            if (chunk->start != pos)
+            {
+                chunk->start = pos;
+                dlt_file_scan_chunk(file, chunk);
+            }
 
-    /* no check for storage header id*/
+            if (chunk->failed)
+            {
+                ret = DLT_RETURN_ERROR;
+                break;
+            }
 
-    /* calculate complete size of headers */
-    file->msg.headersize = sizeof(DltStorageHeader) + sizeof(DltStandardHeader) +
-                           DLT_STANDARD_HEADER_EXTRA_SIZE(file->msg.standardheader->htyp) + (DLT_IS_HTYP_UEH(file->msg.standardheader->htyp) ? sizeof(DltExtendedHeader) : 0);
-    file->msg.datasize = DLT_BETOH_16(file->msg.standardheader->len) + sizeof(DltStorageHeader) - file->msg.headersize;
-    if (verbose)
-    {
-        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"HeaderSize=%d, DataSize=%d\n",file->msg.headersize, file->msg.datasize);
-        dlt_log(LOG_DEBUG, str);
-    }
+            for (i = 0; i < chunk->count; i++)
+            {
+                if (dlt_file_index_add(file, chunk->start + chunk->offsets[i]) < DLT_RETURN_OK)
+                {
+                    ret = DLT_RETURN_ERROR;
+                    break;
+                }
 
-    /* check data size */
-    if (file->msg.datasize < 0)
-    {
-        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Plausibility check failed. Complete message size too short! (%d)\n", file->msg.datasize);
-        dlt_log(LOG_WARNING, str);
-        return DLT_RETURN_ERROR;
-    }
+                file->counter++;
+            }
 
-    return DLT_RETURN_OK;
-}
+            if (ret < DLT_RETURN_OK)
+            {
+                break;
+            }
 
-DltReturnValue dlt_file_read_header_extended(DltFile *file, int verbose)
-{
-    PRINT_FUNCTION_VERBOSE(verbose);
+            file->counter_total += chunk->total;
+            file->file_position = pos = chunk->stop;
 
-    if (file == NULL)
-    {
-        return DLT_RETURN_WRONG_PARAMETER;
-    }
+            free(chunk->offsets);
+            chunk->offsets = NULL;
 
-    /* load standard header extra parameters if used */
-    if (DLT_STANDARD_HEADER_EXTRA_SIZE(file->msg.standardheader->htyp))
-    {
-        if (fread(file->msg.headerbuffer+sizeof(DltStorageHeader)+sizeof(DltStandardHeader),
-                  DLT_STANDARD_HEADER_EXTRA_SIZE(file->msg.standardheader->htyp),
-                  1,file->handle)!=1)
+            if (!chunk->complete)
+            {
+                break;
+            }
+        }
+
+        if (file->counter > 0)
         {
-            dlt_log(LOG_WARNING, "Cannot read standard header extra parameters from file!\n");
-            return DLT_RETURN_ERROR;
+            file->position = file->counter - 1;
         }
 
-        dlt_message_get_extraparameters(&(file->msg),verbose);
+        if (verbose)
+        {
+            snprintf(str, DLT_COMMON_BUFFER_LENGTH, "%d messages indexed in %d chunks by %d threads\n",
+                     file->counter_total, scan.num_chunks, started + 1);
+            dlt_log(LOG_DEBUG, str);
+        }
     }
 
-    /* load Extended header if used */
-    if (DLT_IS_HTYP_UEH(file->msg.standardheader->htyp)==0)
+    if (scan.chunks)
     {
-        /* there is nothing to be loaded */
-        return DLT_RETURN_OK;
-    }
+        for (num = 0; num < scan.num_chunks; num++)
+        {
+            free(scan.chunks[num].offsets);
+        }
 
-    if (fread(file->msg.headerbuffer+sizeof(DltStorageHeader)+sizeof(DltStandardHeader)+DLT_STANDARD_HEADER_EXTRA_SIZE(file->msg.standardheader->htyp),
-              (DLT_IS_HTYP_UEH(file->msg.standardheader->htyp) ? sizeof(DltExtendedHeader) : 0),
-              1,file->handle)!=1)
-    {
-        dlt_log(LOG_WARNING, "Cannot read extended header from file!\n");
-        return DLT_RETURN_ERROR;
+        free(scan.chunks);
     }
 
-    /* set extended header ptr */
-    if (DLT_IS_HTYP_UEH(file->msg.standardheader->htyp))
+    free(tids);
+
+    if (ret < DLT_RETURN_OK)
     {
-        file->msg.extendedheader = (DltExtendedHeader*) (file->msg.headerbuffer + sizeof(DltStorageHeader) + sizeof(DltStandardHeader) +
-                                   DLT_STANDARD_HEADER_EXTRA_SIZE(file->msg.standardheader->htyp));
+        return ret;
     }
-    else
+
+    /* small files, files which are not mapped and the end of the file are read sequentially */
+    while (dlt_file_read(file, verbose) >= DLT_RETURN_OK)
     {
-        file->msg.extendedheader = NULL;
     }
 
     return DLT_RETURN_OK;
 }
 
-DltReturnValue dlt_file_read_data(DltFile *file, int verbose)
+DltReturnValue dlt_file_close(DltFile *file, int verbose)
 {
     PRINT_FUNCTION_VERBOSE(verbose);
 
@@ -1557,385 +3384,341 @@ DltReturnValue dlt_file_read_data(DltFile *file, int verbose)
         return DLT_RETURN_WRONG_PARAMETER;
     }
 
-    /* free last used memory for buffer */
-    if (file->msg.databuffer && (file->msg.databuffersize < file->msg.datasize))
-    {
-        free(file->msg.databuffer);
-        file->msg.databuffer = NULL;
-    }
-
-    if (file->msg.databuffer == NULL){
-        /* get new memory for buffer */
-        file->msg.databuffer = (uint8_t *)malloc(file->msg.datasize);
-        file->msg.databuffersize = file->msg.datasize;
-    }
+    dlt_file_unmap(file);
 
-    if (file->msg.databuffer == NULL)
+    if (file->handle)
     {
-        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Cannot allocate memory for payload buffer of size %d!\n",file->msg.datasize);
-        dlt_log(LOG_WARNING, str);
-        return DLT_RETURN_ERROR;
+        fclose(file->handle);
     }
 
-    /* load payload data from file */
-    if (fread(file->msg.databuffer,file->msg.datasize,1,file->handle)!=1)
-    {
-        if (file->msg.datasize!=0)
-        {
-            snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Cannot read payload data from file of size %d!\n",file->msg.datasize);
-            dlt_log(LOG_WARNING, str);
-            return DLT_RETURN_ERROR;
-        }
-    }
+    file->handle = NULL;
 
     return DLT_RETURN_OK;
 }
 
-DltReturnValue dlt_file_open(DltFile *file,const char *filename,int verbose)
+DltReturnValue dlt_file_message(DltFile *file, int index, int verbose)
 {
     PRINT_FUNCTION_VERBOSE(verbose);
 
-    if(file == NULL || filename == NULL)
+    if (file == NULL)
+    {
         return DLT_RETURN_WRONG_PARAMETER;
+    }
 
-    /* reset counters */
-    file->counter = 0;
-    file->counter_total = 0;
-    file->position = 0;
-    file->file_position = 0;
-    file->file_length = 0;
-    file->error_messages = 0;
-
-    if (file->handle)
+    /* check if message is in range */
+    if (index < 0 || index >= file->counter)
     {
-        fclose(file->handle);
+        snprintf(str,DLT_COMMON_BUFFER_LENGTH, "Message %d out of range!\r\n", index);
+        dlt_log(LOG_WARNING, str);
+        return DLT_RETURN_WRONG_PARAMETER;
     }
 
-    /* open dlt file */
-    file->handle = fopen(filename,"rb");
-    if (file->handle == NULL)
+    /* seek to position in file */
+    if (dlt_file_seek(file,dlt_file_index_position(file,index),SEEK_SET)!=0)
     {
-        snprintf(str, DLT_COMMON_BUFFER_LENGTH - 1 ,"File %s cannot be opened!\n", filename);
+        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Seek to message %d to position %ld failed!\r\n",index,dlt_file_index_position(file,index));
         dlt_log(LOG_WARNING, str);
         return DLT_RETURN_ERROR;
     }
 
-    if (0 != fseek(file->handle, 0, SEEK_END))
+    /* read all header and payload */
+    if (dlt_file_read_header(file,verbose) < DLT_RETURN_OK)
+    {
+        return DLT_RETURN_ERROR;
+    }
+
+    if (dlt_file_read_header_extended(file,verbose) < DLT_RETURN_OK)
     {
-        snprintf(str, DLT_COMMON_BUFFER_LENGTH, "dlt_file_open: Seek failed to 0,SEEK_END");
-        dlt_log(LOG_WARNING, str);
         return DLT_RETURN_ERROR;
     }
-    file->file_length = ftell(file->handle);
 
-    if (0 != fseek(file->handle,0,SEEK_SET))
+    if (dlt_file_read_data(file,verbose) < DLT_RETURN_OK)
     {
-        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"dlt_file_open: Seek failed to 0,SEEK_SET");
-        dlt_log(LOG_WARNING, str);
         return DLT_RETURN_ERROR;
     }
 
-    if (verbose)
-    {
-        /* print file length */
-        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"File is %lu bytes long\n",file->file_length);
-        dlt_log(LOG_DEBUG, str);
-    }
+    /* set current position in file */
+    file->position = index;
+
     return DLT_RETURN_OK;
 }
 
-DltReturnValue dlt_file_read(DltFile *file,int verbose)
+DltReturnValue dlt_file_message_view(DltFile *file, int index, DltMessage *msg, int verbose)
 {
-    long *ptr;
-    int found = DLT_RETURN_OK;
+    long position;
+    int32_t headersize;
+    int32_t datasize;
 
-    if (verbose)
-    {
-        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"%s: Message %d:\n",__func__, file->counter_total);
-        dlt_log(LOG_DEBUG, str);
-    }
+    PRINT_FUNCTION_VERBOSE(verbose);
 
-    if (file == NULL)
+    if ((file == NULL) || (msg == NULL))
     {
         return DLT_RETURN_WRONG_PARAMETER;
     }
 
-    /* allocate new memory for index if number of messages exceeds a multiple of DLT_COMMON_INDEX_ALLOC (e.g.: 1000) */
-    if (file->counter % DLT_COMMON_INDEX_ALLOC == 0)
+    position = dlt_file_index_position(file, index);
+
+    if ((position < 0) || (file->index->map == NULL) ||
+        (file->index->map_length - position < (long) (sizeof(DltStorageHeader) + sizeof(DltStandardHeader))))
     {
-        ptr = (long *) malloc(((file->counter/DLT_COMMON_INDEX_ALLOC) + 1) * DLT_COMMON_INDEX_ALLOC * sizeof(long));
+        return DLT_RETURN_ERROR;
+    }
 
-        if (ptr == NULL)
-        {
-            return DLT_RETURN_ERROR;
-        }
+    memcpy(msg->headerbuffer, file->index->map + position, sizeof(DltStorageHeader) + sizeof(DltStandardHeader));
+    msg->storageheader = (DltStorageHeader *) msg->headerbuffer;
+    msg->standardheader = (DltStandardHeader *) (msg->headerbuffer + sizeof(DltStorageHeader));
 
-        if (file->index)
-        {
-            memcpy(ptr,file->index,file->counter * sizeof(long));
-            free(file->index);
-        }
-        file->index = ptr;
-    }
+    headersize = sizeof(DltStorageHeader) + sizeof(DltStandardHeader) +
+                 DLT_STANDARD_HEADER_EXTRA_SIZE(msg->standardheader->htyp) +
+                 (DLT_IS_HTYP_UEH(msg->standardheader->htyp) ? sizeof(DltExtendedHeader) : 0);
+    datasize = DLT_BETOH_16(msg->standardheader->len) + sizeof(DltStorageHeader) - headersize;
 
-    /* set to end of last succesful read message, because of conflicting calls to dlt_file_read and dlt_file_message */
-    if (0 !=  fseek(file->handle,file->file_position,SEEK_SET))
+    if ((datasize < 0) || (file->index->map_length - position < headersize + datasize))
     {
-        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Seek failed to file_position %ld \n",file->file_position);
-        dlt_log(LOG_WARNING, str);
         return DLT_RETURN_ERROR;
     }
 
-    /* get file position at start of DLT message */
-    if (verbose)
-    {
-        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Position in file: %ld\n",file->file_position);
-        dlt_log(LOG_INFO, str);
-    }
+    memcpy(msg->headerbuffer + sizeof(DltStorageHeader) + sizeof(DltStandardHeader),
+           file->index->map + position + sizeof(DltStorageHeader) + sizeof(DltStandardHeader),
+           headersize - sizeof(DltStorageHeader) - sizeof(DltStandardHeader));
+    msg->headersize = headersize;
+    msg->datasize = datasize;
 
-    /* read header */
-    if (dlt_file_read_header(file,verbose) < DLT_RETURN_OK)
+    if (DLT_STANDARD_HEADER_EXTRA_SIZE(msg->standardheader->htyp))
     {
-        /* go back to last position in file */
-        fseek(file->handle,file->file_position,SEEK_SET);
-        return DLT_RETURN_ERROR;
+        dlt_message_get_extraparameters(msg, verbose);
     }
 
-    if (file->filter)
+    if (DLT_IS_HTYP_UEH(msg->standardheader->htyp))
     {
-        /* read the extended header if filter is enabled and extended header exists */
-        if (dlt_file_read_header_extended(file, verbose) < DLT_RETURN_OK)
-        {
-            /* go back to last position in file */
-            if (0 != fseek(file->handle,file->file_position,SEEK_SET))
-            {
-                snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Seek to last file pos failed!\n");
-                dlt_log(LOG_WARNING, str);
-            }
-            return DLT_RETURN_ERROR;
-        }
-
-        /* check the filters if message is used */
-        if (dlt_message_filter_check(&(file->msg),file->filter,verbose) == DLT_RETURN_TRUE)
-        {
-            /* filter matched, consequently store current message */
-            /* store index pointer to message position in DLT file */
-            file->index[file->counter] = file->file_position;
-            file->counter++;
-            file->position = file->counter - 1;
-
-            found = DLT_RETURN_TRUE;
-        }
-
-        /* skip payload data */
-        if (fseek(file->handle,file->msg.datasize,SEEK_CUR)!=0)
-        {
-            /* go back to last position in file */
-            snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Seek failed to skip payload data of size %d!\n",file->msg.datasize);
-            dlt_log(LOG_WARNING, str);
-
-            if (0 != fseek(file->handle,file->file_position,SEEK_SET))
-            {
-                snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Seek back also failed!\n");
-                dlt_log(LOG_WARNING, str);
-            }
-
-            return DLT_RETURN_ERROR;
-        }
+        msg->extendedheader = (DltExtendedHeader *) (msg->headerbuffer + sizeof(DltStorageHeader) + sizeof(DltStandardHeader) +
+                              DLT_STANDARD_HEADER_EXTRA_SIZE(msg->standardheader->htyp));
     }
     else
     {
-        /* filter is disabled */
-        /* skip additional header parameters and payload data */
-        if (fseek(file->handle,file->msg.headersize - sizeof(DltStorageHeader) - sizeof(DltStandardHeader) + file->msg.datasize,SEEK_CUR))
-        {
-
-            snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Seek failed to skip extra header and payload data from file of size %d!\n",
-                    file->msg.headersize - (int32_t)sizeof(DltStorageHeader) - (int32_t)sizeof(DltStandardHeader) + file->msg.datasize);
-            dlt_log(LOG_WARNING, str);
-            /* go back to last position in file */
-            if (fseek(file->handle,file->file_position,SEEK_SET))
-            {
-                snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Seek back also failed!\n");
-                dlt_log(LOG_WARNING, str);
-            }
-            return DLT_RETURN_ERROR;
-        }
-
-        /* store index pointer to message position in DLT file */
-        file->index[file->counter] = file->file_position;
-        file->counter++;
-        file->position = file->counter - 1;
-
-        found = DLT_RETURN_TRUE;
+        msg->extendedheader = NULL;
     }
 
-    /* increase total message counter */
-    file->counter_total++;
+    /* payload stays in the mapping */
+    msg->databuffer = (uint8_t *) (file->index->map + position + headersize);
+    msg->databuffersize = 0;
 
-    /* store position to next message */
-    file->file_position = ftell(file->handle);
+    return DLT_RETURN_OK;
+}
 
-    return found;
+int dlt_file_is_mapped(DltFile *file)
+{
+    return (file != NULL) && (file->index != NULL) && (file->index->map != NULL);
 }
 
-DltReturnValue dlt_file_read_raw(DltFile *file, int resync, int verbose)
+long dlt_file_index_position(DltFile *file, int32_t index)
 {
-    int found = DLT_RETURN_OK;
-    long *ptr;
+    uint64_t high;
 
-    if (verbose)
+    if (file == NULL || file->index == NULL || index < 0 || index >= file->counter)
     {
-        snprintf(str, DLT_COMMON_BUFFER_LENGTH, "%s: Message %d:\n", __func__, file->counter_total);
-        dlt_log(LOG_DEBUG, str);
+        return -1;
     }
 
-    if (file == NULL)
-        return DLT_RETURN_WRONG_PARAMETER;
+    high = file->index->wraps;
 
-    /* allocate new memory for index if number of messages exceeds a multiple of DLT_COMMON_INDEX_ALLOC (e.g.: 1000) */
-    if (file->counter % DLT_COMMON_INDEX_ALLOC == 0)
+    while (high > 0 && file->index->wrap[high - 1] > index)
     {
-        ptr = (long *) malloc(((file->counter/DLT_COMMON_INDEX_ALLOC) + 1) * DLT_COMMON_INDEX_ALLOC * sizeof(long));
+        high--;
+    }
 
-        if (ptr == NULL)
-        {
-            return DLT_RETURN_ERROR;
-        }
+    return (long) ((high << 32) | file->index->position[index]);
+}
 
-        if (file->index)
-        {
-            memcpy(ptr,file->index,file->counter * sizeof(long));
-            free(file->index);
-        }
-        file->index = ptr;
-    }
+DltReturnValue dlt_file_index_save(DltFile *file, const char *filename, int verbose)
+{
+    DltFileIndexHeader header;
+    char tmpname[PATH_MAX + 1];
+    struct stat st;
+    FILE *handle;
+    int ok;
 
-    /* set to end of last successful read message, because of conflicting calls to dlt_file_read and dlt_file_message */
-    if (0 != fseek(file->handle,file->file_position,SEEK_SET))
-        return DLT_RETURN_ERROR;
+    PRINT_FUNCTION_VERBOSE(verbose);
 
-    /* get file position at start of DLT message */
-    if (verbose)
+    if (file == NULL || filename == NULL || file->handle == NULL || file->index == NULL)
     {
-        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Position in file: %ld\n",file->file_position);
-        dlt_log(LOG_DEBUG, str);
+        return DLT_RETURN_WRONG_PARAMETER;
     }
 
-    /* read header */
-    if (dlt_file_read_header_raw(file,resync,verbose) < DLT_RETURN_OK)
+    if (fstat(fileno(file->handle), &st) != 0)
     {
-        /* go back to last position in file */
-        if (0!= fseek(file->handle,file->file_position,SEEK_SET))
-        {
-            snprintf(str,DLT_COMMON_BUFFER_LENGTH,"dlt_file_read_raw, fseek failed 1\n");
-            dlt_log(LOG_WARNING, str);
-        }
         return DLT_RETURN_ERROR;
     }
 
-    /* read the extended header if filter is enabled and extended header exists */
-    if (dlt_file_read_header_extended(file, verbose) < DLT_RETURN_OK)
+    memset(&header, 0, sizeof(header));
+    memcpy(header.pattern, DLT_COMMON_INDEX_FILE_PATTERN, DLT_ID_SIZE);
+    header.version = DLT_COMMON_INDEX_FILE_VERSION;
+    header.trace_size = st.st_size;
+    header.trace_mtime_sec = st.st_mtim.tv_sec;
+    header.trace_mtime_nsec = st.st_mtim.tv_nsec;
+    header.file_position = file->file_position;
+    header.filter_hash = dlt_file_filter_hash(file->filter);
+    header.counter = file->counter;
+    header.counter_total = file->counter_total;
+    header.error_messages = file->error_messages;
+    header.index_wraps = file->index->wraps;
+
+    /* write a temporary file first, so that readers never see a partial index */
+    if (snprintf(tmpname, sizeof(tmpname), "%s.tmp", filename) >= (int) sizeof(tmpname))
     {
-        /* go back to last position in file */
-        if (0 != fseek(file->handle,file->file_position,SEEK_SET))
-        {
-            snprintf(str,DLT_COMMON_BUFFER_LENGTH,"dlt_file_read_raw, fseek failed 2\n");
-            dlt_log(LOG_WARNING, str);
-        }
         return DLT_RETURN_ERROR;
     }
 
-    if (dlt_file_read_data(file,verbose) < DLT_RETURN_OK)
+    handle = fopen(tmpname, "wb");
+
+    if (handle == NULL)
     {
-        /* go back to last position in file */
-        if (0 != fseek(file->handle,file->file_position,SEEK_SET))
-        {
-            snprintf(str,DLT_COMMON_BUFFER_LENGTH,"dlt_file_read_raw, fseek failed 3\n");
-            dlt_log(LOG_WARNING, str);
-        }
+        snprintf(str, DLT_COMMON_BUFFER_LENGTH, "Index file %.200s cannot be created!\n", tmpname);
+        dlt_log(LOG_WARNING, str);
         return DLT_RETURN_ERROR;
     }
 
-    /* store index pointer to message position in DLT file */
-    file->index[file->counter] = file->file_position;
-    file->counter++;
-    file->position = file->counter - 1;
-
-    found = DLT_RETURN_TRUE;
+    ok = (fwrite(&header, sizeof(header), 1, handle) == 1) &&
+         ((file->counter == 0) ||
+          (fwrite(file->index->position, sizeof(uint32_t), file->counter, handle) == (size_t) file->counter)) &&
+         ((file->index->wraps == 0) ||
+          (fwrite(file->index->wrap, sizeof(int32_t), file->index->wraps, handle) == (size_t) file->index->wraps));
 
-    /* increase total message counter */
-    file->counter_total++;
+    if ((fclose(handle) != 0) || !ok || (rename(tmpname, filename) != 0))
+    {
+        snprintf(str, DLT_COMMON_BUFFER_LENGTH, "Index file %s cannot be written!\n", filename);
+        dlt_log(LOG_WARNING, str);
+        unlink(tmpname);
+        return DLT_RETURN_ERROR;
+    }
 
-    /* store position to next message */
-    file->file_position = ftell(file->handle);
+    if (verbose)
+    {
+        snprintf(str, DLT_COMMON_BUFFER_LENGTH, "Index of %d messages written to %s\n", file->counter, filename);
+        dlt_log(LOG_DEBUG, str);
+    }
 
-    return found;
+    return DLT_RETURN_OK;
 }
 
-DltReturnValue dlt_file_close(DltFile *file, int verbose)
+DltReturnValue dlt_file_index_load(DltFile *file, const char *filename, int verbose)
 {
+    DltFileIndexHeader header;
+    struct stat st;
+    FILE *handle;
+    uint32_t *index;
+    int32_t *wrap = NULL;
+    int32_t size;
+    int ok;
+
     PRINT_FUNCTION_VERBOSE(verbose);
 
-    if (file == NULL)
+    if (file == NULL || filename == NULL || file->handle == NULL || file->index == NULL)
     {
         return DLT_RETURN_WRONG_PARAMETER;
     }
 
-    if (file->handle)
+    if (fstat(fileno(file->handle), &st) != 0)
     {
-        fclose(file->handle);
+        return DLT_RETURN_ERROR;
     }
 
-    file->handle = NULL;
+    handle = fopen(filename, "rb");
 
-    return DLT_RETURN_OK;
-}
+    if (handle == NULL)
+    {
+        return DLT_RETURN_ERROR;
+    }
 
-DltReturnValue dlt_file_message(DltFile *file, int index, int verbose)
-{
-    PRINT_FUNCTION_VERBOSE(verbose);
+    if ((fread(&header, sizeof(header), 1, handle) != 1) ||
+        (memcmp(header.pattern, DLT_COMMON_INDEX_FILE_PATTERN, DLT_ID_SIZE) != 0) ||
+        (header.version != DLT_COMMON_INDEX_FILE_VERSION) ||
+        (header.trace_size != (uint64_t) st.st_size) ||
+        (header.trace_mtime_sec != st.st_mtim.tv_sec) ||
+        (header.trace_mtime_nsec != st.st_mtim.tv_nsec) ||
+        (header.filter_hash != dlt_file_filter_hash(file->filter)) ||
+        (header.file_position < 0) ||
+        (header.counter < 0) ||
+        (header.counter_total < header.counter) ||
+        (header.index_wraps < 0) ||
+        ((uint64_t) header.index_wraps > ((uint64_t) st.st_size >> 32)))
+    {
+        if (verbose)
+        {
+            snprintf(str, DLT_COMMON_BUFFER_LENGTH, "Index file %s does not match the DLT file\n", filename);
+            dlt_log(LOG_DEBUG, str);
+        }
 
-    if (file == NULL)
-    {
-        return DLT_RETURN_WRONG_PARAMETER;
+        fclose(handle);
+        return DLT_RETURN_ERROR;
     }
 
-    /* check if message is in range */
-    if (index >= file->counter)
+    /* keep the usual growth steps for messages read later */
+    size = file->index->size;
+
+    while (size < header.counter)
     {
-        snprintf(str,DLT_COMMON_BUFFER_LENGTH, "Message %d out of range!\r\n", index);
-        dlt_log(LOG_WARNING, str);
-        return DLT_RETURN_WRONG_PARAMETER;
+        size = (size > INT32_MAX / 2) ? INT32_MAX : (size ? size * 2 : DLT_COMMON_INDEX_ALLOC);
     }
 
-    /* seek to position in file */
-    if (fseek(file->handle,file->index[index],SEEK_SET)!=0)
+    index = (uint32_t *) realloc(file->index->position, size * sizeof(uint32_t));
+
+    if (index == NULL)
     {
-        snprintf(str,DLT_COMMON_BUFFER_LENGTH,"Seek to message %d to position %ld failed!\r\n",index,file->index[index]);
-        dlt_log(LOG_WARNING, str);
+        fclose(handle);
         return DLT_RETURN_ERROR;
     }
 
-    /* read all header and payload */
-    if (dlt_file_read_header(file,verbose) < DLT_RETURN_OK)
+    file->index->position = index;
+    file->index->size = size;
+
+    if (header.index_wraps > 0)
     {
-        return DLT_RETURN_ERROR;
+        wrap = (int32_t *) malloc(header.index_wraps * sizeof(int32_t));
     }
 
-    if (dlt_file_read_header_extended(file,verbose) < DLT_RETURN_OK)
+    ok = ((header.counter == 0) ||
+          (fread(file->index->position, sizeof(uint32_t), header.counter, handle) == (size_t) header.counter)) &&
+         ((header.index_wraps == 0) ||
+          ((wrap != NULL) &&
+           (fread(wrap, sizeof(int32_t), header.index_wraps, handle) == (size_t) header.index_wraps)));
+
+    fclose(handle);
+
+    if (!ok)
     {
+        snprintf(str, DLT_COMMON_BUFFER_LENGTH, "Index file %s cannot be read!\n", filename);
+        dlt_log(LOG_WARNING, str);
+        free(wrap);
+
+        /* the index may be partly overwritten, start over */
+        free(file->index->wrap);
+        file->index->wrap = NULL;
+        file->index->wraps = 0;
+        file->counter = 0;
+        file->counter_total = 0;
+        file->error_messages = 0;
+        file->position = 0;
+        file->file_position = 0;
         return DLT_RETURN_ERROR;
     }
 
-    if (dlt_file_read_data(file,verbose) < DLT_RETURN_OK)
+    free(file->index->wrap);
+    file->index->wrap = wrap;
+    file->index->wraps = header.index_wraps;
+
+    file->counter = header.counter;
+    file->counter_total = header.counter_total;
+    file->error_messages = header.error_messages;
+    file->position = header.counter > 0 ? header.counter - 1 : 0;
+    file->file_position = header.file_position;
+
+    if (verbose)
     {
-        return DLT_RETURN_ERROR;
+        snprintf(str, DLT_COMMON_BUFFER_LENGTH, "Index of %d messages loaded from %s\n", file->counter, filename);
+        dlt_log(LOG_DEBUG, str);
     }
 
-    /* set current position in file */
-    file->position = index;
-
     return DLT_RETURN_OK;
 }
 
@@ -1951,6 +3734,9 @@ DltReturnValue dlt_file_free(DltFile *file, int verbose)
     /* delete index lost if exists */
     if (file->index)
     {
+        dlt_file_unmap(file);
+        free(file->index->position);
+        free(file->index->wrap);
         free(file->index);
     }
     file->index = NULL;
@@ -2284,6 +4070,38 @@ DltReturnValue dlt_receiver_move_to_begin(DltReceiver *receiver)
     return DLT_RETURN_OK;
 }
 
+DltReturnValue dlt_receiver_grow(DltReceiver *receiver, int32_t buffersize)
+{
+    char *buffer;
+
+    if (receiver == NULL)
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
+
+    if ((receiver->buffer == NULL) || (receiver->buf == NULL))
+    {
+        return DLT_RETURN_ERROR;
+    }
+
+    if (buffersize <= receiver->buffersize)
+    {
+        return DLT_RETURN_OK;
+    }
+
+    buffer = (char*)realloc(receiver->buffer, buffersize);
+    if (buffer == NULL)
+    {
+        return DLT_RETURN_ERROR;
+    }
+
+    receiver->buf = buffer + (receiver->buf - receiver->buffer);
+    receiver->buffer = buffer;
+    receiver->buffersize = buffersize;
+
+    return DLT_RETURN_OK;
+}
+
 int dlt_receiver_check_and_get(DltReceiver *receiver,
                                void *dest,
                                unsigned int to_get,
@@ -85,9 +85,20 @@
 /* Length of one char */
 #define DLT_COMMON_CHARLEN     1
 
-/* Number of indices to be allocated at one, if no more indeces are left */
+/* Number of indices to be allocated at first, doubled if no more indeces are left */
 #define DLT_COMMON_INDEX_ALLOC       1000
 
+/* Limits of the size of the parts of a file indexed in parallel */
+#define DLT_COMMON_PARALLEL_CHUNK_MIN (1024 * 1024)
+#define DLT_COMMON_PARALLEL_CHUNK_MAX (256 * 1024 * 1024)
+
+/* Size of the ASCII payload to which regular expressions of filters are applied */
+#define DLT_COMMON_FILTER_TEXT_LENGTH 10024
+
+/* Pattern and version at the beginning of an index file */
+#define DLT_COMMON_INDEX_FILE_PATTERN "DLTI"
+#define DLT_COMMON_INDEX_FILE_VERSION 1
+
 /* If limited output is called,
    this is the maximum number of characters to be printed out */
 #define DLT_COMMON_ASCII_LIMIT_MAX_CHARS 20
@@ -61,8 +61,12 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <errno.h>
+#include <sys/uio.h>
 #include <dirent.h>
 #include <syslog.h>
+#include <signal.h>
+#include <pthread.h>
 
 #include <dlt_offline_trace.h>
 #include "dlt_common.h"
@@ -205,13 +209,282 @@ unsigned int dlt_offline_trace_get_idx_of_log_file(char *file)
 }
 
 
+/* append a file to the file list as newest file */
+static DltReturnValue dlt_offline_trace_add_file(DltOfflineTrace *trace, const char *name, unsigned long size) {
+
+    DltOfflineTraceFile *files;
+    int max;
+    int i;
+
+    if (trace->filesNum == trace->filesMax)
+    {
+        max = (trace->filesMax > 0) ? (2 * trace->filesMax) : DLT_OFFLINETRACE_FILES_ALLOC;
+        files = malloc(max * sizeof(DltOfflineTraceFile));
+
+        if (files == NULL)
+        {
+            printf("Offline trace file list cannot be allocated\n");
+            return DLT_RETURN_ERROR;
+        }
+
+        /* the oldest file is at the beginning again */
+        for (i = 0; i < trace->filesNum; i++)
+            files[i] = trace->files[(trace->filesFirst + i) % trace->filesMax];
+
+        free(trace->files);
+        trace->files = files;
+        trace->filesFirst = 0;
+        trace->filesMax = max;
+    }
+
+    files = &trace->files[(trace->filesFirst + trace->filesNum) % trace->filesMax];
+    strncpy(files->name, name, NAME_MAX);
+    files->name[NAME_MAX] = 0;
+    files->size = size;
+
+    trace->filesNum++;
+    trace->totalSize += size;
+
+    return DLT_RETURN_OK;
+}
+
+static DltOfflineTraceFile *dlt_offline_trace_newest_file(DltOfflineTrace *trace) {
+
+    if (trace->filesNum == 0)
+        return NULL;
+
+    return &trace->files[(trace->filesFirst + trace->filesNum - 1) % trace->filesMax];
+}
+
+typedef struct
+{
+    time_t mtime;
+    DltOfflineTraceFile file;
+} DltOfflineTraceScan;
+
+/* oldest first, files of the same age by name */
+static int dlt_offline_trace_compare_files(const void *a, const void *b) {
+
+    const DltOfflineTraceScan *file_a = a;
+    const DltOfflineTraceScan *file_b = b;
+
+    if (file_a->mtime != file_b->mtime)
+        return (file_a->mtime < file_b->mtime) ? -1 : 1;
+
+    return strcmp(file_a->file.name, file_b->file.name);
+}
+
+/* build the file list from the files in the offline trace directory */
+static DltReturnValue dlt_offline_trace_read_files(DltOfflineTrace *trace) {
+
+    struct dirent *dp;
+    char filename[PATH_MAX+1];
+    struct stat status;
+    DltOfflineTraceScan *scan = NULL;
+    DltOfflineTraceScan *tmp;
+    int num = 0;
+    int max = 0;
+    int len = strlen(DLT_OFFLINETRACE_FILENAME_BASE);
+    unsigned int idx;
+    int i;
+
+    /* go through all dlt files in directory */
+    DIR *dir = opendir(trace->directory);
+
+    if (dir == NULL)
+    {
+        dlt_vlog(LOG_ERR, "Offline trace directory: %s cannot be read\n", trace->directory);
+        return DLT_RETURN_ERROR;
+    }
+
+    while ((dp=readdir(dir)) != NULL) {
+        if(strstr(dp->d_name,DLT_OFFLINETRACE_FILENAME_BASE) == NULL)
+            continue;
+
+        int res = snprintf(filename, sizeof(filename), "%s/%s",trace->directory,dp->d_name);
+        // if the total length of the string is greater than the buffer, silently forget it.
+        if( (unsigned int)res>=sizeof(filename) || res<=0 )
+            continue;
+
+        if(0 != stat(filename,&status))
+        {
+            printf("Offline trace file %s cannot be stat-ed\n",filename);
+            continue;
+        }
+
+        if (num == max)
+        {
+            max = (max > 0) ? (2 * max) : DLT_OFFLINETRACE_FILES_ALLOC;
+            tmp = realloc(scan, max * sizeof(DltOfflineTraceScan));
+
+            if (tmp == NULL)
+            {
+                printf("Offline trace file list cannot be allocated\n");
+                break;
+            }
+
+            scan = tmp;
+        }
+
+        scan[num].mtime = status.st_mtime;
+        strncpy(scan[num].file.name, dp->d_name, NAME_MAX);
+        scan[num].file.name[NAME_MAX] = 0;
+        scan[num].file.size = status.st_size;
+        num++;
+
+        /* newest index of index based filenames "dlt_offlinetrace.<index>.dlt" */
+        if ((strncmp(dp->d_name, DLT_OFFLINETRACE_FILENAME_BASE, len) == 0) &&
+            (dp->d_name[len] == DLT_OFFLINETRACE_FILENAME_DELI[0]))
+        {
+            idx = strtoul(dp->d_name + len + 1, NULL, 10);
+
+            if (idx > trace->fileIndex)
+                trace->fileIndex = idx;
+        }
+    }
+
+    closedir(dir);
+
+    if (num > 0)
+        qsort(scan, num, sizeof(DltOfflineTraceScan), dlt_offline_trace_compare_files);
+
+    for (i = 0; i < num; i++)
+        dlt_offline_trace_add_file(trace, scan[i].file.name, scan[i].file.size);
+
+    free(scan);
+
+    return DLT_RETURN_OK;
+}
+
+/* remove the files deleted from the file list, in the background */
+static void *dlt_offline_trace_remover(void *arg) {
+
+    DltOfflineTrace *trace = (DltOfflineTrace *)arg;
+    DltOfflineTraceRemoval *removal;
+    sigset_t set;
+
+    /* signals are handled by the main loop */
+    sigfillset(&set);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+    pthread_mutex_lock(&trace->removerMutex);
+
+    while (1)
+    {
+        while ((trace->removeFirst == NULL) && !trace->removerStop)
+            pthread_cond_wait(&trace->removerCond, &trace->removerMutex);
+
+        /* files queued before stop are removed */
+        if (trace->removeFirst == NULL)
+            break;
+
+        removal = trace->removeFirst;
+        trace->removeFirst = removal->next;
+
+        if (trace->removeFirst == NULL)
+            trace->removeLast = NULL;
+
+        trace->removing = removal;
+        pthread_mutex_unlock(&trace->removerMutex);
+
+        if(remove(removal->filename))
+            printf("Remove file %s failed!\n",removal->filename);
+
+        pthread_mutex_lock(&trace->removerMutex);
+        trace->removing = NULL;
+        free(removal);
+        pthread_cond_broadcast(&trace->removerCond);
+    }
+
+    pthread_mutex_unlock(&trace->removerMutex);
+
+    return NULL;
+}
+
+/* remove a file deleted from the file list */
+static void dlt_offline_trace_remove(DltOfflineTrace *trace, const char *filename) {
+
+    DltOfflineTraceRemoval *removal = NULL;
+
+    if (trace->removerRunning)
+        removal = malloc(sizeof(DltOfflineTraceRemoval));
+
+    if (removal == NULL)
+    {
+        if(remove(filename))
+            printf("Remove file %s failed!\n",filename);
+
+        return;
+    }
+
+    strncpy(removal->filename, filename, PATH_MAX);
+    removal->filename[PATH_MAX] = 0;
+    removal->next = NULL;
+
+    pthread_mutex_lock(&trace->removerMutex);
+
+    if (trace->removeLast != NULL)
+        trace->removeLast->next = removal;
+    else
+        trace->removeFirst = removal;
+
+    trace->removeLast = removal;
+    pthread_cond_broadcast(&trace->removerCond);
+    pthread_mutex_unlock(&trace->removerMutex);
+}
+
+/* remove a file of the given name now, if it still waits for removal */
+static void dlt_offline_trace_wait_removed(DltOfflineTrace *trace, const char *filename) {
+
+    DltOfflineTraceRemoval *removal;
+    DltOfflineTraceRemoval *prev = NULL;
+    DltOfflineTraceRemoval *next;
+    int found = 0;
+
+    if (!trace->removerRunning)
+        return;
+
+    pthread_mutex_lock(&trace->removerMutex);
+
+    for (removal = trace->removeFirst; removal != NULL; removal = next)
+    {
+        next = removal->next;
+
+        if (strcmp(removal->filename, filename) != 0)
+        {
+            prev = removal;
+            continue;
+        }
+
+        if (prev != NULL)
+            prev->next = next;
+        else
+            trace->removeFirst = next;
+
+        if (trace->removeLast == removal)
+            trace->removeLast = prev;
+
+        free(removal);
+        found = 1;
+    }
+
+    while ((trace->removing != NULL) && (strcmp(trace->removing->filename, filename) == 0))
+        pthread_cond_wait(&trace->removerCond, &trace->removerMutex);
+
+    pthread_mutex_unlock(&trace->removerMutex);
+
+    if (found && remove(filename))
+        printf("Remove file %s failed!\n",filename);
+}
+
 DltReturnValue dlt_offline_trace_create_new_file(DltOfflineTrace *trace) {
     time_t t;
     struct tm *tmp;
     char outstr[200];
-    char newest[DLT_OFFLINETRACE_FILENAME_MAX_SIZE] = {0};
-    char oldest[DLT_OFFLINETRACE_FILENAME_MAX_SIZE] = {0};
     unsigned int idx = 0;
+    struct stat status;
+    DltOfflineTraceFile *newest;
+    const char *name;
 
     /* set filename */
     if(trace->filenameTimestampBased)
@@ -235,9 +508,8 @@ DltReturnValue dlt_offline_trace_create_new_file(DltOfflineTrace *trace) {
     else
     {
         int ret = 0;
-        /* targeting newest file, ignoring number of files in dir returned */
-        dlt_offline_trace_storage_dir_info(trace->directory, DLT_OFFLINETRACE_FILENAME_BASE, newest, oldest);
-        idx = dlt_offline_trace_get_idx_of_log_file(newest) + 1;
+        /* the index of the newest file is known from the file list */
+        idx = trace->fileIndex + 1;
 
         dlt_offline_trace_file_name(outstr, DLT_OFFLINETRACE_FILENAME_BASE, idx);
         ret = snprintf(trace->filename, NAME_MAX, "%s/%s", trace->directory, outstr);
@@ -246,8 +518,12 @@ DltReturnValue dlt_offline_trace_create_new_file(DltOfflineTrace *trace) {
             printf("filename cannot be concatenated\n");
             return DLT_RETURN_ERROR;
         }
+
+        trace->fileIndex = idx;
     }
 
+    /* a deleted file of the same name must be gone before it is created again */
+    dlt_offline_trace_wait_removed(trace, trace->filename);
 
     /* open DLT output file */
     trace->ohandle = open(trace->filename,O_WRONLY|O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH); /* mode: wb */
@@ -258,94 +534,74 @@ DltReturnValue dlt_offline_trace_create_new_file(DltOfflineTrace *trace) {
         return DLT_RETURN_ERROR;
     } /* if */
 
-    return DLT_RETURN_OK; /* OK */
+    /* the file is written from its beginning */
+    trace->fileOffset = 0;
+
+    /* an existing file is reused if the filename did not change */
+    name = trace->filename + strlen(trace->directory) + 1;
+    newest = dlt_offline_trace_newest_file(trace);
+
+    if ((newest != NULL) && (strcmp(newest->name, name) == 0))
+    {
+        trace->totalSize -= newest->size;
+        trace->filesNum--;
+    }
+
+    if (fstat(trace->ohandle, &status) != 0)
+        status.st_size = 0;
+
+    return dlt_offline_trace_add_file(trace, name, status.st_size);
 }
 
-unsigned long dlt_offline_trace_get_total_size(DltOfflineTrace *trace) {
-    struct dirent *dp;
-    char filename[256];
-    unsigned long size = 0;
+/* update the size of the currently used file in the file list and close it */
+static void dlt_offline_trace_close_file(DltOfflineTrace *trace) {
+
     struct stat status;
+    DltOfflineTraceFile *newest = dlt_offline_trace_newest_file(trace);
 
-    /* go through all dlt files in directory */
-    DIR *dir = opendir(trace->directory);
-    while ((dp=readdir(dir)) != NULL) {
-        if(strstr(dp->d_name,DLT_OFFLINETRACE_FILENAME_BASE))
-        {
-            int res = snprintf(filename, sizeof(filename), "%s/%s",trace->directory,dp->d_name);
-            // if the total length of the string is greater than the buffer, silently forget it.
-            // snprintf: a return value of size  or more means that the output was truncated
-            //           if an output error is encountered, a negative value is returned.
-            if( (unsigned int)res<sizeof(filename) && res>0 )
-            {
-                if(0 == stat(filename,&status))
-                {
-                    size += status.st_size;
-                }
-                else
-                    printf("Offline trace file %s cannot be stat-ed",filename);
-            }
-            //else
-            //{
-            //    dlt_log(3, "dlt_offline_trace_get_total_size: long filename ignored");
-            //}
-        }
+    if ((newest != NULL) &&
+        (strcmp(newest->name, trace->filename + strlen(trace->directory) + 1) == 0) &&
+        (fstat(trace->ohandle, &status) == 0))
+    {
+        trace->totalSize += status.st_size - newest->size;
+        newest->size = status.st_size;
     }
 
-    closedir(dir);
+    close(trace->ohandle);
+    trace->ohandle = -1;
+}
+
+unsigned long dlt_offline_trace_get_total_size(DltOfflineTrace *trace) {
 
     /* return size */
-    return size;
+    return trace->totalSize;
 }
 
 int dlt_offline_trace_delete_oldest_file(DltOfflineTrace *trace) {
-    struct dirent *dp;
     char filename[PATH_MAX+1];
-    char filename_oldest[PATH_MAX+1];
-    unsigned long size_oldest = 0;
-    struct stat status;
-    time_t time_oldest = 0;
-
-    filename[0] = 0;
-    filename_oldest[0] = 0;
+    DltOfflineTraceFile *oldest;
+    unsigned long size_oldest;
+    int res;
 
-    /* go through all dlt files in directory */
-    DIR *dir = opendir(trace->directory);
-    while ((dp=readdir(dir)) != NULL) {
-        if(strstr(dp->d_name,DLT_OFFLINETRACE_FILENAME_TO_COMPARE)) {
-            int res = snprintf(filename, sizeof(filename), "%s/%s",trace->directory,dp->d_name);
-                // if the total length of the string is greater than the buffer, silently forget it.
-                // snprintf: a return value of size  or more means that the output was truncated
-                //           if an output error is encountered, a negative value is returned.
-                if( (unsigned int)res<sizeof(filename) && res>0 )
-                {
-                    if(0 == stat(filename,&status))
-                    {
-                        if(time_oldest == 0 || status.st_mtime < time_oldest) {
-                                time_oldest = status.st_mtime;
-                                size_oldest = status.st_size;
-                                strncpy(filename_oldest,filename,PATH_MAX);
-                                filename_oldest[PATH_MAX]=0;
-                        }
-                    }
-                    else
-                        printf("Old offline trace file %s cannot be stat-ed",filename);
-                }
-        }
+    if (trace->filesNum == 0) {
+        printf("No file to be removed!\n");
+        return -1; /* ERROR */
     }
-    closedir(dir);
+
+    /* the file list is ordered by age */
+    oldest = &trace->files[trace->filesFirst];
+    size_oldest = oldest->size;
+    res = snprintf(filename, sizeof(filename), "%s/%s", trace->directory, oldest->name);
+
+    trace->filesFirst = (trace->filesFirst + 1) % trace->filesMax;
+    trace->filesNum--;
+    trace->totalSize -= size_oldest;
 
     /* delete file */
-    if(filename_oldest[0]) {
-        if(remove(filename_oldest)) {
-            printf("Remove file %s failed!\n",filename_oldest);
-            return -1; /* ERROR */
-        }
-    }
-    else {
-            printf("No file to be removed!\n");
-            return -1; /* ERROR */
-    }
+    if ((unsigned int)res < sizeof(filename) && res > 0)
+        dlt_offline_trace_remove(trace, filename);
+    else
+        printf("Old offline trace file %s/%s cannot be removed\n", trace->directory, oldest->name);
 
     /* return size of deleted file*/
     return size_oldest;
@@ -370,7 +626,7 @@ DltReturnValue dlt_offline_trace_check_size(DltOfflineTrace *trace) {
     }
     
     /* check size of complete offline trace */
-    while((int)dlt_offline_trace_get_total_size(trace) > (trace->maxSize-trace->fileSize))
+    while((long)dlt_offline_trace_get_total_size(trace) > (trace->maxSize-trace->fileSize))
     {
         /* remove oldest files as long as new file will not fit in completely into complete offline trace */
         if(dlt_offline_trace_delete_oldest_file(trace) < 0) {
@@ -389,23 +645,208 @@ DltReturnValue dlt_offline_trace_init(DltOfflineTrace *trace,const char *directo
     trace->fileSize = fileSize;
     trace->maxSize = maxSize;
     trace->filenameTimestampBased = filenameTimestampBased;
+    trace->fileOffset = 0;
+    trace->buffer = NULL;
+    trace->bufferSize = 0;
+    trace->bufferUsed = 0;
+    trace->flushInterval = 0;
+    trace->bufferTime = 0;
+    trace->files = NULL;
+    trace->filesFirst = 0;
+    trace->filesNum = 0;
+    trace->filesMax = 0;
+    trace->totalSize = 0;
+    trace->fileIndex = 0;
+    trace->removerRunning = 0;
+    trace->removerStop = 0;
+    trace->removeFirst = NULL;
+    trace->removeLast = NULL;
+    trace->removing = NULL;
+
+    /* deleted files are removed in the background */
+    pthread_mutex_init(&trace->removerMutex, NULL);
+    pthread_cond_init(&trace->removerCond, NULL);
+
+    if (pthread_create(&trace->remover, NULL, dlt_offline_trace_remover, trace) == 0)
+    {
+        trace->removerRunning = 1;
+    }
+    else
+    {
+        printf("Offline trace remover thread cannot be started, files are removed directly\n");
+        pthread_cond_destroy(&trace->removerCond);
+        pthread_mutex_destroy(&trace->removerMutex);
+    }
+
+    /* the directory is only read once, the file list is kept up to date afterwards */
+    dlt_offline_trace_read_files(trace);
+
     /* check complete offlien trace size, remove old logs if needed */
     dlt_offline_trace_check_size(trace);
 
     return dlt_offline_trace_create_new_file(trace);
 }
 
+DltReturnValue dlt_offline_trace_set_buffer(DltOfflineTrace *trace, int bufferSize, int flushInterval) {
+
+    if ((trace == NULL) || (bufferSize < 0) || (flushInterval < 0))
+        return DLT_RETURN_WRONG_PARAMETER;
+
+    if (dlt_offline_trace_flush(trace) < DLT_RETURN_OK)
+        return DLT_RETURN_ERROR;
+
+    free(trace->buffer);
+    trace->buffer = NULL;
+    trace->bufferSize = 0;
+    trace->flushInterval = flushInterval;
+
+    if (bufferSize == 0)
+        return DLT_RETURN_OK;
+
+    /* keep at least one aligned chunk */
+    if (bufferSize < DLT_OFFLINETRACE_WRITE_ALIGN)
+        bufferSize = DLT_OFFLINETRACE_WRITE_ALIGN;
+
+    trace->buffer = malloc(bufferSize);
+
+    if (trace->buffer == NULL)
+    {
+        printf("Offline trace buffer cannot be allocated\n");
+        return DLT_RETURN_ERROR;
+    }
+
+    trace->bufferSize = bufferSize;
+
+    return DLT_RETURN_OK; /* OK */
+}
+
+/* write all data of the vector, continue after partial writes */
+static DltReturnValue dlt_offline_trace_writev(int handle, struct iovec *iov, int iovcnt) {
+
+    ssize_t ret;
+
+    while (iovcnt > 0)
+    {
+        ret = writev(handle, iov, iovcnt);
+
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            printf("Offline trace write failed!\n");
+            return DLT_RETURN_ERROR;
+        }
+
+        while ((iovcnt > 0) && ((size_t)ret >= iov->iov_len))
+        {
+            ret -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+
+        if (iovcnt > 0)
+        {
+            iov->iov_base = (char *)iov->iov_base + ret;
+            iov->iov_len -= ret;
+        }
+    }
+
+    return DLT_RETURN_OK;
+}
+
+/* write the first size bytes of the staging buffer */
+static DltReturnValue dlt_offline_trace_write_buffer(DltOfflineTrace *trace, int size) {
+
+    struct iovec iov;
+
+    if (size <= 0)
+        return DLT_RETURN_OK;
+
+    iov.iov_base = trace->buffer;
+    iov.iov_len = size;
+
+    if (dlt_offline_trace_writev(trace->ohandle, &iov, 1) < DLT_RETURN_OK)
+    {
+        /* data cannot be written, do not retry it forever */
+        trace->bufferUsed = 0;
+        return DLT_RETURN_ERROR;
+    }
+
+    trace->bufferUsed -= size;
+
+    /* the age of the remaining data is kept */
+    if (trace->bufferUsed > 0)
+        memmove(trace->buffer, trace->buffer + size, trace->bufferUsed);
+
+    return DLT_RETURN_OK;
+}
+
+DltReturnValue dlt_offline_trace_flush(DltOfflineTrace *trace) {
+
+    if (trace == NULL)
+        return DLT_RETURN_WRONG_PARAMETER;
+
+    if ((trace->bufferUsed == 0) || (trace->ohandle < 0))
+        return DLT_RETURN_OK;
+
+    return dlt_offline_trace_write_buffer(trace, trace->bufferUsed);
+}
+
+DltReturnValue dlt_offline_trace_flush_due(DltOfflineTrace *trace, int period) {
+
+    uint32_t age;
+
+    if (trace == NULL)
+        return DLT_RETURN_WRONG_PARAMETER;
+
+    if (trace->bufferUsed == 0)
+        return DLT_RETURN_OK;
+
+    /* uptime is in 0.1 ms */
+    age = (dlt_uptime() - trace->bufferTime) / 10;
+
+    if ((age + (uint32_t)period) < (uint32_t)trace->flushInterval)
+        return DLT_RETURN_OK;
+
+    return dlt_offline_trace_flush(trace);
+}
+
 DltReturnValue dlt_offline_trace_write(DltOfflineTrace *trace,unsigned char *data1,int size1,unsigned char *data2,int size2,unsigned char *data3,int size3) {
 
+    struct iovec iov[3];
+    int iovcnt = 0;
+    int total = 0;
+    int aligned;
+    int i;
+
     if(trace->ohandle <= 0)
         return DLT_RETURN_ERROR;
 
-    /* check file size here */
-    if((lseek(trace->ohandle,0,SEEK_CUR)+size1+size2+size3)>=trace->fileSize)
+    if (data1 && (size1 > 0)) {
+        iov[iovcnt].iov_base = data1;
+        iov[iovcnt++].iov_len = size1;
+        total += size1;
+    }
+    if (data2 && (size2 > 0)) {
+        iov[iovcnt].iov_base = data2;
+        iov[iovcnt++].iov_len = size2;
+        total += size2;
+    }
+    if (data3 && (size3 > 0)) {
+        iov[iovcnt].iov_base = data3;
+        iov[iovcnt++].iov_len = size3;
+        total += size3;
+    }
+
+    /* check file size here, buffered data counts for the current file */
+    if((trace->fileOffset+total)>=trace->fileSize)
     {
+        /* write the rest of the old file */
+        dlt_offline_trace_flush(trace);
+
         /* close old file */
-        close(trace->ohandle);
-        trace->ohandle = -1;
+        dlt_offline_trace_close_file(trace);
 
         /* check complete offline trace size, remove old logs if needed */
         dlt_offline_trace_check_size(trace);
@@ -414,36 +855,90 @@ DltReturnValue dlt_offline_trace_write(DltOfflineTrace *trace,unsigned char *dat
         dlt_offline_trace_create_new_file(trace);
     }
 
-    /* write data into log file */
-        if(data1 && (trace->ohandle >= 0)) {
-        if(write(trace->ohandle,data1,size1)!=size1) {
-            printf("Offline trace write failed!\n");
-            return DLT_RETURN_ERROR;
-        }
+    if (trace->ohandle < 0)
+        return DLT_RETURN_OK;
+
+    trace->fileOffset += total;
+
+    if (trace->buffer == NULL)
+    {
+        /* write data into log file */
+        return dlt_offline_trace_writev(trace->ohandle, iov, iovcnt);
     }
-        if(data2 && (trace->ohandle >= 0)) {
-        if(write(trace->ohandle,data2,size2)!=size2) {
-            printf("Offline trace write failed!\n");
+
+    if ((trace->bufferUsed + total) > trace->bufferSize)
+    {
+        /* write complete chunks, the rest waits for more data */
+        aligned = trace->fileOffset - total - trace->bufferUsed;
+        aligned = ((aligned + trace->bufferUsed) & ~(DLT_OFFLINETRACE_WRITE_ALIGN - 1)) - aligned;
+
+        if (dlt_offline_trace_write_buffer(trace, aligned) < DLT_RETURN_OK)
             return DLT_RETURN_ERROR;
+
+        if ((trace->bufferUsed + total) > trace->bufferSize)
+        {
+            /* keep the order of data */
+            if (dlt_offline_trace_flush(trace) < DLT_RETURN_OK)
+                return DLT_RETURN_ERROR;
+
+            /* message does not fit at all */
+            if (total > trace->bufferSize)
+                return dlt_offline_trace_writev(trace->ohandle, iov, iovcnt);
         }
     }
-        if(data3 && (trace->ohandle >= 0)) {
-        if(write(trace->ohandle,data3,size3)!=size3) {
-            printf("Offline trace write failed!\n");
-            return DLT_RETURN_ERROR;
-        }
+
+    if (trace->bufferUsed == 0)
+        trace->bufferTime = dlt_uptime();
+
+    for (i = 0; i < iovcnt; i++) {
+        memcpy(trace->buffer + trace->bufferUsed, iov[i].iov_base, iov[i].iov_len);
+        trace->bufferUsed += iov[i].iov_len;
     }
 
-    return DLT_RETURN_OK; /* OK */
+    /* data must not stay unwritten longer than the flush interval */
+    return dlt_offline_trace_flush_due(trace, 0);
 }
 
 DltReturnValue dlt_offline_trace_free(DltOfflineTrace *trace) {
 
+    DltReturnValue ret = DLT_RETURN_OK;
+
     if(trace->ohandle <= 0)
-        return DLT_RETURN_ERROR;
+    {
+        ret = DLT_RETURN_ERROR;
+    }
+    else
+    {
+        /* write buffered data */
+        dlt_offline_trace_flush(trace);
 
-    /* close last used log file */
-    close(trace->ohandle);
+        free(trace->buffer);
+        trace->buffer = NULL;
+        trace->bufferSize = 0;
 
-    return DLT_RETURN_OK; /* OK */
+        /* close last used log file */
+        dlt_offline_trace_close_file(trace);
+    }
+
+    /* remove the remaining deleted files and stop the remover thread */
+    if (trace->removerRunning)
+    {
+        pthread_mutex_lock(&trace->removerMutex);
+        trace->removerStop = 1;
+        pthread_cond_broadcast(&trace->removerCond);
+        pthread_mutex_unlock(&trace->removerMutex);
+
+        pthread_join(trace->remover, NULL);
+        trace->removerRunning = 0;
+
+        pthread_cond_destroy(&trace->removerCond);
+        pthread_mutex_destroy(&trace->removerMutex);
+    }
+
+    free(trace->files);
+    trace->files = NULL;
+    trace->filesNum = 0;
+    trace->filesMax = 0;
+
+    return ret;
 }
@@ -55,10 +55,11 @@
 *******************************************************************************/
 
 #include <sys/types.h>
-#include <sys/ipc.h>
-#include <sys/shm.h>
-#include <sys/sem.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/eventfd.h>
+#include <fcntl.h>
+#include <errno.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -70,246 +71,502 @@
 #include <dlt_shm.h>
 #include <dlt_common.h>
 
-void dlt_shm_print_hex(char *ptr,int size)
+#define DLT_SHM_RING_ALIGN_SIZE(s) \
+    (((s) + DLT_SHM_RING_ALIGN - 1) & ~(uint32_t)(DLT_SHM_RING_ALIGN - 1))
+
+/* largest data area, keeps the free running counters unambiguous */
+#define DLT_SHM_RING_MAX_SIZE (1u << 30)
+
+static uint32_t dlt_shm_round_size(int size)
 {
-    int num;
+    uint32_t ret = DLT_SHM_RING_MIN_SIZE;
 
-    for (num=0;num<size;num++)
+    while ((ret < (uint32_t)size) && (ret < DLT_SHM_RING_MAX_SIZE))
     {
-        if((num%16)==15)
-            printf("%.2x\n",((unsigned char*)ptr)[num]);
-        else
-            printf("%.2x ",((unsigned char*)ptr)[num]);
+        ret <<= 1;
     }
-    printf("\n");
+
+    return ret;
 }
 
-void dlt_shm_pv(int id,int operation)
+DltReturnValue dlt_shm_init_client(DltShm *buf, int size)
 {
-    static struct sembuf semaphor;
-
-    semaphor.sem_op = operation;
-    semaphor.sem_flg = SEM_UNDO;
+    unsigned char *ptr;
+    size_t total;
 
-    if(semop(id, &semaphor,1) == -1) {
-        dlt_log(LOG_WARNING,"SHM: semop() failed");
+    if (buf == NULL)
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
     }
-}
-
-int dlt_shm_init_server(DltShm *buf,int key,int size) {
-    struct shmid_ds shm_buf;
-    unsigned char *ptr;
 
-    // Init parameters
-    buf->shmid = 0;
-    buf->semid = 0;
+    memset(buf, 0, sizeof(DltShm));
+    buf->memfd = -1;
+    buf->eventfd = -1;
+    buf->owner = -1;
+    buf->pid = getpid();
+    buf->size = dlt_shm_round_size(size);
+    total = sizeof(DltShmRingHead) + buf->size;
 
-    // Create the segment.
-    if ((buf->shmid = shmget(key, size, IPC_CREAT | 0666)) < 0) {
-        dlt_log(LOG_WARNING,"SHM: shmget() failed");
-        return DLT_RETURN_ERROR; /* ERROR */
+    buf->memfd = memfd_create("dlt-ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (buf->memfd == -1)
+    {
+        dlt_vlog(LOG_WARNING, "SHM: memfd_create() failed: %s\n", strerror(errno));
+        return DLT_RETURN_ERROR;
     }
 
-    // get the size of shm
-    if (shmctl(buf->shmid,  IPC_STAT, &shm_buf))
+    if (ftruncate(buf->memfd, total) == -1)
     {
-        dlt_log(LOG_WARNING,"SHM: shmctl() failed");
-        return DLT_RETURN_ERROR; /* ERROR */
+        dlt_vlog(LOG_WARNING, "SHM: ftruncate() failed: %s\n", strerror(errno));
+        dlt_shm_free_client(buf);
+        return DLT_RETURN_ERROR;
     }
 
-    // Now we attach the segment to our data space.
-    if ((ptr = shmat(buf->shmid, NULL, 0)) == (unsigned char *) -1) {
-        dlt_log(LOG_WARNING,"SHM: shmat() failed");
-        return DLT_RETURN_ERROR; /* ERROR */
+    /* the daemon relies on the size of the mapping to never change */
+    if (fcntl(buf->memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) == -1)
+    {
+        dlt_vlog(LOG_WARNING, "SHM: sealing failed: %s\n", strerror(errno));
+        dlt_shm_free_client(buf);
+        return DLT_RETURN_ERROR;
     }
 
-    // Init semaphore
-    if( (buf->semid = semget(DLT_SHM_SEM,1,S_IRWXU|S_IRWXG|S_IRWXO|IPC_CREAT|IPC_EXCL)) == -1 ) {
-        if( (buf->semid = semget(DLT_SHM_SEM,1,S_IRWXU|S_IRWXG|S_IRWXO|IPC_EXCL)) == -1 ) {
-            dlt_log(LOG_WARNING,"SHM: semget() failed");
-            return DLT_RETURN_ERROR; /* ERROR */
-        }
+    ptr = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_SHARED, buf->memfd, 0);
+    if (ptr == MAP_FAILED)
+    {
+        dlt_vlog(LOG_WARNING, "SHM: mmap() failed: %s\n", strerror(errno));
+        dlt_shm_free_client(buf);
+        return DLT_RETURN_ERROR;
     }
-    if( semctl(buf->semid,0,SETVAL,(int)1) == -1 ) {
-        dlt_log(LOG_WARNING,"SHM: semctl() failed");
-        return DLT_RETURN_ERROR; /* ERROR */
+
+    buf->head = (DltShmRingHead *)ptr;
+    buf->data = ptr + sizeof(DltShmRingHead);
+
+    buf->eventfd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (buf->eventfd == -1)
+    {
+        dlt_vlog(LOG_WARNING, "SHM: eventfd() failed: %s\n", strerror(errno));
+        dlt_shm_free_client(buf);
+        return DLT_RETURN_ERROR;
     }
 
-    // init buffer
-    dlt_buffer_init_static_server(&(buf->buffer),ptr,shm_buf.shm_segsz);
+    buf->head->magic = DLT_SHM_RING_MAGIC;
+    buf->head->size = buf->size;
+    buf->head->flags = 0;
+    buf->head->dropped = 0;
+    buf->head->head = 0;
+    buf->head->tail = 0;
 
-    return DLT_RETURN_OK; /* OK */
+    return DLT_RETURN_OK;
 }
 
-DltReturnValue dlt_shm_init_client(DltShm *buf,int key) {
-    struct shmid_ds shm_buf;
+DltReturnValue dlt_shm_init_server(DltShm *buf, int max_size)
+{
+    struct stat st;
     unsigned char *ptr;
+    uint32_t size;
+    int seals;
 
-    // init parameters
-    buf->shmid = 0;
-    buf->semid = 0;
+    if ((buf == NULL) || (buf->memfd < 0) || (buf->eventfd < 0))
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
 
-    // Create the segment.
-    if ((buf->shmid = shmget(key, 0, 0666)) < 0) {
-        dlt_log(LOG_WARNING,"SHM: shmget() failed");
-        return DLT_RETURN_ERROR; /* ERROR */
+    /* never trust the application: size and seals come from the kernel */
+    seals = fcntl(buf->memfd, F_GET_SEALS);
+    if ((seals == -1) || !(seals & F_SEAL_SHRINK))
+    {
+        dlt_log(LOG_WARNING, "SHM: ring is not sealed against shrinking\n");
+        return DLT_RETURN_ERROR;
+    }
+
+    if (fstat(buf->memfd, &st) == -1)
+    {
+        dlt_vlog(LOG_WARNING, "SHM: fstat() failed: %s\n", strerror(errno));
+        return DLT_RETURN_ERROR;
+    }
+
+    if (st.st_size <= (off_t)sizeof(DltShmRingHead))
+    {
+        dlt_log(LOG_WARNING, "SHM: ring too small\n");
+        return DLT_RETURN_ERROR;
     }
 
-    // get the size of shm
-    if (shmctl(buf->shmid,  IPC_STAT, &shm_buf))
+    size = (uint32_t)(st.st_size - sizeof(DltShmRingHead));
+    if ((size < DLT_SHM_RING_MIN_SIZE) || (size > DLT_SHM_RING_MAX_SIZE) ||
+        (size & (size - 1)) || (size > (uint32_t)max_size))
     {
-        dlt_log(LOG_WARNING,"SHM: shmctl() failed");
-            return DLT_RETURN_ERROR; /* ERROR */
+        dlt_vlog(LOG_WARNING, "SHM: invalid ring size %u\n", size);
+        return DLT_RETURN_ERROR;
     }
 
-    // Now we attach the segment to our data space.
-    if ((ptr = shmat(buf->shmid, NULL, 0)) == (unsigned char *) -1) {
-        dlt_log(LOG_WARNING,"shmat() failed");
-        return DLT_RETURN_ERROR; /* ERROR */
+    ptr = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, buf->memfd, 0);
+    if (ptr == MAP_FAILED)
+    {
+        dlt_vlog(LOG_WARNING, "SHM: mmap() failed: %s\n", strerror(errno));
+        return DLT_RETURN_ERROR;
     }
 
-    // Init semaphore
-    if( (buf->semid = semget(DLT_SHM_SEM,0,0)) == -1 ) {
-            dlt_log(LOG_WARNING,"SHM: semget() failed");
-            return DLT_RETURN_ERROR; /* ERROR */
+    if ((((DltShmRingHead *)ptr)->magic != DLT_SHM_RING_MAGIC) ||
+        (((DltShmRingHead *)ptr)->size != size))
+    {
+        dlt_log(LOG_WARNING, "SHM: invalid ring header\n");
+        munmap(ptr, st.st_size);
+        return DLT_RETURN_ERROR;
     }
 
-    // init buffer
-    dlt_buffer_init_static_client(&(buf->buffer),ptr,shm_buf.shm_segsz);
+    buf->head = (DltShmRingHead *)ptr;
+    buf->data = ptr + sizeof(DltShmRingHead);
+    buf->size = size;
+    buf->current = 0;
+
+    /* the mapping keeps the memory alive */
+    close(buf->memfd);
+    buf->memfd = -1;
 
-    return DLT_RETURN_OK; /* OK */
+    return DLT_RETURN_OK;
 }
 
-void dlt_shm_info(DltShm *buf)
+void dlt_shm_notify(DltShm *buf)
 {
-    dlt_buffer_info(&(buf->buffer));
+    uint64_t one = 1;
+
+    if ((buf == NULL) || (buf->eventfd < 0))
+    {
+        return;
+    }
+
+    /* EAGAIN means the counter is already non zero, nothing to do */
+    if ((write(buf->eventfd, &one, sizeof(one)) == -1) && (errno != EAGAIN))
+    {
+        dlt_vlog(LOG_WARNING, "SHM: doorbell failed: %s\n", strerror(errno));
+    }
 }
 
-void dlt_shm_status(DltShm *buf)
+void dlt_shm_ack(DltShm *buf)
 {
-    dlt_buffer_status(&(buf->buffer));
+    uint64_t value;
+
+    if ((buf == NULL) || (buf->eventfd < 0))
+    {
+        return;
+    }
+
+    if (read(buf->eventfd, &value, sizeof(value)) == -1)
+    {
+        /* nothing pending */
+        return;
+    }
 }
 
-int dlt_shm_get_total_size(DltShm *buf)
+DltReturnValue dlt_shm_push(DltShm *buf,const unsigned char *data1,unsigned int size1,const unsigned char *data2,unsigned int size2,const unsigned char *data3,unsigned int size3)
 {
-    return dlt_buffer_get_total_size(&(buf->buffer));
+    DltShmRingHead *ring;
+    uint32_t head, tail, pos, pad, len, rec;
+    unsigned char *ptr;
+
+    /* check if ring available */
+    if ((buf == NULL) || (buf->head == NULL))
+    {
+        return DLT_RETURN_ERROR;
+    }
+
+    ring = buf->head;
+    len = size1 + size2 + size3;
+    rec = DLT_SHM_RING_ALIGN_SIZE(sizeof(uint32_t) + len);
+
+    if (rec > buf->size)
+    {
+        return DLT_RETURN_ERROR;
+    }
+
+    /* head is only written by us, tail is published by the daemon */
+    head = ring->head;
+    tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    pos = head & (buf->size - 1);
+
+    /* records never wrap, skip the end of the ring if needed */
+    pad = ((buf->size - pos) < rec) ? (buf->size - pos) : 0;
+
+    if ((head - tail) + pad + rec > buf->size)
+    {
+        __atomic_add_fetch(&ring->dropped, 1, __ATOMIC_RELAXED);
+        return DLT_RETURN_BUFFER_FULL;
+    }
+
+    if (pad)
+    {
+        *(uint32_t *)(buf->data + pos) = DLT_SHM_RING_PAD;
+        pos = 0;
+    }
+
+    ptr = buf->data + pos;
+    *(uint32_t *)ptr = len;
+    ptr += sizeof(uint32_t);
+
+    if (size1)
+    {
+        memcpy(ptr, data1, size1);
+        ptr += size1;
+    }
+    if (size2)
+    {
+        memcpy(ptr, data2, size2);
+        ptr += size2;
+    }
+    if (size3)
+    {
+        memcpy(ptr, data3, size3);
+    }
+
+    /* Publish the record. Together with the daemon storing tail before it
+     * checks head again, this ensures that either the daemon sees the new
+     * record or we see the ring was drained and ring the doorbell. */
+    __atomic_store_n(&ring->head, head + pad + rec, __ATOMIC_SEQ_CST);
+
+    if (__atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST) == head)
+    {
+        dlt_shm_notify(buf);
+    }
+
+    return DLT_RETURN_OK;
 }
 
-int dlt_shm_get_used_size(DltShm *buf)
+int dlt_shm_copy(DltShm *buf, unsigned char *data, int max_size)
 {
-    int ret;
+    DltShmRingHead *ring;
+    uint32_t head, tail, used, pos, len, rec;
 
-    /* check if buffer available */
-    if(!buf->buffer.mem)
+    /* check if ring available */
+    if ((buf == NULL) || (buf->head == NULL) || (data == NULL) || (max_size < 0))
+    {
         return -1;
+    }
 
-    DLT_SHM_SEM_GET(buf->semid);
-    ret =  dlt_buffer_get_used_size(&(buf->buffer));
-    DLT_SHM_SEM_FREE(buf->semid);
+    ring = buf->head;
 
-    return ret;
+    while (1)
+    {
+        tail = ring->tail;
+        head = __atomic_load_n(&ring->head, __ATOMIC_SEQ_CST);
+
+        if (head == tail)
+        {
+            return 0;
+        }
+
+        used = head - tail;
+        pos = tail & (buf->size - 1);
+
+        if ((used > buf->size) || (pos & (DLT_SHM_RING_ALIGN - 1)))
+        {
+            dlt_log(LOG_WARNING, "SHM: ring corrupted\n");
+            return -1;
+        }
+
+        /* read the length only once, the application may modify it anytime */
+        len = __atomic_load_n((uint32_t *)(buf->data + pos), __ATOMIC_RELAXED);
+
+        if (len == DLT_SHM_RING_PAD)
+        {
+            if (buf->size - pos > used)
+            {
+                dlt_log(LOG_WARNING, "SHM: ring corrupted\n");
+                return -1;
+            }
+
+            __atomic_store_n(&ring->tail, tail + (buf->size - pos), __ATOMIC_SEQ_CST);
+            continue;
+        }
+
+        if (len > buf->size)
+        {
+            dlt_log(LOG_WARNING, "SHM: ring corrupted\n");
+            return -1;
+        }
+
+        rec = DLT_SHM_RING_ALIGN_SIZE(sizeof(uint32_t) + len);
+
+        if ((rec > buf->size - pos) || (rec > used))
+        {
+            dlt_log(LOG_WARNING, "SHM: ring corrupted\n");
+            return -1;
+        }
+
+        buf->current = rec;
+        memcpy(data, buf->data + pos + sizeof(uint32_t), (len < (uint32_t)max_size) ? len : (uint32_t)max_size);
+
+        return (int)len;
+    }
 }
 
-int dlt_shm_get_message_count(DltShm *buf)
+DltReturnValue dlt_shm_remove(DltShm *buf)
 {
-    return dlt_buffer_get_message_count(&(buf->buffer));
+    /* check if ring available */
+    if ((buf == NULL) || (buf->head == NULL) || (buf->current == 0))
+    {
+        return DLT_RETURN_ERROR;
+    }
+
+    __atomic_store_n(&buf->head->tail, buf->head->tail + buf->current, __ATOMIC_SEQ_CST);
+    buf->current = 0;
+
+    return DLT_RETURN_OK;
 }
 
-int dlt_shm_push(DltShm *buf,const unsigned char *data1,unsigned int size1,const unsigned char *data2,unsigned int size2,const unsigned char *data3,unsigned int size3)
+DltReturnValue dlt_shm_reset(DltShm *buf)
 {
-    int ret;
+    /* check if ring available */
+    if ((buf == NULL) || (buf->head == NULL))
+    {
+        return DLT_RETURN_ERROR;
+    }
 
-    /* check if buffer available */
-    if(!buf->buffer.mem)
-        return -1;
+    __atomic_store_n(&buf->head->tail,
+                     __atomic_load_n(&buf->head->head, __ATOMIC_SEQ_CST),
+                     __ATOMIC_SEQ_CST);
+    buf->current = 0;
 
-    DLT_SHM_SEM_GET(buf->semid);
-    ret =  dlt_buffer_push3(&(buf->buffer),data1,size1,data2,size2,data3,size3);
-    DLT_SHM_SEM_FREE(buf->semid);
+    return DLT_RETURN_OK;
+}
 
-    return ret;
+void dlt_shm_close(DltShm *buf)
+{
+    if ((buf == NULL) || (buf->head == NULL))
+    {
+        return;
+    }
+
+    __atomic_or_fetch(&buf->head->flags, DLT_SHM_RING_CLOSED, __ATOMIC_SEQ_CST);
+    dlt_shm_notify(buf);
 }
 
-int dlt_shm_pull(DltShm *buf,unsigned char *data, int max_size)
+int dlt_shm_is_closed(DltShm *buf)
 {
-    int ret;
+    if ((buf == NULL) || (buf->head == NULL))
+    {
+        return 1;
+    }
 
-    /* check if buffer available */
-    if(!buf->buffer.mem)
-        return -1;
+    return (__atomic_load_n(&buf->head->flags, __ATOMIC_SEQ_CST) & DLT_SHM_RING_CLOSED) ? 1 : 0;
+}
 
-    DLT_SHM_SEM_GET(buf->semid);
-    ret =  dlt_buffer_pull(&(buf->buffer),data,max_size);
-    DLT_SHM_SEM_FREE(buf->semid);
+void dlt_shm_info(DltShm *buf)
+{
+    if ((buf == NULL) || (buf->head == NULL))
+    {
+        return;
+    }
 
-    return ret;
+    dlt_vlog(LOG_DEBUG, "SHM: ring %p size %u pid %d\n",
+             (void *)buf->head, buf->size, (int)buf->pid);
 }
 
-int dlt_shm_copy(DltShm *buf,unsigned char *data, int max_size)
+void dlt_shm_status(DltShm *buf)
 {
-    int ret;
+    if ((buf == NULL) || (buf->head == NULL))
+    {
+        return;
+    }
 
-    /* check if buffer available */
-    if(!buf->buffer.mem)
-        return -1;
+    dlt_vlog(LOG_DEBUG, "SHM: head %u tail %u used %d dropped %d\n",
+             buf->head->head, buf->head->tail,
+             dlt_shm_get_used_size(buf), dlt_shm_get_dropped_count(buf));
+}
 
-    DLT_SHM_SEM_GET(buf->semid);
-    ret =  dlt_buffer_copy(&(buf->buffer),data,max_size);
-    DLT_SHM_SEM_FREE(buf->semid);
+int dlt_shm_get_total_size(DltShm *buf)
+{
+    if ((buf == NULL) || (buf->head == NULL))
+    {
+        return -1;
+    }
 
-    return ret;
+    return (int)buf->size;
 }
 
-int dlt_shm_remove(DltShm *buf)
+int dlt_shm_get_used_size(DltShm *buf)
 {
-    int ret;
+    uint32_t head, tail;
 
-    /* check if buffer available */
-    if(!buf->buffer.mem)
+    /* check if ring available */
+    if ((buf == NULL) || (buf->head == NULL))
+    {
         return -1;
+    }
 
-    DLT_SHM_SEM_GET(buf->semid);
-    ret =  dlt_buffer_remove(&(buf->buffer));
-    DLT_SHM_SEM_FREE(buf->semid);
+    tail = __atomic_load_n(&buf->head->tail, __ATOMIC_ACQUIRE);
+    head = __atomic_load_n(&buf->head->head, __ATOMIC_ACQUIRE);
 
-    return ret;
+    return (int)(head - tail);
 }
 
-DltReturnValue dlt_shm_free_server(DltShm *buf) {
+int dlt_shm_get_dropped_count(DltShm *buf)
+{
+    if ((buf == NULL) || (buf->head == NULL))
+    {
+        return -1;
+    }
+
+    return (int)__atomic_load_n(&buf->head->dropped, __ATOMIC_RELAXED);
+}
 
-    if(shmdt(buf->buffer.shm)) {
-        dlt_log(LOG_WARNING,"SHM: shmdt() failed");
-        return DLT_RETURN_ERROR; /* ERROR */
+DltReturnValue dlt_shm_free_client(DltShm *buf)
+{
+    if (buf == NULL)
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
     }
 
-    if(shmctl(buf->shmid,IPC_RMID,NULL) == -1) {
-        dlt_log(LOG_WARNING,"SHM: shmdt() failed");
-        return DLT_RETURN_ERROR; /* ERROR */
+    if (buf->head != NULL)
+    {
+        if (munmap(buf->head, sizeof(DltShmRingHead) + buf->size) == -1)
+        {
+            dlt_log(LOG_WARNING, "SHM: munmap() failed\n");
+        }
     }
 
-    if(semctl(buf->semid,0,IPC_RMID,(int)0) == -1) {
-        dlt_log(LOG_WARNING,"SHM: shmdt() failed");
-        return DLT_RETURN_ERROR; /* ERROR */
+    if (buf->memfd >= 0)
+    {
+        close(buf->memfd);
     }
 
-    // Reset parameters
-    buf->shmid = 0;
-    buf->semid = 0;
+    if (buf->eventfd >= 0)
+    {
+        close(buf->eventfd);
+    }
 
-    return dlt_buffer_free_static(&(buf->buffer));
+    buf->head = NULL;
+    buf->data = NULL;
+    buf->memfd = -1;
+    buf->eventfd = -1;
+    buf->size = 0;
 
+    return DLT_RETURN_OK;
 }
 
-DltReturnValue dlt_shm_free_client(DltShm *buf) {
+DltReturnValue dlt_shm_free_server(DltShm *buf)
+{
+    if (buf == NULL)
+    {
+        return DLT_RETURN_WRONG_PARAMETER;
+    }
 
-    if(shmdt(buf->buffer.shm)) {
-        dlt_log(LOG_WARNING,"SHM: shmdt() failed");
-        return DLT_RETURN_ERROR; /* ERROR */
+    if (buf->head != NULL)
+    {
+        if (munmap(buf->head, sizeof(DltShmRingHead) + buf->size) == -1)
+        {
+            dlt_log(LOG_WARNING, "SHM: munmap() failed\n");
+        }
+    }
+
+    if (buf->memfd >= 0)
+    {
+        close(buf->memfd);
     }
 
-    // Reset parameters
-    buf->shmid = 0;
-    buf->semid = 0;
+    buf->head = NULL;
+    buf->data = NULL;
+    buf->memfd = -1;
+    buf->size = 0;
+    buf->current = 0;
 
-    return dlt_buffer_free_static(&(buf->buffer));
+    return DLT_RETURN_OK;
 }
@@ -71,8 +71,12 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <string.h>
 
 #include <sys/uio.h> /* writev() */
+#ifdef DLT_SHM_ENABLE
+#include <sys/socket.h> /* sendmsg() */
+#endif
 
 #include "dlt_user_shared.h"
 #include "dlt_user_shared_cfg.h"
@@ -107,6 +111,33 @@ int dlt_user_check_userheader(DltUserHeader *userheader)
              (userheader->pattern[3] == 1));
 }
 
+int dlt_user_find_userheader(const char *buf, int size)
+{
+    static const char marker[DLT_ID_SIZE] = { 'D', 'U', 'H', 1 };
+    const char *ptr = buf;
+    const char *end;
+
+    if ((buf == NULL) || (size < DLT_ID_SIZE))
+    {
+        return -1;
+    }
+
+    /* last position a complete marker can start at */
+    end = buf + size - DLT_ID_SIZE;
+
+    /* memchr skips quickly over data not starting a marker */
+    while ((ptr <= end) && ((ptr = memchr(ptr, marker[0], end - ptr + 1)) != NULL))
+    {
+        if (memcmp(ptr, marker, DLT_ID_SIZE) == 0)
+        {
+            return ptr - buf;
+        }
+        ptr++;
+    }
+
+    return -1;
+}
+
 DltReturnValue dlt_user_log_out2(int handle, void *ptr1, size_t len1, void* ptr2, size_t len2)
 {
     struct iovec iov[2];
@@ -182,3 +213,108 @@ DltReturnValue dlt_user_log_out3(int handle, void *ptr1, size_t len1, void* ptr2
 
     return DLT_RETURN_OK;
 }
+
+DltReturnValue dlt_user_log_outv(int handle, const struct iovec *iov, int iovcnt)
+{
+    ssize_t bytes_written;
+    size_t len = 0;
+    int i;
+
+    if (handle<=0)
+    {
+        /* Invalid handle */
+        return DLT_RETURN_ERROR;
+    }
+
+    for (i = 0; i < iovcnt; i++)
+    {
+        len += iov[i].iov_len;
+    }
+
+    bytes_written = writev(handle, iov, iovcnt);
+
+    if (bytes_written != (ssize_t)len)
+    {
+        switch(errno)
+        {
+            case EBADF:
+            {
+                return DLT_RETURN_PIPE_ERROR; /* EBADF - handle not open */
+            }
+            case EPIPE:
+            {
+                return DLT_RETURN_PIPE_ERROR; /* EPIPE - pipe error */
+            }
+            case EAGAIN:
+            {
+                return DLT_RETURN_PIPE_FULL; /* EAGAIN - data could not be written */
+            }
+            default:
+            {
+                break;
+            }
+        }
+        return DLT_RETURN_ERROR;
+    }
+
+    return DLT_RETURN_OK;
+}
+
+#ifdef DLT_SHM_ENABLE
+DltReturnValue dlt_user_log_out2_fds(int handle, void *ptr1, size_t len1, void* ptr2, size_t len2, int *fds, int nfds)
+{
+    struct iovec iov[2];
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+    char control[CMSG_SPACE(sizeof(int) * 2)];
+    ssize_t bytes_written;
+
+    if ((handle <= 0) || (fds == NULL) || (nfds <= 0) || (nfds > 2))
+    {
+        return DLT_RETURN_ERROR;
+    }
+
+    iov[0].iov_base = ptr1;
+    iov[0].iov_len = len1;
+    iov[1].iov_base = ptr2;
+    iov[1].iov_len = len2;
+
+    memset(&msg, 0, sizeof(msg));
+    memset(control, 0, sizeof(control));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+    msg.msg_control = control;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * nfds);
+
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * nfds);
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * nfds);
+
+    bytes_written = sendmsg(handle, &msg, MSG_NOSIGNAL);
+
+    if (bytes_written != (ssize_t)(len1 + len2))
+    {
+        switch(errno)
+        {
+            case EBADF:
+            case EPIPE:
+            {
+                return DLT_RETURN_PIPE_ERROR; /* handle not open or pipe error */
+            }
+            case EAGAIN:
+            {
+                return DLT_RETURN_PIPE_FULL; /* EAGAIN - data could not be written */
+            }
+            default:
+            {
+                break;
+            }
+        }
+        return DLT_RETURN_ERROR;
+    }
+
+    return DLT_RETURN_OK;
+}
+#endif
@@ -72,8 +72,10 @@
 
 #include "dlt_types.h"
 #include "dlt_user.h"
+#include "dlt_user_shared_cfg.h"
 
 #include <sys/types.h>
+#include <sys/uio.h>
 
 /**
  * This is the header of each message to be exchanged between application and daemon.
@@ -137,6 +139,27 @@ typedef struct
     int32_t log_level_pos;          /**< offset in management structure on user-application side */
 } PACKED DltUserControlMsgLogLevel;
 
+/**
+ * Entry of the log level table the daemon publishes to an application.
+ */
+typedef struct
+{
+    int8_t log_level;              /**< log level */
+    int8_t trace_status;           /**< trace status */
+} DltUserLogLevelEntry;
+
+/**
+ * Log level table the daemon creates next to the FIFO of an application.
+ * Only the daemon writes it, the application maps it read-only.
+ * The entries are indexed by the log_level_pos of the contexts.
+ */
+typedef struct
+{
+    uint32_t generation;           /**< incremented by the daemon after entries were changed */
+    uint32_t reserved;
+    DltUserLogLevelEntry entries[DLT_USER_LOG_LEVEL_TABLE_ENTRIES];
+} DltUserLogLevelTable;
+
 /**
  * This is the internal message content to exchange control msg injection information between application and daemon.
  */
@@ -183,6 +206,16 @@ typedef struct
     char apid[4];                        /**< application which lost messages */
 } PACKED DltUserControlMsgBufferOverflow;
 
+/**
+ * This is the internal message content to register a shared memory ring of an application thread.
+ * The memfd and the eventfd of the ring are passed along as ancillary data.
+ */
+typedef struct
+{
+    pid_t pid;                          /**< process id of user application */
+    uint32_t size;                      /**< size of the ring data area */
+} PACKED DltUserControlMsgShmRegister;
+
 /**************************************************************************************************
 * The folowing functions are used shared between the user lib and the daemon implementation
 **************************************************************************************************/
@@ -202,6 +235,14 @@ DltReturnValue dlt_user_set_userheader(DltUserHeader *userheader, uint32_t mtype
  */
 int dlt_user_check_userheader(DltUserHeader *userheader);
 
+/**
+ * Search the next user header marker in a buffer
+ * @param buf pointer to the buffer
+ * @param size number of bytes in the buffer
+ * @return offset of the marker, -1 if the buffer does not contain a complete marker
+ */
+int dlt_user_find_userheader(const char *buf, int size);
+
 /**
  * Atomic write to file descriptor, using vector of 2 elements
  * @param handle file descriptor
@@ -226,4 +267,28 @@ DltReturnValue dlt_user_log_out2(int handle, void *ptr1, size_t len1, void* ptr2
  */
 DltReturnValue dlt_user_log_out3(int handle, void *ptr1, size_t len1, void* ptr2, size_t len2, void *ptr3, size_t len3);
 
+/**
+ * Atomic write to file descriptor, using a vector of any number of elements
+ * @param handle file descriptor
+ * @param iov segments of data to be written
+ * @param iovcnt number of segments
+ * @return Value from DltReturnValue enum
+ */
+DltReturnValue dlt_user_log_outv(int handle, const struct iovec *iov, int iovcnt);
+
+#ifdef DLT_SHM_ENABLE
+/**
+ * Atomic write to a UNIX socket, using vector of 2 elements and passing file descriptors
+ * @param handle socket file descriptor
+ * @param ptr1 generic pointer to first segment of data to be written
+ * @param len1 length of first segment of data to be written
+ * @param ptr2 generic pointer to second segment of data to be written
+ * @param len2 length of second segment of data to be written
+ * @param fds file descriptors to be passed to the peer
+ * @param nfds number of file descriptors
+ * @return Value from DltReturnValue enum
+ */
+DltReturnValue dlt_user_log_out2_fds(int handle, void *ptr1, size_t len1, void* ptr2, size_t len2, int *fds, int nfds);
+#endif
+
 #endif /* DLT_USER_SHARED_H */
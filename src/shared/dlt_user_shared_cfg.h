@@ -74,6 +74,11 @@
 /* Changable */
 /*************/
 
+/* Number of contexts of an application, whose log level and trace status
+   the daemon changes in place in the log level table of the application.
+   Levels of further contexts are sent as messages. */
+#define DLT_USER_LOG_LEVEL_TABLE_ENTRIES 1024
+
 /************************/
 /* Don't change please! */
 /************************/
@@ -88,12 +93,15 @@
 #define DLT_USER_MESSAGE_INJECTION 7
 #define DLT_USER_MESSAGE_OVERFLOW 8
 #define DLT_USER_MESSAGE_APP_LL_TS 9
-#define DLT_USER_MESSAGE_LOG_SHM 10
+#define DLT_USER_MESSAGE_LOG_SHM 10 /* registers a shared memory ring, descriptors passed along */
 #define DLT_USER_MESSAGE_LOG_MODE 11
 #define DLT_USER_MESSAGE_LOG_STATE 12
 #define DLT_USER_MESSAGE_MARKER 13
 #define DLT_USER_MESSAGE_NOT_SUPPORTED 16
 
+/* Suffix of the log level table the daemon creates next to the FIFO of an application */
+#define DLT_USER_LOG_LEVEL_TABLE_SUFFIX ".ll"
+
 /* Internal defined values */
 
 /* must be different from DltLogLevelType */
@@ -26,13 +26,18 @@
 */
 
 #include <stdio.h>
+#include <vector>
 #include <gtest/gtest.h>
 #include <limits.h>
 #include <syslog.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 extern "C"
 {
 #include "dlt-daemon.h"
+#include "dlt_client.h"
 #include "dlt-daemon_cfg.h"
 #include "dlt_user_cfg.h"
 #include "dlt_version.h"
@@ -1280,6 +1285,166 @@ TEST(t_dlt_buffer_status, nullpointer)
 
 
 
+/* Begin Method:dlt_client::dlt_client_loop */
+static int client_loop_messages[2];
+static int client_loop_payload;
+
+static int client_loop_message(DltClientConnection *con, DltMessage *message, void *data)
+{
+    client_loop_messages[(intptr_t) data]++;
+    client_loop_payload += message->datasize;
+    (void) con;
+    return 0;
+}
+
+static int client_loop_wait(DltClientLoop *loop, DltClientConnection *con, DltClientLoopState state)
+{
+    for (int i = 0; (i < 100) && (con->state != state); i++)
+    {
+        dlt_client_loop_dispatch(loop, 10, 0);
+    }
+
+    return con->state == state;
+}
+
+TEST(t_dlt_client_loop, normal)
+{
+    DltFile file;
+    // Get PWD so file can be used
+    char pwd[100];
+    char  openfile[114];
+
+    // ignore returned value from getcwd
+    if (getcwd(pwd, 100) == NULL) {}
+
+    sprintf(openfile, "%s/testfile.dlt", pwd);
+    /*---------------------------------------*/
+
+    const char *path = "/tmp/gtest_dlt_client_loop.sock";
+    static uint8_t buffer[64 * 1024];
+    uint32_t length = 0;
+    int payload = 0;
+    int headersize;
+    struct sockaddr_un addr;
+    int server;
+    int peer[2];
+    DltClientLoop loop;
+    DltClientConnection con[2];
+
+    /* all messages without storage header, as sent by the daemon */
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_init(&file, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_open(&file, openfile, 0));
+    while (dlt_file_read(&file,0)>=0){}
+    for(int i=0;i<file.counter;i++)
+    {
+        EXPECT_LE(DLT_RETURN_OK, dlt_file_message(&file, i, 0));
+        headersize = file.msg.headersize - sizeof(DltStorageHeader);
+        memcpy(buffer + length, file.msg.headerbuffer + sizeof(DltStorageHeader), headersize);
+        memcpy(buffer + length + headersize, file.msg.databuffer, file.msg.datasize);
+        length += headersize + file.msg.datasize;
+        payload += file.msg.datasize;
+    }
+
+    unlink(path);
+    server = socket(AF_UNIX, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    ASSERT_EQ(0, bind(server, (struct sockaddr *) &addr, sizeof(addr)));
+    ASSERT_EQ(0, listen(server, 4));
+
+    EXPECT_EQ(DLT_RETURN_OK, dlt_client_loop_init(&loop, 0));
+    EXPECT_EQ(DLT_RETURN_OK, dlt_client_loop_set_backoff(&loop, 10, 20));
+    memset(con, 0, sizeof(con));
+    memset(client_loop_messages, 0, sizeof(client_loop_messages));
+    client_loop_payload = 0;
+
+    for (int i = 0; i < 2; i++)
+    {
+        EXPECT_EQ(DLT_RETURN_OK, dlt_client_init(&con[i].client, 0));
+        con[i].client.mode = DLT_CLIENT_MODE_UNIX;
+        EXPECT_EQ(DLT_RETURN_OK, dlt_client_set_socket_path(&con[i].client, (char *) path));
+        con[i].message_callback = client_loop_message;
+        con[i].data = (void *) (intptr_t) i;
+        EXPECT_EQ(DLT_RETURN_OK, dlt_client_loop_add(&loop, &con[i], 0));
+    }
+    EXPECT_EQ(2, loop.num_connections);
+
+    EXPECT_TRUE(client_loop_wait(&loop, &con[0], DLT_CLIENT_LOOP_CONNECTED));
+    EXPECT_TRUE(client_loop_wait(&loop, &con[1], DLT_CLIENT_LOOP_CONNECTED));
+    peer[0] = accept(server, NULL, NULL);
+    peer[1] = accept(server, NULL, NULL);
+
+    /* messages split across several reads */
+    EXPECT_EQ((ssize_t) 100, write(peer[0], buffer, 100));
+    EXPECT_EQ((ssize_t) (length - 100), write(peer[0], buffer + 100, length - 100));
+    EXPECT_EQ((ssize_t) length, write(peer[1], buffer, length));
+    for (int i = 0; (i < 100) && (client_loop_messages[0] + client_loop_messages[1] < 2 * file.counter); i++)
+    {
+        dlt_client_loop_dispatch(&loop, 10, 0);
+    }
+    EXPECT_EQ(file.counter, client_loop_messages[0]);
+    EXPECT_EQ(file.counter, client_loop_messages[1]);
+    EXPECT_EQ(2 * payload, client_loop_payload);
+
+    /* control messages are queued and sent by the loop */
+    EXPECT_EQ(DLT_RETURN_OK, dlt_client_send_log_level(&con[0].client, (char *) "APP", (char *) "CON", DLT_LOG_INFO));
+    dlt_client_loop_dispatch(&loop, 10, 0);
+    EXPECT_LT(0, read(peer[0], buffer, sizeof(buffer)));
+
+    /* lost connection is established again */
+    close(peer[0]);
+    EXPECT_TRUE(client_loop_wait(&loop, &con[0], DLT_CLIENT_LOOP_DISCONNECTED));
+    EXPECT_EQ(DLT_RETURN_ERROR, dlt_client_send_log_level(&con[0].client, (char *) "APP", (char *) "CON", DLT_LOG_INFO));
+    EXPECT_TRUE(client_loop_wait(&loop, &con[0], DLT_CLIENT_LOOP_CONNECTED));
+    peer[0] = accept(server, NULL, NULL);
+    EXPECT_EQ(DLT_CLIENT_LOOP_CONNECTED, con[1].state);
+
+    EXPECT_EQ(DLT_RETURN_OK, dlt_client_loop_remove(&loop, &con[1], 0));
+    EXPECT_EQ(1, loop.num_connections);
+    EXPECT_EQ(-1, con[1].client.sock);
+    EXPECT_EQ(DLT_RETURN_OK, dlt_client_loop_free(&loop, 0));
+    EXPECT_EQ(-1, con[0].client.sock);
+
+    for (int i = 0; i < 2; i++)
+    {
+        EXPECT_EQ(DLT_RETURN_OK, dlt_client_cleanup(&con[i].client, 0));
+        EXPECT_TRUE(con[i].client.priv == NULL);
+        free(con[i].client.socketPath);
+        close(peer[i]);
+    }
+    close(server);
+    unlink(path);
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_close(&file, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_free(&file, 0));
+}
+TEST(t_dlt_client_loop, nullpointer)
+{
+    DltClientLoop loop;
+    DltClientConnection con;
+
+    // NULL-Pointer, expect -1
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_client_loop_init(NULL, 0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_client_loop_free(NULL, 0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_client_loop_add(NULL, &con, 0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_client_loop_remove(NULL, &con, 0));
+    EXPECT_GE(-1, dlt_client_loop_dispatch(NULL, 0, 0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_client_loop_run(NULL, 0));
+
+    EXPECT_EQ(DLT_RETURN_OK, dlt_client_loop_init(&loop, 0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_client_loop_add(&loop, NULL, 0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_client_loop_set_backoff(&loop, 20, 10));
+
+    /* stop request before running returns immediately */
+    dlt_client_loop_stop(&loop);
+    EXPECT_EQ(DLT_RETURN_OK, dlt_client_loop_run(&loop, 0));
+    EXPECT_EQ(DLT_RETURN_OK, dlt_client_loop_free(&loop, 0));
+}
+/* End Method:dlt_client::dlt_client_loop */
+
+
+
+
 /*##############################################################################################################################*/
 /*##############################################################################################################################*/
 /*##############################################################################################################################*/
@@ -1433,6 +1598,364 @@ TEST(t_dlt_file_open, nullpointer)
 
 
 
+/* Begin Method: dlt_common::dlt_file_index_save, dlt_file_index_load */
+TEST(t_dlt_file_index, save_load)
+{
+    DltFile file;
+    DltFile loaded;
+    DltFilter filter;
+    /* Get PWD so file can be used*/
+    char pwd[100];
+    char  openfile[114];
+    char  indexfile[130];
+
+    // ignore returned value from getcwd
+    if (getcwd(pwd, 100) == NULL) {}
+
+    sprintf(openfile, "%s/testfile.dlt", pwd);
+    sprintf(indexfile, "%s/testfile.dlt.gtest.idx", pwd);
+    unlink(indexfile);
+    /*---------------------------------------*/
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_init(&file, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_open(&file, openfile, 0));
+    while (dlt_file_read(&file,0)>=0){}
+    EXPECT_LT(0, file.counter);
+    EXPECT_EQ(0, dlt_file_index_position(&file, 0));
+    EXPECT_GT(0, dlt_file_index_position(&file, file.counter));
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_init(&loaded, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_open(&loaded, openfile, 0));
+    // no index file yet
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_file_index_load(&loaded, indexfile, 0));
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_index_save(&file, indexfile, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_index_load(&loaded, indexfile, 0));
+    EXPECT_EQ(file.counter, loaded.counter);
+    EXPECT_EQ(file.counter_total, loaded.counter_total);
+    EXPECT_EQ(file.file_position, loaded.file_position);
+    for(int i=0;i<file.counter;i++)
+    {
+        EXPECT_EQ(dlt_file_index_position(&file, i), dlt_file_index_position(&loaded, i));
+        EXPECT_LE(DLT_RETURN_OK, dlt_file_message(&file, i, 0));
+        EXPECT_LE(DLT_RETURN_OK, dlt_file_message(&loaded, i, 0));
+        EXPECT_EQ(file.msg.headersize, loaded.msg.headersize);
+        EXPECT_EQ(file.msg.datasize, loaded.msg.datasize);
+        EXPECT_EQ(0, memcmp(file.msg.headerbuffer, loaded.msg.headerbuffer, file.msg.headersize));
+        EXPECT_EQ(0, memcmp(file.msg.databuffer, loaded.msg.databuffer, file.msg.datasize));
+    }
+    // all messages were read, nothing left
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_file_read(&loaded, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_free(&loaded, 0));
+
+    // index was created without filters
+    EXPECT_LE(DLT_RETURN_OK, dlt_filter_init(&filter, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_filter_add(&filter, "DLTD", "", 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_init(&loaded, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_set_filter(&loaded, &filter, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_open(&loaded, openfile, 0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_file_index_load(&loaded, indexfile, 0));
+    EXPECT_EQ(0, loaded.counter);
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_free(&loaded, 0));
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_free(&file, 0));
+    unlink(indexfile);
+}
+TEST(t_dlt_file_index, nullpointer)
+{
+    DltFile file;
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_init(&file, 0));
+
+    // NULL-Pointer, expected -1
+    EXPECT_GT(0, dlt_file_index_position(NULL, 0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_file_index_save(NULL, "index", 0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_file_index_save(&file, NULL, 0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_file_index_load(NULL, "index", 0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_file_index_load(&file, NULL, 0));
+    // no file opened
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_file_index_save(&file, "index", 0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_file_index_load(&file, "index", 0));
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_free(&file, 0));
+}
+/* End Method: dlt_common::dlt_file_index_save, dlt_file_index_load */
+
+
+
+
+/* Begin Method: dlt_common::dlt_file_read_parallel */
+TEST(t_dlt_file_read_parallel, normal)
+{
+    DltFile file;
+    DltFile parallel;
+    DltFilter filter;
+    /* Get PWD so file can be used*/
+    char pwd[100];
+    char  openfile[114];
+    char  bigfile[130];
+    FILE *in;
+    FILE *out;
+    char buffer[8192];
+    size_t size;
+    /* message with a payload full of storage header patterns */
+    uint8_t fake[16 + 4 + 6000];
+
+    // ignore returned value from getcwd
+    if (getcwd(pwd, 100) == NULL) {}
+
+    sprintf(openfile, "%s/testfile.dlt", pwd);
+    sprintf(bigfile, "%s/testfile.dlt.gtest.big", pwd);
+    /*---------------------------------------*/
+
+    memset(fake, 0, sizeof(fake));
+    memcpy(fake, "DLT\x01", 4);
+    memcpy(fake + 12, "ECU1", 4);
+    fake[16] = DLT_HTYP_PROTOCOL_VERSION1;
+    fake[18] = (4 + 6000) >> 8;
+    fake[19] = (4 + 6000) & 0xff;
+    for (int i = 20; i < (int)sizeof(fake); i += 4)
+    {
+        memcpy(fake + i, "DLT\x01", 4);
+    }
+
+    in = fopen(openfile, "rb");
+    ASSERT_TRUE(in != NULL);
+    size = fread(buffer, 1, sizeof(buffer), in);
+    fclose(in);
+    out = fopen(bigfile, "wb");
+    ASSERT_TRUE(out != NULL);
+    // large enough to be split in chunks for two threads, half of the chunks start in a fake message
+    for (int i = 0; i < 900; i++)
+    {
+        EXPECT_EQ(size, fwrite(buffer, 1, size, out));
+        EXPECT_EQ(sizeof(fake), fwrite(fake, 1, sizeof(fake), out));
+    }
+    fclose(out);
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_filter_init(&filter, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_filter_add(&filter, "DLTD", "", 0));
+
+    for (int filtered = 0; filtered <= 1; filtered++)
+    {
+        EXPECT_LE(DLT_RETURN_OK, dlt_file_init(&file, 0));
+        EXPECT_LE(DLT_RETURN_OK, dlt_file_init(&parallel, 0));
+        if (filtered)
+        {
+            EXPECT_LE(DLT_RETURN_OK, dlt_file_set_filter(&file, &filter, 0));
+            EXPECT_LE(DLT_RETURN_OK, dlt_file_set_filter(&parallel, &filter, 0));
+        }
+        EXPECT_LE(DLT_RETURN_OK, dlt_file_open(&file, bigfile, 0));
+        EXPECT_LE(DLT_RETURN_OK, dlt_file_open(&parallel, bigfile, 0));
+
+        while (dlt_file_read(&file,0)>=0){}
+        EXPECT_LE(DLT_RETURN_OK, dlt_file_read_parallel(&parallel, 2, 0));
+
+        EXPECT_EQ(900 * 106, file.counter_total);
+        EXPECT_EQ(file.counter, parallel.counter);
+        EXPECT_EQ(file.counter_total, parallel.counter_total);
+        EXPECT_EQ(file.file_position, parallel.file_position);
+        for(int i=0;i<file.counter;i++)
+        {
+            ASSERT_EQ(dlt_file_index_position(&file, i), dlt_file_index_position(&parallel, i));
+        }
+
+        EXPECT_LE(DLT_RETURN_OK, dlt_file_free(&file, 0));
+        EXPECT_LE(DLT_RETURN_OK, dlt_file_free(&parallel, 0));
+    }
+
+    unlink(bigfile);
+}
+TEST(t_dlt_file_read_parallel, nullpointer)
+{
+    DltFile file;
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_init(&file, 0));
+
+    // NULL-Pointer, expected -1
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_file_read_parallel(NULL, 0, 0));
+    // no file opened
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_file_read_parallel(&file, 0, 0));
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_free(&file, 0));
+}
+/* End Method: dlt_common::dlt_file_read_parallel */
+
+
+
+
+#ifdef DLT_SORT_TOOL
+/* Begin Method: dlt-sortbytimestamp */
+/* Write a message with timestamp and session id, its number is the payload */
+static void sort_write_message(FILE *out, const char *ecu, uint32_t seid, uint32_t tmsp, uint32_t num)
+{
+    DltStorageHeader storage;
+    uint8_t header[sizeof(DltStandardHeader) + sizeof(DltStandardHeaderExtra) + sizeof(DltExtendedHeader)];
+    DltStandardHeader *standard = (DltStandardHeader *)header;
+    DltStandardHeaderExtra *extra = (DltStandardHeaderExtra *)(header + sizeof(DltStandardHeader));
+    DltExtendedHeader *extended = (DltExtendedHeader *)(header + sizeof(DltStandardHeader) + sizeof(DltStandardHeaderExtra));
+
+    memset(header, 0, sizeof(header));
+    dlt_set_storageheader(&storage, ecu);
+    standard->htyp = DLT_HTYP_UEH | DLT_HTYP_WEID | DLT_HTYP_WSID | DLT_HTYP_WTMS | DLT_HTYP_PROTOCOL_VERSION1;
+    standard->len = DLT_HTOBE_16(sizeof(header) + sizeof(num));
+    dlt_set_id(extra->ecu, ecu);
+    extra->seid = DLT_HTOBE_32(seid);
+    extra->tmsp = DLT_HTOBE_32(tmsp);
+    extended->msin = DLT_MSIN_VERB | (DLT_TYPE_LOG << DLT_MSIN_MSTP_SHIFT) | (DLT_LOG_INFO << DLT_MSIN_MTIN_SHIFT);
+    dlt_set_id(extended->apid, "SORT");
+    dlt_set_id(extended->ctid, "TEST");
+
+    ASSERT_EQ(1u, fwrite(&storage, sizeof(storage), 1, out));
+    ASSERT_EQ(1u, fwrite(header, sizeof(header), 1, out));
+    ASSERT_EQ(1u, fwrite(&num, sizeof(num), 1, out));
+}
+
+/* Run the sort tool, return its exit status and the number of runs written */
+static int sort_run_tool(const char *args, int *runs)
+{
+    char cmd[PATH_MAX * 3];
+    char line[256];
+    FILE *pipe;
+
+    snprintf(cmd, sizeof(cmd), "%s %s", DLT_SORT_TOOL, args);
+    pipe = popen(cmd, "r");
+
+    if (pipe == NULL)
+    {
+        return -1;
+    }
+
+    *runs = 0;
+
+    while (fgets(line, sizeof(line), pipe) != NULL)
+    {
+        if (strncmp(line, "Writing run", 11) == 0)
+        {
+            (*runs)++;
+        }
+    }
+
+    return pclose(pipe);
+}
+
+TEST(t_dlt_sortbytimestamp, runs)
+{
+    char pwd[100];
+    char infile[PATH_MAX];
+    char outfile[PATH_MAX];
+    char args[PATH_MAX * 2];
+    std::vector<bool> seen(20000, false);
+    DltFile file;
+    FILE *out;
+    uint32_t num = 0;
+    uint32_t prev_tmsp = 0;
+    uint32_t prev_num = 0;
+    int runs = 0;
+
+    if (getcwd(pwd, sizeof(pwd)) == NULL) {}
+
+    snprintf(infile, sizeof(infile), "%s/sort.dlt.gtest.in", pwd);
+    snprintf(outfile, sizeof(outfile), "%s/sort.dlt.gtest.out", pwd);
+
+    /* many equal timestamps, which keep the order of the input */
+    out = fopen(infile, "wb");
+    ASSERT_TRUE(out != NULL);
+    for (num = 0; num < seen.size(); num++)
+    {
+        sort_write_message(out, "ECU1", 1, (num * 7919) % 5000, num);
+    }
+    fclose(out);
+
+    /* the messages do not fit into one run of 1 MB */
+    ASSERT_GT((int) sizeof(args), snprintf(args, sizeof(args), "-v -s 1 %s %s", infile, outfile));
+    EXPECT_EQ(0, sort_run_tool(args, &runs));
+    EXPECT_LT(1, runs);
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_init(&file, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_open(&file, outfile, 0));
+    while (dlt_file_read(&file, 0) >= 0) {}
+    ASSERT_EQ((int32_t) seen.size(), file.counter);
+
+    for (int32_t i = 0; i < file.counter; i++)
+    {
+        ASSERT_LE(DLT_RETURN_OK, dlt_file_message(&file, i, 0));
+        ASSERT_EQ(sizeof(num), (size_t) file.msg.datasize);
+        memcpy(&num, file.msg.databuffer, sizeof(num));
+        ASSERT_GT(seen.size(), num);
+        EXPECT_FALSE(seen[num]);
+        seen[num] = true;
+
+        if (i > 0)
+        {
+            ASSERT_LE(prev_tmsp, file.msg.headerextra.tmsp);
+            if (prev_tmsp == file.msg.headerextra.tmsp)
+            {
+                ASSERT_LT(prev_num, num);
+            }
+        }
+
+        prev_tmsp = file.msg.headerextra.tmsp;
+        prev_num = num;
+    }
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_free(&file, 0));
+    unlink(infile);
+    unlink(outfile);
+}
+TEST(t_dlt_sortbytimestamp, merge)
+{
+    char pwd[100];
+    char infile[2][PATH_MAX];
+    char outfile[PATH_MAX];
+    char args[PATH_MAX * 3];
+    DltFile file;
+    FILE *out;
+    uint32_t num;
+    int runs = 0;
+
+    if (getcwd(pwd, sizeof(pwd)) == NULL) {}
+
+    /* files sorted by ECU, session and timestamp, interleaved with each other */
+    for (int f = 0; f < 2; f++)
+    {
+        snprintf(infile[f], sizeof(infile[f]), "%s/sort.dlt.gtest.in%d", pwd, f);
+        out = fopen(infile[f], "wb");
+        ASSERT_TRUE(out != NULL);
+        for (num = 0; num < 100; num++)
+        {
+            sort_write_message(out, (num < 50) ? "ECU1" : "ECU2", 1, 2 * num + f, 2 * num + f);
+        }
+        fclose(out);
+    }
+
+    snprintf(outfile, sizeof(outfile), "%s/sort.dlt.gtest.out", pwd);
+    ASSERT_GT((int) sizeof(args), snprintf(args, sizeof(args), "-m %s %s %s", infile[0], infile[1], outfile));
+    EXPECT_EQ(0, sort_run_tool(args, &runs));
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_init(&file, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_open(&file, outfile, 0));
+    while (dlt_file_read(&file, 0) >= 0) {}
+    ASSERT_EQ(200, file.counter);
+
+    for (int32_t i = 0; i < file.counter; i++)
+    {
+        ASSERT_LE(DLT_RETURN_OK, dlt_file_message(&file, i, 0));
+        memcpy(&num, file.msg.databuffer, sizeof(num));
+        EXPECT_EQ((uint32_t) i, num);
+    }
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_free(&file, 0));
+    unlink(infile[0]);
+    unlink(infile[1]);
+    unlink(outfile);
+}
+/* End Method: dlt-sortbytimestamp */
+#endif
+
+
+
+
 /* Begin Method: dlt_common::dlt_message_print_ascii*/
 TEST(t_dlt_message_print_ascii, normal)
 {
@@ -2262,6 +2785,172 @@ TEST(t_dlt_message_filter_check, nullpointer)
 /* End Method:dlt_common::dlt_message_filter_check */
 
 
+/* Begin Method:dlt_common::dlt_filter_parse */
+static int count_filtered(const char *text, int parallel)
+{
+    DltFile file;
+    DltFilter filter;
+    int counter;
+    /* Get PWD so file can be used*/
+    char pwd[100];
+    char  openfile[114];
+
+    // ignore returned value from getcwd
+    if (getcwd(pwd, 100) == NULL) {}
+
+    sprintf(openfile, "%s/testfile.dlt", pwd);
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_filter_init(&filter, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_filter_parse(&filter, text, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_init(&file, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_set_filter(&file, &filter, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_open(&file, openfile, 0));
+    if (parallel)
+    {
+        EXPECT_LE(DLT_RETURN_OK, dlt_file_read_parallel(&file, 2, 0));
+    }
+    else
+    {
+        while (dlt_file_read(&file,0)>=0){}
+    }
+    counter = file.counter;
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_free(&file, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_filter_free(&filter, 0));
+
+    return counter;
+}
+
+TEST(t_dlt_filter_parse, normal)
+{
+    DltFilter filter;
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_filter_init(&filter, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_filter_parse(&filter, "# comment\nLOG TES4 LOG TES1\n---- ---- type=control\n", 0));
+    EXPECT_EQ(3, filter.counter);
+    EXPECT_EQ(0, dlt_filter_find(&filter, "LOG", "TES4", 0));
+    EXPECT_EQ(1, dlt_filter_find(&filter, "LOG", "TES1", 0));
+    // filters with predicates are not found by ids
+    EXPECT_GT(0, dlt_filter_find(&filter, "", "", 0));
+    // ids are added only once
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_filter_add(&filter, "LOG", "TES4", 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_filter_delete(&filter, "LOG", "TES4", 0));
+    EXPECT_EQ(0, dlt_filter_find(&filter, "LOG", "TES1", 0));
+    EXPECT_GT(0, dlt_filter_find(&filter, "LOG", "TES4", 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_filter_free(&filter, 0));
+    EXPECT_EQ(0, filter.counter);
+
+    // testfile.dlt: 53 messages without extended header are always used,
+    // 8 control messages of APP CON, 44 info messages of LOG with
+    // 3 of TES1, 16 of TES2, 7 of TES3 and 18 of TES4
+    EXPECT_EQ(105, count_filtered("", 0));
+    EXPECT_EQ(53 + 18 + 8, count_filtered("LOG TES4\n---- ---- type=control", 0));
+    EXPECT_EQ(53 + 44, count_filtered("LOG ----", 0));
+    EXPECT_EQ(53 + 8, count_filtered("---- CON", 0));
+    EXPECT_EQ(105, count_filtered("---- ----", 0));
+    EXPECT_EQ(53 + 3 + 16, count_filtered("apid=LOG ctid=TES1\nLOG TES2", 0));
+    EXPECT_EQ(53 + 44, count_filtered("type=log level=info", 0));
+    EXPECT_EQ(53 + 44, count_filtered("level>=warn level<=5", 0));
+    EXPECT_EQ(53, count_filtered("level<=warn", 0));
+    EXPECT_EQ(53, count_filtered("APP CON level=info", 0));
+    // only the control messages have a timestamp
+    EXPECT_EQ(53 + 8, count_filtered("tmsp>=0", 0));
+    EXPECT_EQ(53, count_filtered("ecu=XXXX", 0));
+}
+TEST(t_dlt_filter_parse, payload)
+{
+    // 19 messages contain Hello as string, 18 of them in TES4,
+    // one more contains it as raw data, printed as hex in ASCII
+    EXPECT_EQ(53 + 20, count_filtered("payload=Hello", 0));
+    EXPECT_EQ(53 + 18, count_filtered("LOG TES4 payload=Hello", 0));
+    EXPECT_EQ(53 + 1, count_filtered("payload~=^Hello[[:space:]]BMW$", 0));
+    EXPECT_EQ(53 + 18, count_filtered("payload~=^[0-9]+[[:space:]]Hello", 0));
+    EXPECT_EQ(53 + 19, count_filtered("payload~=Hello", 1));
+    EXPECT_EQ(53 + 18 + 8, count_filtered("payload~=^[0-9]+[[:space:]]Hello\ntype=control", 1));
+}
+TEST(t_dlt_filter_parse, save_load)
+{
+    DltFilter filter;
+    DltFilter loaded;
+    /* Get PWD so file can be used*/
+    char pwd[100];
+    char  filterfile[130];
+    char  savedfile[140];
+    char text[512];
+    char saved[512];
+    size_t text_length;
+    size_t saved_length;
+    FILE *handle;
+
+    // ignore returned value from getcwd
+    if (getcwd(pwd, 100) == NULL) {}
+
+    sprintf(filterfile, "%s/testfilter.txt.gtest", pwd);
+    sprintf(savedfile, "%s/testfilter.txt.gtest.saved", pwd);
+    /*---------------------------------------*/
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_filter_init(&filter, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_filter_parse(&filter, "LOG TES4 level<=info tmsp<=100 payload=Hello payload~=[0-9]\n"
+                                                        "---- CON ecu=ECU1 seid=7 type=control\nDLTD ----", 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_filter_save(&filter, filterfile, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_filter_init(&loaded, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_filter_load(&loaded, filterfile, 0));
+    EXPECT_EQ(filter.counter, loaded.counter);
+    for (int i = 0; i < filter.counter; i++)
+    {
+        EXPECT_EQ(0, memcmp(filter.apid[i], loaded.apid[i], DLT_ID_SIZE));
+        EXPECT_EQ(0, memcmp(filter.ctid[i], loaded.ctid[i], DLT_ID_SIZE));
+    }
+    EXPECT_EQ(2, dlt_filter_find(&loaded, "DLTD", NULL, 0));
+
+    /* the predicates survive the round trip if the loaded filters are saved the same way */
+    EXPECT_LE(DLT_RETURN_OK, dlt_filter_save(&loaded, savedfile, 0));
+    handle = fopen(filterfile, "r");
+    ASSERT_TRUE(handle != NULL);
+    text_length = fread(text, 1, sizeof(text), handle);
+    fclose(handle);
+    handle = fopen(savedfile, "r");
+    ASSERT_TRUE(handle != NULL);
+    saved_length = fread(saved, 1, sizeof(saved), handle);
+    fclose(handle);
+    EXPECT_LT(0u, text_length);
+    EXPECT_EQ(text_length, saved_length);
+    EXPECT_EQ(0, memcmp(text, saved, text_length));
+    EXPECT_TRUE(memmem(text, text_length, "seid=7", 6) != NULL);
+    EXPECT_TRUE(memmem(text, text_length, "payload~=[0-9]", 14) != NULL);
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_filter_free(&filter, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_filter_free(&loaded, 0));
+    EXPECT_TRUE(loaded.compiled == NULL);
+    unlink(filterfile);
+    unlink(savedfile);
+}
+TEST(t_dlt_filter_parse, abnormal)
+{
+    DltFilter filter;
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_filter_init(&filter, 0));
+    // unknown predicate, level and operator
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_filter_parse(&filter, "size>=10", 0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_filter_parse(&filter, "level<=loud", 0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_filter_parse(&filter, "apid<=LOG", 0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_filter_parse(&filter, "payload~=(", 0));
+    // context id missing before predicate
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_filter_parse(&filter, "LOG level=info", 0));
+    EXPECT_EQ(0, filter.counter);
+    EXPECT_LE(DLT_RETURN_OK, dlt_filter_free(&filter, 0));
+}
+TEST(t_dlt_filter_parse, nullpointer)
+{
+    DltFilter filter;
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_filter_init(&filter, 0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_filter_parse(NULL, "LOG ----", 0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_filter_parse(&filter, NULL, 0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_filter_parse(NULL, NULL, 0));
+}
+/* End Method:dlt_common::dlt_filter_parse */
+
+
 
 
 /* Begin Method:dlt_common::dlt_message _get_extraparameters */
@@ -2995,10 +3684,116 @@ TEST(t_dlt_message_payload, nullpointer)
 //    EXPECT_GE(DLT_RETURN_ERROR, dlt_message_payload(&file.msg, text, DLT_DAEMON_TEXTSIZE, 0, 0));
 //    EXPECT_GE(DLT_RETURN_ERROR, dlt_message_payload(&file.msg, text, DLT_DAEMON_TEXTSIZE, 0, 1));
 }
+TEST(t_dlt_message_payload, arguments)
+{
+    DltMessage msg;
+    uint8_t payload[128];
+    char text[DLT_DAEMON_TEXTSIZE];
+    uint32_t type_info;
+    uint16_t length;
+    int8_t value8i = -128;
+    uint16_t value16u = 65535;
+    int32_t value32i = INT32_MIN;
+    int64_t value64i = INT64_MIN;
+    uint64_t value64u = UINT64_MAX;
+    uint8_t value8u = 1;
+    int size = 0;
+
+    /* verbose little endian message with arguments printed by the fast path */
+    EXPECT_LE(DLT_RETURN_OK, dlt_message_init(&msg, 0));
+    memset(msg.headerbuffer, 0, sizeof(msg.headerbuffer));
+    msg.storageheader = (DltStorageHeader *) msg.headerbuffer;
+    msg.standardheader = (DltStandardHeader *) (msg.headerbuffer + sizeof(DltStorageHeader));
+    msg.standardheader->htyp = DLT_HTYP_UEH | DLT_HTYP_PROTOCOL_VERSION1;
+    msg.extendedheader = (DltExtendedHeader *) (msg.headerbuffer + sizeof(DltStorageHeader) + sizeof(DltStandardHeader));
+    msg.extendedheader->msin = DLT_MSIN_VERB | (DLT_TYPE_LOG << DLT_MSIN_MSTP_SHIFT);
+    msg.extendedheader->noar = 7;
+
+#define APPEND_ARG(info, value) \
+    type_info = (info); memcpy(payload + size, &type_info, 4); size += 4; \
+    memcpy(payload + size, &(value), sizeof(value)); size += sizeof(value);
+
+    APPEND_ARG(DLT_TYPE_INFO_SINT | DLT_TYLE_8BIT, value8i);
+    APPEND_ARG(DLT_TYPE_INFO_UINT | DLT_TYLE_16BIT, value16u);
+    APPEND_ARG(DLT_TYPE_INFO_SINT | DLT_TYLE_32BIT, value32i);
+    APPEND_ARG(DLT_TYPE_INFO_SINT | DLT_TYLE_64BIT, value64i);
+    APPEND_ARG(DLT_TYPE_INFO_UINT | DLT_TYLE_64BIT, value64u);
+    APPEND_ARG(DLT_TYPE_INFO_BOOL | DLT_TYLE_8BIT, value8u);
+    length = 6;
+    APPEND_ARG(DLT_TYPE_INFO_STRG | DLT_SCOD_ASCII, length);
+    memcpy(payload + size, "a\nbc\r", 6);
+    size += 6;
+#undef APPEND_ARG
+
+    msg.databuffer = payload;
+    msg.datasize = size;
+    EXPECT_LE(DLT_RETURN_OK, dlt_message_payload(&msg, text, DLT_DAEMON_TEXTSIZE, DLT_OUTPUT_ASCII, 0));
+    /* 64 bit values are printed signed */
+    EXPECT_STREQ("-128 65535 -2147483648 -9223372036854775808 -1 1 a bc ", text);
+
+    /* text too small for fast path, same truncated output */
+    msg.extendedheader->noar = 2;
+    EXPECT_LE(DLT_RETURN_OK, dlt_message_payload(&msg, text, 10, DLT_OUTPUT_ASCII, 0));
+    EXPECT_STREQ("-128 6553", text);
+    msg.extendedheader->noar = 7;
+
+    /* missing data */
+    msg.datasize = size - 1;
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_message_payload(&msg, text, DLT_DAEMON_TEXTSIZE, DLT_OUTPUT_ASCII, 0));
+    msg.databuffer = NULL;
+}
 /* End Method:dlt_common::dlt_message_payload */
 
 
 
+/* Begin Method:dlt_common::dlt_file_message_view */
+TEST(t_dlt_file_message_view, normal)
+{
+    DltFile file;
+    DltMessage msg;
+    // Get PWD so file can be used
+    char pwd[100];
+    char  openfile[114];
+
+    // ignore returned value from getcwd
+    if (getcwd(pwd, 100) == NULL) {}
+
+    sprintf(openfile, "%s/testfile.dlt", pwd);
+    /*---------------------------------------*/
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_init(&file, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_open(&file, openfile, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_message_init(&msg, 0));
+    while (dlt_file_read(&file,0)>=0){}
+    for(int i=0;i<file.counter;i++)
+    {
+        EXPECT_LE(DLT_RETURN_OK, dlt_file_message_view(&file, i, &msg, 0));
+        EXPECT_LE(DLT_RETURN_OK, dlt_file_message(&file, i, 0));
+        EXPECT_EQ(file.msg.headersize, msg.headersize);
+        EXPECT_EQ(file.msg.datasize, msg.datasize);
+        EXPECT_EQ(0, memcmp(file.msg.headerbuffer, msg.headerbuffer, msg.headersize));
+        EXPECT_EQ(0, memcmp(file.msg.databuffer, msg.databuffer, msg.datasize));
+        EXPECT_EQ(0, msg.databuffersize);
+        EXPECT_EQ(DLT_IS_HTYP_UEH(msg.standardheader->htyp) != 0, msg.extendedheader != NULL);
+    }
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_file_message_view(&file, file.counter, &msg, 0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_file_message_view(&file, -1, &msg, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_close(&file, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_free(&file, 0));
+}
+TEST(t_dlt_file_message_view, nullpointer)
+{
+    DltFile file;
+    DltMessage msg;
+
+    // NULL-Pointer, expected -1
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_file_message_view(NULL, 0, &msg, 0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_file_message_view(&file, 0, NULL, 0));
+}
+/* End Method:dlt_common::dlt_file_message_view */
+
+
+
 
 /* Begin Method:dlt_common::dlt_message_set_extraparameters */
 TEST(t_dlt_message_set_extraparamters, normal)
@@ -3140,6 +3935,191 @@ TEST(t_dlt_message_read, nullpointer)
 
 
 
+/* Begin Method:dlt_common::dlt_message_read_header */
+TEST(t_dlt_message_read_header, normal)
+{
+    DltFile file;
+    DltMessage msg;
+    // Get PWD so file can be used
+    char pwd[100];
+    char  openfile[114];
+
+    // ignore returned value from getcwd
+    if (getcwd(pwd, 100) == NULL) {}
+
+    sprintf(openfile, "%s/testfile.dlt", pwd);
+    /*---------------------------------------*/
+
+    uint8_t buffer[DLT_DAEMON_RCVBUFSIZE];
+    int headersize;
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_init(&file, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_open(&file, openfile, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_message_init(&msg, 0));
+    while (dlt_file_read(&file,0)>=0){}
+    for(int i=0;i<file.counter;i++)
+    {
+        EXPECT_LE(DLT_RETURN_OK, dlt_file_message(&file, i, 0));
+
+        /* message without storage header, as sent by an application */
+        headersize = file.msg.headersize - sizeof(DltStorageHeader);
+        memcpy(buffer, file.msg.headerbuffer + sizeof(DltStorageHeader), headersize);
+        memcpy(buffer + headersize, file.msg.databuffer, file.msg.datasize);
+
+        EXPECT_EQ(DLT_MESSAGE_ERROR_OK, dlt_message_read_header(&msg, buffer, headersize + file.msg.datasize, 0, 0));
+        EXPECT_EQ(file.msg.headersize, msg.headersize);
+        EXPECT_EQ(file.msg.datasize, msg.datasize);
+        EXPECT_EQ(0, memcmp(buffer + headersize, file.msg.databuffer, msg.datasize));
+        /* payload is not copied */
+        EXPECT_EQ(NULL, msg.databuffer);
+
+        /* incomplete payload */
+        if (file.msg.datasize > 0)
+        {
+            EXPECT_EQ(DLT_MESSAGE_ERROR_SIZE, dlt_message_read_header(&msg, buffer, headersize + file.msg.datasize - 1, 0, 0));
+        }
+    }
+    EXPECT_LE(DLT_RETURN_OK, dlt_message_free(&msg, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_close(&file, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_free(&file, 0));
+}
+TEST(t_dlt_message_read_header, nullpointer)
+{
+    DltMessage msg;
+    uint8_t buf[16];
+
+    // NULL_Pointer, expected -1
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_message_read_header(NULL, NULL, 0,0,0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_message_read_header(NULL, buf, sizeof(buf),0,0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_message_read_header(&msg, NULL, sizeof(buf),0,0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_message_read_header(&msg, buf, 0,0,0));
+}
+/* End Method:dlt_common::dlt_message_read_header */
+
+
+
+
+/* Begin Method:dlt_common::dlt_message_read_view */
+TEST(t_dlt_message_read_view, normal)
+{
+    DltFile file;
+    DltMessage msg;
+    // Get PWD so file can be used
+    char pwd[100];
+    char  openfile[114];
+
+    // ignore returned value from getcwd
+    if (getcwd(pwd, 100) == NULL) {}
+
+    sprintf(openfile, "%s/testfile.dlt", pwd);
+    /*---------------------------------------*/
+
+    static uint8_t buffer[64 * 1024];
+    uint32_t length = 0;
+    uint32_t offset = 0;
+    int headersize;
+    int count = 0;
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_init(&file, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_open(&file, openfile, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_message_init(&msg, 0));
+    while (dlt_file_read(&file,0)>=0){}
+
+    /* all messages without storage header as received, every second one with serial header */
+    for(int i=0;i<file.counter;i++)
+    {
+        EXPECT_LE(DLT_RETURN_OK, dlt_file_message(&file, i, 0));
+        if (i % 2)
+        {
+            memcpy(buffer + length, dltSerialHeader, sizeof(dltSerialHeader));
+            length += sizeof(dltSerialHeader);
+        }
+        headersize = file.msg.headersize - sizeof(DltStorageHeader);
+        memcpy(buffer + length, file.msg.headerbuffer + sizeof(DltStorageHeader), headersize);
+        memcpy(buffer + length + headersize, file.msg.databuffer, file.msg.datasize);
+        length += headersize + file.msg.datasize;
+    }
+
+    while (dlt_message_read_view(&msg, buffer + offset, length - offset, 0, 0) == DLT_MESSAGE_ERROR_OK)
+    {
+        EXPECT_LE(DLT_RETURN_OK, dlt_file_message(&file, count, 0));
+        EXPECT_EQ(file.msg.headersize, msg.headersize);
+        EXPECT_EQ(file.msg.datasize, msg.datasize);
+        EXPECT_EQ(count % 2, msg.found_serialheader);
+        /* payload points into the buffer */
+        headersize = msg.headersize - sizeof(DltStorageHeader) + (msg.found_serialheader ? sizeof(dltSerialHeader) : 0);
+        EXPECT_EQ(buffer + offset + headersize, msg.databuffer);
+        EXPECT_EQ(0, msg.databuffersize);
+        EXPECT_EQ(0, memcmp(file.msg.databuffer, msg.databuffer, msg.datasize));
+
+        offset += headersize + msg.datasize;
+        count++;
+    }
+    EXPECT_EQ(file.counter, count);
+    EXPECT_EQ(length, offset);
+
+    /* incomplete last message */
+    msg.databuffer = NULL;
+    EXPECT_EQ(DLT_MESSAGE_ERROR_SIZE, dlt_message_read_view(&msg, buffer, file.msg.headersize - sizeof(DltStorageHeader) - 1, 0, 0));
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_close(&file, 0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_file_free(&file, 0));
+}
+TEST(t_dlt_message_read_view, nullpointer)
+{
+    DltMessage msg;
+    uint8_t buf[16];
+
+    // NULL_Pointer, expected -1
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_message_read_view(NULL, NULL, 0,0,0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_message_read_view(NULL, buf, sizeof(buf),0,0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_message_read_view(&msg, NULL, sizeof(buf),0,0));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_message_read_view(&msg, buf, 0,0,0));
+}
+/* End Method:dlt_common::dlt_message_read_view */
+
+
+
+
+/* Begin Method:dlt_common::dlt_receiver_grow */
+TEST(t_dlt_receiver_grow, normal)
+{
+    DltReceiver receiver;
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_receiver_init(&receiver, -1, 16));
+    memcpy(receiver.buffer, "0123456789abcdef", 16);
+    receiver.bytesRcvd = 16;
+    EXPECT_LE(DLT_RETURN_OK, dlt_receiver_remove(&receiver, 4));
+
+    /* data and position are kept */
+    EXPECT_LE(DLT_RETURN_OK, dlt_receiver_grow(&receiver, 64));
+    EXPECT_EQ(64, receiver.buffersize);
+    EXPECT_EQ(12, receiver.bytesRcvd);
+    EXPECT_EQ(receiver.buffer + 4, receiver.buf);
+    EXPECT_EQ(0, memcmp(receiver.buf, "456789abcdef", 12));
+
+    /* buffer does not shrink */
+    EXPECT_LE(DLT_RETURN_OK, dlt_receiver_grow(&receiver, 32));
+    EXPECT_EQ(64, receiver.buffersize);
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_receiver_free(&receiver));
+}
+TEST(t_dlt_receiver_grow, nullpointer)
+{
+    DltReceiver receiver;
+
+    // NULL-Pointer, expect -1
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_receiver_grow(NULL, 64));
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_receiver_init(&receiver, -1, 16));
+    EXPECT_LE(DLT_RETURN_OK, dlt_receiver_free(&receiver));
+    EXPECT_GE(DLT_RETURN_ERROR, dlt_receiver_grow(&receiver, 64));
+}
+/* End Method:dlt_common::dlt_receiver_grow */
+
+
+
+
 /* Begin Method:dlt_common::dlt_message_argument_print */
 TEST(t_dlt_message_argument_print, normal)
 {
@@ -3510,6 +4490,112 @@ TEST(t_dlt_set_id, nullpointer)
 
 
 
+/* Reference implementations of the payload formatting, printing one byte
+ * at a time with snprintf() as dlt_common did before. Used to check that
+ * the output of dlt_print_hex_string(), dlt_print_mixed_string() and
+ * dlt_print_char_string() stays identical to the byte. */
+static void ref_print_hex_string(char *text, uint8_t *ptr, int size)
+{
+    for (int num = 0; num < size; num++)
+    {
+        if (num > 0)
+        {
+            snprintf(text, 2, " ");
+            text++;
+        }
+
+        snprintf(text, 3, "%.2x", ptr[num]);
+        text += 2;
+    }
+}
+
+static void ref_print_char_string(char **text, uint8_t *ptr, int size)
+{
+    for (int num = 0; num < size; num++)
+    {
+        if ((((char *)ptr)[num] < 32) || (((char *)ptr)[num] > 126) || (((char *)ptr)[num] == '<'))
+        {
+            snprintf(*text, 2, ".");
+        }
+        else
+        {
+            snprintf(*text, 2, "%c", ((char *)ptr)[num]);
+        }
+        (*text)++;
+    }
+}
+
+static void ref_print_mixed_string(char *text, uint8_t *ptr, int size, int html)
+{
+    int lines, rest, i;
+
+    for (lines = 0; lines < (size / 16); lines++)
+    {
+        snprintf(text, 9, "%.6x: ", lines * 16);
+        text += 8;
+        ref_print_hex_string(text, ptr + lines * 16, 16);
+        text += 47;
+        snprintf(text, 2, " ");
+        text++;
+        ref_print_char_string(&text, ptr + lines * 16, 16);
+
+        if (html == 0)
+        {
+            snprintf(text, 2, "\n");
+            text++;
+        }
+        else
+        {
+            snprintf(text, 5, "<BR>");
+            text += 4;
+        }
+    }
+
+    rest = size % 16;
+
+    if (rest > 0)
+    {
+        snprintf(text, 9, "%.6x: ", (size / 16) * 16);
+        text += 8;
+        ref_print_hex_string(text, ptr + (size / 16) * 16, rest);
+        text += 2 * rest + (rest - 1);
+
+        for (i = 0; i < (16 - rest); i++)
+        {
+            snprintf(text, 4, " xx");
+            text += 3;
+        }
+
+        snprintf(text, 2, " ");
+        text++;
+        ref_print_char_string(&text, ptr + (size / 16) * 16, rest);
+    }
+}
+
+static void ref_fill_payload(uint8_t *ptr, int size)
+{
+    /* all byte values first, then pseudo random data */
+    uint32_t seed = 12345;
+
+    for (int i = 0; i < size; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        ptr[i] = (i < 256) ? (uint8_t)i : (uint8_t)(seed >> 16);
+    }
+}
+
+static double ref_elapsed(struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+
+
+
 /* Begin Method:dlt_common::dlt_print_hex_string */
 TEST(t_dlt_print_hex_string, normal)
 {
@@ -3611,6 +4697,26 @@ TEST(t_dlt_print_hex_string, nullpointer)
     EXPECT_GE(DLT_RETURN_ERROR, dlt_print_hex_string(NULL,0,(unsigned char *)test5, 0));
     EXPECT_GE(DLT_RETURN_ERROR, dlt_print_hex_string(text5,0,NULL, 0));
 }
+TEST(t_dlt_print_hex_string, reference)
+{
+    uint8_t payload[600];
+    char text[3 * 600 + 16];
+    char expected[3 * 600 + 16];
+
+    ref_fill_payload(payload, sizeof(payload));
+
+    for (int offset = 0; offset < 3; offset++)
+    {
+        for (int size = 0; size <= 300; size++)
+        {
+            memset(text, '#', sizeof(text));
+            memset(expected, '#', sizeof(expected));
+            ref_print_hex_string(expected, payload + offset * 100, size);
+            EXPECT_LE(DLT_RETURN_OK, dlt_print_hex_string(text, 3 * size + 1, payload + offset * 100, size));
+            EXPECT_EQ(0, memcmp(expected, text, sizeof(text))) << "size " << size;
+        }
+    }
+}
 /* End Method:dlt_common::dlt_print_hex_string */
 
 
@@ -3673,6 +4779,89 @@ TEST(t_dlt_print_mixed_string, nullpointer)
     EXPECT_GE(DLT_RETURN_ERROR, dlt_print_mixed_string(text9,0,NULL,0,0));
     EXPECT_GE(DLT_RETURN_ERROR, dlt_print_mixed_string(text9,0,NULL,0,1));
 }
+TEST(t_dlt_print_mixed_string, reference)
+{
+    uint8_t payload[600];
+    char text[DLT_DAEMON_TEXTSIZE];
+    char expected[DLT_DAEMON_TEXTSIZE];
+
+    ref_fill_payload(payload, sizeof(payload));
+
+    for (int html = 0; html <= 1; html++)
+    {
+        for (int size = 0; size <= 300; size++)
+        {
+            memset(text, '#', sizeof(text));
+            memset(expected, '#', sizeof(expected));
+            ref_print_mixed_string(expected, payload + (size % 7) * 40, size, html);
+            EXPECT_LE(DLT_RETURN_OK, dlt_print_mixed_string(text, DLT_DAEMON_TEXTSIZE, payload + (size % 7) * 40, size, html));
+            EXPECT_EQ(0, memcmp(expected, text, sizeof(text))) << "size " << size << " html " << html;
+        }
+    }
+}
+TEST(t_dlt_print_mixed_string, large)
+{
+    const int size = 1024 * 1024 + 5;
+    const int textlength = 5 * size;
+    uint8_t *payload = (uint8_t *) malloc(size);
+    char *text = (char *) malloc(textlength);
+    char *expected = (char *) malloc(textlength);
+
+    ASSERT_TRUE(payload != NULL && text != NULL && expected != NULL);
+    ref_fill_payload(payload, size);
+
+    for (int html = 0; html < 2; html++)
+    {
+        memset(text, '#', textlength);
+        memset(expected, '#', textlength);
+        ref_print_mixed_string(expected, payload, size, html);
+        EXPECT_LE(DLT_RETURN_OK, dlt_print_mixed_string(text, textlength, payload, size, html));
+        EXPECT_EQ(0, memcmp(expected, text, textlength)) << "html " << html;
+    }
+
+    free(expected);
+    free(text);
+    free(payload);
+}
+/* timing against the snprintf reference, run with --gtest_also_run_disabled_tests */
+TEST(t_dlt_print_mixed_string, DISABLED_benchmark)
+{
+    const int size = 1024 * 1024;
+    const int textlength = 5 * size;
+    const int rounds = 16;
+    uint8_t *payload = (uint8_t *) malloc(size);
+    char *text = (char *) malloc(textlength);
+    char *expected = (char *) malloc(textlength);
+    struct timespec start;
+    double ref_time, time;
+
+    ASSERT_TRUE(payload != NULL && text != NULL && expected != NULL);
+    ref_fill_payload(payload, size);
+    memset(text, '#', textlength);
+    memset(expected, '#', textlength);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < rounds; i++)
+    {
+        ref_print_mixed_string(expected, payload, size, 0);
+    }
+    ref_time = ref_elapsed(&start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < rounds; i++)
+    {
+        EXPECT_LE(DLT_RETURN_OK, dlt_print_mixed_string(text, textlength, payload, size, 0));
+    }
+    time = ref_elapsed(&start);
+
+    EXPECT_EQ(0, memcmp(expected, text, textlength));
+    printf("mixed output of %d MiB: snprintf %.3f s, dlt_print_mixed_string %.3f s\n",
+           rounds * size / (1024 * 1024), ref_time, time);
+
+    free(expected);
+    free(text);
+    free(payload);
+}
 /* End Method:dlt_common::dlt_print_mixed_string */
 
 
@@ -3724,6 +4913,30 @@ TEST(t_dlt_print_char_string, nullpointer)
     EXPECT_GE(DLT_RETURN_ERROR, dlt_print_char_string(NULL,0,(unsigned char *)test5, 0));
     EXPECT_GE(DLT_RETURN_ERROR, dlt_print_char_string(&ptr5,0,NULL, 0));
 }
+TEST(t_dlt_print_char_string, reference)
+{
+    uint8_t payload[600];
+    char text[600 + 16];
+    char expected[600 + 16];
+
+    ref_fill_payload(payload, sizeof(payload));
+
+    for (int offset = 0; offset < 3; offset++)
+    {
+        for (int size = 0; size <= 300; size++)
+        {
+            char *ptr = text;
+            char *ptr_expected = expected;
+
+            memset(text, '#', sizeof(text));
+            memset(expected, '#', sizeof(expected));
+            ref_print_char_string(&ptr_expected, payload + offset * 100, size);
+            EXPECT_LE(DLT_RETURN_OK, dlt_print_char_string(&ptr, size + 1, payload + offset * 100, size));
+            EXPECT_EQ(ptr_expected - expected, ptr - text);
+            EXPECT_EQ(0, memcmp(expected, text, sizeof(text))) << "size " << size;
+        }
+    }
+}
 /* End Method:dlt_common::dlt_print_char_string */
 
 
@@ -3849,6 +5062,67 @@ TEST(dlt_get_minor_version, nullpointer)
 
 
 
+/* Begin Method:dlt_user_shared::dlt_user_find_userheader */
+TEST(t_dlt_user_find_userheader, normal)
+{
+    char buf[32];
+
+    // Marker at offset 0
+    memset(buf, 'x', sizeof(buf));
+    memcpy(buf, "DUH\1", 4);
+    EXPECT_EQ(0, dlt_user_find_userheader(buf, sizeof(buf)));
+
+    // Marker behind garbage, first complete marker wins
+    memset(buf, 'x', sizeof(buf));
+    memcpy(buf + 5, "DUH\1", 4);
+    memcpy(buf + 20, "DUH\1", 4);
+    EXPECT_EQ(5, dlt_user_find_userheader(buf, sizeof(buf)));
+
+    // Complete marker ending exactly at the end of the buffer
+    memset(buf, 'x', sizeof(buf));
+    memcpy(buf + sizeof(buf) - 4, "DUH\1", 4);
+    EXPECT_EQ((int)sizeof(buf) - 4, dlt_user_find_userheader(buf, sizeof(buf)));
+
+    // Marker preceded by a partial one
+    memset(buf, 'x', sizeof(buf));
+    memcpy(buf + 2, "DUDUH\1", 6);
+    EXPECT_EQ(4, dlt_user_find_userheader(buf, sizeof(buf)));
+}
+TEST(t_dlt_user_find_userheader, abnormal)
+{
+    char buf[32];
+
+    // No marker at all
+    memset(buf, 'x', sizeof(buf));
+    EXPECT_EQ(-1, dlt_user_find_userheader(buf, sizeof(buf)));
+
+    // Marker split across the end of the buffer
+    memset(buf, 'x', sizeof(buf));
+    memcpy(buf + sizeof(buf) - 2, "DU", 2);
+    EXPECT_EQ(-1, dlt_user_find_userheader(buf, sizeof(buf)));
+    memcpy(buf + sizeof(buf) - 3, "DUH", 3);
+    EXPECT_EQ(-1, dlt_user_find_userheader(buf, sizeof(buf)));
+
+    // Partial markers without a match
+    memset(buf, 'x', sizeof(buf));
+    memcpy(buf, "DUX\1", 4);
+    memcpy(buf + 10, "DUH\2", 4);
+    memcpy(buf + 20, "D\1", 2);
+    EXPECT_EQ(-1, dlt_user_find_userheader(buf, sizeof(buf)));
+
+    // Buffer shorter than a marker
+    EXPECT_EQ(-1, dlt_user_find_userheader("DUH", 3));
+    EXPECT_EQ(-1, dlt_user_find_userheader(buf, 0));
+}
+TEST(t_dlt_user_find_userheader, nullpointer)
+{
+    EXPECT_EQ(-1, dlt_user_find_userheader(NULL, 0));
+    EXPECT_EQ(-1, dlt_user_find_userheader(NULL, 32));
+}
+/* End Method:dlt_user_shared::dlt_user_find_userheader */
+
+
+
 
 /*##############################################################################################################################*/
 /*##############################################################################################################################*/
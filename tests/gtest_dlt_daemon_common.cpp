@@ -26,6 +26,9 @@
 */
 
 #include <stdio.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <gtest/gtest.h>
 
 extern "C" {
@@ -1059,6 +1062,96 @@ TEST(t_dlt_daemon_context_find, nullpointer)
     EXPECT_EQ((DltDaemonContext *) 0 ,dlt_daemon_context_find(&daemon, apid, NULL, NULL, 0));
     EXPECT_EQ((DltDaemonContext *) 0 ,dlt_daemon_context_find(&daemon, NULL, NULL, ecu, 0));
 }
+TEST(t_dlt_daemon_context_find, many)
+{
+    DltDaemon daemon;
+    DltGateway gateway;
+    char desc[255] = "TEST dlt_daemon_context_find";
+    char ecu[] = "ECU1";
+    char apid[5];
+    char ctid[5];
+    DltDaemonContext *daecontext = NULL;
+    DltDaemonRegisteredUsers *user_list = NULL;
+    int num_apps = 5;
+    int num_contexts = 3000;
+    int i, n;
+
+    EXPECT_EQ(0, dlt_daemon_init(&daemon, DLT_DAEMON_RINGBUFFER_MIN_SIZE, DLT_DAEMON_RINGBUFFER_MAX_SIZE, DLT_DAEMON_RINGBUFFER_STEP_SIZE, DLT_RUNTIME_DEFAULT_DIRECTORY,DLT_LOG_INFO, DLT_TRACE_STATUS_OFF,0,0));
+    dlt_set_id(daemon.ecuid, ecu);
+    EXPECT_EQ(0, dlt_daemon_init_user_information(&daemon, &gateway, 0, 0));
+    user_list = &daemon.user_list[0];
+
+    for (i = 0; i < num_apps; i++)
+    {
+        snprintf(apid, sizeof(apid), "AP%02d", i);
+        EXPECT_NE((DltDaemonApplication *) 0, dlt_daemon_application_add(&daemon, apid, 0, desc, 42, ecu, 0));
+    }
+
+    // Add in scrambled order, beyond the initial size of contexts and index
+    for (i = 0; i < num_contexts; i++)
+    {
+        n = (i * 7919) % num_contexts;
+        snprintf(apid, sizeof(apid), "AP%02d", n % num_apps);
+        snprintf(ctid, sizeof(ctid), "%04d", n % 10000);
+        daecontext = dlt_daemon_context_add(&daemon,apid,ctid,DLT_LOG_DEFAULT,DLT_TRACE_STATUS_DEFAULT,0,0,desc,ecu,0);
+        ASSERT_NE((DltDaemonContext *) 0, daecontext);
+        EXPECT_EQ(0, strncmp(ctid, daecontext->ctid, DLT_ID_SIZE));
+    }
+    EXPECT_EQ(num_contexts, user_list->num_contexts);
+
+    // Contexts stay sorted by apid and ctid
+    for (i = 1; i < num_contexts; i++)
+    {
+        EXPECT_GT(0, memcmp(user_list->contexts[i - 1].apid, user_list->contexts[i].apid, 2 * DLT_ID_SIZE));
+    }
+
+    for (i = 0; i < num_contexts; i++)
+    {
+        snprintf(apid, sizeof(apid), "AP%02d", i % num_apps);
+        snprintf(ctid, sizeof(ctid), "%04d", i % 10000);
+        daecontext = dlt_daemon_context_find(&daemon, apid, ctid, ecu, 0);
+        ASSERT_NE((DltDaemonContext *) 0, daecontext);
+        EXPECT_EQ(0, strncmp(apid, daecontext->apid, DLT_ID_SIZE));
+        EXPECT_EQ(0, strncmp(ctid, daecontext->ctid, DLT_ID_SIZE));
+
+        // Not registered for another application
+        snprintf(apid, sizeof(apid), "AP%02d", (i + 1) % num_apps);
+        EXPECT_EQ((DltDaemonContext *) 0, dlt_daemon_context_find(&daemon, apid, ctid, ecu, 0));
+    }
+
+    // Delete every second context
+    for (i = 0; i < num_contexts; i += 2)
+    {
+        snprintf(apid, sizeof(apid), "AP%02d", i % num_apps);
+        snprintf(ctid, sizeof(ctid), "%04d", i % 10000);
+        daecontext = dlt_daemon_context_find(&daemon, apid, ctid, ecu, 0);
+        ASSERT_NE((DltDaemonContext *) 0, daecontext);
+        EXPECT_EQ(0, dlt_daemon_context_del(&daemon, daecontext, ecu, 0));
+    }
+    EXPECT_EQ(num_contexts / 2, user_list->num_contexts);
+
+    for (i = 0; i < num_contexts; i++)
+    {
+        snprintf(apid, sizeof(apid), "AP%02d", i % num_apps);
+        snprintf(ctid, sizeof(ctid), "%04d", i % 10000);
+        daecontext = dlt_daemon_context_find(&daemon, apid, ctid, ecu, 0);
+
+        if (i % 2)
+        {
+            ASSERT_NE((DltDaemonContext *) 0, daecontext);
+            EXPECT_EQ(0, strncmp(ctid, daecontext->ctid, DLT_ID_SIZE));
+        }
+        else
+        {
+            EXPECT_EQ((DltDaemonContext *) 0, daecontext);
+        }
+    }
+
+    EXPECT_LE(0, dlt_daemon_contexts_clear(&daemon, ecu, 0));
+    EXPECT_EQ((DltDaemonContext *) 0, dlt_daemon_context_find(&daemon, apid, ctid, ecu, 0));
+    EXPECT_LE(0, dlt_daemon_applications_clear(&daemon, ecu, 0));
+    EXPECT_EQ(0, dlt_daemon_free(&daemon, 0));
+}
 /* End Method: dlt_daemon_common::dlt_daemon_context_find */
 
 
@@ -1427,6 +1520,102 @@ TEST(t_dlt_daemon_user_send_log_level, normal)
     EXPECT_LE(0, dlt_daemon_applications_clear(&daemon, ecu, 0));
     EXPECT_EQ(0, dlt_daemon_free(&daemon, 0));
 }
+#ifndef DLT_USE_UNIX_SOCKET_IPC
+TEST(t_dlt_daemon_user_send_log_level, log_level_table)
+{
+    DltDaemon daemon;
+    DltGateway gateway;
+    ID4 apid = "TES";
+    ID4 ctid = "CON";
+    char desc[255] = "TEST dlt_daemon_user_send_log_level";
+    char fifo[PATH_MAX];
+    char table_name[PATH_MAX];
+    char other_name[PATH_MAX];
+    char buf[64];
+    struct stat st;
+    DltUserLogLevelTable *table = NULL;
+    DltDaemonContext *daecontext = NULL;
+    DltDaemonApplication *app = NULL;
+    char ecu[] = "ECU1";
+    uint32_t generation;
+    int fifo_fd, table_fd, other_fd;
+
+    // Set up FIFO like an application, a link placed as table must not be used
+    mkdir(DLT_USER_DIR, S_IRWXU | S_IRWXG | S_IRWXO);
+    ASSERT_GT((int) sizeof(fifo), snprintf(fifo, sizeof(fifo), "%s/dltpipes/dlt%d", dltFifoBaseDir, getpid()));
+    ASSERT_GT((int) sizeof(table_name),
+              snprintf(table_name, sizeof(table_name), "%s%s", fifo, DLT_USER_LOG_LEVEL_TABLE_SUFFIX));
+    ASSERT_GT((int) sizeof(other_name), snprintf(other_name, sizeof(other_name), "%s.other", fifo));
+    unlink(fifo);
+    unlink(table_name);
+    unlink(other_name);
+    ASSERT_EQ(0, mkfifo(fifo, S_IRUSR | S_IWUSR));
+    fifo_fd = open(fifo, O_RDWR | O_NONBLOCK);
+    ASSERT_LE(0, fifo_fd);
+    other_fd = open(other_name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    ASSERT_LE(0, other_fd);
+    close(other_fd);
+    ASSERT_EQ(0, link(other_name, table_name));
+
+    EXPECT_EQ(0, dlt_daemon_init(&daemon, DLT_DAEMON_RINGBUFFER_MIN_SIZE, DLT_DAEMON_RINGBUFFER_MAX_SIZE, DLT_DAEMON_RINGBUFFER_STEP_SIZE, DLT_RUNTIME_DEFAULT_DIRECTORY,DLT_LOG_INFO, DLT_TRACE_STATUS_OFF,0,0));
+    dlt_set_id(daemon.ecuid, ecu);
+    EXPECT_EQ(0, dlt_daemon_init_user_information(&daemon, &gateway, 0, 0));
+    app = dlt_daemon_application_add(&daemon, apid, getpid(), desc, 0, ecu, 0);
+    ASSERT_NE((DltDaemonApplication *) 0, app);
+    EXPECT_NE((DltUserLogLevelTable *) 0, app->log_level_table);
+
+    // Daemon created its own table, read-only for others, the linked file is untouched
+    ASSERT_EQ(0, stat(other_name, &st));
+    EXPECT_EQ(0, st.st_size);
+    EXPECT_EQ(1, (int)st.st_nlink);
+    ASSERT_EQ(0, lstat(table_name, &st));
+    EXPECT_TRUE(S_ISREG(st.st_mode));
+    EXPECT_EQ((off_t)sizeof(DltUserLogLevelTable), st.st_size);
+    EXPECT_EQ(0, (int)(st.st_mode & (S_IWGRP | S_IWOTH)));
+
+    // Map it like the application
+    table_fd = open(table_name, O_RDONLY);
+    ASSERT_LE(0, table_fd);
+    table = (DltUserLogLevelTable *)mmap(NULL, sizeof(DltUserLogLevelTable), PROT_READ, MAP_SHARED, table_fd, 0);
+    ASSERT_NE(MAP_FAILED, (void *)table);
+    close(table_fd);
+    EXPECT_EQ(DLT_LOG_INFO, table->entries[2].log_level);
+    EXPECT_EQ(DLT_TRACE_STATUS_OFF, table->entries[2].trace_status);
+
+    daecontext = dlt_daemon_context_add(&daemon,apid,ctid,DLT_LOG_WARN,DLT_TRACE_STATUS_ON,3,app->user_handle,desc,ecu,0);
+    ASSERT_NE((DltDaemonContext *) 0, daecontext);
+
+    // First change is stored and sent, the application maps the table on receiving it
+    generation = table->generation;
+    EXPECT_EQ(0, dlt_daemon_user_send_log_level(&daemon, daecontext, 0));
+    EXPECT_EQ(DLT_LOG_WARN, table->entries[3].log_level);
+    EXPECT_EQ(DLT_TRACE_STATUS_ON, table->entries[3].trace_status);
+    EXPECT_NE(generation, table->generation);
+    EXPECT_EQ((ssize_t)(sizeof(DltUserHeader) + sizeof(DltUserControlMsgLogLevel)), read(fifo_fd, buf, sizeof(buf)));
+
+    // Further changes only in place
+    generation = table->generation;
+    daecontext->log_level = DLT_LOG_VERBOSE;
+    EXPECT_EQ(0, dlt_daemon_user_send_log_level(&daemon, daecontext, 0));
+    EXPECT_EQ(DLT_LOG_VERBOSE, table->entries[3].log_level);
+    EXPECT_EQ(DLT_LOG_INFO, table->entries[2].log_level);
+    EXPECT_NE(generation, table->generation);
+    EXPECT_GE(0, read(fifo_fd, buf, sizeof(buf)));
+
+    // Table is removed with the application
+    EXPECT_LE(0, dlt_daemon_context_del(&daemon, daecontext, ecu, 0));
+    EXPECT_LE(0, dlt_daemon_application_del(&daemon, app, ecu, 0));
+    EXPECT_EQ(-1, lstat(table_name, &st));
+    EXPECT_LE(0, dlt_daemon_contexts_clear(&daemon, ecu, 0));
+    EXPECT_LE(0, dlt_daemon_applications_clear(&daemon, ecu, 0));
+    EXPECT_EQ(0, dlt_daemon_free(&daemon, 0));
+
+    munmap(table, sizeof(DltUserLogLevelTable));
+    close(fifo_fd);
+    unlink(fifo);
+    unlink(other_name);
+}
+#endif
 TEST(t_dlt_daemon_user_send_log_level, abnormal)
 {
 //    DltDaemon daemon;
@@ -94,6 +94,7 @@ extern "C"
     #include "dlt_config_file_parser.h"
     #include "dlt_common.h"
     #include "dlt_daemon_client.h"
+    #include "dlt_daemon_socket.h"
 }
 
 /* Begin Method: dlt_daemon_event_handler::t_dlt_daemon_prepare_event_handling*/
@@ -313,12 +314,22 @@ TEST(t_dlt_event_handler_unregister_connection, normal)
 /* Begin Method: dlt_daemon_connections::dlt_connection_create*/
 TEST(t_dlt_connection_create, normal)
 {
-    int fd = 1;
+    int fds[2];
+    int fd;
     int ret = 0;
 
+    /* the connection closes its fd when it is destroyed */
+    ASSERT_EQ(0, pipe(fds));
+    fd = fds[0];
+
     DltDaemonLocal daemon_local;
     DltConnection connections;
     DltReceiver receiver;
+    memset(&daemon_local, 0, sizeof(DltDaemonLocal));
+    memset(&connections, 0, sizeof(DltConnection));
+    memset(&receiver, 0, sizeof(DltReceiver));
+    connections.next = NULL;
+    receiver.fd = -1;
     daemon_local.pEvent.connections = &connections;
     daemon_local.pEvent.connections->receiver = &receiver;
     daemon_local.pEvent.epfd =  epoll_create(5);
@@ -329,6 +340,13 @@ TEST(t_dlt_connection_create, normal)
                                 EPOLLIN,
                                 DLT_CONNECTION_CLIENT_MSG_SERIAL);
     EXPECT_EQ(DLT_RETURN_OK, ret);
+    EXPECT_TRUE(connections.next != NULL);
+
+    ret = dlt_event_handler_unregister_connection(&daemon_local.pEvent, &daemon_local, fd);
+    EXPECT_EQ(DLT_RETURN_OK, ret);
+    EXPECT_TRUE(connections.next == NULL);
+    close(daemon_local.pEvent.epfd);
+    close(fds[1]);
 }
 
 /* Begin Method: dlt_daemon_connections::dlt_connection_destroy*/
@@ -570,6 +588,61 @@ TEST(t_dlt_connection_send_multiple, nullpointer)
     EXPECT_EQ(DLT_RETURN_ERROR, ret);
 }
 
+/* Begin Method: dlt_daemon_socket::t_dlt_daemon_socket_queue*/
+TEST(t_dlt_daemon_socket_queue, watermarks)
+{
+    DltDaemonSocketQueue queue;
+    char data[1000];
+    int fds[2];
+    int i;
+
+    memset(data, 0, sizeof(data));
+    EXPECT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    EXPECT_EQ(DLT_DAEMON_ERROR_OK,
+              dlt_daemon_socket_queue_init(&queue, 16384, 8000, 4000));
+
+    /* fill up to the high watermark */
+    for (i = 0; i < 8; i++)
+    {
+        EXPECT_EQ(DLT_DAEMON_ERROR_OK,
+                  dlt_daemon_socket_queue_add(&queue, data, sizeof(data), NULL, 0, 0));
+    }
+    EXPECT_EQ(8000, queue.used);
+    EXPECT_EQ(0, queue.degraded);
+
+    /* exceeding it degrades the client */
+    EXPECT_EQ(DLT_DAEMON_ERROR_BUFFER_FULL,
+              dlt_daemon_socket_queue_add(&queue, data, sizeof(data), NULL, 0, 0));
+    EXPECT_EQ(1, queue.degraded);
+
+    /* messages fitting again are still dropped while degraded */
+    EXPECT_EQ(DLT_DAEMON_ERROR_BUFFER_FULL,
+              dlt_daemon_socket_queue_add(&queue, data, 10, NULL, 0, 0));
+    EXPECT_EQ(2u, queue.dropped);
+
+    /* sending down to the low watermark recovers the client */
+    EXPECT_EQ(DLT_DAEMON_ERROR_OK, dlt_daemon_socket_queue_flush(fds[0], &queue));
+    EXPECT_EQ(0, queue.used);
+    EXPECT_EQ(0, queue.degraded);
+    EXPECT_EQ(DLT_DAEMON_ERROR_OK,
+              dlt_daemon_socket_queue_add(&queue, data, sizeof(data), NULL, 0, 0));
+
+    dlt_daemon_socket_queue_free(&queue);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(t_dlt_daemon_socket_queue, nullpointer)
+{
+    DltDaemonSocketQueue queue;
+
+    EXPECT_EQ(DLT_DAEMON_ERROR_UNKNOWN, dlt_daemon_socket_queue_init(NULL, 16384, 8000, 4000));
+    EXPECT_EQ(DLT_DAEMON_ERROR_UNKNOWN, dlt_daemon_socket_queue_init(&queue, 16384, 20000, 4000));
+    EXPECT_EQ(DLT_DAEMON_ERROR_UNKNOWN, dlt_daemon_socket_queue_init(&queue, 16384, 4000, 8000));
+    EXPECT_EQ(DLT_DAEMON_ERROR_UNKNOWN, dlt_daemon_socket_queue_add(NULL, NULL, 0, NULL, 0, 0));
+    EXPECT_EQ(DLT_DAEMON_ERROR_UNKNOWN, dlt_daemon_socket_queue_flush(0, NULL));
+}
+
 int connectServer(void)
 {
     int sockfd, portno;
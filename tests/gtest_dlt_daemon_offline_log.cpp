@@ -0,0 +1,774 @@
+/*
+ * @licence app begin@
+ * SPDX license identifier: MPL-2.0
+ *
+ * Copyright (C) 2011-2015, BMW AG
+ *
+ * This file is part of GENIVI Project DLT - Diagnostic Log and Trace.
+ *
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License (MPL), v. 2.0.
+ * If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * For further information see http://www.genivi.org/.
+ * @licence end@
+ */
+
+/*!
+ * \copyright Copyright © 2011-2015 BMW AG. \n
+ * License MPL-2.0: Mozilla Public License version 2.0 http://mozilla.org/MPL/2.0/.
+ *
+ * \file gtest_dlt_daemon_offline_log.cpp
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include <gtest/gtest.h>
+
+extern "C" {
+#include "dlt_common.h"
+#include "dlt_offline_logstorage.h"
+#include "dlt_offline_logstorage_behavior.h"
+#include "dlt_offline_trace.h"
+#include "dlt_daemon_storage.h"
+}
+
+/* Create an empty directory used as mount point of a logstorage device */
+static void offline_log_mkdir(char *path, size_t size)
+{
+    snprintf(path, size, "/tmp/dlt_offline_log_XXXXXX");
+    ASSERT_TRUE(mkdtemp(path) != NULL);
+}
+
+/* Remove a directory and the files in it */
+static void offline_log_rmdir(const char *path)
+{
+    char name[PATH_MAX];
+    struct dirent *entry;
+    DIR *dir = opendir(path);
+
+    if (dir == NULL)
+    {
+        return;
+    }
+
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (entry->d_name[0] != '.')
+        {
+            snprintf(name, sizeof(name), "%s/%s", path, entry->d_name);
+            unlink(name);
+        }
+    }
+
+    closedir(dir);
+    rmdir(path);
+}
+
+/* Number of files in a directory and their total size */
+static int offline_log_count(const char *path, unsigned long *size)
+{
+    char name[PATH_MAX];
+    struct dirent *entry;
+    struct stat st;
+    int num = 0;
+    DIR *dir = opendir(path);
+
+    if (size != NULL)
+    {
+        *size = 0;
+    }
+
+    if (dir == NULL)
+    {
+        return -1;
+    }
+
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (entry->d_name[0] == '.')
+        {
+            continue;
+        }
+
+        if ((snprintf(name, sizeof(name), "%s/%s", path, entry->d_name) < (int)sizeof(name)) &&
+            (stat(name, &st) == 0) && (size != NULL))
+        {
+            *size += st.st_size;
+        }
+
+        num++;
+    }
+
+    closedir(dir);
+
+    return num;
+}
+
+/* Path of an index based offline trace file */
+static int offline_trace_name(char *name, size_t size, const char *path, unsigned int idx)
+{
+    char file[DLT_OFFLINETRACE_FILENAME_MAX_SIZE];
+
+    dlt_offline_trace_file_name(file, (char *)DLT_OFFLINETRACE_FILENAME_BASE, idx);
+
+    if (snprintf(name, size, "%s/%s", path, file) >= (int)size)
+    {
+        return 0;
+    }
+
+    return 1;
+}
+
+/* Check if an index based offline trace file exists */
+static int offline_trace_exists(const char *path, unsigned int idx)
+{
+    char name[PATH_MAX];
+
+    return offline_trace_name(name, sizeof(name), path, idx) && (access(name, F_OK) == 0);
+}
+
+/* Write the logstorage configuration of a device */
+static void offline_log_write_config(const char *path, const char *config)
+{
+    char name[PATH_MAX];
+    FILE *file;
+
+    snprintf(name, sizeof(name), "%s/%s", path, DLT_OFFLINE_LOGSTORAGE_CONFIG_FILE_NAME);
+    file = fopen(name, "w");
+    ASSERT_TRUE(file != NULL);
+    fputs(config, file);
+    fclose(file);
+}
+
+/* Connect a device with the given configuration */
+static void offline_log_connect(DltLogStorage *handle, char *path, const char *config)
+{
+    memset(handle, 0, sizeof(DltLogStorage));
+    offline_log_write_config(path, config);
+    ASSERT_EQ(0, dlt_logstorage_device_connected(handle, path));
+    ASSERT_EQ(0, dlt_logstorage_load_config(handle));
+}
+
+/* Number of filters matching apid and ctid */
+static int offline_log_match(DltLogStorage *handle, const char *apid, const char *ctid)
+{
+    DltLogStorageConfigData **config;
+    int num = 0;
+
+    config = dlt_logstorage_get_config(handle, (char *)apid, (char *)ctid, &num);
+    free(config);
+
+    return num;
+}
+
+/* Size of the messages written by offline_log_write_msg() */
+#define OFFLINE_LOG_MSG_SIZE 100
+
+/* User configuration of log file names, <name>_<index>.dlt */
+static void offline_log_user_config(DltLogStorageUserConfig *uconfig, unsigned int maxcounter)
+{
+    memset(uconfig, 0, sizeof(DltLogStorageUserConfig));
+    uconfig->logfile_timestamp = 0;
+    uconfig->logfile_delimiter = '_';
+    uconfig->logfile_maxcounter = maxcounter;
+    uconfig->logfile_counteridxlen = 3;
+}
+
+/* Write a log message with the number num as payload */
+static int offline_log_write_msg(DltLogStorage *handle,
+                                 DltLogStorageUserConfig *uconfig,
+                                 const char *apid,
+                                 const char *ctid,
+                                 int num)
+{
+    DltStorageHeader storage;
+    unsigned char header[sizeof(DltStandardHeader) + DLT_ID_SIZE + sizeof(DltExtendedHeader)];
+    unsigned char payload[OFFLINE_LOG_MSG_SIZE - sizeof(DltStorageHeader) - sizeof(header)];
+    DltStandardHeader *standard = (DltStandardHeader *)header;
+    DltExtendedHeader *extended = (DltExtendedHeader *)(header + sizeof(DltStandardHeader) + DLT_ID_SIZE);
+
+    memset(header, 0, sizeof(header));
+    memset(payload, 0, sizeof(payload));
+    dlt_set_storageheader(&storage, "ECU1");
+    standard->htyp = DLT_HTYP_UEH | DLT_HTYP_WEID | DLT_HTYP_PROTOCOL_VERSION1;
+    standard->len = DLT_HTOBE_16(sizeof(header) + sizeof(payload));
+    dlt_set_id((char *)(header + sizeof(DltStandardHeader)), "ECU1");
+    extended->msin = DLT_MSIN_VERB | (DLT_TYPE_LOG << DLT_MSIN_MSTP_SHIFT) | (DLT_LOG_INFO << DLT_MSIN_MTIN_SHIFT);
+    extended->noar = 1;
+    dlt_set_id(extended->apid, apid);
+    dlt_set_id(extended->ctid, ctid);
+    snprintf((char *)payload, sizeof(payload), "%04d", num % 10000);
+
+    return dlt_logstorage_write(handle,
+                                uconfig,
+                                (unsigned char *)&storage,
+                                sizeof(storage),
+                                header,
+                                sizeof(header),
+                                payload,
+                                sizeof(payload));
+}
+
+/* Size of a file in a directory, -1 if it does not exist */
+static long offline_log_file_size(const char *path, const char *file)
+{
+    char name[PATH_MAX];
+    struct stat st;
+
+    if ((snprintf(name, sizeof(name), "%s/%s", path, file) >= (int)sizeof(name)) ||
+        (stat(name, &st) != 0))
+    {
+        return -1;
+    }
+
+    return st.st_size;
+}
+
+/* Number of messages in a log file, -1 if it cannot be read */
+static int offline_log_file_messages(const char *path, const char *file)
+{
+    char name[PATH_MAX];
+    DltFile dlt_file;
+    int num = -1;
+
+    if (snprintf(name, sizeof(name), "%s/%s", path, file) >= (int)sizeof(name))
+    {
+        return -1;
+    }
+
+    dlt_file_init(&dlt_file, 0);
+
+    if (dlt_file_open(&dlt_file, name, 0) >= DLT_RETURN_OK)
+    {
+        while (dlt_file_read(&dlt_file, 0) >= 0)
+        {
+        }
+
+        num = dlt_file.counter;
+    }
+
+    dlt_file_free(&dlt_file, 0);
+
+    return num;
+}
+
+static const char *offline_log_filters =
+    "[FILTER1]\n"
+    "LogAppName=APP1\n"
+    "ContextName=CON1\n"
+    "LogLevel=DLT_LOG_VERBOSE\n"
+    "File=exact\n"
+    "FileSize=10000\n"
+    "NOFiles=2\n"
+    "\n"
+    "[FILTER2]\n"
+    "LogAppName=APP2\n"
+    "ContextName=.*\n"
+    "LogLevel=DLT_LOG_VERBOSE\n"
+    "File=app\n"
+    "FileSize=10000\n"
+    "NOFiles=2\n"
+    "\n"
+    "[FILTER3]\n"
+    "LogAppName=.*\n"
+    "ContextName=CON3\n"
+    "LogLevel=DLT_LOG_VERBOSE\n"
+    "File=ctx\n"
+    "FileSize=10000\n"
+    "NOFiles=2\n";
+
+/* Begin Method:dlt_offline_logstorage::dlt_logstorage_get_config */
+TEST(t_dlt_logstorage_get_config, normal)
+{
+    DltLogStorage handle;
+    char path[PATH_MAX];
+
+    offline_log_mkdir(path, sizeof(path));
+    offline_log_connect(&handle, path, offline_log_filters);
+
+    /* exact match, application only and context only */
+    EXPECT_EQ(1, offline_log_match(&handle, "APP1", "CON1"));
+    EXPECT_EQ(1, offline_log_match(&handle, "APP2", "ANY"));
+    EXPECT_EQ(1, offline_log_match(&handle, "ANY", "CON3"));
+    /* apid:, :ctid and apid:ctid at once */
+    EXPECT_EQ(2, offline_log_match(&handle, "APP2", "CON3"));
+    /* no match, ids are compared as strings of up to 4 characters */
+    EXPECT_EQ(0, offline_log_match(&handle, "APP1", "CON2"));
+    EXPECT_EQ(0, offline_log_match(&handle, "APP", "CON1"));
+    EXPECT_EQ(0, offline_log_match(&handle, "", ""));
+
+    /* second lookup of each combination is answered from the cache */
+    EXPECT_EQ(1, offline_log_match(&handle, "APP1", "CON1"));
+    EXPECT_EQ(2, offline_log_match(&handle, "APP2", "CON3"));
+    EXPECT_EQ(0, offline_log_match(&handle, "APP1", "CON2"));
+
+    EXPECT_EQ(0, dlt_logstorage_device_disconnected(&handle, DLT_LOGSTORAGE_SYNC_ON_DEVICE_DISCONNECT));
+    offline_log_rmdir(path);
+}
+TEST(t_dlt_logstorage_get_config, cache)
+{
+    DltLogStorage handle;
+    char path[PATH_MAX];
+    char ctid[DLT_ID_SIZE + 1];
+    unsigned int used;
+
+    offline_log_mkdir(path, sizeof(path));
+    offline_log_connect(&handle, path, offline_log_filters);
+    used = handle.filter_table_used;
+
+    /* combinations without filter are cached as well */
+    EXPECT_EQ(0, offline_log_match(&handle, "NONE", "NONE"));
+    EXPECT_EQ(used + 1, handle.filter_table_used);
+    EXPECT_EQ(1u, handle.filter_table_cached);
+    EXPECT_EQ(0, offline_log_match(&handle, "NONE", "NONE"));
+    EXPECT_EQ(used + 1, handle.filter_table_used);
+
+    /* the table grows with the cached combinations */
+    for (int i = 0; i < 500; i++)
+    {
+        snprintf(ctid, sizeof(ctid), "%04d", i % 10000);
+        EXPECT_EQ((i % 2 == 0) ? 1 : 0, offline_log_match(&handle, (i % 2 == 0) ? "APP2" : "APP3", ctid));
+    }
+    EXPECT_LT((unsigned int)DLT_OFFLINE_LOGSTORAGE_FILTER_TABLE_SIZE, handle.filter_table_size);
+    EXPECT_EQ(501u, handle.filter_table_cached);
+    EXPECT_EQ(1, offline_log_match(&handle, "APP1", "CON1"));
+    EXPECT_EQ(1, offline_log_match(&handle, "APP2", "0000"));
+
+    /* the cache is bounded, configured filters survive clearing it */
+    for (int i = 0; i < 4 * DLT_OFFLINE_LOGSTORAGE_FILTER_CACHE_MAX; i++)
+    {
+        snprintf(ctid, sizeof(ctid), "%04d", i % 10000);
+        EXPECT_EQ(0, offline_log_match(&handle, "APP4", ctid));
+        EXPECT_GE((unsigned int)DLT_OFFLINE_LOGSTORAGE_FILTER_CACHE_MAX, handle.filter_table_cached);
+    }
+    EXPECT_GE(4u * DLT_OFFLINE_LOGSTORAGE_FILTER_CACHE_MAX, handle.filter_table_size);
+    EXPECT_EQ(1, offline_log_match(&handle, "APP1", "CON1"));
+    EXPECT_EQ(1, offline_log_match(&handle, "APP2", "0000"));
+    EXPECT_EQ(1, offline_log_match(&handle, "ANY", "CON3"));
+    EXPECT_EQ(DLT_LOG_VERBOSE, dlt_logstorage_get_loglevel_by_key(&handle, (char *)"APP1:CON1"));
+
+    EXPECT_EQ(0, dlt_logstorage_device_disconnected(&handle, DLT_LOGSTORAGE_SYNC_ON_DEVICE_DISCONNECT));
+    offline_log_rmdir(path);
+}
+TEST(t_dlt_logstorage_get_config, removed)
+{
+    DltLogStorage handle;
+    char path[PATH_MAX];
+
+    offline_log_mkdir(path, sizeof(path));
+    offline_log_connect(&handle, path, offline_log_filters);
+    EXPECT_EQ(1, offline_log_match(&handle, "APP1", "CON1"));
+    EXPECT_EQ(0, offline_log_match(&handle, "APP5", "CON5"));
+    EXPECT_EQ(0, dlt_logstorage_device_disconnected(&handle, DLT_LOGSTORAGE_SYNC_ON_DEVICE_DISCONNECT));
+
+    /* cached matches and misses do not outlive the configuration */
+    offline_log_connect(&handle, path,
+                        "[FILTER1]\n"
+                        "LogAppName=APP5\n"
+                        "ContextName=CON5\n"
+                        "LogLevel=DLT_LOG_VERBOSE\n"
+                        "File=other\n"
+                        "FileSize=10000\n"
+                        "NOFiles=2\n");
+    EXPECT_EQ(0, offline_log_match(&handle, "APP1", "CON1"));
+    EXPECT_EQ(0, offline_log_match(&handle, "APP2", "CON3"));
+    EXPECT_EQ(1, offline_log_match(&handle, "APP5", "CON5"));
+    EXPECT_EQ(-1, dlt_logstorage_get_loglevel_by_key(&handle, (char *)"APP1:CON1"));
+
+    EXPECT_EQ(0, dlt_logstorage_device_disconnected(&handle, DLT_LOGSTORAGE_SYNC_ON_DEVICE_DISCONNECT));
+    EXPECT_EQ(0, offline_log_match(&handle, "APP5", "CON5"));
+    offline_log_rmdir(path);
+}
+TEST(t_dlt_logstorage_get_config, nullpointer)
+{
+    DltLogStorage handle;
+    int num = 0;
+
+    memset(&handle, 0, sizeof(DltLogStorage));
+    EXPECT_TRUE(dlt_logstorage_get_config(NULL, (char *)"APP1", (char *)"CON1", &num) == NULL);
+    EXPECT_TRUE(dlt_logstorage_get_config(&handle, (char *)"APP1", (char *)"CON1", &num) == NULL);
+    EXPECT_EQ(0, num);
+}
+/* End Method:dlt_offline_logstorage::dlt_logstorage_get_config */
+
+
+/* Begin Method:dlt_offline_logstorage::dlt_logstorage_write */
+static const char *offline_log_ring =
+    "[FILTER1]\n"
+    "LogAppName=APP1\n"
+    "ContextName=.*\n"
+    "LogLevel=DLT_LOG_VERBOSE\n"
+    "File=ring\n"
+    "FileSize=1000\n"
+    "NOFiles=3\n";
+
+TEST(t_dlt_logstorage_write, ring)
+{
+    DltLogStorage handle;
+    DltLogStorageUserConfig uconfig;
+    DltLogStorageFileList *records;
+    char path[PATH_MAX];
+    int i;
+
+    offline_log_mkdir(path, sizeof(path));
+    offline_log_user_config(&uconfig, 5);
+    offline_log_connect(&handle, path, offline_log_ring);
+    records = &handle.config_data[0].data.records;
+
+    /* 9 messages fit into a file, 12 files are created, their index wraps
+     * after 5 and only the newest 3 files are kept */
+    for (i = 0; i < 108; i++)
+    {
+        ASSERT_EQ(0, offline_log_write_msg(&handle, &uconfig, "APP1", "CON1", i));
+    }
+
+    EXPECT_EQ(3u, records->num);
+    EXPECT_EQ(4u, records->max);
+    EXPECT_STREQ("ring_005.dlt", records->files[records->first].name);
+    EXPECT_STREQ("ring_002.dlt", records->files[(records->first + 2) % records->max].name);
+    EXPECT_EQ(4, offline_log_count(path, NULL)); /* and dlt_logstorage.conf */
+    EXPECT_EQ(9 * OFFLINE_LOG_MSG_SIZE, offline_log_file_size(path, "ring_005.dlt"));
+    EXPECT_EQ(9 * OFFLINE_LOG_MSG_SIZE, offline_log_file_size(path, "ring_001.dlt"));
+    EXPECT_EQ(9 * OFFLINE_LOG_MSG_SIZE, offline_log_file_size(path, "ring_002.dlt"));
+    EXPECT_EQ(-1, offline_log_file_size(path, "ring_003.dlt"));
+    EXPECT_EQ(-1, offline_log_file_size(path, "ring_004.dlt"));
+
+    EXPECT_EQ(0, dlt_logstorage_device_disconnected(&handle, DLT_LOGSTORAGE_SYNC_ON_DEVICE_DISCONNECT));
+    offline_log_rmdir(path);
+}
+TEST(t_dlt_logstorage_write, oldest)
+{
+    DltLogStorage handle;
+    DltLogStorageUserConfig uconfig;
+    DltLogStorageFileList *records;
+    char path[PATH_MAX];
+    int i;
+
+    offline_log_mkdir(path, sizeof(path));
+    offline_log_user_config(&uconfig, 5);
+    offline_log_connect(&handle, path, offline_log_ring);
+
+    for (i = 0; i < 108; i++)
+    {
+        ASSERT_EQ(0, offline_log_write_msg(&handle, &uconfig, "APP1", "CON1", i));
+    }
+
+    EXPECT_EQ(0, dlt_logstorage_device_disconnected(&handle, DLT_LOGSTORAGE_SYNC_ON_DEVICE_DISCONNECT));
+
+    /* files read again after the index wrapped, the oldest one follows the gap */
+    offline_log_connect(&handle, path, offline_log_ring);
+    records = &handle.config_data[0].data.records;
+    ASSERT_EQ(0, offline_log_write_msg(&handle, &uconfig, "APP1", "CON1", i));
+
+    EXPECT_EQ(3u, records->num);
+    EXPECT_STREQ("ring_001.dlt", records->files[records->first].name);
+    EXPECT_STREQ("ring_003.dlt", records->files[(records->first + 2) % records->max].name);
+    EXPECT_EQ(-1, offline_log_file_size(path, "ring_005.dlt"));
+    EXPECT_EQ(9 * OFFLINE_LOG_MSG_SIZE, offline_log_file_size(path, "ring_001.dlt"));
+    EXPECT_EQ(9 * OFFLINE_LOG_MSG_SIZE, offline_log_file_size(path, "ring_002.dlt"));
+    EXPECT_EQ(OFFLINE_LOG_MSG_SIZE, offline_log_file_size(path, "ring_003.dlt"));
+
+    EXPECT_EQ(0, dlt_logstorage_device_disconnected(&handle, DLT_LOGSTORAGE_SYNC_ON_DEVICE_DISCONNECT));
+    offline_log_rmdir(path);
+}
+TEST(t_dlt_logstorage_write, group_commit)
+{
+    DltLogStorage handle;
+    DltLogStorageUserConfig uconfig;
+    char path[PATH_MAX];
+    int i;
+
+    offline_log_mkdir(path, sizeof(path));
+    offline_log_user_config(&uconfig, 999);
+    offline_log_connect(&handle, path,
+                        "[FILTER1]\n"
+                        "LogAppName=APP1\n"
+                        "ContextName=.*\n"
+                        "LogLevel=DLT_LOG_VERBOSE\n"
+                        "File=group\n"
+                        "FileSize=100000\n"
+                        "NOFiles=2\n"
+                        "SyncBehavior=ON_GROUP_COMMIT\n"
+                        "GroupCommitSize=100000\n"
+                        "GroupCommitInterval=60000\n");
+
+    /* messages are collected until the commit is due */
+    for (i = 0; i < 25; i++)
+    {
+        ASSERT_EQ(0, offline_log_write_msg(&handle, &uconfig, "APP1", "CON1", i));
+    }
+
+    EXPECT_GE(0, offline_log_file_size(path, "group_001.dlt"));
+    EXPECT_EQ(0, dlt_logstorage_commit_due(&handle, 0));
+    EXPECT_GE(0, offline_log_file_size(path, "group_001.dlt"));
+
+    /* the commit writes every collected message */
+    EXPECT_EQ(0, dlt_logstorage_commit_due(&handle, 60000));
+    EXPECT_EQ(25 * OFFLINE_LOG_MSG_SIZE, offline_log_file_size(path, "group_001.dlt"));
+    EXPECT_EQ(25, offline_log_file_messages(path, "group_001.dlt"));
+
+    /* so does disconnecting the device */
+    for (i = 25; i < 30; i++)
+    {
+        ASSERT_EQ(0, offline_log_write_msg(&handle, &uconfig, "APP1", "CON1", i));
+    }
+
+    EXPECT_EQ(0, dlt_logstorage_device_disconnected(&handle, DLT_LOGSTORAGE_SYNC_ON_DEVICE_DISCONNECT));
+    EXPECT_EQ(30, offline_log_file_messages(path, "group_001.dlt"));
+
+    offline_log_rmdir(path);
+}
+TEST(t_dlt_logstorage_write, cache)
+{
+    DltLogStorage handle;
+    DltLogStorageUserConfig uconfig;
+    char path[PATH_MAX];
+    int steps = 0;
+    int i;
+
+    offline_log_mkdir(path, sizeof(path));
+    offline_log_user_config(&uconfig, 999);
+    /* set by the daemon on startup */
+    g_logstorage_cache_max = 100000;
+    offline_log_connect(&handle, path,
+                        "[FILTER1]\n"
+                        "LogAppName=APP1\n"
+                        "ContextName=.*\n"
+                        "LogLevel=DLT_LOG_VERBOSE\n"
+                        "File=cache\n"
+                        "FileSize=10000\n"
+                        "NOFiles=2\n"
+                        "SyncBehavior=ON_DEMAND\n");
+
+    /* messages stay in the cache until it is synced */
+    for (i = 0; i < 50; i++)
+    {
+        ASSERT_EQ(0, offline_log_write_msg(&handle, &uconfig, "APP1", "CON1", i));
+    }
+
+    EXPECT_GE(0, offline_log_file_size(path, "cache_001.dlt"));
+
+    /* synced data is written in steps, until every message is written */
+    EXPECT_EQ(0, dlt_logstorage_sync_caches(&handle));
+
+    while (dlt_logstorage_flush_caches(1000))
+    {
+        steps++;
+    }
+
+    EXPECT_LT(1, steps);
+    EXPECT_EQ(50 * OFFLINE_LOG_MSG_SIZE, offline_log_file_size(path, "cache_001.dlt"));
+    EXPECT_EQ(50, offline_log_file_messages(path, "cache_001.dlt"));
+
+    EXPECT_EQ(0, dlt_logstorage_device_disconnected(&handle, DLT_LOGSTORAGE_SYNC_ON_DEVICE_DISCONNECT));
+    offline_log_rmdir(path);
+}
+/* End Method:dlt_offline_logstorage::dlt_logstorage_write */
+
+/* Begin Method:dlt_daemon_storage::dlt_daemon_storage_write */
+TEST(t_dlt_daemon_storage_write, dropped)
+{
+    DltDaemon daemon;
+    DltDaemonStorage storage;
+    DltOfflineTrace trace;
+    DltLogStorageUserConfig uconfig;
+    char path[PATH_MAX];
+    char name[DLT_OFFLINETRACE_FILENAME_MAX_SIZE];
+    unsigned char data[OFFLINE_LOG_MSG_SIZE];
+    int i;
+
+    offline_log_mkdir(path, sizeof(path));
+    offline_log_user_config(&uconfig, 999);
+    memset(&daemon, 0, sizeof(daemon));
+    memset(&trace, 0, sizeof(trace));
+    memset(data, 0, sizeof(data));
+    ASSERT_EQ(DLT_RETURN_OK, dlt_offline_trace_init(&trace, path, 100000, 1000000, 0));
+    ASSERT_EQ(0, dlt_daemon_storage_init(&storage, &daemon, &trace, &uconfig, 0, 4, 0));
+    ASSERT_EQ(1, storage.running);
+    ASSERT_EQ(4u, storage.queues[DLT_DAEMON_STORAGE_OFFLINE_TRACE].size);
+
+    /* the storage thread cannot take messages while the lock is held,
+     * a full queue drops messages and counts them */
+    dlt_daemon_storage_lock(&storage);
+
+    for (i = 0; i < 10; i++)
+    {
+        EXPECT_EQ(0, dlt_daemon_storage_write(&storage, 1, 0, data, sizeof(data), NULL, 0, NULL, 0));
+    }
+
+    EXPECT_EQ(6u, storage.queues[DLT_DAEMON_STORAGE_OFFLINE_TRACE].dropped);
+
+    /* a write for another target does not count for the full queue */
+    EXPECT_EQ(0, dlt_daemon_storage_write(&storage, 0, 0, data, sizeof(data), NULL, 0, NULL, 0));
+    EXPECT_EQ(6u, storage.queues[DLT_DAEMON_STORAGE_OFFLINE_TRACE].dropped);
+
+    dlt_daemon_storage_unlock(&storage);
+
+    /* queued messages are written before the thread terminates */
+    dlt_daemon_storage_free(&storage, 0);
+    EXPECT_EQ(DLT_RETURN_OK, dlt_offline_trace_free(&trace));
+
+    dlt_offline_trace_file_name(name, (char *)DLT_OFFLINETRACE_FILENAME_BASE, 1);
+    EXPECT_EQ(4 * OFFLINE_LOG_MSG_SIZE, offline_log_file_size(path, name));
+
+    offline_log_rmdir(path);
+}
+/* End Method:dlt_daemon_storage::dlt_daemon_storage_write */
+
+/* Begin Method:dlt_offline_trace::dlt_offline_trace_write */
+TEST(t_dlt_offline_trace_write, ring)
+{
+    DltOfflineTrace trace;
+    char path[PATH_MAX];
+    char name[PATH_MAX];
+    unsigned char data[100];
+    unsigned long size;
+    FILE *file;
+    int i;
+
+    offline_log_mkdir(path, sizeof(path));
+    memset(&trace, 0, sizeof(trace));
+    ASSERT_EQ(DLT_RETURN_OK, dlt_offline_trace_init(&trace, path, 1000, 3000, 0));
+
+    /* 9 messages fit into a file, 200 files are created and the oldest
+     * are deleted, so that two full files and the current one are left */
+    for (i = 0; i < 1800; i++)
+    {
+        memset(data, 0, sizeof(data));
+        snprintf((char *)data, sizeof(data), "%04d", i);
+        ASSERT_EQ(DLT_RETURN_OK, dlt_offline_trace_write(&trace, data, sizeof(data), NULL, 0, NULL, 0));
+    }
+
+    /* the file list wrapped around instead of growing */
+    EXPECT_EQ(200u, trace.fileIndex);
+    EXPECT_EQ(3, trace.filesNum);
+    EXPECT_EQ(DLT_OFFLINETRACE_FILES_ALLOC, trace.filesMax);
+    EXPECT_NE(0, trace.filesFirst);
+    EXPECT_EQ(DLT_RETURN_OK, dlt_offline_trace_free(&trace));
+    EXPECT_EQ(2700u, dlt_offline_trace_get_total_size(&trace));
+
+    /* all deleted files are removed when the trace is freed */
+    EXPECT_EQ(3, offline_log_count(path, &size));
+    EXPECT_EQ(2700u, size);
+    EXPECT_FALSE(offline_trace_exists(path, 1));
+    EXPECT_FALSE(offline_trace_exists(path, 197));
+    EXPECT_TRUE(offline_trace_exists(path, 198));
+    EXPECT_TRUE(offline_trace_exists(path, 200));
+
+    /* the newest file holds the last messages */
+    ASSERT_TRUE(offline_trace_name(name, sizeof(name), path, 200));
+    file = fopen(name, "r");
+    ASSERT_TRUE(file != NULL);
+    ASSERT_EQ(sizeof(data), fread(data, 1, sizeof(data), file));
+    fclose(file);
+    EXPECT_STREQ("1791", (char *)data);
+
+    offline_log_rmdir(path);
+}
+TEST(t_dlt_offline_trace_write, oldest)
+{
+    DltOfflineTrace trace;
+    char path[PATH_MAX];
+    char name[PATH_MAX];
+    unsigned char data[100];
+    struct utimbuf times;
+    FILE *file;
+    int num;
+    int i;
+
+    /* existing files, the first one was written last */
+    offline_log_mkdir(path, sizeof(path));
+
+    for (i = 1; i <= 100; i++)
+    {
+        ASSERT_TRUE(offline_trace_name(name, sizeof(name), path, i));
+        file = fopen(name, "w");
+        ASSERT_TRUE(file != NULL);
+        memset(data, 0, sizeof(data));
+        fwrite(data, 1, sizeof(data), file);
+        fclose(file);
+        times.actime = (i == 1) ? 2000000 : 1000000 + i;
+        times.modtime = times.actime;
+        ASSERT_EQ(0, utime(name, &times));
+    }
+
+    /* the file list grows beyond its initial size */
+    memset(&trace, 0, sizeof(trace));
+    ASSERT_EQ(DLT_RETURN_OK, dlt_offline_trace_init(&trace, path, 1000, 1000000, 0));
+    EXPECT_EQ(101, trace.filesNum);
+    EXPECT_LT(DLT_OFFLINETRACE_FILES_ALLOC, trace.filesMax);
+    EXPECT_EQ(101u, trace.fileIndex);
+    EXPECT_EQ(10000u, dlt_offline_trace_get_total_size(&trace));
+
+    /* the next rotation deletes the oldest files until the new file fits,
+     * their age and not their index tells the oldest */
+    trace.maxSize = 3000;
+
+    for (i = 0; i < 10; i++)
+    {
+        ASSERT_EQ(DLT_RETURN_OK, dlt_offline_trace_write(&trace, data, sizeof(data), NULL, 0, NULL, 0));
+    }
+
+    EXPECT_EQ(102u, trace.fileIndex);
+    EXPECT_EQ(13, trace.filesNum);
+    EXPECT_EQ(2000u, dlt_offline_trace_get_total_size(&trace));
+    num = trace.filesNum;
+    EXPECT_EQ(DLT_RETURN_OK, dlt_offline_trace_free(&trace));
+
+    EXPECT_FALSE(offline_trace_exists(path, 2));
+    EXPECT_FALSE(offline_trace_exists(path, 90));
+    EXPECT_TRUE(offline_trace_exists(path, 1));
+    EXPECT_TRUE(offline_trace_exists(path, 91));
+    EXPECT_TRUE(offline_trace_exists(path, 100));
+    EXPECT_TRUE(offline_trace_exists(path, 101));
+    EXPECT_TRUE(offline_trace_exists(path, 102));
+    EXPECT_EQ(num, offline_log_count(path, NULL));
+
+    offline_log_rmdir(path);
+}
+TEST(t_dlt_offline_trace_write, removed)
+{
+    DltOfflineTrace trace;
+    char path[PATH_MAX];
+    unsigned char data[100];
+    unsigned long size;
+    int i;
+
+    /* only the current file fits, it is deleted on each rotation and
+     * timestamp based names are created again within the same second */
+    offline_log_mkdir(path, sizeof(path));
+    memset(&trace, 0, sizeof(trace));
+    memset(data, 0, sizeof(data));
+    ASSERT_EQ(DLT_RETURN_OK, dlt_offline_trace_init(&trace, path, 1000, 1500, 1));
+
+    for (i = 0; i < 12; i++)
+    {
+        ASSERT_EQ(DLT_RETURN_OK, dlt_offline_trace_write(&trace, data, sizeof(data), NULL, 0, NULL, 0));
+    }
+
+    EXPECT_EQ(DLT_RETURN_OK, dlt_offline_trace_free(&trace));
+
+    /* the queued removal did not delete the file created again */
+    EXPECT_EQ(1, offline_log_count(path, &size));
+    EXPECT_EQ(300u, size);
+    EXPECT_TRUE(trace.removeFirst == NULL);
+
+    offline_log_rmdir(path);
+}
+/* End Method:dlt_offline_trace::dlt_offline_trace_write */
+
+
+
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
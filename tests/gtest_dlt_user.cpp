@@ -28,9 +28,16 @@
 #include <stdio.h>
 #include "gtest/gtest.h"
 #include <limits.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
 
 extern "C" {
 #include "dlt_user.h"
+#include "dlt_common.h"
 }
 
 
@@ -3035,6 +3042,284 @@ TEST(t_dlt_user_is_logLevel_enabled, nullpointer)
     EXPECT_LE(DLT_RETURN_WRONG_PARAMETER, dlt_user_is_logLevel_enabled(NULL, DLT_LOG_FATAL));
 }
 
+/////////////////////////////////////////
+// header template of dlt_user_log_send_log
+typedef struct
+{
+    DltLogLevelType log_level;
+    int verbose;
+    int with_ecu_id;
+    int with_session_id;
+    int with_timestamp;
+} t_dlt_header_expected;
+
+static DltReturnValue t_dlt_header_log(DltContext *context, DltLogLevelType log_level, uint32_t num)
+{
+    DltContextData contextData;
+    DltReturnValue ret;
+
+    /* DLT_RETURN_TRUE if the message is written */
+    ret = dlt_user_log_write_start(context, &contextData, log_level);
+    if (ret != DLT_RETURN_TRUE)
+    {
+        return ret;
+    }
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_user_log_write_uint32(&contextData, num));
+    if (dlt_user_log_write_finish(&contextData) < DLT_RETURN_OK)
+    {
+        return DLT_RETURN_ERROR;
+    }
+
+    return DLT_RETURN_TRUE;
+}
+
+TEST(t_dlt_user_log_send_log, header_template)
+{
+    /* headers of the written messages, after each settings change */
+    static const t_dlt_header_expected expected[] =
+    {
+        { DLT_LOG_WARN,    1, 1, 1, 1 },
+        { DLT_LOG_INFO,    1, 1, 1, 1 },
+        { DLT_LOG_DEBUG,   1, 1, 1, 0 },
+        { DLT_LOG_INFO,    1, 0, 0, 0 },
+        { DLT_LOG_ERROR,   1, 1, 1, 1 },
+        { DLT_LOG_WARN,    0, 1, 1, 1 },
+        { DLT_LOG_FATAL,   1, 1, 1, 1 },
+    };
+    int num = sizeof(expected) / sizeof(expected[0]);
+    char filename[] = "/tmp/gtest_dlt_user_XXXXXX";
+    DltContext context;
+    DltFile file;
+    uint32_t value;
+    uint8_t mcnt = 0;
+    int fd;
+    int i;
+
+    fd = mkstemp(filename);
+    ASSERT_NE(-1, fd);
+    close(fd);
+
+    /* log into a file, it contains the headers as sent to the daemon */
+    dlt_free();
+    ASSERT_EQ(DLT_RETURN_OK, dlt_init_file(filename));
+    EXPECT_LE(DLT_RETURN_OK, dlt_register_app("TUSR", "dlt_user.c tests"));
+    EXPECT_LE(DLT_RETURN_OK, dlt_register_context_ll_ts(&context, "TMPL",
+                                                         "t_dlt_user_log_send_log header_template",
+                                                         DLT_LOG_VERBOSE,
+                                                         DLT_TRACE_STATUS_OFF));
+    EXPECT_LE(DLT_RETURN_OK, dlt_verbose_mode());
+    EXPECT_LE(DLT_RETURN_OK, dlt_with_ecu_id(1));
+    EXPECT_LE(DLT_RETURN_OK, dlt_with_session_id(1));
+    EXPECT_LE(DLT_RETURN_OK, dlt_with_timestamp(1));
+
+    EXPECT_EQ(DLT_RETURN_TRUE, t_dlt_header_log(&context, DLT_LOG_WARN, 0));
+    EXPECT_EQ(DLT_RETURN_TRUE, t_dlt_header_log(&context, DLT_LOG_INFO, 1));
+    EXPECT_LE(DLT_RETURN_OK, dlt_with_timestamp(0));
+    EXPECT_EQ(DLT_RETURN_TRUE, t_dlt_header_log(&context, DLT_LOG_DEBUG, 2));
+    EXPECT_LE(DLT_RETURN_OK, dlt_with_ecu_id(0));
+    EXPECT_LE(DLT_RETURN_OK, dlt_with_session_id(0));
+    EXPECT_EQ(DLT_RETURN_TRUE, t_dlt_header_log(&context, DLT_LOG_INFO, 3));
+    EXPECT_LE(DLT_RETURN_OK, dlt_with_ecu_id(1));
+    EXPECT_LE(DLT_RETURN_OK, dlt_with_session_id(1));
+    EXPECT_LE(DLT_RETURN_OK, dlt_with_timestamp(1));
+    EXPECT_EQ(DLT_RETURN_TRUE, t_dlt_header_log(&context, DLT_LOG_ERROR, 4));
+    EXPECT_LE(DLT_RETURN_OK, dlt_nonverbose_mode());
+    EXPECT_EQ(DLT_RETURN_TRUE, t_dlt_header_log(&context, DLT_LOG_WARN, 5));
+    EXPECT_LE(DLT_RETURN_OK, dlt_verbose_mode());
+
+    /* a lower log level of the context drops messages, but does not change the header */
+    dlt_set_application_ll_ts_limit(DLT_LOG_WARN, DLT_TRACE_STATUS_OFF);
+    EXPECT_NE(DLT_RETURN_TRUE, t_dlt_header_log(&context, DLT_LOG_INFO, 99));
+    EXPECT_EQ(DLT_RETURN_TRUE, t_dlt_header_log(&context, DLT_LOG_FATAL, 6));
+
+    EXPECT_LE(DLT_RETURN_OK, dlt_unregister_context(&context));
+    EXPECT_LE(DLT_RETURN_OK, dlt_unregister_app());
+    EXPECT_EQ(DLT_RETURN_OK, dlt_free());
+
+    /* every header must match a header built from the settings of its message */
+    EXPECT_EQ(DLT_RETURN_OK, dlt_file_init(&file, 0));
+    ASSERT_EQ(DLT_RETURN_OK, dlt_file_open(&file, filename, 0));
+
+    while (dlt_file_read(&file, 0) >= 0)
+    {
+    }
+
+    ASSERT_EQ(num, file.counter);
+
+    for (i = 0; i < num; i++)
+    {
+        uint8_t htyp;
+
+        ASSERT_LE(DLT_RETURN_OK, dlt_file_message(&file, i, 0));
+        htyp = file.msg.standardheader->htyp;
+
+        EXPECT_EQ(DLT_HTYP_PROTOCOL_VERSION1, htyp & DLT_HTYP_VERS);
+        EXPECT_EQ(expected[i].with_ecu_id, DLT_IS_HTYP_WEID(htyp) ? 1 : 0);
+        EXPECT_EQ(expected[i].with_session_id, DLT_IS_HTYP_WSID(htyp) ? 1 : 0);
+        EXPECT_EQ(expected[i].with_timestamp, DLT_IS_HTYP_WTMS(htyp) ? 1 : 0);
+        ASSERT_TRUE(DLT_IS_HTYP_UEH(htyp));
+
+        if (expected[i].with_ecu_id)
+        {
+            EXPECT_EQ(0, memcmp(file.msg.headerextra.ecu, file.msg.storageheader->ecu, DLT_ID_SIZE));
+        }
+
+        if (expected[i].with_session_id)
+        {
+            EXPECT_EQ((uint32_t)getpid(), file.msg.headerextra.seid);
+        }
+
+        if (expected[i].with_timestamp)
+        {
+            EXPECT_LT(0u, file.msg.headerextra.tmsp);
+        }
+
+        if (i == 0)
+        {
+            mcnt = file.msg.standardheader->mcnt;
+        }
+
+        EXPECT_EQ((uint8_t)(mcnt + i), file.msg.standardheader->mcnt);
+        EXPECT_EQ(0, memcmp(file.msg.extendedheader->apid, "TUSR", DLT_ID_SIZE));
+        EXPECT_EQ(0, memcmp(file.msg.extendedheader->ctid, "TMPL", DLT_ID_SIZE));
+        EXPECT_EQ(expected[i].verbose, DLT_IS_MSIN_VERB(file.msg.extendedheader->msin) ? 1 : 0);
+        EXPECT_EQ(DLT_TYPE_LOG, DLT_GET_MSIN_MSTP(file.msg.extendedheader->msin));
+        EXPECT_EQ(expected[i].log_level, DLT_GET_MSIN_MTIN(file.msg.extendedheader->msin));
+        EXPECT_EQ(1, file.msg.extendedheader->noar);
+
+        /* the value follows the type info in verbose mode, the message id otherwise */
+        ASSERT_EQ((int32_t)(2 * sizeof(uint32_t)), file.msg.datasize);
+        memcpy(&value, file.msg.databuffer + file.msg.datasize - sizeof(uint32_t), sizeof(uint32_t));
+        EXPECT_EQ((uint32_t)i, value);
+    }
+
+    EXPECT_EQ(DLT_RETURN_OK, dlt_file_free(&file, 0));
+    unlink(filename);
+}
+
+/////////////////////////////////////////
+// dlt_init_async
+typedef struct
+{
+    int num;
+    int received;
+} t_dlt_async_messages;
+
+/* Receive messages from the daemon until check returns 1, returns 0 on timeout */
+static int t_dlt_async_receive(DltReceiver *receiver, DltMessage *msg,
+                               int (*check)(DltMessage *msg, void *data), void *data)
+{
+    int done = 0;
+
+    while (!done && (dlt_receiver_receive_socket(receiver) > 0))
+    {
+        int offset = 0;
+
+        while (!done && (dlt_message_read(msg, (uint8_t *)receiver->buf + offset,
+                                          receiver->bytesRcvd - offset, 0, 0) == DLT_MESSAGE_ERROR_OK))
+        {
+            offset += msg->headersize + msg->datasize - sizeof(DltStorageHeader);
+            done = check(msg, data);
+        }
+
+        EXPECT_EQ(DLT_RETURN_OK, dlt_receiver_remove(receiver, offset));
+        EXPECT_EQ(DLT_RETURN_OK, dlt_receiver_move_to_begin(receiver));
+    }
+
+    return done;
+}
+
+/* The daemon sends the connection info once it accepted the client */
+static int t_dlt_async_connected(DltMessage *msg, void *data)
+{
+    uint32_t service_id;
+
+    (void) data;
+
+    if (!DLT_MSG_IS_CONTROL_RESPONSE(msg) || (msg->datasize < (int32_t)sizeof(uint32_t)))
+    {
+        return 0;
+    }
+
+    memcpy(&service_id, msg->databuffer, sizeof(uint32_t));
+
+    return (service_id == DLT_SERVICE_ID_CONNECTION_INFO);
+}
+
+/* Messages of this process must arrive once and in order */
+static int t_dlt_async_message(DltMessage *msg, void *data)
+{
+    t_dlt_async_messages *messages = (t_dlt_async_messages *)data;
+    uint32_t value;
+
+    if ((msg->extendedheader == NULL) ||
+        !DLT_IS_HTYP_WSID(msg->standardheader->htyp) ||
+        (msg->headerextra.seid != (uint32_t)getpid()) ||
+        (memcmp(msg->extendedheader->apid, "TASY", DLT_ID_SIZE) != 0) ||
+        (memcmp(msg->extendedheader->ctid, "ASYN", DLT_ID_SIZE) != 0))
+    {
+        return 0;
+    }
+
+    EXPECT_EQ((int32_t)(2 * sizeof(uint32_t)), msg->datasize);
+    memcpy(&value, msg->databuffer + msg->datasize - sizeof(uint32_t), sizeof(uint32_t));
+    EXPECT_EQ((uint32_t)messages->received, value);
+    messages->received++;
+
+    return (messages->received >= messages->num);
+}
+
+TEST(t_dlt_init_async, free)
+{
+    t_dlt_async_messages messages = { 500, 0 };
+    struct sockaddr_in addr;
+    struct timeval timeout = { 5, 0 };
+    DltReceiver receiver;
+    DltMessage msg;
+    DltContext context;
+    DltContextData contextData;
+    int sock;
+    int i;
+
+    /* receive the messages as a client of the daemon, the daemon keeps
+     * messages received before it accepted the client in its own buffer */
+    sock = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_NE(-1, sock);
+    ASSERT_EQ(0, setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(DLT_DAEMON_TCP_PORT);
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    ASSERT_EQ(0, connect(sock, (struct sockaddr *)&addr, sizeof(addr)));
+    EXPECT_EQ(DLT_RETURN_OK, dlt_receiver_init(&receiver, sock, 65536));
+    EXPECT_EQ(DLT_RETURN_OK, dlt_message_init(&msg, 0));
+    ASSERT_EQ(1, t_dlt_async_receive(&receiver, &msg, t_dlt_async_connected, NULL));
+
+    /* watermark (the whole buffer of 64 kB) and latency are not reached,
+     * all messages are sent by dlt_free() */
+    dlt_free();
+    ASSERT_EQ(DLT_RETURN_OK, dlt_init_async(65536, 60000));
+    EXPECT_LE(DLT_RETURN_OK, dlt_register_app("TASY", "dlt_user.c async tests"));
+    EXPECT_LE(DLT_RETURN_OK, dlt_register_context(&context, "ASYN", "t_dlt_init_async free"));
+
+    for (i = 0; i < messages.num; i++)
+    {
+        ASSERT_EQ(DLT_RETURN_TRUE, dlt_user_log_write_start(&context, &contextData, DLT_LOG_WARN));
+        EXPECT_LE(DLT_RETURN_OK, dlt_user_log_write_uint32(&contextData, i));
+        ASSERT_LE(DLT_RETURN_OK, dlt_user_log_write_finish(&contextData));
+    }
+
+    EXPECT_EQ(DLT_RETURN_OK, dlt_free());
+
+    EXPECT_EQ(1, t_dlt_async_receive(&receiver, &msg, t_dlt_async_message, &messages));
+    EXPECT_EQ(messages.num, messages.received);
+
+    dlt_message_free(&msg, 0);
+    dlt_receiver_free(&receiver);
+    close(sock);
+}
+
 /////////////////////////////////////////
 // main
 int main(int argc, char **argv)